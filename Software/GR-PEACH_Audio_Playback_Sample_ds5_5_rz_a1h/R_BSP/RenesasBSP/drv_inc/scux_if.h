@@ -68,6 +68,8 @@ typedef enum
 } scux_ch_num_t;
 #endif /* end mbed */
 
+#if(1) /* mbed */
+#else  /* not mbed */
 /* SCUX route setting */
 typedef enum
 {
@@ -113,6 +115,7 @@ typedef enum
     SCUX_ROUTE_SRC3_MIX_SSIF345 = 0x3010,   
     SCUX_ROUTE_SRC_MIX_SSIF_MAX = 0x3011
 } scux_route_t;
+#endif /* end mbed */
 
 #if(1) /* mbed */
 #else  /* not mbed */
@@ -212,6 +215,8 @@ typedef enum
     SCUX_DELAY_MAX         = 3     
 } scux_src_delay_mode_t;
 
+#if(1) /* mbed */
+#else  /* not mbed */
 /* DVU ramp time setting */
 typedef enum
 {
@@ -242,6 +247,7 @@ typedef enum
     SCUX_DVU_TIME_0_125DB_8192STEP = 23,  /* volume change 0.125DB among 8192 step */
     SCUX_DVU_TIME_MAX              = 24   
 } scux_dvu_ramp_time_t;
+#endif /* end mbed */
 
 /* MIX ramp time setting */
 typedef enum
@@ -261,6 +267,8 @@ typedef enum
     SCUX_MIX_TIME_MAX            = 11     
 } scux_mix_ramp_time_t;
 
+#if(1) /* mbed */
+#else  /* not mbed */
 /* SSIF channels */
 typedef enum
 {
@@ -286,6 +294,7 @@ typedef enum
     SCUX_SSIF_SYSTEM_LEN_256   = 7,    /* SSIF system word length is 256bit */
     SCUX_SSIF_SYSTEM_LEN_MAX   = 8
 } scux_ssif_system_len_t;
+#endif /* end mbed */
 
 /******************************************************************************
 Macro definitions
@@ -323,12 +332,15 @@ Macro definitions
 #define SCUX_STAT_TRANS   2  /* under data transfer execution */
 #endif /* end mbed */
 
+#if(1) /* mbed */
+#else  /* not mbed */
 /* DVU status */
 #define SCUX_DVU_STAT_MUTE          0  /* DVU volume is mute */
 #define SCUX_DVU_STAT_RAMP_DOWN     1  /* DVU volume is ramp down */
 #define SCUX_DVU_STAT_RAMP_UP       2  /* DVU volume is ramp up */
 #define SCUX_DVU_STAT_RAMP_FIXED    3  /* DVU volume change is stop */
 #define SCUX_DVU_STAT_ORIGINAL_SIZE 4  /* DVU volume is original size */
+#endif /* end mbed */
 
 /* MIX status */
 #define SCUX_MIX_STAT_RAMP_FIXED  0  /* MIX volume change is stop */
@@ -45,6 +45,11 @@
 #define SAMPLING_RATE_96000HZ (96000U) /* Selects a sampling rate of 96 kHz. */
 #define SELECT_IN_DATA_CH_0   (0U)     /* Specifies audio channel 0ch. */
 #define SELECT_IN_DATA_CH_1   (1U)     /* Specifies audio channel 1ch. */
+#define DVU_DIGI_VOL_0DB      (0x100000U) /* Digital volume value of 0 dB (x1). */
+#define DVU_DIGI_VOL_MAX      (0x7FFFFFU) /* Maximum digital volume value (about +18 dB). */
+#define DVU_RAMP_VOL_0DB      (0x000U)    /* Ramp volume value of 0 dB. */
+#define DVU_RAMP_VOL_MUTE     (0x3FFU)    /* Ramp volume value of mute. */
+#define DVU_RAMP_VOL_PER_DB   (8U)        /* Ramp volume value per 1 dB of attenuation. */
 
 /** SRC parameter information */
 typedef struct
@@ -58,6 +63,38 @@ typedef struct
     uint32_t              select_in_data_ch[SCUX_USE_CH_2]; /**< For SRC's input data position swapping */
 } scux_src_usr_cfg_t;
 
+/** SSIF parameter information */
+typedef struct
+{
+    scux_ssif_ch_num_t     ssif_ch_num;       /**< SSIF channel number */
+    bool                   mode_master;       /**< Master mode (true) / slave mode (false) select */
+    bool                   select_audio_clk;  /**< AUDIO_CLK (true) / AUDIO_X1 (false) select */
+    scux_ssif_system_len_t system_word;       /**< System word length */
+    bool                   sck_polarity_rise; /**< SCK polarity type select */
+    bool                   ws_polarity_high;  /**< WS polarity type select */
+    bool                   padding_high;      /**< Padding type select */
+    bool                   serial_data_align; /**< Serial data alignment type select */
+    bool                   ws_delay;          /**< WS delay type select */
+    bool                   use_noise_cancel;  /**< Noise cancel ON / OFF select */
+    bool                   use_tdm;           /**< TDM mode ON / OFF select */
+} scux_ssif_usr_cfg_t;
+
+/** DVU parameter information */
+typedef struct
+{
+    bool                   dvu_enable;              /**< DVU function enable setting */
+    bool                   digi_vol_enable;         /**< Digital volume enable setting */
+    uint32_t               digi_vol[SCUX_USE_CH_2]; /**< Digital volume of each channel
+                                                         (0 - DVU_DIGI_VOL_MAX, DVU_DIGI_VOL_0DB is 0 dB) */
+    bool                   ramp_vol_enable;         /**< Ramp volume enable setting */
+    scux_dvu_ramp_time_t   up_period;               /**< Ramp up period */
+    scux_dvu_ramp_time_t   down_period;             /**< Ramp down period */
+    uint32_t               ramp_vol;                /**< Target of the ramp volume
+                                                         (DVU_RAMP_VOL_0DB - DVU_RAMP_VOL_MUTE) */
+    uint32_t               ramp_wait_time;          /**< Wait time in samples before the ramp starts */
+    bool                   zc_mute_enable;          /**< Zero cross mute enable setting */
+} scux_dvu_usr_cfg_t;
+
 /** The SCUX module is made up of a sampling rate converter, a digital volume unit, and a mixer.
  *  The SCUX driver can perform asynchronous and synchronous sampling rate conversions using the sampling rate
  *  converter. 
@@ -122,6 +159,81 @@ public:
      */
     bool SetSrcCfg(const scux_src_usr_cfg_t * const p_src_param);
 
+    /** Sets up the route of the SCUX.
+     *  The route can be changed only while the transfer is stopped.
+     *  When a route to SSIF is selected, SetSsifCfg must be called for the SSIF channel
+     *  before TransStart. On a route to SSIF, the SRC output is transferred to SSIF
+     *  by the SCUX HW and read requests are not accepted.
+     *
+     * @param route Route of the SCUX
+     *        SCUX_ROUTE_SRCn_MEM        SRC output is read by read requests. (Initial route)
+     *        SCUX_ROUTE_SRCn_SSIFm      SRC output is transferred to SSIF directly.
+     *        SCUX_ROUTE_SRCn_MIX_SSIFm  SRC output is transferred to SSIF through the mixer.
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetRoute(const scux_route_t route);
+
+    /** Sets up SSIF parameters used on a route to SSIF.
+     *
+     * @param p_ssif_param SSIF parameter information
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetSsifCfg(const scux_ssif_usr_cfg_t * const p_ssif_param);
+
+    /** Sets up DVU (digital volume unit) parameters.
+     *  The DVU is in the signal path on a route to SSIF only. On SCUX_ROUTE_SRCn_MEM
+     *  the parameters are accepted but have no effect on the read data.
+     *  The parameters can be changed only while the transfer is stopped.
+     *
+     * @param p_dvu_param DVU parameter information
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetDvuCfg(const scux_dvu_usr_cfg_t * const p_dvu_param);
+
+    /** Changes the digital volume.
+     *  The digital volume is enabled by this function. 
+     *  It is applied at once, so it is suitable for the change while the output is silent.
+     *
+     * @param p_digi_vol Digital volume of each channel (array of SCUX_USE_CH_2 elements)
+     *                   0 - DVU_DIGI_VOL_MAX, DVU_DIGI_VOL_0DB is 0 dB.
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetDigiVol(const uint32_t * const p_digi_vol);
+
+    /** Changes the target of the ramp volume.
+     *  The volume moves to the target by the HW in the specified period, so the change is
+     *  click-free and the CPU does not process any sample.
+     *  The ramp volume is enabled by this function. 
+     *
+     * @param ramp_vol Target of the ramp volume
+     *                 DVU_RAMP_VOL_0DB (0 dB) - DVU_RAMP_VOL_MUTE (mute), DVU_RAMP_VOL_PER_DB per 1 dB.
+     * @param up_period Ramp up period
+     * @param down_period Ramp down period
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetRampVol(const uint32_t ramp_vol, 
+                    const scux_dvu_ramp_time_t up_period, const scux_dvu_ramp_time_t down_period);
+
+    /** Turns the zero cross mute on or off.
+     *  When it is turned on, each channel is muted at the next zero crossing point.
+     *
+     * @param mute Zero cross mute enable setting
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool SetZerocrossMute(const bool mute);
+
+    /** Obtains the state information of the DVU volume.
+     *
+     * @param p_dvu_stat Status of the ramp volume
+     *        SCUX_DVU_STAT_MUTE         (0)  Volume is muted.
+     *        SCUX_DVU_STAT_RAMP_DOWN    (1)  Volume is ramping down.
+     *        SCUX_DVU_STAT_RAMP_UP      (2)  Volume is ramping up.
+     *        SCUX_DVU_STAT_RAMP_FIXED   (3)  Volume change is completed.
+     *        SCUX_DVU_STAT_ORIGINAL_SIZE(4)  Volume is the original size.
+     * @return Returns true if the function is successful. Returns false if the function fails.
+     */
+    bool GetDvuStat(uint32_t * const p_dvu_stat);
+
     /** Obtains the state information of the write request.
      *
      * @param p_write_stat Status of the write request
@@ -71,6 +71,109 @@ typedef enum
     SCUX_DATA_LEN_MAX      = 3    /**< For data word length identification [unsettable] */
 } scux_data_word_len_t;
 
+/** SCUX route setting */
+typedef enum
+{
+    /* mem to mem */
+    SCUX_ROUTE_SRC_MEM_MIN = 0x1000,        /**< For route identification [unsettable] */
+    SCUX_ROUTE_SRC0_MEM    = 0x1001,        /**< SRC0 to memory */
+    SCUX_ROUTE_SRC1_MEM    = 0x1002,        /**< SRC1 to memory */
+    SCUX_ROUTE_SRC2_MEM    = 0x1003,        /**< SRC2 to memory */
+    SCUX_ROUTE_SRC3_MEM    = 0x1004,        /**< SRC3 to memory */
+    SCUX_ROUTE_SRC_MEM_MAX = 0x1005,        /**< For route identification [unsettable] */
+    /* mem to SSIF */
+    SCUX_ROUTE_SRC_SSIF_MIN = 0x2000,       /**< For route identification [unsettable] */
+    SCUX_ROUTE_SRC0_SSIF0   = 0x2001,       /**< SRC0 to SSIF0 */
+    SCUX_ROUTE_SRC0_SSIF012 = 0x2002,       /**< SRC0 to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC0_SSIF3   = 0x2003,       /**< SRC0 to SSIF3 */
+    SCUX_ROUTE_SRC0_SSIF345 = 0x2004,       /**< SRC0 to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC1_SSIF0   = 0x2005,       /**< SRC1 to SSIF0 */
+    SCUX_ROUTE_SRC1_SSIF012 = 0x2006,       /**< SRC1 to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC1_SSIF3   = 0x2007,       /**< SRC1 to SSIF3 */
+    SCUX_ROUTE_SRC1_SSIF345 = 0x2008,       /**< SRC1 to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC2_SSIF1   = 0x2009,       /**< SRC2 to SSIF1 */
+    SCUX_ROUTE_SRC2_SSIF4   = 0x200A,       /**< SRC2 to SSIF4 */
+    SCUX_ROUTE_SRC3_SSIF2   = 0x200B,       /**< SRC3 to SSIF2 */
+    SCUX_ROUTE_SRC3_SSIF5   = 0x200C,       /**< SRC3 to SSIF5 */
+    SCUX_ROUTE_SRC_SSIF_MAX = 0x200D,       /**< For route identification [unsettable] */
+    /* mem to MIX to SSIF */
+    SCUX_ROUTE_SRC_MIX_SSIF_MIN  = 0x3000,  /**< For route identification [unsettable] */
+    SCUX_ROUTE_SRC0_MIX_SSIF0   = 0x3001,   /**< SRC0 to MIX to SSIF0 */
+    SCUX_ROUTE_SRC0_MIX_SSIF012 = 0x3002,   /**< SRC0 to MIX to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC0_MIX_SSIF3   = 0x3003,   /**< SRC0 to MIX to SSIF3 */
+    SCUX_ROUTE_SRC0_MIX_SSIF345 = 0x3004,   /**< SRC0 to MIX to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC1_MIX_SSIF0   = 0x3005,   /**< SRC1 to MIX to SSIF0 */
+    SCUX_ROUTE_SRC1_MIX_SSIF012 = 0x3006,   /**< SRC1 to MIX to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC1_MIX_SSIF3   = 0x3007,   /**< SRC1 to MIX to SSIF3 */
+    SCUX_ROUTE_SRC1_MIX_SSIF345 = 0x3008,   /**< SRC1 to MIX to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC2_MIX_SSIF0   = 0x3009,   /**< SRC2 to MIX to SSIF0 */
+    SCUX_ROUTE_SRC2_MIX_SSIF012 = 0x300A,   /**< SRC2 to MIX to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC2_MIX_SSIF3   = 0x300B,   /**< SRC2 to MIX to SSIF3 */
+    SCUX_ROUTE_SRC2_MIX_SSIF345 = 0x300C,   /**< SRC2 to MIX to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC3_MIX_SSIF0   = 0x300D,   /**< SRC3 to MIX to SSIF0 */
+    SCUX_ROUTE_SRC3_MIX_SSIF012 = 0x300E,   /**< SRC3 to MIX to SSIF0, SSIF1, SSIF2 */
+    SCUX_ROUTE_SRC3_MIX_SSIF3   = 0x300F,   /**< SRC3 to MIX to SSIF3 */
+    SCUX_ROUTE_SRC3_MIX_SSIF345 = 0x3010,   /**< SRC3 to MIX to SSIF3, SSIF4, SSIF5 */
+    SCUX_ROUTE_SRC_MIX_SSIF_MAX = 0x3011    /**< For route identification [unsettable] */
+} scux_route_t;
+
+/** DVU ramp time setting */
+typedef enum
+{
+    SCUX_DVU_TIME_MIN              =(-1), /**< For ramp time identification [unsettable] */
+    SCUX_DVU_TIME_128DB_1STEP      = 0,   /**< volume change 128DB among 1 step */
+    SCUX_DVU_TIME_64DB_1STEP       = 1,   /**< volume change 64DB among 1 step */
+    SCUX_DVU_TIME_32DB_1STEP       = 2,   /**< volume change 32DB among 1 step */
+    SCUX_DVU_TIME_16DB_1STEP       = 3,   /**< volume change 16DB among 1 step */
+    SCUX_DVU_TIME_8DB_1STEP        = 4,   /**< volume change 8DB among 1 step */
+    SCUX_DVU_TIME_4DB_1STEP        = 5,   /**< volume change 4DB among 1 step */
+    SCUX_DVU_TIME_2DB_1STEP        = 6,   /**< volume change 2DB among 1 step */
+    SCUX_DVU_TIME_1DB_1STEP        = 7,   /**< volume change 1DB among 1 step */
+    SCUX_DVU_TIME_0_5DB_1STEP      = 8,   /**< volume change 0.5DB among 1 step */
+    SCUX_DVU_TIME_0_25DB_1STEP     = 9,   /**< volume change 0.25DB among 1 step */
+    SCUX_DVU_TIME_0_125DB_1STEP    = 10,  /**< volume change 0.125DB among 1 step */
+    SCUX_DVU_TIME_0_125DB_2STEP    = 11,  /**< volume change 0.125DB among 2 step */
+    SCUX_DVU_TIME_0_125DB_4STEP    = 12,  /**< volume change 0.125DB among 4 step */
+    SCUX_DVU_TIME_0_125DB_8STEP    = 13,  /**< volume change 0.125DB among 8 step */
+    SCUX_DVU_TIME_0_125DB_16STEP   = 14,  /**< volume change 0.125DB among 16 step */
+    SCUX_DVU_TIME_0_125DB_32STEP   = 15,  /**< volume change 0.125DB among 32 step */
+    SCUX_DVU_TIME_0_125DB_64STEP   = 16,  /**< volume change 0.125DB among 64 step */
+    SCUX_DVU_TIME_0_125DB_128STEP  = 17,  /**< volume change 0.125DB among 128 step */
+    SCUX_DVU_TIME_0_125DB_256STEP  = 18,  /**< volume change 0.125DB among 256 step */
+    SCUX_DVU_TIME_0_125DB_512STEP  = 19,  /**< volume change 0.125DB among 512 step */
+    SCUX_DVU_TIME_0_125DB_1024STEP = 20,  /**< volume change 0.125DB among 1024 step */
+    SCUX_DVU_TIME_0_125DB_2048STEP = 21,  /**< volume change 0.125DB among 2048 step */
+    SCUX_DVU_TIME_0_125DB_4096STEP = 22,  /**< volume change 0.125DB among 4096 step */
+    SCUX_DVU_TIME_0_125DB_8192STEP = 23,  /**< volume change 0.125DB among 8192 step */
+    SCUX_DVU_TIME_MAX              = 24   /**< For ramp time identification [unsettable] */
+} scux_dvu_ramp_time_t;
+
+/** SSIF channel number */
+typedef enum
+{
+    SCUX_SSIF_CH_0    = 0,    /**< Specifies SSIF0. */
+    SCUX_SSIF_CH_1    = 1,    /**< Specifies SSIF1. */
+    SCUX_SSIF_CH_2    = 2,    /**< Specifies SSIF2. */
+    SCUX_SSIF_CH_3    = 3,    /**< Specifies SSIF3. */
+    SCUX_SSIF_CH_4    = 4,    /**< Specifies SSIF4. */
+    SCUX_SSIF_CH_5    = 5,    /**< Specifies SSIF5. */
+    SCUX_SSIF_CH_NUM  = 6     /**< Number of SSIF channels. */
+} scux_ssif_ch_num_t;
+
+/** SSIF system word length */
+typedef enum
+{
+    SCUX_SSIF_SYSTEM_LEN_MIN   = 0,    /**< For system word length identification [unsettable] */
+    SCUX_SSIF_SYSTEM_LEN_16    = 1,    /**< SSIF system word length is 16bit */
+    SCUX_SSIF_SYSTEM_LEN_24    = 2,    /**< SSIF system word length is 24bit */
+    SCUX_SSIF_SYSTEM_LEN_32    = 3,    /**< SSIF system word length is 32bit */
+    SCUX_SSIF_SYSTEM_LEN_48    = 4,    /**< SSIF system word length is 48bit */
+    SCUX_SSIF_SYSTEM_LEN_64    = 5,    /**< SSIF system word length is 64bit */
+    SCUX_SSIF_SYSTEM_LEN_128   = 6,    /**< SSIF system word length is 128bit */
+    SCUX_SSIF_SYSTEM_LEN_256   = 7,    /**< SSIF system word length is 256bit */
+    SCUX_SSIF_SYSTEM_LEN_MAX   = 8     /**< For system word length identification [unsettable] */
+} scux_ssif_system_len_t;
+
 /******************************************************************************
 Macro definitions
 ******************************************************************************/
@@ -80,6 +183,13 @@ Macro definitions
 #define SCUX_STAT_IDLE    1  /**< Processing of all requests is completed and waiting for a request. */
 #define SCUX_STAT_TRANS   2  /**< Transfer in progress */
 
+/** Status of the DVU volume */
+#define SCUX_DVU_STAT_MUTE          0  /**< DVU volume is muted. */
+#define SCUX_DVU_STAT_RAMP_DOWN     1  /**< DVU volume is ramping down. */
+#define SCUX_DVU_STAT_RAMP_UP       2  /**< DVU volume is ramping up. */
+#define SCUX_DVU_STAT_RAMP_FIXED    3  /**< DVU volume change is completed. */
+#define SCUX_DVU_STAT_ORIGINAL_SIZE 4  /**< DVU volume is the original size. */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
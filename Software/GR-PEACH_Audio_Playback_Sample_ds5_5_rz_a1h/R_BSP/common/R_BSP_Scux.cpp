@@ -45,6 +45,7 @@
 #define DIV_RATIO_CLK_USB_48000HZ   (1000U)  /* Divide ratio when the frequency is 48000Hz */
 #define DIV_RATIO_CLK_USB_64000HZ   (750U)   /* Divide ratio when the frequency is 64000Hz */
 #define DIV_RATIO_CLK_USB_96000HZ   (500U)   /* Divide ratio when the frequency is 96000Hz */
+#define RAMP_WAIT_TIME_MAX          (0xFFFFFFU) /* The maximum value of the ramp wait time */
 
 static bool set_src_init_cfg(scux_src_cfg_t * const src_cfg);
 
@@ -299,6 +300,179 @@ bool R_BSP_Scux::SetSrcCfg(const scux_src_usr_cfg_t * const p_src_param) {
     return ret;
 }
 
+bool R_BSP_Scux::SetRoute(const scux_route_t route) {
+    bool    ret = false;
+    scux_route_t set_route = route;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else if (((route > SCUX_ROUTE_SRC_MEM_MIN) && (route < SCUX_ROUTE_SRC_MEM_MAX)) ||
+               ((route > SCUX_ROUTE_SRC_SSIF_MIN) && (route < SCUX_ROUTE_SRC_SSIF_MAX)) ||
+               ((route > SCUX_ROUTE_SRC_MIX_SSIF_MIN) && (route < SCUX_ROUTE_SRC_MIX_SSIF_MAX))) {
+        ret = ioctl(SCUX_IOCTL_SET_ROUTE, (void *)&set_route);
+    } else {
+        ret = false;
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::SetSsifCfg(const scux_ssif_usr_cfg_t * const p_ssif_param) {
+    scux_ssif_cfg_t ssif_cfg;
+    bool    ret = false;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else if (p_ssif_param == NULL) {
+        ret = false;
+    } else if ((p_ssif_param->ssif_ch_num >= SCUX_SSIF_CH_NUM) ||
+               (p_ssif_param->system_word <= SCUX_SSIF_SYSTEM_LEN_MIN) ||
+               (p_ssif_param->system_word >= SCUX_SSIF_SYSTEM_LEN_MAX)) {
+        ret = false;
+    } else {
+        ssif_cfg.ssif_ch_num       = p_ssif_param->ssif_ch_num;
+        ssif_cfg.mode_master       = p_ssif_param->mode_master;
+        ssif_cfg.select_audio_clk  = p_ssif_param->select_audio_clk;
+        ssif_cfg.system_word       = p_ssif_param->system_word;
+        ssif_cfg.sck_polarity_rise = p_ssif_param->sck_polarity_rise;
+        ssif_cfg.ws_polarity_high  = p_ssif_param->ws_polarity_high;
+        ssif_cfg.padding_high      = p_ssif_param->padding_high;
+        ssif_cfg.serial_data_align = p_ssif_param->serial_data_align;
+        ssif_cfg.ws_delay          = p_ssif_param->ws_delay;
+        ssif_cfg.use_noise_cancel  = p_ssif_param->use_noise_cancel;
+        ssif_cfg.use_tdm           = p_ssif_param->use_tdm;
+        ret = ioctl(SCUX_IOCTL_SET_SSIF_CFG, (void *)&ssif_cfg);
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::SetDvuCfg(const scux_dvu_usr_cfg_t * const p_dvu_param) {
+    scux_dvu_cfg_t dvu_cfg;
+    bool    ret = false;
+    int32_t i;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else if (p_dvu_param == NULL) {
+        ret = false;
+    } else if ((p_dvu_param->digi_vol[SCUX_AUDIO_CH_0] > DVU_DIGI_VOL_MAX) ||
+               (p_dvu_param->digi_vol[SCUX_AUDIO_CH_1] > DVU_DIGI_VOL_MAX) ||
+               (p_dvu_param->up_period <= SCUX_DVU_TIME_MIN) ||
+               (p_dvu_param->up_period >= SCUX_DVU_TIME_MAX) ||
+               (p_dvu_param->down_period <= SCUX_DVU_TIME_MIN) ||
+               (p_dvu_param->down_period >= SCUX_DVU_TIME_MAX) ||
+               (p_dvu_param->ramp_vol > DVU_RAMP_VOL_MUTE) ||
+               (p_dvu_param->ramp_wait_time > RAMP_WAIT_TIME_MAX)) {
+        ret = false;
+    } else {
+        dvu_cfg.dvu_enable                   = p_dvu_param->dvu_enable;
+        dvu_cfg.dvu_digi_vol.digi_vol_enable = p_dvu_param->digi_vol_enable;
+        dvu_cfg.dvu_ramp_vol.up_period       = p_dvu_param->up_period;
+        dvu_cfg.dvu_ramp_vol.down_period     = p_dvu_param->down_period;
+        dvu_cfg.dvu_ramp_vol.ramp_vol        = p_dvu_param->ramp_vol;
+        dvu_cfg.dvu_ramp_vol.ramp_wait_time  = p_dvu_param->ramp_wait_time;
+        for (i = 0; i < SCUX_AUDIO_CH_MAX; i++) {
+            if (i < SCUX_USE_CH_2) {
+                dvu_cfg.dvu_digi_vol.digi_vol[i]        = p_dvu_param->digi_vol[i];
+                dvu_cfg.dvu_ramp_vol.ramp_vol_enable[i] = p_dvu_param->ramp_vol_enable;
+                dvu_cfg.dvu_zc_mute.zc_mute_enable[i]   = p_dvu_param->zc_mute_enable;
+            } else {
+                dvu_cfg.dvu_digi_vol.digi_vol[i]        = DVU_DIGI_VOL_0DB;
+                dvu_cfg.dvu_ramp_vol.ramp_vol_enable[i] = false;
+                dvu_cfg.dvu_zc_mute.zc_mute_enable[i]   = false;
+            }
+            dvu_cfg.dvu_zc_mute.pcallback[i] = NULL;
+        }
+        ret = ioctl(SCUX_IOCTL_SET_DVU_CFG, (void *)&dvu_cfg);
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::SetDigiVol(const uint32_t * const p_digi_vol) {
+    scux_dvu_digi_vol_t digi_vol;
+    bool    ret = false;
+    int32_t i;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else if (p_digi_vol == NULL) {
+        ret = false;
+    } else if ((p_digi_vol[SCUX_AUDIO_CH_0] > DVU_DIGI_VOL_MAX) ||
+               (p_digi_vol[SCUX_AUDIO_CH_1] > DVU_DIGI_VOL_MAX)) {
+        ret = false;
+    } else {
+        digi_vol.digi_vol_enable = true;
+        for (i = 0; i < SCUX_AUDIO_CH_MAX; i++) {
+            if (i < SCUX_USE_CH_2) {
+                digi_vol.digi_vol[i] = p_digi_vol[i];
+            } else {
+                digi_vol.digi_vol[i] = DVU_DIGI_VOL_0DB;
+            }
+        }
+        ret = ioctl(SCUX_IOCTL_SET_DVU_DIGI_VOL, (void *)&digi_vol);
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::SetRampVol(const uint32_t ramp_vol, 
+                    const scux_dvu_ramp_time_t up_period, const scux_dvu_ramp_time_t down_period) {
+    scux_dvu_ramp_vol_t ramp;
+    bool    ret = false;
+    int32_t i;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else if ((ramp_vol > DVU_RAMP_VOL_MUTE) ||
+               (up_period <= SCUX_DVU_TIME_MIN) || (up_period >= SCUX_DVU_TIME_MAX) ||
+               (down_period <= SCUX_DVU_TIME_MIN) || (down_period >= SCUX_DVU_TIME_MAX)) {
+        ret = false;
+    } else {
+        for (i = 0; i < SCUX_AUDIO_CH_MAX; i++) {
+            if (i < SCUX_USE_CH_2) {
+                ramp.ramp_vol_enable[i] = true;
+            } else {
+                ramp.ramp_vol_enable[i] = false;
+            }
+        }
+        ramp.up_period      = up_period;
+        ramp.down_period    = down_period;
+        ramp.ramp_vol       = ramp_vol;
+        ramp.ramp_wait_time = 0U;
+        ret = ioctl(SCUX_IOCTL_SET_DVU_RAMP_VOL, (void *)&ramp);
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::SetZerocrossMute(const bool mute) {
+    scux_zc_mute_t zc_mute;
+    bool    ret = false;
+    int32_t i;
+
+    if (scux_ch == CH_ERR_NUM) {
+        ret = false;
+    } else {
+        for (i = 0; i < SCUX_AUDIO_CH_MAX; i++) {
+            if (i < SCUX_USE_CH_2) {
+                zc_mute.zc_mute_enable[i] = mute;
+            } else {
+                zc_mute.zc_mute_enable[i] = false;
+            }
+            zc_mute.pcallback[i] = NULL;
+        }
+        ret = ioctl(SCUX_IOCTL_SET_ZEROCROSS_MUTE, (void *)&zc_mute);
+    }
+
+    return ret;
+}
+
+bool R_BSP_Scux::GetDvuStat(uint32_t * const p_dvu_stat) {
+    return ioctl(SCUX_IOCTL_GET_DVU_STAT, (void *)p_dvu_stat);
+}
+
 bool R_BSP_Scux::GetWriteStat(uint32_t * const p_write_stat) {
     return ioctl(SCUX_IOCTL_GET_WRITE_STAT, (void *)p_write_stat);
 }
@@ -37,10 +37,12 @@ USBHost * USBHost::instHost = NULL;
 *           - reads the device descriptor
 *           - sets the address of the device
 *           - if it is a hub, enumerates it
+*           - calls the device event callback
 *   - device disconnected:
 *       - a message is queued in queue_usb_event with the id DEVICE_DISCONNECTED_EVENT
 *       - when the usb_thread receives the event, it:
 *           - free the device and all its children (hub)
+*           - calls the device event callback
 *   - td processed
 *       - a message is queued in queue_usb_event with the id TD_PROCESSED_EVENT
 *       - when the usb_thread receives the event, it:
@@ -186,6 +188,9 @@ void USBHost::usb_process() {
 
                     } while(0);
 
+                    if (deviceEvent) {
+                        deviceEvent.call();
+                    }
                     break;
 
                 // a device has been disconnected
@@ -210,6 +215,9 @@ void USBHost::usb_process() {
 
                     } while(0);
 
+                    if (deviceEvent) {
+                        deviceEvent.call();
+                    }
                     break;
 
                 // a td has been processed
@@ -187,6 +187,18 @@ public:
         }
     }
 
+    /**
+     * Attach a callback function called from the USB thread when a device has been connected or disconnected
+     *
+     * The callback is called after the USB thread has reset and addressed the new device,
+     * so the drivers can be connected to it from then on.
+     *
+     * @param fn callback function
+     */
+    inline void attachDeviceEvent(void (*fn)(void)) {
+        deviceEvent.attach(fn);
+    }
+
     /**
      * Instantiate to protect USB thread from accessing shared objects (USBConnectedDevices and Interfaces)
      */
@@ -277,6 +289,7 @@ private:
     } message_t;
 
     Thread usbThread;
+    FunctionPointer deviceEvent;
     void usb_process();
     static void usb_process_static(void const * arg);
     Mail<message_t, 10> mail_usb_event;
@@ -38,6 +38,41 @@
 */
 #define USBHOST_MSD                 1
 
+/*
+* Maximum number of blocks read by one READ(10) command of USBHostMSD
+*/
+#define USBHOST_MSD_MAX_READ_BLOCKS 128
+
+/*
+* Number of blocks of each of the two read-ahead buffers of USBHostMSD
+* A sequential read stream is served from the buffers, and the MSD thread
+* reads the next part of the stream into a buffer while the caller works.
+* 0 disables the read-ahead.
+*/
+#ifndef USBHOST_MSD_READ_AHEAD_BLOCKS
+#define USBHOST_MSD_READ_AHEAD_BLOCKS   64
+#endif
+
+/*
+* Maximum number of asynchronous reads queued to the MSD thread
+*/
+#define USBHOST_MSD_ASYNC_QUEUE     4
+
+/*
+* MSD thread stack size
+*/
+#define USBHOST_MSD_THREAD_STACK    (256*8)
+
+/*
+* TEST UNIT READY polling of USBHostMSD::init()
+* The wait between the tries starts at USBHOST_MSD_TUR_FIRST_WAIT_MS and is
+* doubled up to USBHOST_MSD_TUR_MAX_WAIT_MS. The device is given up when it is
+* not ready in USBHOST_MSD_TUR_TIMEOUT_MS.
+*/
+#define USBHOST_MSD_TUR_FIRST_WAIT_MS   2
+#define USBHOST_MSD_TUR_MAX_WAIT_MS     100
+#define USBHOST_MSD_TUR_TIMEOUT_MS      2000
+
 /*
 * Enable USBHostKeyboard
 */
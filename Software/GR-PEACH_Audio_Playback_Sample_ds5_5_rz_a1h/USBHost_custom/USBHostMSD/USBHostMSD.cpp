@@ -29,9 +29,21 @@
 #define GET_MAX_LUN             (0xFE)
 #define BO_MASS_STORAGE_RESET   (0xFF)
 
-USBHostMSD::USBHostMSD()
+#define RA_EMPTY                (1)
+#define RA_QUEUED               (2)
+
+USBHostMSD::USBHostMSD() : _thread(osPriorityAboveNormal, USBHOST_MSD_THREAD_STACK)
 {
     host = USBHost::getHostInst();
+    _thread_started = false;
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    for (int i = 0; i < 2; i++) {
+        _ra[i].buf = new uint8_t[USBHOST_MSD_READ_AHEAD_BLOCKS * 512];
+        _ra[i].state = RA_EMPTY;
+    }
+    _ra_next = 0;
+    _ra_last = 0;
+#endif
     msd_init();
 }
 
@@ -131,7 +143,8 @@ bool USBHostMSD::connect()
 
 int USBHostMSD::testUnitReady() {
     USB_DBG("Test unit ready");
-    return SCSITransfer(NULL, 6, DEVICE_TO_HOST, 0, 0);
+    uint8_t cmd[6] = {0x00,0,0,0,0,0};
+    return SCSITransfer(cmd, 6, DEVICE_TO_HOST, 0, 0);
 }
 
 
@@ -252,10 +265,11 @@ int USBHostMSD::SCSITransfer(uint8_t * cmd, uint8_t cmd_len, int flags, uint8_t
 
     USB_DBG("recv csw: status: %d", csw.Status);
 
-    // ModeSense?
+    // ModeSense? The sense data is read to clear the error, and the command fails
     if ((csw.Status == 1) && (cmd[0] != 0x03)) {
         USB_DBG("request mode sense");
-        return SCSIRequestSense();
+        SCSIRequestSense();
+        return 1;
     }
 
     // perform reset recovery
@@ -284,7 +298,7 @@ int USBHostMSD::SCSITransfer(uint8_t * cmd, uint8_t cmd_len, int flags, uint8_t
 }
 
 
-int USBHostMSD::dataTransfer(uint8_t * buf, uint32_t block, uint8_t nbBlock, int direction) {
+int USBHostMSD::dataTransfer(uint8_t * buf, uint32_t block, uint16_t nbBlock, int direction) {
     uint8_t cmd[10];
     memset(cmd,0,10);
     cmd[0] = (direction == DEVICE_TO_HOST) ? 0x28 : 0x2A;
@@ -297,7 +311,10 @@ int USBHostMSD::dataTransfer(uint8_t * buf, uint32_t block, uint8_t nbBlock, int
     cmd[7] = (nbBlock >> 8) & 0xff;
     cmd[8] = nbBlock & 0xff;
 
-    return SCSITransfer(cmd, 10, direction, buf, blockSize*nbBlock);
+    _io_lock.lock();
+    int res = SCSITransfer(cmd, 10, direction, buf, blockSize*nbBlock);
+    _io_lock.unlock();
+    return res;
 }
 
 int USBHostMSD::getMaxLun() {
@@ -316,26 +333,55 @@ int USBHostMSD::getMaxLun() {
 #define USB_BLOCK_DEVICE_ERROR_WRITE_PROTECTED    -5006 /*!< write protected */
 
 int USBHostMSD::init() {
-    uint16_t i, timeout = 10;
+    Timer timer;
+    uint32_t wait_ms = USBHOST_MSD_TUR_FIRST_WAIT_MS;
+    int tries = 1;
 
     _lock.lock();
-    getMaxLun();
-
-    for (i = 0; i < timeout; i++) {
-        Thread::wait(100);
-        if (!testUnitReady())
-            break;
+    if (!_thread_started) {
+        _thread.start(callback(this, &USBHostMSD::msd_process));
+        _thread_started = true;
+    }
+    if (_is_initialized) {
+        // The results of INQUIRY and READ CAPACITY are kept until the device is disconnected
+        _lock.unlock();
+        return BD_ERROR_OK;
     }
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    raFlush();
+    _ra_last = 0;
+#endif
 
-    if (i == timeout) {
-        return BD_ERROR_DEVICE_ERROR;
+    _io_lock.lock();
+    timer.start();
+    getMaxLun();
+
+    // Most of the devices are ready at once, so the first waits are short
+    while (testUnitReady() != 0) {
+        if (timer.read_ms() >= USBHOST_MSD_TUR_TIMEOUT_MS) {
+            USB_ERR("MSD [dev: %p] - not ready in %d ms", dev, timer.read_ms());
+            _io_lock.unlock();
+            _lock.unlock();
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        Thread::wait(wait_ms);
+        wait_ms = (wait_ms * 2 < USBHOST_MSD_TUR_MAX_WAIT_MS) ? (wait_ms * 2) : USBHOST_MSD_TUR_MAX_WAIT_MS;
+        tries++;
     }
+    int ready_us = timer.read_us();
 
     inquiry(0, 0);
-    if (readCapacity() != 0) {
+    int inquiry_us = timer.read_us();
+
+    // The first command after a reset may report a unit attention
+    if ((readCapacity() != 0) && (readCapacity() != 0)) {
+        _io_lock.unlock();
         _lock.unlock();
         return BD_ERROR_DEVICE_ERROR;
     }
+    USB_INFO("MSD [dev: %p] - init: ready %d us (%d tries), inquiry %d us, capacity %d us",
+             dev, ready_us, tries, inquiry_us - ready_us, timer.read_us() - inquiry_us);
+    _io_lock.unlock();
     _is_initialized = true;
     _lock.unlock();
 
@@ -357,6 +403,10 @@ int USBHostMSD::program(const void *b, bd_addr_t addr, bd_size_t size)
         _lock.unlock();
         return USB_BLOCK_DEVICE_ERROR_NO_INIT;
     }
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    // The read-ahead buffers may hold the old data
+    raFlush();
+#endif
 
     const uint8_t *buffer = static_cast<const uint8_t*>(b);
     while (size > 0) {
@@ -389,22 +439,181 @@ int USBHostMSD::read(void *b, bd_addr_t addr, bd_size_t size)
     }
 
     uint8_t *buffer = static_cast<uint8_t *>(b);
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    // The second sequential read of several blocks starts the read-ahead of the stream
+    bool stream = (addr == _ra_last) && (size >= 2 * 512);
+    bd_size_t n = raRead(buffer, addr, size);
+    buffer += n;
+    addr += n;
+    size -= n;
+    stream = stream && (size > 0);
+    if (stream) {
+        raFlush();
+    }
+#endif
+
+    if (readBlocks(buffer, addr, size)) {
+        _lock.unlock();
+        return BD_ERROR_DEVICE_ERROR;
+    }
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    _ra_last = addr + size;
+    if (stream) {
+        _ra_next = _ra_last;
+        raQueue(&_ra[0]);
+        raQueue(&_ra[1]);
+    }
+#endif
+    _lock.unlock();
+    return 0;
+}
+
+int USBHostMSD::readAsync(void *b, bd_addr_t addr, bd_size_t size, Callback<void(int)> cb)
+{
+    if (!is_valid_read(addr, size)) {
+        return USB_BLOCK_DEVICE_ERROR_PARAMETER;
+    }
+
+    _lock.lock();
+    if (!_is_initialized) {
+        _lock.unlock();
+        return USB_BLOCK_DEVICE_ERROR_NO_INIT;
+    }
+    int res = queueRead(static_cast<uint8_t *>(b), addr, size, cb);
+    _lock.unlock();
+    return res;
+}
+
+int USBHostMSD::queueRead(uint8_t * buf, bd_addr_t addr, bd_size_t size, Callback<void(int)> cb)
+{
+    AsyncRead *req = _async_mail.alloc();
+    if (req == NULL) {
+        return USB_BLOCK_DEVICE_ERROR_WOULD_BLOCK;
+    }
+    req->buf = buf;
+    req->addr = addr;
+    req->size = size;
+    req->cb = cb;
+    _async_mail.put(req);
+    return 0;
+}
+
+int USBHostMSD::readBlocks(uint8_t * buf, bd_addr_t addr, bd_size_t size)
+{
     while (size > 0) {
         bd_addr_t block = addr / 512;
+        bd_size_t nb = size / 512;
+        if (nb > USBHOST_MSD_MAX_READ_BLOCKS) {
+            nb = USBHOST_MSD_MAX_READ_BLOCKS;
+        }
 
-        // receive the data
-        if (dataTransfer((uint8_t*)buffer, block, 1, DEVICE_TO_HOST)) {
-            _lock.unlock();
+        // receive the data, several blocks by one command
+        if (dataTransfer(buf, block, (uint16_t)nb, DEVICE_TO_HOST)) {
             return BD_ERROR_DEVICE_ERROR;
         }
-        buffer += 512;
-        addr += 512;
-        size -= 512;
+        buf += nb * 512;
+        addr += nb * 512;
+        size -= nb * 512;
     }
-    _lock.unlock();
     return 0;
 }
 
+// MSD thread: issues the queued reads in order
+void USBHostMSD::msd_process()
+{
+    while (true) {
+        osEvent evt = _async_mail.get();
+        if (evt.status == osEventMail) {
+            AsyncRead *req = (AsyncRead *)evt.value.p;
+            int res = readBlocks(req->buf, req->addr, req->size);
+            Callback<void(int)> cb = req->cb;
+            _async_mail.free(req);
+            if (cb) {
+                cb(res);
+            }
+        }
+    }
+}
+
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+// Copies the head of a read from the read-ahead buffers, and reads the stream
+// ahead again into each buffer used up. Returns the number of bytes copied.
+bd_size_t USBHostMSD::raRead(uint8_t * buf, bd_addr_t addr, bd_size_t size)
+{
+    bd_size_t done = 0;
+
+    while (done < size) {
+        ReadAhead *ra = NULL;
+        for (int i = 0; i < 2; i++) {
+            if ((_ra[i].state != RA_EMPTY) && (addr >= _ra[i].addr) && (addr < (_ra[i].addr + _ra[i].size))) {
+                ra = &_ra[i];
+            }
+        }
+        if (ra == NULL) {
+            break;
+        }
+        if (ra->state == RA_QUEUED) {
+            ra->done.wait();
+            ra->state = ra->result;
+        }
+        if (ra->state != 0) {
+            // Read error: the rest is read again by the caller
+            raFlush();
+            break;
+        }
+
+        bd_size_t n = ra->addr + ra->size - addr;
+        if (n > (size - done)) {
+            n = size - done;
+        }
+        memcpy(buf + done, ra->buf + (addr - ra->addr), n);
+        addr += n;
+        done += n;
+        if (addr == (ra->addr + ra->size)) {
+            raQueue(ra);
+        }
+    }
+    return done;
+}
+
+void USBHostMSD::raQueue(ReadAhead * ra)
+{
+    bd_size_t end = size();
+
+    ra->state = RA_EMPTY;
+    if (_ra_next >= end) {
+        return;
+    }
+    ra->addr = _ra_next;
+    ra->size = USBHOST_MSD_READ_AHEAD_BLOCKS * 512;
+    if (ra->size > (end - _ra_next)) {
+        ra->size = end - _ra_next;
+    }
+    if (queueRead(ra->buf, ra->addr, ra->size, callback(&USBHostMSD::raDone, ra)) == 0) {
+        ra->state = RA_QUEUED;
+        _ra_next += ra->size;
+    }
+}
+
+// Waits for the queued read-ahead and discards the buffers
+void USBHostMSD::raFlush()
+{
+    for (int i = 0; i < 2; i++) {
+        if (_ra[i].state == RA_QUEUED) {
+            _ra[i].done.wait();
+        }
+        _ra[i].state = RA_EMPTY;
+    }
+}
+
+// Called from the MSD thread
+void USBHostMSD::raDone(ReadAhead * ra, int result)
+{
+    ra->result = result;
+    ra->done.release();
+}
+#endif
+
 int USBHostMSD::erase(bd_addr_t addr, bd_size_t size)
 {
     return 0;
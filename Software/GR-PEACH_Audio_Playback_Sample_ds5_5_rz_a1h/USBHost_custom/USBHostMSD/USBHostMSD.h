@@ -52,6 +52,10 @@ public:
     bool connect();
 
     /** Initialize a block device
+     *
+     *  TEST UNIT READY is retried with a growing wait until the device is ready.
+     *  The device stays initialized until it is disconnected, and init() returns
+     *  at once in the meantime.
      *
      *  @return         0 on success or a negative error code on failure
      */
@@ -72,6 +76,20 @@ public:
      */
     virtual int read(void *buffer, bd_addr_t addr, bd_size_t size);
 
+    /** Queue a read of blocks to the MSD thread
+     *
+     *  The MSD thread issues the queued reads in order, while the caller
+     *  keeps working. When a read is finished, the callback is called from
+     *  the MSD thread.
+     *
+     *  @param buffer   Buffer to write blocks to, kept until the callback
+     *  @param addr     Address of block to begin reading from
+     *  @param size     Size to read in bytes, must be a multiple of read block size
+     *  @param cb       Callback called with 0 on success or a negative error code
+     *  @return         0 if the read is queued, negative error code on failure
+     */
+    int readAsync(void *buffer, bd_addr_t addr, bd_size_t size, Callback<void(int)> cb);
+
     /** Program blocks to a block device
      *
      *  The blocks must have been erased prior to being programmed
@@ -161,13 +179,51 @@ private:
     CBW cbw;
     CSW csw;
     Mutex _lock;
+    Mutex _io_lock;     // Held during a SCSI command, by the caller or the MSD thread
+
+    // Read queued to the MSD thread
+    typedef struct {
+        uint8_t * buf;
+        bd_addr_t addr;
+        bd_size_t size;
+        Callback<void(int)> cb;
+    } AsyncRead;
+
+    Mail<AsyncRead, USBHOST_MSD_ASYNC_QUEUE> _async_mail;
+    Thread _thread;
+    bool _thread_started;
+
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    // Read-ahead buffer of a sequential read stream
+    typedef struct {
+        uint8_t * buf;
+        bd_addr_t addr;
+        bd_size_t size;
+        int state;          // RA_EMPTY, RA_QUEUED or the result of the read
+        int result;         // Set by the MSD thread before it releases done
+        Semaphore done;
+    } ReadAhead;
+
+    ReadAhead _ra[2];
+    bd_addr_t _ra_next;     // Address of the stream to be read ahead next
+    bd_addr_t _ra_last;     // End address of the last read
+
+    bd_size_t raRead(uint8_t * buf, bd_addr_t addr, bd_size_t size);
+    void raQueue(ReadAhead * ra);
+    void raFlush();
+    static void raDone(ReadAhead * ra, int result);
+#endif
+
+    int queueRead(uint8_t * buf, bd_addr_t addr, bd_size_t size, Callback<void(int)> cb);
+    int readBlocks(uint8_t * buf, bd_addr_t addr, bd_size_t size);
+    void msd_process();
 
     int SCSITransfer(uint8_t * cmd, uint8_t cmd_len, int flags, uint8_t * data, uint32_t transfer_len);
     int testUnitReady();
     int readCapacity();
     int inquiry(uint8_t lun, uint8_t page_code);
     int SCSIRequestSense();
-    int dataTransfer(uint8_t * buf, uint32_t block, uint8_t nbBlock, int direction);
+    int dataTransfer(uint8_t * buf, uint32_t block, uint16_t nbBlock, int direction);
     int checkResult(uint8_t res, USBEndpoint * ep);
     int getMaxLun();
 
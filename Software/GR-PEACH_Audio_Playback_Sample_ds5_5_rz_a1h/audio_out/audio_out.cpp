@@ -29,6 +29,9 @@
 #include "audio_out.h"
 #include "display.h"
 #include "TLV320_RBSP.h"
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+#include "ssif_api.h"
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
 
 /*--- Macro definition of mbed-rtos mail ---*/
 #define MAIL_QUEUE_SIZE     (12)    /* Queue size */
@@ -43,9 +46,13 @@
 
 /* mail_id = AUD_MAILID_DATA_OUT */
 #define MAIL_DATA_OUT_CB            (MAIL_PARAM0)   /* Callback function */
+#define MAIL_DATA_OUT_FREQ          (MAIL_PARAM1)   /* Sampling frequency */
 
 /* mail_id = AUD_MAILID_ZERO_OUT : No parameter */
 
+/* mail_id = AUD_MAILID_MUTE_OUT */
+#define MAIL_MUTE_OUT_CB            (MAIL_PARAM0)   /* Callback function */
+
 /* mail_id = AUD_MAILID_SCUX_READ_FIN */
 #define MAIL_SCUX_READ_RESULT       (MAIL_PARAM0)   /* Result of the process */
 #define MAIL_SCUX_READ_BUF_INDEX    (MAIL_PARAM1)   /* Index number of PCM buffer */
@@ -55,6 +62,10 @@
 #define MAIL_PCM_OUT_RESULT         (MAIL_PARAM0)   /* Result of the process */
 #define MAIL_PCM_OUT_BUF_INDEX      (MAIL_PARAM1)   /* Index number of PCM buffer */
 
+/* mail_id = AUD_MAILID_SET_VOLUME */
+#define MAIL_SET_VOLUME_GAIN        (MAIL_PARAM0)   /* Gain in dB */
+#define MAIL_SET_VOLUME_MUTE        (MAIL_PARAM1)   /* Mute */
+
 /*--- Macro definition of PCM buffer ---*/
 #define UNIT_TIME_MS                (10u)   /* Unit time of PCM data processing (ms) */
 #define SEC_TO_MSEC                 (1000u)
@@ -70,12 +81,40 @@
 #define PCM_BUF_NUM                 (DEC_SCUX_READ_NUM)
 #define TOTAL_SAMPLE_NUM            (SAMPLE_PER_UNIT_MS * DEC_OUTPUT_CHANNEL_NUM)
 
+/*--- Macro definition of the audio data for the display ---*/
+#define TAP_CHANNEL_NUM             (DEC_OUTPUT_CHANNEL_NUM)
+#define TAP_SAMPLE_SHIFT            (16u)   /* 24 bits data with 8 bits padding to 16 bits */
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+/* Frame number of the ring buffer. It must be a power of 2. */
+/* The decode thread stores a whole decoded buffer (up to 16384 frames) at once. */
+#define TAP_BUF_FRAME_NUM           (16384u)
+/* Maximum frame number stored at once. The older data of a longer buffer is not stored. */
+#define TAP_WRITE_FRAME_NUM         (TAP_BUF_FRAME_NUM / 2u)
+#else
+/* Frame number stored from 1 PCM buffer */
+#define TAP_WRITE_FRAME_NUM         (SAMPLE_PER_UNIT_MS / AUD_TAP_DECIMATION)
+/* Frame number of the ring buffer. It must be a power of 2. */
+#define TAP_BUF_FRAME_NUM           (2048u)
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+/* Advance of the write counter allowed during the copy. */
+/* The PCM buffer being stored is not counted yet, so it is subtracted. */
+#define TAP_READ_MARGIN(frame_num)  ((TAP_BUF_FRAME_NUM - (frame_num)) - TAP_WRITE_FRAME_NUM)
+
 /*--- Macro definition of TLV320_RBSP ---*/
 #define AUDIO_POWER_MIC_OFF         (0x02)  /* Microphone input :OFF */
 #define AUDIO_INT_LEVEL             (0x80)
 #define AUDIO_READ_NUM              (0)
 #define AUDIO_WRITE_NUM             (PCM_BUF_NUM)
+#define AUDIO_SSIF_SCK              (P4_4)
+#define AUDIO_SSIF_WS               (P4_5)
+#define AUDIO_SSIF_TX               (P4_7)
+#define AUDIO_SSIF_RX               (P4_6)
 #define ERR_MSG_TLV320_RBSP_WRITE   "\nError: TLV320_RBSP::write()\n"
+#define ERR_MSG_TLV320_RBSP_FREQ    "\nError: TLV320_RBSP::frequency()\n"
+#define ERR_MSG_SSIF_INIT           "\nError: ssif_init()\n"
+#define AUDIO_VOLUME_MIN_DB         (-73)   /* Headphone volume of 0.0 (mute) */
+#define AUDIO_VOLUME_MAX_DB         (6)     /* Headphone volume of 1.0 */
+#define AUDIO_VOLUME_ROUND          (0.5f)  /* TLV320_RBSP truncates the volume to 1dB step. */
 
 /* 4 bytes aligned. No cache memory. */
 #if defined(__ICCARM__)
@@ -90,8 +129,10 @@ typedef enum {
     AUD_MAILID_DUMMY = 0,
     AUD_MAILID_DATA_OUT,            /* Requests the output of PCM data. */
     AUD_MAILID_ZERO_OUT,            /* Requests the output of zero data. */
+    AUD_MAILID_MUTE_OUT,            /* Requests the mute and the stop of the output. */
     AUD_MAILID_SCUX_READ_FIN,       /* Finished the reading process of SCUX. */
     AUD_MAILID_PCM_OUT_FIN,         /* Finished the output of data. */
+    AUD_MAILID_SET_VOLUME,          /* Requests the setting of the volume. */
     AUD_MAILID_NUM
 } AUD_MAIL_ID;
 
@@ -110,12 +151,33 @@ typedef struct {
 } pcm_buf_ctrl_t;
 
 static Mail<aud_mail_t, MAIL_QUEUE_SIZE> mail_box;
-static TLV320_RBSP audio(P10_13, I2C_SDA, I2C_SCL, P4_4, P4_5, P4_7,
-                     P4_6, AUDIO_INT_LEVEL, AUDIO_WRITE_NUM, AUDIO_READ_NUM);
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+/* SCUX driver owns SSIF0 on the direct route and controls its clock and reset. */
+/* TLV320_RBSP is created without the SSIF pins, so it opens no SSIF channel */
+/* and only controls the audio codec through I2C. */
+static TLV320_RBSP audio(P10_13, I2C_SDA, I2C_SCL, NC, NC, NC, NC,
+                     AUDIO_INT_LEVEL, AUDIO_WRITE_NUM, AUDIO_READ_NUM);
+#else
+static TLV320_RBSP audio(P10_13, I2C_SDA, I2C_SCL, AUDIO_SSIF_SCK, AUDIO_SSIF_WS, AUDIO_SSIF_TX,
+                     AUDIO_SSIF_RX, AUDIO_INT_LEVEL, AUDIO_WRITE_NUM, AUDIO_READ_NUM);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+
+/* Ring buffer of the audio data for the display. */
+/* Only one thread writes it, and tap_wr_cnt is updated after the data. */
+/* It is the audio out thread, or the decode thread when DEC_SCUX_DIRECT_OUTPUT is 1. */
+static int16_t tap_buf[TAP_BUF_FRAME_NUM * TAP_CHANNEL_NUM];
+static volatile uint32_t tap_wr_cnt = 0u;  /* Total number of the stored frames */
+
+/* Soft mute of the audio codec. Only the audio out thread accesses them. */
+static bool vol_mute = false;   /* Mute by aud_set_volume() */
+static bool out_mute = false;   /* Mute by aud_req_mute_out() until the output restarts */
 
 static void init_pcm_buf(pcm_buf_ctrl_t * const p_ctrl);
+static void set_volume(const int32_t gain, const bool mute);
+static void set_out_mute(const bool mute);
 static bool read_scux(int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t buf_id);
 static bool write_audio(int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t buf_id);
+static void store_tap(const int32_t * const p_buf, const uint32_t sample_num);
 static void read_callback(void * p_data, int32_t result, void * p_app_data);
 static void pcm_out_callback(void * p_data, int32_t result, void * p_app_data);
 static bool send_mail(const AUD_MAIL_ID mail_id, const uint32_t param0, 
@@ -132,10 +194,14 @@ void aud_thread(void const *argument)
     uint32_t                    mail_param[MAIL_PARAM_NUM];
     bool                        result;
     AUD_CbDataOut               cb_data_out;
+    AUD_CbMuteOut               cb_mute_out;
+    uint32_t                    out_frame_cnt = 0u; /* Frames output from aud_req_data_out() */
+    uint32_t                    mute_buf_cnt = 0u;  /* PCM buffers in TLV320_RBSP to be muted */
     uint32_t                    i;
     uint32_t                    buf_id;
     int32_t                     *p_buf;
     uint32_t                    byte_cnt;
+    uint32_t                    output_freq;
 #if defined(__ICCARM__)
     static int32_t pcm_buf[PCM_BUF_NUM][TOTAL_SAMPLE_NUM] NC_BSS_SECT;
 #else
@@ -147,9 +213,17 @@ void aud_thread(void const *argument)
     /* Initializes the control data of PCM buffer. */
     init_pcm_buf(p_ctrl);
 
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+    /* Assigns the pins and the power of SSIF0 to which SCUX outputs. */
+    if (ssif_init(AUDIO_SSIF_SCK, AUDIO_SSIF_WS, AUDIO_SSIF_TX, AUDIO_SSIF_RX) == (int32_t)NC) {
+        /* Unexpected cases : Output error message to PC */
+        (void) dsp_notify_print_string(ERR_MSG_SSIF_INIT);
+    }
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
     /* Sets the output of PCM data using TLV320_RBSP. */
     (void) audio.format(DEC_OUTPUT_BITS_PER_SAMPLE);
     (void) audio.frequency(DEC_OUTPUT_SAMPLE_RATE);
+    output_freq = DEC_OUTPUT_SAMPLE_RATE;
     audio.power(AUDIO_POWER_MIC_OFF);
     while (1) {
         result = recv_mail(&mail_type, &mail_param[MAIL_PARAM0], 
@@ -159,15 +233,36 @@ void aud_thread(void const *argument)
                 case AUD_MAILID_DATA_OUT:        /* Requests the output of PCM data. */
                     cb_data_out = (AUD_CbDataOut)mail_param[MAIL_DATA_OUT_CB];
                     if (scux_read_enable != true) {
-                        scux_read_enable = true;
                         result = true;
-                        for (i = 0; (i < p_ctrl->pcm_buf_remain_cnt) && (result == true); i++) {
-                            buf_id = (p_ctrl->pcm_buf_index + i) % PCM_BUF_NUM;
-                            result = read_scux(&pcm_buf[buf_id], buf_id);
+                        if (mail_param[MAIL_DATA_OUT_FREQ] != output_freq) {
+                            /* Changes the sampling frequency while the output is stopped. */
+                            result = audio.frequency((int)mail_param[MAIL_DATA_OUT_FREQ]);
+                            if (result == true) {
+                                output_freq = mail_param[MAIL_DATA_OUT_FREQ];
+                            } else {
+                                /* Unexpected cases : Output error message to PC */
+                                (void) dsp_notify_print_string(ERR_MSG_TLV320_RBSP_FREQ);
+                            }
                         }
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                        /* SCUX outputs PCM data to SSIF directly. No data is read from SCUX. */
+                        /* SCUX was stopped after the mute, so no muted data remains. */
+                        if ((result == true) && (out_mute == true)) {
+                            set_out_mute(false);
+                        }
+#else
                         if (result == true) {
-                            p_ctrl->output_trg_cnt = OUTPUT_START_TRIGGER;
+                            scux_read_enable = true;
+                            out_frame_cnt = 0u;
+                            for (i = 0; (i < p_ctrl->pcm_buf_remain_cnt) && (result == true); i++) {
+                                buf_id = (p_ctrl->pcm_buf_index + i) % PCM_BUF_NUM;
+                                result = read_scux(&pcm_buf[buf_id], buf_id);
+                            }
+                            if (result == true) {
+                                p_ctrl->output_trg_cnt = OUTPUT_START_TRIGGER;
+                            }
                         }
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
                     } else {
                         result = false;
                     }
@@ -176,10 +271,23 @@ void aud_thread(void const *argument)
                 case AUD_MAILID_ZERO_OUT:        /* Requests the output of zero data. */
                     scux_read_enable = false;
                     break;
+                case AUD_MAILID_MUTE_OUT:        /* Requests the mute and the stop of the output. */
+                    cb_mute_out = (AUD_CbMuteOut)mail_param[MAIL_MUTE_OUT_CB];
+                    /* TLV320_RBSP can not cancel the queued data, so it is output muted. */
+                    set_out_mute(true);
+                    scux_read_enable = false;
+                    /* Discards the stocked data. The reading data is discarded when it finishes. */
+                    p_ctrl->pcm_stock_cnt = 0u;
+                    p_ctrl->output_trg_cnt = OUTPUT_START_TRIGGER;
+                    mute_buf_cnt = PCM_BUF_NUM - p_ctrl->pcm_buf_remain_cnt;
+                    cb_mute_out(out_frame_cnt);
+                    break;
                 case AUD_MAILID_SCUX_READ_FIN:   /* Finished the reading process of SCUX. */
                     buf_id = mail_param[MAIL_SCUX_READ_BUF_INDEX];
                     byte_cnt = mail_param[MAIL_SCUX_READ_BYTE_NUM];
-                    if ((buf_id < PCM_BUF_NUM) && (byte_cnt <= sizeof(pcm_buf[0]))) {
+                    if (scux_read_enable != true) {
+                        /* The output is stopped. The data is discarded. */
+                    } else if ((buf_id < PCM_BUF_NUM) && (byte_cnt <= sizeof(pcm_buf[0]))) {
                         if (byte_cnt < sizeof(pcm_buf[0])) {
                             /* End of stream */
                             /* Fills the remain area of PCM buffer with 0. */
@@ -187,6 +295,7 @@ void aud_thread(void const *argument)
                             (void) memset(p_buf, 0, sizeof(pcm_buf[0]) - byte_cnt);
                             p_ctrl->output_trg_cnt = OUTPUT_UPDATE_TRIGGER;
                         }
+                        store_tap(&pcm_buf[buf_id][0], TOTAL_SAMPLE_NUM);
                         p_ctrl->pcm_stock_cnt++;
                         if (p_ctrl->pcm_stock_cnt >= p_ctrl->output_trg_cnt) {
                             /* Starts the output of PCM data. */
@@ -202,6 +311,10 @@ void aud_thread(void const *argument)
                                 /* Unexpected cases : Output error message to PC */
                                 (void) dsp_notify_print_string(ERR_MSG_TLV320_RBSP_WRITE);
                             }
+                            if ((out_mute == true) && (mute_buf_cnt == 0u)) {
+                                /* No muted data remains before this data. */
+                                set_out_mute(false);
+                            }
                             p_ctrl->pcm_buf_index  = 
                                         (p_ctrl->pcm_buf_index + p_ctrl->pcm_stock_cnt) % PCM_BUF_NUM;
                             p_ctrl->pcm_stock_cnt  = 0u;
@@ -214,6 +327,17 @@ void aud_thread(void const *argument)
                     break;
                 case AUD_MAILID_PCM_OUT_FIN:     /* Finished the output of data. */
                     p_ctrl->pcm_buf_remain_cnt++;
+                    if (mute_buf_cnt > 0u) {
+                        /* The data written before the mute finished. */
+                        mute_buf_cnt--;
+                        if ((mute_buf_cnt == 0u) && (scux_read_enable == true) && 
+                            (p_ctrl->pcm_buf_remain_cnt < PCM_BUF_NUM)) {
+                            /* The data of the restarted output follows. */
+                            set_out_mute(false);
+                        }
+                    } else {
+                        out_frame_cnt += SAMPLE_PER_UNIT_MS;
+                    }
                     if ((int32_t)mail_param[MAIL_PCM_OUT_RESULT] == true) {
                         if (scux_read_enable == true) {
                             buf_id = mail_param[MAIL_PCM_OUT_BUF_INDEX];
@@ -224,6 +348,10 @@ void aud_thread(void const *argument)
                         (void) dsp_notify_print_string(ERR_MSG_TLV320_RBSP_WRITE);
                     }
                     break;
+                case AUD_MAILID_SET_VOLUME:      /* Requests the setting of the volume. */
+                    set_volume((int32_t)mail_param[MAIL_SET_VOLUME_GAIN], 
+                                (bool)mail_param[MAIL_SET_VOLUME_MUTE]);
+                    break;
                 default:
                     /* Unexpected cases : Output error message to PC */
                     (void) dsp_notify_print_string(ERR_MSG_RECV_ILLEGAL_MAIL);
@@ -233,12 +361,12 @@ void aud_thread(void const *argument)
     }
 }
 
-bool aud_req_data_out(const AUD_CbDataOut p_cb)
+bool aud_req_data_out(const AUD_CbDataOut p_cb, const uint32_t sample_freq)
 {
     bool    ret = false;
 
     if (p_cb != NULL) {
-        ret = send_mail(AUD_MAILID_DATA_OUT, (uint32_t)p_cb, MAIL_PARAM_NON, MAIL_PARAM_NON);
+        ret = send_mail(AUD_MAILID_DATA_OUT, (uint32_t)p_cb, sample_freq, MAIL_PARAM_NON);
     }
     return ret;
 }
@@ -251,11 +379,106 @@ bool aud_req_zero_out(void)
     return ret;
 }
 
-bool aud_get_audio_data(const AUD_CbAudioData p_cb, uint16_t * const p_buf)
+bool aud_req_mute_out(const AUD_CbMuteOut p_cb)
+{
+    bool    ret = false;
+
+    if (p_cb != NULL) {
+        ret = send_mail(AUD_MAILID_MUTE_OUT, (uint32_t)p_cb, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    }
+    return ret;
+}
+
+bool aud_set_volume(const int32_t gain, const bool mute)
+{
+    bool    ret = false;
+
+    ret = send_mail(AUD_MAILID_SET_VOLUME, (uint32_t)gain, (uint32_t)mute, MAIL_PARAM_NON);
+    return ret;
+}
+
+void aud_store_audio_data(const int32_t * const p_buf, const uint32_t sample_num)
 {
-    UNUSED_ARG(p_cb);
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+    store_tap(p_buf, sample_num);
+#else
+    /* The audio out thread stores the data read from SCUX. */
     UNUSED_ARG(p_buf);
-    return true;
+    UNUSED_ARG(sample_num);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+}
+
+bool aud_get_audio_data(const AUD_CbAudioData p_cb, int16_t * const p_buf, 
+                                                    const uint32_t buf_num)
+{
+    bool        ret = false;
+    bool        result = false;
+    uint32_t    frame_num;
+    uint32_t    end_cnt;
+    uint32_t    rd_pos;
+    uint32_t    i;
+    uint32_t    ch;
+
+    if ((p_cb != NULL) && (p_buf != NULL) && (buf_num >= TAP_CHANNEL_NUM) && 
+        (buf_num <= (AUD_TAP_MAX_FRAME_NUM * TAP_CHANNEL_NUM)) && 
+        ((buf_num % TAP_CHANNEL_NUM) == 0u)) {
+        ret = true;
+        frame_num = buf_num / TAP_CHANNEL_NUM;
+        end_cnt = tap_wr_cnt;
+        __DMB();
+        if (end_cnt >= frame_num) {
+            rd_pos = (end_cnt - frame_num) % TAP_BUF_FRAME_NUM;
+            for (i = 0u; i < frame_num; i++) {
+                for (ch = 0u; ch < TAP_CHANNEL_NUM; ch++) {
+                    p_buf[(i * TAP_CHANNEL_NUM) + ch] = tap_buf[(rd_pos * TAP_CHANNEL_NUM) + ch];
+                }
+                rd_pos = (rd_pos + 1u) % TAP_BUF_FRAME_NUM;
+            }
+            __DMB();
+            /* Checks that the copied area was not overwritten by the audio out thread. */
+            if ((tap_wr_cnt - end_cnt) <= TAP_READ_MARGIN(frame_num)) {
+                result = true;
+            }
+        }
+        p_cb(result, p_buf, buf_num, NULL, 0u);
+    }
+    return ret;
+}
+
+/** Sets the headphone volume of the audio codec
+ *
+ *  The audio codec changes the volume at zero crossing.
+ *
+ *  @param gain Gain in dB. It is limited to the range of the audio codec.
+ *  @param mute Mute. true is on.
+ */
+static void set_volume(const int32_t gain, const bool mute)
+{
+    float       vol;
+
+    if (gain <= AUDIO_VOLUME_MIN_DB) {
+        vol = 0.0f;
+    } else if (gain >= AUDIO_VOLUME_MAX_DB) {
+        vol = 1.0f;
+    } else {
+        vol = ((float)(gain - AUDIO_VOLUME_MIN_DB) + AUDIO_VOLUME_ROUND) / 
+                                (float)(AUDIO_VOLUME_MAX_DB - AUDIO_VOLUME_MIN_DB);
+    }
+    (void) audio.outputVolume(vol, vol);
+    vol_mute = mute;
+    audio.mute(vol_mute || out_mute);
+}
+
+/** Sets the soft mute of the audio codec for the stop of the output
+ *
+ *  The audio codec is muted while either aud_set_volume() or aud_req_mute_out() mutes it.
+ *
+ *  @param mute Mute. true is on.
+ */
+static void set_out_mute(const bool mute)
+{
+    out_mute = mute;
+    audio.mute(vol_mute || out_mute);
 }
 
 /** Initialises the control data of PCM buffer
@@ -322,6 +545,51 @@ static bool write_audio(int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_
     return ret;
 }
 
+/** Stores the output data for the display
+ *
+ *  The data is decimated by the average of AUD_TAP_DECIMATION frames
+ *  and converted to 16 bits.
+ *
+ *  @param p_buf Pointer to PCM buffer array.
+ *  @param sample_num Number of the samples in PCM buffer array.
+ */
+static void store_tap(const int32_t * const p_buf, const uint32_t sample_num)
+{
+    uint32_t    wr_cnt;
+    uint32_t    wr_pos;
+    uint32_t    frame_num;
+    uint32_t    i;
+    uint32_t    j;
+    uint32_t    ch;
+    int32_t     sum;
+
+    if (p_buf != NULL) {
+        wr_cnt = tap_wr_cnt;
+        /* Only the latest TAP_WRITE_FRAME_NUM frames are stored. */
+        frame_num = sample_num / (TAP_CHANNEL_NUM * AUD_TAP_DECIMATION);
+        if (frame_num > TAP_WRITE_FRAME_NUM) {
+            i = (frame_num - TAP_WRITE_FRAME_NUM) * (TAP_CHANNEL_NUM * AUD_TAP_DECIMATION);
+        } else {
+            i = 0u;
+        }
+        for (; (i + (TAP_CHANNEL_NUM * AUD_TAP_DECIMATION)) <= sample_num; 
+                                        i += (TAP_CHANNEL_NUM * AUD_TAP_DECIMATION)) {
+            wr_pos = (wr_cnt % TAP_BUF_FRAME_NUM) * TAP_CHANNEL_NUM;
+            for (ch = 0u; ch < TAP_CHANNEL_NUM; ch++) {
+                sum = 0;
+                for (j = 0u; j < AUD_TAP_DECIMATION; j++) {
+                    sum += p_buf[i + (j * TAP_CHANNEL_NUM) + ch] >> TAP_SAMPLE_SHIFT;
+                }
+                tap_buf[wr_pos + ch] = (int16_t)(sum / (int32_t)AUD_TAP_DECIMATION);
+            }
+            wr_cnt++;
+        }
+        /* Publishes the counter after the data. */
+        __DMB();
+        tap_wr_cnt = wr_cnt;
+    }
+}
+
 /** Callback function of SCUX driver
  *
  *  @param p_data Pointer to PCM byffer array.
@@ -29,10 +29,17 @@
 /*--- Macro definition ---*/
 #define AUD_STACK_SIZE     (2048u)      /* Stack size of Decode thread */
 
+/* Decimation ratio of the audio data for the display. The sampling rate of the data */
+/* got by aud_get_audio_data() is the output sampling rate divided by this value. */
+#define AUD_TAP_DECIMATION      (2u)
+/* Maximum number of frames got by aud_get_audio_data(). 1 frame is 2ch. */
+#define AUD_TAP_MAX_FRAME_NUM   (512u)
+
 /*--- User defined types ---*/
 typedef void (*AUD_CbDataOut)(const bool result);
-typedef void (*AUD_CbAudioData)( const bool result, uint16_t * const p_buf, 
-    const uint32_t buf_num, const uint32_t * const p_audio, const uint32_t audio_num);
+typedef void (*AUD_CbMuteOut)(const uint32_t frame_num);
+typedef void (*AUD_CbAudioData)( const bool result, int16_t * const p_buf, 
+    const uint32_t buf_num, const int32_t * const p_audio, const uint32_t audio_num);
 
 /** Audio Output Thread
  *
@@ -41,6 +48,8 @@ typedef void (*AUD_CbAudioData)( const bool result, uint16_t * const p_buf,
 void aud_thread(void const *argument);
 
 /** Requests the audio out thread to read the SCUX conversion results and output data.
+ *  When DEC_SCUX_DIRECT_OUTPUT is 1, SCUX outputs the data to SSIF directly and
+ *  the audio out thread only sets the sampling frequency of the audio codec.
  *
  *  @param p_cb Callback function for notifying the completion of data output preparation
  *              typedef void (*AUD_CbDataOut)( const bool result );
@@ -52,6 +61,9 @@ void aud_thread(void const *argument);
  *                  must be set up to notify the completion of processing after making settings
  *                  for reading SCUX data. The decode thread starts writing data to the SCUX upon
  *                  receipt of the completion notification through the callback function.
+ *  @param sample_freq Sampling frequency of audio output (Hz)
+ *                     The audio codec is reprogrammed when it differs from the current frequency.
+ *                     If the audio codec does not support it, result of p_cb is set to false.
  *
  *  @returns 
  *    Returns true if the API is successful. Returns false if the API fails.
@@ -60,7 +72,7 @@ void aud_thread(void const *argument);
  *     Failed to secure memory for mailbox communication.
  *     Failed to perform transmit processing for mailbox communication.
  */
-bool aud_req_data_out(const AUD_CbDataOut p_cb);
+bool aud_req_data_out(const AUD_CbDataOut p_cb, const uint32_t sample_freq);
 
 /** Requests the audio out thread to stop reading the SCUX conversion results and to generate silent output.
  *
@@ -72,7 +84,67 @@ bool aud_req_data_out(const AUD_CbDataOut p_cb);
  */
 bool aud_req_zero_out(void);
 
+/** Requests the audio out thread to mute the audio codec at once and to stop the output.
+ *
+ *  The data queued in the audio out thread is discarded. The data queued in the driver
+ *  of the audio codec is output muted. The mute is released when the data requested by
+ *  the next aud_req_data_out() is output after it.
+ *  The caller must stop SCUX after this function, so that the output stops before
+ *  the data in SCUX is discarded.
+ *
+ *  @param p_cb Callback function for notifying the completion of the mute
+ *              typedef void (*AUD_CbMuteOut)(const uint32_t frame_num);
+ *              When calling callback function specified in p_cb, specify the following
+ *              in the callback function argument frame_num:
+ *                frame_num : Number of the frames output before the mute since the last
+ *                            aud_req_data_out(). The data being output at the mute is not
+ *                            counted, so the data from this position has not been heard
+ *                            in full. When DEC_SCUX_DIRECT_OUTPUT is 1, it is always 0.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     The argument p_cb is set to NULL.
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool aud_req_mute_out(const AUD_CbMuteOut p_cb);
+
+/** Requests the audio out thread to set the headphone volume of the audio codec.
+ *
+ *  @param gain Gain in dB. It is limited to the range of the audio codec (-73 dB to +6 dB).
+ *              -73 dB mutes the headphone output.
+ *  @param mute Soft mute of the DAC. true is on.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool aud_set_volume(const int32_t gain, const bool mute);
+
+/** Stores the audio data written to SCUX for aud_get_audio_data().
+ *
+ *  It is used when DEC_SCUX_DIRECT_OUTPUT is 1, because the audio out thread does not
+ *  read the SCUX output then. Only the decode thread calls it. Otherwise it does nothing.
+ *  When p_buf holds more than (AUD_TAP_DECIMATION * 8192) frames, only the latest
+ *  frames are stored.
+ *
+ *  @param p_buf Pointer to the PCM data. 2ch interleaved, 24 bits data with 8 bits padding.
+ *  @param sample_num Elements number of the PCM data.
+ */
+void aud_store_audio_data(const int32_t * const p_buf, const uint32_t sample_num);
+
 /** Gets the audio data from the output thread.
+ *
+ *  The audio out thread stores the output data decimated by AUD_TAP_DECIMATION
+ *  in a ring buffer without a lock. This function copies the latest data from it
+ *  in the context of the caller, so the audio out thread is never blocked.
+ *  The callback function is called before this function returns.
+ *  When DEC_SCUX_DIRECT_OUTPUT is 1, the decode thread stores the data written to SCUX
+ *  by aud_store_audio_data() instead. The data is at the sampling rate of SCUX input and
+ *  is ahead of the output by the data queued in SCUX.
  *
  *  @param p_cb Callback function for notifying the completion of data acquisition
  *              typedef void (*AUD_CbAudioData)( const bool result, 
@@ -81,26 +153,30 @@ bool aud_req_zero_out(void);
  *              When calling callback function specified in p_cb, specify the following
  *              in the callback function arguments result, p_buf, buf_num, p_audio, and audio_num:
  *                result : Execution result; true = Success; false = Failure
+ *                         It fails when the output has not stored buf_num elements yet,
+ *                         or when the data was overwritten during the copy.
  *                p_buf : Pointer to the buffer for storing audio data
  *                        * Although the audio data output is 24 bits long, 16 bits of the data
- *                          are used for display.
+ *                          are used for display. The data is 2ch interleaved.
  *                        * The data that is specified in the second argument p_buf of this function
  *                          must be placed in p_buf of the callback function as is. 
  *                buf_num : Array size of the area pointed to by p_buf
  *                          * The data that is specified in the third argument buf_num of
  *                            this function must be placed in buf_num of the callback function as is.
- *                p_audio : 10 ms equivalent of audio data (88200 Hz, 2ch, 24 bits)
- *                audio_num : Array size of the area pointed to by p_audio
+ *                p_audio : Not used. NULL is set.
+ *                audio_num : Not used. 0 is set.
  *  @param p_buf Pointer to the buffer for storing audio data
+ *  @param buf_num Array size of the area pointed to by p_buf
+ *                 2 to (AUD_TAP_MAX_FRAME_NUM * 2). It must be a multiple of 2.
  *
  *  @returns 
  *    Returns true if the API is successful. Returns false if the API fails.
  *    This function fails when:
  *     The argument p_cb is set to NULL.
  *     The argument p_buf is set to NULL.
- *     Failed to secure memory for mailbox communication.
- *     Failed to perform transmit processing for mailbox communication.
+ *     The argument buf_num is out of range.
  */
-bool aud_get_audio_data(const AUD_CbAudioData p_cb, uint16_t * const p_buf);
+bool aud_get_audio_data(const AUD_CbAudioData p_cb, int16_t * const p_buf, 
+                                                    const uint32_t buf_num);
 
 #endif /* AUDIO_OUT_H */
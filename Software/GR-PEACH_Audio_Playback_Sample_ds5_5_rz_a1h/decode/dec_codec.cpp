@@ -0,0 +1,213 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "decode.h"
+#include "misratypes.h"
+#include "dec_codec.h"
+
+bool codec_set_pcm_buf(codec_ctrl_t * const p_codec_ctrl, 
+                        int32_t * const p_buf_addr, const uint32_t buf_num)
+{
+    bool        ret = false;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = pcm_set_pcm_buf(&p_codec_ctrl->pcm_ctrl, p_buf_addr, buf_num);
+        } else {
+            ret = flac_set_pcm_buf(&p_codec_ctrl->flac_ctrl, p_buf_addr, buf_num);
+        }
+    }
+    return ret;
+}
+
+uint32_t codec_get_pcm_cnt(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint32_t    ret = 0u;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = pcm_get_pcm_cnt(&p_codec_ctrl->pcm_ctrl);
+        } else {
+            ret = flac_get_pcm_cnt(&p_codec_ctrl->flac_ctrl);
+        }
+    }
+    return ret;
+}
+
+uint32_t codec_get_sample_rate(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint32_t    ret = 0u;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = p_codec_ctrl->pcm_ctrl.sample_rate;
+        } else {
+            ret = p_codec_ctrl->flac_ctrl.sample_rate;
+        }
+    }
+    return ret;
+}
+
+uint32_t codec_get_channel_num(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint32_t    ret = 0u;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = p_codec_ctrl->pcm_ctrl.channel_num;
+        } else {
+            ret = p_codec_ctrl->flac_ctrl.channel_num;
+        }
+    }
+    return ret;
+}
+
+uint64_t codec_get_decoded_sample(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint64_t    ret = 0uLL;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = p_codec_ctrl->pcm_ctrl.decoded_sample;
+        } else {
+            ret = p_codec_ctrl->flac_ctrl.decoded_sample;
+        }
+    }
+    return ret;
+}
+
+uint64_t codec_get_total_sample(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint64_t    ret = 0uLL;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = p_codec_ctrl->pcm_ctrl.total_sample;
+        } else {
+            ret = p_codec_ctrl->flac_ctrl.total_sample;
+        }
+    }
+    return ret;
+}
+
+uint32_t codec_get_play_time(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint32_t    play_time = 0u;
+    uint32_t    rate;
+
+    rate = codec_get_sample_rate(p_codec_ctrl);
+    if (rate > 0u) {    /* Prevents division by 0 */
+        play_time = (uint32_t)(codec_get_decoded_sample(p_codec_ctrl) / rate);
+    }
+    return play_time;
+}
+
+uint32_t codec_get_total_time(const codec_ctrl_t * const p_codec_ctrl)
+{
+    uint32_t    total_time = 0u;
+    uint32_t    rate;
+
+    rate = codec_get_sample_rate(p_codec_ctrl);
+    if (rate > 0u) {    /* Prevents division by 0 */
+        total_time = (uint32_t)(codec_get_total_sample(p_codec_ctrl) / rate);
+    }
+    return total_time;
+}
+
+int32_t codec_get_replay_gain(const codec_ctrl_t * const p_codec_ctrl)
+{
+    int32_t     replay_gain = 0;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_FLAC) {
+            replay_gain = flac_get_replay_gain(&p_codec_ctrl->flac_ctrl);
+        }
+    }
+    return replay_gain;
+}
+
+bool codec_set_position(codec_ctrl_t * const p_codec_ctrl, const uint64_t sample)
+{
+    bool        ret = false;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = pcm_set_position(&p_codec_ctrl->pcm_ctrl, sample);
+        } else {
+            ret = flac_set_position(&p_codec_ctrl->flac_ctrl, sample);
+        }
+    }
+    return ret;
+}
+
+bool codec_init(codec_ctrl_t * const p_codec_ctrl)
+{
+    bool        ret = false;
+    if (p_codec_ctrl != NULL) {
+        p_codec_ctrl->type = CODEC_TYPE_FLAC;
+        p_codec_ctrl->pcm_ctrl.p_kernel = NULL;
+        /* The buffers of FLAC decoder are allocated here, not by the track. */
+        ret = flac_init(&p_codec_ctrl->flac_ctrl);
+    }
+    return ret;
+}
+
+bool codec_open(FILE * const p_handle, codec_ctrl_t * const p_codec_ctrl)
+{
+    bool        ret = false;
+    bool        result;
+    uint8_t     head[PCM_HEADER_SIZE];
+    size_t      read_size;
+
+    if ((p_handle != NULL) && (p_codec_ctrl != NULL)) {
+        /* Sniffs the header, and rewinds the file for the backend. */
+        read_size = fread(&head[0], sizeof(uint8_t), sizeof(head), p_handle);
+        result = pcm_check_header(&head[0], (uint32_t)read_size);
+        if (fseek(p_handle, 0, SEEK_SET) == 0) {
+            if (result == true) {
+                p_codec_ctrl->type = CODEC_TYPE_PCM;
+                ret = pcm_open(p_handle, &p_codec_ctrl->pcm_ctrl);
+            } else {
+                p_codec_ctrl->type = CODEC_TYPE_FLAC;
+                ret = flac_open(p_handle, &p_codec_ctrl->flac_ctrl);
+            }
+        }
+    }
+    return ret;
+}
+
+bool codec_decode(codec_ctrl_t * const p_codec_ctrl)
+{
+    bool        ret = false;
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            ret = pcm_decode(&p_codec_ctrl->pcm_ctrl);
+        } else {
+            ret = flac_decode(&p_codec_ctrl->flac_ctrl);
+        }
+    }
+    return ret;
+}
+
+void codec_close(codec_ctrl_t * const p_codec_ctrl)
+{
+    if (p_codec_ctrl != NULL) {
+        if (p_codec_ctrl->type == CODEC_TYPE_PCM) {
+            pcm_close(&p_codec_ctrl->pcm_ctrl);
+        } else {
+            flac_close(&p_codec_ctrl->flac_ctrl);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_CODEC_H
+#define DEC_CODEC_H
+
+#include "r_typedefs.h"
+#include "dec_flac.h"
+#include "dec_pcm.h"
+
+/*--- User defined types ---*/
+/* Decoder backend */
+typedef enum {
+    CODEC_TYPE_FLAC = 0,        /* FLAC decoder library */
+    CODEC_TYPE_PCM,             /* WAV/AIFF */
+    CODEC_TYPE_NUM
+} CODEC_TYPE;
+
+/* Control data of the decoder of a track */
+/* The backend is selected by the header of the file, not by its extension. */
+typedef struct {
+    CODEC_TYPE              type;               /* Backend of the opened track */
+    flac_ctrl_t             flac_ctrl;          /* Control data of FLAC module */
+    pcm_ctrl_t              pcm_ctrl;           /* Control data of WAV/AIFF module */
+} codec_ctrl_t;
+
+/** Sets the PCM buffer to store decoded data
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *  @param p_buf_addr Pointer to PCM buffer to store decoded data.
+ *  @param buf_num Elements number of PCM buffer array.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool codec_set_pcm_buf(codec_ctrl_t * const p_codec_ctrl, 
+        int32_t * const p_buf_addr, const uint32_t buf_num);
+
+/** Gets elements number of the decoded data
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Elements number of the decoded data.
+ */
+uint32_t codec_get_pcm_cnt(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the sampling rate of the track
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Sampling rate in Hz.
+ */
+uint32_t codec_get_sample_rate(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the number of channels of the track
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Number of channels.
+ */
+uint32_t codec_get_channel_num(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the number of the decoded samples
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Position of the decoder in samples from the start of the track.
+ */
+uint64_t codec_get_decoded_sample(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the total number of samples of the track
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Total number of samples. 0 if it is unknown.
+ */
+uint64_t codec_get_total_sample(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the playback time
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Playback time (second).
+ */
+uint32_t codec_get_play_time(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets the total playback time
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Total playback time (second).
+ */
+uint32_t codec_get_total_time(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Gets ReplayGain of the track
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    ReplayGain (0.01dB unit). 0 if the file does not have the tag.
+ */
+int32_t codec_get_replay_gain(const codec_ctrl_t * const p_codec_ctrl);
+
+/** Sets the position to decode next
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *  @param sample Position in samples from the start of the track.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool codec_set_position(codec_ctrl_t * const p_codec_ctrl, const uint64_t sample);
+
+/** Initialises the decoder
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool codec_init(codec_ctrl_t * const p_codec_ctrl);
+
+/** Opens the decoder
+ *
+ *  The backend is selected by the header of the file. WAV and AIFF are read
+ *  by WAV/AIFF module, and the other files are decoded by FLAC module.
+ *
+ *  @param p_handle Pointer to the handle of the file.
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool codec_open(FILE * const p_handle, codec_ctrl_t * const p_codec_ctrl);
+
+/** Decode some audio frames.
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool codec_decode(codec_ctrl_t * const p_codec_ctrl);
+
+/** Close the decoder
+ *
+ *  @param p_codec_ctrl Pointer to the control data of the decoder.
+ */
+void codec_close(codec_ctrl_t * const p_codec_ctrl);
+
+#endif /* DEC_CODEC_H */
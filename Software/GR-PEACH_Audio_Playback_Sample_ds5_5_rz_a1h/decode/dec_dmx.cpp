@@ -0,0 +1,290 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "misratypes.h"
+#include "dec_dmx.h"
+
+/*--- Macro definition ---*/
+#define DMX_MIN_MIX_CH_NUM  (3u)                            /* Minimum channel number of downmix */
+#define DMX_MATRIX_NUM      ((DEC_MAX_CHANNEL_NUM - DMX_MIN_MIX_CH_NUM) + 1u)
+#define DMX_LEFT            (0u)                            /* Index of left output */
+#define DMX_RIGHT           (1u)                            /* Index of right output */
+#define DMX_MONO_CH_NUM     (1u)
+#define DMX_STEREO_CH_NUM   (2u)
+#define DMX_INTERNAL_BITS   (DEC_OUTPUT_BITS_PER_SAMPLE)    /* Bit count of the mixing */
+#define DMX_ROUND_VAL       ((int64_t)1 << (DMX_COEF_FRAC_BITS - 1))
+#define PCM_PADDING_BITS    (DEC_OUTPUT_PADDING_BITS)
+#define PCM_MAX_VAL         ((int32_t)0x007FFFFF)           /* Maximum value of 24bits data */
+#define PCM_MIN_VAL         ((int32_t)-0x00800000)          /* Minimum value of 24bits data */
+
+/* Downmix matrices of each channel layout (3ch to 8ch). */
+/* Center and surround are mixed at -3dB, back center at -6dB and LFE is discarded. */
+/* Each row is normalized so that a full scale input does not clip. */
+static dmx_matrix_t dmx_matrix_tbl[DMX_MATRIX_NUM] = {
+    /* 3ch : FL FR FC */
+    {{{19195,     0, 13573,     0,     0,     0,     0,     0},
+      {    0, 19195, 13573,     0,     0,     0,     0,     0}}},
+    /* 4ch : FL FR BL BR */
+    {{{19195,     0, 13573,     0,     0,     0,     0,     0},
+      {    0, 19195,     0, 13573,     0,     0,     0,     0}}},
+    /* 5ch : FL FR FC BL BR */
+    {{{13572,     0,  9598,  9598,     0,     0,     0,     0},
+      {    0, 13572,  9598,     0,  9598,     0,     0,     0}}},
+    /* 6ch : FL FR FC LFE BL BR */
+    {{{13572,     0,  9598,     0,  9598,     0,     0,     0},
+      {    0, 13572,  9598,     0,     0,  9598,     0,     0}}},
+    /* 7ch : FL FR FC LFE BC SL SR */
+    {{{11244,     0,  7951,     0,  5622,  7951,     0,     0},
+      {    0, 11244,  7951,     0,  5622,     0,  7951,     0}}},
+    /* 8ch : FL FR FC LFE BL BR SL SR */
+    {{{10498,     0,  7423,     0,  7423,     0,  7423,     0},
+      {    0, 10498,  7423,     0,     0,  7423,     0,  7423}}}
+};
+
+static void kernel_mono(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_stereo(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_3ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_4ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_5ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_6ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_7ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static void kernel_8ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+static inline void mix_kernel(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, 
+        const uint32_t sample_num, const uint32_t ch_num);
+static inline int32_t saturate_pcm(const int64_t acc);
+
+/* Kernels of each channel number (1ch to 8ch) */
+static const dmx_kernel_t kernel_tbl[DEC_MAX_CHANNEL_NUM] = {
+    &kernel_mono, &kernel_stereo, &kernel_3ch, &kernel_4ch,
+    &kernel_5ch,  &kernel_6ch,    &kernel_7ch, &kernel_8ch
+};
+
+bool dmx_set_matrix(const uint32_t channel_num, const dmx_matrix_t * const p_matrix)
+{
+    bool        ret = false;
+
+    if ((p_matrix != NULL) && 
+        (channel_num >= DMX_MIN_MIX_CH_NUM) && (channel_num <= DEC_MAX_CHANNEL_NUM)) {
+        dmx_matrix_tbl[channel_num - DMX_MIN_MIX_CH_NUM] = *p_matrix;
+        ret = true;
+    }
+    return ret;
+}
+
+bool dmx_set_cfg(dmx_ctrl_t * const p_dmx_ctrl, 
+        const uint32_t channel_num, const uint32_t bits_per_sample)
+{
+    bool        ret = false;
+
+    if (p_dmx_ctrl == NULL) {
+        /* Error : NULL pointer */
+    } else if ((channel_num < DMX_MONO_CH_NUM) || (channel_num > DEC_MAX_CHANNEL_NUM)) {
+        /* Error : Channel number is illegal specification */
+    } else if ((bits_per_sample < DEC_MIN_BITS_PER_SAMPLE) || 
+               (bits_per_sample > DEC_MAX_BITS_PER_SAMPLE)) {
+        /* Error : Bit per sample is illegal specification */
+    } else {
+        p_dmx_ctrl->p_kernel = kernel_tbl[channel_num - 1u];
+        p_dmx_ctrl->channel_num = channel_num;
+        if (bits_per_sample > DMX_INTERNAL_BITS) {
+            /* The lower bits which exceed 24bits are discarded. */
+            p_dmx_ctrl->in_rshift = bits_per_sample - DMX_INTERNAL_BITS;
+            p_dmx_ctrl->in_lshift = 0u;
+        } else {
+            p_dmx_ctrl->in_rshift = 0u;
+            p_dmx_ctrl->in_lshift = DMX_INTERNAL_BITS - bits_per_sample;
+        }
+        if (channel_num >= DMX_MIN_MIX_CH_NUM) {
+            p_dmx_ctrl->matrix = dmx_matrix_tbl[channel_num - DMX_MIN_MIX_CH_NUM];
+        }
+        ret = true;
+    }
+    return ret;
+}
+
+uint32_t dmx_convert(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    uint32_t    ret = 0u;
+
+    if ((p_dmx_ctrl != NULL) && (p_dmx_ctrl->p_kernel != NULL) && 
+        (p_in != NULL) && (p_out != NULL)) {
+        p_dmx_ctrl->p_kernel(p_dmx_ctrl, p_in, p_out, sample_num);
+        ret = sample_num * DEC_OUTPUT_CHANNEL_NUM;
+    }
+    return ret;
+}
+
+/** Kernel of 1ch input. The channel is copied to both outputs.
+ *
+ *  @param p_dmx_ctrl Pointer to the control data of downmix.
+ *  @param p_in Array of pointers to the decoded data of each channel.
+ *  @param p_out Pointer to PCM buffer.
+ *  @param sample_num Number of samples per channel.
+ */
+static void kernel_mono(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    const int32_t   * const p_ch0 = p_in[0];
+    const uint32_t  rshift = p_dmx_ctrl->in_rshift;
+    const uint32_t  lshift = p_dmx_ctrl->in_lshift + PCM_PADDING_BITS;
+    int32_t         data;
+    uint32_t        i;
+
+    for (i = 0u; i < sample_num; i++) {
+        data = (int32_t)((uint32_t)(p_ch0[i] >> rshift) << lshift);
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_LEFT]  = data;
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_RIGHT] = data;
+    }
+}
+
+/** Kernel of 2ch input. The channels are interleaved.
+ *
+ *  @param p_dmx_ctrl Pointer to the control data of downmix.
+ *  @param p_in Array of pointers to the decoded data of each channel.
+ *  @param p_out Pointer to PCM buffer.
+ *  @param sample_num Number of samples per channel.
+ */
+static void kernel_stereo(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    const int32_t   * const p_ch0 = p_in[0];
+    const int32_t   * const p_ch1 = p_in[1];
+    const uint32_t  rshift = p_dmx_ctrl->in_rshift;
+    const uint32_t  lshift = p_dmx_ctrl->in_lshift + PCM_PADDING_BITS;
+    uint32_t        i;
+
+    for (i = 0u; i < sample_num; i++) {
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_LEFT]  = 
+                                (int32_t)((uint32_t)(p_ch0[i] >> rshift) << lshift);
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_RIGHT] = 
+                                (int32_t)((uint32_t)(p_ch1[i] >> rshift) << lshift);
+    }
+}
+
+/* Kernels of 3ch to 8ch input. The channel number is a constant in each kernel, */
+/* so that the channel loop of mix_kernel is unrolled by the compiler. */
+static void kernel_3ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 3u);
+}
+
+static void kernel_4ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 4u);
+}
+
+static void kernel_5ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 5u);
+}
+
+static void kernel_6ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 6u);
+}
+
+static void kernel_7ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 7u);
+}
+
+static void kernel_8ch(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num)
+{
+    mix_kernel(p_dmx_ctrl, p_in, p_out, sample_num, 8u);
+}
+
+/** Downmixes multichannel input to the interleaved stereo PCM data
+ *
+ *  @param p_dmx_ctrl Pointer to the control data of downmix.
+ *  @param p_in Array of pointers to the decoded data of each channel.
+ *  @param p_out Pointer to PCM buffer.
+ *  @param sample_num Number of samples per channel.
+ *  @param ch_num Number of input channels.
+ */
+static inline void mix_kernel(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, 
+        const uint32_t sample_num, const uint32_t ch_num)
+{
+    const int32_t   * const p_coef_l = p_dmx_ctrl->matrix.coef[DMX_LEFT];
+    const int32_t   * const p_coef_r = p_dmx_ctrl->matrix.coef[DMX_RIGHT];
+    const uint32_t  rshift = p_dmx_ctrl->in_rshift;
+    const uint32_t  lshift = p_dmx_ctrl->in_lshift;
+    int64_t         acc_l;
+    int64_t         acc_r;
+    int32_t         data;
+    uint32_t        i;
+    uint32_t        ch;
+
+    for (i = 0u; i < sample_num; i++) {
+        acc_l = DMX_ROUND_VAL;
+        acc_r = DMX_ROUND_VAL;
+        for (ch = 0u; ch < ch_num; ch++) {
+            data = (int32_t)((uint32_t)(p_in[ch][i] >> rshift) << lshift);
+            acc_l += (int64_t)p_coef_l[ch] * data;
+            acc_r += (int64_t)p_coef_r[ch] * data;
+        }
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_LEFT]  = 
+                    (int32_t)((uint32_t)saturate_pcm(acc_l) << PCM_PADDING_BITS);
+        p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + DMX_RIGHT] = 
+                    (int32_t)((uint32_t)saturate_pcm(acc_r) << PCM_PADDING_BITS);
+    }
+}
+
+/** Scales the mixed data to 24bits and saturates it
+ *
+ *  @param acc Mixed data. (24bits data multiplied by Q15 coefficients)
+ *
+ *  @returns 
+ *    24bits data.
+ */
+static inline int32_t saturate_pcm(const int64_t acc)
+{
+    int64_t     data;
+    int32_t     ret;
+
+    data = acc >> DMX_COEF_FRAC_BITS;
+    if (data > PCM_MAX_VAL) {
+        ret = PCM_MAX_VAL;
+    } else if (data < PCM_MIN_VAL) {
+        ret = PCM_MIN_VAL;
+    } else {
+        ret = (int32_t)data;
+    }
+    return ret;
+}
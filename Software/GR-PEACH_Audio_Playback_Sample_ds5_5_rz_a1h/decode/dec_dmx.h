@@ -0,0 +1,100 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_DMX_H
+#define DEC_DMX_H
+
+#include "r_typedefs.h"
+#include "decode.h"
+
+/*--- Macro definition ---*/
+#define DMX_COEF_FRAC_BITS      (15)        /* Coefficients of downmix matrix are Q15 */
+#define DMX_COEF_UNITY          (32768)     /* 1.0 in Q15 */
+
+/*--- User defined types ---*/
+/* Downmix matrix. coef[output channel][input channel] in Q15. */
+/* The order of the input channels is the FLAC channel assignment. */
+/*   3ch : FL FR FC                      4ch : FL FR BL BR        */
+/*   5ch : FL FR FC BL BR                6ch : FL FR FC LFE BL BR */
+/*   7ch : FL FR FC LFE BC SL SR         8ch : FL FR FC LFE BL BR SL SR */
+typedef struct {
+    int32_t                 coef[DEC_OUTPUT_CHANNEL_NUM][DEC_MAX_CHANNEL_NUM];
+} dmx_matrix_t;
+
+typedef struct dmx_ctrl_st dmx_ctrl_t;
+
+/* Kernel which converts one block of the decoder output */
+typedef void (*dmx_kernel_t)(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+
+/* Control data of downmix */
+struct dmx_ctrl_st {
+    dmx_kernel_t            p_kernel;           /* Kernel for the channel layout */
+    uint32_t                channel_num;        /* Number of input channels */
+    uint32_t                in_rshift;          /* Right shift to adjust input to 24bits */
+    uint32_t                in_lshift;          /* Left shift to adjust input to 24bits */
+    dmx_matrix_t            matrix;             /* Downmix matrix */
+};
+
+/** Replaces the downmix matrix of the channel layout
+ *
+ *  The matrix is applied from the next call of dmx_set_cfg.
+ *
+ *  @param channel_num Number of input channels. (3 to DEC_MAX_CHANNEL_NUM)
+ *  @param p_matrix Pointer to the downmix matrix.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool dmx_set_matrix(const uint32_t channel_num, const dmx_matrix_t * const p_matrix);
+
+/** Selects the kernel for the input format
+ *
+ *  @param p_dmx_ctrl Pointer to the control data of downmix.
+ *  @param channel_num Number of input channels. (1 to DEC_MAX_CHANNEL_NUM)
+ *  @param bits_per_sample Bit count per sample of input. 
+ *                         (DEC_MIN_BITS_PER_SAMPLE to DEC_MAX_BITS_PER_SAMPLE)
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool dmx_set_cfg(dmx_ctrl_t * const p_dmx_ctrl, 
+        const uint32_t channel_num, const uint32_t bits_per_sample);
+
+/** Converts the decoder output to the interleaved stereo PCM data
+ *
+ *  Downmix, adjustment of the bit count and interleave are done in one pass.
+ *
+ *  @param p_dmx_ctrl Pointer to the control data of downmix.
+ *  @param p_in Array of pointers to the decoded data of each channel.
+ *  @param p_out Pointer to PCM buffer. (2ch interleaved, 24bits data with 8bits padding)
+ *               The buffer needs (sample_num * DEC_OUTPUT_CHANNEL_NUM) elements.
+ *  @param sample_num Number of samples per channel.
+ *
+ *  @returns 
+ *    Elements number of PCM data written in p_out.
+ */
+uint32_t dmx_convert(const dmx_ctrl_t * const p_dmx_ctrl, 
+        const int32_t * const p_in[], int32_t * const p_out, const uint32_t sample_num);
+
+#endif /* DEC_DMX_H */
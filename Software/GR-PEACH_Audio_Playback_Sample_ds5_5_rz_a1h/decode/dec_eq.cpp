@@ -0,0 +1,424 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "misratypes.h"
+#include "decode.h"
+#include "dec_eq.h"
+
+/*--- Macro definition ---*/
+#define EQ_COEF_FRAC_BITS   (28)                            /* Coefficients are Q28 */
+#define EQ_COEF_MAX         (7.99f)                         /* Maximum absolute value of coefficients */
+#define EQ_ROUND_VAL        ((int64_t)1 << (EQ_COEF_FRAC_BITS - 1))
+#define EQ_FADE_SHIFT       (10)
+#define EQ_FADE_FRAME_NUM   (1u << EQ_FADE_SHIFT)           /* Crossfade length in frames */
+#define EQ_CH_L             (0u)
+#define EQ_CH_R             (1u)
+#define EQ_ST_1             (0u)                            /* Index of the state s1 */
+#define EQ_ST_2             (1u)                            /* Index of the state s2 */
+#define EQ_GAIN_UNIT        (10.0f)                         /* gain is 0.1dB unit */
+#define EQ_Q_UNIT           (100.0f)                        /* q is 0.01 unit */
+#define EQ_PI               (3.14159265f)
+#define PCM_PADDING_BITS    (DEC_OUTPUT_PADDING_BITS)
+#define PCM_MAX_VAL         ((int32_t)0x007FFFFF)           /* Maximum value of 24bits data */
+#define PCM_MIN_VAL         ((int32_t)-0x00800000)          /* Minimum value of 24bits data */
+
+static bool start_fade(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param);
+static void copy_param(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param);
+static bool check_param(const eq_param_t * const p_param, const uint32_t sample_rate);
+static bool calc_filter(eq_filter_t * const p_flt, 
+                const eq_param_t * const p_param, const uint32_t sample_rate);
+static bool calc_coef(eq_coef_t * const p_coef, 
+                const eq_band_t * const p_band, const uint32_t sample_rate);
+static bool to_fixed(int32_t * const p_fixed, const float val);
+static inline void filter_frame(eq_filter_t * const p_flt, int32_t * const p_l, int32_t * const p_r);
+static inline int32_t saturate_pcm(const int64_t acc);
+
+void eq_init(eq_ctrl_t * const p_eq_ctrl)
+{
+    if (p_eq_ctrl != NULL) {
+        (void) memset(p_eq_ctrl, 0, sizeof(eq_ctrl_t));
+        p_eq_ctrl->param.band_num = 0u;
+    }
+}
+
+bool eq_set_rate(eq_ctrl_t * const p_eq_ctrl, const uint32_t sample_rate)
+{
+    bool        ret = false;
+
+    if ((p_eq_ctrl != NULL) && (sample_rate > 0u)) {
+        p_eq_ctrl->sample_rate = sample_rate;
+        p_eq_ctrl->fade_cnt = 0u;
+        p_eq_ctrl->is_pending = false;
+        ret = calc_filter(&p_eq_ctrl->cur, &p_eq_ctrl->param, sample_rate);
+        if (ret != true) {
+            /* The parameter does not suit the sampling rate. Bypasses the equalizer. */
+            p_eq_ctrl->cur.stage_num = 0u;
+        }
+        (void) memset(p_eq_ctrl->cur.state, 0, sizeof(p_eq_ctrl->cur.state));
+    }
+    return ret;
+}
+
+bool eq_set_param(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param)
+{
+    bool        ret = false;
+
+    if (p_eq_ctrl == NULL) {
+        /* Error : NULL pointer */
+    } else if (p_eq_ctrl->sample_rate == 0u) {
+        /* The coefficients are calculated by eq_set_rate. */
+        copy_param(p_eq_ctrl, p_param);
+        ret = true;
+    } else if (p_eq_ctrl->fade_cnt > 0u) {
+        /* Cutting the crossfade in progress would step the output. */
+        /* The new parameter is faded in by eq_process after it. */
+        ret = check_param(p_param, p_eq_ctrl->sample_rate);
+        if (ret == true) {
+            copy_param(p_eq_ctrl, p_param);
+            p_eq_ctrl->is_pending = true;
+        }
+    } else {
+        ret = start_fade(p_eq_ctrl, p_param);
+        if (ret == true) {
+            copy_param(p_eq_ctrl, p_param);
+        }
+    }
+    return ret;
+}
+
+void eq_process(eq_ctrl_t * const p_eq_ctrl, int32_t * const p_buf, const uint32_t sample_num)
+{
+    uint32_t    i;
+    int32_t     cur_l;
+    int32_t     cur_r;
+    int32_t     next_l;
+    int32_t     next_r;
+    int32_t     weight;
+
+    if ((p_eq_ctrl != NULL) && (p_buf != NULL)) {
+        /* The PCM buffer is not cached, so all stages are applied in one pass over it. */
+        for (i = 0u; ((i + EQ_CHANNEL_NUM) <= sample_num) && (p_eq_ctrl->fade_cnt > 0u); 
+                                                                    i += EQ_CHANNEL_NUM) {
+            cur_l = p_buf[i + EQ_CH_L] >> PCM_PADDING_BITS;
+            cur_r = p_buf[i + EQ_CH_R] >> PCM_PADDING_BITS;
+            next_l = cur_l;
+            next_r = cur_r;
+            filter_frame(&p_eq_ctrl->cur, &cur_l, &cur_r);
+            filter_frame(&p_eq_ctrl->next, &next_l, &next_r);
+            weight = (int32_t)(EQ_FADE_FRAME_NUM - p_eq_ctrl->fade_cnt);
+            cur_l += (int32_t)(((int64_t)(next_l - cur_l) * weight) >> EQ_FADE_SHIFT);
+            cur_r += (int32_t)(((int64_t)(next_r - cur_r) * weight) >> EQ_FADE_SHIFT);
+            p_buf[i + EQ_CH_L] = (int32_t)((uint32_t)cur_l << PCM_PADDING_BITS);
+            p_buf[i + EQ_CH_R] = (int32_t)((uint32_t)cur_r << PCM_PADDING_BITS);
+            p_eq_ctrl->fade_cnt--;
+            if (p_eq_ctrl->fade_cnt == 0u) {
+                p_eq_ctrl->cur = p_eq_ctrl->next;
+                if (p_eq_ctrl->is_pending == true) {
+                    p_eq_ctrl->is_pending = false;
+                    (void) start_fade(p_eq_ctrl, &p_eq_ctrl->param);
+                }
+            }
+        }
+        if (p_eq_ctrl->cur.stage_num > 0u) {
+            for (; (i + EQ_CHANNEL_NUM) <= sample_num; i += EQ_CHANNEL_NUM) {
+                cur_l = p_buf[i + EQ_CH_L] >> PCM_PADDING_BITS;
+                cur_r = p_buf[i + EQ_CH_R] >> PCM_PADDING_BITS;
+                filter_frame(&p_eq_ctrl->cur, &cur_l, &cur_r);
+                p_buf[i + EQ_CH_L] = (int32_t)((uint32_t)cur_l << PCM_PADDING_BITS);
+                p_buf[i + EQ_CH_R] = (int32_t)((uint32_t)cur_r << PCM_PADDING_BITS);
+            }
+        }
+    }
+}
+
+/** Starts the crossfade to the filter of the parameter
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ *  @param p_param Pointer to the parameter. NULL is the bypass.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool start_fade(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param)
+{
+    bool        ret;
+
+    ret = calc_filter(&p_eq_ctrl->next, p_param, p_eq_ctrl->sample_rate);
+    if (ret == true) {
+        /* Starts the new filter from the current state to reduce the transient. */
+        (void) memcpy(p_eq_ctrl->next.state, p_eq_ctrl->cur.state, sizeof(p_eq_ctrl->next.state));
+        p_eq_ctrl->fade_cnt = EQ_FADE_FRAME_NUM;
+    }
+    return ret;
+}
+
+/** Copies the parameter into the control data
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ *  @param p_param Pointer to the parameter. NULL is the bypass.
+ */
+static void copy_param(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param)
+{
+    if (p_param == NULL) {
+        p_eq_ctrl->param.band_num = 0u;
+    } else {
+        p_eq_ctrl->param = *p_param;
+    }
+}
+
+/** Checks that the coefficients of all stages can be calculated
+ *
+ *  @param p_param Pointer to the parameter. NULL is the bypass.
+ *  @param sample_rate Sampling rate in Hz.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool check_param(const eq_param_t * const p_param, const uint32_t sample_rate)
+{
+    bool        ret = false;
+    eq_coef_t   coef;
+    uint32_t    i;
+
+    if (p_param == NULL) {
+        ret = true;
+    } else if (p_param->band_num > EQ_MAX_STAGE_NUM) {
+        /* Error : Number of bands is illegal specification */
+    } else {
+        ret = true;
+        for (i = 0u; (i < p_param->band_num) && (ret == true); i++) {
+            ret = calc_coef(&coef, &p_param->band[i], sample_rate);
+        }
+    }
+    return ret;
+}
+
+/** Calculates the coefficients of all stages
+ *
+ *  @param p_flt Pointer to the filter to store the coefficients.
+ *  @param p_param Pointer to the parameter. NULL is the bypass.
+ *  @param sample_rate Sampling rate in Hz.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool calc_filter(eq_filter_t * const p_flt, 
+                const eq_param_t * const p_param, const uint32_t sample_rate)
+{
+    bool        ret = false;
+    uint32_t    i;
+
+    if (p_flt == NULL) {
+        /* Error : NULL pointer */
+    } else if (p_param == NULL) {
+        p_flt->stage_num = 0u;
+        ret = true;
+    } else if (p_param->band_num > EQ_MAX_STAGE_NUM) {
+        /* Error : Number of bands is illegal specification */
+    } else {
+        ret = true;
+        for (i = 0u; (i < p_param->band_num) && (ret == true); i++) {
+            ret = calc_coef(&p_flt->coef[i], &p_param->band[i], sample_rate);
+        }
+        if (ret == true) {
+            p_flt->stage_num = p_param->band_num;
+        }
+    }
+    return ret;
+}
+
+/** Calculates the coefficients of a biquad (Audio EQ Cookbook by R. Bristow-Johnson)
+ *
+ *  @param p_coef Pointer to the coefficients.
+ *  @param p_band Pointer to the parameter of a band.
+ *  @param sample_rate Sampling rate in Hz.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool calc_coef(eq_coef_t * const p_coef, 
+                const eq_band_t * const p_band, const uint32_t sample_rate)
+{
+    bool        ret = false;
+    float       amp;
+    float       sqrt_amp;
+    float       w0_cos;
+    float       alpha;
+    float       b0;
+    float       b1;
+    float       b2;
+    float       a0;
+    float       a1;
+    float       a2;
+
+    if ((p_coef == NULL) || (p_band == NULL)) {
+        /* Error : NULL pointer */
+    } else if ((p_band->type >= EQ_TYPE_NUM) || 
+               (p_band->freq == 0u) || ((p_band->freq * 2u) >= sample_rate) ||
+               (p_band->gain < EQ_MIN_GAIN) || (p_band->gain > EQ_MAX_GAIN) ||
+               (p_band->q < EQ_MIN_Q) || (p_band->q > EQ_MAX_Q)) {
+        /* Error : Parameter is illegal specification */
+    } else {
+        amp = powf(10.0f, ((float)p_band->gain / EQ_GAIN_UNIT) / 40.0f);
+        sqrt_amp = sqrtf(amp);
+        w0_cos = cosf((2.0f * EQ_PI * (float)p_band->freq) / (float)sample_rate);
+        alpha = sinf((2.0f * EQ_PI * (float)p_band->freq) / (float)sample_rate) / 
+                                        (2.0f * ((float)p_band->q / EQ_Q_UNIT));
+        switch (p_band->type) {
+            case EQ_TYPE_LOW_SHELF:
+                b0 = amp * (((amp + 1.0f) - ((amp - 1.0f) * w0_cos)) + (2.0f * sqrt_amp * alpha));
+                b1 = 2.0f * amp * ((amp - 1.0f) - ((amp + 1.0f) * w0_cos));
+                b2 = amp * (((amp + 1.0f) - ((amp - 1.0f) * w0_cos)) - (2.0f * sqrt_amp * alpha));
+                a0 = ((amp + 1.0f) + ((amp - 1.0f) * w0_cos)) + (2.0f * sqrt_amp * alpha);
+                a1 = -2.0f * ((amp - 1.0f) + ((amp + 1.0f) * w0_cos));
+                a2 = ((amp + 1.0f) + ((amp - 1.0f) * w0_cos)) - (2.0f * sqrt_amp * alpha);
+                break;
+            case EQ_TYPE_HIGH_SHELF:
+                b0 = amp * (((amp + 1.0f) + ((amp - 1.0f) * w0_cos)) + (2.0f * sqrt_amp * alpha));
+                b1 = -2.0f * amp * ((amp - 1.0f) + ((amp + 1.0f) * w0_cos));
+                b2 = amp * (((amp + 1.0f) + ((amp - 1.0f) * w0_cos)) - (2.0f * sqrt_amp * alpha));
+                a0 = ((amp + 1.0f) - ((amp - 1.0f) * w0_cos)) + (2.0f * sqrt_amp * alpha);
+                a1 = 2.0f * ((amp - 1.0f) - ((amp + 1.0f) * w0_cos));
+                a2 = ((amp + 1.0f) - ((amp - 1.0f) * w0_cos)) - (2.0f * sqrt_amp * alpha);
+                break;
+            case EQ_TYPE_LOW_PASS:
+                b0 = (1.0f - w0_cos) / 2.0f;
+                b1 = 1.0f - w0_cos;
+                b2 = (1.0f - w0_cos) / 2.0f;
+                a0 = 1.0f + alpha;
+                a1 = -2.0f * w0_cos;
+                a2 = 1.0f - alpha;
+                break;
+            case EQ_TYPE_HIGH_PASS:
+                b0 = (1.0f + w0_cos) / 2.0f;
+                b1 = -(1.0f + w0_cos);
+                b2 = (1.0f + w0_cos) / 2.0f;
+                a0 = 1.0f + alpha;
+                a1 = -2.0f * w0_cos;
+                a2 = 1.0f - alpha;
+                break;
+            case EQ_TYPE_PEAK:
+            default:
+                b0 = 1.0f + (alpha * amp);
+                b1 = -2.0f * w0_cos;
+                b2 = 1.0f - (alpha * amp);
+                a0 = 1.0f + (alpha / amp);
+                a1 = -2.0f * w0_cos;
+                a2 = 1.0f - (alpha / amp);
+                break;
+        }
+        ret = to_fixed(&p_coef->b0, b0 / a0);
+        if (ret == true) {
+            ret = to_fixed(&p_coef->b1, b1 / a0);
+        }
+        if (ret == true) {
+            ret = to_fixed(&p_coef->b2, b2 / a0);
+        }
+        if (ret == true) {
+            ret = to_fixed(&p_coef->a1, a1 / a0);
+        }
+        if (ret == true) {
+            ret = to_fixed(&p_coef->a2, a2 / a0);
+        }
+    }
+    return ret;
+}
+
+/** Converts a coefficient to Q28
+ *
+ *  @param p_fixed Pointer to store the converted coefficient.
+ *  @param val Coefficient.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool to_fixed(int32_t * const p_fixed, const float val)
+{
+    bool        ret = false;
+
+    if ((val < EQ_COEF_MAX) && (val > -EQ_COEF_MAX)) {
+        *p_fixed = (int32_t)lrintf(val * (float)(1uL << EQ_COEF_FRAC_BITS));
+        ret = true;
+    }
+    return ret;
+}
+
+/** Applies all stages to a stereo frame
+ *
+ *  @param p_flt Pointer to the filter.
+ *  @param p_l Pointer to the left sample. (24bits data without padding)
+ *  @param p_r Pointer to the right sample. (24bits data without padding)
+ */
+static inline void filter_frame(eq_filter_t * const p_flt, int32_t * const p_l, int32_t * const p_r)
+{
+    const eq_coef_t *p_coef;
+    int64_t         (*p_state)[EQ_STATE_NUM];
+    int32_t         x_l = *p_l;
+    int32_t         x_r = *p_r;
+    int32_t         y_l;
+    int32_t         y_r;
+    uint32_t        st;
+
+    for (st = 0u; st < p_flt->stage_num; st++) {
+        p_coef = &p_flt->coef[st];
+        p_state = p_flt->state[st];
+        /* Both channels share the coefficients loaded for the stage. */
+        y_l = saturate_pcm(((int64_t)p_coef->b0 * x_l) + p_state[EQ_CH_L][EQ_ST_1]);
+        y_r = saturate_pcm(((int64_t)p_coef->b0 * x_r) + p_state[EQ_CH_R][EQ_ST_1]);
+        p_state[EQ_CH_L][EQ_ST_1] = (((int64_t)p_coef->b1 * x_l) - ((int64_t)p_coef->a1 * y_l)) 
+                                                            + p_state[EQ_CH_L][EQ_ST_2];
+        p_state[EQ_CH_R][EQ_ST_1] = (((int64_t)p_coef->b1 * x_r) - ((int64_t)p_coef->a1 * y_r)) 
+                                                            + p_state[EQ_CH_R][EQ_ST_2];
+        p_state[EQ_CH_L][EQ_ST_2] = ((int64_t)p_coef->b2 * x_l) - ((int64_t)p_coef->a2 * y_l);
+        p_state[EQ_CH_R][EQ_ST_2] = ((int64_t)p_coef->b2 * x_r) - ((int64_t)p_coef->a2 * y_r);
+        x_l = y_l;
+        x_r = y_r;
+    }
+    *p_l = x_l;
+    *p_r = x_r;
+}
+
+/** Scales the accumulated data to 24bits and saturates it
+ *
+ *  @param acc Accumulated data. (24bits data multiplied by Q28 coefficients)
+ *
+ *  @returns 
+ *    24bits data.
+ */
+static inline int32_t saturate_pcm(const int64_t acc)
+{
+    int64_t     data;
+    int32_t     ret;
+
+    data = (acc + EQ_ROUND_VAL) >> EQ_COEF_FRAC_BITS;
+    if (data > PCM_MAX_VAL) {
+        ret = PCM_MAX_VAL;
+    } else if (data < PCM_MIN_VAL) {
+        ret = PCM_MIN_VAL;
+    } else {
+        ret = (int32_t)data;
+    }
+    return ret;
+}
@@ -0,0 +1,131 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_EQ_H
+#define DEC_EQ_H
+
+#include "r_typedefs.h"
+
+/*--- Macro definition ---*/
+#define EQ_MAX_STAGE_NUM        (10u)       /* Maximum number of biquad stages */
+#define EQ_CHANNEL_NUM          (2u)        /* Number of channels (DEC_OUTPUT_CHANNEL_NUM) */
+#define EQ_STATE_NUM            (2u)        /* Number of states per channel of a biquad */
+#define EQ_MIN_GAIN             (-150)      /* Minimum gain (0.1dB unit) */
+#define EQ_MAX_GAIN             (150)       /* Maximum gain (0.1dB unit) */
+#define EQ_MIN_Q                (10u)       /* Minimum Q (0.01 unit) */
+#define EQ_MAX_Q                (2000u)     /* Maximum Q (0.01 unit) */
+
+/*--- User defined types ---*/
+/* Filter type of a band */
+typedef enum {
+    EQ_TYPE_PEAK = 0,           /* Peaking */
+    EQ_TYPE_LOW_SHELF,          /* Low shelf (Bass) */
+    EQ_TYPE_HIGH_SHELF,         /* High shelf (Treble) */
+    EQ_TYPE_LOW_PASS,           /* Low pass. gain is ignored. */
+    EQ_TYPE_HIGH_PASS,          /* High pass. gain is ignored. */
+    EQ_TYPE_NUM
+} EQ_FilterType;
+
+/* Parameter of a band */
+typedef struct {
+    EQ_FilterType           type;               /* Filter type */
+    uint32_t                freq;               /* Center or corner frequency in Hz */
+    int32_t                 gain;               /* Gain (0.1dB unit) EQ_MIN_GAIN to EQ_MAX_GAIN */
+    uint32_t                q;                  /* Q (0.01 unit) EQ_MIN_Q to EQ_MAX_Q */
+} eq_band_t;
+
+/* Parameter of the equalizer */
+typedef struct {
+    uint32_t                band_num;           /* Number of bands. 0 to EQ_MAX_STAGE_NUM */
+    eq_band_t               band[EQ_MAX_STAGE_NUM];
+} eq_param_t;
+
+/* Coefficients of a biquad. (Q28, a0 is normalized to 1) */
+/* H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) */
+typedef struct {
+    int32_t                 b0;
+    int32_t                 b1;
+    int32_t                 b2;
+    int32_t                 a1;
+    int32_t                 a2;
+} eq_coef_t;
+
+/* Cascade of biquads (Transposed direct form II) */
+typedef struct {
+    uint32_t                stage_num;          /* Number of stages. 0 is bypass. */
+    eq_coef_t               coef[EQ_MAX_STAGE_NUM];
+    int64_t                 state[EQ_MAX_STAGE_NUM][EQ_CHANNEL_NUM][EQ_STATE_NUM];
+} eq_filter_t;
+
+/* Control data of the equalizer */
+typedef struct {
+    eq_param_t              param;              /* Copy of the parameter. band_num 0 is the bypass. */
+    uint32_t                sample_rate;        /* Sampling rate in Hz */
+    uint32_t                fade_cnt;           /* Remaining frames of the crossfade */
+    bool                    is_pending;         /* param is faded in after the crossfade */
+    eq_filter_t             cur;                /* Filter in use */
+    eq_filter_t             next;               /* Filter which is faded in */
+} eq_ctrl_t;
+
+/** Initialises the control data of the equalizer
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ */
+void eq_init(eq_ctrl_t * const p_eq_ctrl);
+
+/** Sets the sampling rate and clears the filter state
+ *
+ *  The coefficients are recalculated for the sampling rate without the crossfade.
+ *  Call this before the playback of each file.
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ *  @param sample_rate Sampling rate in Hz of the PCM data.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool eq_set_rate(eq_ctrl_t * const p_eq_ctrl, const uint32_t sample_rate);
+
+/** Sets the parameter of the equalizer
+ *
+ *  The new coefficients are crossfaded with the current ones during the playback.
+ *  When a crossfade is in progress, the new one starts after it ends.
+ *  The parameter is copied, so it can be changed or released after the call.
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ *  @param p_param Pointer to the parameter. NULL disables the equalizer.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool eq_set_param(eq_ctrl_t * const p_eq_ctrl, const eq_param_t * const p_param);
+
+/** Applies the equalizer to PCM data in place
+ *
+ *  @param p_eq_ctrl Pointer to the control data of the equalizer.
+ *  @param p_buf Pointer to PCM buffer. (2ch interleaved, 24bits data with 8bits padding)
+ *  @param sample_num Elements number of PCM data in p_buf.
+ */
+void eq_process(eq_ctrl_t * const p_eq_ctrl, int32_t * const p_buf, const uint32_t sample_num);
+
+#endif /* DEC_EQ_H */
@@ -21,12 +21,35 @@
 * Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
 *******************************************************************************/
 
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "decode.h"
 #include "misratypes.h"
 #include "dec_flac.h"
 
+/*--- Macro definition ---*/
+#define TAG_TRACK_GAIN      "REPLAYGAIN_TRACK_GAIN="    /* Field name of VORBIS_COMMENT */
+#define TAG_TRACK_PEAK      "REPLAYGAIN_TRACK_PEAK="    /* Field name of VORBIS_COMMENT */
+#define GAIN_UNIT           (100.0f)                    /* replay_gain is 0.01dB unit */
+#define DB_TO_AMP_DIV       (20.0f)                     /* Amplitude ratio is 10^(dB/20) */
+#define GAIN_MIN_DB         (-100.0f)                   /* Minimum valid value of the tag */
+#define GAIN_MAX_DB         (100.0f)                    /* Maximum valid value of the tag */
+
+/* Prints "R,<position>,<bytes>" for each read and "S,<position>" for each seek */
+/* of the FLAC file. The lines are the I/O trace replayed by tests/bench. */
+#define DEC_FLAC_READ_TRACE (0)
+
 static FLAC__StreamDecoderReadStatus read_cb(const FLAC__StreamDecoder *decoder, 
                             FLAC__byte buffer[], size_t *bytes, void *client_data);
+static FLAC__StreamDecoderSeekStatus seek_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderTellStatus tell_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 *absolute_byte_offset, void *client_data);
+static FLAC__StreamDecoderLengthStatus length_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 *stream_length, void *client_data);
+static FLAC__bool eof_cb(const FLAC__StreamDecoder *decoder, void *client_data);
 static FLAC__StreamDecoderWriteStatus write_cb (const FLAC__StreamDecoder *decoder,
     const FLAC__Frame *frame, const FLAC__int32 *const buffer[], void *client_data);
 static void meta_cb(const FLAC__StreamDecoder *decoder, 
@@ -34,6 +57,7 @@ static void meta_cb(const FLAC__StreamDecoder *decoder,
 static void error_cb(const FLAC__StreamDecoder *decoder, 
                             FLAC__StreamDecoderErrorStatus status, void *client_data);
 static void init_ctrl_data(flac_ctrl_t * const p_ctrl);
+static int32_t parse_replay_gain(const FLAC__StreamMetadata_VorbisComment * const p_comment);
 static bool check_file_spec(const flac_ctrl_t * const p_ctrl);
 static bool check_end_of_stream(const flac_ctrl_t * const p_flac_ctrl);
 
@@ -81,6 +105,50 @@ uint32_t flac_get_total_time(const flac_ctrl_t * const p_flac_ctrl)
     return total_time;
 }
 
+int32_t flac_get_replay_gain(const flac_ctrl_t * const p_flac_ctrl)
+{
+    int32_t     replay_gain = 0;
+    if (p_flac_ctrl != NULL) {
+        replay_gain = p_flac_ctrl->replay_gain;
+    }
+    return replay_gain;
+}
+
+bool flac_set_position(flac_ctrl_t * const p_flac_ctrl, const uint64_t sample)
+{
+    bool        ret = false;
+    if ((p_flac_ctrl != NULL) && (sample < p_flac_ctrl->total_sample)) {
+        p_flac_ctrl->seek_sample = sample;
+        p_flac_ctrl->is_seek_req = true;
+        ret = true;
+    }
+    return ret;
+}
+
+bool flac_init(flac_ctrl_t * const p_flac_ctrl)
+{
+    bool                            ret = false;
+    FLAC__bool                      result;
+    FLAC__StreamDecoder             *p_dec;
+
+    if (p_flac_ctrl != NULL) {
+        init_ctrl_data(p_flac_ctrl);
+        /* Creates the instance of flac decoder. It is recycled by every track. */
+        p_dec = FLAC__stream_decoder_new();
+        if (p_dec != NULL) {
+            /* Allocates the buffers for the maximum block size and channels in advance, */
+            /* so that no file allocates them when the track changes. */
+            result = FLAC__stream_decoder_reserve_output(p_dec, 
+                                DEC_MAX_BLOCK_SIZE, DEC_MAX_CHANNEL_NUM);
+            if (result == true) {
+                ret = true;
+            }
+            p_flac_ctrl->p_decoder = p_dec;
+        }
+    }
+    return ret;
+}
+
 bool flac_open(FILE * const p_handle, flac_ctrl_t * const p_flac_ctrl)
 {
     bool                            ret = false;
@@ -92,33 +160,42 @@ bool flac_open(FILE * const p_handle, flac_ctrl_t * const p_flac_ctrl)
         /* Initialises Internal memory */
         init_ctrl_data(p_flac_ctrl);
         p_flac_ctrl->p_file_handle = p_handle;
-        /* Creates the instance of flac decoder. */
-        p_dec = FLAC__stream_decoder_new();
+        /* The instance of flac decoder created by flac_init() is used. */
+        p_dec = p_flac_ctrl->p_decoder;
         if (p_dec != NULL) {
             /* Sets the MD5 check. */
             (void) FLAC__stream_decoder_set_md5_checking(p_dec, true);
+            /* Notifies STREAMINFO and VORBIS_COMMENT (for ReplayGain) only. */
+            /* The other metadata blocks are skipped by seeking. */
+            (void) FLAC__stream_decoder_set_metadata_ignore_all(p_dec);
+            (void) FLAC__stream_decoder_set_metadata_respond(p_dec, FLAC__METADATA_TYPE_STREAMINFO);
+            (void) FLAC__stream_decoder_set_metadata_respond(p_dec, FLAC__METADATA_TYPE_VORBIS_COMMENT);
             /* Initialises the instance of flac decoder. */
-            result_init = FLAC__stream_decoder_init_stream(p_dec, &read_cb, NULL, NULL, 
-                            NULL, NULL, &write_cb, &meta_cb, &error_cb, (void *)p_flac_ctrl);
+            result_init = FLAC__stream_decoder_init_stream(p_dec, &read_cb, &seek_cb, &tell_cb, 
+                            &length_cb, &eof_cb, &write_cb, &meta_cb, &error_cb, (void *)p_flac_ctrl);
             if (result_init == FLAC__STREAM_DECODER_INIT_STATUS_OK) {
                 /* Decodes until end of metadata. */
                 result = FLAC__stream_decoder_process_until_end_of_metadata(p_dec);
                 if (result == true) {
                     if (check_file_spec(p_flac_ctrl) == true) {
-                        p_flac_ctrl->p_decoder = p_dec;
-                        ret = true;
+                        /* Selects the kernel for the channel layout and the bit count. */
+                        if (dmx_set_cfg(&p_flac_ctrl->dmx_ctrl, p_flac_ctrl->channel_num, 
+                                            p_flac_ctrl->bits_per_sample) == true) {
+                            ret = true;
+                        }
                     }
                 }
             }
             if (ret != true) {
-                FLAC__stream_decoder_delete(p_dec);
+                /* The instance returns to the uninitialized state, keeping its buffers. */
+                (void) FLAC__stream_decoder_finish(p_dec);
             }
         }
     }
     return ret;
 }
 
-bool flac_decode(const flac_ctrl_t * const p_flac_ctrl)
+bool flac_decode(flac_ctrl_t * const p_flac_ctrl)
 {
     bool            ret = false;
     bool            eos;
@@ -127,7 +204,19 @@ bool flac_decode(const flac_ctrl_t * const p_flac_ctrl)
 
     if (p_flac_ctrl != NULL) {
         eos = check_end_of_stream(p_flac_ctrl);
-        if (eos != true) {
+        if (p_flac_ctrl->is_seek_req == true) {
+            /* The seek is accepted at the end of stream too. */
+            /* The decoder writes the frame of the position from the position. */
+            p_flac_ctrl->is_seek_req = false;
+            used_cnt = p_flac_ctrl->pcm_buf_used_cnt;
+            result = FLAC__stream_decoder_seek_absolute(p_flac_ctrl->p_decoder, 
+                                                        p_flac_ctrl->seek_sample);
+            if (result == true) {
+                if (p_flac_ctrl->pcm_buf_used_cnt > used_cnt) {
+                    ret = true;
+                }
+            }
+        } else if (eos != true) {
             /* Decoding position is not end of stream. */
             used_cnt = p_flac_ctrl->pcm_buf_used_cnt;
             result = FLAC__stream_decoder_process_single (p_flac_ctrl->p_decoder);
@@ -145,9 +234,9 @@ bool flac_decode(const flac_ctrl_t * const p_flac_ctrl)
 
 void flac_close(flac_ctrl_t * const p_flac_ctrl)
 {
-    if (p_flac_ctrl != NULL) {
-        FLAC__stream_decoder_delete(p_flac_ctrl->p_decoder);
-        p_flac_ctrl->p_decoder = NULL;
+    if ((p_flac_ctrl != NULL) && (p_flac_ctrl->p_decoder != NULL)) {
+        /* The instance is not deleted, so that the next track does not allocate it. */
+        (void) FLAC__stream_decoder_finish(p_flac_ctrl->p_decoder);
     }
 }
 
@@ -174,6 +263,9 @@ static FLAC__StreamDecoderReadStatus read_cb(const FLAC__StreamDecoder *decoder,
     UNUSED_ARG(decoder);
     if ((buffer != NULL) && (bytes != NULL) && (p_ctrl != NULL)) {
         if (*bytes > 0u) {
+#if DEC_FLAC_READ_TRACE
+            (void)printf("R,%ld,%u\n", ftell(p_ctrl->p_file_handle), (unsigned int)*bytes);
+#endif /* DEC_FLAC_READ_TRACE */
             read_size = fread(&buffer[0], sizeof(FLAC__byte), *bytes, p_ctrl->p_file_handle);
             if (read_size > 0u) {
                 ret = FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
@@ -187,6 +279,123 @@ static FLAC__StreamDecoderReadStatus read_cb(const FLAC__StreamDecoder *decoder,
     return ret;
 }
 
+/** Seek callback function of FLAC decoder library
+ *
+ *  @param decoder Decoder instance.
+ *  @param absolute_byte_offset Offset from the beginning of FLAC file.
+ *  @param client_data Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    Results of process. Returns the following status.
+ *    FLAC__STREAM_DECODER_SEEK_STATUS_OK
+ *    FLAC__STREAM_DECODER_SEEK_STATUS_ERROR
+ */
+static FLAC__StreamDecoderSeekStatus seek_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 absolute_byte_offset, void *client_data)
+{
+    FLAC__StreamDecoderSeekStatus   ret = FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+    flac_ctrl_t                     * const p_ctrl = (flac_ctrl_t*)client_data;
+    int                             result;
+
+    UNUSED_ARG(decoder);
+    if ((p_ctrl != NULL) && (absolute_byte_offset <= (FLAC__uint64)LONG_MAX)) {
+#if DEC_FLAC_READ_TRACE
+        (void)printf("S,%ld\n", (long)absolute_byte_offset);
+#endif /* DEC_FLAC_READ_TRACE */
+        result = fseek(p_ctrl->p_file_handle, (long)absolute_byte_offset, SEEK_SET);
+        if (result == 0) {
+            ret = FLAC__STREAM_DECODER_SEEK_STATUS_OK;
+        }
+    }
+    return ret;
+}
+
+/** Tell callback function of FLAC decoder library
+ *
+ *  @param decoder Decoder instance.
+ *  @param absolute_byte_offset Pointer to store the current offset from the beginning of FLAC file.
+ *  @param client_data Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    Results of process. Returns the following status.
+ *    FLAC__STREAM_DECODER_TELL_STATUS_OK
+ *    FLAC__STREAM_DECODER_TELL_STATUS_ERROR
+ */
+static FLAC__StreamDecoderTellStatus tell_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 *absolute_byte_offset, void *client_data)
+{
+    FLAC__StreamDecoderTellStatus   ret = FLAC__STREAM_DECODER_TELL_STATUS_ERROR;
+    flac_ctrl_t                     * const p_ctrl = (flac_ctrl_t*)client_data;
+    long                            pos;
+
+    UNUSED_ARG(decoder);
+    if ((absolute_byte_offset != NULL) && (p_ctrl != NULL)) {
+        pos = ftell(p_ctrl->p_file_handle);
+        if (pos >= 0) {
+            *absolute_byte_offset = (FLAC__uint64)pos;
+            ret = FLAC__STREAM_DECODER_TELL_STATUS_OK;
+        }
+    }
+    return ret;
+}
+
+/** Length callback function of FLAC decoder library
+ *
+ *  @param decoder Decoder instance.
+ *  @param stream_length Pointer to store the size of FLAC file.
+ *  @param client_data Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    Results of process. Returns the following status.
+ *    FLAC__STREAM_DECODER_LENGTH_STATUS_OK
+ *    FLAC__STREAM_DECODER_LENGTH_STATUS_ERROR
+ */
+static FLAC__StreamDecoderLengthStatus length_cb(const FLAC__StreamDecoder *decoder, 
+                            FLAC__uint64 *stream_length, void *client_data)
+{
+    FLAC__StreamDecoderLengthStatus ret = FLAC__STREAM_DECODER_LENGTH_STATUS_ERROR;
+    flac_ctrl_t                     * const p_ctrl = (flac_ctrl_t*)client_data;
+    long                            cur_pos;
+    long                            end_pos;
+
+    UNUSED_ARG(decoder);
+    if ((stream_length != NULL) && (p_ctrl != NULL)) {
+        cur_pos = ftell(p_ctrl->p_file_handle);
+        if (cur_pos >= 0) {
+            if (fseek(p_ctrl->p_file_handle, 0, SEEK_END) == 0) {
+                end_pos = ftell(p_ctrl->p_file_handle);
+                if ((fseek(p_ctrl->p_file_handle, cur_pos, SEEK_SET) == 0) && (end_pos >= 0)) {
+                    *stream_length = (FLAC__uint64)end_pos;
+                    ret = FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+/** EOF callback function of FLAC decoder library
+ *
+ *  @param decoder Decoder instance.
+ *  @param client_data Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    true is end of FLAC file. false is other state.
+ */
+static FLAC__bool eof_cb(const FLAC__StreamDecoder *decoder, void *client_data)
+{
+    FLAC__bool      ret = true;
+    flac_ctrl_t     * const p_ctrl = (flac_ctrl_t*)client_data;
+
+    UNUSED_ARG(decoder);
+    if (p_ctrl != NULL) {
+        if (feof(p_ctrl->p_file_handle) == 0) {
+            ret = false;
+        }
+    }
+    return ret;
+}
+
 /** Write callback function of FLAC decoder library
  *
  *  @param decoder Decoder instance.
@@ -203,11 +412,8 @@ static FLAC__StreamDecoderWriteStatus write_cb (const FLAC__StreamDecoder *decod
         const FLAC__Frame *frame, const FLAC__int32 *const buffer[], void *client_data)
 {
     FLAC__StreamDecoderWriteStatus  ret = FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
-    const FLAC__int32               *p_ch0;
-    const FLAC__int32               *p_ch1;
     flac_ctrl_t                     *const p_ctrl = (flac_ctrl_t*)client_data;
-    uint32_t                        bit_shift_num;
-    uint32_t                        i;
+    uint32_t                        write_cnt;
 
     UNUSED_ARG(decoder);
     if ((frame != NULL) && (buffer != NULL) && (p_ctrl != NULL)) {
@@ -220,26 +426,15 @@ static FLAC__StreamDecoderWriteStatus write_cb (const FLAC__StreamDecoder *decod
             /* Error */
         } else if (frame->header.blocksize > DEC_MAX_BLOCK_SIZE) {
             /* Error : Block size is illegal specification */
+        } else if ((frame->header.channels != p_ctrl->channel_num) || 
+                   (frame->header.bits_per_sample != p_ctrl->bits_per_sample)) {
+            /* Error : The frame does not match STREAMINFO */
         } else {
-            bit_shift_num = (DEC_OUTPUT_BITS_PER_SAMPLE + DEC_OUTPUT_PADDING_BITS)- p_ctrl->bits_per_sample;
-            if (p_ctrl->channel_num == DEC_MAX_CHANNEL_NUM) {
-                /* stereo */
-                p_ch0 = buffer[0];
-                p_ch1 = buffer[1];
-            } else {
-                /* mono */
-                p_ch0 = buffer[0];
-                p_ch1 = buffer[0];
-            }
-            if ((p_ctrl->pcm_buf_num - p_ctrl->pcm_buf_used_cnt) >= (frame->header.blocksize * DEC_MAX_CHANNEL_NUM)) {
-                for (i = 0; i < frame->header.blocksize; i++) {
-                    /* ch 0 */
-                    p_ctrl->p_pcm_buf[p_ctrl->pcm_buf_used_cnt] = (int32_t)((uint32_t)p_ch0[i] << bit_shift_num);
-                    p_ctrl->pcm_buf_used_cnt++;
-                    /* ch 1 */
-                    p_ctrl->p_pcm_buf[p_ctrl->pcm_buf_used_cnt] = (int32_t)((uint32_t)p_ch1[i] << bit_shift_num);
-                    p_ctrl->pcm_buf_used_cnt++;
-                }
+            if ((p_ctrl->pcm_buf_num - p_ctrl->pcm_buf_used_cnt) >= (frame->header.blocksize * DEC_OUTPUT_CHANNEL_NUM)) {
+                /* Downmix, bit count adjustment and interleave */
+                write_cnt = dmx_convert(&p_ctrl->dmx_ctrl, buffer, 
+                            &p_ctrl->p_pcm_buf[p_ctrl->pcm_buf_used_cnt], frame->header.blocksize);
+                p_ctrl->pcm_buf_used_cnt += write_cnt;
                 ret = FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
             }
         }
@@ -265,6 +460,10 @@ static void meta_cb(const FLAC__StreamDecoder *decoder,
             p_ctrl->channel_num = metadata->data.stream_info.channels;
             p_ctrl->bits_per_sample = metadata->data.stream_info.bits_per_sample;
             p_ctrl->total_sample = metadata->data.stream_info.total_samples;
+        } else if (metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT) {
+            p_ctrl->replay_gain = parse_replay_gain(&metadata->data.vorbis_comment);
+        } else {
+            /* DO NOTHING */
         }
     }
 }
@@ -290,7 +489,7 @@ static void error_cb(const FLAC__StreamDecoder *decoder,
 static void init_ctrl_data(flac_ctrl_t * const p_ctrl)
 {
     if (p_ctrl != NULL) {
-        p_ctrl->p_decoder        = NULL;    /* Handle of flac decoder */
+        /* p_decoder is kept. */
         p_ctrl->p_file_handle    = NULL;    /* Handle of flac file */
         p_ctrl->decoded_sample   = 0uLL;    /* Number of a decoded sample */
         p_ctrl->total_sample     = 0uLL;    /* Total number of sample */
@@ -300,9 +499,61 @@ static void init_ctrl_data(flac_ctrl_t * const p_ctrl)
         p_ctrl->p_pcm_buf        = NULL;    /* Pointer of PCM buffer */
         p_ctrl->pcm_buf_num      = 0u;      /* Number of elements in PCM buffer */
         p_ctrl->pcm_buf_used_cnt = 0u;      /* Counter of used elements in PCM buffer */
+        p_ctrl->dmx_ctrl.p_kernel = NULL;   /* Kernel of downmix */
+        p_ctrl->replay_gain      = 0;       /* ReplayGain of the track */
+        p_ctrl->seek_sample      = 0uLL;    /* Position requested by flac_set_position() */
+        p_ctrl->is_seek_req      = false;   /* true while the seek is not done yet */
     }
 }
 
+/** Parses ReplayGain of the track from VORBIS_COMMENT
+ *
+ *  @param p_comment Pointer to VORBIS_COMMENT metadata.
+ *
+ *  @returns 
+ *    ReplayGain (0.01dB unit). 0 if the metadata does not have the tag.
+ */
+static int32_t parse_replay_gain(const FLAC__StreamMetadata_VorbisComment * const p_comment)
+{
+    int32_t         ret = 0;
+    bool            gain_found = false;
+    float           gain = 0.0f;
+    float           peak = 0.0f;
+    float           limit;
+    const char_t    *p_entry;
+    uint32_t        i;
+
+    if (p_comment != NULL) {
+        for (i = 0u; i < p_comment->num_comments; i++) {
+            /* The entry is terminated by '\0' in FLAC decoder library. */
+            p_entry = (const char_t *)p_comment->comments[i].entry;
+            if (p_entry != NULL) {
+                if (strncasecmp(p_entry, TAG_TRACK_GAIN, sizeof(TAG_TRACK_GAIN) - 1u) == 0) {
+                    gain = strtof(&p_entry[sizeof(TAG_TRACK_GAIN) - 1u], NULL);
+                    gain_found = true;
+                } else if (strncasecmp(p_entry, TAG_TRACK_PEAK, sizeof(TAG_TRACK_PEAK) - 1u) == 0) {
+                    peak = strtof(&p_entry[sizeof(TAG_TRACK_PEAK) - 1u], NULL);
+                } else {
+                    /* DO NOTHING */
+                }
+            }
+        }
+        if (gain_found == true) {
+            if (peak > 0.0f) {
+                /* Limits the gain so that the peak does not clip. */
+                limit = -DB_TO_AMP_DIV * log10f(peak);
+                if (gain > limit) {
+                    gain = limit;
+                }
+            }
+            if ((gain >= GAIN_MIN_DB) && (gain <= GAIN_MAX_DB)) {
+                ret = (int32_t)lrintf(gain * GAIN_UNIT);
+            }
+        }
+    }
+    return ret;
+}
+
 /** Checks the playable file of the playback
  *
  *  @param client_data Pointer to the control data of FLAC module.
@@ -316,8 +567,8 @@ static bool check_file_spec(const flac_ctrl_t * const p_ctrl)
     } else if ((p_ctrl->channel_num <= 0u) || 
                (p_ctrl->channel_num > DEC_MAX_CHANNEL_NUM)) {
         /* Error : Channel number is illegal specification */
-    } else if ((p_ctrl->bits_per_sample != DEC_16BITS_PER_SAMPLE) && 
-               (p_ctrl->bits_per_sample != DEC_24BITS_PER_SAMPLE)) {
+    } else if ((p_ctrl->bits_per_sample < DEC_MIN_BITS_PER_SAMPLE) || 
+               (p_ctrl->bits_per_sample > DEC_MAX_BITS_PER_SAMPLE)) {
         /* Error : Bit per sample is illegal specification */
     } else if ((p_ctrl->sample_rate < DEC_INPUT_MIN_SAMPLE_RATE) || 
                (p_ctrl->sample_rate > DEC_INPUT_MAX_SAMPLE_RATE)) {
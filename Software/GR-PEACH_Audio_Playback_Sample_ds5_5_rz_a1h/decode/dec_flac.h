@@ -26,10 +26,11 @@
 
 #include "r_typedefs.h"
 #include "stream_decoder.h"
+#include "dec_dmx.h"
 
 /*--- User defined types ---*/
 typedef struct {
-    FLAC__StreamDecoder     *p_decoder;         /* Handle of flac decoder */
+    FLAC__StreamDecoder     *p_decoder;         /* Handle of flac decoder. It is kept from flac_init(). */
     FILE                    *p_file_handle;     /* Handle of flac file */
     uint64_t                decoded_sample;     /* Number of a decoded sample */
     uint64_t                total_sample;       /* Total number of sample */
@@ -39,6 +40,10 @@ typedef struct {
     int32_t                 *p_pcm_buf;         /* Pointer of PCM buffer */
     uint32_t                pcm_buf_num;        /* Size of PCM buffer */
     uint32_t                pcm_buf_used_cnt;   /* Counter of used elements in PCM buffer */
+    dmx_ctrl_t              dmx_ctrl;           /* Control data of downmix */
+    int32_t                 replay_gain;        /* ReplayGain of the track (0.01dB unit) */
+    uint64_t                seek_sample;        /* Position requested by flac_set_position() */
+    bool                    is_seek_req;        /* true while the seek is not done yet */
 } flac_ctrl_t;
 
 /** Sets the PCM buffer to store decoded data
@@ -80,6 +85,44 @@ uint32_t flac_get_play_time(const flac_ctrl_t * const p_flac_ctrl);
  */
 uint32_t flac_get_total_time(const flac_ctrl_t * const p_flac_ctrl);
 
+/** Gets ReplayGain of the track
+ *
+ *  REPLAYGAIN_TRACK_GAIN of VORBIS_COMMENT is used. It is reduced so that
+ *  REPLAYGAIN_TRACK_PEAK does not clip.
+ *
+ *  @param p_flac_ctrl Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    ReplayGain (0.01dB unit). 0 if the file does not have the tag.
+ */
+int32_t flac_get_replay_gain(const flac_ctrl_t * const p_flac_ctrl);
+
+/** Sets the position to decode next
+ *
+ *  The seek is done by the next flac_decode(), so that the data from the position
+ *  is stored in the PCM buffer set at that time.
+ *
+ *  @param p_flac_ctrl Pointer to the control data of FLAC module.
+ *  @param sample Position in samples from the start of the track.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool flac_set_position(flac_ctrl_t * const p_flac_ctrl, const uint64_t sample);
+
+/** Initialises the FLAC module
+ *
+ *  Creates the instance of FLAC decoder and allocates its buffers for DEC_MAX_BLOCK_SIZE.
+ *  The instance is recycled by flac_open() and flac_close(), so the track change
+ *  does not allocate the buffers of FLAC decoder.
+ *
+ *  @param p_flac_ctrl Pointer to the control data of FLAC module.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool flac_init(flac_ctrl_t * const p_flac_ctrl);
+
 /** Open the FLAC decoder
  *
  *  @param p_handle Pointer to the handle of FLAC file.
@@ -91,13 +134,16 @@ uint32_t flac_get_total_time(const flac_ctrl_t * const p_flac_ctrl);
 bool flac_open(FILE * const p_handle, flac_ctrl_t * const p_flac_ctrl);
 
 /** Decode some audio frames.
+ *
+ *  When the position is set by flac_set_position(), it seeks to the position and
+ *  stores the data from the position instead.
  *
  *  @param p_flac_ctrl Pointer to the control data of FLAC module.
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-bool flac_decode(const flac_ctrl_t * const p_flac_ctrl);
+bool flac_decode(flac_ctrl_t * const p_flac_ctrl);
 
 /** Close the FLAC decoder
  *
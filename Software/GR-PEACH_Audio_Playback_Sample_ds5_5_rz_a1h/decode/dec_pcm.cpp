@@ -0,0 +1,833 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include <limits.h>
+#include <string.h>
+#include "decode.h"
+#include "misratypes.h"
+#include "dec_pcm.h"
+
+/*--- Macro definition ---*/
+#define CHUNK_ID_SIZE           (4u)
+#define CHUNK_HEADER_SIZE       (8u)    /* ID and size */
+#define RIFF_FORM_TYPE_POS      (8u)    /* Position of the form type in the file header */
+#define WAV_FMT_MIN_SIZE        (16u)   /* Size of WAVEFORMAT with wBitsPerSample */
+#define WAV_FMT_EXT_SIZE        (40u)   /* Size of WAVEFORMATEXTENSIBLE */
+#define WAV_FMT_SUBFORMAT_POS   (24u)   /* Position of SubFormat in WAVEFORMATEXTENSIBLE */
+#define WAV_FORMAT_PCM          (0x0001u)
+#define WAV_FORMAT_EXTENSIBLE   (0xFFFEu)
+#define WAV_DATA_SIZE_UNKNOWN   (0xFFFFFFFFu)   /* Size of the data chunk of the stream */
+#define AIFF_COMM_SIZE          (18u)   /* Size of COMM chunk of AIFF */
+#define AIFC_COMM_SIZE          (22u)   /* Size of COMM chunk of AIFF-C until compressionType */
+#define AIFF_SSND_HEADER_SIZE   (8u)    /* offset and blockSize */
+#define AIFF_EXP_BIAS           (16383 + 63)    /* Exponent of 80bits extended for integer */
+#define AIFF_EXP_MASK           (0x7FFFu)
+#define BITS_PER_BYTE           (8u)
+#define BYTES_8BITS             (1u)
+#define BYTES_16BITS            (2u)
+#define BYTES_24BITS            (3u)
+#define BYTES_32BITS            (4u)
+#define SIGN_BIT                (0x80000000u)
+#define UPPER_16BITS            (0xFFFF0000u)
+#define MONO_CH_NUM             (1u)
+#define STEREO_CH_NUM           (2u)
+/* Samples per channel of the downmix over 2ch by a read */
+#define MIX_SAMPLE_NUM          (512u)
+
+static void init_ctrl_data(pcm_ctrl_t * const p_ctrl);
+static bool parse_wav(pcm_ctrl_t * const p_ctrl);
+static bool parse_aiff(pcm_ctrl_t * const p_ctrl, const bool is_aifc);
+static bool read_data(FILE * const p_handle, uint8_t * const p_buf, const uint32_t size);
+static bool skip_data(FILE * const p_handle, const uint32_t size);
+static uint32_t get_le16(const uint8_t * const p_data);
+static uint32_t get_le32(const uint8_t * const p_data);
+static uint32_t get_be16(const uint8_t * const p_data);
+static uint32_t get_be32(const uint8_t * const p_data);
+static uint32_t get_ext_rate(const uint8_t * const p_data);
+static bool check_file_spec(const pcm_ctrl_t * const p_ctrl);
+static pcm_kernel_t select_kernel(const pcm_ctrl_t * const p_ctrl, const bool is_unsigned);
+static uint32_t read_frames(const pcm_ctrl_t * const p_ctrl, 
+                        uint8_t * const p_buf, const uint32_t sample_num);
+static uint32_t kernel_u8(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s8(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s16le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s16be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s24le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s24be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s32le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static uint32_t kernel_s32be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+static inline uint32_t convert_kernel(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned);
+static inline uint32_t mix_kernel(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned);
+static inline int32_t load_sample(const uint8_t * const p_data, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned);
+
+/* Work of the downmix over 2ch. Only Decode thread uses it. */
+static uint8_t mix_raw_buf[MIX_SAMPLE_NUM * DEC_MAX_CHANNEL_NUM * BYTES_32BITS];
+static int32_t mix_ch_buf[DEC_MAX_CHANNEL_NUM][MIX_SAMPLE_NUM];
+
+bool pcm_check_header(const uint8_t * const p_head, const uint32_t size)
+{
+    bool        ret = false;
+
+    if ((p_head != NULL) && (size >= PCM_HEADER_SIZE)) {
+        if (memcmp(&p_head[0], "RIFF", CHUNK_ID_SIZE) == 0) {
+            if (memcmp(&p_head[RIFF_FORM_TYPE_POS], "WAVE", CHUNK_ID_SIZE) == 0) {
+                ret = true;
+            }
+        } else if (memcmp(&p_head[0], "FORM", CHUNK_ID_SIZE) == 0) {
+            if ((memcmp(&p_head[RIFF_FORM_TYPE_POS], "AIFF", CHUNK_ID_SIZE) == 0) || 
+                (memcmp(&p_head[RIFF_FORM_TYPE_POS], "AIFC", CHUNK_ID_SIZE) == 0)) {
+                ret = true;
+            }
+        } else {
+            /* DO NOTHING */
+        }
+    }
+    return ret;
+}
+
+bool pcm_set_pcm_buf(pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_buf_addr, const uint32_t buf_num)
+{
+    bool        ret = false;
+    if ((p_pcm_ctrl != NULL) && (p_buf_addr != NULL) && (buf_num > 0u)) {
+        p_pcm_ctrl->p_pcm_buf = p_buf_addr;
+        p_pcm_ctrl->pcm_buf_num = buf_num;
+        p_pcm_ctrl->pcm_buf_used_cnt = 0u;
+        ret = true;
+    }
+    return ret;
+}
+
+uint32_t pcm_get_pcm_cnt(const pcm_ctrl_t * const p_pcm_ctrl)
+{
+    uint32_t    ret = 0u;
+    if (p_pcm_ctrl != NULL) {
+        ret = p_pcm_ctrl->pcm_buf_used_cnt;
+    }
+    return ret;
+}
+
+bool pcm_set_position(pcm_ctrl_t * const p_pcm_ctrl, const uint64_t sample)
+{
+    bool        ret = false;
+    uint64_t    pos;
+    int         result;
+
+    if ((p_pcm_ctrl != NULL) && (sample < p_pcm_ctrl->total_sample)) {
+        pos = p_pcm_ctrl->data_pos + (sample * p_pcm_ctrl->frame_size);
+        if (pos <= (uint64_t)LONG_MAX) {
+            result = fseek(p_pcm_ctrl->p_file_handle, (long)pos, SEEK_SET);
+            if (result == 0) {
+                p_pcm_ctrl->decoded_sample = sample;
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+bool pcm_open(FILE * const p_handle, pcm_ctrl_t * const p_pcm_ctrl)
+{
+    bool        ret = false;
+    bool        result = false;
+    uint8_t     head[PCM_HEADER_SIZE];
+
+    if ((p_handle != NULL) && (p_pcm_ctrl != NULL)) {
+        init_ctrl_data(p_pcm_ctrl);
+        p_pcm_ctrl->p_file_handle = p_handle;
+        if (read_data(p_handle, &head[0], sizeof(head)) == true) {
+            if (memcmp(&head[0], "RIFF", CHUNK_ID_SIZE) == 0) {
+                result = parse_wav(p_pcm_ctrl);
+            } else if (memcmp(&head[RIFF_FORM_TYPE_POS], "AIFC", CHUNK_ID_SIZE) == 0) {
+                result = parse_aiff(p_pcm_ctrl, true);
+            } else {
+                result = parse_aiff(p_pcm_ctrl, false);
+            }
+        }
+        if ((result == true) && (check_file_spec(p_pcm_ctrl) == true)) {
+            if (p_pcm_ctrl->channel_num > STEREO_CH_NUM) {
+                /* The data over 2ch is downmixed by the kernel of the FLAC decoder. */
+                result = dmx_set_cfg(&p_pcm_ctrl->dmx_ctrl, p_pcm_ctrl->channel_num, 
+                                                    p_pcm_ctrl->bits_per_sample);
+            }
+            if ((result == true) && (p_pcm_ctrl->p_kernel != NULL)) {
+                ret = pcm_set_position(p_pcm_ctrl, 0uLL);
+            }
+        }
+    }
+    return ret;
+}
+
+bool pcm_decode(pcm_ctrl_t * const p_pcm_ctrl)
+{
+    bool            ret = false;
+    uint64_t        rest;
+    uint32_t        sample_num;
+    uint32_t        read_num;
+
+    if ((p_pcm_ctrl != NULL) && (p_pcm_ctrl->p_kernel != NULL) && (p_pcm_ctrl->p_pcm_buf != NULL)) {
+        sample_num = (p_pcm_ctrl->pcm_buf_num - p_pcm_ctrl->pcm_buf_used_cnt) / DEC_OUTPUT_CHANNEL_NUM;
+        if (sample_num > DEC_MAX_BLOCK_SIZE) {
+            sample_num = DEC_MAX_BLOCK_SIZE;
+        }
+        rest = p_pcm_ctrl->total_sample - p_pcm_ctrl->decoded_sample;
+        if ((uint64_t)sample_num > rest) {
+            sample_num = (uint32_t)rest;
+        }
+        if (sample_num > 0u) {
+            read_num = p_pcm_ctrl->p_kernel(p_pcm_ctrl, 
+                        &p_pcm_ctrl->p_pcm_buf[p_pcm_ctrl->pcm_buf_used_cnt], sample_num);
+            if (read_num < sample_num) {
+                /* The file is shorter than its header. It ends here. */
+                p_pcm_ctrl->total_sample = p_pcm_ctrl->decoded_sample + read_num;
+            }
+            if (read_num > 0u) {
+                p_pcm_ctrl->decoded_sample += read_num;
+                p_pcm_ctrl->pcm_buf_used_cnt += read_num * DEC_OUTPUT_CHANNEL_NUM;
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+void pcm_close(pcm_ctrl_t * const p_pcm_ctrl)
+{
+    if (p_pcm_ctrl != NULL) {
+        /* The file is closed by the caller. */
+        p_pcm_ctrl->p_file_handle = NULL;
+        p_pcm_ctrl->p_kernel = NULL;
+    }
+}
+
+/** Initialises the control data of WAV/AIFF module
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ */
+static void init_ctrl_data(pcm_ctrl_t * const p_ctrl)
+{
+    if (p_ctrl != NULL) {
+        p_ctrl->p_file_handle    = NULL;    /* Handle of WAV/AIFF file */
+        p_ctrl->decoded_sample   = 0uLL;    /* Number of a decoded sample */
+        p_ctrl->total_sample     = 0uLL;    /* Total number of sample */
+        p_ctrl->sample_rate      = 0u;      /* Sample rate in Hz */
+        p_ctrl->channel_num      = 0u;      /* Number of channels */
+        p_ctrl->bits_per_sample  = 0u;      /* Bit count of the container of a sample */
+        p_ctrl->frame_size       = 0u;      /* Bytes of a sample of all channels */
+        p_ctrl->data_pos         = 0u;      /* Position of the first sample in the file */
+        p_ctrl->is_big_endian    = false;   /* true for AIFF */
+        p_ctrl->p_kernel         = NULL;    /* Kernel for the data layout */
+        p_ctrl->p_pcm_buf        = NULL;    /* Pointer of PCM buffer */
+        p_ctrl->pcm_buf_num      = 0u;      /* Number of elements in PCM buffer */
+        p_ctrl->pcm_buf_used_cnt = 0u;      /* Counter of used elements in PCM buffer */
+        p_ctrl->dmx_ctrl.p_kernel = NULL;   /* Kernel of downmix */
+    }
+}
+
+/** Parses the chunks of WAV file until the data chunk
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool parse_wav(pcm_ctrl_t * const p_ctrl)
+{
+    bool        ret = false;
+    bool        result = true;
+    bool        is_fmt = false;
+    bool        is_data = false;
+    uint8_t     buf[WAV_FMT_EXT_SIZE];
+    uint32_t    size = 0u;
+    uint32_t    read_size;
+    uint32_t    format = 0u;
+    uint32_t    block_align = 0u;
+    uint32_t    valid_bits = 0u;
+    long        pos;
+
+    if (p_ctrl != NULL) {
+        while ((result == true) && (is_data != true)) {
+            result = read_data(p_ctrl->p_file_handle, &buf[0], CHUNK_HEADER_SIZE);
+            if (result == true) {
+                size = get_le32(&buf[CHUNK_ID_SIZE]);
+                if (memcmp(&buf[0], "fmt ", CHUNK_ID_SIZE) == 0) {
+                    read_size = (size < sizeof(buf)) ? size : sizeof(buf);
+                    result = (read_size >= WAV_FMT_MIN_SIZE);
+                    if (result == true) {
+                        result = read_data(p_ctrl->p_file_handle, &buf[0], read_size);
+                    }
+                    if (result == true) {
+                        format = get_le16(&buf[0]);
+                        p_ctrl->channel_num = get_le16(&buf[2]);
+                        p_ctrl->sample_rate = get_le32(&buf[4]);
+                        block_align = get_le16(&buf[12]);
+                        valid_bits = get_le16(&buf[14]);
+                        if ((format == WAV_FORMAT_EXTENSIBLE) && (read_size >= WAV_FMT_EXT_SIZE)) {
+                            /* The first 2 bytes of SubFormat GUID are the format code. */
+                            format = get_le16(&buf[WAV_FMT_SUBFORMAT_POS]);
+                        }
+                        is_fmt = true;
+                        /* Chunks of WAV are padded to an even size. */
+                        result = skip_data(p_ctrl->p_file_handle, (size - read_size) + (size & 1u));
+                    }
+                } else if (memcmp(&buf[0], "data", CHUNK_ID_SIZE) == 0) {
+                    pos = ftell(p_ctrl->p_file_handle);
+                    result = (pos >= 0);
+                    p_ctrl->data_pos = (uint32_t)pos;
+                    is_data = true;
+                } else {
+                    result = skip_data(p_ctrl->p_file_handle, size + (size & 1u));
+                }
+            }
+        }
+        if ((is_fmt == true) && (is_data == true) && (format == WAV_FORMAT_PCM) && 
+            (p_ctrl->channel_num > 0u) && ((block_align % p_ctrl->channel_num) == 0u)) {
+            /* The container of a sample is given by nBlockAlign. */
+            /* wBitsPerSample may be less than it in WAVE_FORMAT_EXTENSIBLE. */
+            p_ctrl->frame_size = block_align;
+            p_ctrl->bits_per_sample = (block_align / p_ctrl->channel_num) * BITS_PER_BYTE;
+            p_ctrl->is_big_endian = false;
+            if ((valid_bits > 0u) && (valid_bits <= p_ctrl->bits_per_sample)) {
+                if (size == WAV_DATA_SIZE_UNKNOWN) {
+                    /* The size of the stream is not written. It is played until the end of file. */
+                    p_ctrl->total_sample = (uint64_t)LONG_MAX / block_align;
+                } else {
+                    p_ctrl->total_sample = size / block_align;
+                }
+                /* 8bits data of WAV is unsigned. */
+                p_ctrl->p_kernel = select_kernel(p_ctrl, 
+                                    (p_ctrl->bits_per_sample == DEC_MIN_BITS_PER_SAMPLE));
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Parses the chunks of AIFF file until COMM chunk and SSND chunk
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param is_aifc true for AIFF-C.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool parse_aiff(pcm_ctrl_t * const p_ctrl, const bool is_aifc)
+{
+    bool        ret = false;
+    bool        result = true;
+    bool        is_comm = false;
+    bool        is_ssnd = false;
+    uint8_t     buf[AIFC_COMM_SIZE];
+    uint32_t    size;
+    uint32_t    read_size;
+    uint32_t    data_size = 0u;
+    uint32_t    frame_num = 0u;
+    uint32_t    bits = 0u;
+    long        pos;
+
+    if (p_ctrl != NULL) {
+        p_ctrl->is_big_endian = true;
+        while ((result == true) && ((is_comm != true) || (is_ssnd != true))) {
+            result = read_data(p_ctrl->p_file_handle, &buf[0], CHUNK_HEADER_SIZE);
+            if (result == true) {
+                size = get_be32(&buf[CHUNK_ID_SIZE]);
+                /* Chunks of AIFF are padded to an even size. */
+                size += (size & 1u);
+                if (memcmp(&buf[0], "COMM", CHUNK_ID_SIZE) == 0) {
+                    read_size = (is_aifc == true) ? AIFC_COMM_SIZE : AIFF_COMM_SIZE;
+                    result = (size >= read_size);
+                    if (result == true) {
+                        result = read_data(p_ctrl->p_file_handle, &buf[0], read_size);
+                    }
+                    if (result == true) {
+                        p_ctrl->channel_num = get_be16(&buf[0]);
+                        frame_num = get_be32(&buf[2]);
+                        bits = get_be16(&buf[6]);
+                        p_ctrl->sample_rate = get_ext_rate(&buf[8]);
+                        if (is_aifc == true) {
+                            if (memcmp(&buf[AIFF_COMM_SIZE], "sowt", CHUNK_ID_SIZE) == 0) {
+                                p_ctrl->is_big_endian = false;
+                            } else if (memcmp(&buf[AIFF_COMM_SIZE], "NONE", CHUNK_ID_SIZE) != 0) {
+                                /* Error : Compressed data */
+                                p_ctrl->channel_num = 0u;
+                            } else {
+                                /* DO NOTHING */
+                            }
+                        }
+                        is_comm = true;
+                        result = skip_data(p_ctrl->p_file_handle, size - read_size);
+                    }
+                } else if (memcmp(&buf[0], "SSND", CHUNK_ID_SIZE) == 0) {
+                    result = (size >= AIFF_SSND_HEADER_SIZE);
+                    if (result == true) {
+                        result = read_data(p_ctrl->p_file_handle, &buf[0], AIFF_SSND_HEADER_SIZE);
+                    }
+                    if (result == true) {
+                        /* The samples start after the offset. */
+                        read_size = AIFF_SSND_HEADER_SIZE + get_be32(&buf[0]);
+                        pos = ftell(p_ctrl->p_file_handle);
+                        result = ((pos >= 0) && (size >= read_size));
+                        p_ctrl->data_pos = (uint32_t)pos + (read_size - AIFF_SSND_HEADER_SIZE);
+                        data_size = size - read_size;
+                        is_ssnd = true;
+                        if (is_comm != true) {
+                            result = skip_data(p_ctrl->p_file_handle, size - AIFF_SSND_HEADER_SIZE);
+                        }
+                    }
+                } else {
+                    result = skip_data(p_ctrl->p_file_handle, size);
+                }
+            }
+        }
+        if ((is_comm == true) && (is_ssnd == true) && (p_ctrl->channel_num > 0u) && 
+            (bits > 0u) && (bits <= (BYTES_32BITS * BITS_PER_BYTE))) {
+            /* The sample is left-justified in the bytes of the container. */
+            p_ctrl->bits_per_sample = ((bits + (BITS_PER_BYTE - 1u)) / BITS_PER_BYTE) * BITS_PER_BYTE;
+            p_ctrl->frame_size = (p_ctrl->bits_per_sample / BITS_PER_BYTE) * p_ctrl->channel_num;
+            p_ctrl->total_sample = data_size / p_ctrl->frame_size;
+            if (p_ctrl->total_sample > frame_num) {
+                p_ctrl->total_sample = frame_num;
+            }
+            p_ctrl->p_kernel = select_kernel(p_ctrl, false);
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Reads the data of the file
+ *
+ *  @param p_handle Pointer to the handle of the file.
+ *  @param p_buf Pointer to the buffer to store the data.
+ *  @param size Size of the data.
+ *
+ *  @returns 
+ *    true if all data is read. Otherwise false.
+ */
+static bool read_data(FILE * const p_handle, uint8_t * const p_buf, const uint32_t size)
+{
+    bool        ret = false;
+    size_t      read_size;
+
+    if ((p_handle != NULL) && (p_buf != NULL)) {
+        read_size = fread(p_buf, sizeof(uint8_t), size, p_handle);
+        if (read_size == size) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Skips the data of the file
+ *
+ *  @param p_handle Pointer to the handle of the file.
+ *  @param size Size of the data.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool skip_data(FILE * const p_handle, const uint32_t size)
+{
+    bool        ret = false;
+    int         result;
+
+    if ((p_handle != NULL) && (size <= (uint32_t)LONG_MAX)) {
+        result = fseek(p_handle, (long)size, SEEK_CUR);
+        if (result == 0) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Gets 16bits little endian data
+ *
+ *  @param p_data Pointer to the data.
+ *
+ *  @returns 
+ *    The data.
+ */
+static uint32_t get_le16(const uint8_t * const p_data)
+{
+    return (uint32_t)p_data[0] | ((uint32_t)p_data[1] << 8);
+}
+
+/** Gets 32bits little endian data
+ *
+ *  @param p_data Pointer to the data.
+ *
+ *  @returns 
+ *    The data.
+ */
+static uint32_t get_le32(const uint8_t * const p_data)
+{
+    return get_le16(&p_data[0]) | (get_le16(&p_data[2]) << 16);
+}
+
+/** Gets 16bits big endian data
+ *
+ *  @param p_data Pointer to the data.
+ *
+ *  @returns 
+ *    The data.
+ */
+static uint32_t get_be16(const uint8_t * const p_data)
+{
+    return ((uint32_t)p_data[0] << 8) | (uint32_t)p_data[1];
+}
+
+/** Gets 32bits big endian data
+ *
+ *  @param p_data Pointer to the data.
+ *
+ *  @returns 
+ *    The data.
+ */
+static uint32_t get_be32(const uint8_t * const p_data)
+{
+    return (get_be16(&p_data[0]) << 16) | get_be16(&p_data[2]);
+}
+
+/** Gets the sampling rate of 80bits extended format of AIFF
+ *
+ *  @param p_data Pointer to the data.
+ *
+ *  @returns 
+ *    Sampling rate in Hz. 0 if it is not an integer of 32bits.
+ */
+static uint32_t get_ext_rate(const uint8_t * const p_data)
+{
+    uint32_t    ret = 0u;
+    uint64_t    mantissa;
+    int32_t     shift;
+
+    /* The integer part of the 64bits mantissa is got by the exponent. */
+    shift = AIFF_EXP_BIAS - (int32_t)(get_be16(&p_data[0]) & AIFF_EXP_MASK);
+    mantissa = ((uint64_t)get_be32(&p_data[2]) << 32) | get_be32(&p_data[6]);
+    if ((shift >= 32) && (shift < 64)) {
+        ret = (uint32_t)(mantissa >> shift);
+    }
+    return ret;
+}
+
+/** Checks the playable file of the playback
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ *
+ *  @returns 
+ *    Results of the checking. true is playable. false is not playable.
+ */
+static bool check_file_spec(const pcm_ctrl_t * const p_ctrl)
+{
+    bool    ret = false;
+
+    if (p_ctrl == NULL) {
+        /* Error : NULL pointer */
+    } else if ((p_ctrl->channel_num <= 0u) || 
+               (p_ctrl->channel_num > DEC_MAX_CHANNEL_NUM)) {
+        /* Error : Channel number is illegal specification */
+    } else if ((p_ctrl->bits_per_sample < DEC_MIN_BITS_PER_SAMPLE) || 
+               (p_ctrl->bits_per_sample > DEC_MAX_BITS_PER_SAMPLE)) {
+        /* Error : Bit per sample is illegal specification */
+    } else if ((p_ctrl->sample_rate < DEC_INPUT_MIN_SAMPLE_RATE) || 
+               (p_ctrl->sample_rate > DEC_INPUT_MAX_SAMPLE_RATE)) {
+        /* Error : Sample rate is illegal specification */
+    } else {
+        /* OK */
+        ret = true;
+    }
+    return ret;
+}
+
+/** Selects the kernel for the data layout
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param is_unsigned true if 8bits data is unsigned.
+ *
+ *  @returns 
+ *    Pointer to the kernel. NULL if the layout is not supported.
+ */
+static pcm_kernel_t select_kernel(const pcm_ctrl_t * const p_ctrl, const bool is_unsigned)
+{
+    pcm_kernel_t    ret = NULL;
+
+    if (p_ctrl != NULL) {
+        switch (p_ctrl->bits_per_sample / BITS_PER_BYTE) {
+            case BYTES_8BITS:
+                ret = (is_unsigned == true) ? &kernel_u8 : &kernel_s8;
+                break;
+            case BYTES_16BITS:
+                ret = (p_ctrl->is_big_endian == true) ? &kernel_s16be : &kernel_s16le;
+                break;
+            case BYTES_24BITS:
+                ret = (p_ctrl->is_big_endian == true) ? &kernel_s24be : &kernel_s24le;
+                break;
+            case BYTES_32BITS:
+                ret = (p_ctrl->is_big_endian == true) ? &kernel_s32be : &kernel_s32le;
+                break;
+            default:
+                /* Error : Bit per sample is illegal specification */
+                break;
+        }
+    }
+    return ret;
+}
+
+/** Reads the samples of the file
+ *
+ *  @param p_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param p_buf Pointer to the buffer to store the data.
+ *  @param sample_num Number of samples per channel.
+ *
+ *  @returns 
+ *    Number of samples per channel which were read.
+ */
+static uint32_t read_frames(const pcm_ctrl_t * const p_ctrl, 
+                        uint8_t * const p_buf, const uint32_t sample_num)
+{
+    size_t      read_size;
+
+    /* The sectors in the middle of the data are read to the buffer directly */
+    /* by the file system, without the copy through its sector buffer. */
+    read_size = fread(p_buf, sizeof(uint8_t), sample_num * p_ctrl->frame_size, p_ctrl->p_file_handle);
+    return (uint32_t)(read_size / p_ctrl->frame_size);
+}
+
+/* Kernels of each container. The parameters are constants in each kernel, */
+/* so that the loop of convert_kernel is specialized by the compiler. */
+static uint32_t kernel_u8(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_8BITS, false, true);
+}
+
+static uint32_t kernel_s8(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_8BITS, false, false);
+}
+
+static uint32_t kernel_s16le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    uint32_t        ret;
+    const uint32_t  *p_in;
+    uint32_t        data;
+    uint32_t        i;
+
+    if (p_pcm_ctrl->channel_num == STEREO_CH_NUM) {
+        /* A sample of 2ch is a word. The file data is read to the latter half */
+        /* of the output, and a word is expanded to 2 words from the top. */
+        p_in = (const uint32_t *)&p_out[sample_num];
+        ret = read_frames(p_pcm_ctrl, (uint8_t *)&p_out[sample_num], sample_num);
+        for (i = 0u; i < ret; i++) {
+            data = p_in[i];
+            p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 0u] = (int32_t)(data << 16);
+            p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 1u] = (int32_t)(data & UPPER_16BITS);
+        }
+    } else {
+        ret = convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_16BITS, false, false);
+    }
+    return ret;
+}
+
+static uint32_t kernel_s16be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_16BITS, true, false);
+}
+
+static uint32_t kernel_s24le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_24BITS, false, false);
+}
+
+static uint32_t kernel_s24be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_24BITS, true, false);
+}
+
+static uint32_t kernel_s32le(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    uint32_t        ret;
+
+    if (p_pcm_ctrl->channel_num == STEREO_CH_NUM) {
+        /* The file data is the layout of the PCM buffer. It is read without */
+        /* the conversion. The lower 8bits are left in the padding of SCUX input. */
+        ret = read_frames(p_pcm_ctrl, (uint8_t *)p_out, sample_num);
+    } else {
+        ret = convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_32BITS, false, false);
+    }
+    return ret;
+}
+
+static uint32_t kernel_s32be(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num)
+{
+    return convert_kernel(p_pcm_ctrl, p_out, sample_num, BYTES_32BITS, true, false);
+}
+
+/** Reads the samples and converts them to the interleaved stereo PCM data
+ *
+ *  The data of 1ch and 2ch is read to the end of the output, and it is
+ *  converted in place from the top. The output of a sample is not shorter
+ *  than its input, so the input is not overwritten before it is converted.
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param p_out Pointer to PCM buffer. 
+ *               The buffer needs (sample_num * DEC_OUTPUT_CHANNEL_NUM) elements.
+ *  @param sample_num Number of samples per channel.
+ *  @param bytes Bytes of the container of a sample.
+ *  @param is_big true if the data is big endian.
+ *  @param is_unsigned true if the data is unsigned.
+ *
+ *  @returns 
+ *    Number of samples per channel which were converted.
+ */
+static inline uint32_t convert_kernel(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned)
+{
+    uint32_t        ret;
+    uint8_t         *p_in;
+    int32_t         data_l;
+    int32_t         data_r;
+    uint32_t        i;
+
+    if (p_pcm_ctrl->channel_num > STEREO_CH_NUM) {
+        ret = mix_kernel(p_pcm_ctrl, p_out, sample_num, bytes, is_big, is_unsigned);
+    } else {
+        p_in = (uint8_t *)&p_out[sample_num * DEC_OUTPUT_CHANNEL_NUM];
+        p_in -= sample_num * p_pcm_ctrl->frame_size;
+        ret = read_frames(p_pcm_ctrl, p_in, sample_num);
+        if (p_pcm_ctrl->channel_num == MONO_CH_NUM) {
+            for (i = 0u; i < ret; i++) {
+                data_l = load_sample(&p_in[i * bytes], bytes, is_big, is_unsigned);
+                p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 0u] = data_l;
+                p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 1u] = data_l;
+            }
+        } else {
+            for (i = 0u; i < ret; i++) {
+                data_l = load_sample(&p_in[(i * STEREO_CH_NUM) * bytes], bytes, is_big, is_unsigned);
+                data_r = load_sample(&p_in[((i * STEREO_CH_NUM) + 1u) * bytes], bytes, is_big, is_unsigned);
+                p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 0u] = data_l;
+                p_out[(i * DEC_OUTPUT_CHANNEL_NUM) + 1u] = data_r;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Reads the samples over 2ch and downmixes them to the interleaved stereo PCM data
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param p_out Pointer to PCM buffer. 
+ *               The buffer needs (sample_num * DEC_OUTPUT_CHANNEL_NUM) elements.
+ *  @param sample_num Number of samples per channel.
+ *  @param bytes Bytes of the container of a sample.
+ *  @param is_big true if the data is big endian.
+ *  @param is_unsigned true if the data is unsigned.
+ *
+ *  @returns 
+ *    Number of samples per channel which were converted.
+ */
+static inline uint32_t mix_kernel(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned)
+{
+    uint32_t        ret = 0u;
+    uint32_t        num;
+    uint32_t        read_num = MIX_SAMPLE_NUM;
+    const int32_t   *p_in[DEC_MAX_CHANNEL_NUM];
+    const uint32_t  ch_num = p_pcm_ctrl->channel_num;
+    const uint32_t  rshift = (BYTES_32BITS - bytes) * BITS_PER_BYTE;
+    uint32_t        i;
+    uint32_t        ch;
+
+    for (ch = 0u; ch < DEC_MAX_CHANNEL_NUM; ch++) {
+        p_in[ch] = &mix_ch_buf[ch][0];
+    }
+    while ((ret < sample_num) && (read_num == MIX_SAMPLE_NUM)) {
+        num = sample_num - ret;
+        if (num > MIX_SAMPLE_NUM) {
+            num = MIX_SAMPLE_NUM;
+        }
+        read_num = read_frames(p_pcm_ctrl, &mix_raw_buf[0], num);
+        /* The channels are separated to the format of the FLAC decoder output. */
+        for (i = 0u; i < read_num; i++) {
+            for (ch = 0u; ch < ch_num; ch++) {
+                mix_ch_buf[ch][i] = load_sample(&mix_raw_buf[((i * ch_num) + ch) * bytes], 
+                                                bytes, is_big, is_unsigned) >> rshift;
+            }
+        }
+        (void) dmx_convert(&p_pcm_ctrl->dmx_ctrl, p_in, &p_out[ret * DEC_OUTPUT_CHANNEL_NUM], read_num);
+        ret += read_num;
+    }
+    return ret;
+}
+
+/** Loads a sample and left-justifies it in 32bits
+ *
+ *  @param p_data Pointer to the sample.
+ *  @param bytes Bytes of the container of a sample.
+ *  @param is_big true if the data is big endian.
+ *  @param is_unsigned true if the data is unsigned.
+ *
+ *  @returns 
+ *    The sample left-justified in 32bits.
+ */
+static inline int32_t load_sample(const uint8_t * const p_data, 
+                        const uint32_t bytes, const bool is_big, const bool is_unsigned)
+{
+    uint32_t    data = 0u;
+    uint32_t    i;
+
+    for (i = 0u; i < bytes; i++) {
+        if (is_big == true) {
+            data |= (uint32_t)p_data[i] << (24u - (i * BITS_PER_BYTE));
+        } else {
+            data |= (uint32_t)p_data[i] << ((32u - (bytes * BITS_PER_BYTE)) + (i * BITS_PER_BYTE));
+        }
+    }
+    if (is_unsigned == true) {
+        data ^= SIGN_BIT;
+    }
+    return (int32_t)data;
+}
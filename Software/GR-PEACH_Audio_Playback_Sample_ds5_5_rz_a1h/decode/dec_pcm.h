@@ -0,0 +1,132 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_PCM_H
+#define DEC_PCM_H
+
+#include "r_typedefs.h"
+#include "dec_dmx.h"
+
+/*--- Macro definition ---*/
+#define PCM_HEADER_SIZE         (12u)   /* Size of the header checked by pcm_check_header() */
+
+/*--- User defined types ---*/
+typedef struct pcm_ctrl_st pcm_ctrl_t;
+
+/* Kernel which converts the file data to the PCM buffer */
+typedef uint32_t (*pcm_kernel_t)(const pcm_ctrl_t * const p_pcm_ctrl, 
+                        int32_t * const p_out, const uint32_t sample_num);
+
+/* Control data of WAV/AIFF module */
+struct pcm_ctrl_st {
+    FILE                    *p_file_handle;     /* Handle of WAV/AIFF file */
+    uint64_t                decoded_sample;     /* Number of a decoded sample */
+    uint64_t                total_sample;       /* Total number of sample */
+    uint32_t                sample_rate;        /* Sample rate in Hz */
+    uint32_t                channel_num;        /* Number of channels */
+    uint32_t                bits_per_sample;    /* Bit count of the container of a sample */
+    uint32_t                frame_size;         /* Bytes of a sample of all channels */
+    uint32_t                data_pos;           /* Position of the first sample in the file */
+    bool                    is_big_endian;      /* true for AIFF */
+    pcm_kernel_t            p_kernel;           /* Kernel for the data layout */
+    int32_t                 *p_pcm_buf;         /* Pointer of PCM buffer */
+    uint32_t                pcm_buf_num;        /* Size of PCM buffer */
+    uint32_t                pcm_buf_used_cnt;   /* Counter of used elements in PCM buffer */
+    dmx_ctrl_t              dmx_ctrl;           /* Control data of downmix over 2ch */
+};
+
+/** Checks whether the file is WAV or AIFF
+ *
+ *  @param p_head Pointer to the first PCM_HEADER_SIZE bytes of the file.
+ *  @param size Size of the data in p_head.
+ *
+ *  @returns 
+ *    true if the file is WAV or AIFF. Otherwise false.
+ */
+bool pcm_check_header(const uint8_t * const p_head, const uint32_t size);
+
+/** Sets the PCM buffer to store decoded data
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param p_buf_addr Pointer to PCM buffer to store decoded data.
+ *  @param buf_num Elements number of PCM buffer array.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool pcm_set_pcm_buf(pcm_ctrl_t * const p_pcm_ctrl, 
+        int32_t * const p_buf_addr, const uint32_t buf_num);
+
+/** Gets elements number of the decoded data
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *
+ *  @returns 
+ *    Elements number of the decoded data.
+ */
+uint32_t pcm_get_pcm_cnt(const pcm_ctrl_t * const p_pcm_ctrl);
+
+/** Sets the position to decode next
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *  @param sample Position in samples from the start of the track.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool pcm_set_position(pcm_ctrl_t * const p_pcm_ctrl, const uint64_t sample);
+
+/** Opens WAV/AIFF file
+ *
+ *  The chunks are parsed once, and the kernel for the data layout is selected.
+ *  Integer PCM of WAV (WAVE_FORMAT_PCM and WAVE_FORMAT_EXTENSIBLE), AIFF and
+ *  AIFF-C ("NONE" and "sowt") is supported.
+ *
+ *  @param p_handle Pointer to the handle of WAV/AIFF file.
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool pcm_open(FILE * const p_handle, pcm_ctrl_t * const p_pcm_ctrl);
+
+/** Reads some audio frames.
+ *
+ *  DEC_MAX_BLOCK_SIZE samples or less are read to the PCM buffer by a read of
+ *  the file. The data of 1ch and 2ch is converted in place. The data of 2ch
+ *  with 32bits little endian container is not converted.
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool pcm_decode(pcm_ctrl_t * const p_pcm_ctrl);
+
+/** Closes WAV/AIFF file
+ *
+ *  @param p_pcm_ctrl Pointer to the control data of WAV/AIFF module.
+ */
+void pcm_close(pcm_ctrl_t * const p_pcm_ctrl);
+
+#endif /* DEC_PCM_H */
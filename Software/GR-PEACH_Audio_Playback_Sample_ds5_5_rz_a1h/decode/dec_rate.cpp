@@ -0,0 +1,87 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "misratypes.h"
+#include "dec_rate.h"
+#include "dec_src.h"
+
+uint32_t rate_get_scux_input_rate(const uint32_t file_rate)
+{
+    uint32_t    input_rate = file_rate;
+
+    if (file_rate > DEC_SCUX_MAX_SAMPLE_RATE) {
+        /* SCUX does not support the rate. Decimates it by 2 before SCUX. */
+        input_rate = file_rate / SRC_DECIMATION_RATIO;
+    }
+    return input_rate;
+}
+
+uint32_t rate_select_output_rate(const uint32_t input_rate)
+{
+    uint32_t    output_rate = DEC_OUTPUT_SAMPLE_RATE;
+
+#if (DEC_NATIVE_RATE_OUTPUT == 1)
+    /* The rates which are supported by both TLV320 and the SRC bypass of SCUX */
+    switch (input_rate) {
+        case SAMPLING_RATE_44100HZ:
+            /* fall through */
+        case SAMPLING_RATE_48000HZ:
+            /* fall through */
+        case SAMPLING_RATE_88200HZ:
+            /* fall through */
+        case SAMPLING_RATE_96000HZ:
+            output_rate = input_rate;
+            break;
+        default:
+            /* Converts to DEC_OUTPUT_SAMPLE_RATE by SRC. */
+            break;
+    }
+#else
+    UNUSED_ARG(input_rate);
+#endif /* DEC_NATIVE_RATE_OUTPUT */
+    return output_rate;
+}
+
+bool rate_set_scux_src_cfg(scux_src_usr_cfg_t * const p_conf, 
+                            const uint32_t input_rate, const uint32_t output_rate)
+{
+    bool        ret = false;
+
+    if (p_conf != NULL) {
+        if (output_rate == input_rate) {
+            /* Bypasses SRC. Bypass mode is available in asynchronous mode only. */
+            p_conf->src_enable    = false;
+            p_conf->mode_sync     = false;
+        } else {
+            p_conf->src_enable    = true;
+            p_conf->mode_sync     = true;
+        }
+        p_conf->word_len              = SCUX_DATA_LEN_24;
+        p_conf->input_rate            = input_rate;
+        p_conf->output_rate           = output_rate;
+        p_conf->select_in_data_ch[0]  = SELECT_IN_DATA_CH_0;
+        p_conf->select_in_data_ch[1]  = SELECT_IN_DATA_CH_1;
+        ret = true;
+    }
+    return ret;
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_RATE_H
+#define DEC_RATE_H
+
+#include "r_typedefs.h"
+#include "decode.h"
+
+/** Gets the sampling rate of SCUX input for the file
+ *
+ *  The file over DEC_SCUX_MAX_SAMPLE_RATE is decimated by the software SRC.
+ *
+ *  @param file_rate Sampling rate of the file to be played back.
+ *
+ *  @returns
+ *    Sampling rate of SCUX input. When it is not equal to file_rate, 
+ *    the software SRC decimates the data before SCUX.
+ */
+uint32_t rate_get_scux_input_rate(const uint32_t file_rate);
+
+/** Selects the sampling rate of audio output
+ *
+ *  When DEC_NATIVE_RATE_OUTPUT is 1, the rates supported by both TLV320 and 
+ *  the SRC bypass of SCUX are output as they are. Other rates are converted 
+ *  to DEC_OUTPUT_SAMPLE_RATE.
+ *
+ *  @param input_rate Sampling rate of SCUX input.
+ *
+ *  @returns
+ *    Sampling rate of audio output. When it is equal to input_rate, 
+ *    the SRC of SCUX is bypassed.
+ */
+uint32_t rate_select_output_rate(const uint32_t input_rate);
+
+/** Sets the SRC config of SCUX for the rates
+ *
+ *  SRC is bypassed when the rates are the same. Bypass mode is available 
+ *  in asynchronous mode only, so the mode is selected together.
+ *
+ *  @param p_conf Pointer to the SRC config of SCUX to be set.
+ *  @param input_rate Sampling rate of SCUX input.
+ *  @param output_rate Sampling rate of SCUX output.
+ *
+ *  @returns
+ *    Results of process. true is success. false is failure.
+ */
+bool rate_set_scux_src_cfg(scux_src_usr_cfg_t * const p_conf, 
+                            const uint32_t input_rate, const uint32_t output_rate);
+
+#endif /* DEC_RATE_H */
@@ -0,0 +1,168 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "misratypes.h"
+#include "dec_src.h"
+
+/*--- Macro definition ---*/
+#define HB_CENTER_TAP       ((SRC_HB_TAP_NUM - 1u) / 2u)    /* Index of the center tap */
+#define HB_COEF_NUM         ((HB_CENTER_TAP + 1u) / 2u)     /* Number of non-zero side taps per side */
+#define HB_COEF_FRAC_BITS   (31)                            /* Coefficients are Q31 */
+#define HB_CENTER_COEF_SHIFT (HB_COEF_FRAC_BITS - 1)        /* Center tap is 0.5 */
+#define HB_ROUND_VAL        ((int64_t)1 << (HB_COEF_FRAC_BITS - 1))
+#define PCM_PADDING_BITS    (DEC_OUTPUT_PADDING_BITS)
+#define PCM_MAX_VAL         ((int32_t)0x007FFFFF)           /* Maximum value of 24bits data */
+#define PCM_MIN_VAL         ((int32_t)-0x00800000)          /* Minimum value of 24bits data */
+
+/* Odd side taps of the half-band low pass filter (Q31). */
+/* Index i is the coefficient at the distance (2 * i + 1) from the center tap. */
+/* Kaiser window (beta = 8). Passband : 0 to 0.21 fs, Stopband : 0.29 fs to 0.5 fs (-70dB) */
+static const int32_t hb_coef[HB_COEF_NUM] = {
+     680908763, -219993598,  123961433,  -80507829,
+      55056506,  -38235300,   26447511,  -17987774,
+      11904891,   -7590096,    4608303,   -2624388,
+       1370323,    -630415,     234154,     -51572
+};
+
+static int32_t hb_filter(const int32_t * const p_win);
+
+bool src_set_cfg(src_ctrl_t * const p_src_ctrl, const src_cfg_t * const p_src_cfg)
+{
+    bool        ret = false;
+    uint32_t    ch;
+    uint32_t    i;
+
+    if ((p_src_ctrl != NULL) && (p_src_cfg != NULL)) {
+        if (p_src_cfg->src_enable == false) {
+            ret = true;
+        } else if ((p_src_cfg->input_rate > 0u) && 
+                   ((p_src_cfg->output_rate * SRC_DECIMATION_RATIO) == p_src_cfg->input_rate)) {
+            ret = true;
+        } else {
+            /* Error : The ratio is not supported. */
+        }
+        if (ret == true) {
+            p_src_ctrl->src_enable  = p_src_cfg->src_enable;
+            p_src_ctrl->input_rate  = p_src_cfg->input_rate;
+            p_src_ctrl->output_rate = p_src_cfg->output_rate;
+            p_src_ctrl->write_pos   = 0u;
+            p_src_ctrl->phase       = 0u;
+            for (ch = 0u; ch < DEC_OUTPUT_CHANNEL_NUM; ch++) {
+                for (i = 0u; i < (SRC_HB_TAP_NUM * 2u); i++) {
+                    p_src_ctrl->delay[ch][i] = 0;
+                }
+            }
+        } else {
+            p_src_ctrl->src_enable  = false;
+        }
+    }
+    return ret;
+}
+
+uint32_t src_get_output_rate(const src_ctrl_t * const p_src_ctrl)
+{
+    uint32_t    ret = 0u;
+
+    if (p_src_ctrl != NULL) {
+        if (p_src_ctrl->src_enable == true) {
+            ret = p_src_ctrl->output_rate;
+        } else {
+            ret = p_src_ctrl->input_rate;
+        }
+    }
+    return ret;
+}
+
+uint32_t src_convert(src_ctrl_t * const p_src_ctrl,
+                        int32_t * const p_buf, const uint32_t sample_num)
+{
+    uint32_t    ret = sample_num;
+    uint32_t    in_idx;
+    uint32_t    out_idx;
+    uint32_t    pos;
+    uint32_t    ch;
+
+    if ((p_src_ctrl != NULL) && (p_buf != NULL) && (p_src_ctrl->src_enable == true)) {
+        pos = p_src_ctrl->write_pos;
+        out_idx = 0u;
+        /* The output is written behind the input, so the conversion is done in place. */
+        for (in_idx = 0u; (in_idx + DEC_OUTPUT_CHANNEL_NUM) <= sample_num; 
+                                            in_idx += DEC_OUTPUT_CHANNEL_NUM) {
+            for (ch = 0u; ch < DEC_OUTPUT_CHANNEL_NUM; ch++) {
+                /* Removes the padding bits. */
+                p_src_ctrl->delay[ch][pos] = p_buf[in_idx + ch] >> PCM_PADDING_BITS;
+                p_src_ctrl->delay[ch][pos + SRC_HB_TAP_NUM] = p_src_ctrl->delay[ch][pos];
+            }
+            pos++;
+            if (pos >= SRC_HB_TAP_NUM) {
+                pos = 0u;
+            }
+            p_src_ctrl->phase++;
+            if (p_src_ctrl->phase >= SRC_DECIMATION_RATIO) {
+                p_src_ctrl->phase = 0u;
+                for (ch = 0u; ch < DEC_OUTPUT_CHANNEL_NUM; ch++) {
+                    /* delay[ch][pos] is the oldest sample of the filter window. */
+                    p_buf[out_idx] = (int32_t)((uint32_t)hb_filter(&p_src_ctrl->delay[ch][pos]) 
+                                                                        << PCM_PADDING_BITS);
+                    out_idx++;
+                }
+            }
+        }
+        p_src_ctrl->write_pos = pos;
+        ret = out_idx;
+    }
+    return ret;
+}
+
+/** Calculates one output sample of the half-band low pass filter
+ *
+ *  @param p_win Pointer to the oldest sample of the filter window. (SRC_HB_TAP_NUM samples)
+ *
+ *  @returns 
+ *    Filtered sample. (24bits data without padding)
+ */
+static int32_t hb_filter(const int32_t * const p_win)
+{
+    int64_t     acc;
+    int32_t     ret;
+    uint32_t    i;
+    uint32_t    dist;
+
+    acc = ((int64_t)p_win[HB_CENTER_TAP] << HB_CENTER_COEF_SHIFT) + HB_ROUND_VAL;
+    /* The even side taps are zero. The odd side taps are symmetric, */
+    /* so the pair of samples is added before the multiplication. */
+    for (i = 0u; i < HB_COEF_NUM; i++) {
+        dist = (i * 2u) + 1u;
+        acc += (int64_t)hb_coef[i] * 
+                    (int64_t)(p_win[HB_CENTER_TAP - dist] + p_win[HB_CENTER_TAP + dist]);
+    }
+    acc >>= HB_COEF_FRAC_BITS;
+    if (acc > PCM_MAX_VAL) {
+        ret = PCM_MAX_VAL;
+    } else if (acc < PCM_MIN_VAL) {
+        ret = PCM_MIN_VAL;
+    } else {
+        ret = (int32_t)acc;
+    }
+    return ret;
+}
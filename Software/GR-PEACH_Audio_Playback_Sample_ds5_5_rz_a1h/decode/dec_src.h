@@ -0,0 +1,93 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_SRC_H
+#define DEC_SRC_H
+
+#include "r_typedefs.h"
+#include "decode.h"
+
+/*--- Macro definition ---*/
+#define SRC_HB_TAP_NUM          (63u)   /* Number of taps of the half-band filter */
+#define SRC_DECIMATION_RATIO    (2u)    /* Decimation ratio of the half-band filter */
+
+/*--- User defined types ---*/
+/* SRC parameter information (The same shape as scux_src_usr_cfg_t) */
+typedef struct {
+    bool                    src_enable;         /* SRC function enable setting */
+    uint32_t                input_rate;         /* Input sampling rate */
+    uint32_t                output_rate;        /* Output sampling rate */
+} src_cfg_t;
+
+/* Control data of software SRC */
+/* It only decimates by SRC_DECIMATION_RATIO in front of SCUX. Any other */
+/* conversion of the sampling rate is done by the SRC of SCUX. */
+typedef struct {
+    bool                    src_enable;         /* SRC function enable setting */
+    uint32_t                input_rate;         /* Input sampling rate */
+    uint32_t                output_rate;        /* Output sampling rate */
+    uint32_t                write_pos;          /* Write position of the delay line */
+    uint32_t                phase;              /* Input sample count modulo decimation ratio */
+    /* Delay line of each channel. The same data is stored twice so that */
+    /* the filter window is always contiguous. */
+    int32_t                 delay[DEC_OUTPUT_CHANNEL_NUM][SRC_HB_TAP_NUM * 2u];
+} src_ctrl_t;
+
+/** Sets up the software SRC parameters and clears the filter state
+ *
+ *  @param p_src_ctrl Pointer to the control data of software SRC.
+ *  @param p_src_cfg Pointer to SRC parameter information.
+ *                   When src_enable is true, output_rate must be
+ *                   input_rate / SRC_DECIMATION_RATIO.
+ *
+ *  @returns
+ *    Results of process. true is success. false is failure.
+ */
+bool src_set_cfg(src_ctrl_t * const p_src_ctrl, const src_cfg_t * const p_src_cfg);
+
+/** Gets the output sampling rate of the software SRC
+ *
+ *  @param p_src_ctrl Pointer to the control data of software SRC.
+ *
+ *  @returns
+ *    Output sampling rate. When SRC is disabled, this is the input sampling rate.
+ */
+uint32_t src_get_output_rate(const src_ctrl_t * const p_src_ctrl);
+
+/** Converts the sampling rate of PCM data in place
+ *
+ *  When SRC is enabled, the data is low pass filtered by the half-band filter
+ *  and decimated by SRC_DECIMATION_RATIO. The filter state is kept between calls.
+ *  When SRC is disabled, the data is not changed.
+ *
+ *  @param p_src_ctrl Pointer to the control data of software SRC.
+ *  @param p_buf Pointer to PCM buffer. (2ch interleaved, 24bits data with 8bits padding)
+ *  @param sample_num Elements number of PCM data in p_buf.
+ *
+ *  @returns
+ *    Elements number of the converted PCM data in p_buf.
+ */
+uint32_t src_convert(src_ctrl_t * const p_src_ctrl,
+                        int32_t * const p_buf, const uint32_t sample_num);
+
+#endif /* DEC_SRC_H */
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include <math.h>
+#include "misratypes.h"
+#include "R_BSP_Scux.h"
+#include "dec_vol.h"
+
+/*--- Macro definition ---*/
+#define VOL_DB_TO_AMP_DIV       (20.0f)     /* Amplitude ratio is 10^(dB/20) */
+#define VOL_ROUND_VAL           (VOL_GAIN_UNIT / 2)
+
+void vol_init(vol_ctrl_t * const p_vol_ctrl)
+{
+    if (p_vol_ctrl != NULL) {
+        p_vol_ctrl->volume = VOL_MAX;
+        p_vol_ctrl->mute = false;
+        p_vol_ctrl->replay_gain = 0;
+    }
+}
+
+bool vol_set_volume(vol_ctrl_t * const p_vol_ctrl, const int32_t volume, const bool mute)
+{
+    bool        ret = false;
+
+    if ((p_vol_ctrl != NULL) && (volume >= VOL_MIN) && (volume <= VOL_MAX)) {
+        p_vol_ctrl->volume = volume;
+        p_vol_ctrl->mute = mute;
+        ret = true;
+    }
+    return ret;
+}
+
+void vol_set_replay_gain(vol_ctrl_t * const p_vol_ctrl, const int32_t replay_gain)
+{
+    if (p_vol_ctrl != NULL) {
+        if (replay_gain < VOL_MIN_REPLAY_GAIN) {
+            p_vol_ctrl->replay_gain = VOL_MIN_REPLAY_GAIN;
+        } else if (replay_gain > VOL_MAX_REPLAY_GAIN) {
+            p_vol_ctrl->replay_gain = VOL_MAX_REPLAY_GAIN;
+        } else {
+            p_vol_ctrl->replay_gain = replay_gain;
+        }
+    }
+}
+
+uint32_t vol_get_digi_vol(const vol_ctrl_t * const p_vol_ctrl)
+{
+    uint32_t    digi_vol = DVU_DIGI_VOL_0DB;
+    float       amp;
+
+    if (p_vol_ctrl != NULL) {
+        amp = powf(10.0f, ((float)p_vol_ctrl->replay_gain / (float)VOL_GAIN_UNIT) / VOL_DB_TO_AMP_DIV);
+        amp = amp * (float)DVU_DIGI_VOL_0DB;
+        if (amp >= (float)DVU_DIGI_VOL_MAX) {
+            digi_vol = DVU_DIGI_VOL_MAX;
+        } else {
+            digi_vol = (uint32_t)lrintf(amp);
+        }
+    }
+    return digi_vol;
+}
+
+uint32_t vol_get_ramp_vol(const vol_ctrl_t * const p_vol_ctrl)
+{
+    uint32_t    ramp_vol = DVU_RAMP_VOL_0DB;
+
+    if (p_vol_ctrl != NULL) {
+        if (p_vol_ctrl->mute == true) {
+            ramp_vol = DVU_RAMP_VOL_MUTE;
+        } else {
+            /* The ramp volume is the attenuation. VOL_MIN is far from DVU_RAMP_VOL_MUTE. */
+            ramp_vol = DVU_RAMP_VOL_0DB + ((uint32_t)(VOL_MAX - p_vol_ctrl->volume) * DVU_RAMP_VOL_PER_DB);
+        }
+    }
+    return ramp_vol;
+}
+
+int32_t vol_get_gain(const vol_ctrl_t * const p_vol_ctrl)
+{
+    int32_t     gain = 0;
+    int32_t     rg;
+
+    if (p_vol_ctrl != NULL) {
+        /* Rounds ReplayGain to 1dB unit. */
+        rg = p_vol_ctrl->replay_gain;
+        if (rg >= 0) {
+            rg = (rg + VOL_ROUND_VAL) / VOL_GAIN_UNIT;
+        } else {
+            rg = -((VOL_ROUND_VAL - rg) / VOL_GAIN_UNIT);
+        }
+        gain = p_vol_ctrl->volume + rg;
+    }
+    return gain;
+}
@@ -0,0 +1,98 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_VOL_H
+#define DEC_VOL_H
+
+#include "r_typedefs.h"
+
+/*--- Macro definition ---*/
+#define VOL_MIN                 (-60)       /* Minimum volume in dB */
+#define VOL_MAX                 (0)         /* Maximum volume in dB */
+#define VOL_GAIN_UNIT           (100)       /* ReplayGain is 0.01dB unit */
+#define VOL_MIN_REPLAY_GAIN     (-2400)     /* Minimum ReplayGain (0.01dB unit) */
+#define VOL_MAX_REPLAY_GAIN     (1800)      /* Maximum ReplayGain (0.01dB unit) */
+
+/*--- User defined types ---*/
+/* Control data of the volume */
+typedef struct {
+    int32_t                 volume;         /* Volume in dB. VOL_MIN to VOL_MAX */
+    bool                    mute;           /* Mute. true is on. */
+    int32_t                 replay_gain;    /* ReplayGain of the track (0.01dB unit) */
+} vol_ctrl_t;
+
+/** Initialises the control data of the volume
+ *
+ *  The volume is set to VOL_MAX without mute and ReplayGain.
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ */
+void vol_init(vol_ctrl_t * const p_vol_ctrl);
+
+/** Sets the volume and the mute
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *  @param volume Volume in dB. VOL_MIN to VOL_MAX
+ *  @param mute Mute. true is on.
+ *
+ *  @returns
+ *    Results of process. true is success. false is failure.
+ */
+bool vol_set_volume(vol_ctrl_t * const p_vol_ctrl, const int32_t volume, const bool mute);
+
+/** Sets ReplayGain of the track
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *  @param replay_gain ReplayGain (0.01dB unit). 
+ *                     It is limited to VOL_MIN_REPLAY_GAIN to VOL_MAX_REPLAY_GAIN.
+ */
+void vol_set_replay_gain(vol_ctrl_t * const p_vol_ctrl, const int32_t replay_gain);
+
+/** Gets the digital volume value of SCUX DVU which applies ReplayGain
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns
+ *    Digital volume value. DVU_DIGI_VOL_0DB is 0 dB.
+ */
+uint32_t vol_get_digi_vol(const vol_ctrl_t * const p_vol_ctrl);
+
+/** Gets the ramp volume value of SCUX DVU which applies the volume and the mute
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns
+ *    Ramp volume value. DVU_RAMP_VOL_0DB to DVU_RAMP_VOL_MUTE
+ */
+uint32_t vol_get_ramp_vol(const vol_ctrl_t * const p_vol_ctrl);
+
+/** Gets the total gain of the volume and ReplayGain
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns
+ *    Total gain in dB. The mute is not included.
+ */
+int32_t vol_get_gain(const vol_ctrl_t * const p_vol_ctrl);
+
+#endif /* DEC_VOL_H */
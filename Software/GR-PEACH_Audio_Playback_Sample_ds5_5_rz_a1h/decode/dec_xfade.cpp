@@ -0,0 +1,250 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "misratypes.h"
+#include "decode.h"
+#include "dec_xfade.h"
+
+/*--- Macro definition ---*/
+#define XFADE_GAIN_FRAC_BITS    (15)                            /* Gains are Q15 */
+#define XFADE_GAIN_ONE          ((int32_t)1 << XFADE_GAIN_FRAC_BITS)
+#define XFADE_ROUND_VAL         ((int64_t)1 << (XFADE_GAIN_FRAC_BITS - 1))
+#define XFADE_POS_FRAC_BITS     (16)                            /* Position of the fade is Q16 */
+#define XFADE_POS_ONE           ((uint32_t)1 << XFADE_POS_FRAC_BITS)
+#define XFADE_TABLE_SHIFT       (8)
+#define XFADE_TABLE_SIZE        (1u << XFADE_TABLE_SHIFT)       /* Segments of the quarter sine */
+#define XFADE_TABLE_FRAC_MASK   ((1u << (XFADE_POS_FRAC_BITS - XFADE_TABLE_SHIFT)) - 1u)
+#define XFADE_STEP_SHIFT        (5)
+#define XFADE_STEP_FRAME_NUM    (1u << XFADE_STEP_SHIFT)        /* Frames per update of the gains */
+#define XFADE_CH_L              (0u)
+#define XFADE_CH_R              (1u)
+#define XFADE_HALF_PI           (1.57079633f)
+#define SEC_TO_MSEC             (1000u)
+#define PCM_PADDING_BITS        (DEC_OUTPUT_PADDING_BITS)
+#define PCM_MAX_VAL             ((int32_t)0x007FFFFF)           /* Maximum value of 24bits data */
+#define PCM_MIN_VAL             ((int32_t)-0x00800000)          /* Minimum value of 24bits data */
+
+/* Quarter sine in Q15. sin(pi/2 * i / XFADE_TABLE_SIZE) */
+static int32_t sine_table[XFADE_TABLE_SIZE + 1u];
+
+static void calc_gain(const xfade_ctrl_t * const p_xfade_ctrl, 
+                                int32_t * const p_out_gain, int32_t * const p_in_gain);
+static int32_t get_sine(const uint32_t pos);
+static inline int32_t mix_sample(const int32_t out_data, const int32_t out_gain, 
+                                    const int32_t in_data, const int32_t in_gain);
+
+void xfade_init(xfade_ctrl_t * const p_xfade_ctrl)
+{
+    uint32_t    i;
+
+    if (p_xfade_ctrl != NULL) {
+        (void) memset(p_xfade_ctrl, 0, sizeof(xfade_ctrl_t));
+        p_xfade_ctrl->curve = XFADE_CURVE_LINEAR;
+        for (i = 0u; i <= XFADE_TABLE_SIZE; i++) {
+            sine_table[i] = (int32_t)lrintf(sinf((XFADE_HALF_PI * (float)i) / (float)XFADE_TABLE_SIZE) 
+                                                                    * (float)XFADE_GAIN_ONE);
+        }
+    }
+}
+
+bool xfade_set_param(xfade_ctrl_t * const p_xfade_ctrl, 
+                        const uint32_t time_ms, const XFADE_Curve curve)
+{
+    bool        ret = false;
+
+    if ((p_xfade_ctrl != NULL) && (time_ms <= XFADE_MAX_TIME_MS) && (curve < XFADE_CURVE_NUM)) {
+        p_xfade_ctrl->time_ms = time_ms;
+        if (p_xfade_ctrl->fade_len == 0u) {
+            p_xfade_ctrl->curve = curve;
+        } else {
+            /* Changing the curve during the crossfade makes a step of the gains. */
+            /* The new curve is used from the next crossfade. */
+        }
+        ret = true;
+    }
+    return ret;
+}
+
+uint32_t xfade_get_frame_num(const xfade_ctrl_t * const p_xfade_ctrl, const uint32_t sample_rate)
+{
+    uint32_t    frame_num = 0u;
+
+    if (p_xfade_ctrl != NULL) {
+        /* XFADE_MAX_TIME_MS * 192000 does not overflow. */
+        frame_num = (p_xfade_ctrl->time_ms * sample_rate) / SEC_TO_MSEC;
+    }
+    return frame_num;
+}
+
+void xfade_start(xfade_ctrl_t * const p_xfade_ctrl, const uint32_t frame_num)
+{
+    if (p_xfade_ctrl != NULL) {
+        p_xfade_ctrl->fade_len = frame_num;
+        p_xfade_ctrl->fade_pos = 0u;
+    }
+}
+
+void xfade_stop(xfade_ctrl_t * const p_xfade_ctrl)
+{
+    if (p_xfade_ctrl != NULL) {
+        p_xfade_ctrl->fade_len = 0u;
+        p_xfade_ctrl->fade_pos = 0u;
+    }
+}
+
+bool xfade_is_started(const xfade_ctrl_t * const p_xfade_ctrl)
+{
+    bool        ret = false;
+
+    if (p_xfade_ctrl != NULL) {
+        if (p_xfade_ctrl->fade_len > 0u) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+uint32_t xfade_mix(xfade_ctrl_t * const p_xfade_ctrl, int32_t * const p_out_buf, 
+        const uint32_t out_num, const int32_t * const p_in_buf, const uint32_t in_num)
+{
+    uint32_t    i;
+    uint32_t    used_num;
+    int32_t     out_gain = 0;
+    int32_t     in_gain = XFADE_GAIN_ONE;
+    int32_t     in_l;
+    int32_t     in_r;
+
+    if ((p_xfade_ctrl == NULL) || (p_out_buf == NULL) || (p_in_buf == NULL)) {
+        used_num = 0u;
+    } else {
+        if (in_num < out_num) {
+            used_num = in_num;
+        } else {
+            used_num = out_num;
+        }
+        for (i = 0u; (i + XFADE_CHANNEL_NUM) <= out_num; i += XFADE_CHANNEL_NUM) {
+            /* The gains are updated every XFADE_STEP_FRAME_NUM frames and at the end. */
+            if ((i == 0u) || ((p_xfade_ctrl->fade_pos & (XFADE_STEP_FRAME_NUM - 1u)) == 0u) || 
+                (p_xfade_ctrl->fade_pos >= p_xfade_ctrl->fade_len)) {
+                calc_gain(p_xfade_ctrl, &out_gain, &in_gain);
+            }
+            if ((i + XFADE_CHANNEL_NUM) <= used_num) {
+                in_l = p_in_buf[i + XFADE_CH_L] >> PCM_PADDING_BITS;
+                in_r = p_in_buf[i + XFADE_CH_R] >> PCM_PADDING_BITS;
+            } else {
+                in_l = 0;
+                in_r = 0;
+            }
+            p_out_buf[i + XFADE_CH_L] = mix_sample(p_out_buf[i + XFADE_CH_L] >> PCM_PADDING_BITS, 
+                                                                out_gain, in_l, in_gain);
+            p_out_buf[i + XFADE_CH_R] = mix_sample(p_out_buf[i + XFADE_CH_R] >> PCM_PADDING_BITS, 
+                                                                out_gain, in_r, in_gain);
+            if (p_xfade_ctrl->fade_pos < p_xfade_ctrl->fade_len) {
+                p_xfade_ctrl->fade_pos++;
+            }
+        }
+    }
+    return used_num;
+}
+
+/** Calculates the gains at the current position of the crossfade
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *  @param p_out_gain Pointer to store the gain of the track which fades out. (Q15)
+ *  @param p_in_gain Pointer to store the gain of the track which fades in. (Q15)
+ */
+static void calc_gain(const xfade_ctrl_t * const p_xfade_ctrl, 
+                                int32_t * const p_out_gain, int32_t * const p_in_gain)
+{
+    uint32_t    pos;
+
+    if (p_xfade_ctrl->fade_pos >= p_xfade_ctrl->fade_len) {
+        pos = XFADE_POS_ONE;
+    } else {
+        pos = (uint32_t)(((uint64_t)p_xfade_ctrl->fade_pos << XFADE_POS_FRAC_BITS) / 
+                                                    p_xfade_ctrl->fade_len);
+    }
+    if (p_xfade_ctrl->curve == XFADE_CURVE_EQUAL_POWER) {
+        /* cos(x) is sin(pi/2 - x). */
+        *p_in_gain = get_sine(pos);
+        *p_out_gain = get_sine(XFADE_POS_ONE - pos);
+    } else {
+        *p_in_gain = (int32_t)(pos >> (XFADE_POS_FRAC_BITS - XFADE_GAIN_FRAC_BITS));
+        *p_out_gain = XFADE_GAIN_ONE - *p_in_gain;
+    }
+}
+
+/** Gets sin(pi/2 * pos) by the linear interpolation of the table
+ *
+ *  @param pos Position. (Q16, 0 to 1)
+ *
+ *  @returns 
+ *    Sine in Q15.
+ */
+static int32_t get_sine(const uint32_t pos)
+{
+    uint32_t    idx;
+    int32_t     frac;
+    int32_t     ret;
+
+    idx = pos >> (XFADE_POS_FRAC_BITS - XFADE_TABLE_SHIFT);
+    if (idx >= XFADE_TABLE_SIZE) {
+        ret = sine_table[XFADE_TABLE_SIZE];
+    } else {
+        frac = (int32_t)(pos & XFADE_TABLE_FRAC_MASK);
+        ret = sine_table[idx] + (((sine_table[idx + 1u] - sine_table[idx]) * frac) 
+                                    >> (XFADE_POS_FRAC_BITS - XFADE_TABLE_SHIFT));
+    }
+    return ret;
+}
+
+/** Mixes two samples with the gains and saturates the result
+ *
+ *  The sum of the equal power curve exceeds 0dB for the correlated signals.
+ *
+ *  @param out_data Sample of the track which fades out. (24bits data without padding)
+ *  @param out_gain Gain of the track which fades out. (Q15)
+ *  @param in_data Sample of the track which fades in. (24bits data without padding)
+ *  @param in_gain Gain of the track which fades in. (Q15)
+ *
+ *  @returns 
+ *    Mixed sample. (24bits data with 8bits padding)
+ */
+static inline int32_t mix_sample(const int32_t out_data, const int32_t out_gain, 
+                                    const int32_t in_data, const int32_t in_gain)
+{
+    int64_t     data;
+
+    data = ((((int64_t)out_data * out_gain) + ((int64_t)in_data * in_gain)) + XFADE_ROUND_VAL) 
+                                                                >> XFADE_GAIN_FRAC_BITS;
+    if (data > PCM_MAX_VAL) {
+        data = PCM_MAX_VAL;
+    } else if (data < PCM_MIN_VAL) {
+        data = PCM_MIN_VAL;
+    } else {
+        /* DO NOTHING */
+    }
+    return (int32_t)((uint32_t)(int32_t)data << PCM_PADDING_BITS);
+}
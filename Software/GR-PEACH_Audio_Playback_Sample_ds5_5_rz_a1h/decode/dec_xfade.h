@@ -0,0 +1,122 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DEC_XFADE_H
+#define DEC_XFADE_H
+
+#include "r_typedefs.h"
+
+/*--- Macro definition ---*/
+#define XFADE_MAX_TIME_MS       (10000u)    /* Maximum length of the crossfade in ms */
+#define XFADE_CHANNEL_NUM       (2u)        /* Number of channels (DEC_OUTPUT_CHANNEL_NUM) */
+
+/*--- User defined types ---*/
+/* Curve of the crossfade */
+typedef enum {
+    XFADE_CURVE_LINEAR = 0,     /* Linear. The sum of the gains is constant. */
+    XFADE_CURVE_EQUAL_POWER,    /* Sine and cosine. The sum of the powers is constant. */
+    XFADE_CURVE_NUM
+} XFADE_Curve;
+
+/* Control data of the crossfade */
+typedef struct {
+    uint32_t                time_ms;            /* Length of the crossfade in ms. 0 is off. */
+    XFADE_Curve             curve;              /* Curve of the crossfade */
+    uint32_t                fade_len;           /* Length of the crossfade in progress in frames */
+                                                /* 0 means that it is not started. */
+    uint32_t                fade_pos;           /* Frames mixed in the crossfade in progress */
+} xfade_ctrl_t;
+
+/** Initialises the control data of the crossfade
+ *
+ *  The crossfade is off after the initialisation.
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ */
+void xfade_init(xfade_ctrl_t * const p_xfade_ctrl);
+
+/** Sets the length and the curve of the crossfade
+ *
+ *  The crossfade in progress is finished with the previous setting.
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *  @param time_ms Length of the crossfade in ms. 0 to XFADE_MAX_TIME_MS. 0 is off.
+ *  @param curve Curve of the crossfade.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool xfade_set_param(xfade_ctrl_t * const p_xfade_ctrl, 
+                        const uint32_t time_ms, const XFADE_Curve curve);
+
+/** Gets the length of the crossfade in frames
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *  @param sample_rate Sampling rate in Hz.
+ *
+ *  @returns 
+ *    Length of the crossfade in frames. 0 if the crossfade is off.
+ */
+uint32_t xfade_get_frame_num(const xfade_ctrl_t * const p_xfade_ctrl, const uint32_t sample_rate);
+
+/** Starts the crossfade
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *  @param frame_num Length of the crossfade in frames.
+ */
+void xfade_start(xfade_ctrl_t * const p_xfade_ctrl, const uint32_t frame_num);
+
+/** Stops the crossfade
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ */
+void xfade_stop(xfade_ctrl_t * const p_xfade_ctrl);
+
+/** Checks whether the crossfade is in progress
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *
+ *  @returns 
+ *    true if the crossfade is in progress.
+ */
+bool xfade_is_started(const xfade_ctrl_t * const p_xfade_ctrl);
+
+/** Mixes the track which fades in into the track which fades out
+ *
+ *  After the end of the crossfade, the track which fades out is muted.
+ *
+ *  @param p_xfade_ctrl Pointer to the control data of the crossfade.
+ *  @param p_out_buf Pointer to PCM buffer of the track which fades out. The result is stored here.
+ *                   (2ch interleaved, 24bits data with 8bits padding)
+ *  @param out_num Elements number of PCM data in p_out_buf.
+ *  @param p_in_buf Pointer to PCM buffer of the track which fades in. (The same format)
+ *  @param in_num Elements number of PCM data in p_in_buf. 
+ *                The data after in_num is treated as silence.
+ *
+ *  @returns 
+ *    Elements number of PCM data used in p_in_buf.
+ */
+uint32_t xfade_mix(xfade_ctrl_t * const p_xfade_ctrl, int32_t * const p_out_buf, 
+        const uint32_t out_num, const int32_t * const p_in_buf, const uint32_t in_num);
+
+#endif /* DEC_XFADE_H */
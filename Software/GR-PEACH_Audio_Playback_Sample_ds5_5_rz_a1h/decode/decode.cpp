@@ -28,21 +28,33 @@
 #include "system.h"
 #include "decode.h"
 #include "audio_out.h"
-#include "dec_flac.h"
+#include "dec_codec.h"
+#include "dec_src.h"
+#include "dec_rate.h"
+#include "dec_eq.h"
+#include "dec_vol.h"
+#include "dec_xfade.h"
 
 /*--- Macro definition of mbed-rtos mail ---*/
 #define MAIL_QUEUE_SIZE     (12)    /* Queue size */
-#define MAIL_PARAM_NUM      (2)     /* Elements number of mail parameter array */
+#define MAIL_PARAM_NUM      (3)     /* Elements number of mail parameter array */
 
 /* dec_mail_t */
 #define MAIL_PARAM0         (0)     /* Index number of mail parameter array */
 #define MAIL_PARAM1         (1)     /* Index number of mail parameter array */
+#define MAIL_PARAM2         (2)     /* Index number of mail parameter array */
 
 #define MAIL_PARAM_NON      (0u)    /* Value of unused element of mail parameter array */
 
 /* mail_id = DEC_MAILID_OPEN */
 #define MAIL_OPEN_CB        (MAIL_PARAM0)   /* Callback function */
 #define MAIL_OPEN_FILE      (MAIL_PARAM1)   /* File handle */
+#define MAIL_OPEN_START     (MAIL_PARAM2)   /* Start position in samples */
+
+/* mail_id = DEC_MAILID_OPEN_NEXT */
+#define MAIL_OPEN_NEXT_CB           (MAIL_PARAM0)   /* Callback function of open */
+#define MAIL_OPEN_NEXT_FILE         (MAIL_PARAM1)   /* File handle */
+#define MAIL_OPEN_NEXT_START_CB     (MAIL_PARAM2)   /* Callback function of start */
 
 /* mail_id = DEC_MAILID_PLAY : No parameter */
 
@@ -58,20 +70,34 @@
 /* mail_id = DEC_MAILID_CB_AUD_DATA_OUT */
 #define MAIL_DATA_OUT_RESULT        (MAIL_PARAM0)   /* Result of the process */
 
+/* mail_id = DEC_MAILID_CB_AUD_MUTE_OUT */
+#define MAIL_MUTE_OUT_FRAME_NUM     (MAIL_PARAM0)   /* Number of the output frames */
+
 /* mail_id = DEC_MAILID_SCUX_WRITE_FIN */
 #define MAIL_SCUX_WRITE_RESULT      (MAIL_PARAM0)   /* Result of the process */
 #define MAIL_SCUX_WRITE_BUF_INDEX   (MAIL_PARAM1)   /* Index number of PCM buffer */
+#define MAIL_SCUX_WRITE_BYTE_NUM    (MAIL_PARAM2)   /* Byte number of the written data */
 
 /* mail_id = DEC_MAILID_SCUX_FLUSH_FIN */
 #define MAIL_SCUX_FLUSH_RESULT      (MAIL_PARAM0)   /* Result of the process */
 
+/* mail_id = DEC_MAILID_SET_EQ : No parameter. The parameter is in eq_req. */
+
+/* mail_id = DEC_MAILID_SET_VOLUME */
+#define MAIL_SET_VOLUME_VOL         (MAIL_PARAM0)   /* Volume */
+#define MAIL_SET_VOLUME_MUTE        (MAIL_PARAM1)   /* Mute */
+
+/* mail_id = DEC_MAILID_SET_XFADE */
+#define MAIL_SET_XFADE_TIME         (MAIL_PARAM0)   /* Length of the crossfade */
+#define MAIL_SET_XFADE_CURVE        (MAIL_PARAM1)   /* Curve of the crossfade */
+
 
 /*--- Macro definition of PCM buffer ---*/
 #define UNIT_TIME_MS                (50u)   /* Unit time of PCM data processing (ms) */
 #define SEC_TO_MSEC                 (1000u)
 
 /* Sample number per uint time (ms) */
-#define SAMPLE_NUM_PER_UNIT_MS      (((UNIT_TIME_MS * DEC_INPUT_MAX_SAMPLE_RATE) / SEC_TO_MSEC) * DEC_OUTPUT_CHANNEL_NUM)
+#define SAMPLE_NUM_PER_UNIT_MS      (((UNIT_TIME_MS * DEC_SCUX_MAX_SAMPLE_RATE) / SEC_TO_MSEC) * DEC_OUTPUT_CHANNEL_NUM)
 /* Max number of samples per 1 block */
 #define MAX_SAMPLE_PER_1BLOCK       (DEC_MAX_BLOCK_SIZE * DEC_OUTPUT_CHANNEL_NUM)
 
@@ -80,11 +106,21 @@
 
 #define PCM_BUF_SINGLE              (1)
 #define PCM_BUF_TOP_ID              (0)
+#define PCM_FRAME_BYTE              (sizeof(int32_t) * DEC_OUTPUT_CHANNEL_NUM)
+
+/*--- Macro definition of the crossfade ---*/
+#define STREAM_NUM                  (2u)    /* The playing track and the next track */
+/* The next track is decoded by the frame until it covers the data of the playing track. */
+#define NEXT_BUF_SAMPLE_NUM         (TOTAL_SAMPLE_NUM + MAX_SAMPLE_PER_1BLOCK)
 
 /*--- Macro definition of R_BSP_Scux ---*/
 #define SCUX_INT_LEVEL              (0x80)
 #define SCUX_READ_NUM               (DEC_SCUX_READ_NUM)
 #define SCUX_WRITE_NUM              (PCM_BUF_NUM)
+#define SCUX_DIRECT_ROUTE           (SCUX_ROUTE_SRC0_SSIF0)
+/* Ramp period of DVU : 1dB per 64 samples. 60dB is changed in 80ms at 48kHz. */
+#define SCUX_RAMP_UP_PERIOD         (SCUX_DVU_TIME_0_125DB_8STEP)
+#define SCUX_RAMP_DOWN_PERIOD       (SCUX_DVU_TIME_0_125DB_8STEP)
 
 /* 4 bytes aligned. No cache memory. */
 #if defined(__ICCARM__)
@@ -97,20 +133,25 @@
 typedef enum {
     DEC_MAILID_DUMMY = 0,
     DEC_MAILID_OPEN,            /* Requests the opening of the decoder. */
+    DEC_MAILID_OPEN_NEXT,       /* Requests the opening of the decoder of the next track. */
     DEC_MAILID_PLAY,            /* Requests the starting of the playback. */
     DEC_MAILID_PAUSE_ON,        /* Requests the starting of the pause. */
     DEC_MAILID_PAUSE_OFF,       /* Requests the stopping of the pause. */
     DEC_MAILID_STOP,            /* Requests the stopping of the playback. */
     DEC_MAILID_CLOSE,           /* Requests the closing of the decoder. */
     DEC_MAILID_CB_AUD_DATA_OUT, /* Finished the preparation for the audio output. */
+    DEC_MAILID_CB_AUD_MUTE_OUT, /* Finished the mute of the audio output. */
     DEC_MAILID_SCUX_WRITE_FIN,  /* Finished the writing process of SCUX. */
     DEC_MAILID_SCUX_FLUSH_FIN,  /* Finished the flush process of SCUX. */
+    DEC_MAILID_SET_EQ,          /* Requests the setting of the equalizer. */
+    DEC_MAILID_SET_VOLUME,      /* Requests the setting of the volume. */
+    DEC_MAILID_SET_XFADE,       /* Requests the setting of the crossfade. */
     DEC_MAILID_NUM
 } DEC_MAIL_ID;
 
 typedef struct {
     DEC_MAIL_ID     mail_id;
-    uint32_t        param[MAIL_PARAM_NUM];
+    uintptr_t       param[MAIL_PARAM_NUM];  /* Wide enough for the pointers of the requests */
 } dec_mail_t;
 
 /*--- User defined types of decode thread ---*/
@@ -119,12 +160,30 @@ typedef struct {
     SYS_PlayStat    play_stat;  /* Playback status */
     uint32_t        play_time;  /* Playback start time */
     uint32_t        total_time; /* Total playback time */
+    uint32_t        play_sample;    /* Playback position in samples */
 } play_info_t;
 
+/* Decoding stream of a track */
+typedef struct {
+    codec_ctrl_t    codec_ctrl;     /* Decoder of the track */
+    src_ctrl_t      src_ctrl;       /* Software SRC in front of SCUX */
+} dec_stream_t;
+
 /* Control data of Decode thread */
 typedef struct {
     play_info_t     play_info;
-    flac_ctrl_t     flac_ctrl;
+    dec_stream_t    *p_cur;         /* Stream of the playing track */
+    dec_stream_t    *p_next;        /* Stream of the next track. NULL if it is not opened. */
+    DEC_CbOpen      p_next_cb;      /* Callback for notifying the start of the next track */
+    uint32_t        next_buf_cnt;   /* Elements number of the next track in next_buf */
+    uint32_t        output_rate;    /* Sampling rate of audio output */
+    uint64_t        start_sample;   /* Position of the opened track where the playback starts */
+    uint64_t        out_start_sample;   /* Position of the playing track at the output start */
+    uint32_t        out_frame_cnt;      /* Number of the frames output from the output start */
+    bool            is_out_pos_valid;   /* false if the track changed after the output start */
+    bool            is_out_cnt_fixed;   /* true if out_frame_cnt is fixed by the pause */
+    uint32_t        write_cnt;          /* SCUX writes of which the result is not received */
+    bool            is_resume_wait;     /* The pause_off waits for the results of the writes */
 } dec_ctrl_t;
 
 /* Status of Decode thread */
@@ -140,23 +199,47 @@ typedef enum {
 
 static Mail<dec_mail_t, MAIL_QUEUE_SIZE> mail_box;
 static R_BSP_Scux scux(SCUX_CH_0, SCUX_INT_LEVEL, SCUX_WRITE_NUM, SCUX_READ_NUM);
-
-static bool open_proc(flac_ctrl_t * const p_ctrl, 
-        FILE * const p_handle, const DEC_CbOpen p_cb);
-static void close_proc(flac_ctrl_t * const p_ctrl, const DEC_CbClose p_cb);
-static bool play_proc(flac_ctrl_t * const p_ctrl, const uint32_t buf_id,
-        int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t element_num);
-static bool pause_proc(const uint32_t buf_id,
+static dec_stream_t dec_stream[STREAM_NUM];
+static eq_ctrl_t eq_ctrl;       /* Equalizer in front of SCUX */
+static eq_param_t eq_req;       /* Parameter of the last dec_set_eq(). band_num 0 is the bypass. */
+static Mutex eq_req_mutex;      /* Guards eq_req */
+static vol_ctrl_t vol_ctrl;     /* Volume applied by SCUX DVU or the audio codec */
+static xfade_ctrl_t xfade_ctrl; /* Crossfade between tracks in front of the equalizer */
+/* PCM data of the next track. Only CPU accesses it, so it is in the cached memory. */
+static int32_t next_buf[NEXT_BUF_SAMPLE_NUM];
+
+static bool open_proc(dec_stream_t * const p_stream, FILE * const p_handle, 
+        const DEC_CbOpen p_cb, uint32_t * const p_output_rate);
+static bool open_next_proc(dec_ctrl_t * const p_ctrl, FILE * const p_handle, 
+        const DEC_CbOpen p_cb_open, const DEC_CbOpen p_cb_start);
+static bool set_src_cfg(dec_stream_t * const p_stream);
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+static bool set_direct_route(void);
+static bool set_dvu_cfg(const vol_ctrl_t * const p_vol_ctrl);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+static bool apply_volume(const vol_ctrl_t * const p_vol_ctrl);
+static bool apply_replay_gain(const vol_ctrl_t * const p_vol_ctrl);
+static void close_proc(dec_ctrl_t * const p_ctrl, const DEC_CbClose p_cb);
+static void start_output(dec_ctrl_t * const p_ctrl, const uint64_t start_sample);
+static bool get_output_position(const dec_ctrl_t * const p_ctrl, uint64_t * const p_pos);
+static bool resume_proc(dec_ctrl_t * const p_ctrl);
+static bool play_proc(dec_ctrl_t * const p_ctrl, const uint32_t buf_id,
         int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t element_num);
-static uint32_t get_audio_data(flac_ctrl_t * const p_ctrl, 
+static uint32_t get_mixed_data(dec_ctrl_t * const p_ctrl, 
                                 int32_t * const p_buf, const uint32_t buf_num);
+static uint32_t get_audio_data(dec_stream_t * const p_stream, 
+                                int32_t * const p_buf, const uint32_t buf_num);
+static void check_xfade_start(const dec_ctrl_t * const p_ctrl);
+static void fill_next_buf(dec_ctrl_t * const p_ctrl, const uint32_t sample_num);
+static void start_next_track(dec_ctrl_t * const p_ctrl);
 static void data_out_callback(const bool result);
+static void mute_out_callback(const uint32_t frame_num);
 static void write_callback(void * p_data, int32_t result, void * p_app_data);
 static void flush_callback(int32_t result);
-static bool send_mail(const DEC_MAIL_ID mail_id, 
-                            const uint32_t param0, const uint32_t param1);
-static bool recv_mail(DEC_MAIL_ID * const p_mail_id, 
-                        uint32_t * const p_param0, uint32_t * const p_param1);
+static bool send_mail(const DEC_MAIL_ID mail_id, const uintptr_t param0, 
+                            const uintptr_t param1, const uintptr_t param2);
+static bool recv_mail(DEC_MAIL_ID * const p_mail_id, uintptr_t * const p_param0, 
+                        uintptr_t * const p_param1, uintptr_t * const p_param2);
 static void update_decode_stat(const SYS_PlayStat stat, play_info_t * const p_play_info);
 static void update_decode_playtime(const uint32_t play_time, play_info_t * const p_play_info);
 static void init_decode_playinfo(const uint32_t total_time, play_info_t * const p_play_info);
@@ -167,11 +250,15 @@ void dec_thread(void const *argument)
     dec_ctrl_t                  dec_ctrl;   /* Control data of Decode thread */
     DEC_STATE                   dec_stat;   /* Status of Decode thread */
     DEC_MAIL_ID                 mail_type;
-    uint32_t                    mail_param[MAIL_PARAM_NUM];
+    uintptr_t                   mail_param[MAIL_PARAM_NUM];
     uint32_t                    buf_id;
     uint32_t                    buf_num;
     uint32_t                    time_code;
+    uint64_t                    pos;
     bool                        result;
+    bool                        is_resume;
+    DEC_CbOpen                  p_cb_open;
+    uint32_t                    i;
 #if defined(__ICCARM__)
     static int32_t pcm_buf[PCM_BUF_NUM][TOTAL_SAMPLE_NUM] NC_BSS_SECT;
 #else
@@ -179,22 +266,85 @@ void dec_thread(void const *argument)
 #endif
 
     UNUSED_ARG(argument);
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+    /* Connects SCUX to SSIF0. SCUX is stopped until the first track is opened. */
+    (void) set_direct_route();
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+    eq_init(&eq_ctrl);
+    vol_init(&vol_ctrl);
+    xfade_init(&xfade_ctrl);
+    for (i = 0u; i < STREAM_NUM; i++) {
+        (void) codec_init(&dec_stream[i].codec_ctrl);
+    }
+    dec_ctrl.p_cur = &dec_stream[0];
+    dec_ctrl.p_next = NULL;
+    dec_ctrl.p_next_cb = NULL;
+    dec_ctrl.next_buf_cnt = 0u;
+    dec_ctrl.start_sample = 0uLL;
+    dec_ctrl.out_frame_cnt = 0u;
+    dec_ctrl.is_out_pos_valid = false;
+    dec_ctrl.is_out_cnt_fixed = false;
+    dec_ctrl.write_cnt = 0u;
+    dec_ctrl.is_resume_wait = false;
     dec_stat = DEC_ST_IDLE;
     while (1) {
-        result = recv_mail(&mail_type, &mail_param[MAIL_PARAM0], &mail_param[MAIL_PARAM1]);
+        result = recv_mail(&mail_type, &mail_param[MAIL_PARAM0], 
+                            &mail_param[MAIL_PARAM1], &mail_param[MAIL_PARAM2]);
         if (result == true) {
+            if (mail_type == DEC_MAILID_SET_EQ) {
+                /* The equalizer is set in any state. "dec_stat" variable does not change. */
+                /* eq_set_param() copies the parameter, so eq_req is locked only during it. */
+                (void) eq_req_mutex.lock();
+                (void) eq_set_param(&eq_ctrl, &eq_req);
+                (void) eq_req_mutex.unlock();
+            } else if (mail_type == DEC_MAILID_SET_VOLUME) {
+                /* The volume is set in any state. "dec_stat" variable does not change. */
+                result = vol_set_volume(&vol_ctrl, (int32_t)mail_param[MAIL_SET_VOLUME_VOL], 
+                                        (bool)mail_param[MAIL_SET_VOLUME_MUTE]);
+                if (result == true) {
+                    (void) apply_volume(&vol_ctrl);
+                }
+            } else if (mail_type == DEC_MAILID_SET_XFADE) {
+                /* The crossfade is set in any state. "dec_stat" variable does not change. */
+                (void) xfade_set_param(&xfade_ctrl, mail_param[MAIL_SET_XFADE_TIME], 
+                                        (XFADE_Curve)mail_param[MAIL_SET_XFADE_CURVE]);
+            } else if (mail_type == DEC_MAILID_OPEN_NEXT) {
+                /* The next track is accepted during the playback only. */
+                /* "dec_stat" variable does not change. */
+                p_cb_open = (DEC_CbOpen)mail_param[MAIL_OPEN_NEXT_CB];
+                if ((dec_stat == DEC_ST_PLAY) || (dec_stat == DEC_ST_PAUSE)) {
+                    (void) open_next_proc(&dec_ctrl, (FILE*)mail_param[MAIL_OPEN_NEXT_FILE], 
+                                    p_cb_open, (DEC_CbOpen)mail_param[MAIL_OPEN_NEXT_START_CB]);
+                } else {
+                    p_cb_open(false, 0u, 0u);
+                }
+            } else {
+                /* DO NOTHING */
+            }
+            if (mail_type == DEC_MAILID_SCUX_WRITE_FIN) {
+                if (dec_ctrl.write_cnt > 0u) {
+                    dec_ctrl.write_cnt--;
+                }
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                /* SCUX outputs the written data to SSIF directly, so the written data */
+                /* is the output data. The data cancelled by ClearStop() is excluded, */
+                /* and the one being output at ClearStop() counts its output part. */
+                dec_ctrl.out_frame_cnt += mail_param[MAIL_SCUX_WRITE_BYTE_NUM] / PCM_FRAME_BYTE;
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+            }
             /* State transition processing */
             switch (dec_stat) {
                 case DEC_ST_META_FIN:       /* Finished the decoding until a metadata */
                     if (mail_type == DEC_MAILID_PLAY) {
-                        time_code = flac_get_total_time(&dec_ctrl.flac_ctrl);
+                        time_code = codec_get_total_time(&dec_ctrl.p_cur->codec_ctrl);
                         init_decode_playinfo(time_code, &dec_ctrl.play_info);
+                        dec_ctrl.play_info.play_sample = (uint32_t)dec_ctrl.start_sample;
                         update_decode_stat(SYS_PLAYSTAT_PLAY, &dec_ctrl.play_info);
-                        (void) aud_req_data_out(&data_out_callback);
+                        start_output(&dec_ctrl, dec_ctrl.start_sample);
                         dec_stat = DEC_ST_PLAY;
                     } else if (mail_type == DEC_MAILID_CLOSE) {
                         scux.ClearStop();
-                        close_proc(&dec_ctrl.flac_ctrl, (DEC_CbClose)mail_param[MAIL_CLOSE_CB]);
+                        close_proc(&dec_ctrl, (DEC_CbClose)mail_param[MAIL_CLOSE_CB]);
                         dec_stat = DEC_ST_IDLE;
                     } else {
                         /* DO NOTHING */
@@ -202,11 +352,23 @@ void dec_thread(void const *argument)
                     break;
                 case DEC_ST_PLAY:           /* Decoder start */
                     if (mail_type == DEC_MAILID_PAUSE_ON) {
+                        /* Mutes the audio output first, then discards the data queued */
+                        /* in SCUX. The pause_off resumes from the output position. */
+                        (void) aud_req_mute_out(&mute_out_callback);
+                        scux.ClearStop();
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                        /* The results of the writes cancelled by ClearStop() come by */
+                        /* the later mails. Until then the position is the one output */
+                        /* before this mail, and it is notified again with them. */
+                        dec_ctrl.is_out_cnt_fixed = true;
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+                        (void) get_output_position(&dec_ctrl, &pos);
+                        dec_ctrl.play_info.play_sample = (uint32_t)pos;
                         update_decode_stat(SYS_PLAYSTAT_PAUSE, &dec_ctrl.play_info);
                         dec_stat = DEC_ST_PAUSE;
                     } else if (mail_type == DEC_MAILID_STOP) {
+                        (void) aud_req_mute_out(&mute_out_callback);
                         scux.ClearStop();
-                        (void) aud_req_zero_out();
                         update_decode_stat(SYS_PLAYSTAT_STOP, &dec_ctrl.play_info);
                         dec_stat = DEC_ST_STOP;
                     } else if ((mail_type == DEC_MAILID_CB_AUD_DATA_OUT) || 
@@ -218,9 +380,11 @@ void dec_thread(void const *argument)
                             buf_id = PCM_BUF_TOP_ID;
                             buf_num = PCM_BUF_NUM;
                         }
-                        result = play_proc(&dec_ctrl.flac_ctrl, buf_id, &pcm_buf[buf_id], buf_num);
+                        result = play_proc(&dec_ctrl, buf_id, &pcm_buf[buf_id], buf_num);
                         if (result == true) {
-                            time_code = flac_get_play_time(&dec_ctrl.flac_ctrl);
+                            (void) get_output_position(&dec_ctrl, &pos);
+                            dec_ctrl.play_info.play_sample = (uint32_t)pos;
+                            time_code = codec_get_play_time(&dec_ctrl.p_cur->codec_ctrl);
                             update_decode_playtime(time_code, &dec_ctrl.play_info);
                             /* "dec_stat" variable does not change. */
                         } else {
@@ -239,39 +403,56 @@ void dec_thread(void const *argument)
                     }
                     break;
                 case DEC_ST_PAUSE:          /* Decoder pause */
+                    is_resume = false;
                     if (mail_type == DEC_MAILID_PAUSE_OFF) {
-                        update_decode_stat(SYS_PLAYSTAT_PLAY, &dec_ctrl.play_info);
-                        dec_stat = DEC_ST_PLAY;
+                        /* The results of the cancelled writes must not reach the playback, */
+                        /* because they would write their buffers again. */
+                        if (dec_ctrl.write_cnt > 0u) {
+                            dec_ctrl.is_resume_wait = true;
+                        } else {
+                            is_resume = true;
+                        }
                     } else if (mail_type == DEC_MAILID_STOP) {
-                        scux.ClearStop();
-                        (void) aud_req_zero_out();
+                        /* SCUX is already stopped and the audio output is muted. */
+                        dec_ctrl.is_resume_wait = false;
                         update_decode_stat(SYS_PLAYSTAT_STOP, &dec_ctrl.play_info);
                         dec_stat = DEC_ST_STOP;
-                    } else if ((mail_type == DEC_MAILID_CB_AUD_DATA_OUT) || 
-                               (mail_type == DEC_MAILID_SCUX_WRITE_FIN)) {
-                        if (mail_type == DEC_MAILID_SCUX_WRITE_FIN) {
-                            buf_id = mail_param[MAIL_SCUX_WRITE_BUF_INDEX];
-                            buf_num = PCM_BUF_SINGLE;
-                        } else {
-                            buf_id = PCM_BUF_TOP_ID;
-                            buf_num = PCM_BUF_NUM;
+                    } else if (mail_type == DEC_MAILID_SCUX_WRITE_FIN) {
+                        if (dec_ctrl.write_cnt == 0u) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                            /* All results of the cancelled writes are received. Notifies Main */
+                            /* thread of the position including the data output at ClearStop(). */
+                            (void) get_output_position(&dec_ctrl, &pos);
+                            dec_ctrl.play_info.play_sample = (uint32_t)pos;
+                            notify_decode_stat(&dec_ctrl.play_info);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+                            is_resume = dec_ctrl.is_resume_wait;
                         }
-                        result = pause_proc(buf_id, &pcm_buf[buf_id], buf_num);
+                    } else if (mail_type == DEC_MAILID_CB_AUD_MUTE_OUT) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                        /* out_frame_cnt is counted by the write results of SCUX. */
+#else
+                        dec_ctrl.out_frame_cnt = mail_param[MAIL_MUTE_OUT_FRAME_NUM];
+                        dec_ctrl.is_out_cnt_fixed = true;
+                        /* Notifies Main thread of the position where the pause_off resumes. */
+                        (void) get_output_position(&dec_ctrl, &pos);
+                        dec_ctrl.play_info.play_sample = (uint32_t)pos;
+                        notify_decode_stat(&dec_ctrl.play_info);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+                    } else {
+                        /* DO NOTHING */
+                    }
+                    if (is_resume == true) {
+                        dec_ctrl.is_resume_wait = false;
+                        result = resume_proc(&dec_ctrl);
                         if (result == true) {
-                            /* "dec_stat" variable does not change. */
+                            update_decode_stat(SYS_PLAYSTAT_PLAY, &dec_ctrl.play_info);
+                            dec_stat = DEC_ST_PLAY;
                         } else {
-                            result = scux.FlushStop(&flush_callback);
-                            if (result == true) {
-                                dec_stat = DEC_ST_STOP_PREPARE;
-                            } else {
-                                /* Error occurred by SCUX driver. */
-                                (void) aud_req_zero_out();
-                                update_decode_stat(SYS_PLAYSTAT_STOP, &dec_ctrl.play_info);
-                                dec_stat = DEC_ST_STOP;
-                            }
+                            /* Error occurred by SCUX driver. */
+                            update_decode_stat(SYS_PLAYSTAT_STOP, &dec_ctrl.play_info);
+                            dec_stat = DEC_ST_STOP;
                         }
-                    } else {
-                        /* DO NOTHING */
                     }
                     break;
                 case DEC_ST_STOP_PREPARE:   /* Preparing of decoder stop */
@@ -285,7 +466,7 @@ void dec_thread(void const *argument)
                     break;
                 case DEC_ST_STOP:           /* Decoder stop */
                     if (mail_type == DEC_MAILID_CLOSE) {
-                        close_proc(&dec_ctrl.flac_ctrl, (DEC_CbClose)mail_param[MAIL_CLOSE_CB]);
+                        close_proc(&dec_ctrl, (DEC_CbClose)mail_param[MAIL_CLOSE_CB]);
                         dec_stat = DEC_ST_IDLE;
                     } else {
                         /* DO NOTHING */
@@ -294,10 +475,20 @@ void dec_thread(void const *argument)
                 case DEC_ST_IDLE:           /* Idle */
                 default:
                     if (mail_type == DEC_MAILID_OPEN) {
-                        result = open_proc(&dec_ctrl.flac_ctrl, 
+                        result = open_proc(dec_ctrl.p_cur, 
                                            (FILE*)mail_param[MAIL_OPEN_FILE], 
-                                           (DEC_CbOpen)mail_param[MAIL_OPEN_CB]);
+                                           (DEC_CbOpen)mail_param[MAIL_OPEN_CB],
+                                           &dec_ctrl.output_rate);
                         if (result == true) {
+                            /* The decoder seeks to the start position at the first decoding. */
+                            dec_ctrl.start_sample = 0uLL;
+                            if (mail_param[MAIL_OPEN_START] > 0u) {
+                                result = codec_set_position(&dec_ctrl.p_cur->codec_ctrl, 
+                                                (uint64_t)mail_param[MAIL_OPEN_START]);
+                                if (result == true) {
+                                    dec_ctrl.start_sample = (uint64_t)mail_param[MAIL_OPEN_START];
+                                }
+                            }
                             dec_stat = DEC_ST_META_FIN;
                         } else {
                             /* "dec_stat" variable does not change. */
@@ -311,12 +502,24 @@ void dec_thread(void const *argument)
     }
 }
 
-bool dec_open(FILE * const p_handle, const DEC_CbOpen p_cb)
+bool dec_open(FILE * const p_handle, const uint32_t start_sample, const DEC_CbOpen p_cb)
 {
     bool    ret = false;
 
     if ((p_handle != NULL) && (p_cb != NULL)) {
-        ret = send_mail(DEC_MAILID_OPEN, (uint32_t)p_cb, (uint32_t)p_handle);
+        ret = send_mail(DEC_MAILID_OPEN, (uintptr_t)p_cb, (uintptr_t)p_handle, start_sample);
+    }
+    return ret;
+}
+
+bool dec_open_next(FILE * const p_handle, 
+                    const DEC_CbOpen p_cb_open, const DEC_CbOpen p_cb_start)
+{
+    bool    ret = false;
+
+    if ((p_handle != NULL) && (p_cb_open != NULL) && (p_cb_start != NULL)) {
+        ret = send_mail(DEC_MAILID_OPEN_NEXT, (uintptr_t)p_cb_open, 
+                                (uintptr_t)p_handle, (uintptr_t)p_cb_start);
     }
     return ret;
 }
@@ -325,7 +528,7 @@ bool dec_play(void)
 {
     bool    ret = false;
 
-    ret = send_mail(DEC_MAILID_PLAY, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    ret = send_mail(DEC_MAILID_PLAY, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
 
     return ret;
 }
@@ -334,7 +537,7 @@ bool dec_pause_on(void)
 {
     bool    ret = false;
 
-    ret = send_mail(DEC_MAILID_PAUSE_ON, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    ret = send_mail(DEC_MAILID_PAUSE_ON, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
 
     return ret;
 }
@@ -343,7 +546,7 @@ bool dec_pause_off(void)
 {
     bool    ret = false;
 
-    ret = send_mail(DEC_MAILID_PAUSE_OFF, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    ret = send_mail(DEC_MAILID_PAUSE_OFF, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
 
     return ret;
 }
@@ -352,7 +555,7 @@ bool dec_stop(void)
 {
     bool    ret;
 
-    ret = send_mail(DEC_MAILID_STOP, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    ret = send_mail(DEC_MAILID_STOP, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
 
     return ret;
 }
@@ -362,7 +565,45 @@ bool dec_close(const DEC_CbClose p_cb)
     bool    ret = false;
 
     if (p_cb != NULL) {
-        ret = send_mail(DEC_MAILID_CLOSE, (uint32_t)p_cb, MAIL_PARAM_NON);
+        ret = send_mail(DEC_MAILID_CLOSE, (uintptr_t)p_cb, MAIL_PARAM_NON, MAIL_PARAM_NON);
+    }
+    return ret;
+}
+
+bool dec_set_eq(const eq_param_t * const p_param)
+{
+    bool    ret;
+
+    /* The parameter is copied before the mail, so the caller may reuse it at once. */
+    /* When the calls overtake the mails, each mail sets the last parameter. */
+    (void) eq_req_mutex.lock();
+    if (p_param == NULL) {
+        eq_req.band_num = 0u;
+    } else {
+        eq_req = *p_param;
+    }
+    (void) eq_req_mutex.unlock();
+    ret = send_mail(DEC_MAILID_SET_EQ, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
+
+    return ret;
+}
+
+bool dec_set_volume(const int32_t volume, const bool mute)
+{
+    bool    ret = false;
+
+    if ((volume >= DEC_VOLUME_MIN) && (volume <= DEC_VOLUME_MAX)) {
+        ret = send_mail(DEC_MAILID_SET_VOLUME, (uint32_t)volume, (uint32_t)mute, MAIL_PARAM_NON);
+    }
+    return ret;
+}
+
+bool dec_set_xfade(const uint32_t time_ms, const XFADE_Curve curve)
+{
+    bool    ret = false;
+
+    if ((time_ms <= DEC_XFADE_MAX_TIME_MS) && (curve < XFADE_CURVE_NUM)) {
+        ret = send_mail(DEC_MAILID_SET_XFADE, time_ms, (uint32_t)curve, MAIL_PARAM_NON);
     }
     return ret;
 }
@@ -382,89 +623,364 @@ bool dec_scux_read(void * const p_data, const uint32_t data_size,
 
 /** Executes the opening process of the decoder
  *
- *  @param p_ctrl Pointer to the control data of FLAC module.
- *  @param p_handle Pointer to the handle of FLAC file.
+ *  @param p_stream Pointer to the stream to open.
+ *  @param p_handle Pointer to the handle of the file.
  *  @param p_cb Pointer to the callback for notification of the process result.
+ *  @param p_output_rate Pointer to the variable to store the sampling rate of audio output.
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool open_proc(flac_ctrl_t * const p_ctrl, FILE * const p_handle, const DEC_CbOpen p_cb)
+static bool open_proc(dec_stream_t * const p_stream, FILE * const p_handle, 
+        const DEC_CbOpen p_cb, uint32_t * const p_output_rate)
 {
     bool                ret = false;
     bool                result;
+    uint32_t            input_rate;
+    uint32_t            output_rate;
     scux_src_usr_cfg_t  conf;
 
-    if ((p_ctrl != NULL) && (p_handle != NULL) && (p_cb != NULL)) {
-        result = flac_open(p_handle, p_ctrl);
+    if ((p_stream != NULL) && (p_handle != NULL) && (p_cb != NULL) && (p_output_rate != NULL)) {
+        result = codec_open(p_handle, &p_stream->codec_ctrl);
+        if (result == true) {
+            vol_set_replay_gain(&vol_ctrl, codec_get_replay_gain(&p_stream->codec_ctrl));
+            result = set_src_cfg(p_stream);
+        }
         if (result == true) {
+            input_rate = src_get_output_rate(&p_stream->src_ctrl);
+            /* Recalculates the equalizer for the rate. It is bypassed if it does not suit. */
+            (void) eq_set_rate(&eq_ctrl, input_rate);
+            output_rate = rate_select_output_rate(input_rate);
             /* Sets SCUX config */
-            conf.src_enable           = true;
-            conf.word_len             = SCUX_DATA_LEN_24;
-            conf.mode_sync            = true;
-            conf.input_rate           = p_ctrl->sample_rate;
-            conf.output_rate          = DEC_OUTPUT_SAMPLE_RATE;
-            conf.select_in_data_ch[0] = SELECT_IN_DATA_CH_0;
-            conf.select_in_data_ch[1] = SELECT_IN_DATA_CH_1;
+            (void) rate_set_scux_src_cfg(&conf, input_rate, output_rate);
             result = scux.SetSrcCfg(&conf);
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+            if (result == true) {
+                /* DVU can be set up only while SCUX is stopped. */
+                result = set_dvu_cfg(&vol_ctrl);
+            }
+#else
+            (void) apply_volume(&vol_ctrl);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
             if (result == true) {
                 ret = scux.TransStart();
             }
+            *p_output_rate = output_rate;
+        }
+        p_cb(ret, codec_get_sample_rate(&p_stream->codec_ctrl), codec_get_channel_num(&p_stream->codec_ctrl));
+    }
+    return ret;
+}
+
+/** Executes the opening process of the decoder of the next track
+ *
+ *  SCUX is not stopped, so the next track is accepted only when 
+ *  the sampling rate of SCUX input is the same as the playing track.
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ *  @param p_handle Pointer to the handle of the file.
+ *  @param p_cb_open Pointer to the callback for notification of the process result.
+ *  @param p_cb_start Pointer to the callback for notification of the start of the next track.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool open_next_proc(dec_ctrl_t * const p_ctrl, FILE * const p_handle, 
+        const DEC_CbOpen p_cb_open, const DEC_CbOpen p_cb_start)
+{
+    bool                ret = false;
+    bool                result;
+    dec_stream_t        *p_stream;
+    uint32_t            sample_rate = 0u;
+    uint32_t            channel_num = 0u;
+
+    if ((p_ctrl != NULL) && (p_handle != NULL) && (p_cb_open != NULL) && (p_cb_start != NULL)) {
+        if (p_ctrl->p_next == NULL) {
+            if (p_ctrl->p_cur == &dec_stream[0]) {
+                p_stream = &dec_stream[1];
+            } else {
+                p_stream = &dec_stream[0];
+            }
+            result = codec_open(p_handle, &p_stream->codec_ctrl);
+            if (result == true) {
+                result = set_src_cfg(p_stream);
+                if ((result == true) && (src_get_output_rate(&p_stream->src_ctrl) == 
+                                         src_get_output_rate(&p_ctrl->p_cur->src_ctrl))) {
+                    p_ctrl->p_next = p_stream;
+                    p_ctrl->p_next_cb = p_cb_start;
+                    p_ctrl->next_buf_cnt = 0u;
+                    sample_rate = codec_get_sample_rate(&p_stream->codec_ctrl);
+                    channel_num = codec_get_channel_num(&p_stream->codec_ctrl);
+                    ret = true;
+                } else {
+                    codec_close(&p_stream->codec_ctrl);
+                }
+            }
         }
-        p_cb(ret, p_ctrl->sample_rate, p_ctrl->channel_num);
+        p_cb_open(ret, sample_rate, channel_num);
+    }
+    return ret;
+}
+
+/** Sets up the software SRC for the sampling rate of the stream
+ *
+ *  @param p_stream Pointer to the stream which is opened.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool set_src_cfg(dec_stream_t * const p_stream)
+{
+    bool                ret = false;
+    src_cfg_t           src_conf;
+    uint32_t            rate;
+
+    if (p_stream != NULL) {
+        rate = codec_get_sample_rate(&p_stream->codec_ctrl);
+        src_conf.output_rate      = rate_get_scux_input_rate(rate);
+        src_conf.src_enable       = (src_conf.output_rate != rate);
+        src_conf.input_rate       = rate;
+        ret = src_set_cfg(&p_stream->src_ctrl, &src_conf);
+    }
+    return ret;
+}
+
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+/** Sets the route which outputs the SRC result to SSIF0 directly
+ *
+ *  The SSIF settings are the same as the settings of TLV320_RBSP.
+ *  (Slave mode, 32 bits system word, I2S format)
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool set_direct_route(void)
+{
+    bool                ret = false;
+    scux_ssif_usr_cfg_t conf;
+
+    conf.ssif_ch_num       = SCUX_SSIF_CH_0;
+    conf.mode_master       = false;
+    conf.select_audio_clk  = false;
+    conf.system_word       = SCUX_SSIF_SYSTEM_LEN_32;
+    conf.sck_polarity_rise = false;
+    conf.ws_polarity_high  = false;
+    conf.padding_high      = false;
+    conf.serial_data_align = true;
+    conf.ws_delay          = true;
+    conf.use_noise_cancel  = true;
+    conf.use_tdm           = false;
+    ret = scux.SetSsifCfg(&conf);
+    if (ret == true) {
+        ret = scux.SetRoute(SCUX_DIRECT_ROUTE);
+    }
+    return ret;
+}
+
+/** Sets up DVU of SCUX for the track
+ *
+ *  ReplayGain is applied by the digital volume, because it is fixed during the track.
+ *  The volume and the mute are applied by the ramp volume to change them without a click.
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool set_dvu_cfg(const vol_ctrl_t * const p_vol_ctrl)
+{
+    bool                ret = false;
+    scux_dvu_usr_cfg_t  conf;
+    uint32_t            digi_vol;
+
+    if (p_vol_ctrl != NULL) {
+        digi_vol = vol_get_digi_vol(p_vol_ctrl);
+        conf.dvu_enable      = true;
+        conf.digi_vol_enable = true;
+        conf.digi_vol[0]     = digi_vol;
+        conf.digi_vol[1]     = digi_vol;
+        conf.ramp_vol_enable = true;
+        conf.up_period       = SCUX_RAMP_UP_PERIOD;
+        conf.down_period     = SCUX_RAMP_DOWN_PERIOD;
+        conf.ramp_vol        = vol_get_ramp_vol(p_vol_ctrl);
+        conf.ramp_wait_time  = 0u;
+        conf.zc_mute_enable  = false;
+        ret = scux.SetDvuCfg(&conf);
+    }
+    return ret;
+}
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+
+/** Applies the volume to the audio output
+ *
+ *  When SCUX outputs to SSIF directly, the ramp volume of DVU is changed.
+ *  Otherwise DVU is not in the signal path, so the audio codec changes the volume.
+ *  In both cases the CPU does not process any sample.
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool apply_volume(const vol_ctrl_t * const p_vol_ctrl)
+{
+    bool                ret = false;
+
+    if (p_vol_ctrl != NULL) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+        ret = scux.SetRampVol(vol_get_ramp_vol(p_vol_ctrl), 
+                                SCUX_RAMP_UP_PERIOD, SCUX_RAMP_DOWN_PERIOD);
+#else
+        ret = aud_set_volume(vol_get_gain(p_vol_ctrl), p_vol_ctrl->mute);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+    }
+    return ret;
+}
+
+/** Applies ReplayGain of the track which starts without stopping SCUX
+ *
+ *  When SCUX outputs to SSIF directly, the digital volume of DVU is changed at once.
+ *  Otherwise ReplayGain is a part of the volume of the audio codec.
+ *
+ *  @param p_vol_ctrl Pointer to the control data of the volume.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool apply_replay_gain(const vol_ctrl_t * const p_vol_ctrl)
+{
+    bool                ret = false;
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+    uint32_t            digi_vol[SCUX_USE_CH_2];
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+
+    if (p_vol_ctrl != NULL) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+        digi_vol[0] = vol_get_digi_vol(p_vol_ctrl);
+        digi_vol[1] = digi_vol[0];
+        ret = scux.SetDigiVol(digi_vol);
+#else
+        ret = apply_volume(p_vol_ctrl);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
     }
     return ret;
 }
 
 /** Executes the closing process of the decoder
  *
- *  @param p_ctrl Pointer to the control data of FLAC module.
+ *  The decoder of the next track is also closed if it is opened.
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
  *  @param p_cb Pointer to the callback for notification of the process result.
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static void close_proc(flac_ctrl_t * const p_ctrl, const DEC_CbClose p_cb)
+static void close_proc(dec_ctrl_t * const p_ctrl, const DEC_CbClose p_cb)
 {
     if ((p_ctrl != NULL) && (p_cb != NULL)) {
-        flac_close(p_ctrl);
+        if (p_ctrl->p_next != NULL) {
+            codec_close(&p_ctrl->p_next->codec_ctrl);
+            p_ctrl->p_next = NULL;
+            p_ctrl->next_buf_cnt = 0u;
+        }
+        xfade_stop(&xfade_ctrl);
+        codec_close(&p_ctrl->p_cur->codec_ctrl);
         p_cb();
     }
 }
 
-/** Executes the starting process of the pause
+/** Starts the audio output and the count of the output position
  *
- *  @param p_ctrl Pointer to the control data of FLAC module.
- *  @param buf_id Index of PCM buffer array.
- *  @param p_buf Pointer to PCM buffer array to use in this process.
- *  @param element_num Elements number of PCM buffer array.
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ *  @param start_sample Position of the playing track where the output starts.
+ */
+static void start_output(dec_ctrl_t * const p_ctrl, const uint64_t start_sample)
+{
+    if (p_ctrl != NULL) {
+        p_ctrl->out_start_sample = start_sample;
+        p_ctrl->out_frame_cnt = 0u;
+        p_ctrl->is_out_pos_valid = true;
+        p_ctrl->is_out_cnt_fixed = false;
+        (void) aud_req_data_out(&data_out_callback, p_ctrl->output_rate);
+    }
+}
+
+/** Gets the position of the playing track which was output
+ *
+ *  The position is counted at the rate of the output, so it is rounded when
+ *  the SRC of SCUX converts the rate. When the output count is not fixed, or
+ *  the track changed or the crossfade started after the output start, the
+ *  position of the decoder is got instead. It is ahead of the output by the
+ *  data queued in SCUX.
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ *  @param p_pos Pointer to store the position in samples.
+ *
+ *  @returns 
+ *    true if the position was counted from the output. false if it is the position of the decoder.
+ */
+static bool get_output_position(const dec_ctrl_t * const p_ctrl, uint64_t * const p_pos)
+{
+    bool                ret = false;
+    const codec_ctrl_t  *p_codec;
+    uint32_t            rate;
+
+    if ((p_ctrl != NULL) && (p_pos != NULL)) {
+        p_codec = &p_ctrl->p_cur->codec_ctrl;
+        *p_pos = codec_get_decoded_sample(p_codec);
+        if ((p_ctrl->is_out_pos_valid == true) && (p_ctrl->is_out_cnt_fixed == true) && 
+            (xfade_is_started(&xfade_ctrl) != true)) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+            /* out_frame_cnt is counted at the rate of SCUX input. */
+            rate = src_get_output_rate(&p_ctrl->p_cur->src_ctrl);
+#else
+            rate = p_ctrl->output_rate;
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+            if (rate > 0u) {    /* Prevents division by 0 */
+                *p_pos = p_ctrl->out_start_sample + 
+                        (((uint64_t)p_ctrl->out_frame_cnt * codec_get_sample_rate(p_codec)) / rate);
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Executes the stopping process of the pause
+ *
+ *  The data discarded by the pause is decoded again from the position output
+ *  before the mute. The data being output at the mute is output again, so no
+ *  data is skipped. When the position is unknown (see get_output_position()),
+ *  the playback resumes from the position of the decoder.
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool pause_proc(const uint32_t buf_id,
-        int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t element_num)
+static bool resume_proc(dec_ctrl_t * const p_ctrl)
 {
     bool                ret = false;
-    uint32_t            i;
-    int32_t             result;
-    const uint32_t      pause_data_size = SAMPLE_NUM_PER_UNIT_MS * sizeof(*p_buf[0]);
-    rbsp_data_conf_t    cb_conf = {
-        &write_callback,
-        NULL
-    };
+    bool                result;
+    codec_ctrl_t        *p_codec;
+    uint64_t            pos;
 
-    if ((p_buf != NULL) && (element_num > 0u) && 
-        (element_num <= PCM_BUF_NUM) && ((buf_id + element_num) <= PCM_BUF_NUM)) {
-        /* Audio output process */
-        result = ESUCCESS;
-        for (i = 0; (i < element_num) && (result == ESUCCESS); i++) {
-            (void) memset(&p_buf[i], 0, pause_data_size);
-            cb_conf.p_app_data = (void *)(buf_id + i);
-            result = scux.write(&p_buf[i], pause_data_size, &cb_conf);
+    if (p_ctrl != NULL) {
+        p_codec = &p_ctrl->p_cur->codec_ctrl;
+        result = get_output_position(p_ctrl, &pos);
+        if (result == true) {
+            result = codec_set_position(p_codec, pos);
+            if (result == true) {
+                /* Clears the filter state of the discarded data. */
+                (void) set_src_cfg(p_ctrl->p_cur);
+            } else {
+                pos = codec_get_decoded_sample(p_codec);
+            }
         }
-        if (result == ESUCCESS) {
-            ret = true;
+        ret = scux.TransStart();
+        if (ret == true) {
+            start_output(p_ctrl, pos);
         }
     }
     return ret;
@@ -472,7 +988,7 @@ static bool pause_proc(const uint32_t buf_id,
 
 /** Executes the starting process of the playback
  *
- *  @param p_ctrl Pointer to the control data of FLAC module.
+ *  @param p_ctrl Pointer to the control data of Decode thread.
  *  @param buf_id Index of PCM buffer array.
  *  @param p_buf Pointer to PCM buffer array to use in this process.
  *  @param element_num Elements number of PCM buffer array.
@@ -480,15 +996,13 @@ static bool pause_proc(const uint32_t buf_id,
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool play_proc(flac_ctrl_t * const p_ctrl, const uint32_t buf_id,
+static bool play_proc(dec_ctrl_t * const p_ctrl, const uint32_t buf_id,
         int32_t (* const p_buf)[TOTAL_SAMPLE_NUM], const uint32_t element_num)
 {
     bool                ret = false;
     int32_t             result;
-    uint32_t            i;
     uint32_t            decoded_cnt;
     uint32_t            num;
-    uint32_t            read_byte[PCM_BUF_NUM];
     rbsp_data_conf_t    cb_conf = {
         &write_callback,
         NULL
@@ -496,62 +1010,214 @@ static bool play_proc(flac_ctrl_t * const p_ctrl, const uint32_t buf_id,
 
     if ((p_ctrl != NULL) && (p_buf != NULL) && (element_num > 0u) && 
         (element_num <= PCM_BUF_NUM) && ((buf_id + element_num) <= PCM_BUF_NUM)) {
-        /* FLAC decoder process */
+        /* Decoder process and audio output process */
+        /* Each buffer is written as soon as it is decoded, so that the output */
+        /* starts without waiting for the decoding of all buffers. */
+        result = ESUCCESS;
         decoded_cnt = 0u;
         do {
-            num = get_audio_data(p_ctrl, p_buf[decoded_cnt], sizeof(p_buf[0])/sizeof(*p_buf[0]));
-            read_byte[decoded_cnt] = num * sizeof(num);
+            num = get_mixed_data(p_ctrl, p_buf[decoded_cnt], sizeof(p_buf[0])/sizeof(*p_buf[0]));
             if (num > 0u) {
+#if (DEC_SCUX_DIRECT_OUTPUT == 1)
+                /* The audio out thread does not see the data, so it is stored for the display. */
+                aud_store_audio_data(p_buf[decoded_cnt], num);
+#endif /* DEC_SCUX_DIRECT_OUTPUT */
+                cb_conf.p_app_data = (void *)(uintptr_t)(buf_id + decoded_cnt);
+                result = scux.write(&p_buf[decoded_cnt], num * sizeof(num), &cb_conf);
+                if (result == ESUCCESS) {
+                    /* Each write returns its result by write_callback(). */
+                    p_ctrl->write_cnt++;
+                }
                 decoded_cnt++;
             }
-        } while ((decoded_cnt < element_num) &&  (num > 0u));
-        /* Audio output process */
-        if (decoded_cnt > 0u) {
-            result = ESUCCESS;
-            for (i = 0; (i < decoded_cnt) && (result == ESUCCESS); i++) {
-                cb_conf.p_app_data = (void *)(buf_id + i);
-                result = scux.write(&p_buf[i], read_byte[i], &cb_conf);
+        } while ((decoded_cnt < element_num) && (num > 0u) && (result == ESUCCESS));
+        if ((decoded_cnt > 0u) && (result == ESUCCESS)) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Gets the decoded data of the playing track mixed with the next track
+ *
+ *  When the playing track ends, the next track takes over without the gap.
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ *  @param p_buf Pointer to PCM buffer array to store the decoded data.
+ *  @param buf_num Elements number of PCM buffer array.
+ *
+ *  @returns 
+ *    Elements number of decoded data.
+ */
+static uint32_t get_mixed_data(dec_ctrl_t * const p_ctrl, 
+                            int32_t * const p_buf, const uint32_t buf_num)
+{
+    uint32_t    read_cnt = 0u;
+    uint32_t    used_cnt;
+
+    if ((p_ctrl != NULL) && (p_buf != NULL) && (buf_num > 0u)) {
+        check_xfade_start(p_ctrl);
+        read_cnt = get_audio_data(p_ctrl->p_cur, p_buf, buf_num);
+        if (p_ctrl->p_next == NULL) {
+            /* DO NOTHING */
+        } else if (read_cnt > 0u) {
+            if (xfade_is_started(&xfade_ctrl) == true) {
+                /* The next track is decoded as much as the playing track in the same turn, */
+                /* so neither decoder falls behind the other. */
+                fill_next_buf(p_ctrl, read_cnt);
+                used_cnt = xfade_mix(&xfade_ctrl, p_buf, read_cnt, next_buf, p_ctrl->next_buf_cnt);
+                p_ctrl->next_buf_cnt -= used_cnt;
+                if (p_ctrl->next_buf_cnt > 0u) {
+                    (void) memmove(&next_buf[0], &next_buf[used_cnt], 
+                                        p_ctrl->next_buf_cnt * sizeof(next_buf[0]));
+                }
+            }
+        } else {
+            /* The playing track ended. Outputs the rest of the mixed data of the next track. */
+            /* It is less than a block, so it fits in the PCM buffer. */
+            if (p_ctrl->next_buf_cnt <= buf_num) {
+                read_cnt = p_ctrl->next_buf_cnt;
+            } else {
+                read_cnt = buf_num;
             }
-            if (result == ESUCCESS) {
-                ret = true;
+            (void) memcpy(p_buf, &next_buf[0], read_cnt * sizeof(next_buf[0]));
+            start_next_track(p_ctrl);
+            if (read_cnt == 0u) {
+                read_cnt = get_audio_data(p_ctrl->p_cur, p_buf, buf_num);
             }
         }
+        /* Applies the equalizer. It returns at once in the bypass. */
+        eq_process(&eq_ctrl, p_buf, read_cnt);
     }
-    return ret;
+    return read_cnt;
 }
 
-/** Gets the decoded data from FLAC decoder library
+/** Gets the decoded data from the decoder of the stream
  *
- *  @param p_ctrl Pointer to the control data of FLAC module.
+ *  @param p_stream Pointer to the stream to decode.
  *  @param p_buf Pointer to PCM buffer array to store the decoded data.
  *  @param buf_num Elements number of PCM buffer array.
  *
  *  @returns 
  *    Elements number of decoded data.
  */
-static uint32_t get_audio_data(flac_ctrl_t * const p_ctrl, 
+static uint32_t get_audio_data(dec_stream_t * const p_stream, 
                             int32_t * const p_buf, const uint32_t buf_num)
 {
     uint32_t    read_cnt = 0u;
     bool        result;
 
-    if ((p_ctrl != NULL) && (p_buf != NULL) && (buf_num > 0u)) {
-        result = flac_set_pcm_buf(p_ctrl, p_buf, buf_num);
+    if ((p_stream != NULL) && (p_buf != NULL) && (buf_num > 0u)) {
+        result = codec_set_pcm_buf(&p_stream->codec_ctrl, p_buf, buf_num);
         while ((result == true) && ((read_cnt + MAX_SAMPLE_PER_1BLOCK) <= buf_num)) {
-            result = flac_decode(p_ctrl);
-            read_cnt = flac_get_pcm_cnt(p_ctrl);
+            result = codec_decode(&p_stream->codec_ctrl);
+            read_cnt = codec_get_pcm_cnt(&p_stream->codec_ctrl);
         }
+        /* Converts the sampling rate if SCUX does not support it. */
+        read_cnt = src_convert(&p_stream->src_ctrl, p_buf, read_cnt);
     }
     return read_cnt;
 }
 
+/** Starts the crossfade when the rest of the playing track is shorter than its length
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ */
+static void check_xfade_start(const dec_ctrl_t * const p_ctrl)
+{
+    const codec_ctrl_t  *p_codec;
+    uint64_t            total;
+    uint64_t            decoded;
+    uint64_t            rest;
+    uint32_t            rate;
+    uint32_t            frame_num;
+
+    if ((p_ctrl != NULL) && (p_ctrl->p_next != NULL)) {
+        p_codec = &p_ctrl->p_cur->codec_ctrl;
+        total = codec_get_total_sample(p_codec);
+        decoded = codec_get_decoded_sample(p_codec);
+        rate = codec_get_sample_rate(p_codec);
+        if ((xfade_is_started(&xfade_ctrl) != true) && (total > decoded)) {
+            frame_num = xfade_get_frame_num(&xfade_ctrl, rate);
+            rest = total - decoded;
+            if (rest <= (uint64_t)frame_num) {
+                /* The length is the rest of the playing track at the rate of SCUX input. */
+                rest = (rest * src_get_output_rate(&p_ctrl->p_cur->src_ctrl)) / rate;
+                xfade_start(&xfade_ctrl, (uint32_t)rest);
+            }
+        }
+    }
+}
+
+/** Decodes the next track until the buffer has the specified number of data
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ *  @param sample_num Elements number of PCM data required. (TOTAL_SAMPLE_NUM or less)
+ */
+static void fill_next_buf(dec_ctrl_t * const p_ctrl, const uint32_t sample_num)
+{
+    bool        result = true;
+    uint32_t    num;
+
+    if ((p_ctrl != NULL) && (p_ctrl->p_next != NULL) && (sample_num <= TOTAL_SAMPLE_NUM)) {
+        /* The space is a block or more, because next_buf_cnt is less than TOTAL_SAMPLE_NUM. */
+        while ((result == true) && (p_ctrl->next_buf_cnt < sample_num)) {
+            result = codec_set_pcm_buf(&p_ctrl->p_next->codec_ctrl, &next_buf[p_ctrl->next_buf_cnt], 
+                                        NEXT_BUF_SAMPLE_NUM - p_ctrl->next_buf_cnt);
+            if (result == true) {
+                result = codec_decode(&p_ctrl->p_next->codec_ctrl);
+                num = codec_get_pcm_cnt(&p_ctrl->p_next->codec_ctrl);
+                num = src_convert(&p_ctrl->p_next->src_ctrl, &next_buf[p_ctrl->next_buf_cnt], num);
+                p_ctrl->next_buf_cnt += num;
+            }
+        }
+    }
+}
+
+/** Switches the playing track to the next track
+ *
+ *  @param p_ctrl Pointer to the control data of Decode thread.
+ */
+static void start_next_track(dec_ctrl_t * const p_ctrl)
+{
+    dec_stream_t    *p_prev;
+    uint32_t        time_code;
+
+    if ((p_ctrl != NULL) && (p_ctrl->p_next != NULL)) {
+        p_prev = p_ctrl->p_cur;
+        p_ctrl->p_cur = p_ctrl->p_next;
+        p_ctrl->p_next = NULL;
+        p_ctrl->next_buf_cnt = 0u;
+        xfade_stop(&xfade_ctrl);
+        codec_close(&p_prev->codec_ctrl);
+        /* The output position of the next track is unknown. */
+        p_ctrl->is_out_pos_valid = false;
+        vol_set_replay_gain(&vol_ctrl, codec_get_replay_gain(&p_ctrl->p_cur->codec_ctrl));
+        (void) apply_replay_gain(&vol_ctrl);
+        p_ctrl->p_next_cb(true, codec_get_sample_rate(&p_ctrl->p_cur->codec_ctrl), 
+                                codec_get_channel_num(&p_ctrl->p_cur->codec_ctrl));
+        time_code = codec_get_total_time(&p_ctrl->p_cur->codec_ctrl);
+        init_decode_playinfo(time_code, &p_ctrl->play_info);
+        update_decode_stat(SYS_PLAYSTAT_PLAY, &p_ctrl->play_info);
+    }
+}
+
 /** Callback function of Audio Out Thread
  *
  *  @param result Result of the process of Audio Out Thread
  */
 static void data_out_callback(const bool result)
 {
-    (void) send_mail(DEC_MAILID_CB_AUD_DATA_OUT, (uint32_t)result, MAIL_PARAM_NON);
+    (void) send_mail(DEC_MAILID_CB_AUD_DATA_OUT, (uint32_t)result, MAIL_PARAM_NON, MAIL_PARAM_NON);
+}
+
+/** Callback function of Audio Out Thread
+ *
+ *  @param frame_num Number of the frames output before the mute
+ */
+static void mute_out_callback(const uint32_t frame_num)
+{
+    (void) send_mail(DEC_MAILID_CB_AUD_MUTE_OUT, frame_num, MAIL_PARAM_NON, MAIL_PARAM_NON);
 }
 
 /** Callback function of SCUX driver
@@ -562,16 +1228,19 @@ static void data_out_callback(const bool result)
  */
 static void write_callback(void * p_data, int32_t result, void * p_app_data)
 {
-    const uint32_t  buf_id = (uint32_t)p_app_data;
+    const uint32_t  buf_id = (uint32_t)(uintptr_t)p_app_data;
     bool            flag_result;
+    uint32_t        write_byte;
 
     UNUSED_ARG(p_data);
     if (result > 0) {
         flag_result = true;
+        write_byte = (uint32_t)result;
     } else {
         flag_result = false;
+        write_byte = 0u;
     }
-    (void) send_mail(DEC_MAILID_SCUX_WRITE_FIN, (uint32_t)flag_result, buf_id);
+    (void) send_mail(DEC_MAILID_SCUX_WRITE_FIN, (uint32_t)flag_result, buf_id, write_byte);
 }
 
 /** Callback function of SCUX driver
@@ -587,7 +1256,7 @@ static void flush_callback(int32_t result)
     } else {
         flag_result = false;
     }
-    (void) send_mail(DEC_MAILID_SCUX_FLUSH_FIN, (uint32_t)flag_result, MAIL_PARAM_NON);
+    (void) send_mail(DEC_MAILID_SCUX_FLUSH_FIN, (uint32_t)flag_result, MAIL_PARAM_NON, MAIL_PARAM_NON);
 }
 
 /** Sends the mail to Decode thread
@@ -595,12 +1264,13 @@ static void flush_callback(int32_t result)
  *  @param mail_id Mail ID
  *  @param param0 Parameter 0 of this mail
  *  @param param1 Parameter 1 of this mail
+ *  @param param2 Parameter 2 of this mail
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool send_mail(const DEC_MAIL_ID mail_id, 
-                            const uint32_t param0, const uint32_t param1)
+static bool send_mail(const DEC_MAIL_ID mail_id, const uintptr_t param0, 
+                            const uintptr_t param1, const uintptr_t param2)
 {
     bool            ret = false;
     osStatus        stat;
@@ -610,6 +1280,7 @@ static bool send_mail(const DEC_MAIL_ID mail_id,
         p_mail->mail_id = mail_id;
         p_mail->param[MAIL_PARAM0] = param0;
         p_mail->param[MAIL_PARAM1] = param1;
+        p_mail->param[MAIL_PARAM2] = param2;
         stat = mail_box.put(p_mail);
         if (stat == osOK) {
             ret = true;
@@ -625,18 +1296,20 @@ static bool send_mail(const DEC_MAIL_ID mail_id,
  *  @param p_mail_id Pointer to the variable to store the mail ID
  *  @param p_param0 Pointer to the variable to store the parameter 0 of this mail
  *  @param p_param1 Pointer to the variable to store the parameter 1 of this mail
+ *  @param p_param2 Pointer to the variable to store the parameter 2 of this mail
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool recv_mail(DEC_MAIL_ID * const p_mail_id, 
-                        uint32_t * const p_param0, uint32_t * const p_param1)
+static bool recv_mail(DEC_MAIL_ID * const p_mail_id, uintptr_t * const p_param0, 
+                        uintptr_t * const p_param1, uintptr_t * const p_param2)
 {
     bool            ret = false;
     osEvent         evt;
     dec_mail_t      *p_mail;
     
-    if ((p_mail_id != NULL) && (p_param0 != NULL) && (p_param1 != NULL)) {
+    if ((p_mail_id != NULL) && (p_param0 != NULL) && 
+        (p_param1 != NULL) && (p_param2 != NULL)) {
         evt = mail_box.get();
         if (evt.status == osEventMail) {
             p_mail = (dec_mail_t *)evt.value.p;
@@ -644,6 +1317,7 @@ static bool recv_mail(DEC_MAIL_ID * const p_mail_id,
                 *p_mail_id = p_mail->mail_id;
                 *p_param0 = p_mail->param[MAIL_PARAM0];
                 *p_param1 = p_mail->param[MAIL_PARAM1];
+                *p_param2 = p_mail->param[MAIL_PARAM2];
                 ret = true;
             }
             (void) mail_box.free(p_mail);
@@ -693,6 +1367,7 @@ static void init_decode_playinfo(const uint32_t total_time, play_info_t * const
         p_play_info->play_stat  = SYS_PLAYSTAT_STOP;
         p_play_info->play_time  = 0u;
         p_play_info->total_time = total_time;
+        p_play_info->play_sample = 0u;
     }
 }
 
@@ -704,6 +1379,6 @@ static void notify_decode_stat(const play_info_t * const p_play_info)
 {
     if (p_play_info != NULL) {
         (void) sys_notify_play_time(p_play_info->play_stat, 
-                    p_play_info->play_time, p_play_info->total_time);
+                    p_play_info->play_time, p_play_info->total_time, p_play_info->play_sample);
     }
 }
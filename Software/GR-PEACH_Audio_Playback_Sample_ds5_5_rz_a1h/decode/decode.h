@@ -27,6 +27,9 @@
 #include "r_typedefs.h"
 #include "USBHostMSD.h"
 #include "R_BSP_Scux.h"
+#include "dec_eq.h"
+#include "dec_vol.h"
+#include "dec_xfade.h"
 
 /*--- Macro definition ---*/
 #define DEC_STACK_SIZE              (2048u)     /* Stack size of Decode thread */
@@ -34,20 +37,43 @@
 #define DEC_MAX_BLOCK_SIZE          (16384u)    /* Maximum block size */
 #define DEC_16BITS_PER_SAMPLE       (16u)       /* Bit count per sample */
 #define DEC_24BITS_PER_SAMPLE       (24u)       /* Bit count per sample */
-#define DEC_MAX_CHANNEL_NUM         (2u)        /* Maximum number of channel */
+#define DEC_MIN_BITS_PER_SAMPLE     (8u)        /* Minimum bit count per sample of input file */
+#define DEC_MAX_BITS_PER_SAMPLE     (32u)       /* Maximum bit count per sample of input file */
+#define DEC_MAX_CHANNEL_NUM         (8u)        /* Maximum number of channel of input file */
 #define DEC_OUTPUT_PADDING_BITS     (8u)        /* Padding of lower 8 bits */
 #define DEC_SCUX_READ_NUM           (9u)        /* The number of buffuer for SCUX read */
 
 /* Minimum sampling rate in Hz of input file */
 #define DEC_INPUT_MIN_SAMPLE_RATE   (SAMPLING_RATE_22050HZ)
 /* Maximum sampling rate in Hz of input file */
-#define DEC_INPUT_MAX_SAMPLE_RATE   (SAMPLING_RATE_96000HZ)
+/* The file over DEC_SCUX_MAX_SAMPLE_RATE is decimated by 2 in software before SCUX. */
+#define DEC_INPUT_MAX_SAMPLE_RATE   (192000u)
+/* Maximum sampling rate in Hz of SCUX input */
+#define DEC_SCUX_MAX_SAMPLE_RATE    (SAMPLING_RATE_96000HZ)
 /* Sampling rate in Hz of audio output */
 #define DEC_OUTPUT_SAMPLE_RATE      (SAMPLING_RATE_96000HZ)
-/* Channel number of audio output */
-#define DEC_OUTPUT_CHANNEL_NUM      (DEC_MAX_CHANNEL_NUM)
+/* Channel number of audio output. The file over 2ch is downmixed to stereo. */
+#define DEC_OUTPUT_CHANNEL_NUM      (2u)
 /* Bit count per sample of audio output */
 #define DEC_OUTPUT_BITS_PER_SAMPLE  (DEC_24BITS_PER_SAMPLE)
+/* Output mode of the sampling rate */
+/* 1 : Outputs the file at its own sampling rate if the audio codec supports it. */
+/*     The SRC of SCUX is bypassed. Other rates are converted to DEC_OUTPUT_SAMPLE_RATE. */
+/* 0 : Always converts to DEC_OUTPUT_SAMPLE_RATE by the SRC of SCUX. */
+#define DEC_NATIVE_RATE_OUTPUT      (1)
+/* Output route of SCUX */
+/* 1 : SCUX outputs to SSIF0 directly. Audio Output thread only controls the audio codec. */
+/*     SCUX driver owns SSIF0, and TLV320_RBSP does not open it. */
+/* 0 : Audio Output thread reads the SCUX output and writes it to SSIF0 by TLV320_RBSP. */
+/* The direct route is not validated on the board yet, so 0 is the default. */
+#ifndef DEC_SCUX_DIRECT_OUTPUT
+#define DEC_SCUX_DIRECT_OUTPUT      (0)
+#endif
+/* Range of the volume in dB */
+#define DEC_VOLUME_MIN              (VOL_MIN)
+#define DEC_VOLUME_MAX              (VOL_MAX)
+/* Maximum length of the crossfade in ms */
+#define DEC_XFADE_MAX_TIME_MS       (XFADE_MAX_TIME_MS)
 
 /*--- User defined types ---*/
 typedef void (*DEC_CbOpen)(const bool result, 
@@ -63,6 +89,8 @@ void dec_thread(void const *argument);
 /** Instructs the decode thread to open the decoder.
  *
  *  @param p_handle File handle
+ *  @param start_sample Position in samples where the playback starts. 0 is the top.
+ *              The track is played from the top if it is out of the track.
  *  @param p_cb Callback function for notifying the completion of open processing
  *              typedef void (*DEC_CbOpen)(const bool result, 
  *                            const uint32_t sample_freq, const uint32_t channel_num);
@@ -80,7 +108,37 @@ void dec_thread(void const *argument);
  *     Failed to secure memory for mailbox communication.
  *     Failed to perform transmit processing for mailbox communication.
  */
-bool dec_open(FILE * const p_handle, const DEC_CbOpen p_cb);
+bool dec_open(FILE * const p_handle, const uint32_t start_sample, const DEC_CbOpen p_cb);
+
+/** Instructs the decode thread to open the decoder of the next track during the playback.
+ *
+ *  The next track starts when the playing track ends. If the crossfade is set by
+ *  dec_set_xfade(), the next track is mixed from the end of the playing track.
+ *  The next track must have the same sampling rate of SCUX input as the playing track,
+ *  because SCUX is not stopped. Otherwise the open fails.
+ *
+ *  @param p_handle File handle
+ *  @param p_cb_open Callback function for notifying the completion of open processing
+ *              typedef void (*DEC_CbOpen)(const bool result, 
+ *                            const uint32_t sample_freq, const uint32_t channel_num);
+ *              The arguments are the same as dec_open().
+ *              When result is false, the file handle is not used by the decode thread.
+ *  @param p_cb_start Callback function for notifying the start of the next track
+ *              The arguments are the same as p_cb_open. result is always true.
+ *              The decoder of the previous track is closed before the call, and its
+ *              file handle can be closed.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     The argument p_handle is set to NULL.
+ *     The argument p_cb_open is set to NULL.
+ *     The argument p_cb_start is set to NULL.
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dec_open_next(FILE * const p_handle, 
+                    const DEC_CbOpen p_cb_open, const DEC_CbOpen p_cb_start);
 
 /** Instructs the decode thread for playback.
  *
@@ -136,6 +194,55 @@ bool dec_stop(void);
  */
 bool dec_close(const DEC_CbClose p_cb);
 
+/** Instructs the decode thread to set the equalizer.
+ *
+ *  @param p_param Parameter of the equalizer. NULL disables the equalizer.
+ *                 The parameter is copied before this function returns, so it can be
+ *                 placed in a stack. The change is crossfaded during the playback.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dec_set_eq(const eq_param_t * const p_param);
+
+/** Instructs the decode thread to set the volume.
+ *
+ *  When DEC_SCUX_DIRECT_OUTPUT is 1, the volume is applied by the ramp volume of SCUX DVU.
+ *  Otherwise it is applied by the headphone volume of the audio codec.
+ *  ReplayGain of the track (REPLAYGAIN_TRACK_GAIN) is added to the volume.
+ *
+ *  @param volume Volume in dB. DEC_VOLUME_MIN to DEC_VOLUME_MAX
+ *  @param mute Mute. true is on.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     The argument volume is out of range.
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dec_set_volume(const int32_t volume, const bool mute);
+
+/** Instructs the decode thread to set the crossfade between tracks.
+ *
+ *  @param time_ms Length of the crossfade in ms. 0 to DEC_XFADE_MAX_TIME_MS. 0 is off.
+ *                 When it is off, the next track opened by dec_open_next() starts
+ *                 without the gap.
+ *  @param curve Curve of the crossfade.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     The argument time_ms is out of range.
+ *     The argument curve is out of range.
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dec_set_xfade(const uint32_t time_ms, const XFADE_Curve curve);
+
 /** Issues a read request to the SCUX driver.
  *
  *  @param p_data Buffer for storing the read data
@@ -0,0 +1,472 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include <math.h>
+#include "mbed.h"
+#include "misratypes.h"
+#include "display.h"
+#include "disp_spec.h"
+#include "audio_out.h"
+
+/*--- Macro definition ---*/
+#define TAP_CH_NUM          (2u)                    /* Audio data is 2ch interleaved. */
+#define TAP_CH_L            (0u)
+#define TAP_CH_R            (1u)
+#define FFT_SIZE            (256u)                  /* Points of the complex FFT (4^4) */
+#define FFT_STAGE_NUM       (4u)                    /* Number of the radix-4 stages */
+#define FFT_DIGIT_BITS      (2u)                    /* Bits of a digit of radix-4 */
+#define FFT_DIGIT_MASK      (3u)
+#define FFT_STAGE_SHIFT     (2)                     /* Each stage is scaled by 1/4. */
+#define FFT_INPUT_SHIFT     (8)                     /* 16 bits data to Q23 */
+#define TW_POINT            (512u)                  /* Twiddle factors are exp(-j*2*pi*k/TW_POINT) */
+#define TW_NUM              ((TW_POINT * 3u) / 4u)  /* 3/4 turn is enough for the FFT and the split */
+#define Q15_SHIFT           (15)
+#define Q15_ONE             (32768.0f)
+#define TWO_PI              (6.28318531f)
+
+#if (DSP_SPEC_FFT_POINT == 512u)
+#define SPEC_FRAME_NUM      (DSP_SPEC_FFT_POINT)    /* Frames of the audio data */
+#elif (DSP_SPEC_FFT_POINT == 256u)
+#define SPEC_FRAME_NUM      (DSP_SPEC_FFT_POINT)    /* Frames of the audio data */
+#else
+#error "DSP_SPEC_FFT_POINT must be 256 or 512."
+#endif
+#define SPEC_BIN_NUM        (DSP_SPEC_FFT_POINT / 2u)   /* Bin 0 (DC) is not used. */
+
+/* Amplitude of the full scale sine in the bin after the FFT with the Hann window */
+#define FULL_SCALE_AMP      (((float)INT16_MAX * (float)(1u << FFT_INPUT_SHIFT) * \
+                              (float)DSP_SPEC_FFT_POINT) / (4.0f * (float)FFT_SIZE))
+/* Power of a sine in the main lobe of the Hann window (1 + 0.5^2 + 0.5^2) */
+#define HANN_LOBE_POWER     (1.5f)
+#define FULL_SCALE_POWER    (FULL_SCALE_AMP * FULL_SCALE_AMP * HANN_LOBE_POWER)
+#define PCM_FULL_SCALE      ((float)INT16_MAX)
+#define POWER_TO_DB         (10.0f)
+#define METER_FALL_DB       (3)                     /* Fall of the levels per cycle */
+
+/*--- User defined types ---*/
+typedef struct {
+    int32_t     re;
+    int32_t     im;
+} cplx_t;
+
+static int16_t pcm_data[SPEC_FRAME_NUM * TAP_CH_NUM];
+static cplx_t fft_buf[FFT_SIZE];
+static int32_t tw_cos[TW_NUM];                      /* cos(2*pi*k/TW_POINT) in Q15 */
+static int32_t tw_sin[TW_NUM];                      /* sin(2*pi*k/TW_POINT) in Q15 */
+static int32_t hann_window[DSP_SPEC_FFT_POINT];     /* Q15 */
+static uint32_t band_edge[DSP_METER_BAND_NUM + 1u]; /* First bin of each band */
+static bool data_result = false;
+
+static void get_data_callback(const bool result, int16_t * const p_buf, 
+    const uint32_t buf_num, const int32_t * const p_audio, const uint32_t audio_num);
+static void calc_meter(const int16_t * const p_data, 
+                        int32_t * const p_peak, int32_t * const p_rms);
+static void calc_spectrum(const int16_t * const p_data, int32_t * const p_band);
+static void fill_fft_buf(const int16_t * const p_data, cplx_t * const p_buf);
+static void fft_radix4(cplx_t * const p_buf);
+static int64_t get_bin_power(const cplx_t * const p_buf, const uint32_t bin);
+static int32_t to_db(const float power, const float full_scale);
+static bool update_level(int32_t * const p_level, const int32_t new_level);
+static inline int32_t mul_q15(const int32_t data, const int32_t coef);
+
+void dsp_init_spec(void)
+{
+    uint32_t    i;
+    uint32_t    edge;
+    float       angle;
+
+    for (i = 0u; i < TW_NUM; i++) {
+        angle = (TWO_PI * (float)i) / (float)TW_POINT;
+        tw_cos[i] = (int32_t)lrintf(cosf(angle) * Q15_ONE);
+        tw_sin[i] = (int32_t)lrintf(sinf(angle) * Q15_ONE);
+    }
+    for (i = 0u; i < DSP_SPEC_FFT_POINT; i++) {
+        angle = (TWO_PI * (float)i) / (float)DSP_SPEC_FFT_POINT;
+        hann_window[i] = (int32_t)lrintf((0.5f - (0.5f * cosf(angle))) * Q15_ONE);
+    }
+    /* The bands are spaced logarithmically from bin 1 to SPEC_BIN_NUM. */
+    band_edge[0] = 1u;
+    for (i = 1u; i < DSP_METER_BAND_NUM; i++) {
+        edge = (uint32_t)lrintf(powf((float)SPEC_BIN_NUM, (float)i / (float)DSP_METER_BAND_NUM));
+        if (edge <= band_edge[i - 1u]) {
+            edge = band_edge[i - 1u] + 1u;
+        }
+        band_edge[i] = edge;
+    }
+    band_edge[DSP_METER_BAND_NUM] = SPEC_BIN_NUM;
+}
+
+bool dsp_exe_spec(dsp_com_ctrl_t * const p_com)
+{
+    bool        ret = false;
+    bool        result;
+    uint32_t    i;
+    int32_t     band[DSP_METER_BAND_NUM];
+    int32_t     peak[DSP_METER_CH_NUM];
+    int32_t     rms[DSP_METER_CH_NUM];
+
+    if (p_com != NULL) {
+        data_result = false;
+        (void) aud_get_audio_data(&get_data_callback, &pcm_data[0], sizeof(pcm_data) / sizeof(pcm_data[0]));
+        if (data_result == true) {
+            calc_meter(&pcm_data[0], &peak[0], &rms[0]);
+            calc_spectrum(&pcm_data[0], &band[0]);
+        } else {
+            for (i = 0u; i < DSP_METER_CH_NUM; i++) {
+                peak[i] = DSP_METER_LEVEL_MIN;
+                rms[i] = DSP_METER_LEVEL_MIN;
+            }
+            for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+                band[i] = DSP_METER_LEVEL_MIN;
+            }
+        }
+        for (i = 0u; i < DSP_METER_CH_NUM; i++) {
+            result = update_level(&p_com->peak_level[i], peak[i]);
+            if (result == true) {
+                ret = true;
+            }
+            result = update_level(&p_com->rms_level[i], rms[i]);
+            if (result == true) {
+                ret = true;
+            }
+        }
+        for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+            result = update_level(&p_com->band_level[i], band[i]);
+            if (result == true) {
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Callback function of aud_get_audio_data
+ *
+ *  @param result Result of the process.
+ *  @param p_buf Pointer to the buffer of the audio data.
+ *  @param buf_num Array size of the buffer.
+ *  @param p_audio Not used.
+ *  @param audio_num Not used.
+ */
+static void get_data_callback(const bool result, int16_t * const p_buf, 
+    const uint32_t buf_num, const int32_t * const p_audio, const uint32_t audio_num)
+{
+    UNUSED_ARG(p_buf);
+    UNUSED_ARG(buf_num);
+    UNUSED_ARG(p_audio);
+    UNUSED_ARG(audio_num);
+    data_result = result;
+}
+
+/** Calculates the peak and RMS levels of each channel
+ *
+ *  @param p_data Pointer to the audio data (2ch interleaved).
+ *  @param p_peak Pointer to the array to store the peak levels in dB.
+ *  @param p_rms Pointer to the array to store the RMS levels in dB.
+ */
+static void calc_meter(const int16_t * const p_data, 
+                        int32_t * const p_peak, int32_t * const p_rms)
+{
+    uint32_t    i;
+    uint32_t    ch;
+    int32_t     data;
+    int32_t     peak;
+    int64_t     sum;
+
+    if ((p_data != NULL) && (p_peak != NULL) && (p_rms != NULL)) {
+        for (ch = 0u; ch < DSP_METER_CH_NUM; ch++) {
+            peak = 0;
+            sum = 0;
+            for (i = 0u; i < SPEC_FRAME_NUM; i++) {
+                data = (int32_t)p_data[(i * TAP_CH_NUM) + ch];
+                if (data < 0) {
+                    data = -data;
+                }
+                if (data > peak) {
+                    peak = data;
+                }
+                sum += (int64_t)data * data;
+            }
+            p_peak[ch] = to_db((float)peak * (float)peak, PCM_FULL_SCALE * PCM_FULL_SCALE);
+            p_rms[ch] = to_db((float)sum / (float)SPEC_FRAME_NUM, PCM_FULL_SCALE * PCM_FULL_SCALE);
+        }
+    }
+}
+
+/** Calculates the levels of the spectrum bands
+ *
+ *  @param p_data Pointer to the audio data (2ch interleaved).
+ *  @param p_band Pointer to the array to store the band levels in dB.
+ */
+static void calc_spectrum(const int16_t * const p_data, int32_t * const p_band)
+{
+    uint32_t    band;
+    uint32_t    bin;
+    int64_t     power;
+
+    if ((p_data != NULL) && (p_band != NULL)) {
+        fill_fft_buf(p_data, &fft_buf[0]);
+        fft_radix4(&fft_buf[0]);
+        for (band = 0u; band < DSP_METER_BAND_NUM; band++) {
+            power = 0;
+            for (bin = band_edge[band]; bin < band_edge[band + 1u]; bin++) {
+                power += get_bin_power(&fft_buf[0], bin);
+            }
+            p_band[band] = to_db((float)power, FULL_SCALE_POWER);
+        }
+    }
+}
+
+/** Applies the window to the audio data and stores it in the FFT buffer
+ *
+ *  When DSP_SPEC_FFT_POINT is 512, (L + R) / 2 is packed to the complex data
+ *  as re = x[2n], im = x[2n+1]. When it is 256, re = L[n], im = R[n].
+ *
+ *  @param p_data Pointer to the audio data (2ch interleaved).
+ *  @param p_buf Pointer to the FFT buffer.
+ */
+static void fill_fft_buf(const int16_t * const p_data, cplx_t * const p_buf)
+{
+    uint32_t    i;
+#if (DSP_SPEC_FFT_POINT == 512u)
+    uint32_t    pos;
+    int32_t     even;
+    int32_t     odd;
+#endif
+
+    if ((p_data != NULL) && (p_buf != NULL)) {
+        for (i = 0u; i < FFT_SIZE; i++) {
+#if (DSP_SPEC_FFT_POINT == 512u)
+            pos = (i * 2u) * TAP_CH_NUM;
+            even = ((int32_t)p_data[pos + TAP_CH_L] + p_data[pos + TAP_CH_R]) << (FFT_INPUT_SHIFT - 1);
+            pos += TAP_CH_NUM;
+            odd = ((int32_t)p_data[pos + TAP_CH_L] + p_data[pos + TAP_CH_R]) << (FFT_INPUT_SHIFT - 1);
+            p_buf[i].re = mul_q15(even, hann_window[i * 2u]);
+            p_buf[i].im = mul_q15(odd, hann_window[(i * 2u) + 1u]);
+#else
+            p_buf[i].re = mul_q15((int32_t)p_data[(i * TAP_CH_NUM) + TAP_CH_L] << FFT_INPUT_SHIFT, 
+                                                                            hann_window[i]);
+            p_buf[i].im = mul_q15((int32_t)p_data[(i * TAP_CH_NUM) + TAP_CH_R] << FFT_INPUT_SHIFT, 
+                                                                            hann_window[i]);
+#endif
+        }
+    }
+}
+
+/** Executes the complex FFT of FFT_SIZE points
+ *
+ *  Radix-4 decimation in frequency. Each stage is scaled by 1/4, so the result
+ *  is the DFT divided by FFT_SIZE. The result is in the natural order.
+ *
+ *  @param p_buf Pointer to the FFT buffer.
+ */
+static void fft_radix4(cplx_t * const p_buf)
+{
+    uint32_t    len;
+    uint32_t    quarter;
+    uint32_t    tw_step;
+    uint32_t    i;
+    uint32_t    j;
+    uint32_t    k;
+    uint32_t    rev;
+    uint32_t    tw1;
+    uint32_t    tw2;
+    uint32_t    tw3;
+    cplx_t      a;
+    cplx_t      b;
+    cplx_t      c;
+    cplx_t      d;
+    cplx_t      t0;
+    cplx_t      t1;
+    cplx_t      t2;
+    cplx_t      t3;
+    cplx_t      y;
+
+    if (p_buf != NULL) {
+        for (len = FFT_SIZE; len >= 4u; len /= 4u) {
+            quarter = len / 4u;
+            tw_step = TW_POINT / len;
+            for (j = 0u; j < quarter; j++) {
+                tw1 = j * tw_step;
+                tw2 = tw1 * 2u;
+                tw3 = tw1 * 3u;
+                for (i = j; i < FFT_SIZE; i += len) {
+                    a.re = p_buf[i].re >> FFT_STAGE_SHIFT;
+                    a.im = p_buf[i].im >> FFT_STAGE_SHIFT;
+                    b.re = p_buf[i + quarter].re >> FFT_STAGE_SHIFT;
+                    b.im = p_buf[i + quarter].im >> FFT_STAGE_SHIFT;
+                    c.re = p_buf[i + (quarter * 2u)].re >> FFT_STAGE_SHIFT;
+                    c.im = p_buf[i + (quarter * 2u)].im >> FFT_STAGE_SHIFT;
+                    d.re = p_buf[i + (quarter * 3u)].re >> FFT_STAGE_SHIFT;
+                    d.im = p_buf[i + (quarter * 3u)].im >> FFT_STAGE_SHIFT;
+                    t0.re = a.re + c.re;
+                    t0.im = a.im + c.im;
+                    t1.re = a.re - c.re;
+                    t1.im = a.im - c.im;
+                    t2.re = b.re + d.re;
+                    t2.im = b.im + d.im;
+                    t3.re = b.re - d.re;
+                    t3.im = b.im - d.im;
+                    /* X0 = t0 + t2 */
+                    p_buf[i].re = t0.re + t2.re;
+                    p_buf[i].im = t0.im + t2.im;
+                    /* X1 = (t1 - j * t3) * W^tw1 */
+                    y.re = t1.re + t3.im;
+                    y.im = t1.im - t3.re;
+                    p_buf[i + quarter].re = mul_q15(y.re, tw_cos[tw1]) + mul_q15(y.im, tw_sin[tw1]);
+                    p_buf[i + quarter].im = mul_q15(y.im, tw_cos[tw1]) - mul_q15(y.re, tw_sin[tw1]);
+                    /* X2 = (t0 - t2) * W^tw2 */
+                    y.re = t0.re - t2.re;
+                    y.im = t0.im - t2.im;
+                    p_buf[i + (quarter * 2u)].re = mul_q15(y.re, tw_cos[tw2]) + mul_q15(y.im, tw_sin[tw2]);
+                    p_buf[i + (quarter * 2u)].im = mul_q15(y.im, tw_cos[tw2]) - mul_q15(y.re, tw_sin[tw2]);
+                    /* X3 = (t1 + j * t3) * W^tw3 */
+                    y.re = t1.re - t3.im;
+                    y.im = t1.im + t3.re;
+                    p_buf[i + (quarter * 3u)].re = mul_q15(y.re, tw_cos[tw3]) + mul_q15(y.im, tw_sin[tw3]);
+                    p_buf[i + (quarter * 3u)].im = mul_q15(y.im, tw_cos[tw3]) - mul_q15(y.re, tw_sin[tw3]);
+                }
+            }
+        }
+        /* Reorders the result from the digit reversed order. */
+        for (i = 0u; i < FFT_SIZE; i++) {
+            rev = 0u;
+            k = i;
+            for (j = 0u; j < FFT_STAGE_NUM; j++) {
+                rev = (rev << FFT_DIGIT_BITS) | (k & FFT_DIGIT_MASK);
+                k >>= FFT_DIGIT_BITS;
+            }
+            if (rev > i) {
+                y = p_buf[i];
+                p_buf[i] = p_buf[rev];
+                p_buf[rev] = y;
+            }
+        }
+    }
+}
+
+/** Gets the power of the bin of the real input FFT
+ *
+ *  Separates the spectra of the real data packed to the complex FFT.
+ *  Z[k] is the complex FFT. E[k] = (Z[k] + conj(Z[N-k])) / 2, O[k] = (Z[k] - conj(Z[N-k])) / 2j.
+ *  When DSP_SPEC_FFT_POINT is 512, X[k] = E[k] + O[k] * exp(-j*2*pi*k/512).
+ *  When it is 256, E[k] and O[k] are the spectra of L and R, and their powers are averaged.
+ *
+ *  @param p_buf Pointer to the result of the complex FFT.
+ *  @param bin Bin number. 1 to (SPEC_BIN_NUM - 1).
+ *
+ *  @returns 
+ *    Power of the bin.
+ */
+static int64_t get_bin_power(const cplx_t * const p_buf, const uint32_t bin)
+{
+    int64_t     power = 0;
+    cplx_t      e;
+    cplx_t      o;
+    const cplx_t *p_a;
+    const cplx_t *p_b;
+
+    if ((p_buf != NULL) && (bin > 0u) && (bin < SPEC_BIN_NUM)) {
+        p_a = &p_buf[bin];
+        p_b = &p_buf[FFT_SIZE - bin];
+        e.re = (p_a->re + p_b->re) / 2;
+        e.im = (p_a->im - p_b->im) / 2;
+        o.re = (p_a->im + p_b->im) / 2;
+        o.im = (p_b->re - p_a->re) / 2;
+#if (DSP_SPEC_FFT_POINT == 512u)
+        e.re += mul_q15(o.re, tw_cos[bin]) + mul_q15(o.im, tw_sin[bin]);
+        e.im += mul_q15(o.im, tw_cos[bin]) - mul_q15(o.re, tw_sin[bin]);
+        power = ((int64_t)e.re * e.re) + ((int64_t)e.im * e.im);
+#else
+        power = (((int64_t)e.re * e.re) + ((int64_t)e.im * e.im) + 
+                 ((int64_t)o.re * o.re) + ((int64_t)o.im * o.im)) / 2;
+#endif
+    }
+    return power;
+}
+
+/** Converts the power ratio to the level in dB
+ *
+ *  @param power Power.
+ *  @param full_scale Power of the full scale.
+ *
+ *  @returns 
+ *    Level in dB. DSP_METER_LEVEL_MIN to DSP_METER_LEVEL_MAX.
+ */
+static int32_t to_db(const float power, const float full_scale)
+{
+    int32_t     level = DSP_METER_LEVEL_MIN;
+
+    if ((power > 0.0f) && (full_scale > 0.0f)) {
+        level = (int32_t)lrintf(POWER_TO_DB * log10f(power / full_scale));
+        if (level < DSP_METER_LEVEL_MIN) {
+            level = DSP_METER_LEVEL_MIN;
+        } else if (level > DSP_METER_LEVEL_MAX) {
+            level = DSP_METER_LEVEL_MAX;
+        } else {
+            /* DO NOTHING */
+        }
+    }
+    return level;
+}
+
+/** Updates the level with the fall time
+ *
+ *  The level rises at once, and falls by METER_FALL_DB per cycle.
+ *
+ *  @param p_level Pointer to the level to update.
+ *  @param new_level New level in dB.
+ *
+ *  @returns 
+ *    true if the level is changed. false if the level is not changed.
+ */
+static bool update_level(int32_t * const p_level, const int32_t new_level)
+{
+    bool        ret = false;
+    int32_t     level;
+
+    if (p_level != NULL) {
+        level = new_level;
+        if (level < (*p_level - METER_FALL_DB)) {
+            level = *p_level - METER_FALL_DB;
+        }
+        if (level != *p_level) {
+            *p_level = level;
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Multiplies the data by the coefficient in Q15
+ *
+ *  @param data Data.
+ *  @param coef Coefficient in Q15.
+ *
+ *  @returns 
+ *    Result of the multiplication.
+ */
+static inline int32_t mul_q15(const int32_t data, const int32_t coef)
+{
+    return (int32_t)(((int64_t)data * coef) >> Q15_SHIFT);
+}
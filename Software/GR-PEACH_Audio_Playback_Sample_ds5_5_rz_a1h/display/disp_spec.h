@@ -0,0 +1,57 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DISP_SPEC_H
+#define DISP_SPEC_H
+
+#include "display.h"
+
+/*--- Macro definition ---*/
+/* Number of points of the FFT */
+/* 512 : The spectrum of (L + R) / 2 by the FFT of 512 points. */
+/* 256 : The spectra of L and R by the FFT of 256 points. They are averaged in power. */
+/* Both are calculated by the complex FFT of 256 points (radix-4). */
+#ifndef DSP_SPEC_FFT_POINT
+#define DSP_SPEC_FFT_POINT      (512u)
+#endif
+
+/** Initialises the level meter module
+ *
+ *  Makes the tables of the twiddle factors, the window and the bands.
+ */
+void dsp_init_spec(void);
+
+/** Executes the main processing of the level meter module
+ *
+ *  Gets the latest audio data from the audio out thread, and calculates the
+ *  levels of the spectrum bands and the peak/RMS meters. When no audio data is
+ *  got, the levels fall to DSP_METER_LEVEL_MIN.
+ *
+ *  @param p_com Pointer to common data in all display module.
+ *
+ *  @returns 
+ *    true if any level is changed. false if no level is changed.
+ */
+bool dsp_exe_spec(dsp_com_ctrl_t * const p_com);
+
+#endif /* DISP_SPEC_H */
@@ -25,17 +25,24 @@
 #include "rtos.h"
 #include "display.h"
 #include "disp_term.h"
+#include "disp_uart.h"
 
 /*--- Macro definition ---*/
 #define MOVE_CURSOR_TO_LEFT     "\x1b[128D" /* Moves a cursor to the left. */
 #define CLEAR_CURSOR_RIGHT      "\x1b[0K"   /* Clears the right side of the cursor position. */
 #define CLEAR_CURSOR_LINE       "\x1b[2K"   /* Clears a cursor line. */
 #define CLEAR_ALL               "\x1b[2J"   /* Clears all screen. */
+#define SAVE_CURSOR             "\x1b" "7"  /* Saves the cursor position. */
+#define RESTORE_CURSOR          "\x1b" "8"  /* Restores the cursor position. */
+#define MOVE_CURSOR_TO_TOP      "\x1b[1;1H" /* Moves a cursor to the top line. */
+#define MOVE_CURSOR_TO_SECOND   "\x1b[2;1H" /* Moves a cursor to the second line. */
+#define SET_SCROLL_REGION       "\x1b[2r"   /* Scrolls the lines except the top line. */
+#define RESET_SCROLL_REGION     "\x1b[r"    /* Scrolls all lines. */
+#define MOVE_CURSOR_TO_COLUMN   "\x1b[%luG" /* Moves a cursor to the column of the cursor line. */
+#define MOVE_CURSOR_TO_TOP_COL  "\x1b[1;%luH" /* Moves a cursor to the column of the top line. */
 #define STR_CR                  "\r\n"
 
-#define MSG_PROMPT               MOVE_CURSOR_TO_LEFT \
-                                "T%ld %ld:%02ld:%02ld > "\
-                                CLEAR_CURSOR_RIGHT
+#define MSG_PROMPT              "T%ld %ld:%02ld:%02ld > "
 #define MSG_FILENAME_PREFIX     "File Name = "
 #define MSG_FILE_TYPE           "File type      : FLAC"
 #define MSG_SAMPLING_FREQ       "Sampling freq. : %ld Hz"
@@ -45,33 +52,56 @@
 #define MSG_REPEAT_PREFIX       "Repeat Mode = "
 #define MSG_MODE_ON             "on"
 #define MSG_MODE_OFF            "off"
+#define MSG_METER_PREFIX        "Pk%4ld%4ld Rms%4ld%4ld |"
+#define MSG_METER_SUFFIX        "|"
 
-#define HELP_CMD_NUM            (7u)
+/* Characters of the spectrum bands from DSP_METER_LEVEL_MIN to DSP_METER_LEVEL_MAX */
+#define METER_GLYPH             " .:-=+*#%@"
+#define METER_GLYPH_NUM         (sizeof(METER_GLYPH) - 1u)
+#define METER_LEVEL_RANGE       (DSP_METER_LEVEL_MAX - DSP_METER_LEVEL_MIN)
+
+#define HELP_CMD_NUM            (13u)
 
 /* help information */
+#define HELP_INFO_EQ            "eq        : Set the equalizer: eq flat, eq bass or eq treble."
 #define HELP_INFO_HELP          "help      : Show help information for commands."
+#define HELP_INFO_METER         "meter     : Turn on and off the level meter and the spectrum."
+#define HELP_INFO_MUTE          "mute      : Turn on and off the mute."
 #define HELP_INFO_NEXT          "next      : Select the next song."
 #define HELP_INFO_PLAYINFO      "playinfo  : Show the song information."
 #define HELP_INFO_PLAYPAUSE     "playpause : Control playback/pause."
 #define HELP_INFO_PREV          "prev      : Select the previous song."
 #define HELP_INFO_REPEAT        "repeat    : Turn on and off the repeat mode."
 #define HELP_INFO_STOP          "stop      : Stop playback."
+#define HELP_INFO_VOLDOWN       "voldown   : Turn down the volume."
+#define HELP_INFO_VOLUP         "volup     : Turn up the volume."
+#define HELP_INFO_XFADE         "xfade     : Turn on and off the crossfade between songs."
 
 #define MIN_TO_SEC              (60u)
 #define HOUR_TO_SEC             (3600u)
 
-static Serial pc_out(USBTX, USBRX);
+/* The screen contents last sent. Only the changed columns are sent again. */
+/* The empty string means that the contents are unknown. */
+static char_t last_prompt[DSP_DISP_STR_MAX_LEN];
+static char_t last_meter[DSP_DISP_STR_MAX_LEN];
+static uint32_t last_inpt_len = 0u;
 
+static bool update_prompt(const dsp_com_ctrl_t * const p_com);
 static void output_prompt(const dsp_com_ctrl_t * const p_com);
+static uint32_t make_prompt(const dsp_com_ctrl_t * const p_com, char_t * const p_buf);
 static void output_playinfo(const dsp_com_ctrl_t * const p_com);
 static void output_help_info(void);
+static void output_meter(const dsp_com_ctrl_t * const p_com);
 static void clear_current_line(void);
 static void output_cr(void);
 static void output_string(const char_t * const p_str);
+static uint32_t find_diff_column(const char_t * const p_new, const char_t * const p_old);
 
 void dsp_init_term(void)
 {
-    pc_out.baud(DSP_PC_COM_BAUDRATE);
+    dsp_uart_init();
+    last_prompt[0] = '\0';
+    last_meter[0] = '\0';
     output_string(CLEAR_ALL);       /* Clears all screen. */
 }
 
@@ -79,9 +109,17 @@ void dsp_output_term(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_c
                                             const dsp_trm_ctrl_t * const p_trm)
 {
     bool            is_update;
+    bool            is_redraw;
     const char_t    *p_str;
     
     if ((p_com != NULL) && (p_trm != NULL)) {
+        /* When the transmit buffer overflowed, some strings were not displayed. */
+        /* The command prompt and the level meter are redrawn entirely. */
+        is_redraw = dsp_uart_check_overflow();
+        if (is_redraw == true) {
+            last_prompt[0] = '\0';
+            last_meter[0] = '\0';
+        }
         switch(mail_id) {
             case DSP_MAILID_CMD_STR:    /* Input character string by the command-line */
                 /* Input character string is displayed after Command Prompt. */
@@ -95,7 +133,8 @@ void dsp_output_term(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_c
                 break;
             case DSP_MAILID_PLAY_TIME:  /* Playback time */
                 /* Playback time is displayed in Command Prompt. */
-                is_update = true;
+                /* Only the changed columns are sent if it is possible. */
+                is_update = update_prompt(p_com);
                 break;
             case DSP_MAILID_PLAY_INFO:  /* Music information */
                 is_update = true;
@@ -126,7 +165,27 @@ void dsp_output_term(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_c
                 clear_current_line();
                 output_help_info();
                 break;
+            case DSP_MAILID_METER_MODE:  /* Level meter mode */
+                is_update = true;
+                last_meter[0] = '\0';
+                if (p_com->meter_mode == true) {
+                    /* The top line is kept for the level meter. */
+                    output_string(CLEAR_ALL);
+                    output_string(SET_SCROLL_REGION);
+                    output_string(MOVE_CURSOR_TO_SECOND);
+                    output_meter(p_com);
+                } else {
+                    output_string(RESET_SCROLL_REGION);
+                    output_string(CLEAR_ALL);
+                }
+                break;
             case DSP_MAILID_CYCLE_IND:  /* Cyclic notice */
+                /* The level meter is updated without the command prompt. */
+                is_update = is_redraw;
+                if (p_com->meter_mode == true) {
+                    output_meter(p_com);
+                }
+                break;
             default:                    /* Unexpected cases : mail id was illegal. */
                 is_update = false;
                 break;
@@ -138,17 +197,56 @@ void dsp_output_term(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_c
             
             /* Outputs a input character string. */
             output_string(&p_trm->inpt_str[0]);
+            last_inpt_len = strlen(&p_trm->inpt_str[0]);
             
             if (p_trm->edge_fin_inpt == true) {
                 /* Because command input was finished, I move a cursor. */
                 /* And outputs the command prompt for next input. */
                 output_cr();
                 output_prompt(p_com);
+                last_inpt_len = 0u;
             }
         }
     }
 }
 
+/** Prints only the changed columns of the command prompt
+ *
+ *  The input character string after the command prompt is kept.
+ *
+ *  @param p_com Pointer to common data in all module.
+ *
+ *  @returns 
+ *    true if the command prompt and the input character string have to be redrawn.
+ */
+static bool update_prompt(const dsp_com_ctrl_t * const p_com)
+{
+    bool            ret = true;
+    char_t          str_buf[DSP_DISP_STR_MAX_LEN];
+    char_t          seq_buf[DSP_DISP_STR_MAX_LEN];
+    uint32_t        len;
+    uint32_t        col;
+
+    if (p_com != NULL) {
+        len = make_prompt(p_com, str_buf);
+        if ((last_prompt[0] != '\0') && (len == strlen(last_prompt))) {
+            /* The input character string does not move. */
+            ret = false;
+            col = find_diff_column(str_buf, last_prompt);
+            if (col < len) {
+                (void) sprintf(seq_buf, MOVE_CURSOR_TO_COLUMN, (unsigned long)(col + 1u));
+                output_string(seq_buf);
+                output_string(&str_buf[col]);
+                (void) sprintf(seq_buf, MOVE_CURSOR_TO_COLUMN, 
+                                        (unsigned long)(len + last_inpt_len + 1u));
+                output_string(seq_buf);
+                (void) strcpy(last_prompt, str_buf);
+            }
+        }
+    }
+    return ret;
+}
+
 /** Prints the command prompt
  *
  *  @param p_com Pointer to common data in all module.
@@ -156,20 +254,41 @@ void dsp_output_term(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_c
 static void output_prompt(const dsp_com_ctrl_t * const p_com)
 {
     char_t          str_buf[DSP_DISP_STR_MAX_LEN];
+
+    if (p_com != NULL) {
+        (void) make_prompt(p_com, str_buf);
+        output_string(MOVE_CURSOR_TO_LEFT);
+        output_string(str_buf);
+        output_string(CLEAR_CURSOR_RIGHT);
+        (void) strcpy(last_prompt, str_buf);
+    }
+}
+
+/** Makes the character string of the command prompt
+ *
+ *  @param p_com Pointer to common data in all module.
+ *  @param p_buf Pointer to the buffer of DSP_DISP_STR_MAX_LEN bytes.
+ *
+ *  @returns 
+ *    Length of the character string.
+ */
+static uint32_t make_prompt(const dsp_com_ctrl_t * const p_com, char_t * const p_buf)
+{
+    uint32_t        len = 0u;
     uint32_t        tim;
     uint32_t        hour;
     uint32_t        min;
     uint32_t        sec;
 
-    if (p_com != NULL) {
+    if ((p_com != NULL) && (p_buf != NULL)) {
         tim  = p_com->play_time;
         hour = tim / HOUR_TO_SEC;
         tim  = tim % HOUR_TO_SEC;
         min  = tim / MIN_TO_SEC;
         sec  = tim % MIN_TO_SEC;
-        (void) sprintf(str_buf, MSG_PROMPT, p_com->track_id, hour, min, sec);
-        output_string(str_buf);
+        len = (uint32_t)sprintf(p_buf, MSG_PROMPT, p_com->track_id, hour, min, sec);
     }
+    return len;
 }
 
 /** Prints the file information of the current playback music.
@@ -212,13 +331,19 @@ static void output_help_info(void)
     struct {
         const char_t    *p_help_info;
     } static const info_list[HELP_CMD_NUM] = {
+        {   HELP_INFO_EQ          },
         {   HELP_INFO_HELP        },
+        {   HELP_INFO_METER       },
+        {   HELP_INFO_MUTE        },
         {   HELP_INFO_NEXT        },
         {   HELP_INFO_PLAYINFO    },
         {   HELP_INFO_PLAYPAUSE   },
         {   HELP_INFO_PREV        },
         {   HELP_INFO_REPEAT      },
-        {   HELP_INFO_STOP        }
+        {   HELP_INFO_STOP        },
+        {   HELP_INFO_VOLDOWN     },
+        {   HELP_INFO_VOLUP       },
+        {   HELP_INFO_XFADE       }
     };
 
     /* Prints the help information in alphabetical order. */
@@ -228,6 +353,61 @@ static void output_help_info(void)
     }
 }
 
+/** Prints the level meter on the top line
+ *
+ *  The cursor position of the command prompt is kept.
+ *  Only the columns from the first changed column to the last one are sent.
+ *
+ *  @param p_com Pointer to common data in all module.
+ */
+static void output_meter(const dsp_com_ctrl_t * const p_com)
+{
+    char_t          str_buf[DSP_DISP_STR_MAX_LEN];
+    char_t          seq_buf[DSP_DISP_STR_MAX_LEN];
+    uint32_t        len;
+    uint32_t        i;
+    uint32_t        glyph;
+    uint32_t        col;
+
+    if (p_com != NULL) {
+        len = (uint32_t)sprintf(str_buf, MSG_METER_PREFIX, 
+                        p_com->peak_level[0], p_com->peak_level[1], 
+                        p_com->rms_level[0], p_com->rms_level[1]);
+        for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+            glyph = (uint32_t)(((p_com->band_level[i] - DSP_METER_LEVEL_MIN) * 
+                                (int32_t)(METER_GLYPH_NUM - 1u)) / METER_LEVEL_RANGE);
+            str_buf[len] = METER_GLYPH[glyph];
+            len++;
+        }
+        str_buf[len] = '\0';
+        if ((last_meter[0] != '\0') && (len == strlen(last_meter))) {
+            col = find_diff_column(str_buf, last_meter);
+            if (col < len) {
+                /* Cuts the columns after the last changed column. */
+                i = len;
+                while (str_buf[i - 1u] == last_meter[i - 1u]) {
+                    i--;
+                }
+                (void) strcpy(last_meter, str_buf);
+                str_buf[i] = '\0';
+                (void) sprintf(seq_buf, MOVE_CURSOR_TO_TOP_COL, (unsigned long)(col + 1u));
+                output_string(SAVE_CURSOR);
+                output_string(seq_buf);
+                output_string(&str_buf[col]);
+                output_string(RESTORE_CURSOR);
+            }
+        } else {
+            (void) strcpy(last_meter, str_buf);
+            output_string(SAVE_CURSOR);
+            output_string(MOVE_CURSOR_TO_TOP);
+            output_string(str_buf);
+            output_string(MSG_METER_SUFFIX);
+            output_string(CLEAR_CURSOR_RIGHT);
+            output_string(RESTORE_CURSOR);
+        }
+    }
+}
+
 /** Clears a cursor line
  *
  */
@@ -252,6 +432,28 @@ static void output_cr(void)
 static void output_string(const char_t * const p_str)
 {
     if (p_str != NULL) {
-        (void) pc_out.puts(p_str);
+        /* The string is discarded when the transmit buffer is full. */
+        /* The overflow is checked in the next call of dsp_output_term(). */
+        (void) dsp_uart_write(p_str);
+    }
+}
+
+/** Finds the first column where two character strings of the same length differ
+ *
+ *  @param p_new Pointer to the new character string.
+ *  @param p_old Pointer to the old character string.
+ *
+ *  @returns 
+ *    Index of the first changed column. The length of p_new if no column is changed.
+ */
+static uint32_t find_diff_column(const char_t * const p_new, const char_t * const p_old)
+{
+    uint32_t        col = 0u;
+
+    if ((p_new != NULL) && (p_old != NULL)) {
+        while ((p_new[col] != '\0') && (p_new[col] == p_old[col])) {
+            col++;
+        }
     }
+    return col;
 }
@@ -0,0 +1,759 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "mbed.h"
+#include "misratypes.h"
+#include "display.h"
+#include "disp_tft.h"
+
+/* Without the TFT module, neither the code nor the frame buffer is linked. */
+#if (DSP_TFT_ENABLE == 1)
+
+/*--- Macro definition ---*/
+/* The screen is divided into the tiles. Only the marked tiles are redrawn. */
+#define TILE_SIZE           (16u)
+#define TILE_COL_NUM        (DSP_TFT_WIDTH / TILE_SIZE)
+#define TILE_ROW_NUM        (DSP_TFT_HEIGHT / TILE_SIZE)
+#define TILE_ROW_ALL        ((1uL << TILE_COL_NUM) - 1uL)
+#if ((TILE_COL_NUM > 31u) || ((DSP_TFT_WIDTH % TILE_SIZE) != 0u) || ((DSP_TFT_HEIGHT % TILE_SIZE) != 0u))
+#error "The screen must be divided into TILE_SIZE and a tile row must fit in uint32_t."
+#endif
+#define SLICE_CYCLE_US      (DSP_TFT_SLICE_CYCLE_MS * 1000u)
+
+/* Font of 5 x 8 dots. Each glyph is scaled by 2 in the glyph atlas. */
+#define FONT_CHR_MIN        (0x20)      /* ' ' */
+#define FONT_CHR_MAX        (0x7E)      /* '~' */
+#define FONT_CHR_NUM        ((FONT_CHR_MAX - FONT_CHR_MIN) + 1)
+#define FONT_CHR_INVALID    ('?')
+#define FONT_COL_NUM        (5u)
+#define FONT_SCALE          (2u)
+#define GLYPH_W             (12u)       /* Width of a character cell */
+#define GLYPH_H             (16u)       /* Height of a character cell */
+#define GLYPH_LEFT          (1u)        /* Left space of a glyph in a cell */
+#define MASK_ON             (0xFFFFu)
+#define MASK_OFF            (0x0000u)
+
+#define RGB565(r, g, b)     ((uint16_t)((((uint32_t)(r) & 0xF8u) << 8) | \
+                                        (((uint32_t)(g) & 0xFCu) << 3) | ((uint32_t)(b) >> 3)))
+#define COLOR_BG            RGB565(0x10u, 0x14u, 0x1Cu)
+#define COLOR_HEADER_BG     RGB565(0x28u, 0x30u, 0x40u)
+#define COLOR_TEXT          RGB565(0xF0u, 0xF0u, 0xF0u)
+#define COLOR_TEXT_DIM      RGB565(0x90u, 0x98u, 0xA8u)
+#define COLOR_SELECT_BG     RGB565(0x20u, 0x50u, 0x90u)
+#define COLOR_BAR           RGB565(0x40u, 0xA0u, 0xF0u)
+#define COLOR_BAR_BG        RGB565(0x38u, 0x40u, 0x50u)
+#define COLOR_SPEC_LOW      RGB565(0x30u, 0xD0u, 0x60u)
+#define COLOR_SPEC_MID      RGB565(0xF0u, 0xD0u, 0x30u)
+#define COLOR_SPEC_HIGH     RGB565(0xF0u, 0x40u, 0x30u)
+
+/* Layout */
+#define MARGIN_X            (6u)
+#define TEXT_MAX_CHR        (DSP_TFT_WIDTH / GLYPH_W)
+#define HEADER_H            (24u)
+#define HEADER_TEXT_Y       (4u)
+#define TITLE_Y             (30u)
+#define BAR_X               (MARGIN_X)
+#define BAR_Y               (54u)
+#define BAR_W               (DSP_TFT_WIDTH - (MARGIN_X * 2u))
+#define BAR_H               (8u)
+#define TIME_Y              (66u)
+#define LIST_Y              (94u)
+#define LIST_ROW_H          (18u)
+#define LIST_SELECT_ROW     (DSP_LIST_ROW_NUM / 2u)
+#define SPEC_Y              (192u)
+#define SPEC_H              (DSP_TFT_HEIGHT - SPEC_Y)
+#define SPEC_BAND_W         (DSP_TFT_WIDTH / DSP_METER_BAND_NUM)
+#define SPEC_BAR_W          (SPEC_BAND_W - 4u)
+#define SPEC_BAR_X          (2u)
+#define SPEC_LEVEL_RANGE    (DSP_METER_LEVEL_MAX - DSP_METER_LEVEL_MIN)
+
+#define STR_STOP            "STOP"
+#define STR_PLAY            "PLAY"
+#define STR_PAUSE           "PAUSE"
+#define STR_REPEAT          "REPEAT"
+#define STR_TRACK           "No.%03lu"
+#define STR_INFO            "%luHz %s"
+#define STR_MONO            "Mono"
+#define STR_STEREO          "Stereo"
+#define STR_TIME            "%lu:%02lu:%02lu / %lu:%02lu:%02lu"
+#define STR_LIST_ROW        " %03lu %s"
+#define STR_EMPTY           ""
+
+#define HOUR_TO_SEC         (3600u)
+#define MIN_TO_SEC          (60u)
+
+/*--- User defined types ---*/
+/* Rectangle. x1 and y1 are not included. */
+typedef struct {
+    uint32_t    x0;
+    uint32_t    y0;
+    uint32_t    x1;
+    uint32_t    y1;
+} rect_t;
+
+/* Text item on the screen. The string is padded by spaces to chr_num. */
+typedef struct {
+    uint32_t    x;
+    uint32_t    y;
+    uint32_t    chr_num;
+    uint16_t    fg;
+    uint16_t    bg;
+    char_t      str[TEXT_MAX_CHR + 1u];
+} text_item_t;
+
+typedef enum {
+    TEXT_STATUS = 0,
+    TEXT_TRACK,
+    TEXT_INFO,
+    TEXT_REPEAT,
+    TEXT_TITLE,
+    TEXT_TIME,
+    TEXT_LIST,                  /* DSP_LIST_ROW_NUM items from here */
+    TEXT_NUM = TEXT_LIST + DSP_LIST_ROW_NUM
+} TEXT_ID;
+
+/* Font of the characters from FONT_CHR_MIN to FONT_CHR_MAX. */
+/* A byte is a column. The bit 0 is the top row. */
+static const uint8_t font_5x8[FONT_CHR_NUM][FONT_COL_NUM] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, /*   ! " */
+    {0x14,0x7F,0x14,0x7F,0x14}, {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, /* # $ % */
+    {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00}, {0x00,0x1C,0x22,0x41,0x00}, /* & ' ( */
+    {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08}, /* ) * + */
+    {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, /* , - . */
+    {0x20,0x10,0x08,0x04,0x02}, {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, /* / 0 1 */
+    {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33}, {0x18,0x14,0x12,0x7F,0x10}, /* 2 3 4 */
+    {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07}, /* 5 6 7 */
+    {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, /* 8 9 : */
+    {0x00,0x40,0x34,0x00,0x00}, {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, /* ; < = */
+    {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06}, {0x3E,0x41,0x5D,0x59,0x4E}, /* > ? @ */
+    {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, /* A B C */
+    {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, /* D E F */
+    {0x3E,0x41,0x41,0x51,0x73}, {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, /* G H I */
+    {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, {0x7F,0x40,0x40,0x40,0x40}, /* J K L */
+    {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, /* M N O */
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, /* P Q R */
+    {0x26,0x49,0x49,0x49,0x32}, {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, /* S T U */
+    {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F}, {0x63,0x14,0x08,0x14,0x63}, /* V W X */
+    {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41}, /* Y Z [ */
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, /* \ ] ^ */
+    {0x40,0x40,0x40,0x40,0x40}, {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, /* _ ` a */
+    {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28}, {0x38,0x44,0x44,0x28,0x7F}, /* b c d */
+    {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78}, /* e f g */
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, /* h i j */
+    {0x7F,0x10,0x28,0x44,0x00}, {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, /* k l m */
+    {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38}, {0xFC,0x18,0x24,0x24,0x18}, /* n o p */
+    {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24}, /* q r s */
+    {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, /* t u v */
+    {0x3C,0x40,0x30,0x40,0x3C}, {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, /* w x y */
+    {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00}, {0x00,0x00,0x77,0x00,0x00}, /* z { | */
+    {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02}                              /* } ~   */
+};
+
+/* 32 bytes aligned for the graphics layer of VDC5. No cache memory. */
+#if defined(__ICCARM__)
+#pragma data_alignment=32
+static uint16_t frame_buf[DSP_TFT_HEIGHT][DSP_TFT_WIDTH] @ ".mirrorram";
+#else
+static uint16_t frame_buf[DSP_TFT_HEIGHT][DSP_TFT_WIDTH] __attribute__((section("NC_BSS"),aligned(32)));
+#endif
+/* A tile row is drawn here, and each line of it is copied to the frame buffer. */
+static uint16_t strip_buf[TILE_SIZE][DSP_TFT_WIDTH];
+/* Glyphs pre-rasterized to the masks of a pixel. */
+static uint16_t glyph_atlas[FONT_CHR_NUM][GLYPH_H][GLYPH_W];
+static uint16_t spec_color[SPEC_H];
+static uint32_t dirty_tile[TILE_ROW_NUM];   /* Bit n is the tile of the column n. */
+static text_item_t text_list[TEXT_NUM];
+static uint32_t bar_fill;                   /* Width of the progress bar in pixels */
+static uint32_t band_height[DSP_METER_BAND_NUM];
+static uint32_t slice_start_us;
+static uint32_t slice_used_us;
+
+static void init_glyph_atlas(void);
+static void init_text_item(const TEXT_ID id, const uint32_t x, const uint32_t y,
+                const uint32_t chr_num, const uint16_t fg, const uint16_t bg);
+static void update_status(const dsp_com_ctrl_t * const p_com);
+static void update_play_info(const dsp_com_ctrl_t * const p_com);
+static void update_list(const dsp_tft_ctrl_t * const p_tft);
+static void update_spectrum(const dsp_com_ctrl_t * const p_com);
+static void set_text(const TEXT_ID id, const char_t * const p_str);
+static void set_bar_fill(const uint32_t fill);
+static void set_band_height(const uint32_t band, const uint32_t height);
+static void mark_dirty(const uint32_t x0, const uint32_t y0, const uint32_t x1, const uint32_t y1);
+static void draw_span(const uint32_t tile_row, const uint32_t col0, const uint32_t col1);
+static void fill_rect(const rect_t * const p_clip, const uint32_t x0, const uint32_t y0,
+                const uint32_t x1, const uint32_t y1, const uint16_t color);
+static void draw_text(const rect_t * const p_clip, const text_item_t * const p_item);
+static void draw_spectrum(const rect_t * const p_clip);
+static bool clip_rect(const rect_t * const p_clip, const uint32_t x0, const uint32_t y0,
+                const uint32_t x1, const uint32_t y1, rect_t * const p_out);
+
+void dsp_init_tft(dsp_tft_ctrl_t * const p_tft)
+{
+    uint32_t        i;
+
+    if (p_tft != NULL) {
+        for (i = 0u; i < DSP_LIST_ROW_NUM; i++) {
+            p_tft->list_no[i] = 0u;
+            p_tft->list_name[i][0] = '\0';
+        }
+    }
+    init_glyph_atlas();
+    for (i = 0u; i < SPEC_H; i++) {
+        /* The colour of the spectrum changes by the height. */
+        if (i < (SPEC_H / 8u)) {
+            spec_color[i] = COLOR_SPEC_HIGH;
+        } else if (i < (SPEC_H / 3u)) {
+            spec_color[i] = COLOR_SPEC_MID;
+        } else {
+            spec_color[i] = COLOR_SPEC_LOW;
+        }
+    }
+    init_text_item(TEXT_STATUS, MARGIN_X, HEADER_TEXT_Y, 5u, COLOR_TEXT, COLOR_HEADER_BG);
+    init_text_item(TEXT_TRACK, MARGIN_X + (6u * GLYPH_W), HEADER_TEXT_Y, 6u,
+                                                    COLOR_TEXT, COLOR_HEADER_BG);
+    init_text_item(TEXT_INFO, MARGIN_X + (13u * GLYPH_W), HEADER_TEXT_Y, 15u,
+                                                    COLOR_TEXT_DIM, COLOR_HEADER_BG);
+    init_text_item(TEXT_REPEAT, DSP_TFT_WIDTH - MARGIN_X - (6u * GLYPH_W), HEADER_TEXT_Y, 6u,
+                                                    COLOR_TEXT, COLOR_HEADER_BG);
+    init_text_item(TEXT_TITLE, MARGIN_X, TITLE_Y, TEXT_MAX_CHR - 1u, COLOR_TEXT, COLOR_BG);
+    init_text_item(TEXT_TIME, MARGIN_X, TIME_Y, TEXT_MAX_CHR - 1u, COLOR_TEXT_DIM, COLOR_BG);
+    for (i = 0u; i < DSP_LIST_ROW_NUM; i++) {
+        if (i == LIST_SELECT_ROW) {
+            init_text_item((TEXT_ID)(TEXT_LIST + i), 0u, LIST_Y + (i * LIST_ROW_H),
+                                        TEXT_MAX_CHR, COLOR_TEXT, COLOR_SELECT_BG);
+        } else {
+            init_text_item((TEXT_ID)(TEXT_LIST + i), 0u, LIST_Y + (i * LIST_ROW_H),
+                                        TEXT_MAX_CHR, COLOR_TEXT_DIM, COLOR_BG);
+        }
+    }
+    set_text(TEXT_STATUS, STR_STOP);
+    bar_fill = 0u;
+    for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+        band_height[i] = 0u;
+    }
+    /* The whole screen is drawn at first. */
+    for (i = 0u; i < TILE_ROW_NUM; i++) {
+        dirty_tile[i] = TILE_ROW_ALL;
+    }
+    slice_start_us = us_ticker_read();
+    slice_used_us = 0u;
+}
+
+void dsp_output_tft(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_com,
+                                            const dsp_tft_ctrl_t * const p_tft)
+{
+    if ((p_com != NULL) && (p_tft != NULL)) {
+        switch (mail_id) {
+            case DSP_MAILID_PLAY_TIME:  /* Playback time */
+                update_status(p_com);
+                break;
+            case DSP_MAILID_PLAY_INFO:  /* Music information */
+                update_play_info(p_com);
+                break;
+            case DSP_MAILID_PLAY_MODE:  /* Repeat mode */
+                if (p_com->repeat_mode == true) {
+                    set_text(TEXT_REPEAT, STR_REPEAT);
+                } else {
+                    set_text(TEXT_REPEAT, STR_EMPTY);
+                }
+                break;
+            case DSP_MAILID_FILE_NAME:  /* File name */
+                set_text(TEXT_TITLE, &p_com->file_name[0]);
+                break;
+            case DSP_MAILID_LIST_NAME:  /* Track list */
+                update_list(p_tft);
+                break;
+            case DSP_MAILID_CYCLE_IND:  /* Cyclic notice */
+                update_spectrum(p_com);
+                break;
+            default:
+                /* The other information is not shown on the TFT. */
+                break;
+        }
+    }
+}
+
+bool dsp_exe_tft(void)
+{
+    bool            ret = false;
+    uint32_t        row;
+    uint32_t        col0;
+    uint32_t        col1;
+    uint32_t        start_us;
+    uint32_t        now_us;
+
+    now_us = us_ticker_read();
+    if ((now_us - slice_start_us) >= SLICE_CYCLE_US) {
+        slice_start_us = now_us;
+        slice_used_us = 0u;
+    }
+    for (row = 0u; (row < TILE_ROW_NUM) && (slice_used_us < DSP_TFT_SLICE_US); row++) {
+        while ((dirty_tile[row] != 0u) && (slice_used_us < DSP_TFT_SLICE_US)) {
+            start_us = us_ticker_read();
+            /* Finds the run of the marked tiles, and draws it at once. */
+            col0 = 0u;
+            while ((dirty_tile[row] & (1uL << col0)) == 0u) {
+                col0++;
+            }
+            col1 = col0;
+            while ((col1 < TILE_COL_NUM) && ((dirty_tile[row] & (1uL << col1)) != 0u)) {
+                dirty_tile[row] &= ~(1uL << col1);
+                col1++;
+            }
+            draw_span(row, col0, col1);
+            slice_used_us += us_ticker_read() - start_us;
+        }
+    }
+    for (row = 0u; row < TILE_ROW_NUM; row++) {
+        if (dirty_tile[row] != 0u) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+const uint16_t *dsp_get_tft_frame(void)
+{
+    return &frame_buf[0][0];
+}
+
+/** Makes the glyph atlas from the font
+ *
+ *  Each dot of the font is scaled by FONT_SCALE, and a pixel has the mask of
+ *  MASK_ON or MASK_OFF. So a glyph is drawn without the bit operation.
+ */
+static void init_glyph_atlas(void)
+{
+    uint32_t        chr;
+    uint32_t        x;
+    uint32_t        y;
+    uint32_t        col;
+    uint16_t        mask;
+
+    for (chr = 0u; chr < (uint32_t)FONT_CHR_NUM; chr++) {
+        for (y = 0u; y < GLYPH_H; y++) {
+            for (x = 0u; x < GLYPH_W; x++) {
+                mask = MASK_OFF;
+                if ((x >= GLYPH_LEFT) && (x < (GLYPH_LEFT + (FONT_COL_NUM * FONT_SCALE)))) {
+                    col = (x - GLYPH_LEFT) / FONT_SCALE;
+                    if (((font_5x8[chr][col] >> (y / FONT_SCALE)) & 1u) != 0u) {
+                        mask = MASK_ON;
+                    }
+                }
+                glyph_atlas[chr][y][x] = mask;
+            }
+        }
+    }
+}
+
+/** Initialises the text item
+ *
+ *  @param id ID of the text item.
+ *  @param x X coordinate of the text item.
+ *  @param y Y coordinate of the text item.
+ *  @param chr_num Number of the characters of the text item.
+ *  @param fg Colour of the characters.
+ *  @param bg Colour of the background.
+ */
+static void init_text_item(const TEXT_ID id, const uint32_t x, const uint32_t y,
+                const uint32_t chr_num, const uint16_t fg, const uint16_t bg)
+{
+    text_item_t     *p_item;
+
+    if (id < TEXT_NUM) {
+        p_item = &text_list[id];
+        p_item->x = x;
+        p_item->y = y;
+        p_item->chr_num = chr_num;
+        if (p_item->chr_num > TEXT_MAX_CHR) {
+            p_item->chr_num = TEXT_MAX_CHR;
+        }
+        p_item->fg = fg;
+        p_item->bg = bg;
+        (void) memset(&p_item->str[0], (int32_t)' ', p_item->chr_num);
+        p_item->str[p_item->chr_num] = '\0';
+    }
+}
+
+/** Updates the playback status, the playback time and the progress bar
+ *
+ *  @param p_com Pointer to common data in all display module.
+ */
+static void update_status(const dsp_com_ctrl_t * const p_com)
+{
+    char_t          str_buf[DSP_DISP_STR_MAX_LEN];
+    uint32_t        play;
+    uint32_t        total;
+    uint32_t        fill;
+
+    if (p_com != NULL) {
+        if (p_com->play_stat == SYS_PLAYSTAT_PLAY) {
+            set_text(TEXT_STATUS, STR_PLAY);
+        } else if (p_com->play_stat == SYS_PLAYSTAT_PAUSE) {
+            set_text(TEXT_STATUS, STR_PAUSE);
+        } else {
+            set_text(TEXT_STATUS, STR_STOP);
+        }
+        (void) sprintf(str_buf, STR_TRACK, (unsigned long)p_com->track_id);
+        set_text(TEXT_TRACK, str_buf);
+        play = p_com->play_time;
+        total = p_com->total_time;
+        (void) sprintf(str_buf, STR_TIME, (unsigned long)(play / HOUR_TO_SEC),
+                    (unsigned long)((play % HOUR_TO_SEC) / MIN_TO_SEC), (unsigned long)(play % MIN_TO_SEC),
+                    (unsigned long)(total / HOUR_TO_SEC),
+                    (unsigned long)((total % HOUR_TO_SEC) / MIN_TO_SEC), (unsigned long)(total % MIN_TO_SEC));
+        set_text(TEXT_TIME, str_buf);
+        fill = 0u;
+        if (total > 0u) {
+            if (play < total) {
+                fill = (uint32_t)(((uint64_t)play * BAR_W) / total);
+            } else {
+                fill = BAR_W;
+            }
+        }
+        set_bar_fill(fill);
+    }
+}
+
+/** Updates the sampling frequency and the channel number
+ *
+ *  @param p_com Pointer to common data in all display module.
+ */
+static void update_play_info(const dsp_com_ctrl_t * const p_com)
+{
+    char_t          str_buf[DSP_DISP_STR_MAX_LEN];
+    const char_t    *p_str;
+
+    if (p_com != NULL) {
+        (void) sprintf(str_buf, STR_TRACK, (unsigned long)p_com->track_id);
+        set_text(TEXT_TRACK, str_buf);
+        if (p_com->channel == 1u) {
+            p_str = STR_MONO;
+        } else {
+            p_str = STR_STEREO;
+        }
+        (void) sprintf(str_buf, STR_INFO, (unsigned long)p_com->samp_freq, p_str);
+        set_text(TEXT_INFO, str_buf);
+    }
+}
+
+/** Updates the track list
+ *
+ *  @param p_tft Pointer to control data of TFT module.
+ */
+static void update_list(const dsp_tft_ctrl_t * const p_tft)
+{
+    char_t          str_buf[DSP_DISP_STR_MAX_LEN + 8];
+    uint32_t        i;
+
+    if (p_tft != NULL) {
+        for (i = 0u; i < DSP_LIST_ROW_NUM; i++) {
+            if (p_tft->list_no[i] != 0u) {
+                (void) sprintf(str_buf, STR_LIST_ROW, (unsigned long)p_tft->list_no[i], &p_tft->list_name[i][0]);
+                set_text((TEXT_ID)(TEXT_LIST + i), str_buf);
+            } else {
+                set_text((TEXT_ID)(TEXT_LIST + i), STR_EMPTY);
+            }
+        }
+    }
+}
+
+/** Updates the bars of the spectrum
+ *
+ *  @param p_com Pointer to common data in all display module.
+ */
+static void update_spectrum(const dsp_com_ctrl_t * const p_com)
+{
+    uint32_t        i;
+    int32_t         level;
+
+    if (p_com != NULL) {
+        for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+            level = p_com->band_level[i] - DSP_METER_LEVEL_MIN;
+            if (level < 0) {
+                level = 0;
+            } else if (level > SPEC_LEVEL_RANGE) {
+                level = SPEC_LEVEL_RANGE;
+            } else {
+                /* DO NOTHING */
+            }
+            set_band_height(i, ((uint32_t)level * SPEC_H) / (uint32_t)SPEC_LEVEL_RANGE);
+        }
+    }
+}
+
+/** Sets the string of the text item
+ *
+ *  Only the changed characters are marked to be redrawn.
+ *
+ *  @param id ID of the text item.
+ *  @param p_str Pointer to the string. It is cut at the size of the text item.
+ */
+static void set_text(const TEXT_ID id, const char_t * const p_str)
+{
+    text_item_t     *p_item;
+    uint32_t        i;
+    char_t          c;
+    bool            is_end = false;
+
+    if ((id < TEXT_NUM) && (p_str != NULL)) {
+        p_item = &text_list[id];
+        for (i = 0u; i < p_item->chr_num; i++) {
+            if ((is_end == true) || (p_str[i] == '\0')) {
+                is_end = true;
+                c = ' ';
+            } else if (((int32_t)p_str[i] < FONT_CHR_MIN) || ((int32_t)p_str[i] > FONT_CHR_MAX)) {
+                c = FONT_CHR_INVALID;
+            } else {
+                c = p_str[i];
+            }
+            if (c != p_item->str[i]) {
+                p_item->str[i] = c;
+                mark_dirty(p_item->x + (i * GLYPH_W), p_item->y,
+                           p_item->x + ((i + 1u) * GLYPH_W), p_item->y + GLYPH_H);
+            }
+        }
+    }
+}
+
+/** Sets the width of the progress bar
+ *
+ *  Only the changed part is marked to be redrawn.
+ *
+ *  @param fill Width of the progress bar in pixels. 0 to BAR_W.
+ */
+static void set_bar_fill(const uint32_t fill)
+{
+    if (fill != bar_fill) {
+        if (fill > bar_fill) {
+            mark_dirty(BAR_X + bar_fill, BAR_Y, BAR_X + fill, BAR_Y + BAR_H);
+        } else {
+            mark_dirty(BAR_X + fill, BAR_Y, BAR_X + bar_fill, BAR_Y + BAR_H);
+        }
+        bar_fill = fill;
+    }
+}
+
+/** Sets the height of the bar of the spectrum
+ *
+ *  Only the changed part is marked to be redrawn.
+ *
+ *  @param band Band number.
+ *  @param height Height of the bar in pixels. 0 to SPEC_H.
+ */
+static void set_band_height(const uint32_t band, const uint32_t height)
+{
+    uint32_t        x;
+
+    if ((band < DSP_METER_BAND_NUM) && (height != band_height[band])) {
+        x = (band * SPEC_BAND_W) + SPEC_BAR_X;
+        if (height > band_height[band]) {
+            mark_dirty(x, DSP_TFT_HEIGHT - height, x + SPEC_BAR_W, DSP_TFT_HEIGHT - band_height[band]);
+        } else {
+            mark_dirty(x, DSP_TFT_HEIGHT - band_height[band], x + SPEC_BAR_W, DSP_TFT_HEIGHT - height);
+        }
+        band_height[band] = height;
+    }
+}
+
+/** Marks the tiles of the rectangle to be redrawn
+ *
+ *  @param x0 Left of the rectangle.
+ *  @param y0 Top of the rectangle.
+ *  @param x1 Right of the rectangle. (Not included)
+ *  @param y1 Bottom of the rectangle. (Not included)
+ */
+static void mark_dirty(const uint32_t x0, const uint32_t y0, const uint32_t x1, const uint32_t y1)
+{
+    uint32_t        row;
+    uint32_t        col;
+    uint32_t        bits = 0u;
+
+    if ((x0 < x1) && (y0 < y1) && (x1 <= DSP_TFT_WIDTH) && (y1 <= DSP_TFT_HEIGHT)) {
+        for (col = x0 / TILE_SIZE; col <= ((x1 - 1u) / TILE_SIZE); col++) {
+            bits |= (1uL << col);
+        }
+        for (row = y0 / TILE_SIZE; row <= ((y1 - 1u) / TILE_SIZE); row++) {
+            dirty_tile[row] |= bits;
+        }
+    }
+}
+
+/** Draws the run of the tiles, and copies it to the frame buffer
+ *
+ *  The lines of the run are copied one by one. Each of them is a contiguous
+ *  area in both buffers, so DMA can take over the copy.
+ *
+ *  @param tile_row Row of the tiles.
+ *  @param col0 First column of the tiles.
+ *  @param col1 Last column of the tiles. (Not included)
+ */
+static void draw_span(const uint32_t tile_row, const uint32_t col0, const uint32_t col1)
+{
+    rect_t          clip;
+    uint32_t        i;
+    uint32_t        y;
+
+    if ((tile_row < TILE_ROW_NUM) && (col0 < col1) && (col1 <= TILE_COL_NUM)) {
+        clip.x0 = col0 * TILE_SIZE;
+        clip.x1 = col1 * TILE_SIZE;
+        clip.y0 = tile_row * TILE_SIZE;
+        clip.y1 = clip.y0 + TILE_SIZE;
+        /* Background */
+        fill_rect(&clip, 0u, 0u, DSP_TFT_WIDTH, HEADER_H, COLOR_HEADER_BG);
+        fill_rect(&clip, 0u, HEADER_H, DSP_TFT_WIDTH, DSP_TFT_HEIGHT, COLOR_BG);
+        /* Progress bar */
+        fill_rect(&clip, BAR_X, BAR_Y, BAR_X + bar_fill, BAR_Y + BAR_H, COLOR_BAR);
+        fill_rect(&clip, BAR_X + bar_fill, BAR_Y, BAR_X + BAR_W, BAR_Y + BAR_H, COLOR_BAR_BG);
+        for (i = 0u; i < (uint32_t)TEXT_NUM; i++) {
+            draw_text(&clip, &text_list[i]);
+        }
+        draw_spectrum(&clip);
+        for (y = clip.y0; y < clip.y1; y++) {
+            (void) memcpy(&frame_buf[y][clip.x0], &strip_buf[y - clip.y0][clip.x0],
+                                        (clip.x1 - clip.x0) * sizeof(strip_buf[0][0]));
+        }
+    }
+}
+
+/** Fills the rectangle in the strip buffer
+ *
+ *  @param p_clip Pointer to the clipping rectangle. It must be in the strip buffer.
+ *  @param x0 Left of the rectangle.
+ *  @param y0 Top of the rectangle.
+ *  @param x1 Right of the rectangle. (Not included)
+ *  @param y1 Bottom of the rectangle. (Not included)
+ *  @param color Colour.
+ */
+static void fill_rect(const rect_t * const p_clip, const uint32_t x0, const uint32_t y0,
+                const uint32_t x1, const uint32_t y1, const uint16_t color)
+{
+    rect_t          rect;
+    uint32_t        x;
+    uint32_t        y;
+    uint16_t        *p_dst;
+
+    if (clip_rect(p_clip, x0, y0, x1, y1, &rect) == true) {
+        for (y = rect.y0; y < rect.y1; y++) {
+            p_dst = &strip_buf[y - p_clip->y0][0];
+            for (x = rect.x0; x < rect.x1; x++) {
+                p_dst[x] = color;
+            }
+        }
+    }
+}
+
+/** Draws the text item in the strip buffer
+ *
+ *  @param p_clip Pointer to the clipping rectangle. It must be in the strip buffer.
+ *  @param p_item Pointer to the text item.
+ */
+static void draw_text(const rect_t * const p_clip, const text_item_t * const p_item)
+{
+    rect_t          rect;
+    uint32_t        i;
+    uint32_t        x;
+    uint32_t        y;
+    uint32_t        cell_x;
+    const uint16_t  *p_mask;
+    uint16_t        *p_dst;
+    uint16_t        fg;
+    uint16_t        bg;
+
+    if ((p_clip != NULL) && (p_item != NULL)) {
+        fg = p_item->fg;
+        bg = p_item->bg;
+        for (i = 0u; i < p_item->chr_num; i++) {
+            cell_x = p_item->x + (i * GLYPH_W);
+            if (clip_rect(p_clip, cell_x, p_item->y, cell_x + GLYPH_W, p_item->y + GLYPH_H, &rect) == true) {
+                for (y = rect.y0; y < rect.y1; y++) {
+                    p_mask = &glyph_atlas[(int32_t)p_item->str[i] - FONT_CHR_MIN][y - p_item->y][0];
+                    p_dst = &strip_buf[y - p_clip->y0][0];
+                    for (x = rect.x0; x < rect.x1; x++) {
+                        p_dst[x] = (uint16_t)((bg & (uint16_t)~p_mask[x - cell_x]) | (fg & p_mask[x - cell_x]));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** Draws the bars of the spectrum in the strip buffer
+ *
+ *  @param p_clip Pointer to the clipping rectangle. It must be in the strip buffer.
+ */
+static void draw_spectrum(const rect_t * const p_clip)
+{
+    rect_t          rect;
+    uint32_t        band;
+    uint32_t        x;
+    uint32_t        y;
+    uint32_t        bar_x;
+    uint16_t        *p_dst;
+
+    if (p_clip != NULL) {
+        for (band = 0u; band < DSP_METER_BAND_NUM; band++) {
+            bar_x = (band * SPEC_BAND_W) + SPEC_BAR_X;
+            if (clip_rect(p_clip, bar_x, DSP_TFT_HEIGHT - band_height[band],
+                            bar_x + SPEC_BAR_W, DSP_TFT_HEIGHT, &rect) == true) {
+                for (y = rect.y0; y < rect.y1; y++) {
+                    p_dst = &strip_buf[y - p_clip->y0][0];
+                    for (x = rect.x0; x < rect.x1; x++) {
+                        p_dst[x] = spec_color[y - SPEC_Y];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/** Clips the rectangle
+ *
+ *  @param p_clip Pointer to the clipping rectangle.
+ *  @param x0 Left of the rectangle.
+ *  @param y0 Top of the rectangle.
+ *  @param x1 Right of the rectangle. (Not included)
+ *  @param y1 Bottom of the rectangle. (Not included)
+ *  @param p_out Pointer to the clipped rectangle.
+ *
+ *  @returns
+ *    true if the clipped rectangle is not empty.
+ */
+static bool clip_rect(const rect_t * const p_clip, const uint32_t x0, const uint32_t y0,
+                const uint32_t x1, const uint32_t y1, rect_t * const p_out)
+{
+    bool            ret = false;
+
+    if ((p_clip != NULL) && (p_out != NULL)) {
+        p_out->x0 = (x0 > p_clip->x0) ? x0 : p_clip->x0;
+        p_out->y0 = (y0 > p_clip->y0) ? y0 : p_clip->y0;
+        p_out->x1 = (x1 < p_clip->x1) ? x1 : p_clip->x1;
+        p_out->y1 = (y1 < p_clip->y1) ? y1 : p_clip->y1;
+        if ((p_out->x0 < p_out->x1) && (p_out->y0 < p_out->y1)) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+#endif /* DSP_TFT_ENABLE */
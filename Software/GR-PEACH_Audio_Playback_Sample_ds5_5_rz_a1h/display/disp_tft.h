@@ -0,0 +1,79 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DISP_TFT_H
+#define DISP_TFT_H
+
+#include "display.h"
+
+/*--- Macro definition ---*/
+/* Size of the frame buffer in pixels. The pixel format is RGB565. */
+#define DSP_TFT_WIDTH           (480u)
+#define DSP_TFT_HEIGHT          (272u)
+
+/* CPU slice of the TFT module */
+/* dsp_exe_tft() stops drawing when it has used DSP_TFT_SLICE_US, and the display */
+/* thread calls it again after DSP_TFT_SLICE_CYCLE_MS. So the drawing never uses */
+/* more than DSP_TFT_SLICE_US per DSP_TFT_SLICE_CYCLE_MS (10%). */
+#define DSP_TFT_SLICE_US        (2000u)
+#define DSP_TFT_SLICE_CYCLE_MS  (20u)
+
+/** Initialises the TFT module
+ *
+ *  Makes the glyph atlas and draws the whole screen in the next dsp_exe_tft().
+ *
+ *  @param p_tft Pointer to control data of TFT module.
+ */
+void dsp_init_tft(dsp_tft_ctrl_t * const p_tft);
+
+/** Updates the screen items of the TFT module
+ *
+ *  Only the regions of the changed items are marked to be redrawn.
+ *  Nothing is drawn in this function.
+ *
+ *  @param mail_id Mail ID.
+ *  @param p_com Pointer to common data in all display module.
+ *  @param p_tft Pointer to control data of TFT module.
+ */
+void dsp_output_tft(const DSP_MAIL_ID mail_id, const dsp_com_ctrl_t * const p_com,
+                                            const dsp_tft_ctrl_t * const p_tft);
+
+/** Draws the marked regions to the frame buffer
+ *
+ *  The regions are drawn in the strip buffer tile row by tile row, and each line
+ *  of them is copied to the frame buffer. It returns when DSP_TFT_SLICE_US has
+ *  passed even if some regions are left.
+ *
+ *  @returns
+ *    true if some regions are left. false if the frame buffer is up to date.
+ */
+bool dsp_exe_tft(void);
+
+/** Gets the frame buffer
+ *
+ *  @returns
+ *    Pointer to the frame buffer. DSP_TFT_WIDTH * DSP_TFT_HEIGHT pixels of RGB565.
+ */
+const uint16_t *dsp_get_tft_frame(void);
+
+#endif /* DISP_TFT_H */
@@ -0,0 +1,189 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "mbed.h"
+#include "misratypes.h"
+#include "display.h"
+#include "disp_uart.h"
+
+/*--- Macro definition ---*/
+#define TX_BUF_MASK             (DSP_UART_TX_BUF_SIZE - 1u)
+#define RX_BUF_MASK             (DSP_UART_RX_BUF_SIZE - 1u)
+#define RX_NO_DATA              (-1)
+
+/* The transmit interrupt and the key thread share this object. */
+/* RawSerial does not use the mutex, so it can be used in the interrupt. */
+static RawSerial pc_com(USBTX, USBRX);
+
+/* Transmit ring buffer. Only the display thread writes tx_wr_cnt, */
+/* and only the transmit interrupt writes tx_rd_cnt. */
+static uint8_t tx_buf[DSP_UART_TX_BUF_SIZE];
+static volatile uint32_t tx_wr_cnt = 0u;    /* Total number of the written bytes */
+static volatile uint32_t tx_rd_cnt = 0u;    /* Total number of the transmitted bytes */
+static volatile bool tx_active = false;     /* The transmit interrupt is expected. */
+static bool tx_overflow = false;
+
+/* Receive ring buffer. Only the receive interrupt writes rx_wr_cnt, */
+/* and only the key thread writes rx_rd_cnt. */
+static uint8_t rx_buf[DSP_UART_RX_BUF_SIZE];
+static volatile uint32_t rx_wr_cnt = 0u;    /* Total number of the received bytes */
+static volatile uint32_t rx_rd_cnt = 0u;    /* Total number of the read bytes */
+static volatile DSP_UART_CbRx rx_callback = NULL;
+
+static void tx_irq_handler(void);
+static void rx_irq_handler(void);
+static void send_data(void);
+
+void dsp_uart_init(void)
+{
+    pc_com.baud(DSP_PC_COM_BAUDRATE);
+    pc_com.attach(&tx_irq_handler, SerialBase::TxIrq);
+    pc_com.attach(&rx_irq_handler, SerialBase::RxIrq);
+}
+
+void dsp_uart_set_rx_callback(const DSP_UART_CbRx p_cb)
+{
+    rx_callback = p_cb;
+}
+
+bool dsp_uart_write(const char_t * const p_str)
+{
+    bool        ret = false;
+    uint32_t    len;
+    uint32_t    wr_cnt;
+    uint32_t    i;
+
+    if (p_str != NULL) {
+        len = strlen(p_str);
+        wr_cnt = tx_wr_cnt;
+        if (len <= (DSP_UART_TX_BUF_SIZE - (wr_cnt - tx_rd_cnt))) {
+            for (i = 0u; i < len; i++) {
+                tx_buf[(wr_cnt + i) & TX_BUF_MASK] = (uint8_t)p_str[i];
+            }
+            core_util_critical_section_enter();
+            tx_wr_cnt = wr_cnt + len;
+            if (tx_active == false) {
+                /* Starts the transmission. The interrupt continues it. */
+                send_data();
+            }
+            core_util_critical_section_exit();
+            ret = true;
+        } else {
+            tx_overflow = true;
+        }
+    }
+    return ret;
+}
+
+bool dsp_uart_check_overflow(void)
+{
+    bool        ret;
+
+    ret = tx_overflow;
+    tx_overflow = false;
+    return ret;
+}
+
+bool dsp_uart_readable(void)
+{
+    bool        ret = false;
+
+    if (rx_rd_cnt != rx_wr_cnt) {
+        ret = true;
+    }
+    return ret;
+}
+
+int32_t dsp_uart_getc(void)
+{
+    int32_t     ret = RX_NO_DATA;
+    uint32_t    rd_cnt;
+
+    rd_cnt = rx_rd_cnt;
+    if (rd_cnt != rx_wr_cnt) {
+        ret = (int32_t)rx_buf[rd_cnt & RX_BUF_MASK];
+        __DMB();
+        rx_rd_cnt = rd_cnt + 1u;
+    }
+    return ret;
+}
+
+/** Transmit interrupt handler
+ *
+ *  The driver clears the transmit interrupt enable before this call.
+ *  It is enabled again when a character is written.
+ */
+static void tx_irq_handler(void)
+{
+    send_data();
+}
+
+/** Receive interrupt handler
+ *
+ *  Moves the received characters to the ring buffer, and notifies the reception.
+ */
+static void rx_irq_handler(void)
+{
+    uint32_t        wr_cnt;
+    int             c;
+    DSP_UART_CbRx   p_cb;
+
+    wr_cnt = rx_wr_cnt;
+    while (pc_com.readable() != 0) {
+        c = pc_com.getc();
+        if ((wr_cnt - rx_rd_cnt) < DSP_UART_RX_BUF_SIZE) {
+            rx_buf[wr_cnt & RX_BUF_MASK] = (uint8_t)c;
+            wr_cnt++;
+        } else {
+            /* Because the buffer is full, the character is discarded. */
+        }
+    }
+    __DMB();
+    rx_wr_cnt = wr_cnt;
+    p_cb = rx_callback;
+    if (p_cb != NULL) {
+        p_cb();
+    }
+}
+
+/** Writes the data of the ring buffer to the transmit FIFO
+ *
+ *  It is called in the interrupt or in the critical section.
+ */
+static void send_data(void)
+{
+    uint32_t    rd_cnt;
+
+    rd_cnt = tx_rd_cnt;
+    while ((rd_cnt != tx_wr_cnt) && (pc_com.writeable() != 0)) {
+        (void) pc_com.putc((int)tx_buf[rd_cnt & TX_BUF_MASK]);
+        rd_cnt++;
+    }
+    tx_rd_cnt = rd_cnt;
+    if (rd_cnt != tx_wr_cnt) {
+        tx_active = true;
+    } else {
+        /* The ring buffer is empty. The next write starts the transmission. */
+        tx_active = false;
+    }
+}
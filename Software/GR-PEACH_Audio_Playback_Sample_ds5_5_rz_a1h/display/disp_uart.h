@@ -0,0 +1,94 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef DISP_UART_H
+#define DISP_UART_H
+
+#include "r_typedefs.h"
+
+/*--- Macro definition ---*/
+/* Size of the transmit ring buffer in bytes. It must be a power of 2. */
+#define DSP_UART_TX_BUF_SIZE    (2048u)
+/* Size of the receive ring buffer in bytes. It must be a power of 2. */
+#define DSP_UART_RX_BUF_SIZE    (64u)
+
+/*--- User defined types ---*/
+typedef void (*DSP_UART_CbRx)(void);
+
+/** Initialises the serial port for PC communication
+ *
+ *  Sets the baud rate to DSP_PC_COM_BAUDRATE and enables the transmit and receive
+ *  interrupts. The transmit ring buffer is drained by the interrupt, and the receive
+ *  ring buffer is filled by the interrupt.
+ */
+void dsp_uart_init(void);
+
+/** Sets the callback function for notifying the reception
+ *
+ *  @param p_cb Callback function. NULL stops the notification.
+ *              typedef void (*DSP_UART_CbRx)(void);
+ *              It is called in the receive interrupt after the received characters
+ *              are stored. It must not wait.
+ */
+void dsp_uart_set_rx_callback(const DSP_UART_CbRx p_cb);
+
+/** Writes the string to the transmit ring buffer
+ *
+ *  This function does not wait for the transmission.
+ *  Overflow policy : When the free space is not enough for the whole string, nothing
+ *  is written and the overflow is recorded. A string is never cut, so the escape
+ *  sequences are not broken. The caller redraws the screen after the overflow.
+ *  Only one thread may call this function.
+ *
+ *  @param p_str String terminated by '\0'.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool dsp_uart_write(const char_t * const p_str);
+
+/** Checks and clears the overflow of the transmit ring buffer
+ *
+ *  @returns 
+ *    true if any string was discarded since the last call.
+ */
+bool dsp_uart_check_overflow(void);
+
+/** Checks whether a received character is available
+ *
+ *  @returns 
+ *    true if a character is available.
+ */
+bool dsp_uart_readable(void);
+
+/** Gets a received character
+ *
+ *  This function does not wait. Only one thread may call this function.
+ *  The characters received while the receive ring buffer is full are discarded.
+ *
+ *  @returns 
+ *    Received character. -1 if no character is available.
+ */
+int32_t dsp_uart_getc(void);
+
+#endif /* DISP_UART_H */
@@ -26,9 +26,16 @@
 #include "misratypes.h"
 #include "display.h"
 #include "disp_term.h"
+#include "disp_spec.h"
+#include "disp_tft.h"
+#include "sys_status.h"
 
 /*--- Macro definition of mbed-rtos mail ---*/
+#if (DSP_TFT_ENABLE == 1)
+#define MAIL_QUEUE_SIZE             (12 + DSP_LIST_ROW_NUM) /* Queue size. The track list is sent row by row. */
+#else
 #define MAIL_QUEUE_SIZE             (12)    /* Queue size */
+#endif
 #define MAIL_PARAM_NUM              (64)    /* Elements number of mail parameter array */
 
 /* dsp_mail_t */
@@ -44,16 +51,7 @@
 #define MAIL_DISPSTR_STR_START      (0)     /* Start position of display string */
 #define MAIL_DISPSTR_STR_SIZE       (DSP_DISP_STR_MAX_LEN)  /* Size of display string */
 
-/* mail_id = DSP_MAILID_PLAY_TIME */
-#define MAIL_PLAYTIME_STAT          (0)     /* Playback status */
-#define MAIL_PLAYTIME_TRACK_L       (1)     /* Track number */
-#define MAIL_PLAYTIME_TRACK_H       (2)     /* Track number */
-#define MAIL_PLAYTIME_PLAYTIME_L    (3)     /* Playback time */
-#define MAIL_PLAYTIME_PLAYTIME_M    (4)     /* Playback time */
-#define MAIL_PLAYTIME_PLAYTIME_H    (5)     /* Playback time */
-#define MAIL_PLAYTIME_TOTALTIME_L   (6)     /* Total playback time */
-#define MAIL_PLAYTIME_TOTALTIME_M   (7)     /* Total playback time */
-#define MAIL_PLAYTIME_TOTALTIME_H   (8)     /* Total playback time */
+/* DSP_MAILID_PLAY_TIME is not sent by the mail. The playback time is written to play_status. */
 
 /* mail_id = DSP_MAILID_PLAY_INFO */
 #define MAIL_PLAYINFO_TRACK_L       (0)     /* Track number */
@@ -73,6 +71,17 @@
 /* mail_id = DSP_MAILID_HELP */
 #define MAIL_HELP_PARAM             (0)     /* No mail parameter to be used */
 
+/* mail_id = DSP_MAILID_METER_MODE */
+#define MAIL_METERMODE_MODE         (0)     /* Level meter mode */
+
+/* mail_id = DSP_MAILID_LIST_NAME */
+#define MAIL_LISTNAME_ROW           (0)     /* Row of the track list */
+#define MAIL_LISTNAME_TRACK_L       (1)     /* Track number */
+#define MAIL_LISTNAME_TRACK_H       (2)     /* Track number */
+#define MAIL_LISTNAME_STR_START     (3)     /* Start position of track name string */
+#define MAIL_LISTNAME_STR_SIZE      (MAIL_PARAM_NUM - MAIL_LISTNAME_STR_START)
+                                            /* Size of track name string */
+
 #define MAIL_PARAM_NON              (0u)    /* Value of unused element of mail parameter array */
 
 #define BYTE_SHIFT                  (8u)
@@ -92,34 +101,74 @@ typedef struct {
 } dsp_ctrl_t;
 
 static Mail<dsp_mail_t, MAIL_QUEUE_SIZE> mail_box;
+/* Playback status written by main thread. Its update is not notified by the mail. */
+/* It is not initialised by this thread, because main thread may write it first. */
+/* The static storage starts with the sequence counter 0 and SYS_PLAYSTAT_STOP. */
+static sys_status_block_t play_status;
 
 static void init_ctrl_data(dsp_ctrl_t * const p_ctrl);
 static bool send_mail(const dsp_mail_t * const p_data);
-static bool recv_mail(dsp_mail_t * const p_data);
+static bool recv_mail(dsp_mail_t * const p_data, const uint32_t wait_ms);
 static bool decode_mail(const dsp_mail_t * const p_mail, dsp_ctrl_t * const p_ctrl);
 static void clear_one_shot_data(dsp_ctrl_t * const p_ctrl);
+static bool check_play_status(dsp_ctrl_t * const p_ctrl, uint32_t * const p_seq);
+static uint32_t get_wait_time(Timer * const p_timer, const bool is_tft_busy);
 
 void dsp_thread(void const *argument)
 {
     dsp_mail_t              recv_data;
     bool                    result;
     static dsp_ctrl_t       dsp_ctrl;
+    uint32_t                status_seq = 0u;
+    uint32_t                wait_ms;
+    bool                    is_tft_busy = false;
+    Timer                   cycle_timer;
     
     UNUSED_ARG(argument);
 
     init_ctrl_data(&dsp_ctrl);
+    dsp_init_spec();
     dsp_init_term();
+#if (DSP_TFT_ENABLE == 1)
+    dsp_init_tft(&dsp_ctrl.tft);
+    is_tft_busy = true;
+#endif
+    cycle_timer.start();
     while (1) {
-        result = recv_mail(&recv_data);
+        wait_ms = get_wait_time(&cycle_timer, is_tft_busy);
+        result = recv_mail(&recv_data, wait_ms);
+        if ((result == true) && (recv_data.mail_id == DSP_MAILID_CYCLE_IND)) {
+            if ((uint32_t)cycle_timer.read_ms() < DSP_CYCLE_TIME_MS) {
+                /* Woke up only for the next slice of the TFT module. */
+                result = false;
+            } else {
+                cycle_timer.reset();
+            }
+        }
         if (result == true) {
             result = decode_mail(&recv_data, &dsp_ctrl);
             if (result == true) {
                 /* Executes main function of terminal output module */
                 dsp_output_term(recv_data.mail_id, &dsp_ctrl.com, &dsp_ctrl.trm);
+#if (DSP_TFT_ENABLE == 1)
+                dsp_output_tft(recv_data.mail_id, &dsp_ctrl.com, &dsp_ctrl.tft);
+#endif
                 /* Clears the one shot data */
                 clear_one_shot_data(&dsp_ctrl);
             }
         }
+        /* The playback status is checked at every mail and every cyclic notice. */
+        result = check_play_status(&dsp_ctrl, &status_seq);
+        if (result == true) {
+            dsp_output_term(DSP_MAILID_PLAY_TIME, &dsp_ctrl.com, &dsp_ctrl.trm);
+#if (DSP_TFT_ENABLE == 1)
+            dsp_output_tft(DSP_MAILID_PLAY_TIME, &dsp_ctrl.com, &dsp_ctrl.tft);
+#endif
+        }
+#if (DSP_TFT_ENABLE == 1)
+        /* Draws the changed regions within the CPU slice of the TFT module. */
+        is_tft_busy = dsp_exe_tft();
+#endif
     }
 }
 
@@ -127,19 +176,14 @@ bool dsp_notify_play_time(const SYS_PlayStat play_stat, const uint32_t file_no,
                             const uint32_t play_time, const uint32_t total_time)
 {
     bool            ret;
-    dsp_mail_t      data;
+    sys_status_t    status;
 
-    data.mail_id                          = DSP_MAILID_PLAY_TIME;
-    data.param[MAIL_PLAYTIME_STAT]        = (uint8_t)play_stat;
-    data.param[MAIL_PLAYTIME_TRACK_L]     = (uint8_t)file_no;
-    data.param[MAIL_PLAYTIME_TRACK_H]     = (uint8_t)(file_no >> BYTE_SHIFT);
-    data.param[MAIL_PLAYTIME_PLAYTIME_L]  = (uint8_t)play_time;
-    data.param[MAIL_PLAYTIME_PLAYTIME_M]  = (uint8_t)(play_time >> BYTE_SHIFT);
-    data.param[MAIL_PLAYTIME_PLAYTIME_H]  = (uint8_t)(play_time >> WORD_SHIFT);
-    data.param[MAIL_PLAYTIME_TOTALTIME_L] = (uint8_t)total_time;
-    data.param[MAIL_PLAYTIME_TOTALTIME_M] = (uint8_t)(total_time >> BYTE_SHIFT);
-    data.param[MAIL_PLAYTIME_TOTALTIME_H] = (uint8_t)(total_time >> WORD_SHIFT);
-    ret = send_mail(&data);
+    status.play_stat  = play_stat;
+    status.track_id   = file_no;
+    status.play_time  = play_time;
+    status.total_time = total_time;
+    sys_status_write(&play_status, &status);
+    ret = true;
 
     return ret;
 }
@@ -174,6 +218,18 @@ bool dsp_notify_play_mode(const bool rep_mode)
     return ret;
 }
 
+bool dsp_notify_meter_mode(const bool meter_mode)
+{
+    bool            ret;
+    dsp_mail_t      data;
+
+    data.mail_id                     = DSP_MAILID_METER_MODE;
+    data.param[MAIL_METERMODE_MODE]  = (uint8_t)meter_mode;
+    ret = send_mail(&data);
+
+    return ret;
+}
+
 bool dsp_notify_file_name(const char_t * const p_str)
 {
     bool            ret = false;
@@ -189,6 +245,32 @@ bool dsp_notify_file_name(const char_t * const p_str)
     return ret;
 }
 
+bool dsp_notify_list_name(const uint32_t row, const uint32_t file_no, const char_t * const p_str)
+{
+    bool            ret = false;
+#if (DSP_TFT_ENABLE == 1)
+    dsp_mail_t      data;
+
+    if ((row < DSP_LIST_ROW_NUM) && (p_str != NULL)) {
+        data.mail_id = DSP_MAILID_LIST_NAME;
+        data.param[MAIL_LISTNAME_ROW]     = (uint8_t)row;
+        data.param[MAIL_LISTNAME_TRACK_L] = (uint8_t)file_no;
+        data.param[MAIL_LISTNAME_TRACK_H] = (uint8_t)(file_no >> BYTE_SHIFT);
+        (void) strncpy((char_t *)&data.param[MAIL_LISTNAME_STR_START], p_str, MAIL_LISTNAME_STR_SIZE);
+        data.param[(MAIL_LISTNAME_STR_START + MAIL_LISTNAME_STR_SIZE) - 1] = '\0';
+        ret = send_mail(&data);
+    }
+#else
+    UNUSED_ARG(row);
+    UNUSED_ARG(file_no);
+    UNUSED_ARG(p_str);
+    /* The track list is not shown without the TFT module. */
+    ret = true;
+#endif
+
+    return ret;
+}
+
 bool dsp_notify_print_string(const char_t * const p_str)
 {
     bool            ret = false;
@@ -237,6 +319,8 @@ bool dsp_req_help(void)
  */
 static void init_ctrl_data(dsp_ctrl_t * const p_ctrl)
 {
+    uint32_t        i;
+
     if (p_ctrl != NULL) {
         /* Initialises the common data of the display module. */
         p_ctrl->com.disp_mode       = 0u;
@@ -249,14 +333,21 @@ static void init_ctrl_data(dsp_ctrl_t * const p_ctrl)
         p_ctrl->com.repeat_mode     = false;
         p_ctrl->com.file_name[0]    = '\0';
         p_ctrl->com.dspl_str[0]     = '\0';
+        p_ctrl->com.meter_mode      = false;
+        for (i = 0u; i < DSP_METER_BAND_NUM; i++) {
+            p_ctrl->com.band_level[i] = DSP_METER_LEVEL_MIN;
+        }
+        for (i = 0u; i < DSP_METER_CH_NUM; i++) {
+            p_ctrl->com.peak_level[i] = DSP_METER_LEVEL_MIN;
+            p_ctrl->com.rms_level[i]  = DSP_METER_LEVEL_MIN;
+        }
         
         /* Initialises the data of the terminal output module. */
         p_ctrl->trm.edge_fin_inpt = false;
         p_ctrl->trm.inpt_str[0] = '\0';
 
         /* Does not initialize the data of TFT module. */
-        /* Initial values are different by the display mode. */
-        /* Therefore the data of TFT module is initialized by tft_init_proc function. */
+        /* It is initialized by dsp_init_tft function with the screen. */
     }
 }
 
@@ -289,20 +380,23 @@ static bool send_mail(const dsp_mail_t * const p_data)
 }
 
 /** Receives the mail to main thread
+ *
+ *  When no mail is received in wait_ms, DSP_MAILID_CYCLE_IND is stored.
  *
  *  @param p_data Pointer to the structure of the data
+ *  @param wait_ms Time in ms to wait for the mail
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool recv_mail(dsp_mail_t * const p_data)
+static bool recv_mail(dsp_mail_t * const p_data, const uint32_t wait_ms)
 {
     bool            ret = false;
     osEvent         evt;
     dsp_mail_t      *p_mail;
 
     if (p_data != NULL) {
-        evt = mail_box.get();
+        evt = mail_box.get(wait_ms);
         if (evt.status == osEventMail) {
             p_mail = (dsp_mail_t *)evt.value.p;
             if (p_mail != NULL) {
@@ -310,6 +404,11 @@ static bool recv_mail(dsp_mail_t * const p_data)
                 ret = true;
             }
             (void) mail_box.free(p_mail);
+        } else if (evt.status == osEventTimeout) {
+            p_data->mail_id = DSP_MAILID_CYCLE_IND;
+            ret = true;
+        } else {
+            /* DO NOTHING */
         }
     }
     return ret;
@@ -326,12 +425,18 @@ static bool recv_mail(dsp_mail_t * const p_data)
 static bool decode_mail(const dsp_mail_t * const p_mail, dsp_ctrl_t * const p_ctrl)
 {
     bool            ret = false;
+    uint32_t        row;
     
     if ((p_mail != NULL) && (p_ctrl != NULL)) {
         /* Decodes the received mail */
         switch(p_mail->mail_id) {
             case DSP_MAILID_CYCLE_IND:       /* Cyclic notice */
-                ret = true;
+                if ((p_ctrl->com.meter_mode == true) || (DSP_TFT_ENABLE == 1)) {
+                    /* Only the changed levels are displayed. */
+                    ret = dsp_exe_spec(&p_ctrl->com);
+                } else {
+                    ret = false;
+                }
                 break;
             case DSP_MAILID_CMD_STR:         /* Input character string by the command-line */
                 ret = true;
@@ -352,18 +457,6 @@ static bool decode_mail(const dsp_mail_t * const p_mail, dsp_ctrl_t * const p_ct
                               sizeof(p_ctrl->com.dspl_str));
                 p_ctrl->com.dspl_str[DSP_DISP_STR_MAX_LEN - 1] = '\0';
                 break;
-            case DSP_MAILID_PLAY_TIME:       /* Playback time */
-                ret = true;
-                p_ctrl->com.play_stat   = (SYS_PlayStat)p_mail->param[MAIL_PLAYTIME_STAT];
-                p_ctrl->com.track_id    = (((uint32_t)p_mail->param[MAIL_PLAYTIME_TRACK_H] << BYTE_SHIFT) |
-                                            (uint32_t)p_mail->param[MAIL_PLAYTIME_TRACK_L]);
-                p_ctrl->com.play_time   = (((uint32_t)p_mail->param[MAIL_PLAYTIME_PLAYTIME_H] << WORD_SHIFT) |
-                                           ((uint32_t)p_mail->param[MAIL_PLAYTIME_PLAYTIME_M] << BYTE_SHIFT) |
-                                           ((uint32_t)p_mail->param[MAIL_PLAYTIME_PLAYTIME_L]));
-                p_ctrl->com.total_time  = (((uint32_t)p_mail->param[MAIL_PLAYTIME_TOTALTIME_H] << WORD_SHIFT) |
-                                           ((uint32_t)p_mail->param[MAIL_PLAYTIME_TOTALTIME_M] << BYTE_SHIFT) |
-                                           ((uint32_t)p_mail->param[MAIL_PLAYTIME_TOTALTIME_L]));
-                break;
             case DSP_MAILID_PLAY_INFO:       /* Music information */
                 ret = true;
                 p_ctrl->com.track_id    = (((uint32_t)p_mail->param[MAIL_PLAYINFO_TRACK_H] << BYTE_SHIFT) |
@@ -391,6 +484,27 @@ static bool decode_mail(const dsp_mail_t * const p_mail, dsp_ctrl_t * const p_ct
             case DSP_MAILID_HELP:            /* Help information */
                 ret = true; 
                 break;
+            case DSP_MAILID_METER_MODE:      /* Level meter mode */
+                ret = true;
+                if ((int32_t)p_mail->param[MAIL_METERMODE_MODE] == true) {
+                    p_ctrl->com.meter_mode = true;
+                } else {
+                    p_ctrl->com.meter_mode = false;
+                }
+                break;
+            case DSP_MAILID_LIST_NAME:       /* Track list */
+                if (p_mail->param[MAIL_LISTNAME_ROW] < DSP_LIST_ROW_NUM) {
+                    ret = true;
+                    row = p_mail->param[MAIL_LISTNAME_ROW];
+                    p_ctrl->tft.list_no[row] = (((uint32_t)p_mail->param[MAIL_LISTNAME_TRACK_H] << BYTE_SHIFT) |
+                                                   (uint32_t)p_mail->param[MAIL_LISTNAME_TRACK_L]);
+                    (void) memcpy(&p_ctrl->tft.list_name[row][0], 
+                                  &p_mail->param[MAIL_LISTNAME_STR_START], MAIL_LISTNAME_STR_SIZE);
+                    p_ctrl->tft.list_name[row][MAIL_LISTNAME_STR_SIZE - 1] = '\0';
+                } else {
+                    ret = false;
+                }
+                break;
             default:
                 /* Unexpected cases : mail id was illegal. */
                 ret = false;
@@ -400,6 +514,60 @@ static bool decode_mail(const dsp_mail_t * const p_mail, dsp_ctrl_t * const p_ct
     return ret;
 }
 
+/** Checks the update of the playback status written by main thread
+ *
+ *  @param p_ctrl Pointer to control data of display module.
+ *  @param p_seq Pointer to the sequence counter of the playback status read last
+ *
+ *  @returns 
+ *    true if the playback status is updated. false if it is not updated.
+ */
+static bool check_play_status(dsp_ctrl_t * const p_ctrl, uint32_t * const p_seq)
+{
+    bool            ret = false;
+    sys_status_t    status;
+
+    if ((p_ctrl != NULL) && (p_seq != NULL)) {
+        ret = sys_status_read(&play_status, &status, p_seq);
+        if (ret == true) {
+            p_ctrl->com.play_stat   = status.play_stat;
+            p_ctrl->com.track_id    = status.track_id;
+            p_ctrl->com.play_time   = status.play_time;
+            p_ctrl->com.total_time  = status.total_time;
+        }
+    }
+    return ret;
+}
+
+/** Gets the time to wait for the mail
+ *
+ *  The display thread wakes up every DSP_CYCLE_TIME_MS for the cyclic notice.
+ *  While the TFT module has the regions to draw, it wakes up every
+ *  DSP_TFT_SLICE_CYCLE_MS for the next slice.
+ *
+ *  @param p_timer Pointer to the timer of the cyclic notice.
+ *  @param is_tft_busy true if the TFT module has the regions to draw.
+ *
+ *  @returns 
+ *    Time to wait in ms.
+ */
+static uint32_t get_wait_time(Timer * const p_timer, const bool is_tft_busy)
+{
+    uint32_t        wait_ms = 0u;
+    uint32_t        elapsed_ms;
+
+    if (p_timer != NULL) {
+        elapsed_ms = (uint32_t)p_timer->read_ms();
+        if (elapsed_ms < DSP_CYCLE_TIME_MS) {
+            wait_ms = DSP_CYCLE_TIME_MS - elapsed_ms;
+        }
+        if ((is_tft_busy == true) && (wait_ms > DSP_TFT_SLICE_CYCLE_MS)) {
+            wait_ms = DSP_TFT_SLICE_CYCLE_MS;
+        }
+    }
+    return wait_ms;
+}
+
 /** Clears the one shot data in the control data of display module
  *
  *  @param p_ctrl Pointer to control data of display module.
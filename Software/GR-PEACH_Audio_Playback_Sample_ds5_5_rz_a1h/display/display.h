@@ -36,7 +36,27 @@
 #define DSP_CMD_INPT_STR_MAX_LEN    (63)
 
 /* The baud rate of the serial port for PC communication. */
-#define DSP_PC_COM_BAUDRATE         (9600)
+/* The terminal software on PC must use the same baud rate. (The former setting was 9600.) */
+#define DSP_PC_COM_BAUDRATE         (115200)
+
+/* Cycle time in ms of the cyclic notice. The level meter is updated in this cycle. */
+#define DSP_CYCLE_TIME_MS           (200u)
+
+/* Level meter */
+#define DSP_METER_BAND_NUM          (16u)   /* Number of the bands of the spectrum */
+#define DSP_METER_CH_NUM            (2u)    /* Number of the channels of the peak/RMS meter */
+#define DSP_METER_LEVEL_MIN         (-60)   /* Minimum level in dB */
+#define DSP_METER_LEVEL_MAX         (0)     /* Maximum level in dB */
+
+/* TFT module */
+/* 1 : Draws the now-playing screen (track list, progress bar and spectrum) to the */
+/*     frame buffer of the TFT module. The spectrum is calculated without METER command. */
+/* 0 : The TFT module is not used. */
+#ifndef DSP_TFT_ENABLE
+#define DSP_TFT_ENABLE              (0)
+#endif
+/* Number of the rows of the track list. The playing track is in the center row. */
+#define DSP_LIST_ROW_NUM            (5u)
 
 /*--- User defined types ---*/
 typedef enum {
@@ -44,11 +64,13 @@ typedef enum {
     DSP_MAILID_CYCLE_IND,   /* Cyclic notice */
     DSP_MAILID_CMD_STR,     /* Notifies display thread of input string. */
     DSP_MAILID_PRINT_STR,   /* Notifies display thread of output string. */
-    DSP_MAILID_PLAY_TIME,   /* Notifies display thread of playback time. */
+    DSP_MAILID_PLAY_TIME,   /* Playback time is updated. It is not sent by the mail. */
     DSP_MAILID_PLAY_INFO,   /* Notifies display thread of playback information. */
     DSP_MAILID_PLAY_MODE,   /* Notifies display thread of repeat mode. */
     DSP_MAILID_FILE_NAME,   /* Notifies display thread of file name. */
     DSP_MAILID_HELP,        /* Requests display thread to display help message. */
+    DSP_MAILID_METER_MODE,  /* Notifies display thread of level meter mode. */
+    DSP_MAILID_LIST_NAME,   /* Notifies display thread of track name of the track list. */
     DSP_MAILID_NUM
 } DSP_MAIL_ID;
 
@@ -64,6 +86,10 @@ typedef struct {
     bool            repeat_mode;    /* Repeat mode */
     char_t          file_name[DSP_DISP_STR_MAX_LEN];/* Character string of file name */
     char_t          dspl_str[DSP_DISP_STR_MAX_LEN]; /* Display character string */
+    bool            meter_mode;     /* Level meter mode */
+    int32_t         band_level[DSP_METER_BAND_NUM]; /* Level of the spectrum bands (dB) */
+    int32_t         peak_level[DSP_METER_CH_NUM];   /* Peak level (dB) */
+    int32_t         rms_level[DSP_METER_CH_NUM];    /* RMS level (dB) */
 } dsp_com_ctrl_t;
 
 /* These data are used only in the terminal-output module. */
@@ -75,7 +101,8 @@ typedef struct {
 
 /* These data are used only in the TFT module. */
 typedef struct {
-    int32_t         disp_phase_no;  /* The making phase of the display image */
+    uint32_t        list_no[DSP_LIST_ROW_NUM];      /* Track number of each row (0 is empty) */
+    char_t          list_name[DSP_LIST_ROW_NUM][DSP_DISP_STR_MAX_LEN]; /* Track name of each row */
 } dsp_tft_ctrl_t;
 
 
@@ -86,6 +113,10 @@ typedef struct {
 void dsp_thread(void const *argument);
 
 /** Notifies the display thread of the song information (file number, play time, total play time, play state).
+ *
+ *  The values are written to the status block which the display thread checks at
+ *  every mail and every DSP_CYCLE_TIME_MS, not sent by the mail. The display thread
+ *  gets the latest values, so the notification is never lost even if the mailbox is full.
  *
  *  @param play_stat Playback state
  *                     Stopped : SYS_PLAYSTAT_STOP
@@ -101,10 +132,7 @@ void dsp_thread(void const *argument);
  *                      * 0 hour, 0 minute, 0 second to 99 hours, 59 minutes, 59 seconds
  *
  *  @returns 
- *    Returns true if the API is successful. Returns false if the API fails.
- *    This function fails when:
- *     Failed to secure memory for mailbox communication.
- *     Failed to perform transmit processing for mailbox communication.
+ *    Returns true always.
  */
 bool dsp_notify_play_time(const SYS_PlayStat play_stat, const uint32_t file_no, 
                             const uint32_t play_time, const uint32_t total_time);
@@ -141,6 +169,22 @@ bool dsp_notify_play_info(const uint32_t file_no,
  */
 bool dsp_notify_play_mode(const bool rep_mode);
 
+/** Notifies the display thread of the level meter mode.
+ *
+ *  @param meter_mode Level meter mode
+ *                      Level meter OFF : false
+ *                      Level meter ON : true
+ *                      * The display thread shows the spectrum and the peak/RMS meters
+ *                        every DSP_CYCLE_TIME_MS while it is on.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dsp_notify_meter_mode(const bool meter_mode);
+
 /** Notifies the display thread of the file name.
  *
  *  @param p_str File name string
@@ -160,6 +204,32 @@ bool dsp_notify_play_mode(const bool rep_mode);
  */
 bool dsp_notify_file_name(const char_t * const p_str);
 
+/** Notifies the display thread of the track name of the track list.
+ *
+ *  The track list is shown only by the TFT module. When DSP_TFT_ENABLE is not 1,
+ *  this function does nothing and returns true.
+ *
+ *  @param row Row of the track list
+ *               0 to (DSP_LIST_ROW_NUM - 1)
+ *               * The row (DSP_LIST_ROW_NUM / 2) is the playing track.
+ *  @param file_no File number
+ *                   0 to 999
+ *                   * 0 means that the row is empty.
+ *  @param p_str Track name string
+ *                 * The string must be terminated by '\0'.
+ *                   The maximum length of the string that the display thread can notify
+ *                   is 61 bytes including '\0'.
+ *
+ *  @returns 
+ *    Returns true if the API is successful. Returns false if the API fails.
+ *    This function fails when:
+ *     The argument row is out of range.
+ *     The argument p_str is set to NULL.
+ *     Failed to secure memory for mailbox communication.
+ *     Failed to perform transmit processing for mailbox communication.
+ */
+bool dsp_notify_list_name(const uint32_t row, const uint32_t file_no, const char_t * const p_str);
+
 /** Notifies the display thread of the string to be output on the terminal.
  *
  *  @param p_str String to be output on the terminal
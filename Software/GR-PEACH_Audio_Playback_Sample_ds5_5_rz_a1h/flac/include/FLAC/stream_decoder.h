@@ -797,6 +797,31 @@ FLAC_API FLAC__bool FLAC__stream_decoder_set_ogg_serial_number(FLAC__StreamDecod
  */
 FLAC_API FLAC__bool FLAC__stream_decoder_set_md5_checking(FLAC__StreamDecoder *decoder, FLAC__bool value);
 
+#if(1) /* mbed */
+/** Allocate the output arrays of the decoder in advance.
+ *
+ *  The buffer for a VORBIS_COMMENT block, the MD5 buffer for the frames
+ *  of \a blocksize and \a channels at 32 bits per sample, and the seek
+ *  table of FLAC__STREAM_DECODER_MAX_SEEK_POINTS points (a larger
+ *  SEEKTABLE is thinned out to it) are allocated as well.
+ *  The arrays, the input buffer, the MD5 buffer, the seek table and the
+ *  VORBIS_COMMENT buffer are kept by FLAC__stream_decoder_finish() and
+ *  freed by FLAC__stream_decoder_delete().  A decoder that is recycled
+ *  with FLAC__stream_decoder_finish() therefore does not allocate them
+ *  again for the streams that fit them.
+ *
+ * \param  decoder    A decoder instance to set.
+ * \param  blocksize  Block size in samples to reserve.
+ * \param  channels   Number of channels to reserve.
+ * \assert
+ *    \code decoder != NULL \endcode
+ * \retval FLAC__bool
+ *    \c false if the decoder is already initialized, the arguments are
+ *    out of range, or the memory allocation fails, else \c true.
+ */
+FLAC_API FLAC__bool FLAC__stream_decoder_reserve_output(FLAC__StreamDecoder *decoder, unsigned blocksize, unsigned channels);
+#endif /* end mbed */
+
 /** Direct the decoder to pass on all metadata blocks of type \a type.
  *
  * \default By default, only the \c STREAMINFO block is returned via the
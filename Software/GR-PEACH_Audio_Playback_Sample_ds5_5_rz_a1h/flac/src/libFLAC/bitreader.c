@@ -235,10 +235,20 @@ FLAC__bool FLAC__bitreader_init(FLAC__BitReader *br, FLAC__BitReaderReadCallback
 
 	br->words = br->bytes = 0;
 	br->consumed_words = br->consumed_bits = 0;
+#if(1) /* mbed */
+	/* The buffer kept from the previous stream is reused. */
+	if(br->buffer == 0) {
+		br->capacity = FLAC__BITREADER_DEFAULT_CAPACITY;
+		br->buffer = malloc(sizeof(uint32_t) * br->capacity);
+		if(br->buffer == 0)
+			return false;
+	}
+#else  /* not mbed */
 	br->capacity = FLAC__BITREADER_DEFAULT_CAPACITY;
 	br->buffer = malloc(sizeof(uint32_t) * br->capacity);
 	if(br->buffer == 0)
 		return false;
+#endif /* end mbed */
 	br->read_callback = rcb;
 	br->client_data = cd;
 
@@ -76,6 +76,19 @@ FLAC_API int FLAC_API_SUPPORTS_OGG_FLAC =
 
 static const FLAC__byte ID3V2_TAG_[3] = { 'I', 'D', '3' };
 
+#if(1) /* mbed */
+/* VORBIS_COMMENT blocks longer than this are skipped even if the client
+ * asked for them, so that a huge tag block cannot exhaust the heap. */
+#ifndef FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH
+#define FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH (4096u)
+#endif
+/* SEEKTABLE blocks with more points than this are thinned out evenly to
+ * this count, so that the table reserved in advance always fits. */
+#ifndef FLAC__STREAM_DECODER_MAX_SEEK_POINTS
+#define FLAC__STREAM_DECODER_MAX_SEEK_POINTS (512u)
+#endif
+#endif /* end mbed */
+
 /***********************************************************************
  *
  * Private class method prototypes
@@ -93,6 +106,15 @@ static FLAC__bool read_metadata_seektable_(FLAC__StreamDecoder *decoder, FLAC__b
 static FLAC__bool read_metadata_vorbiscomment_(FLAC__StreamDecoder *decoder, FLAC__StreamMetadata_VorbisComment *obj, unsigned length);
 static FLAC__bool read_metadata_cuesheet_(FLAC__StreamDecoder *decoder, FLAC__StreamMetadata_CueSheet *obj);
 static FLAC__bool read_metadata_picture_(FLAC__StreamDecoder *decoder, FLAC__StreamMetadata_Picture *obj);
+#if(1) /* mbed */
+static FLAC__bool skip_metadata_block_(FLAC__StreamDecoder *decoder, unsigned length);
+static void detach_md5_buffer_(FLAC__StreamDecoder *decoder);
+static void free_buffers_(FLAC__StreamDecoder *decoder);
+static FLAC__bool reserve_comment_buf_(FLAC__StreamDecoder *decoder, unsigned length);
+static FLAC__bool reserve_seek_table_(FLAC__StreamDecoder *decoder);
+static FLAC__bool reserve_md5_buf_(FLAC__StreamDecoder *decoder, unsigned blocksize, unsigned channels);
+static void *alloc_comment_(FLAC__StreamDecoder *decoder, size_t size);
+#endif /* end mbed */
 static FLAC__bool skip_id3v2_tag_(FLAC__StreamDecoder *decoder);
 static FLAC__bool frame_sync_(FLAC__StreamDecoder *decoder);
 static FLAC__bool read_frame_(FLAC__StreamDecoder *decoder, FLAC__bool *got_a_frame, FLAC__bool do_full_decode);
@@ -180,6 +202,17 @@ typedef struct FLAC__StreamDecoderPrivate {
 #if FLAC__HAS_OGG
 	FLAC__bool got_a_frame; /* hack needed in Ogg FLAC seek routine to check when process_single() actually writes a frame */
 #endif
+#if(1) /* mbed */
+	/* The buffers below, the bitreader buffer and the output arrays are kept
+	 * by FLAC__stream_decoder_finish() and reused by the next stream, so that
+	 * a recycled decoder does not allocate on every stream. They are freed
+	 * by FLAC__stream_decoder_delete(). */
+	FLAC__byte *md5_buf; /* internal buffer of md5context while it is not initialized */
+	size_t md5_capacity;
+	unsigned seek_table_capacity; /* units are seek points */
+	FLAC__byte *comment_buf; /* the strings and the entries of VORBIS_COMMENT */
+	size_t comment_buf_capacity, comment_buf_used;
+#endif /* end mbed */
 } FLAC__StreamDecoderPrivate;
 
 /***********************************************************************
@@ -327,6 +360,10 @@ FLAC_API void FLAC__stream_decoder_delete(FLAC__StreamDecoder *decoder)
 
 	(void)FLAC__stream_decoder_finish(decoder);
 
+#if(1) /* mbed */
+	free_buffers_(decoder);
+#endif /* end mbed */
+
 	if(0 != decoder->private_->metadata_filter_ids)
 		free(decoder->private_->metadata_filter_ids);
 
@@ -656,6 +693,14 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 	/* see the comment in FLAC__stream_decoder_reset() as to why we
 	 * always call FLAC__MD5Final()
 	 */
+#if(1) /* mbed */
+	detach_md5_buffer_(decoder);
+	FLAC__MD5Final(decoder->private_->computed_md5sum, &decoder->private_->md5context);
+
+	/* The seek table points, the bitreader buffer and the output arrays are kept. */
+	decoder->private_->has_seek_table = false;
+	(void)i;
+#else  /* not mbed */
 	FLAC__MD5Final(decoder->private_->computed_md5sum, &decoder->private_->md5context);
 
 	if(decoder->private_->has_seek_table && 0 != decoder->private_->seek_table.data.seek_table.points) {
@@ -682,6 +727,7 @@ FLAC_API FLAC__bool FLAC__stream_decoder_finish(FLAC__StreamDecoder *decoder)
 	}
 	decoder->private_->output_capacity = 0;
 	decoder->private_->output_channels = 0;
+#endif /* end mbed */
 
 #if FLAC__HAS_OGG
 	if(decoder->private_->is_ogg)
@@ -734,6 +780,27 @@ FLAC_API FLAC__bool FLAC__stream_decoder_set_md5_checking(FLAC__StreamDecoder *d
 	return true;
 }
 
+#if(1) /* mbed */
+FLAC_API FLAC__bool FLAC__stream_decoder_reserve_output(FLAC__StreamDecoder *decoder, unsigned blocksize, unsigned channels)
+{
+	FLAC__ASSERT(0 != decoder);
+	FLAC__ASSERT(0 != decoder->protected_);
+	if(decoder->protected_->state != FLAC__STREAM_DECODER_UNINITIALIZED)
+		return false;
+	if(blocksize == 0 || blocksize > FLAC__MAX_BLOCK_SIZE || channels == 0 || channels > FLAC__MAX_CHANNELS)
+		return false;
+	if(!allocate_output_(decoder, blocksize, channels) ||
+	   !reserve_comment_buf_(decoder, FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH) ||
+	   !reserve_seek_table_(decoder) ||
+	   !reserve_md5_buf_(decoder, blocksize, channels)) {
+		/* the allocation sets the error state, but the decoder is still not initialized */
+		decoder->protected_->state = FLAC__STREAM_DECODER_UNINITIALIZED;
+		return false;
+	}
+	return true;
+}
+#endif /* end mbed */
+
 FLAC_API FLAC__bool FLAC__stream_decoder_set_metadata_respond(FLAC__StreamDecoder *decoder, FLAC__MetadataType type)
 {
 	FLAC__ASSERT(0 != decoder);
@@ -990,11 +1057,16 @@ FLAC_API FLAC__bool FLAC__stream_decoder_reset(FLAC__StreamDecoder *decoder)
 	decoder->protected_->state = FLAC__STREAM_DECODER_SEARCH_FOR_METADATA;
 
 	decoder->private_->has_stream_info = false;
+#if(1) /* mbed */
+	/* The seek table points are kept for the next seek table. */
+	decoder->private_->has_seek_table = false;
+#else  /* not mbed */
 	if(decoder->private_->has_seek_table && 0 != decoder->private_->seek_table.data.seek_table.points) {
 		free(decoder->private_->seek_table.data.seek_table.points);
 		decoder->private_->seek_table.data.seek_table.points = 0;
 		decoder->private_->has_seek_table = false;
 	}
+#endif /* end mbed */
 	decoder->private_->do_md5_checking = decoder->protected_->md5_checking;
 	/*
 	 * This goes in reset() and not flush() because according to the spec, a
@@ -1008,7 +1080,15 @@ FLAC_API FLAC__bool FLAC__stream_decoder_reset(FLAC__StreamDecoder *decoder)
 	 * FLAC__stream_decoder_finish() to make sure things are always cleaned up
 	 * properly.
 	 */
+#if(1) /* mbed */
+	/* FLAC__MD5Init() forgets the internal buffer, so it is reattached. */
+	detach_md5_buffer_(decoder);
+	FLAC__MD5Init(&decoder->private_->md5context);
+	decoder->private_->md5context.internal_buf.p8 = decoder->private_->md5_buf;
+	decoder->private_->md5context.capacity = decoder->private_->md5_capacity;
+#else  /* not mbed */
 	FLAC__MD5Init(&decoder->private_->md5context);
+#endif /* end mbed */
 
 	decoder->private_->first_frame_offset = 0;
 	decoder->private_->unparseable_frame_count = 0;
@@ -1287,6 +1367,15 @@ FLAC__bool allocate_output_(FLAC__StreamDecoder *decoder, unsigned size, unsigne
 	if(size <= decoder->private_->output_capacity && channels <= decoder->private_->output_channels)
 		return true;
 
+#if(1) /* mbed */
+	/* The arrays only grow, so that the streams with the different block
+	 * sizes or channels do not allocate them in turn. */
+	if(size < decoder->private_->output_capacity)
+		size = decoder->private_->output_capacity;
+	if(channels < decoder->private_->output_channels)
+		channels = decoder->private_->output_channels;
+#endif /* end mbed */
+
 	/* simply using realloc() is not practical because the number of channels may change mid-stream */
 
 	for(i = 0; i < FLAC__MAX_CHANNELS; i++) {
@@ -1465,18 +1554,33 @@ FLAC__bool read_metadata_(FLAC__StreamDecoder *decoder)
 			if(decoder->private_->metadata_filter_ids_count > 0 && has_id_filtered_(decoder, block.data.application.id))
 				skip_it = !skip_it;
 		}
+#if(1) /* mbed */
+		if(type == FLAC__METADATA_TYPE_VORBIS_COMMENT && real_length > FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH)
+			skip_it = true;
+
+		if(skip_it) {
+			if(!skip_metadata_block_(decoder, real_length))
+				return false; /* skip_metadata_block_ sets the state for us */
+		}
+#else  /* not mbed */
 
 		if(skip_it) {
 			if(!FLAC__bitreader_skip_byte_block_aligned_no_crc(decoder->private_->input, real_length))
 				return false; /* read_callback_ sets the state for us */
 		}
+#endif /* end mbed */
 		else {
 			FLAC__bool ok = true;
 			switch(type) {
 				case FLAC__METADATA_TYPE_PADDING:
 					/* skip the padding bytes */
+#if(1) /* mbed */
+					if(!skip_metadata_block_(decoder, real_length))
+						ok = false; /* skip_metadata_block_ sets the state for us */
+#else  /* not mbed */
 					if(!FLAC__bitreader_skip_byte_block_aligned_no_crc(decoder->private_->input, real_length))
 						ok = false; /* read_callback_ sets the state for us */
+#endif /* end mbed */
 					break;
 				case FLAC__METADATA_TYPE_APPLICATION:
 					/* remember, we read the ID already */
@@ -1492,6 +1596,11 @@ FLAC__bool read_metadata_(FLAC__StreamDecoder *decoder)
 						block.data.application.data = 0;
 					break;
 				case FLAC__METADATA_TYPE_VORBIS_COMMENT:
+#if(1) /* mbed */
+					if(!reserve_comment_buf_(decoder, real_length))
+						ok = false;
+					else
+#endif /* end mbed */
 					if(!read_metadata_vorbiscomment_(decoder, &block.data.vorbis_comment, real_length))
 						ok = false;
 					break;
@@ -1532,6 +1641,9 @@ FLAC__bool read_metadata_(FLAC__StreamDecoder *decoder)
 						free(block.data.application.data);
 					break;
 				case FLAC__METADATA_TYPE_VORBIS_COMMENT:
+#if(1) /* mbed */
+					/* The block is in private_->comment_buf, which is reused. */
+#else  /* not mbed */
 					if(0 != block.data.vorbis_comment.vendor_string.entry)
 						free(block.data.vorbis_comment.vendor_string.entry);
 					if(block.data.vorbis_comment.num_comments > 0)
@@ -1540,6 +1652,7 @@ FLAC__bool read_metadata_(FLAC__StreamDecoder *decoder)
 								free(block.data.vorbis_comment.comments[i].entry);
 					if(0 != block.data.vorbis_comment.comments)
 						free(block.data.vorbis_comment.comments);
+#endif /* end mbed */
 					break;
 				case FLAC__METADATA_TYPE_CUESHEET:
 					if(block.data.cue_sheet.num_tracks > 0)
@@ -1656,6 +1769,10 @@ FLAC__bool read_metadata_seektable_(FLAC__StreamDecoder *decoder, FLAC__bool is_
 {
 	FLAC__uint32 i, x;
 	FLAC__uint64 xx;
+#if(1) /* mbed */
+	FLAC__uint32 num_points, step, j;
+	FLAC__StreamMetadata_SeekPoint point;
+#endif /* end mbed */
 
 	FLAC__ASSERT(FLAC__bitreader_is_consumed_byte_aligned(decoder->private_->input));
 
@@ -1665,6 +1782,33 @@ FLAC__bool read_metadata_seektable_(FLAC__StreamDecoder *decoder, FLAC__bool is_
 
 	decoder->private_->seek_table.data.seek_table.num_points = length / FLAC__STREAM_METADATA_SEEKPOINT_LENGTH;
 
+#if(1) /* mbed */
+	/* The table is kept to FLAC__STREAM_DECODER_MAX_SEEK_POINTS by taking
+	 * every step-th point, so the reserved table is never reallocated.  The
+	 * seek routine only uses the points as hints for its search. */
+	num_points = decoder->private_->seek_table.data.seek_table.num_points;
+	step = (num_points > FLAC__STREAM_DECODER_MAX_SEEK_POINTS) ? (num_points + FLAC__STREAM_DECODER_MAX_SEEK_POINTS - 1) / FLAC__STREAM_DECODER_MAX_SEEK_POINTS : 1;
+	decoder->private_->seek_table.data.seek_table.num_points = (num_points + step - 1) / step;
+	if(!reserve_seek_table_(decoder))
+		return false;
+	for(i = 0, j = 0; i < num_points; i++) {
+		if(!FLAC__bitreader_read_raw_uint64(decoder->private_->input, &xx, FLAC__STREAM_METADATA_SEEKPOINT_SAMPLE_NUMBER_LEN))
+			return false; /* read_callback_ sets the state for us */
+		point.sample_number = xx;
+
+		if(!FLAC__bitreader_read_raw_uint64(decoder->private_->input, &xx, FLAC__STREAM_METADATA_SEEKPOINT_STREAM_OFFSET_LEN))
+			return false; /* read_callback_ sets the state for us */
+		point.stream_offset = xx;
+
+		if(!FLAC__bitreader_read_raw_uint32(decoder->private_->input, &x, FLAC__STREAM_METADATA_SEEKPOINT_FRAME_SAMPLES_LEN))
+			return false; /* read_callback_ sets the state for us */
+		point.frame_samples = x;
+
+		if(i % step == 0)
+			decoder->private_->seek_table.data.seek_table.points[j++] = point;
+	}
+	length -= (num_points * FLAC__STREAM_METADATA_SEEKPOINT_LENGTH);
+#else  /* not mbed */
 	/* use realloc since we may pass through here several times (e.g. after seeking) */
 	if(0 == (decoder->private_->seek_table.data.seek_table.points = safe_realloc_mul_2op_(decoder->private_->seek_table.data.seek_table.points, decoder->private_->seek_table.data.seek_table.num_points, /*times*/sizeof(FLAC__StreamMetadata_SeekPoint)))) {
 		decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
@@ -1684,6 +1828,7 @@ FLAC__bool read_metadata_seektable_(FLAC__StreamDecoder *decoder, FLAC__bool is_
 		decoder->private_->seek_table.data.seek_table.points[i].frame_samples = x;
 	}
 	length -= (decoder->private_->seek_table.data.seek_table.num_points * FLAC__STREAM_METADATA_SEEKPOINT_LENGTH);
+#endif /* end mbed */
 	/* if there is a partial point left, skip over it */
 	if(length > 0) {
 		/*@@@ do a send_error_to_client_() here?  there's an argument for either way */
@@ -1714,7 +1859,11 @@ FLAC__bool read_metadata_vorbiscomment_(FLAC__StreamDecoder *decoder, FLAC__Stre
 			}
 			else
 				length -= obj->vendor_string.length;
+#if(1) /* mbed */
+			if (0 == (obj->vendor_string.entry = alloc_comment_(decoder, (size_t)obj->vendor_string.length + 1))) {
+#else  /* not mbed */
 			if (0 == (obj->vendor_string.entry = safe_malloc_add_2op_(obj->vendor_string.length, /*+*/1))) {
+#endif /* end mbed */
 				decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
 				return false;
 			}
@@ -1732,7 +1881,13 @@ FLAC__bool read_metadata_vorbiscomment_(FLAC__StreamDecoder *decoder, FLAC__Stre
 
 		/* read comments */
 		if (obj->num_comments > 0) {
+#if(1) /* mbed */
+			/* Every entry takes 4 bytes at least, so the loop below stores
+			 * length / 4 entries at most even if num_comments is broken. */
+			if (0 == (obj->comments = alloc_comment_(decoder, (obj->num_comments < length / 4 ? obj->num_comments : length / 4) * sizeof(FLAC__StreamMetadata_VorbisComment_Entry)))) {
+#else  /* not mbed */
 			if (0 == (obj->comments = safe_malloc_mul_2op_p(obj->num_comments, /*times*/sizeof(FLAC__StreamMetadata_VorbisComment_Entry)))) {
+#endif /* end mbed */
 				decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
 				return false;
 			}
@@ -1755,7 +1910,11 @@ FLAC__bool read_metadata_vorbiscomment_(FLAC__StreamDecoder *decoder, FLAC__Stre
 					}
 					else
 						length -= obj->comments[i].length;
+#if(1) /* mbed */
+					if (0 == (obj->comments[i].entry = alloc_comment_(decoder, (size_t)obj->comments[i].length + 1))) {
+#else  /* not mbed */
 					if (0 == (obj->comments[i].entry = safe_malloc_add_2op_(obj->comments[i].length, /*+*/1))) {
+#endif /* end mbed */
 						decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
 						return false;
 					}
@@ -1932,6 +2091,177 @@ FLAC__bool read_metadata_picture_(FLAC__StreamDecoder *decoder, FLAC__StreamMeta
 	return true;
 }
 
+#if(1) /* mbed */
+/*
+ * Skips the body of a metadata block.  If the client supplied seek and tell
+ * callbacks and the block is not already in the bitreader, the stream is
+ * repositioned past the block and the bitreader is emptied, so large blocks
+ * such as embedded cover art are never read from the media.  Otherwise the
+ * bytes are read and discarded as usual.
+ */
+FLAC__bool skip_metadata_block_(FLAC__StreamDecoder *decoder, unsigned length)
+{
+	FLAC__uint64 pos;
+	FLAC__StreamDecoderSeekStatus status;
+
+	if(
+		0 != decoder->private_->seek_callback &&
+		length > FLAC__stream_decoder_get_input_bytes_unconsumed(decoder) &&
+		FLAC__stream_decoder_get_decode_position(decoder, &pos)
+	) {
+		status = decoder->private_->seek_callback(decoder, pos + length, decoder->private_->client_data);
+		if(status == FLAC__STREAM_DECODER_SEEK_STATUS_OK)
+			return FLAC__bitreader_clear(decoder->private_->input);
+		if(status == FLAC__STREAM_DECODER_SEEK_STATUS_ERROR) {
+			decoder->protected_->state = FLAC__STREAM_DECODER_SEEK_ERROR;
+			return false;
+		}
+		/* FLAC__STREAM_DECODER_SEEK_STATUS_UNSUPPORTED: fall back to reading */
+	}
+	if(!FLAC__bitreader_skip_byte_block_aligned_no_crc(decoder->private_->input, length))
+		return false; /* read_callback_ sets the state for us */
+	return true;
+}
+
+/*
+ * Takes the internal buffer of md5context into private_->md5_buf, so that
+ * FLAC__MD5Final() and FLAC__MD5Init() do not free or forget it.
+ */
+void detach_md5_buffer_(FLAC__StreamDecoder *decoder)
+{
+	FLAC__MD5Context *ctx = &decoder->private_->md5context;
+
+	if(0 != ctx->internal_buf.p8) {
+		decoder->private_->md5_buf = ctx->internal_buf.p8;
+		decoder->private_->md5_capacity = ctx->capacity;
+		ctx->internal_buf.p8 = 0;
+		ctx->capacity = 0;
+	}
+}
+
+/*
+ * Frees the buffers which FLAC__stream_decoder_finish() keeps.  The
+ * bitreader buffer is freed by FLAC__bitreader_delete().
+ */
+void free_buffers_(FLAC__StreamDecoder *decoder)
+{
+	unsigned i;
+
+	for(i = 0; i < FLAC__MAX_CHANNELS; i++) {
+		if(0 != decoder->private_->output[i]) {
+			free(decoder->private_->output[i]-4);
+			decoder->private_->output[i] = 0;
+		}
+		if(0 != decoder->private_->residual_unaligned[i]) {
+			free(decoder->private_->residual_unaligned[i]);
+			decoder->private_->residual_unaligned[i] = decoder->private_->residual[i] = 0;
+		}
+	}
+	decoder->private_->output_capacity = 0;
+	decoder->private_->output_channels = 0;
+
+	if(0 != decoder->private_->md5_buf) {
+		free(decoder->private_->md5_buf);
+		decoder->private_->md5_buf = 0;
+		decoder->private_->md5_capacity = 0;
+	}
+
+	if(0 != decoder->private_->seek_table.data.seek_table.points) {
+		free(decoder->private_->seek_table.data.seek_table.points);
+		decoder->private_->seek_table.data.seek_table.points = 0;
+		decoder->private_->seek_table_capacity = 0;
+	}
+
+	if(0 != decoder->private_->comment_buf) {
+		free(decoder->private_->comment_buf);
+		decoder->private_->comment_buf = 0;
+		decoder->private_->comment_buf_capacity = 0;
+	}
+}
+
+/*
+ * Prepares private_->comment_buf for a VORBIS_COMMENT block of \a length
+ * bytes.  The buffer is enlarged only when the block can need more than
+ * ever; its contents are discarded.
+ */
+FLAC__bool reserve_comment_buf_(FLAC__StreamDecoder *decoder, unsigned length)
+{
+	/* Every entry takes 4 bytes of the block at least.  Each allocation of
+	 * alloc_comment_() adds a terminator and the alignment padding. */
+	const size_t align = sizeof(void*);
+	const size_t entries = length / 4 + 1;
+	const size_t size = length + (entries + 2) * align + entries * sizeof(FLAC__StreamMetadata_VorbisComment_Entry);
+
+	decoder->private_->comment_buf_used = 0;
+	if(size > decoder->private_->comment_buf_capacity) {
+		if(0 != decoder->private_->comment_buf)
+			free(decoder->private_->comment_buf);
+		decoder->private_->comment_buf_capacity = 0;
+		if(0 == (decoder->private_->comment_buf = malloc(size))) {
+			decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		decoder->private_->comment_buf_capacity = size;
+	}
+	return true;
+}
+
+/*
+ * Allocates private_->seek_table for FLAC__STREAM_DECODER_MAX_SEEK_POINTS
+ * points, once.
+ */
+FLAC__bool reserve_seek_table_(FLAC__StreamDecoder *decoder)
+{
+	if(0 == decoder->private_->seek_table.data.seek_table.points) {
+		if(0 == (decoder->private_->seek_table.data.seek_table.points = safe_malloc_mul_2op_p(FLAC__STREAM_DECODER_MAX_SEEK_POINTS, /*times*/sizeof(FLAC__StreamMetadata_SeekPoint)))) {
+			decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		decoder->private_->seek_table_capacity = FLAC__STREAM_DECODER_MAX_SEEK_POINTS;
+	}
+	return true;
+}
+
+/*
+ * Enlarges private_->md5_buf for the frames of \a blocksize samples of
+ * \a channels channels at the maximum sample size, as FLAC__MD5Accumulate()
+ * would.
+ */
+FLAC__bool reserve_md5_buf_(FLAC__StreamDecoder *decoder, unsigned blocksize, unsigned channels)
+{
+	const size_t size = (size_t)blocksize * channels * ((FLAC__MAX_BITS_PER_SAMPLE + 7) / 8);
+
+	if(size > decoder->private_->md5_capacity) {
+		if(0 != decoder->private_->md5_buf)
+			free(decoder->private_->md5_buf);
+		decoder->private_->md5_capacity = 0;
+		if(0 == (decoder->private_->md5_buf = safe_malloc_(size))) {
+			decoder->protected_->state = FLAC__STREAM_DECODER_MEMORY_ALLOCATION_ERROR;
+			return false;
+		}
+		decoder->private_->md5_capacity = size;
+	}
+	return true;
+}
+
+/*
+ * Allocates \a size bytes from private_->comment_buf.  Returns 0 if the
+ * buffer is exhausted.
+ */
+void *alloc_comment_(FLAC__StreamDecoder *decoder, size_t size)
+{
+	const size_t align = sizeof(void*);
+	void *p;
+
+	size = (size + align - 1) & ~(align - 1);
+	if(size > decoder->private_->comment_buf_capacity - decoder->private_->comment_buf_used)
+		return 0;
+	p = decoder->private_->comment_buf + decoder->private_->comment_buf_used;
+	decoder->private_->comment_buf_used += size;
+	return p;
+}
+#endif /* end mbed */
+
 FLAC__bool skip_id3v2_tag_(FLAC__StreamDecoder *decoder)
 {
 	FLAC__uint32 x;
@@ -26,33 +26,20 @@
 #include "misratypes.h"
 
 #include "key.h"
+#include "key_sw.h"
 #include "key_cmd.h"
 #include "system.h"
+#include "disp_uart.h"
 
 /*--- Macro definition of key thread ---*/
-#define PROC_CYCLE_SW       (10u)   /* The process cycle of SW module */
-#define PROC_CYCLE_TFT      (50u)   /* The process cycle of TFT module */
-#define PROC_CYCLE_CMD      (2u)    /* The process cycle of command-line module */
-#define PROC_CYCLE_REFRESH  (50u)   /* Refresh cycle of counter */
-#define UNIT_TIME_MS        (2u)
-
-#define PROC_CNT_SW         (PROC_CYCLE_SW / UNIT_TIME_MS)      /* Counter for 10ms period */
-#define PROC_CNT_TFT        (PROC_CYCLE_TFT / UNIT_TIME_MS)     /* Counter for 50ms period */
-#define PROC_CNT_CMD        (PROC_CYCLE_CMD / UNIT_TIME_MS)     /* Counter for 2ms period */
-#define PROC_CNT_REFRESH    (PROC_CYCLE_REFRESH / UNIT_TIME_MS) /* Counter for 50ms period */
-
-/*--- Macro definition of SW module ---*/
-#define SW0_ACTIVE_LEVEL    (0)
-#define SW0_DECISION_TIME   (50u)   /* Time until the decision of the input status. */
-#define SW0_DECISION_CNT    (SW0_DECISION_TIME / PROC_CYCLE_SW) /* Counter for 50ms period */
+/* Signals to the key thread. They are set in the interrupts. */
+#define SIG_SW              (0x00000001)    /* Edge of SW0 */
+#define SIG_CMD             (0x00000002)    /* Reception from command-line */
+#define SIG_TFT             (0x00000004)    /* Input from TFT. (No interrupt sets it yet.) */
 
-/*--- User defined types ---*/
-/* Control data of SW module */
-typedef struct {
-    uint32_t        sampling_count; /* Sampling count for decision of input. */
-    bool            current_status; /* Current input status. true=push, false=release. */
-} sw_ctrl_t;
+#define US_TO_MS            (1000u)
 
+/*--- User defined types ---*/
 /* Control data of TFT module */
 typedef struct {
     uint32_t        dummy;
@@ -65,112 +52,142 @@ typedef struct {
     cmd_ctrl_t      cmd_data;
 } key_ctrl_t;
 
-static void sw_init_proc(sw_ctrl_t * const p_ctrl);
-static SYS_KeyCode sw_main_proc(sw_ctrl_t * const p_ctrl);
+static osThreadId   key_thread_id = NULL;
+
+static void sw_irq_handler(void);
+static void cmd_rx_callback(void);
+static uint32_t get_time_ms(void);
 static void tft_init_proc(tft_ctrl_t * const p_ctrl);
 static SYS_KeyCode tft_main_proc(tft_ctrl_t * const p_ctrl);
 
 void key_thread(void const *argument)
 {
     static key_ctrl_t   key_data;
+    static InterruptIn  sw0(P6_0);
     SYS_KeyCode         key_ev;
     SYS_KeyCode         tmp_ev;
-    uint32_t            cnt = 0u;
+    osEvent             evt;
+    int32_t             signals;
+    uint32_t            wait_ms;
+    uint32_t            now_ms;
+    bool                result;
 
     UNUSED_ARG(argument);
     
     /* Initializes the control data of key thread. */
-    sw_init_proc(&key_data.sw_data);
+    key_thread_id = Thread::gettid();
+    sw_init_proc(&key_data.sw_data, get_time_ms());
     tft_init_proc(&key_data.tft_data);
     cmd_init_proc(&key_data.cmd_data);
+
+    /* The interrupts wake up the key thread. No periodic wake-up is used. */
+    sw0.rise(&sw_irq_handler);
+    sw0.fall(&sw_irq_handler);
+    dsp_uart_set_rx_callback(&cmd_rx_callback);
+    signals = SIG_CMD;          /* Reads the characters received before. */
     while(1) {
         key_ev = SYS_KEYCODE_NON;
-        /* Is it a timing of the SW module processing? */
-        if((cnt % PROC_CNT_SW) == 0u) {
-            /* Executes main process of SW module. */
-            tmp_ev = sw_main_proc(&key_data.sw_data);
-            if(tmp_ev != SYS_KEYCODE_NON) {
-                key_ev = tmp_ev;
-            }
+        now_ms = get_time_ms();
+        /* Is the input of SW0 changed? */
+        if ((signals & SIG_SW) != 0) {
+            sw_edge_proc(&key_data.sw_data, now_ms);
+        }
+        /* Executes main process of SW module. */
+        /* The input status is decided when the decision time is passed. */
+        tmp_ev = sw_main_proc(&key_data.sw_data, sw0.read(), now_ms);
+        if (tmp_ev != SYS_KEYCODE_NON) {
+            key_ev = tmp_ev;
         }
-        /* Is it a timing of TFT module processing? */
-        if((cnt % PROC_CNT_TFT) == 0u) {
+        /* Is there the input from TFT? */
+        if ((signals & SIG_TFT) != 0) {
             /* Executes main process of TFT module. */
             tmp_ev = tft_main_proc(&key_data.tft_data);
-            if(tmp_ev != SYS_KEYCODE_NON) {
-                if(key_ev == SYS_KEYCODE_NON) {
+            if (tmp_ev != SYS_KEYCODE_NON) {
+                if (key_ev == SYS_KEYCODE_NON) {
                     /* There is no input from other modules. */
                     key_ev = tmp_ev;
                 }
             }
         }
-        /* Is it a timing of command-line module processing? */
-        if((cnt % PROC_CNT_CMD) == 0u) {
+        /* Is there the input from command-line? */
+        if ((signals & SIG_CMD) != 0) {
             /* Executes main process of command-line module. */
             tmp_ev = cmd_main_proc(&key_data.cmd_data);
-            if(tmp_ev != SYS_KEYCODE_NON) {
-                if(key_ev == SYS_KEYCODE_NON) {
+            if (tmp_ev != SYS_KEYCODE_NON) {
+                if (key_ev == SYS_KEYCODE_NON) {
                     /* There is no input from other modules. */
                     key_ev = tmp_ev;
                 }
             }
-        }
-        /* Is it a refresh timing of the counter? */
-        if(cnt >= PROC_CNT_REFRESH) {
-            cnt = 0u;
+            if (dsp_uart_readable() == true) {
+                /* The rest of the received characters is read in the next loop. */
+                (void) osSignalSet(key_thread_id, SIG_CMD);
+            }
         }
         /* When the event occurs, this mail is sent to main thread. */
-        if(key_ev != SYS_KEYCODE_NON) {
+        if (key_ev != SYS_KEYCODE_NON) {
             (void) sys_notify_key_input(key_ev);
         }
-        Thread::wait(UNIT_TIME_MS);
-        cnt++;
+        /* Waits for the interrupts. */
+        /* The timeout is used only while the input status of SW0 is not decided. */
+        result = sw_get_wait_time(&key_data.sw_data, get_time_ms(), &wait_ms);
+        if (result != true) {
+            wait_ms = osWaitForever;
+        }
+        evt = Thread::signal_wait(0, wait_ms);
+        if (evt.status == osEventSignal) {
+            signals = evt.value.signals;
+        } else {
+            signals = 0;
+        }
     }
 }
 
-/** Initialises SW module
+/** Interrupt handler of the edge of SW0
  *
- *  @param p_ctrl Pointer to the control data of SW module.
  */
-static void sw_init_proc(sw_ctrl_t * const p_ctrl)
+static void sw_irq_handler(void)
 {
-    if (p_ctrl != NULL) {
-        p_ctrl->sampling_count = 0u;
-        p_ctrl->current_status = false;
+    if (key_thread_id != NULL) {
+        (void) osSignalSet(key_thread_id, SIG_SW);
+    }
+}
+
+/** Callback function of the reception from command-line
+ *
+ *  It is called in the receive interrupt.
+ */
+static void cmd_rx_callback(void)
+{
+    if (key_thread_id != NULL) {
+        (void) osSignalSet(key_thread_id, SIG_CMD);
     }
 }
 
-/** Executes the main processing of SW module
+/** Gets the current time in ms
  *
- *  @param p_ctrl Pointer to the control data of SW module.
+ *  The time is counted up by the difference of the microsecond ticker, so
+ *  the difference of the returned values is correct across the wrap-around.
+ *  The key thread must call it at least once in about 71 minutes
+ *  while the difference is used.
  *
  *  @returns 
- *    Key code.
+ *    Current time in ms.
  */
-static SYS_KeyCode sw_main_proc(sw_ctrl_t * const p_ctrl)
+static uint32_t get_time_ms(void)
 {
-    SYS_KeyCode         key_ev = SYS_KEYCODE_NON;
-    int32_t             pin_level;
-    static DigitalIn    sw0(P6_0);
-
-    if (p_ctrl != NULL) {
-        pin_level = sw0.read();
-        if (pin_level == SW0_ACTIVE_LEVEL) {
-            /* SW0 is pushed. */
-            if (p_ctrl->sampling_count < SW0_DECISION_CNT) {
-                p_ctrl->sampling_count++;
-                if (p_ctrl->sampling_count == SW0_DECISION_CNT) {
-                    key_ev = SYS_KEYCODE_PLAYPAUSE;
-                }
-            }
-            p_ctrl->current_status = true;
-        } else {
-            /* SW0 is released. */
-            p_ctrl->sampling_count = 0u;
-            p_ctrl->current_status = false;
-        }
-    }
-    return key_ev;
+    static uint32_t     last_us = 0u;
+    static uint32_t     rest_us = 0u;
+    static uint32_t     time_ms = 0u;
+    uint32_t            now_us;
+    uint32_t            diff_us;
+
+    now_us = us_ticker_read();
+    diff_us = (now_us - last_us) + rest_us;
+    last_us = now_us;
+    time_ms += diff_us / US_TO_MS;
+    rest_us = diff_us % US_TO_MS;
+    return time_ms;
 }
 
 /** Initialises TFT module
@@ -28,6 +28,7 @@
 #include "key_cmd.h"
 #include "system.h"
 #include "display.h"
+#include "disp_uart.h"
 
 /*--- Macro definition ---*/
 #define CHR_BS              '\b'        /* 0x08: BACKSPACE */
@@ -45,10 +46,21 @@
 #define CMD_PLAYINFO        "PLAYINFO"  /* Play info */
 #define CMD_REPEAT          "REPEAT"    /* Repeat */
 #define CMD_HELP            "HELP"      /* Help */
+#define CMD_VOLUP           "VOLUP"     /* Volume up */
+#define CMD_VOLDOWN         "VOLDOWN"   /* Volume down */
+#define CMD_MUTE            "MUTE"      /* Mute */
+#define CMD_XFADE           "XFADE"     /* Crossfade */
+#define CMD_METER           "METER"     /* Level meter */
+#define CMD_EQ              "EQ"        /* Equalizer */
 
-#define VALID_CMD_NUM       (7u)
+/* Argument of the command */
+#define ARG_EQ_FLAT         "FLAT"      /* Equalizer off */
+#define ARG_EQ_BASS         "BASS"      /* Equalizer preset: bass boost */
+#define ARG_EQ_TREBLE       "TREBLE"    /* Equalizer preset: treble boost */
 
-#define MAX_CNT_OF_ARG      (1u)
+#define VALID_CMD_NUM       (15u)
+
+#define MAX_CNT_OF_ARG      (2u)        /* Command name and one argument */
 
 #define MSG_UNKNOWN_CMD     "command not found"
 
@@ -58,10 +70,9 @@ typedef struct {
     uint32_t        argc;
 } split_str_t;
 
-static Serial pc_in(USBTX, USBRX);
-
 static void clear_input_string(cmd_ctrl_t * const p);
 static bool read_data(cmd_ctrl_t * const p);
+static bool edit_input_string(cmd_ctrl_t * const p, const int32_t c);
 static bool split_input_string(split_str_t * const p,
                         const char_t * const p_inp_str, const uint32_t inp_len);
 static SYS_KeyCode parse_input_string(const split_str_t * const p);
@@ -69,7 +80,6 @@ static SYS_KeyCode parse_input_string(const split_str_t * const p);
 void cmd_init_proc(cmd_ctrl_t * const p_ctrl)
 {
     if (p_ctrl != NULL) {
-        pc_in.baud(DSP_PC_COM_BAUDRATE);
         clear_input_string(p_ctrl);
     }
 }
@@ -112,6 +122,9 @@ static void clear_input_string(cmd_ctrl_t * const p)
 }
 
 /** Reads the input character string from command-line
+ *
+ *  Reads the received characters until the end of the input is detected
+ *  or no character remains.
  *
  *  @param p Pointer to the control data of command-line module.
  *
@@ -121,38 +134,60 @@ static void clear_input_string(cmd_ctrl_t * const p)
 static bool read_data(cmd_ctrl_t * const p)
 {
     bool            ret = false;
+    bool            is_read = false;
     int32_t         c;
 
     if (p != NULL) {
-        if (pc_in.readable() == true) {
-            c = pc_in.getc();
-            if ((PRINT_CHR_MIN <= c) && (c <= PRINT_CHR_MAX)) {
-                /* The character of "c" variable can print.  */
-                /* Checks the length except the null terminal character. */
-                if (p->inp_len < ((sizeof(p->inp_str)/sizeof(p->inp_str[0])) - 1u)) {
-                    p->inp_str[p->inp_len] = (char_t)c;
-                    p->inp_len++;
+        while ((ret == false) && (dsp_uart_readable() == true)) {
+            c = dsp_uart_getc();
+            ret = edit_input_string(p, c);
+            is_read = true;
+        }
+        if (is_read == true) {
+            /* Sends the input character string to display thread. */
+            (void) dsp_notify_input_string(p->inp_str, ret);
+        }
+    }
+    return ret;
+}
+
+/** Edits the input character string by the received character
+ *
+ *  @param p Pointer to the control data of command-line module.
+ *  @param c Received character.
+ *
+ *  @returns 
+ *    true if the end of the input is detected.
+ */
+static bool edit_input_string(cmd_ctrl_t * const p, const int32_t c)
+{
+    bool            ret = false;
+
+    if (p != NULL) {
+        if ((PRINT_CHR_MIN <= c) && (c <= PRINT_CHR_MAX)) {
+            /* The character of "c" variable can print.  */
+            /* Checks the length except the null terminal character. */
+            if (p->inp_len < ((sizeof(p->inp_str)/sizeof(p->inp_str[0])) - 1u)) {
+                p->inp_str[p->inp_len] = (char_t)c;
+                p->inp_len++;
+                p->inp_str[p->inp_len] = '\0';
+            } else {
+                /* Because buffer is full, "c" variable is canceled. */
+            }
+        } else {
+            /* The character of "c" variable can not print.  */
+            if ((c == CHR_CR) || (c == CHR_LF) || (c == '\0')) {
+                /* Detected the end of the input from command-line. */
+                ret = true;
+            } else if (c == CHR_BS) {
+                /* Deletes one character. */
+                if (p->inp_len > 0u) {
+                    p->inp_len--;
                     p->inp_str[p->inp_len] = '\0';
-                } else {
-                    /* Because buffer is full, "c" variable is canceled. */
                 }
             } else {
-                /* The character of "c" variable can not print.  */
-                if ((c == CHR_CR) || (c == CHR_LF) || (c == '\0')) {
-                    /* Detected the end of the input from command-line. */
-                    ret = true;
-                } else if (c == CHR_BS) {
-                    /* Deletes one character. */
-                    if (p->inp_len > 0u) {
-                        p->inp_len--;
-                        p->inp_str[p->inp_len] = '\0';
-                    }
-                } else {
-                    /* DO NOTHING */
-                }
+                /* DO NOTHING */
             }
-            /* Sends the input character string to display thread. */
-            (void) dsp_notify_input_string(p->inp_str, ret);
         }
     }
     return ret;
@@ -223,28 +258,48 @@ static SYS_KeyCode parse_input_string(const split_str_t * const p)
 {
     SYS_KeyCode         key_ret = SYS_KEYCODE_NON;
     const char_t        *p_str;
+    const char_t        *p_arg;
     uint32_t            max_len;
     uint32_t            i;
     struct {
         const char_t    *p_cmd;
+        const char_t    *p_arg;     /* NULL if the command has no argument. */
         SYS_KeyCode     key_ev;
     } static const cmd_list[VALID_CMD_NUM] = {
-        {   CMD_STOP,       SYS_KEYCODE_STOP        },
-        {   CMD_PLAYPAUSE,  SYS_KEYCODE_PLAYPAUSE   },
-        {   CMD_NEXT,       SYS_KEYCODE_NEXT        },
-        {   CMD_PREV,       SYS_KEYCODE_PREV        },
-        {   CMD_PLAYINFO,   SYS_KEYCODE_PLAYINFO    },
-        {   CMD_REPEAT,     SYS_KEYCODE_REPEAT      },
-        {   CMD_HELP,       SYS_KEYCODE_HELP        }
+        {   CMD_STOP,       NULL,           SYS_KEYCODE_STOP        },
+        {   CMD_PLAYPAUSE,  NULL,           SYS_KEYCODE_PLAYPAUSE   },
+        {   CMD_NEXT,       NULL,           SYS_KEYCODE_NEXT        },
+        {   CMD_PREV,       NULL,           SYS_KEYCODE_PREV        },
+        {   CMD_PLAYINFO,   NULL,           SYS_KEYCODE_PLAYINFO    },
+        {   CMD_REPEAT,     NULL,           SYS_KEYCODE_REPEAT      },
+        {   CMD_HELP,       NULL,           SYS_KEYCODE_HELP        },
+        {   CMD_VOLUP,      NULL,           SYS_KEYCODE_VOLUP       },
+        {   CMD_VOLDOWN,    NULL,           SYS_KEYCODE_VOLDOWN     },
+        {   CMD_MUTE,       NULL,           SYS_KEYCODE_MUTE        },
+        {   CMD_XFADE,      NULL,           SYS_KEYCODE_XFADE       },
+        {   CMD_METER,      NULL,           SYS_KEYCODE_METER       },
+        {   CMD_EQ,         ARG_EQ_FLAT,    SYS_KEYCODE_EQ_FLAT     },
+        {   CMD_EQ,         ARG_EQ_BASS,    SYS_KEYCODE_EQ_BASS     },
+        {   CMD_EQ,         ARG_EQ_TREBLE,  SYS_KEYCODE_EQ_TREBLE   }
     };
 
     if (p != NULL) {
-        if (p->argc == MAX_CNT_OF_ARG) {
+        if ((p->argc > 0u) && (p->argc <= MAX_CNT_OF_ARG)) {
             p_str = p->argv[0];
+            p_arg = (p->argc > 1u) ? p->argv[1] : NULL;
             max_len = sizeof(p->argv[0])/sizeof(p->argv[0][0]);
             for (i = 0u; (i < VALID_CMD_NUM) && (key_ret == SYS_KEYCODE_NON); i++) {
-                if (strncasecmp(cmd_list[i].p_cmd, p_str, max_len) == 0) {
+                if (strncasecmp(cmd_list[i].p_cmd, p_str, max_len) != 0) {
+                    /* DO NOTHING */
+                } else if ((cmd_list[i].p_arg == NULL) || (p_arg == NULL)) {
+                    /* Both have no argument, or the argument is missing or extra. */
+                    if (cmd_list[i].p_arg == p_arg) {
+                        key_ret = cmd_list[i].key_ev;
+                    }
+                } else if (strncasecmp(cmd_list[i].p_arg, p_arg, max_len) == 0) {
                     key_ret = cmd_list[i].key_ev;
+                } else {
+                    /* DO NOTHING */
                 }
             }
         }
@@ -45,6 +45,9 @@ typedef struct {
 void cmd_init_proc(cmd_ctrl_t * const p_ctrl);
 
 /** Executes the main processing of command-line module
+ *
+ *  Reads the received characters up to the end of one input.
+ *  The rest of the characters is read by the next call.
  *
  *  @param p_ctrl Pointer to the control data of command-line module.
  *
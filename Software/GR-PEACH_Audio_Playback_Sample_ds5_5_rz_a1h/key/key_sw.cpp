@@ -0,0 +1,90 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "misratypes.h"
+
+#include "key_sw.h"
+
+void sw_init_proc(sw_ctrl_t * const p_ctrl, const uint32_t now_ms)
+{
+    if (p_ctrl != NULL) {
+        /* The input status at the start is decided in the same way as the edge. */
+        p_ctrl->is_pending = true;
+        p_ctrl->edge_time = now_ms;
+        p_ctrl->current_status = false;
+    }
+}
+
+void sw_edge_proc(sw_ctrl_t * const p_ctrl, const uint32_t now_ms)
+{
+    if (p_ctrl != NULL) {
+        /* The chattering restarts the decision time. */
+        p_ctrl->is_pending = true;
+        p_ctrl->edge_time = now_ms;
+    }
+}
+
+SYS_KeyCode sw_main_proc(sw_ctrl_t * const p_ctrl, const int32_t pin_level, 
+                                                    const uint32_t now_ms)
+{
+    SYS_KeyCode         key_ev = SYS_KEYCODE_NON;
+
+    if (p_ctrl != NULL) {
+        if ((p_ctrl->is_pending == true) && 
+            ((now_ms - p_ctrl->edge_time) >= SW_DECISION_TIME)) {
+            /* The input level was stable during the decision time. */
+            p_ctrl->is_pending = false;
+            if (pin_level == SW_ACTIVE_LEVEL) {
+                /* SW0 is pushed. */
+                if (p_ctrl->current_status == false) {
+                    key_ev = SYS_KEYCODE_PLAYPAUSE;
+                }
+                p_ctrl->current_status = true;
+            } else {
+                /* SW0 is released. */
+                p_ctrl->current_status = false;
+            }
+        }
+    }
+    return key_ev;
+}
+
+bool sw_get_wait_time(const sw_ctrl_t * const p_ctrl, const uint32_t now_ms, 
+                                                    uint32_t * const p_wait_ms)
+{
+    bool                ret = false;
+    uint32_t            elapsed;
+
+    if ((p_ctrl != NULL) && (p_wait_ms != NULL)) {
+        if (p_ctrl->is_pending == true) {
+            elapsed = now_ms - p_ctrl->edge_time;
+            if (elapsed < SW_DECISION_TIME) {
+                *p_wait_ms = SW_DECISION_TIME - elapsed;
+            } else {
+                *p_wait_ms = 0u;
+            }
+            ret = true;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef KEY_SW_H
+#define KEY_SW_H
+
+#include "r_typedefs.h"
+#include "system.h"
+
+/*--- Macro definition ---*/
+#define SW_ACTIVE_LEVEL     (0)     /* Input level when the switch is pushed. */
+#define SW_DECISION_TIME    (50u)   /* Time in ms until the decision of the input status. */
+
+/*--- User defined types ---*/
+/* Control data of SW module */
+typedef struct {
+    bool            is_pending;     /* Waits for the decision of the input status. */
+    uint32_t        edge_time;      /* Time in ms of the last edge of the input. */
+    bool            current_status; /* Current input status. true=push, false=release. */
+} sw_ctrl_t;
+
+/** Initialises SW module
+ *
+ *  The input status is decided SW_DECISION_TIME after the initialisation.
+ *
+ *  @param p_ctrl Pointer to the control data of SW module.
+ *  @param now_ms Current time in ms.
+ */
+void sw_init_proc(sw_ctrl_t * const p_ctrl, const uint32_t now_ms);
+
+/** Notifies SW module of the edge of the input
+ *
+ *  The decision of the input status is postponed until the input level
+ *  does not change for SW_DECISION_TIME.
+ *
+ *  @param p_ctrl Pointer to the control data of SW module.
+ *  @param now_ms Current time in ms.
+ */
+void sw_edge_proc(sw_ctrl_t * const p_ctrl, const uint32_t now_ms);
+
+/** Executes the main processing of SW module
+ *
+ *  @param p_ctrl Pointer to the control data of SW module.
+ *  @param pin_level Current input level of the switch.
+ *  @param now_ms Current time in ms.
+ *
+ *  @returns 
+ *    Key code. SYS_KEYCODE_PLAYPAUSE when the push of the switch is decided.
+ */
+SYS_KeyCode sw_main_proc(sw_ctrl_t * const p_ctrl, const int32_t pin_level, 
+                                                    const uint32_t now_ms);
+
+/** Gets the time until the decision of the input status
+ *
+ *  @param p_ctrl Pointer to the control data of SW module.
+ *  @param now_ms Current time in ms.
+ *  @param p_wait_ms Pointer to store the time in ms.
+ *
+ *  @returns 
+ *    true if the decision is waited. false if SW module waits for no time.
+ */
+bool sw_get_wait_time(const sw_ctrl_t * const p_ctrl, const uint32_t now_ms, 
+                                                    uint32_t * const p_wait_ms);
+
+#endif /* KEY_SW_H */
@@ -35,6 +35,7 @@ int main(void)
     Thread audio_task  (aud_thread, NULL, osPriorityHigh,        AUD_STACK_SIZE);
     Thread decode_task (dec_thread, NULL, osPriorityAboveNormal, DEC_STACK_SIZE);
     Thread key_task    (key_thread, NULL, osPriorityBelowNormal, KEY_STACK_SIZE);
+    Thread attach_task (sys_attach_thread, NULL, osPriorityBelowNormal, SYS_ATTACH_STACK_SIZE);
 
     while(1) {
         system_main();
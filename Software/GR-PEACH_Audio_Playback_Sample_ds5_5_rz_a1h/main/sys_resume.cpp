@@ -0,0 +1,371 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "mbed.h"
+#include "sys_resume.h"
+
+/*--- Macro definition ---*/
+#define RECORD_MAGIC            (0x31534552u)   /* "RES1" */
+#define CRC32_INIT              (0xFFFFFFFFu)
+#define CRC32_POLY              (0xEDB88320u)   /* Reflected polynomial of CRC-32 */
+#define MS_TO_US                (1000u)
+#define SEQ_NON                 (0u)            /* The first record has 1. */
+
+/*--- User defined types ---*/
+/* Record written to a slot */
+typedef struct {
+    uint32_t            magic;      /* RECORD_MAGIC */
+    uint32_t            seq;        /* Sequence number */
+    uint32_t            crc;        /* CRC-32 of "seq" and "state" */
+    sys_resume_state_t  state;
+} record_t;
+
+static bool read_record(sys_resume_t * const p_resume, const uint32_t slot, 
+                                                    record_t * const p_rec);
+static bool write_record(sys_resume_t * const p_resume, const uint32_t slot, 
+                                                    const record_t * const p_rec);
+static uint32_t get_slot_addr(const sys_resume_t * const p_resume, const uint32_t slot);
+static uint32_t get_record_crc(const record_t * const p_rec);
+static uint32_t calc_crc32(uint32_t crc, const uint8_t * const p_data, const uint32_t size);
+static void copy_state(sys_resume_state_t * const p_dst, const sys_resume_state_t * const p_src);
+static uint32_t round_up(const uint32_t value, const uint32_t unit);
+
+bool sys_resume_open(sys_resume_t * const p_resume, BlockDevice * const p_bd)
+{
+    bool            ret = false;
+    bool            result;
+    int             err;
+    uint32_t        slot;
+    uint32_t        latest;
+    uint32_t        erase_size;
+    uint32_t        block_num;
+    record_t        rec;
+
+    if ((p_resume != NULL) && (p_bd != NULL)) {
+        p_resume->p_bd = NULL;
+        p_resume->is_valid = false;
+        p_resume->is_time_valid = false;
+        p_resume->write_cnt = 0u;
+        err = p_bd->init();
+        if (err == 0) {
+            /* A slot is the record rounded up to the program size. */
+            p_resume->slot_size = round_up(sizeof(record_t), (uint32_t)p_bd->get_program_size());
+            p_resume->slot_size = round_up(p_resume->slot_size, (uint32_t)p_bd->get_read_size());
+            erase_size = (uint32_t)p_bd->get_erase_size();
+            if (p_resume->slot_size <= erase_size) {
+                p_resume->block_size = erase_size;
+            } else {
+                p_resume->slot_size = round_up(p_resume->slot_size, erase_size);
+                p_resume->block_size = p_resume->slot_size;
+            }
+            p_resume->block_slot_num = p_resume->block_size / p_resume->slot_size;
+            block_num = (uint32_t)(p_bd->size() / p_resume->block_size);
+            p_resume->slot_num = block_num * p_resume->block_slot_num;
+            if ((p_resume->slot_size <= sizeof(p_resume->buf)) && (block_num >= 2u)) {
+                p_resume->p_bd = p_bd;
+                ret = true;
+            } else {
+                (void) p_bd->deinit();
+            }
+        }
+    }
+
+    if (ret == true) {
+        /* Finds the latest record. A torn record is skipped by its CRC. */
+        p_resume->seq = SEQ_NON;
+        latest = 0u;
+        for (slot = 0u; slot < p_resume->slot_num; slot++) {
+            result = read_record(p_resume, slot, &rec);
+            if ((result == true) && 
+                ((p_resume->is_valid != true) || ((int32_t)(rec.seq - p_resume->seq) > 0))) {
+                copy_state(&p_resume->state, &rec.state);
+                p_resume->seq = rec.seq;
+                p_resume->is_valid = true;
+                latest = slot;
+            }
+        }
+        /* The rest of the erase block of the latest record may have a torn */
+        /* record, so the next record is written to the next erase block. */
+        if (p_resume->is_valid == true) {
+            p_resume->next_slot = ((latest / p_resume->block_slot_num) + 1u) * p_resume->block_slot_num;
+            if (p_resume->next_slot >= p_resume->slot_num) {
+                p_resume->next_slot = 0u;
+            }
+        } else {
+            p_resume->next_slot = 0u;
+        }
+    }
+    return ret;
+}
+
+void sys_resume_close(sys_resume_t * const p_resume)
+{
+    if (p_resume != NULL) {
+        if (p_resume->p_bd != NULL) {
+            (void) p_resume->p_bd->deinit();
+            p_resume->p_bd = NULL;
+        }
+        p_resume->is_valid = false;
+    }
+}
+
+bool sys_resume_read(const sys_resume_t * const p_resume, sys_resume_state_t * const p_state)
+{
+    bool            ret = false;
+
+    if ((p_resume != NULL) && (p_state != NULL)) {
+        if ((p_resume->p_bd != NULL) && (p_resume->is_valid == true)) {
+            copy_state(p_state, &p_resume->state);
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+bool sys_resume_write(sys_resume_t * const p_resume, 
+        const sys_resume_state_t * const p_state, const bool force, const uint32_t now_us)
+{
+    bool            ret = false;
+    bool            result;
+    bool            is_due;
+    record_t        rec;
+
+    if ((p_resume != NULL) && (p_state != NULL) && (p_resume->p_bd != NULL)) {
+        /* The interval is counted from the first call after the open. */
+        if (p_resume->is_time_valid != true) {
+            p_resume->write_time = now_us;
+            p_resume->is_time_valid = true;
+        }
+        (void) memset(&rec, 0, sizeof(rec));
+        copy_state(&rec.state, p_state);
+        if (p_resume->is_valid != true) {
+            is_due = true;
+        } else if (memcmp(&rec.state, &p_resume->state, sizeof(rec.state)) == 0) {
+            /* Same as the latest record */
+            is_due = false;
+        } else if ((force == true) || 
+                   (strncmp(rec.state.path, p_resume->state.path, sizeof(rec.state.path)) != 0)) {
+            is_due = true;
+        } else if ((now_us - p_resume->write_time) >= (SYS_RESUME_WRITE_INTERVAL_MS * MS_TO_US)) {
+            is_due = true;
+        } else {
+            is_due = false;
+        }
+        if (is_due == true) {
+            rec.magic = RECORD_MAGIC;
+            rec.seq = p_resume->seq + 1u;
+            if (rec.seq == SEQ_NON) {
+                rec.seq++;
+            }
+            rec.crc = get_record_crc(&rec);
+            result = write_record(p_resume, p_resume->next_slot, &rec);
+            /* The slot is not used again until the next round even if the write failed. */
+            p_resume->next_slot++;
+            if (p_resume->next_slot >= p_resume->slot_num) {
+                p_resume->next_slot = 0u;
+            }
+            p_resume->write_time = now_us;
+            if (result == true) {
+                copy_state(&p_resume->state, &rec.state);
+                p_resume->seq = rec.seq;
+                p_resume->is_valid = true;
+                p_resume->write_cnt++;
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Reads the record of a slot
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param slot Slot number.
+ *  @param p_rec Pointer to store the record.
+ *
+ *  @returns 
+ *    true if the slot has a valid record. Otherwise false.
+ */
+static bool read_record(sys_resume_t * const p_resume, const uint32_t slot, 
+                                                    record_t * const p_rec)
+{
+    bool            ret = false;
+    int             err;
+
+    if ((p_resume != NULL) && (p_rec != NULL)) {
+        err = p_resume->p_bd->read(&p_resume->buf[0], 
+                            get_slot_addr(p_resume, slot), p_resume->slot_size);
+        if (err == 0) {
+            (void) memcpy(p_rec, &p_resume->buf[0], sizeof(record_t));
+            if ((p_rec->magic == RECORD_MAGIC) && (p_rec->seq != SEQ_NON) && 
+                (p_rec->crc == get_record_crc(p_rec))) {
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Writes a record to a slot
+ *
+ *  The erase block is erased before its first slot is written.
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param slot Slot number.
+ *  @param p_rec Pointer to the record.
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool write_record(sys_resume_t * const p_resume, const uint32_t slot, 
+                                                    const record_t * const p_rec)
+{
+    bool            ret = false;
+    int             err = 0;
+    uint32_t        addr;
+
+    if ((p_resume != NULL) && (p_rec != NULL)) {
+        addr = get_slot_addr(p_resume, slot);
+        if ((slot % p_resume->block_slot_num) == 0u) {
+            err = p_resume->p_bd->erase(addr, p_resume->block_size);
+        }
+        if (err == 0) {
+            (void) memset(&p_resume->buf[0], 0, p_resume->slot_size);
+            (void) memcpy(&p_resume->buf[0], p_rec, sizeof(record_t));
+            err = p_resume->p_bd->program(&p_resume->buf[0], addr, p_resume->slot_size);
+            if (err == 0) {
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Gets the address of a slot
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param slot Slot number.
+ *
+ *  @returns 
+ *    Address of the slot in the block device.
+ */
+static uint32_t get_slot_addr(const sys_resume_t * const p_resume, const uint32_t slot)
+{
+    uint32_t        addr = 0u;
+
+    if (p_resume != NULL) {
+        addr = ((slot / p_resume->block_slot_num) * p_resume->block_size) + 
+                ((slot % p_resume->block_slot_num) * p_resume->slot_size);
+    }
+    return addr;
+}
+
+/** Calculates the CRC of a record
+ *
+ *  @param p_rec Pointer to the record.
+ *
+ *  @returns 
+ *    CRC-32 of the sequence number and the state.
+ */
+static uint32_t get_record_crc(const record_t * const p_rec)
+{
+    uint32_t        crc = CRC32_INIT;
+
+    if (p_rec != NULL) {
+        crc = calc_crc32(crc, (const uint8_t *)&p_rec->seq, sizeof(p_rec->seq));
+        crc = calc_crc32(crc, (const uint8_t *)&p_rec->state, sizeof(p_rec->state));
+    }
+    return ~crc;
+}
+
+/** Calculates CRC-32
+ *
+ *  The record is written once per several seconds at most, so the CRC is
+ *  calculated bit by bit without the table.
+ *
+ *  @param crc CRC of the previous data.
+ *  @param p_data Pointer to the data.
+ *  @param size Size of the data in bytes.
+ *
+ *  @returns 
+ *    CRC including the data.
+ */
+static uint32_t calc_crc32(uint32_t crc, const uint8_t * const p_data, const uint32_t size)
+{
+    uint32_t        i;
+    uint32_t        bit;
+
+    if (p_data != NULL) {
+        for (i = 0u; i < size; i++) {
+            crc ^= (uint32_t)p_data[i];
+            for (bit = 0u; bit < 8u; bit++) {
+                if ((crc & 1u) != 0u) {
+                    crc = (crc >> 1) ^ CRC32_POLY;
+                } else {
+                    crc = (crc >> 1);
+                }
+            }
+        }
+    }
+    return crc;
+}
+
+/** Copies the state
+ *
+ *  The rest of the path after '\0' is cleared, so the states can be compared
+ *  by memcmp() and the CRC does not depend on it.
+ *
+ *  @param p_dst Pointer to the destination.
+ *  @param p_src Pointer to the source.
+ */
+static void copy_state(sys_resume_state_t * const p_dst, const sys_resume_state_t * const p_src)
+{
+    if ((p_dst != NULL) && (p_src != NULL)) {
+        (void) memset(p_dst, 0, sizeof(sys_resume_state_t));
+        (void) strncpy(p_dst->path, p_src->path, sizeof(p_dst->path) - 1u);
+        p_dst->sample = p_src->sample;
+        p_dst->volume = p_src->volume;
+        p_dst->mute = p_src->mute;
+        p_dst->repeat_mode = p_src->repeat_mode;
+        p_dst->xfade_mode = p_src->xfade_mode;
+        p_dst->meter_mode = p_src->meter_mode;
+    }
+}
+
+/** Rounds up a value to a multiple of the unit
+ *
+ *  @param value Value.
+ *  @param unit Unit. 0 is regarded as 1.
+ *
+ *  @returns 
+ *    Rounded value.
+ */
+static uint32_t round_up(const uint32_t value, const uint32_t unit)
+{
+    uint32_t        ret = value;
+
+    if (unit > 0u) {
+        ret = ((value + unit) - 1u) / unit * unit;
+    }
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+
+#ifndef SYS_RESUME_H
+#define SYS_RESUME_H
+
+#include "r_typedefs.h"
+#include "BlockDevice.h"
+
+/*--- Macro definition ---*/
+#define SYS_RESUME_PATH_SIZE        (128u)      /* Size of the track path including '\0' */
+#define SYS_RESUME_SLOT_MAX_SIZE    (512u)      /* Maximum size of a slot of the journal */
+/* Minimum interval of the writes which are not forced */
+#define SYS_RESUME_WRITE_INTERVAL_MS    (30000u)
+
+/*--- User defined types ---*/
+/* State to resume the playback */
+typedef struct {
+    char_t      path[SYS_RESUME_PATH_SIZE]; /* Path of the track from the root folder of the drive. */
+                                            /* "" if no track is selected. */
+    uint32_t    sample;         /* Position of the track in samples */
+    int32_t     volume;         /* Volume in dB */
+    uint8_t     mute;           /* Mute. 1 is on. */
+    uint8_t     repeat_mode;    /* Repeat mode. 1 is on. */
+    uint8_t     xfade_mode;     /* Crossfade mode. 1 is on. */
+    uint8_t     meter_mode;     /* Level meter mode. 1 is on. */
+} sys_resume_state_t;
+
+/* Journal of the resume state */
+/* The records are written to the slots of the block device in turn, so the */
+/* writes are spread over the block device. An erase block is erased when the */
+/* first slot of it is written. The latest record is always in another erase */
+/* block, so it is left if the power is lost during the write. */
+typedef struct {
+    BlockDevice         *p_bd;          /* NULL if the journal is not opened */
+    uint32_t            slot_size;      /* Size of a slot */
+    uint32_t            slot_num;       /* Number of the slots */
+    uint32_t            block_size;     /* Size of an erase block including the slots */
+    uint32_t            block_slot_num; /* Number of the slots in an erase block */
+    uint32_t            next_slot;      /* Slot to write the next record */
+    uint32_t            seq;            /* Sequence number of the latest record */
+    bool                is_valid;       /* true if "state" is the latest record */
+    sys_resume_state_t  state;          /* Latest record */
+    bool                is_time_valid;  /* true if "write_time" is set */
+    uint32_t            write_time;     /* Time of the last write in us */
+    uint32_t            write_cnt;      /* Number of the writes since the open */
+    uint8_t             buf[SYS_RESUME_SLOT_MAX_SIZE];  /* Work */
+} sys_resume_t;
+
+/** Opens the journal and recovers the latest record
+ *
+ *  All slots are read, and the valid record of the largest sequence number is
+ *  the latest record. The next record is written to the next erase block.
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param p_bd Pointer to the block device of the journal.
+ *              It must have 2 erase blocks or more.
+ *
+ *  @returns 
+ *    true if the journal is opened. false if the block device failed.
+ */
+bool sys_resume_open(sys_resume_t * const p_resume, BlockDevice * const p_bd);
+
+/** Closes the journal
+ *
+ *  @param p_resume Pointer to the journal.
+ */
+void sys_resume_close(sys_resume_t * const p_resume);
+
+/** Gets the latest record
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param p_state Pointer to store the latest record.
+ *
+ *  @returns 
+ *    true if the journal has a record. Otherwise false.
+ */
+bool sys_resume_read(const sys_resume_t * const p_resume, sys_resume_state_t * const p_state);
+
+/** Writes the state to the journal
+ *
+ *  The state equal to the latest record is not written. The change of the
+ *  position or the settings is batched, and it is written when
+ *  SYS_RESUME_WRITE_INTERVAL_MS passed from the last write. The change of the
+ *  track is written at once. The caller forces the write at the pause and
+ *  the stop, because the position does not change after them.
+ *
+ *  @param p_resume Pointer to the journal.
+ *  @param p_state Pointer to the state.
+ *  @param force true writes the changed state at once.
+ *  @param now_us Current time in us. It may wrap around.
+ *
+ *  @returns 
+ *    true if the state was written. Otherwise false.
+ */
+bool sys_resume_write(sys_resume_t * const p_resume, 
+        const sys_resume_state_t * const p_state, const bool force, const uint32_t now_us);
+
+#endif /* SYS_RESUME_H */
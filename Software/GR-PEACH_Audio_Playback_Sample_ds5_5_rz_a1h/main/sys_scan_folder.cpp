@@ -27,13 +27,19 @@
 #include "sys_scan_folder.h"
 
 /*--- Macro definition of folder structure scan. ---*/
-/* The character string to identify root directory. */
-#define STR_ROOT_FOR_F_OPENDIR  ""                      /* to use f_opendir() */
-#define STR_ROOT_FOR_FOPEN      "/" SYS_USB_MOUNT_NAME  /* to use fopen()  */
+/* The root directory of each drive is "/usb0", "/usb1" and so on. */
+/* It is used for both of opendir() and fopen(). */
+#define STR_ROOT_FORMAT         "/" SYS_USB_MOUNT_NAME "%lu"
+#define STR_ROOT_SIZE           (sizeof("/" SYS_USB_MOUNT_NAME "0"))
 
 /* The file extension of FLAC. */
 #define FILE_EXT_FLAC           ".flac"
 #define FILE_EXT_FLA            ".fla"
+/* The file extension of WAV and AIFF. */
+#define FILE_EXT_WAV            ".wav"
+#define FILE_EXT_AIF            ".aif"
+#define FILE_EXT_AIFF           ".aiff"
+#define FILE_EXT_AIFC           ".aifc"
 
 #define CHR_FULL_STOP           '.'         /* 0x2E: FULL STOP */
 #define CHR_SOLIDUS             '/'         /* 0x2F: SOLIDUS */
@@ -41,94 +47,243 @@
 #define OPEN_MODE_READ_ONLY     "r"
 
 /* File path maximum size including the usb mount name size */
-#define USB_MOUNT_NAME_SIZE     (sizeof(STR_ROOT_FOR_FOPEN "/"))
+#define USB_MOUNT_NAME_SIZE     (STR_ROOT_SIZE)
 #define FILE_PATH_MAX_LEN       (60u)
 #define FILE_PATH_MAX_SIZE      (USB_MOUNT_NAME_SIZE + FILE_PATH_MAX_LEN)
 
 static const char_t *get_full_path(fid_scan_folder_t * const p_info, 
                                                 const item_t * const p_item);
-static bool open_dir(fid_scan_folder_t * const p_info, 
-                        const item_t * const p_item, FATFS_DIR * const p_fdir);
-static bool read_dir(fid_scan_folder_t * const p_info, FATFS_DIR * const p_fdir, 
-                            const char_t ** const p_name, bool * const p_flag_dir);
+static DIR *open_dir(fid_scan_folder_t * const p_info, const item_t * const p_item);
+static bool read_dir(DIR * const p_dir, const char_t ** const p_name, 
+                                                    bool * const p_flag_dir);
 static bool regist_item(item_t * const p_item, 
                             const char_t * const p_name, const uint32_t parent);
 static bool check_extension(const char_t * const p_name);
 
 static bool check_folder_depth(const fid_scan_folder_t * const p_info, 
                                                     const uint32_t folder_id);
+static uint32_t get_root_folder(const fid_scan_folder_t * const p_info, 
+                                                    const uint32_t folder_id);
 
 void fid_init(fid_scan_folder_t * const p_info)
 {
+    uint32_t        i;
+
     if (p_info != NULL) {
         p_info->total_folder = 0u;
         p_info->total_track = 0u;
+        p_info->scan_folder = 0u;
+        for (i = 0u; i < SYS_MAX_DRIVE_NUM; i++) {
+            p_info->root_folder[i] = FOLD_ID_NOT_EXIST;
+        }
+    }
+}
+
+bool fid_scan_folder_struct(fid_scan_folder_t * const p_info, const uint32_t drive)
+{
+    bool            ret = false;
+    bool            result;
+
+    if (p_info != NULL) {
+        result = fid_add_drive(p_info, drive);
+        while (result == true) {
+            result = fid_scan_next_folder(p_info);
+        }
+
+        if (p_info->total_track > 0u) {
+            ret = true;
+        }
+    }
+
+    return ret;
+}
+
+bool fid_add_drive(fid_scan_folder_t * const p_info, const uint32_t drive)
+{
+    bool            ret = false;
+    char_t          root_name[STR_ROOT_SIZE];
+
+    if ((p_info != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        if ((p_info->root_folder[drive] == FOLD_ID_NOT_EXIST) && 
+            (p_info->total_folder < SYS_MAX_FOLDER_NUM)) {
+            /* Registers the root directory of the drive. */
+            /* It is scanned after the folders registered before it. */
+            (void) snprintf(root_name, sizeof(root_name), STR_ROOT_FORMAT, (unsigned long)drive);
+            ret = regist_item(&p_info->folder_list[p_info->total_folder], 
+                                                root_name, FOLD_ID_NOT_EXIST);
+            if (ret == true) {
+                p_info->root_folder[drive] = p_info->total_folder;
+                p_info->total_folder++;
+            }
+        }
+    }
+    return ret;
+}
+
+void fid_remove_drive(fid_scan_folder_t * const p_info, const uint32_t drive, 
+                            uint32_t * const p_trk_ids, const uint32_t trk_num)
+{
+    uint32_t        fold_map[SYS_MAX_FOLDER_NUM];
+    uint32_t        root;
+    uint32_t        parent;
+    uint32_t        i;
+    uint32_t        j;
+    uint32_t        fold_num;
+    uint32_t        cnt;
+    uint32_t        scan_cnt;
+
+    if ((p_info != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        root = p_info->root_folder[drive];
+        if (root < p_info->total_folder) {
+            /* Moves up the folders of the other drives. */
+            /* A parent folder is always registered before its child folders. */
+            fold_num = p_info->total_folder;
+            cnt = 0u;
+            scan_cnt = 0u;
+            for (i = 0u; i < fold_num; i++) {
+                parent = p_info->folder_list[i].parent_number;
+                if ((i == root) || 
+                    ((parent < i) && (fold_map[parent] == FOLD_ID_NOT_EXIST))) {
+                    fold_map[i] = FOLD_ID_NOT_EXIST;
+                } else {
+                    fold_map[i] = cnt;
+                    p_info->folder_list[cnt] = p_info->folder_list[i];
+                    if (parent < i) {
+                        p_info->folder_list[cnt].parent_number = fold_map[parent];
+                    }
+                    if (i < p_info->scan_folder) {
+                        scan_cnt++;
+                    }
+                    cnt++;
+                }
+            }
+            p_info->total_folder = cnt;
+            p_info->scan_folder = scan_cnt;
+            for (i = 0u; i < SYS_MAX_DRIVE_NUM; i++) {
+                if (i == drive) {
+                    p_info->root_folder[i] = FOLD_ID_NOT_EXIST;
+                } else if (p_info->root_folder[i] != FOLD_ID_NOT_EXIST) {
+                    p_info->root_folder[i] = fold_map[p_info->root_folder[i]];
+                } else {
+                    /* DO NOTHING */
+                }
+            }
+
+            /* Moves up the tracks of the other drives. */
+            cnt = 0u;
+            for (i = 0u; i < p_info->total_track; i++) {
+                if ((p_trk_ids != NULL) && (trk_num > 0u)) {
+                    for (j = 0u; j < trk_num; j++) {
+                        if (p_trk_ids[j] == i) {
+                            p_trk_ids[j] = cnt;
+                        }
+                    }
+                }
+                parent = p_info->track_list[i].parent_number;
+                if ((parent < fold_num) && (fold_map[parent] != FOLD_ID_NOT_EXIST)) {
+                    p_info->track_list[cnt] = p_info->track_list[i];
+                    p_info->track_list[cnt].parent_number = fold_map[parent];
+                    cnt++;
+                }
+            }
+            p_info->total_track = cnt;
+        }
     }
 }
 
-bool fid_scan_folder_struct(fid_scan_folder_t * const p_info)
+bool fid_is_drive_track(const fid_scan_folder_t * const p_info, 
+                            const uint32_t drive, const uint32_t track_id)
 {
     bool            ret = false;
+    uint32_t        root;
+
+    if ((p_info != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        if (track_id < p_info->total_track) {
+            root = get_root_folder(p_info, p_info->track_list[track_id].parent_number);
+            if ((root != FOLD_ID_NOT_EXIST) && (root == p_info->root_folder[drive])) {
+                ret = true;
+            }
+        }
+    }
+    return ret;
+}
+
+bool fid_is_drive_added(const fid_scan_folder_t * const p_info, const uint32_t drive)
+{
+    bool            ret = false;
+
+    if ((p_info != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        if (p_info->root_folder[drive] != FOLD_ID_NOT_EXIST) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+bool fid_scan_next_folder(fid_scan_folder_t * const p_info)
+{
     bool            result;
     bool            chk;
     uint32_t        i;
     item_t          *p_item;
-    FATFS_DIR       fdir;
+    DIR             *p_dir;
     const char_t    *p_name;
     bool            flg_dir;
     bool            chk_dep;
     
-    if (p_info != NULL) {
-        /* Initializes the scan data. */
-        p_info->total_track = 0u;
-        p_info->total_folder = 0u;
-
-        /* Registers the identifier of the root directory to use f_opendir(). */
-        (void) regist_item(&p_info->folder_list[0], STR_ROOT_FOR_F_OPENDIR, FOLD_ID_NOT_EXIST);
-        p_info->total_folder++;
-
-        /* Checks the item in all registered directory. */
-        for (i = 0; i < p_info->total_folder; i++) {
-            chk_dep = check_folder_depth(p_info, i);
-            result = open_dir(p_info, &p_info->folder_list[i], &fdir);
-            while (result == true) {
-                result = read_dir(p_info, &fdir, &p_name, &flg_dir);
-                if (result == true) {
-                    /* Checks the attribute of this item. */
-                    if (flg_dir == true) {
-                        /* This item is directory. */
-                        if ((chk_dep == true) && (p_info->total_folder < SYS_MAX_FOLDER_NUM)) {
-                            p_item = &p_info->folder_list[p_info->total_folder];
-                            chk = regist_item(p_item, p_name, i);
-                            if (chk == true) {
-                                /* Register of directory item was success. */
-                                p_info->total_folder++;
-                            }
+    if ((p_info != NULL) && (p_info->scan_folder < p_info->total_folder)) {
+        /* Checks the item in the next registered directory. */
+        i = p_info->scan_folder;
+        p_info->scan_folder++;
+        chk_dep = check_folder_depth(p_info, i);
+        p_dir = open_dir(p_info, &p_info->folder_list[i]);
+        result = (p_dir != NULL);
+        while (result == true) {
+            result = read_dir(p_dir, &p_name, &flg_dir);
+            if (result == true) {
+                /* Checks the attribute of this item. */
+                if (flg_dir == true) {
+                    /* This item is directory. */
+                    if ((chk_dep == true) && (p_info->total_folder < SYS_MAX_FOLDER_NUM)) {
+                        p_item = &p_info->folder_list[p_info->total_folder];
+                        chk = regist_item(p_item, p_name, i);
+                        if (chk == true) {
+                            /* Register of directory item was success. */
+                            p_info->total_folder++;
                         }
-                    } else {
-                        /* This item is file. */
-                        chk = check_extension(p_name);
-                        if ((chk == true) && (p_info->total_track < SYS_MAX_TRACK_NUM)) {
-                            /* This item is FLAC file. */
-                            p_item = &p_info->track_list[p_info->total_track];
-                            chk = regist_item(p_item, p_name, i);
-                            if (chk == true) {
-                                /* Register of file item was success. */
-                                p_info->total_track++;
-                            }
+                    }
+                } else {
+                    /* This item is file. */
+                    chk = check_extension(p_name);
+                    if ((chk == true) && (p_info->total_track < SYS_MAX_TRACK_NUM)) {
+                        /* This item is audio file. */
+                        p_item = &p_info->track_list[p_info->total_track];
+                        chk = regist_item(p_item, p_name, i);
+                        if (chk == true) {
+                            /* Register of file item was success. */
+                            p_info->total_track++;
                         }
                     }
                 }
             }
         }
-        /* Changes the identifier of the root directory to use fopen(). */
-        (void) regist_item(&p_info->folder_list[0], STR_ROOT_FOR_FOPEN, FOLD_ID_NOT_EXIST);
+        if (p_dir != NULL) {
+            (void) closedir(p_dir);
+        }
+    }
 
-        if (p_info->total_track > 0u) {
+    return fid_is_scanning(p_info);
+}
+
+bool fid_is_scanning(const fid_scan_folder_t * const p_info)
+{
+    bool            ret = false;
+
+    if (p_info != NULL) {
+        if (p_info->scan_folder < p_info->total_folder) {
             ret = true;
         }
     }
-
     return ret;
 }
 
@@ -173,6 +328,45 @@ const char_t *fid_get_track_name(const fid_scan_folder_t * const p_info,
     return p_name;
 }
 
+const char_t *fid_get_track_path(fid_scan_folder_t * const p_info, const uint32_t track_id)
+{
+    const char_t    *p_path = NULL;
+
+    if (p_info != NULL) {
+        if (track_id < p_info->total_track) {
+            p_path = get_full_path(p_info, &p_info->track_list[track_id]);
+        }
+    }
+    return p_path;
+}
+
+bool fid_find_track(fid_scan_folder_t * const p_info, const char_t * const p_path, 
+                            const uint32_t start_id, uint32_t * const p_trk_id)
+{
+    bool            ret = false;
+    uint32_t        i;
+    const char_t    *p_name;
+    const char_t    *p_full;
+
+    if ((p_info != NULL) && (p_path != NULL) && (p_trk_id != NULL)) {
+        p_name = strrchr(p_path, CHR_SOLIDUS);
+        if (p_name != NULL) {
+            p_name++;
+            for (i = start_id; (i < p_info->total_track) && (ret != true); i++) {
+                /* The full path is made only for the tracks of the same name. */
+                if (strncmp(p_info->track_list[i].name, p_name, sizeof(p_info->track_list[i].name)) == 0) {
+                    p_full = get_full_path(p_info, &p_info->track_list[i]);
+                    if ((p_full != NULL) && (strcmp(p_full, p_path) == 0)) {
+                        *p_trk_id = i;
+                        ret = true;
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
+
 uint32_t fid_get_total_track(const fid_scan_folder_t * const p_info)
 {
     uint32_t        ret = 0u;
@@ -256,71 +450,55 @@ static const char_t *get_full_path(fid_scan_folder_t * const p_info,
  *
  *  @param p_info Pointer to the control data of folder scan module.
  *  @param p_item Pointer to the item structure of the folder / track.
- *  @param p_fdir Pointer to the structure to store the directory object.
  *
  *  @returns 
- *    Results of process. true is success. false is failure.
+ *    Pointer to the directory handle. NULL is failure.
  */
-static bool open_dir(fid_scan_folder_t * const p_info, 
-                        const item_t * const p_item, FATFS_DIR * const p_fdir)
+static DIR *open_dir(fid_scan_folder_t * const p_info, const item_t * const p_item)
 {
-    bool            ret = false;
+    DIR             *p_dir = NULL;
     const char_t    *p_path;
-    FRESULT         ferr;
 
-    if ((p_info != NULL) && (p_item != NULL) && (p_fdir != NULL)) {
+    if ((p_info != NULL) && (p_item != NULL)) {
         p_path = get_full_path(p_info, p_item);
         if (p_path != NULL) {
-            ferr = f_opendir(p_fdir, p_path);
-            if (ferr == FR_OK) {
-                ret = true;
-            }
+            /* The mount name at the top of the path selects the drive. */
+            p_dir = opendir(p_path);
         }
     }
-    return ret;
+    return p_dir;
 }
 
 /** Reads the directory
  *
- *  @param p_info Pointer to the control data of folder scan module.
- *  @param p_fdir Pointer to the structure of the directory object.
+ *  @param p_dir Pointer to the directory handle.
+ *  @param p_name Pointer to the variable to store the pointer to the name.
  *  @param p_flag_dir Pointer to the variable to store the directory flag.
  *
  *  @returns 
- *    Pointer to the name.
+ *    Results of process. true is success. false is the end of the directory.
  */
-static bool read_dir(fid_scan_folder_t * const p_info, FATFS_DIR * const p_fdir, 
-                            const char_t ** const p_name, bool * const p_flag_dir)
+static bool read_dir(DIR * const p_dir, const char_t ** const p_name, 
+                                                    bool * const p_flag_dir)
 {
     bool            ret = false;
-    FRESULT         ferr;
-    FILINFO         finfo;
-
-    if ((p_info != NULL) && (p_fdir != NULL) && 
-        (p_name != NULL) && (p_flag_dir != NULL)) {
-        /* Sets the buffer to store the long file name. */
-        finfo.lfname = &p_info->work_buf[0];
-        finfo.lfsize = sizeof(p_info->work_buf);
-        ferr = f_readdir(p_fdir, &finfo);
-        if ((ferr == FR_OK) && ((int32_t)finfo.fname[0] != '\0')) {
-            if (finfo.lfname != NULL) {
-                if ((int32_t)finfo.lfname[0] == '\0') {
-                    /* Long file name does not exist. */
-                    (void) strncpy(finfo.lfname, finfo.fname, finfo.lfsize);
-                }
-                /* Adds the NULL terminal character. */
-                /* This is fail-safe processing. */
-                finfo.lfname[finfo.lfsize - 1u] = '\0';
+    struct dirent   *p_ent;
 
-                ret = true;
-                *p_name = finfo.lfname;
-                if ((finfo.fattrib & AM_DIR) != 0) {
-                    /* This item is directory. */
-                    *p_flag_dir = true;
-                } else {
-                    /* This item is file. */
-                    *p_flag_dir = false;
-                }
+    if ((p_dir != NULL) && (p_name != NULL) && (p_flag_dir != NULL)) {
+        p_ent = readdir(p_dir);
+        if ((p_ent != NULL) && ((int32_t)p_ent->d_name[0] != '\0')) {
+            /* Adds the NULL terminal character. */
+            /* This is fail-safe processing. */
+            p_ent->d_name[sizeof(p_ent->d_name) - 1u] = '\0';
+
+            ret = true;
+            *p_name = p_ent->d_name;
+            if (p_ent->d_type == DT_DIR) {
+                /* This item is directory. */
+                *p_flag_dir = true;
+            } else {
+                /* This item is file. */
+                *p_flag_dir = false;
             }
         }
     }
@@ -359,7 +537,7 @@ static bool regist_item(item_t * const p_item,
  *  @param p_name Pointer to the name of the track.
  *
  *  @returns 
- *    Results of the checking. true is FLAC file. false is other file.
+ *    Results of the checking. true is audio file. false is other file.
  */
 static bool check_extension(const char_t * const p_name)
 {
@@ -373,6 +551,14 @@ static bool check_extension(const char_t * const p_name)
                 ret = true;
             } else if (strncasecmp(p, FILE_EXT_FLA, sizeof(FILE_EXT_FLA)) == 0) {
                 ret = true;
+            } else if (strncasecmp(p, FILE_EXT_WAV, sizeof(FILE_EXT_WAV)) == 0) {
+                ret = true;
+            } else if (strncasecmp(p, FILE_EXT_AIF, sizeof(FILE_EXT_AIF)) == 0) {
+                ret = true;
+            } else if (strncasecmp(p, FILE_EXT_AIFF, sizeof(FILE_EXT_AIFF)) == 0) {
+                ret = true;
+            } else if (strncasecmp(p, FILE_EXT_AIFC, sizeof(FILE_EXT_AIFC)) == 0) {
+                ret = true;
             } else {
                 /* DO NOTHING */
             }
@@ -414,3 +600,34 @@ static bool check_folder_depth(const fid_scan_folder_t * const p_info,
     }
     return ret;
 }
+
+/** Gets the root folder of the folder
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param folder_id Folder ID [0 - (total folder - 1)]
+ *
+ *  @returns 
+ *    Folder ID of the root folder. FOLD_ID_NOT_EXIST if it is not found.
+ */
+static uint32_t get_root_folder(const fid_scan_folder_t * const p_info, 
+                                                    const uint32_t folder_id)
+{
+    uint32_t        ret = FOLD_ID_NOT_EXIST;
+    uint32_t        depth;
+    uint32_t        id;
+
+    if (p_info != NULL) {
+        id = folder_id;
+        depth = 0u;
+        while ((depth < SYS_MAX_FOLDER_DEPTH) && (id < p_info->total_folder) && 
+               (p_info->folder_list[id].parent_number != FOLD_ID_NOT_EXIST)) {
+            depth++;
+            id = p_info->folder_list[id].parent_number;
+        }
+        if ((depth < SYS_MAX_FOLDER_DEPTH) && (id < p_info->total_folder)) {
+            /* Found the root folder. */
+            ret = id;
+        }
+    }
+    return ret;
+}
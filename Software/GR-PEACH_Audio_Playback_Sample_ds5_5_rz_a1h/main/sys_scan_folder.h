@@ -35,11 +35,15 @@ typedef struct {
 } item_t;
 
 /* Information of folder scan in USB memory */
+/* The folders and tracks of all drives are listed together. Each drive has */
+/* its own root folder named by the mount name of the drive. */
 typedef struct {
     item_t      folder_list[SYS_MAX_FOLDER_NUM];    /* Folder list */
     item_t      track_list[SYS_MAX_TRACK_NUM];      /* Track list */
     uint32_t    total_folder;                       /* Total number of folders */
     uint32_t    total_track;                        /* Total number of tracks */
+    uint32_t    scan_folder;                        /* Number of the folder to scan next */
+    uint32_t    root_folder[SYS_MAX_DRIVE_NUM];     /* Number of the root folder of each drive */
     char_t      work_buf[SYS_MAX_PATH_LENGTH + 1];  /* Work */
                                                     /* (Including the null terminal character.) */
 } fid_scan_folder_t;
@@ -50,14 +54,85 @@ typedef struct {
  */
 void fid_init(fid_scan_folder_t * const p_info);
 
-/** Scans the folder structure of USB memory
+/** Scans the folder structure of a drive of USB memory
  *
  *  @param p_info Pointer to the control data of folder scan module.
+ *  @param drive Drive number [0 - (SYS_MAX_DRIVE_NUM - 1)]
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-bool fid_scan_folder_struct(fid_scan_folder_t * const p_info);
+bool fid_scan_folder_struct(fid_scan_folder_t * const p_info, const uint32_t drive);
+
+/** Adds a drive of USB memory and starts the scan of its folder structure
+ *
+ *  The folders are scanned one by one by fid_scan_next_folder(). The folders
+ *  of all added drives are scanned in turn, and the tracks are added to the
+ *  end of the track list. The tracks found so far can be opened during the
+ *  scan, and their track IDs are not changed by the rest of the scan.
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param drive Drive number [0 - (SYS_MAX_DRIVE_NUM - 1)]
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+bool fid_add_drive(fid_scan_folder_t * const p_info, const uint32_t drive);
+
+/** Removes a drive of USB memory
+ *
+ *  The folders and tracks of the drive are removed, and the tracks of the other
+ *  drives are moved up to fill the gap. The track IDs held by the caller are
+ *  converted to the IDs after the removal. The ID of a removed track is changed
+ *  to the ID of the track which follows it.
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param drive Drive number [0 - (SYS_MAX_DRIVE_NUM - 1)]
+ *  @param p_trk_ids Pointer to the track IDs to convert
+ *  @param trk_num Number of the track IDs to convert
+ */
+void fid_remove_drive(fid_scan_folder_t * const p_info, const uint32_t drive, 
+                            uint32_t * const p_trk_ids, const uint32_t trk_num);
+
+/** Checks whether the track is in the drive
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param drive Drive number [0 - (SYS_MAX_DRIVE_NUM - 1)]
+ *  @param track_id Track ID [0 - (total track - 1)]
+ *
+ *  @returns 
+ *    true if the track is in the drive. Otherwise false.
+ */
+bool fid_is_drive_track(const fid_scan_folder_t * const p_info, 
+                            const uint32_t drive, const uint32_t track_id);
+
+/** Checks whether the drive is added
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param drive Drive number [0 - (SYS_MAX_DRIVE_NUM - 1)]
+ *
+ *  @returns 
+ *    true if the drive is added. Otherwise false.
+ */
+bool fid_is_drive_added(const fid_scan_folder_t * const p_info, const uint32_t drive);
+
+/** Scans the next folder of the drives added by fid_add_drive()
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *
+ *  @returns 
+ *    true if some folders are left. false if the scan is finished.
+ */
+bool fid_scan_next_folder(fid_scan_folder_t * const p_info);
+
+/** Checks whether the scan is in progress
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *
+ *  @returns 
+ *    true if some folders are left. false if the scan is finished.
+ */
+bool fid_is_scanning(const fid_scan_folder_t * const p_info);
 
 /** Gets the total number of detected tracks
  *
@@ -79,6 +154,33 @@ uint32_t fid_get_total_track(const fid_scan_folder_t * const p_info);
 const char_t *fid_get_track_name(const fid_scan_folder_t * const p_info, 
                                                 const uint32_t track_id);
 
+/** Gets the full path of the track
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param track_id Track ID [0 - (total track - 1)]
+ *
+ *  @returns 
+ *    Pointer to the full path. ("/usb0/folder/track.flac")
+ *    It is overwritten by the next call of this module.
+ */
+const char_t *fid_get_track_path(fid_scan_folder_t * const p_info, const uint32_t track_id);
+
+/** Finds the track of the full path
+ *
+ *  The tracks from start_id are searched, so the caller can search only the
+ *  tracks added by the scan after the last search.
+ *
+ *  @param p_info Pointer to the control data of folder scan module.
+ *  @param p_path Pointer to the full path. ("/usb0/folder/track.flac")
+ *  @param start_id Track ID to start the search
+ *  @param p_trk_id Pointer to store the track ID
+ *
+ *  @returns 
+ *    true if the track is found. Otherwise false.
+ */
+bool fid_find_track(fid_scan_folder_t * const p_info, const char_t * const p_path, 
+                            const uint32_t start_id, uint32_t * const p_trk_id);
+
 /** Opens the track
  *
  *  @param p_info Pointer to the control data of folder scan module.
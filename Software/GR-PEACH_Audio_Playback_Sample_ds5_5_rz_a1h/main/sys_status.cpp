@@ -0,0 +1,87 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "mbed.h"
+#include "sys_status.h"
+
+/*--- Macro definition ---*/
+#define SYS_STATUS_READ_RETRY   (3u)    /* Retry count of reading the status block */
+#define SEQ_WRITING_BIT         (1u)    /* The sequence counter is odd while writing. */
+
+void sys_status_init(sys_status_block_t * const p_block)
+{
+    if (p_block != NULL) {
+        p_block->seq = 0u;
+        p_block->status.play_stat  = SYS_PLAYSTAT_STOP;
+        p_block->status.track_id   = 0u;
+        p_block->status.play_time  = 0u;
+        p_block->status.total_time = 0u;
+        p_block->status.play_sample = 0u;
+    }
+}
+
+void sys_status_write(sys_status_block_t * const p_block, const sys_status_t * const p_status)
+{
+    if ((p_block != NULL) && (p_status != NULL)) {
+        p_block->seq = p_block->seq + 1u;
+        __DMB();
+        p_block->status = *p_status;
+        __DMB();
+        p_block->seq = p_block->seq + 1u;
+    }
+}
+
+bool sys_status_read(const sys_status_block_t * const p_block, 
+                        sys_status_t * const p_status, uint32_t * const p_seq)
+{
+    bool            ret = false;
+    bool            fin = false;
+    uint32_t        i;
+    uint32_t        seq_start;
+    uint32_t        seq_end;
+    sys_status_t    status;
+
+    if ((p_block != NULL) && (p_status != NULL) && (p_seq != NULL)) {
+        for (i = 0u; (i < SYS_STATUS_READ_RETRY) && (fin == false); i++) {
+            seq_start = p_block->seq;
+            if (seq_start == *p_seq) {
+                /* Not updated since the last read. */
+                fin = true;
+            } else if ((seq_start & SEQ_WRITING_BIT) == 0u) {
+                __DMB();
+                status = p_block->status;
+                __DMB();
+                seq_end = p_block->seq;
+                if (seq_start == seq_end) {
+                    *p_status = status;
+                    *p_seq = seq_start;
+                    ret = true;
+                    fin = true;
+                }
+            } else {
+                /* The writer is preempted while writing. Retries. */
+            }
+        }
+    }
+    return ret;
+}
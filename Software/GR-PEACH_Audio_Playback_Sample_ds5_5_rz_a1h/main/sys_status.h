@@ -0,0 +1,79 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#ifndef SYS_STATUS_H
+#define SYS_STATUS_H
+
+#include "r_typedefs.h"
+#include "system.h"
+
+/*--- User defined types ---*/
+/* Latest value of the playback status */
+typedef struct {
+    SYS_PlayStat    play_stat;      /* Playback status */
+    uint32_t        track_id;       /* Track number. 0 when it is not used. */
+    uint32_t        play_time;      /* Playback time (sec) */
+    uint32_t        total_time;     /* Total playback time (sec) */
+    uint32_t        play_sample;    /* Playback position (samples) */
+} sys_status_t;
+
+/* Status block shared by one writer thread and reader threads. */
+/* The readers copy the latest value without a lock and retry if it was updated during the copy. */
+typedef struct {
+    volatile uint32_t   seq;        /* Sequence counter. It is odd while the status is written. */
+    sys_status_t        status;     /* Latest value */
+} sys_status_block_t;
+
+/** Initialises the status block
+ *
+ *  @param p_block Pointer to the status block.
+ */
+void sys_status_init(sys_status_block_t * const p_block);
+
+/** Writes the latest value to the status block
+ *
+ *  Only one thread may write to a status block. It never blocks.
+ *
+ *  @param p_block Pointer to the status block.
+ *  @param p_status Pointer to the latest value.
+ */
+void sys_status_write(sys_status_block_t * const p_block, const sys_status_t * const p_status);
+
+/** Reads the latest value from the status block
+ *
+ *  It never blocks. If the writer keeps updating the block, the read fails
+ *  after SYS_STATUS_READ_RETRY times and the caller retries later.
+ *
+ *  @param p_block Pointer to the status block.
+ *  @param p_status Pointer to store the latest value.
+ *  @param p_seq Pointer to the sequence counter of the last read.
+ *               When the value is read, it is updated to the current sequence counter.
+ *
+ *  @returns 
+ *    true if the value was updated since the last read. false if it was not
+ *    updated or the read failed. p_status is set only when true is returned.
+ */
+bool sys_status_read(const sys_status_block_t * const p_block, 
+                        sys_status_t * const p_status, uint32_t * const p_seq);
+
+#endif /* SYS_STATUS_H */
@@ -25,9 +25,12 @@
 #include "rtos.h"
 #include "FATFileSystem.h"
 #include "USBHostMSD.h"
+#include "FileBlockDevice.h"
 
 #include "system.h"
 #include "sys_scan_folder.h"
+#include "sys_status.h"
+#include "sys_resume.h"
 #include "decode.h"
 #include "display.h"
 
@@ -51,33 +54,78 @@
 /* mail_id = SYS_MAILID_KEYCODE */
 #define MAIL_KEYCODE_CODE   (MAIL_PARAM0)   /* Key code */
 
-/* mail_id = SYS_MAILID_PLAY_TIME */
-#define MAIL_PLAYTIME_STAT  (MAIL_PARAM0)   /* Playback status */
-#define MAIL_PLAYTIME_TIME  (MAIL_PARAM1)   /* Playback time */
-#define MAIL_PLAYTIME_TOTAL (MAIL_PARAM2)   /* Total playback time */
-
 /* mail_id = SYS_MAILID_DEC_OPEN_FIN */
 #define MAIL_DECOPEN_RESULT (MAIL_PARAM0)   /* Result of the process */
 #define MAIL_DECOPEN_FREQ   (MAIL_PARAM1)   /* Sampling rate in Hz of FLAC file */
 #define MAIL_DECOPEN_CH     (MAIL_PARAM2)   /* Number of channel */
 
+/* mail_id = SYS_MAILID_DEC_NEXT_OPEN_FIN */
+#define MAIL_NEXTOPEN_RESULT    (MAIL_PARAM0)   /* Result of the process */
+
+/* mail_id = SYS_MAILID_DEC_NEXT_START */
+#define MAIL_NEXTSTART_FREQ     (MAIL_PARAM1)   /* Sampling rate in Hz of FLAC file */
+#define MAIL_NEXTSTART_CH       (MAIL_PARAM2)   /* Number of channel */
+
 #define RECV_MAIL_TIMEOUT_MS    (10)
+#define RECV_MAIL_NO_WAIT       (0)     /* Used during the folder scan */
 
 #define USB1_WAIT_TIME_MS       (5)
 #define TRACK_ID_MIN            (0u)
 #define TRACK_ID_ERR            (0xFFFFFFFFu)
+/* Track of the resume state which is opened by its path before the scan finds it */
+#define TRACK_ID_RESUME         (SYS_MAX_TRACK_NUM)
 
 #define PRINT_MSG_USB_CONNECT   "USB connection was detected."
 #define PRINT_MSG_OPEN_ERR      "Could not play this file."
 #define PRINT_MSG_DECODE_ERR    "This file format is not supported."
+#define PRINT_MSG_VOLUME        "Volume = %ld dB"
+#define PRINT_MSG_MUTE          "Volume = mute"
+#define PRINT_MSG_XFADE_ON      "Crossfade = on"
+#define PRINT_MSG_XFADE_OFF     "Crossfade = off"
+#define PRINT_MSG_EQ            "Equalizer = %s"
+
+#define VOLUME_STEP             (2)     /* Step of the volume in dB */
+#define VOLUME_INIT             (DEC_VOLUME_MAX)
+
+#define XFADE_TIME_MS           (5000u) /* Length of the crossfade */
+#define XFADE_CURVE             (XFADE_CURVE_EQUAL_POWER)
+#define XFADE_TIME_SEC          ((XFADE_TIME_MS + 999u) / 1000u)
+/* The next track is opened this time before the crossfade. */
+#define XFADE_OPEN_MARGIN_SEC   (2u)
+
+/* Presets of the equalizer: a shelf of EQ_PRESET_GAIN at EQ_PRESET_BASS_FREQ */
+/* or EQ_PRESET_TREBLE_FREQ. A loud track is saturated by the boost. */
+#define EQ_PRESET_GAIN          (60)    /* +6.0dB */
+#define EQ_PRESET_Q             (71u)   /* 0.71 */
+#define EQ_PRESET_BASS_FREQ     (100u)
+#define EQ_PRESET_TREBLE_FREQ   (8000u)
+
+/* Starts the playback of the first track found on the connected USB memory. */
+/* 1 : The first track is opened during the folder scan and played. */
+/* 0 : Waits for "PLAY/PAUSE" key. */
+#define AUTO_PLAY_ON_CONNECT    (1)
+/* Prints the time of each step from the USB connection to the playback. 1 is on. */
+#define ATTACH_TRACE_PRINT      (0)
+#define PRINT_MSG_ATTACH_TRACE  "ms:conn %lu mnt %lu trk %lu open %lu play %lu scan %lu"
+/* Resumes the track, the position and the settings saved in the journal file */
+/* of USB memory, when the first USB memory is connected. 1 is on. */
+/* The track is played at once if AUTO_PLAY_ON_CONNECT is 1. */
+#define RESUME_ON_CONNECT       (1)
+#define RESUME_FILE_NAME        "resume.jnl"
+#define RESUME_SLOT_SIZE        (512u)      /* A sector of USB memory */
+#define RESUME_SLOT_NUM         (16u)
+#define RESUME_ROOT_SIZE        (sizeof("/" SYS_USB_MOUNT_NAME "0/") - 1u)
+#define RESUME_OPEN_MODE        "r"
 
 /*--- User defined types of mbed-rtos mail ---*/
 typedef enum {
     SYS_MAILID_DUMMY = 0,
     SYS_MAILID_KEYCODE,         /* Notifies main thread of key code. */
-    SYS_MAILID_PLAY_TIME,       /* Notifies main thread of playback time. */
     SYS_MAILID_DEC_OPEN_FIN,    /* Finished the opening process of Decode Thread. */
     SYS_MAILID_DEC_CLOSE_FIN,   /* Finished the closing process of Decode Thread. */
+    SYS_MAILID_DEC_NEXT_OPEN_FIN,   /* Finished the opening process of the next track. */
+    SYS_MAILID_DEC_NEXT_START,  /* Started the next track. */
+    SYS_MAILID_USB_MOUNT_FIN,   /* Mounted the file system of USB memory. */
     SYS_MAILID_NUM
 } SYS_MAIL_ID;
 
@@ -113,10 +161,19 @@ typedef enum {
     SYS_EV_KEY_PLAYINFO,        /* "PLAYINFO" key */
     SYS_EV_KEY_REPEAT,          /* "REPEAT" key */
     SYS_EV_KEY_HELP,            /* "HELP" key */
+    SYS_EV_KEY_VOLUP,           /* "VOLUP" key */
+    SYS_EV_KEY_VOLDOWN,         /* "VOLDOWN" key */
+    SYS_EV_KEY_MUTE,            /* "MUTE" key */
+    SYS_EV_KEY_XFADE,           /* "XFADE" key */
+    SYS_EV_KEY_METER,           /* "METER" key */
+    SYS_EV_KEY_EQ_FLAT,         /* "EQ FLAT" key */
+    SYS_EV_KEY_EQ_BASS,         /* "EQ BASS" key */
+    SYS_EV_KEY_EQ_TREBLE,       /* "EQ TREBLE" key */
     /* Notification of decoder process */
     SYS_EV_DEC_OPEN_COMP,       /* Finished the opening process */
     SYS_EV_DEC_OPEN_COMP_ERR,   /* Finished the opening process (An error occured)*/
     SYS_EV_DEC_CLOSE_COMP,      /* Finished the closing process */
+    SYS_EV_DEC_NEXT_START,      /* Started the next track */
     /* Notification of the playback status */
     SYS_EV_STAT_STOP,           /* Stop */
     SYS_EV_STAT_PLAY,           /* Play */
@@ -124,46 +181,123 @@ typedef enum {
     /* Notification of USB connection */
     SYS_EV_USB_CONNECT,         /* Connect */
     SYS_EV_USB_DISCONNECT,      /* Disconnect  */
+    /* Notification of folder scan */
+    SYS_EV_SCAN_FIRST_TRACK,    /* Found the first track */
+    SYS_EV_RESUME_TRACK,        /* Loaded the track of the resume state */
     SYS_EV_NUM
 } SYS_EVENT;
 
+/* Steps from the USB connection to the playback */
+typedef enum {
+    ATTACH_STEP_CONNECT = 0,    /* Connected the driver to USB memory */
+    ATTACH_STEP_MOUNT,          /* Mounted the FAT filesystem */
+    ATTACH_STEP_TRACK,          /* Found the first track */
+    ATTACH_STEP_OPEN,           /* Opened the decoder */
+    ATTACH_STEP_PLAY,           /* Started the playback */
+    ATTACH_STEP_SCAN,           /* Finished the folder scan */
+    ATTACH_STEP_NUM
+} ATTACH_STEP;
+
+/* Status of a drive of USB memory */
+typedef enum {
+    DRIVE_STAT_FREE = 0,        /* Not used. USB attach thread tries to connect it. */
+    DRIVE_STAT_MOUNTED,         /* Mounted by USB attach thread */
+    DRIVE_STAT_ACTIVE,          /* Added to the track list by main thread */
+    DRIVE_STAT_NUM
+} DRIVE_STAT;
+
+/* A drive of USB memory */
+/* "stat" is changed by USB attach thread from FREE to MOUNTED, and by main */
+/* thread from MOUNTED to ACTIVE and from ACTIVE to FREE. */
+typedef struct {
+    USBHostMSD          *p_msd;
+    FATFileSystem       *p_fs;
+    FileBlockDevice     *p_journal;     /* Journal file of the resume state */
+    char_t              name[sizeof(SYS_USB_MOUNT_NAME "0")];  /* Mount name */
+    volatile DRIVE_STAT stat;           /* Status of the drive */
+    uint32_t            conn_time;      /* Time of the connection in ms */
+    uint32_t            mount_time;     /* Time of the mount in ms */
+} drive_t;
+
 /* Control data of USB memory */
 typedef struct {
-    bool            usb_flag_detach;/* Detected the disconnection of USB memory */
+    uint32_t        detach_drives;  /* Bit mask of the disconnected drives which are not removed */
+    uint32_t        attach_steps;   /* Bit mask of the recorded steps */
+    uint32_t        attach_time[ATTACH_STEP_NUM];   /* Time of each step in ms */
 } usb_ctrl_t;
 
 /* The playback information of the playback file */
 typedef struct {
     SYS_PlayStat    play_stat;      /* Playback status */
     bool            repeat_mode;    /* Repeat mode */
+    int32_t         volume;         /* Volume in dB */
+    bool            mute;           /* Mute */
+    bool            xfade_mode;     /* Crossfade mode */
+    bool            meter_mode;     /* Level meter mode */
     uint32_t        track_id;       /* Number of the selected track */
     uint32_t        open_track_id;  /* Number of the track during the open processing */
     FILE            *p_file_handle; /* Handle of the track */
+    uint32_t        next_track_id;  /* Number of the track which follows without the stop */
+    FILE            *p_next_file_handle;    /* Handle of the track which follows */
     uint32_t        play_time;      /* Playback start time */
     uint32_t        total_time;     /* Total playback time */
     uint32_t        sample_rate;    /* Sampling rate in Hz of FLAC file */
     uint32_t        channel_num;    /* Number of channel */
+    uint32_t        play_sample;    /* Playback position in samples */
+    uint32_t        resume_drive;   /* Drive of the track of TRACK_ID_RESUME */
+    uint32_t        resume_sample;  /* Position where the next open of the selected track starts */
+    char_t          resume_path[RESUME_ROOT_SIZE + SYS_RESUME_PATH_SIZE];  /* Full path of */
+                                                                /* the track of TRACK_ID_RESUME */
 } play_info_t;
 
+/* Control data of the resume state */
+/* The journal is in the drive of the selected track. The resume state is */
+/* written only by main thread, so the audio output is never blocked by it. */
+typedef struct {
+    sys_resume_t        journal;        /* Journal of the resume state */
+    uint32_t            drive;          /* Drive of the opened journal file */
+    uint32_t            fail_drives;    /* Bit mask of the drives of which journal file failed */
+    bool                is_req;         /* true until the track of the resume state is played */
+    uint32_t            search_id;      /* Track ID to start the search of the track of the resume state */
+} resume_ctrl_t;
+
 /* Control data of main thread */
 typedef struct {
     usb_ctrl_t          usb_ctrl;
     fid_scan_folder_t   scan_data;
     play_info_t         play_info;
+    resume_ctrl_t       resume;
+    uint32_t            status_seq;     /* Sequence counter of the playback status read last */
 } sys_ctrl_t;
 
 static Mail<sys_mail_t, MAIL_QUEUE_SIZE> mail_box;
+static drive_t drive_list[SYS_MAX_DRIVE_NUM];
+/* Released by USB thread when a USB device is connected or disconnected */
+static Semaphore attach_sem(0);
+/* Time from the USB connection event of the first USB memory */
+static Timer attach_timer;
+/* Playback status written by Decode thread. Its update is not notified by the mail. */
+static sys_status_block_t play_status;
 
 static void open_callback(const bool result, const uint32_t sample_freq, 
                                                 const uint32_t channel_num);
 static void close_callback(void);
+static void next_open_callback(const bool result, const uint32_t sample_freq, 
+                                                const uint32_t channel_num);
+static void next_start_callback(const bool result, const uint32_t sample_freq, 
+                                                const uint32_t channel_num);
+static void usb_event_callback(void);
+static void init_drive_list(void);
+static bool is_drive_active(void);
 static void init_ctrl_data(sys_ctrl_t * const p_ctrl);
 static SYS_EVENT decode_mail(play_info_t * const p_info, 
         const fid_scan_folder_t * const p_data, const SYS_MAIL_ID mail_id, 
         const uint32_t * const p_param);
-static SYS_EVENT check_usb_event(const SYS_STATE stat, 
-        const usb_ctrl_t * const p_ctrl, USBHostMSD * const p_msd, 
-        FATFileSystem * const p_fs);
+static SYS_EVENT check_play_status(play_info_t * const p_info, uint32_t * const p_seq);
+static SYS_EVENT check_usb_event(const SYS_STATE stat, sys_ctrl_t * const p_ctrl);
+static SYS_EVENT check_scan_event(const SYS_STATE stat, sys_ctrl_t * const p_ctrl);
+static void trace_attach(usb_ctrl_t * const p_ctrl, const ATTACH_STEP step, 
+                                                    const uint32_t time_ms);
 static SYS_STATE state_trans_proc(const SYS_STATE stat, 
                         const SYS_EVENT event, sys_ctrl_t * const p_ctrl);
 static SYS_STATE state_trans_proc(const SYS_STATE stat, 
@@ -183,11 +317,23 @@ static SYS_STATE state_proc_stop_prepare(const SYS_STATE stat,
 static SYS_STATE state_proc_stop_prepare_req(const SYS_STATE stat, 
                         const SYS_EVENT event, sys_ctrl_t * const p_ctrl);
 static bool exe_scan_folder_proc(play_info_t * const p_info, 
-                                            fid_scan_folder_t * const p_data);
+                        fid_scan_folder_t * const p_data, const uint32_t drive);
+static bool is_drive_in_use(const play_info_t * const p_info, 
+                        const fid_scan_folder_t * const p_data, const uint32_t drive);
+static void exe_remove_drive(sys_ctrl_t * const p_ctrl, const uint32_t drive);
+static bool open_resume_journal(sys_ctrl_t * const p_ctrl, const uint32_t drive);
+static void close_resume_journal(sys_ctrl_t * const p_ctrl);
+static void load_resume_state(sys_ctrl_t * const p_ctrl, const uint32_t drive);
+static void save_resume_state(sys_ctrl_t * const p_ctrl);
+static void find_resume_track(sys_ctrl_t * const p_ctrl);
+static uint32_t get_track_drive(const fid_scan_folder_t * const p_data, const uint32_t trk_id);
+static SYS_STATE exe_detach_proc(sys_ctrl_t * const p_ctrl);
 static bool exe_open_proc(play_info_t * const p_info, 
                                             fid_scan_folder_t * const p_data);
 static bool exe_play_proc(play_info_t * const p_info, 
                                     const fid_scan_folder_t * const p_data);
+static bool exe_open_next_proc(play_info_t * const p_info, 
+                                    fid_scan_folder_t * const p_data);
 static bool exe_pause_on_proc(void);
 static bool exe_pause_off_proc(void);
 static bool exe_stop_proc(void);
@@ -195,6 +341,12 @@ static bool exe_close_proc(void);
 static void exe_end_proc(play_info_t * const p_info);
 static bool is_track_changed(const play_info_t * const p_info);
 static void change_repeat_mode(play_info_t * const p_info);
+static void change_volume(play_info_t * const p_info, const SYS_EVENT event);
+static void change_xfade_mode(play_info_t * const p_info);
+static void change_meter_mode(play_info_t * const p_info);
+static void change_eq(const SYS_EVENT event);
+static bool get_next_track_id(const play_info_t * const p_info, 
+                const fid_scan_folder_t * const p_data, uint32_t * const p_trk_id);
 static bool change_next_track(play_info_t * const p_info, 
                                     const fid_scan_folder_t * const p_data);
 static bool change_prev_track(play_info_t * const p_info, 
@@ -208,7 +360,8 @@ static uint32_t convert_track_id(const uint32_t trk_id);
 static bool send_mail(const SYS_MAIL_ID mail_id, const uint32_t param0,
                             const uint32_t param1, const uint32_t param2);
 static bool recv_mail(SYS_MAIL_ID * const p_mail_id, uint32_t * const p_param0, 
-                        uint32_t * const p_param1, uint32_t * const p_param2);
+                        uint32_t * const p_param1, uint32_t * const p_param2, 
+                        const uint32_t timeout_ms);
 
 void system_main(void)
 {
@@ -218,8 +371,6 @@ void system_main(void)
     SYS_MAIL_ID         mail_type;
     uint32_t            mail_param[MAIL_PARAM_NUM];
     static sys_ctrl_t   sys_ctrl;
-    static FATFileSystem fs(SYS_USB_MOUNT_NAME);
-    static USBHostMSD msd;
 #if (USB_HOST_CH == 1) /* Audio Shield USB1 */
     static DigitalOut   usb1en(P3_8);
 
@@ -231,19 +382,83 @@ void system_main(void)
 
     /* Initializes the control data of main thread. */
     init_ctrl_data(&sys_ctrl);
+    init_drive_list();
     sys_stat = SYS_ST_WAIT_USB_CONNECT;
+    USBHost::getHostInst()->attachDeviceEvent(&usb_event_callback);
+    /* The USB memory connected before this is checked by USB attach thread. */
+    (void) attach_sem.release();
     while (1) {
-        sys_ev = check_usb_event(sys_stat, &sys_ctrl.usb_ctrl, &msd, &fs);
+        sys_ev = check_usb_event(sys_stat, &sys_ctrl);
         if (sys_ev == SYS_EV_NON) {
+            sys_ev = check_scan_event(sys_stat, &sys_ctrl);
+        }
+        if (sys_ev == SYS_EV_NON) {
+            /* The rest of the folder scan is continued without waiting the mail. */
             result = recv_mail(&mail_type, &mail_param[MAIL_PARAM0], 
-                        &mail_param[MAIL_PARAM1], &mail_param[MAIL_PARAM2]);
+                        &mail_param[MAIL_PARAM1], &mail_param[MAIL_PARAM2], 
+                        fid_is_scanning(&sys_ctrl.scan_data) ? RECV_MAIL_NO_WAIT : RECV_MAIL_TIMEOUT_MS);
             if (result == true) {
                 sys_ev = decode_mail(&sys_ctrl.play_info, 
                                 &sys_ctrl.scan_data, mail_type, mail_param);
             }
         }
+        if (sys_ev == SYS_EV_NON) {
+            sys_ev = check_play_status(&sys_ctrl.play_info, &sys_ctrl.status_seq);
+        }
+        if (sys_ev == SYS_EV_DEC_OPEN_COMP) {
+            trace_attach(&sys_ctrl.usb_ctrl, ATTACH_STEP_OPEN, (uint32_t)attach_timer.read_ms());
+        } else if (sys_ev == SYS_EV_STAT_PLAY) {
+            trace_attach(&sys_ctrl.usb_ctrl, ATTACH_STEP_PLAY, (uint32_t)attach_timer.read_ms());
+        } else {
+            /* DO NOTHING */
+        }
         if (sys_ev != SYS_EV_NON) {
             sys_stat = state_trans_proc(sys_stat, sys_ev, &sys_ctrl);
+#if (RESUME_ON_CONNECT == 1)
+            save_resume_state(&sys_ctrl);
+#endif /* RESUME_ON_CONNECT */
+        }
+    }
+}
+
+void sys_attach_thread(void const *argument)
+{
+    uint32_t            drv;
+    bool                result;
+    drive_t             *p_drv;
+
+    (void) argument;
+    while (1) {
+        (void) attach_sem.wait();
+        result = false;
+        for (drv = 0u; drv < SYS_MAX_DRIVE_NUM; drv++) {
+            if (drive_list[drv].stat != DRIVE_STAT_FREE) {
+                result = true;
+            }
+        }
+        if (result != true) {
+            /* The time to the playback is measured from the first USB memory. */
+            attach_timer.reset();
+            attach_timer.start();
+        }
+        for (drv = 0u; drv < SYS_MAX_DRIVE_NUM; drv++) {
+            p_drv = &drive_list[drv];
+            if ((p_drv->p_msd != NULL) && (p_drv->stat == DRIVE_STAT_FREE)) {
+                /* USBHostMSD is connected to the USB memory which is not used by the others. */
+                result = p_drv->p_msd->connect();
+                if (result == true) {
+                    p_drv->conn_time = (uint32_t)attach_timer.read_ms();
+                    /* Mounts the FAT filesystem again. */
+                    /* Because the connecting USB memory is changed. */
+                    /* The mount is forced to initialize USB memory here. */
+                    (void) p_drv->p_fs->unmount();
+                    (void) p_drv->p_fs->mount(p_drv->p_msd, true);
+                    p_drv->mount_time = (uint32_t)attach_timer.read_ms();
+                    p_drv->stat = DRIVE_STAT_MOUNTED;
+                    /* Wakes up main thread. The status is checked even if the mail is lost. */
+                    (void) send_mail(SYS_MAILID_USB_MOUNT_FIN, drv, MAIL_PARAM_NON, MAIL_PARAM_NON);
+                }
+            }
         }
     }
 }
@@ -258,11 +473,19 @@ bool sys_notify_key_input(const SYS_KeyCode key_code)
 }
 
 bool sys_notify_play_time(const SYS_PlayStat play_stat, 
-    const uint32_t play_time, const uint32_t total_time)
+    const uint32_t play_time, const uint32_t total_time, const uint32_t play_sample)
 {
     bool    ret = false;
 
-    ret = send_mail(SYS_MAILID_PLAY_TIME, (uint32_t)play_stat, play_time, total_time);
+    sys_status_t    status;
+
+    status.play_stat  = play_stat;
+    status.track_id   = 0u;
+    status.play_time  = play_time;
+    status.total_time = total_time;
+    status.play_sample = play_sample;
+    sys_status_write(&play_status, &status);
+    ret = true;
 
     return ret;
 }
@@ -287,6 +510,82 @@ static void close_callback(void)
     (void) send_mail(SYS_MAILID_DEC_CLOSE_FIN, MAIL_PARAM_NON, MAIL_PARAM_NON, MAIL_PARAM_NON);
 }
 
+/** Callback function of Decode Thread
+ *
+ *  @param result Result of the process.
+ *  @param sample_freq Sampling rate in Hz of FLAC file.
+ *  @param channel_num Number of channel.
+ */
+static void next_open_callback(const bool result, const uint32_t sample_freq, 
+                                                const uint32_t channel_num)
+{
+    (void) send_mail(SYS_MAILID_DEC_NEXT_OPEN_FIN, (uint32_t)result, sample_freq, channel_num);
+}
+
+/** Callback function of Decode Thread
+ *
+ *  @param result Result of the process. (Always true)
+ *  @param sample_freq Sampling rate in Hz of FLAC file.
+ *  @param channel_num Number of channel.
+ */
+static void next_start_callback(const bool result, const uint32_t sample_freq, 
+                                                const uint32_t channel_num)
+{
+    (void) send_mail(SYS_MAILID_DEC_NEXT_START, (uint32_t)result, sample_freq, channel_num);
+}
+
+/** Callback function of USB thread
+ *
+ *  Called when a USB device was connected or disconnected.
+ */
+static void usb_event_callback(void)
+{
+    /* Wakes up USB attach thread. */
+    (void) attach_sem.release();
+}
+
+/** Creates the drives of USB memory
+ *
+ *  Each drive has its own USBHostMSD and FATFileSystem, and it is mounted
+ *  under its own name. ("usb0", "usb1", ...)
+ */
+static void init_drive_list(void)
+{
+    uint32_t            drv;
+    drive_t             *p_drv;
+
+    for (drv = 0u; drv < SYS_MAX_DRIVE_NUM; drv++) {
+        p_drv = &drive_list[drv];
+        (void) snprintf(p_drv->name, sizeof(p_drv->name), "%s%lu", 
+                                        SYS_USB_MOUNT_NAME, (unsigned long)drv);
+        p_drv->p_msd = new USBHostMSD();
+        p_drv->p_fs = new FATFileSystem(p_drv->name);
+        p_drv->p_journal = new FileBlockDevice(p_drv->p_fs, RESUME_FILE_NAME, 
+                                RESUME_SLOT_SIZE * RESUME_SLOT_NUM, RESUME_SLOT_SIZE);
+        p_drv->stat = DRIVE_STAT_FREE;
+        p_drv->conn_time = 0u;
+        p_drv->mount_time = 0u;
+    }
+}
+
+/** Checks whether some drives are added to the track list
+ *
+ *  @returns 
+ *    true if some drives are added. Otherwise false.
+ */
+static bool is_drive_active(void)
+{
+    bool                ret = false;
+    uint32_t            drv;
+
+    for (drv = 0u; drv < SYS_MAX_DRIVE_NUM; drv++) {
+        if (drive_list[drv].stat == DRIVE_STAT_ACTIVE) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
 /** Initialises the control data of main thread
  *
  *  @param p_ctrl Pointer to the control data of main thread
@@ -295,19 +594,39 @@ static void init_ctrl_data(sys_ctrl_t * const p_ctrl)
 {
     if (p_ctrl != NULL) {
         /* Initialises the control data of USB memory. */
-        p_ctrl->usb_ctrl.usb_flag_detach = false;
+        p_ctrl->usb_ctrl.detach_drives = 0u;
+        p_ctrl->usb_ctrl.attach_steps = 0u;
         /* Initialises the information of folder scan. */
         fid_init(&p_ctrl->scan_data);
         /* Initialises the playback information of the playback file */
         p_ctrl->play_info.play_stat = SYS_PLAYSTAT_STOP;
         p_ctrl->play_info.repeat_mode = true;
+        p_ctrl->play_info.volume = VOLUME_INIT;
+        p_ctrl->play_info.mute = false;
+        p_ctrl->play_info.xfade_mode = false;
+        p_ctrl->play_info.meter_mode = false;
         p_ctrl->play_info.track_id = TRACK_ID_MIN;
         p_ctrl->play_info.open_track_id = TRACK_ID_ERR;
         p_ctrl->play_info.p_file_handle = NULL;
+        p_ctrl->play_info.next_track_id = TRACK_ID_ERR;
+        p_ctrl->play_info.p_next_file_handle = NULL;
         p_ctrl->play_info.play_time = 0u;
         p_ctrl->play_info.total_time = 0u;
         p_ctrl->play_info.sample_rate = 0u;
         p_ctrl->play_info.channel_num = 0u;
+        p_ctrl->play_info.play_sample = 0u;
+        p_ctrl->play_info.resume_drive = SYS_MAX_DRIVE_NUM;
+        p_ctrl->play_info.resume_sample = 0u;
+        p_ctrl->play_info.resume_path[0] = '\0';
+        /* Initialises the control data of the resume state. */
+        p_ctrl->resume.journal.p_bd = NULL;
+        p_ctrl->resume.drive = SYS_MAX_DRIVE_NUM;
+        p_ctrl->resume.fail_drives = 0u;
+        p_ctrl->resume.is_req = false;
+        p_ctrl->resume.search_id = 0u;
+        /* Initialises the playback status before Decode thread writes it. */
+        sys_status_init(&play_status);
+        p_ctrl->status_seq = 0u;
     }
 }
 
@@ -352,38 +671,35 @@ static SYS_EVENT decode_mail(play_info_t * const p_info,
                     case SYS_KEYCODE_HELP:
                         ret = SYS_EV_KEY_HELP;
                         break;
-                    default:
-                        /* Unexpected cases : This is fail-safe processing. */
-                        ret = SYS_EV_NON;
+                    case SYS_KEYCODE_VOLUP:
+                        ret = SYS_EV_KEY_VOLUP;
                         break;
-                }
-                break;
-            case SYS_MAILID_PLAY_TIME:
-                switch (p_param[MAIL_PLAYTIME_STAT]) {
-                    case SYS_PLAYSTAT_STOP:
-                        ret = SYS_EV_STAT_STOP;
+                    case SYS_KEYCODE_VOLDOWN:
+                        ret = SYS_EV_KEY_VOLDOWN;
+                        break;
+                    case SYS_KEYCODE_MUTE:
+                        ret = SYS_EV_KEY_MUTE;
+                        break;
+                    case SYS_KEYCODE_XFADE:
+                        ret = SYS_EV_KEY_XFADE;
+                        break;
+                    case SYS_KEYCODE_METER:
+                        ret = SYS_EV_KEY_METER;
                         break;
-                    case SYS_PLAYSTAT_PLAY:
-                        ret = SYS_EV_STAT_PLAY;
+                    case SYS_KEYCODE_EQ_FLAT:
+                        ret = SYS_EV_KEY_EQ_FLAT;
                         break;
-                    case SYS_PLAYSTAT_PAUSE:
-                        ret = SYS_EV_STAT_PAUSE;
+                    case SYS_KEYCODE_EQ_BASS:
+                        ret = SYS_EV_KEY_EQ_BASS;
+                        break;
+                    case SYS_KEYCODE_EQ_TREBLE:
+                        ret = SYS_EV_KEY_EQ_TREBLE;
                         break;
                     default:
+                        /* Unexpected cases : This is fail-safe processing. */
                         ret = SYS_EV_NON;
                         break;
                 }
-                /* Is the playback status correct? */
-                if (ret != SYS_EV_NON) {
-                    p_info->play_stat  = (SYS_PlayStat)p_param[MAIL_PLAYTIME_STAT];
-                    p_info->play_time  = p_param[MAIL_PLAYTIME_TIME];
-                    p_info->total_time = p_param[MAIL_PLAYTIME_TOTAL];
-                } else {
-                    /* Unexpected cases : This is fail-safe processing. */
-                    p_info->play_stat  = SYS_PLAYSTAT_STOP;
-                    p_info->play_time  = 0u;
-                    p_info->total_time = 0u;
-                }
                 break;
             case SYS_MAILID_DEC_OPEN_FIN:
                 if ((int32_t)p_param[MAIL_DECOPEN_RESULT] == true) {
@@ -405,6 +721,29 @@ static SYS_EVENT decode_mail(play_info_t * const p_info,
                 ret = SYS_EV_DEC_CLOSE_COMP;
                 p_info->play_time  = 0u;
                 p_info->total_time = 0u;
+                p_info->play_sample = 0u;
+                break;
+            case SYS_MAILID_DEC_NEXT_OPEN_FIN:
+                if ((int32_t)p_param[MAIL_NEXTOPEN_RESULT] != true) {
+                    /* The next track starts after the stop of the playing track. */
+                    /* "next_track_id" is kept so as not to retry it. */
+                    fid_close_track(p_info->p_next_file_handle);
+                    p_info->p_next_file_handle = NULL;
+                }
+                break;
+            case SYS_MAILID_DEC_NEXT_START:
+                /* Decode thread closed the previous track. Its handle is replaced in any state. */
+                ret = SYS_EV_DEC_NEXT_START;
+                fid_close_track(p_info->p_file_handle);
+                p_info->p_file_handle = p_info->p_next_file_handle;
+                p_info->open_track_id = p_info->next_track_id;
+                p_info->p_next_file_handle = NULL;
+                p_info->sample_rate = p_param[MAIL_NEXTSTART_FREQ];
+                p_info->channel_num = p_param[MAIL_NEXTSTART_CH];
+                break;
+            case SYS_MAILID_USB_MOUNT_FIN:
+                /* The drive is added by check_usb_event(). */
+                ret = SYS_EV_NON;
                 break;
             default:
                 /* Unexpected cases : This is fail-safe processing. */
@@ -415,46 +754,222 @@ static SYS_EVENT decode_mail(play_info_t * const p_info,
     return ret;
 }
 
+/** Checks the update of the playback status written by Decode thread
+ *
+ *  The playback status is the latest value, so the updates between the checks
+ *  are coalesced and never lost.
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ *  @param p_seq Pointer to the sequence counter of the playback status read last
+ *
+ *  @returns 
+ *    Event of the state transition. SYS_EV_NON if the status is not updated.
+ */
+static SYS_EVENT check_play_status(play_info_t * const p_info, uint32_t * const p_seq)
+{
+    SYS_EVENT       ret = SYS_EV_NON;
+    bool            result;
+    sys_status_t    status;
+
+    if ((p_info != NULL) && (p_seq != NULL)) {
+        result = sys_status_read(&play_status, &status, p_seq);
+        if (result == true) {
+            switch (status.play_stat) {
+                case SYS_PLAYSTAT_STOP:
+                    ret = SYS_EV_STAT_STOP;
+                    break;
+                case SYS_PLAYSTAT_PLAY:
+                    ret = SYS_EV_STAT_PLAY;
+                    break;
+                case SYS_PLAYSTAT_PAUSE:
+                    ret = SYS_EV_STAT_PAUSE;
+                    break;
+                default:
+                    ret = SYS_EV_NON;
+                    break;
+            }
+            /* Is the playback status correct? */
+            if (ret != SYS_EV_NON) {
+                p_info->play_stat  = status.play_stat;
+                p_info->play_time  = status.play_time;
+                p_info->total_time = status.total_time;
+                p_info->play_sample = status.play_sample;
+            } else {
+                /* Unexpected cases : This is fail-safe processing. */
+                p_info->play_stat  = SYS_PLAYSTAT_STOP;
+                p_info->play_time  = 0u;
+                p_info->total_time = 0u;
+                p_info->play_sample = 0u;
+            }
+        }
+    }
+    return ret;
+}
+
 /** Checks the event of USB connection
+ *
+ *  The drive mounted by USB attach thread is added to the track list.
+ *  The drive of which USB memory was disconnected is removed from the track
+ *  list at once if no track of it is opened. Otherwise it is removed after
+ *  the stop of the playback.
  *
  *  @param stat Status of main thread
- *  @param p_ctrl Pointer to the control data of USB memory
- *  @param p_msd Pointer to the class object of USBHostMSD
- *  @param P_fs Pointer to the class oblect of FATFileSystem
+ *  @param p_ctrl Pointer to the control data of main thread
  *
  *  @returns 
  *    The event code of SYS_EVENT
  */
-static SYS_EVENT check_usb_event(const SYS_STATE stat, 
-        const usb_ctrl_t * const p_ctrl, 
-        USBHostMSD * const p_msd, FATFileSystem * const p_fs)
+static SYS_EVENT check_usb_event(const SYS_STATE stat, sys_ctrl_t * const p_ctrl)
 {
     SYS_EVENT       ret = SYS_EV_NON;
-    int             iRet;
     bool            result;
+    uint32_t        drv;
+    uint32_t        mask;
+    drive_t         *p_drv;
 
-    if ((p_ctrl != NULL) && (p_msd != NULL)) {
-        if (stat == SYS_ST_WAIT_USB_CONNECT) {
-            /* Mounts the FAT filesystem again. */
-            /* Because the connecting USB memory is changed. */
-            result = p_msd->connect();
-            if (result == true) {
-                iRet = p_fs->unmount();
-                iRet = p_fs->mount(p_msd);
+    if (p_ctrl != NULL) {
+        for (drv = 0u; (drv < SYS_MAX_DRIVE_NUM) && (ret == SYS_EV_NON); drv++) {
+            p_drv = &drive_list[drv];
+            mask = (1u << drv);
+            if (p_drv->stat == DRIVE_STAT_MOUNTED) {
+                p_drv->stat = DRIVE_STAT_ACTIVE;
+                if (stat == SYS_ST_WAIT_USB_CONNECT) {
+                    p_ctrl->usb_ctrl.attach_steps = 0u;
+                    trace_attach(&p_ctrl->usb_ctrl, ATTACH_STEP_CONNECT, p_drv->conn_time);
+                    trace_attach(&p_ctrl->usb_ctrl, ATTACH_STEP_MOUNT, p_drv->mount_time);
+                }
+                (void) exe_scan_folder_proc(&p_ctrl->play_info, &p_ctrl->scan_data, drv);
+#if (RESUME_ON_CONNECT == 1)
+                if (stat == SYS_ST_WAIT_USB_CONNECT) {
+                    /* Nothing is selected yet, so the last track of the drive is selected. */
+                    load_resume_state(p_ctrl, drv);
+                }
+#endif /* RESUME_ON_CONNECT */
+                (void) dsp_notify_print_string(PRINT_MSG_USB_CONNECT);
                 ret = SYS_EV_USB_CONNECT;
+            } else if ((p_drv->stat == DRIVE_STAT_ACTIVE) && 
+                       ((p_ctrl->usb_ctrl.detach_drives & mask) == 0u)) {
+                result = p_drv->p_msd->connected();
+                if (result != true) {
+                    p_ctrl->usb_ctrl.detach_drives |= mask;
+                    result = is_drive_in_use(&p_ctrl->play_info, &p_ctrl->scan_data, drv);
+                    if (result == true) {
+                        /* The playback is stopped, and the drive is removed after it. */
+                        ret = SYS_EV_USB_DISCONNECT;
+                    } else {
+                        exe_remove_drive(p_ctrl, drv);
+                        result = is_drive_active();
+                        if (result != true) {
+                            ret = SYS_EV_USB_DISCONNECT;
+                        } else if (p_ctrl->play_info.p_file_handle != NULL) {
+                            /* The track IDs of the playing track and the list were changed. */
+                            print_file_name(&p_ctrl->play_info, &p_ctrl->scan_data);
+                            print_play_info(&p_ctrl->play_info);
+                        } else {
+                            /* DO NOTHING */
+                        }
+                    }
+                }
+            } else {
+                /* DO NOTHING */
+            }
+        }
+    }
+    return ret;
+}
+
+/** Scans the next folder of USB memory
+ *
+ *  The folders are scanned one by one between the other events, so that the
+ *  first track can be opened before the end of the scan.
+ *
+ *  @param stat Status of main thread
+ *  @param p_ctrl Pointer to the control data of main thread
+ *
+ *  The track of the resume state is played before the scan, and it is
+ *  replaced with the track ID when the scan finds it.
+ *
+ *  @returns 
+ *    SYS_EV_RESUME_TRACK if the track of the resume state is played automatically.
+ *    SYS_EV_SCAN_FIRST_TRACK if the first track is found and it is played
+ *    automatically. Otherwise SYS_EV_NON.
+ */
+static SYS_EVENT check_scan_event(const SYS_STATE stat, sys_ctrl_t * const p_ctrl)
+{
+    SYS_EVENT       ret = SYS_EV_NON;
+    bool            result;
+    uint32_t        total_trk;
+
+    if (p_ctrl != NULL) {
+        result = fid_is_scanning(&p_ctrl->scan_data);
+        if ((stat == SYS_ST_STOP) && (p_ctrl->resume.is_req == true)) {
+            p_ctrl->resume.is_req = false;
+#if (AUTO_PLAY_ON_CONNECT == 1)
+            if (p_ctrl->play_info.track_id == TRACK_ID_RESUME) {
+                ret = SYS_EV_RESUME_TRACK;
+            }
+#endif /* AUTO_PLAY_ON_CONNECT */
+        } else if ((stat != SYS_ST_WAIT_USB_CONNECT) && (result == true)) {
+            total_trk = fid_get_total_track(&p_ctrl->scan_data);
+            result = fid_scan_next_folder(&p_ctrl->scan_data);
+            if ((total_trk == 0u) && (fid_get_total_track(&p_ctrl->scan_data) > 0u)) {
+                trace_attach(&p_ctrl->usb_ctrl, ATTACH_STEP_TRACK, (uint32_t)attach_timer.read_ms());
+#if (AUTO_PLAY_ON_CONNECT == 1)
+                if (p_ctrl->play_info.track_id != TRACK_ID_RESUME) {
+                    ret = SYS_EV_SCAN_FIRST_TRACK;
+                }
+#endif /* AUTO_PLAY_ON_CONNECT */
+            }
+            if ((p_ctrl->play_info.track_id == TRACK_ID_RESUME) || 
+                (p_ctrl->play_info.open_track_id == TRACK_ID_RESUME)) {
+                find_resume_track(p_ctrl);
             }
-        } else if (p_ctrl->usb_flag_detach != true) {
-            result = p_msd->connected();
             if (result != true) {
-                ret = SYS_EV_USB_DISCONNECT;
+                trace_attach(&p_ctrl->usb_ctrl, ATTACH_STEP_SCAN, (uint32_t)attach_timer.read_ms());
             }
-        } else {
-            /* DO NOTHING */
         }
     }
     return ret;
 }
 
+/** Records the time of a step from the USB connection to the playback
+ *
+ *  Only the first time of each step after the connection is recorded.
+ *  When all steps are recorded, they are printed if ATTACH_TRACE_PRINT is 1.
+ *
+ *  @param p_ctrl Pointer to the control data of USB memory
+ *  @param step Step to record
+ *  @param time_ms Time of the step from the USB connection event in ms
+ */
+static void trace_attach(usb_ctrl_t * const p_ctrl, const ATTACH_STEP step, 
+                                                    const uint32_t time_ms)
+{
+    const uint32_t  all_steps = (1u << ATTACH_STEP_NUM) - 1u;
+#if (ATTACH_TRACE_PRINT == 1)
+    char_t          str[DSP_DISP_STR_MAX_LEN];
+#endif /* ATTACH_TRACE_PRINT */
+
+    if ((p_ctrl != NULL) && (step < ATTACH_STEP_NUM)) {
+        if ((p_ctrl->attach_steps & (1u << step)) == 0u) {
+            p_ctrl->attach_time[step] = time_ms;
+            p_ctrl->attach_steps |= (1u << step);
+            if (p_ctrl->attach_steps == all_steps) {
+                attach_timer.stop();
+#if (ATTACH_TRACE_PRINT == 1)
+                (void) snprintf(str, sizeof(str), PRINT_MSG_ATTACH_TRACE, 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_CONNECT], 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_MOUNT], 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_TRACK], 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_OPEN], 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_PLAY], 
+                    (unsigned long)p_ctrl->attach_time[ATTACH_STEP_SCAN]);
+                (void) dsp_notify_print_string(str);
+#endif /* ATTACH_TRACE_PRINT */
+            }
+        }
+    }
+}
+
 /** Executes the state transition processing
  *
  *  @param stat Status of main thread
@@ -519,9 +1034,7 @@ static SYS_STATE state_proc_wait_usb_connect(const SYS_STATE stat, const SYS_EVE
 
     if (p_ctrl != NULL) {
         if (event == SYS_EV_USB_CONNECT) {
-            p_ctrl->usb_ctrl.usb_flag_detach = false;
-            (void) exe_scan_folder_proc(&p_ctrl->play_info, &p_ctrl->scan_data);
-            (void) dsp_notify_print_string(PRINT_MSG_USB_CONNECT);
+            /* The drive was added to the track list by check_usb_event(). */
             next_stat = SYS_ST_STOP;
         } else if (event == SYS_EV_KEY_HELP) {
             print_help_info();
@@ -549,6 +1062,8 @@ static SYS_STATE state_proc_stop(const SYS_STATE stat, const SYS_EVENT event, sy
     if (p_ctrl != NULL) {
         switch (event) {
             case SYS_EV_KEY_PLAY_PAUSE:
+            case SYS_EV_SCAN_FIRST_TRACK:
+            case SYS_EV_RESUME_TRACK:
                 print_file_name(&p_ctrl->play_info, &p_ctrl->scan_data);
                 result = exe_open_proc(&p_ctrl->play_info, &p_ctrl->scan_data);
                 if (result == true) {
@@ -558,11 +1073,27 @@ static SYS_STATE state_proc_stop(const SYS_STATE stat, const SYS_EVENT event, sy
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
+                /* All drives were removed by check_usb_event(). */
                 next_stat = SYS_ST_WAIT_USB_CONNECT;
                 break;
             default:
@@ -609,6 +1140,22 @@ static SYS_STATE state_proc_play_prepare(const SYS_STATE stat, const SYS_EVENT e
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
@@ -649,7 +1196,6 @@ static SYS_STATE state_proc_play_prepare(const SYS_STATE stat, const SYS_EVENT e
                 next_stat = SYS_ST_STOP;
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
                 next_stat = SYS_ST_PLAY_PREPARE_REQ;
                 break;
             default:
@@ -680,6 +1226,22 @@ static SYS_STATE state_proc_play_prepare_req(const SYS_STATE stat, const SYS_EVE
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
@@ -691,25 +1253,17 @@ static SYS_STATE state_proc_play_prepare_req(const SYS_STATE stat, const SYS_EVE
                 } else {
                     /* Unexpected cases : This is fail-safe processing. */
                     exe_end_proc(&p_ctrl->play_info);
-                    if (p_ctrl->usb_ctrl.usb_flag_detach == true) {
-                        next_stat = SYS_ST_WAIT_USB_CONNECT;
-                    } else {
-                        next_stat = SYS_ST_STOP;
-                    }
+                    next_stat = exe_detach_proc(p_ctrl);
                 }
                 break;
             case SYS_EV_DEC_OPEN_COMP_ERR:
                 /* Output error message to PC */
                 (void) dsp_notify_print_string(PRINT_MSG_DECODE_ERR);
                 exe_end_proc(&p_ctrl->play_info);
-                if (p_ctrl->usb_ctrl.usb_flag_detach == true) {
-                    next_stat = SYS_ST_WAIT_USB_CONNECT;
-                } else {
-                    next_stat = SYS_ST_STOP;
-                }
+                next_stat = exe_detach_proc(p_ctrl);
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
+                /* The drive is removed after the completion. */
                 break;
             default:
                 /* Does not change the state. There is not the action. */
@@ -771,6 +1325,22 @@ static SYS_STATE state_proc_play_pause(const SYS_STATE stat, const SYS_EVENT eve
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
@@ -787,23 +1357,26 @@ static SYS_STATE state_proc_play_pause(const SYS_STATE stat, const SYS_EVENT eve
                 } else {
                     /* Unexpected cases : This is fail-safe processing. */
                     exe_end_proc(&p_ctrl->play_info);
-                    if (p_ctrl->usb_ctrl.usb_flag_detach == true) {
-                        next_stat = SYS_ST_WAIT_USB_CONNECT;
-                    } else {
-                        next_stat = SYS_ST_STOP;
-                    }
+                    next_stat = exe_detach_proc(p_ctrl);
                 }
                 break;
             case SYS_EV_STAT_PLAY:
                 print_play_time(&p_ctrl->play_info);
+                (void) exe_open_next_proc(&p_ctrl->play_info, &p_ctrl->scan_data);
                 next_stat = SYS_ST_PLAY;
                 break;
+            case SYS_EV_DEC_NEXT_START:
+                /* The next track started without the stop. */
+                p_ctrl->play_info.track_id = p_ctrl->play_info.open_track_id;
+                p_ctrl->play_info.next_track_id = TRACK_ID_ERR;
+                print_file_name(&p_ctrl->play_info, &p_ctrl->scan_data);
+                print_play_info(&p_ctrl->play_info);
+                break;
             case SYS_EV_STAT_PAUSE:
                 print_play_time(&p_ctrl->play_info);
                 next_stat = SYS_ST_PAUSE;
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
                 result = exe_stop_proc();
                 if (result == true) {
                     next_stat = SYS_ST_STOP_PREPARE;
@@ -841,34 +1414,42 @@ static SYS_STATE state_proc_stop_prepare(const SYS_STATE stat, const SYS_EVENT e
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
             case SYS_EV_DEC_CLOSE_COMP:
                 exe_end_proc(&p_ctrl->play_info);
-                if (p_ctrl->usb_ctrl.usb_flag_detach == true) {
-                    next_stat = SYS_ST_WAIT_USB_CONNECT;
-                } else {
-                    next_stat = SYS_ST_STOP;
-                }
+                next_stat = exe_detach_proc(p_ctrl);
                 break;
             case SYS_EV_STAT_STOP:
                 result = exe_close_proc();
                 if (result != true) {
                     /* Unexpected cases : This is fail-safe processing. */
                     exe_end_proc(&p_ctrl->play_info);
-                    if (p_ctrl->usb_ctrl.usb_flag_detach == true) {
-                        next_stat = SYS_ST_WAIT_USB_CONNECT;
-                    } else {
-                        next_stat = SYS_ST_STOP;
-                    }
+                    next_stat = exe_detach_proc(p_ctrl);
                 }
                 break;
             case SYS_EV_STAT_PLAY:
             case SYS_EV_STAT_PAUSE:
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
+                /* The drive is removed after the completion. */
                 break;
             default:
                 /* Does not change the state. There is not the action. */
@@ -914,6 +1495,22 @@ static SYS_STATE state_proc_stop_prepare_req(const SYS_STATE stat, const SYS_EVE
             case SYS_EV_KEY_REPEAT:
                 change_repeat_mode(&p_ctrl->play_info);
                 break;
+            case SYS_EV_KEY_VOLUP:
+            case SYS_EV_KEY_VOLDOWN:
+            case SYS_EV_KEY_MUTE:
+                change_volume(&p_ctrl->play_info, event);
+                break;
+            case SYS_EV_KEY_XFADE:
+                change_xfade_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_METER:
+                change_meter_mode(&p_ctrl->play_info);
+                break;
+            case SYS_EV_KEY_EQ_FLAT:
+            case SYS_EV_KEY_EQ_BASS:
+            case SYS_EV_KEY_EQ_TREBLE:
+                change_eq(event);
+                break;
             case SYS_EV_KEY_HELP:
                 print_help_info();
                 break;
@@ -939,7 +1536,6 @@ static SYS_STATE state_proc_stop_prepare_req(const SYS_STATE stat, const SYS_EVE
             case SYS_EV_STAT_PAUSE:
                 break;
             case SYS_EV_USB_DISCONNECT:
-                p_ctrl->usb_ctrl.usb_flag_detach = true;
                 next_stat = SYS_ST_STOP_PREPARE;
                 break;
             default:
@@ -951,22 +1547,365 @@ static SYS_STATE state_proc_stop_prepare_req(const SYS_STATE stat, const SYS_EVE
     return next_stat;
 }
 
-/** Executes the scan of the folder structure
+/** Starts the scan of the folder structure of a drive
  *
  *  @param p_info Pointer to the playback information of the playback file
  *  @param p_data Pointer to the control data of folder scan
+ *  @param drive Drive number
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
-static bool exe_scan_folder_proc(play_info_t * const p_info, fid_scan_folder_t * const p_data)
+static bool exe_scan_folder_proc(play_info_t * const p_info, 
+                        fid_scan_folder_t * const p_data, const uint32_t drive)
 {
     bool        ret = false;
 
     if ((p_info != NULL) && (p_data != NULL)) {
-        (void) fid_scan_folder_struct(p_data);
-        p_info->track_id = TRACK_ID_MIN;
-        ret = true;
+        if ((fid_get_total_track(p_data) == 0u) && (p_info->track_id != TRACK_ID_RESUME)) {
+            p_info->track_id = TRACK_ID_MIN;
+        }
+        /* The folders are scanned by check_scan_event(). */
+        /* The tracks of the drive are added after the tracks of the other drives. */
+        ret = fid_add_drive(p_data, drive);
+    }
+    return ret;
+}
+
+/** Checks whether the tracks of a drive are opened
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ *  @param p_data Pointer to the control data of folder scan
+ *  @param drive Drive number
+ *
+ *  @returns 
+ *    true if the playing track or the next track is in the drive. Otherwise false.
+ */
+static bool is_drive_in_use(const play_info_t * const p_info, 
+                        const fid_scan_folder_t * const p_data, const uint32_t drive)
+{
+    bool        ret = false;
+    bool        result;
+
+    if ((p_info != NULL) && (p_data != NULL)) {
+        if (p_info->p_file_handle != NULL) {
+            result = fid_is_drive_track(p_data, drive, p_info->open_track_id);
+            if (result == true) {
+                ret = true;
+            }
+        }
+        if (p_info->p_next_file_handle != NULL) {
+            result = fid_is_drive_track(p_data, drive, p_info->next_track_id);
+            if (result == true) {
+                ret = true;
+            }
+        }
+        if ((p_info->p_file_handle != NULL) && 
+            (p_info->open_track_id == TRACK_ID_RESUME) && (p_info->resume_drive == drive)) {
+            ret = true;
+        }
+    }
+    return ret;
+}
+
+/** Removes a drive from the track list and unmounts it
+ *
+ *  The track IDs of the playback information are changed to the IDs after
+ *  the removal. The selected track is changed to the track which follows it
+ *  if it was in the drive. The journal file of the drive is closed.
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ *  @param drive Drive number
+ */
+static void exe_remove_drive(sys_ctrl_t * const p_ctrl, const uint32_t drive)
+{
+    uint32_t    trk_ids[3];
+    uint32_t    total_trk;
+
+    if ((p_ctrl != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        trk_ids[0] = p_ctrl->play_info.track_id;
+        trk_ids[1] = p_ctrl->play_info.open_track_id;
+        trk_ids[2] = p_ctrl->play_info.next_track_id;
+        fid_remove_drive(&p_ctrl->scan_data, drive, &trk_ids[0], 
+                                            sizeof(trk_ids) / sizeof(trk_ids[0]));
+        p_ctrl->play_info.track_id = trk_ids[0];
+        p_ctrl->play_info.open_track_id = trk_ids[1];
+        p_ctrl->play_info.next_track_id = trk_ids[2];
+        total_trk = fid_get_total_track(&p_ctrl->scan_data);
+        if ((p_ctrl->play_info.track_id >= total_trk) && 
+            ((p_ctrl->play_info.track_id != TRACK_ID_RESUME) || 
+             (p_ctrl->play_info.resume_drive == drive))) {
+            p_ctrl->play_info.track_id = TRACK_ID_MIN;
+        }
+        if (p_ctrl->play_info.resume_drive == drive) {
+            p_ctrl->play_info.resume_sample = 0u;
+        }
+        /* The track IDs after the search were moved up. */
+        p_ctrl->resume.search_id = 0u;
+        p_ctrl->resume.fail_drives &= ~(1u << drive);
+        if (p_ctrl->resume.drive == drive) {
+            close_resume_journal(p_ctrl);
+        }
+
+        (void) drive_list[drive].p_fs->unmount();
+        p_ctrl->usb_ctrl.detach_drives &= ~(1u << drive);
+        drive_list[drive].stat = DRIVE_STAT_FREE;
+        /* The USB memory connected while all drives were used is attached now. */
+        (void) attach_sem.release();
+    }
+}
+
+/** Removes the disconnected drives after the stop of the playback
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ *
+ *  @returns 
+ *    Next status of main thread.
+ *    SYS_ST_WAIT_USB_CONNECT if no drive is left. Otherwise SYS_ST_STOP.
+ */
+static SYS_STATE exe_detach_proc(sys_ctrl_t * const p_ctrl)
+{
+    SYS_STATE   next_stat = SYS_ST_STOP;
+    uint32_t    drv;
+    bool        result;
+
+    if (p_ctrl != NULL) {
+        for (drv = 0u; drv < SYS_MAX_DRIVE_NUM; drv++) {
+            if ((p_ctrl->usb_ctrl.detach_drives & (1u << drv)) != 0u) {
+                exe_remove_drive(p_ctrl, drv);
+            }
+        }
+        result = is_drive_active();
+        if (result != true) {
+            next_stat = SYS_ST_WAIT_USB_CONNECT;
+        }
+    }
+    return next_stat;
+}
+
+/** Opens the journal of the resume state in a drive
+ *
+ *  The journal of the other drive is closed. The journal file is created
+ *  if the drive does not have it. The drive of which journal file failed
+ *  is not tried again until it is removed.
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ *  @param drive Drive number
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool open_resume_journal(sys_ctrl_t * const p_ctrl, const uint32_t drive)
+{
+    bool        ret = false;
+
+    if ((p_ctrl != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        if ((p_ctrl->resume.journal.p_bd != NULL) && (p_ctrl->resume.drive == drive)) {
+            ret = true;
+        } else if ((p_ctrl->resume.fail_drives & (1u << drive)) == 0u) {
+            close_resume_journal(p_ctrl);
+            ret = sys_resume_open(&p_ctrl->resume.journal, drive_list[drive].p_journal);
+            if (ret == true) {
+                p_ctrl->resume.drive = drive;
+            } else {
+                p_ctrl->resume.fail_drives |= (1u << drive);
+            }
+        } else {
+            /* DO NOTHING */
+        }
+    }
+    return ret;
+}
+
+/** Closes the journal of the resume state
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ */
+static void close_resume_journal(sys_ctrl_t * const p_ctrl)
+{
+    if (p_ctrl != NULL) {
+        sys_resume_close(&p_ctrl->resume.journal);
+        p_ctrl->resume.drive = SYS_MAX_DRIVE_NUM;
+    }
+}
+
+/** Loads the resume state from the journal of a drive
+ *
+ *  The settings are restored, and the saved track is selected as
+ *  TRACK_ID_RESUME. It is opened by its path, so the playback does not wait
+ *  for the scan of the folders.
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ *  @param drive Drive number
+ */
+static void load_resume_state(sys_ctrl_t * const p_ctrl, const uint32_t drive)
+{
+    sys_resume_state_t  state;
+    play_info_t         *p_info;
+    bool                result;
+
+    if ((p_ctrl != NULL) && (drive < SYS_MAX_DRIVE_NUM)) {
+        p_info = &p_ctrl->play_info;
+        result = open_resume_journal(p_ctrl, drive);
+        if (result == true) {
+            result = sys_resume_read(&p_ctrl->resume.journal, &state);
+        }
+        if (result == true) {
+            p_info->volume = state.volume;
+            if (p_info->volume > DEC_VOLUME_MAX) {
+                p_info->volume = DEC_VOLUME_MAX;
+            }
+            if (p_info->volume < DEC_VOLUME_MIN) {
+                p_info->volume = DEC_VOLUME_MIN;
+            }
+            p_info->mute = (state.mute != 0u);
+            (void) dec_set_volume(p_info->volume, p_info->mute);
+            if (state.xfade_mode != 0u) {
+                result = dec_set_xfade(XFADE_TIME_MS, XFADE_CURVE);
+            } else {
+                result = dec_set_xfade(0u, XFADE_CURVE);
+            }
+            if (result == true) {
+                p_info->xfade_mode = (state.xfade_mode != 0u);
+            }
+            p_info->repeat_mode = (state.repeat_mode != 0u);
+            (void) dsp_notify_play_mode(p_info->repeat_mode);
+            p_info->meter_mode = (state.meter_mode != 0u);
+            (void) dsp_notify_meter_mode(p_info->meter_mode);
+            if (state.path[0] != '\0') {
+                (void) snprintf(p_info->resume_path, sizeof(p_info->resume_path), 
+                                    "/%s/%s", drive_list[drive].name, state.path);
+                p_info->resume_drive = drive;
+                p_info->resume_sample = state.sample;
+                p_info->track_id = TRACK_ID_RESUME;
+                p_ctrl->resume.is_req = true;
+                p_ctrl->resume.search_id = 0u;
+            }
+        }
+    }
+}
+
+/** Saves the resume state to the journal of the drive of the selected track
+ *
+ *  The journal batches the change of the position during the playback. The
+ *  write is forced at the pause and the stop. When the selected track moves
+ *  to another drive, the track of the old journal is cleared, so the old
+ *  drive does not resume the track selected before.
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ */
+static void save_resume_state(sys_ctrl_t * const p_ctrl)
+{
+    sys_resume_state_t  state;
+    const play_info_t   *p_info;
+    const char_t        *p_path = NULL;
+    uint32_t            drv;
+    bool                result;
+    bool                force;
+
+    if (p_ctrl != NULL) {
+        p_info = &p_ctrl->play_info;
+        if (p_info->track_id == TRACK_ID_RESUME) {
+            drv = p_info->resume_drive;
+            p_path = p_info->resume_path;
+        } else {
+            drv = get_track_drive(&p_ctrl->scan_data, p_info->track_id);
+            if (drv < SYS_MAX_DRIVE_NUM) {
+                p_path = fid_get_track_path(&p_ctrl->scan_data, p_info->track_id);
+            }
+        }
+        if ((p_path != NULL) && (drv < SYS_MAX_DRIVE_NUM) && 
+            ((p_ctrl->usb_ctrl.detach_drives & (1u << drv)) == 0u) && 
+            (strlen(p_path) > RESUME_ROOT_SIZE)) {
+            (void) memset(&state, 0, sizeof(state));
+            /* The track of the too long path is not resumed, but the settings are. */
+            if (strlen(&p_path[RESUME_ROOT_SIZE]) < sizeof(state.path)) {
+                (void) strcpy(state.path, &p_path[RESUME_ROOT_SIZE]);
+            }
+            state.volume = p_info->volume;
+            state.mute = (p_info->mute == true) ? 1u : 0u;
+            state.repeat_mode = (p_info->repeat_mode == true) ? 1u : 0u;
+            state.xfade_mode = (p_info->xfade_mode == true) ? 1u : 0u;
+            state.meter_mode = (p_info->meter_mode == true) ? 1u : 0u;
+            force = (p_info->p_file_handle == NULL) || (p_info->play_stat == SYS_PLAYSTAT_PAUSE);
+            if (p_info->p_file_handle != NULL) {
+                if (p_info->open_track_id == p_info->track_id) {
+                    state.sample = p_info->play_sample;
+                }
+            } else {
+                state.sample = p_info->resume_sample;
+            }
+            if ((p_ctrl->resume.journal.p_bd != NULL) && (p_ctrl->resume.drive != drv)) {
+                state.path[0] = '\0';
+                state.sample = 0u;
+                (void) sys_resume_write(&p_ctrl->resume.journal, &state, true, us_ticker_read());
+                close_resume_journal(p_ctrl);
+                /* Restores the track for the new journal. */
+                if (strlen(&p_path[RESUME_ROOT_SIZE]) < sizeof(state.path)) {
+                    (void) strcpy(state.path, &p_path[RESUME_ROOT_SIZE]);
+                }
+                force = true;
+            }
+            result = open_resume_journal(p_ctrl, drv);
+            if (result == true) {
+                (void) sys_resume_write(&p_ctrl->resume.journal, &state, force, us_ticker_read());
+            }
+        }
+    }
+}
+
+/** Finds the track of the resume state in the tracks added by the scan
+ *
+ *  TRACK_ID_RESUME is replaced with the track ID, so the track list and the
+ *  next track work as the track selected by the keys.
+ *
+ *  @param p_ctrl Pointer to the control data of main thread
+ */
+static void find_resume_track(sys_ctrl_t * const p_ctrl)
+{
+    uint32_t    total_trk;
+    uint32_t    trk_id;
+    bool        result;
+
+    if (p_ctrl != NULL) {
+        total_trk = fid_get_total_track(&p_ctrl->scan_data);
+        if (p_ctrl->resume.search_id < total_trk) {
+            result = fid_find_track(&p_ctrl->scan_data, p_ctrl->play_info.resume_path, 
+                                                p_ctrl->resume.search_id, &trk_id);
+            /* The scan only appends the tracks. */
+            p_ctrl->resume.search_id = total_trk;
+            if (result == true) {
+                if (p_ctrl->play_info.track_id == TRACK_ID_RESUME) {
+                    p_ctrl->play_info.track_id = trk_id;
+                }
+                if (p_ctrl->play_info.open_track_id == TRACK_ID_RESUME) {
+                    p_ctrl->play_info.open_track_id = trk_id;
+                }
+                print_file_name(&p_ctrl->play_info, &p_ctrl->scan_data);
+            }
+        }
+    }
+}
+
+/** Gets the drive of a track
+ *
+ *  @param p_data Pointer to the control data of folder scan
+ *  @param trk_id Track ID
+ *
+ *  @returns 
+ *    Drive number. SYS_MAX_DRIVE_NUM if the track is not found.
+ */
+static uint32_t get_track_drive(const fid_scan_folder_t * const p_data, const uint32_t trk_id)
+{
+    uint32_t    ret = SYS_MAX_DRIVE_NUM;
+    uint32_t    drv;
+    bool        result;
+
+    for (drv = 0u; (drv < SYS_MAX_DRIVE_NUM) && (ret == SYS_MAX_DRIVE_NUM); drv++) {
+        result = fid_is_drive_track(p_data, drv, trk_id);
+        if (result == true) {
+            ret = drv;
+        }
     }
     return ret;
 }
@@ -985,17 +1924,27 @@ static bool exe_open_proc(play_info_t * const p_info, fid_scan_folder_t * const
     bool        result;
     FILE        *fp;
     uint32_t    total_trk;
+    uint32_t    start;
 
     if ((p_info != NULL) && (p_data != NULL)) {
         total_trk = fid_get_total_track(p_data);
-        if (p_info->track_id < total_trk) {
-            fp = fid_open_track(p_data, p_info->track_id);
+        if ((p_info->track_id < total_trk) || (p_info->track_id == TRACK_ID_RESUME)) {
+            if (p_info->track_id == TRACK_ID_RESUME) {
+                /* Opens the track of the resume state by its path without the scan. */
+                fp = fopen(p_info->resume_path, RESUME_OPEN_MODE);
+            } else {
+                fp = fid_open_track(p_data, p_info->track_id);
+            }
+            start = p_info->resume_sample;
             if (fp != NULL) {
-                result = dec_open(fp, &open_callback);
+                result = dec_open(fp, start, &open_callback);
                 if (result == true) {
                     /* Executes fid_close_track() in exe_end_proc(). */
                     p_info->p_file_handle = fp;
                     p_info->open_track_id = p_info->track_id;
+                    p_info->play_sample = start;
+                    /* The next playback of the track starts from the top. */
+                    p_info->resume_sample = 0u;
                     ret = true;
                 } else {
                     /* The opening of the decoder was failure. */
@@ -1043,6 +1992,48 @@ static bool exe_play_proc(play_info_t * const p_info, const fid_scan_folder_t *
     return ret;
 }
 
+/** Executes the opening process of the next track near the end of the playing track
+ *
+ *  It is done once per track when the crossfade mode is on.
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ *  @param p_data Pointer to the control data of folder scan
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool exe_open_next_proc(play_info_t * const p_info, fid_scan_folder_t * const p_data)
+{
+    bool        ret = false;
+    bool        result;
+    FILE        *fp;
+    uint32_t    next_trk;
+
+    if ((p_info != NULL) && (p_data != NULL)) {
+        if ((p_info->xfade_mode == true) && (p_info->next_track_id == TRACK_ID_ERR) && 
+            (p_info->play_time <= p_info->total_time) && 
+            ((p_info->total_time - p_info->play_time) <= (XFADE_TIME_SEC + XFADE_OPEN_MARGIN_SEC))) {
+            result = get_next_track_id(p_info, p_data, &next_trk);
+            if (result == true) {
+                /* Does not retry this track even if the opening fails. */
+                p_info->next_track_id = next_trk;
+                fp = fid_open_track(p_data, next_trk);
+                if (fp != NULL) {
+                    result = dec_open_next(fp, &next_open_callback, &next_start_callback);
+                    if (result == true) {
+                        /* Executes fid_close_track() in exe_end_proc() or at the start. */
+                        p_info->p_next_file_handle = fp;
+                        ret = true;
+                    } else {
+                        fid_close_track(fp);
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
+
 /** Executes the starting process of the pause
  *
  *  @returns 
@@ -1105,6 +2096,10 @@ static void exe_end_proc(play_info_t * const p_info)
         fid_close_track(p_info->p_file_handle);
         p_info->p_file_handle = NULL;
         p_info->open_track_id = TRACK_ID_ERR;
+        /* Decode thread closed the next track together. */
+        fid_close_track(p_info->p_next_file_handle);
+        p_info->p_next_file_handle = NULL;
+        p_info->next_track_id = TRACK_ID_ERR;
     }
 }
 
@@ -1143,21 +2138,151 @@ static void change_repeat_mode(play_info_t * const p_info)
     }
 }
 
-/** Changes the next track
+/** Changes the volume
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ *  @param event Event code of the volume key
+ */
+static void change_volume(play_info_t * const p_info, const SYS_EVENT event)
+{
+    char_t          str[DSP_DISP_STR_MAX_LEN];
+
+    if (p_info != NULL) {
+        switch (event) {
+            case SYS_EV_KEY_VOLUP:
+                p_info->volume += VOLUME_STEP;
+                if (p_info->volume > DEC_VOLUME_MAX) {
+                    p_info->volume = DEC_VOLUME_MAX;
+                }
+                p_info->mute = false;
+                break;
+            case SYS_EV_KEY_VOLDOWN:
+                p_info->volume -= VOLUME_STEP;
+                if (p_info->volume < DEC_VOLUME_MIN) {
+                    p_info->volume = DEC_VOLUME_MIN;
+                }
+                p_info->mute = false;
+                break;
+            case SYS_EV_KEY_MUTE:
+                if (p_info->mute == true) {
+                    p_info->mute = false;
+                } else {
+                    p_info->mute = true;
+                }
+                break;
+            default:
+                /* DO NOTHING */
+                break;
+        }
+        (void) dec_set_volume(p_info->volume, p_info->mute);
+        if (p_info->mute == true) {
+            (void) dsp_notify_print_string(PRINT_MSG_MUTE);
+        } else {
+            (void) sprintf(str, PRINT_MSG_VOLUME, p_info->volume);
+            (void) dsp_notify_print_string(str);
+        }
+    }
+}
+
+/** Changes the crossfade mode
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ */
+static void change_xfade_mode(play_info_t * const p_info)
+{
+    bool            result;
+
+    if (p_info != NULL) {
+        if (p_info->xfade_mode == true) {
+            result = dec_set_xfade(0u, XFADE_CURVE);
+        } else {
+            result = dec_set_xfade(XFADE_TIME_MS, XFADE_CURVE);
+        }
+        if (result == true) {
+            if (p_info->xfade_mode == true) {
+                p_info->xfade_mode = false;
+            } else {
+                p_info->xfade_mode = true;
+            }
+        }
+        if (p_info->xfade_mode == true) {
+            (void) dsp_notify_print_string(PRINT_MSG_XFADE_ON);
+        } else {
+            (void) dsp_notify_print_string(PRINT_MSG_XFADE_OFF);
+        }
+    }
+}
+
+/** Changes the level meter mode
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ */
+static void change_meter_mode(play_info_t * const p_info)
+{
+    if (p_info != NULL) {
+        if (p_info->meter_mode == true) {
+            p_info->meter_mode = false;
+        } else {
+            p_info->meter_mode = true;
+        }
+        (void) dsp_notify_meter_mode(p_info->meter_mode);
+    }
+}
+
+/** Sets the preset of the equalizer
+ *
+ *  @param event Event code of the equalizer key
+ */
+static void change_eq(const SYS_EVENT event)
+{
+    char_t              str[DSP_DISP_STR_MAX_LEN];
+    const eq_param_t    *p_param;
+    const char_t        *p_name;
+    static const eq_param_t bass = {
+        1u, { { EQ_TYPE_LOW_SHELF,  EQ_PRESET_BASS_FREQ,   EQ_PRESET_GAIN, EQ_PRESET_Q } }
+    };
+    static const eq_param_t treble = {
+        1u, { { EQ_TYPE_HIGH_SHELF, EQ_PRESET_TREBLE_FREQ, EQ_PRESET_GAIN, EQ_PRESET_Q } }
+    };
+
+    switch (event) {
+        case SYS_EV_KEY_EQ_BASS:
+            p_param = &bass;
+            p_name = "bass";
+            break;
+        case SYS_EV_KEY_EQ_TREBLE:
+            p_param = &treble;
+            p_name = "treble";
+            break;
+        default:
+            p_param = NULL;
+            p_name = "flat";
+            break;
+    }
+    if (dec_set_eq(p_param) == true) {
+        (void) sprintf(str, PRINT_MSG_EQ, p_name);
+        (void) dsp_notify_print_string(str);
+    }
+}
+
+/** Gets the track which follows the selected track
  *
  *  @param p_info Pointer to the playback information of the playback file
  *  @param p_data Pointer to the control data of folder scan
+ *  @param p_trk_id Pointer to store the number of the next track
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
+ *    It is false at the end of the playback range.
  */
-static bool change_next_track(play_info_t * const p_info, const fid_scan_folder_t * const p_data)
+static bool get_next_track_id(const play_info_t * const p_info, 
+                const fid_scan_folder_t * const p_data, uint32_t * const p_trk_id)
 {
     bool        ret = false;
     uint32_t    next_trk;
     uint32_t    total_trk;
 
-    if ((p_info != NULL) && (p_data != NULL)) {
+    if ((p_info != NULL) && (p_data != NULL) && (p_trk_id != NULL)) {
         next_trk = p_info->track_id + 1u;
         total_trk = fid_get_total_track(p_data);
         if (next_trk < total_trk) {
@@ -1168,7 +2293,28 @@ static bool change_next_track(play_info_t * const p_info, const fid_scan_folder_
                 ret = true;
             }
         }
+        *p_trk_id = next_trk;
+    }
+    return ret;
+}
+
+/** Changes the next track
+ *
+ *  @param p_info Pointer to the playback information of the playback file
+ *  @param p_data Pointer to the control data of folder scan
+ *
+ *  @returns 
+ *    Results of process. true is success. false is failure.
+ */
+static bool change_next_track(play_info_t * const p_info, const fid_scan_folder_t * const p_data)
+{
+    bool        ret = false;
+    uint32_t    next_trk;
+
+    if ((p_info != NULL) && (p_data != NULL)) {
+        ret = get_next_track_id(p_info, p_data, &next_trk);
         p_info->track_id = next_trk;
+        p_info->resume_sample = 0u;
     }
     return ret;
 }
@@ -1205,6 +2351,7 @@ static bool change_prev_track(play_info_t * const p_info, const fid_scan_folder_
             }
         }
         p_info->track_id = prev_trk;
+        p_info->resume_sample = 0u;
     }
     return ret;
 }
@@ -1247,13 +2394,34 @@ static void print_file_name(const play_info_t * const p_info, const fid_scan_fol
     const char_t    *p_path;
     uint32_t        trk_id;
     uint32_t        trk_total;
+    uint32_t        row;
+    uint32_t        list_id;
 
     if ((p_info != NULL) && (p_data != NULL)) {
         trk_id = p_info->track_id;
         trk_total = fid_get_total_track(p_data);
-        if (trk_id < trk_total) {
+        if (trk_id == TRACK_ID_RESUME) {
+            /* The track list is shown after the scan finds the track. */
+            p_path = strrchr(p_info->resume_path, '/');
+            if (p_path != NULL) {
+                (void) dsp_notify_file_name(&p_path[1]);
+            }
+            for (row = 0u; row < DSP_LIST_ROW_NUM; row++) {
+                (void) dsp_notify_list_name(row, 0u, "");
+            }
+        } else if (trk_id < trk_total) {
             p_path = fid_get_track_name(p_data, trk_id);
             (void) dsp_notify_file_name(p_path);
+            /* The track list shows the tracks around the playing track. */
+            for (row = 0u; row < DSP_LIST_ROW_NUM; row++) {
+                list_id = (trk_id + row) - (DSP_LIST_ROW_NUM / 2u);
+                if (((trk_id + row) >= (DSP_LIST_ROW_NUM / 2u)) && (list_id < trk_total)) {
+                    p_path = fid_get_track_name(p_data, list_id);
+                    (void) dsp_notify_list_name(row, convert_track_id(list_id), p_path);
+                } else {
+                    (void) dsp_notify_list_name(row, 0u, "");
+                }
+            }
         }
     }
 }
@@ -1324,12 +2492,14 @@ static bool send_mail(const SYS_MAIL_ID mail_id, const uint32_t param0,
  *  @param p_param0 Pointer to the variable to store the parameter 0 of this mail
  *  @param p_param1 Pointer to the variable to store the parameter 1 of this mail
  *  @param p_param2 Pointer to the variable to store the parameter 2 of this mail
+ *  @param timeout_ms Time in ms to wait the mail
  *
  *  @returns 
  *    Results of process. true is success. false is failure.
  */
 static bool recv_mail(SYS_MAIL_ID * const p_mail_id, uint32_t * const p_param0, 
-                        uint32_t * const p_param1, uint32_t * const p_param2)
+                        uint32_t * const p_param1, uint32_t * const p_param2, 
+                        const uint32_t timeout_ms)
 {
     bool            ret = false;
     osEvent         evt;
@@ -1337,7 +2507,7 @@ static bool recv_mail(SYS_MAIL_ID * const p_mail_id, uint32_t * const p_param0,
 
     if ((p_mail_id != NULL) && (p_param0 != NULL) && 
         (p_param1 != NULL) && (p_param2 != NULL)) {
-        evt = mail_box.get(RECV_MAIL_TIMEOUT_MS);
+        evt = mail_box.get(timeout_ms);
         if (evt.status == osEventMail) {
             p_mail = (sys_mail_t *)evt.value.p;
             if (p_mail != NULL) {
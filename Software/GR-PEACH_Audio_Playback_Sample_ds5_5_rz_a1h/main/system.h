@@ -35,7 +35,13 @@
 #define SYS_MAX_PATH_LENGTH     (511)       /* Maximum length of the full path */
 
 /* It is the name to mount the file system of the USBHostMSD class. */
+/* The drive number is added to it. ("usb0", "usb1", ...) */
 #define SYS_USB_MOUNT_NAME      "usb"
+/* Supported number of USB memories connected through a USB hub (1 - 9) */
+/* _VOLUMES of FatFs must be SYS_MAX_DRIVE_NUM or more. */
+#define SYS_MAX_DRIVE_NUM       (4u)
+
+#define SYS_ATTACH_STACK_SIZE   (2048u)     /* Stack size of USB attach thread */
 
 /*--- User defined types of main thread ---*/
 /* Key code */
@@ -48,6 +54,14 @@ typedef enum {
     SYS_KEYCODE_PLAYINFO,       /* Play info */
     SYS_KEYCODE_REPEAT,         /* Repeat */
     SYS_KEYCODE_HELP,           /* Help */
+    SYS_KEYCODE_VOLUP,          /* Volume up */
+    SYS_KEYCODE_VOLDOWN,        /* Volume down */
+    SYS_KEYCODE_MUTE,           /* Mute */
+    SYS_KEYCODE_XFADE,          /* Crossfade */
+    SYS_KEYCODE_METER,          /* Level meter */
+    SYS_KEYCODE_EQ_FLAT,        /* Equalizer off */
+    SYS_KEYCODE_EQ_BASS,        /* Equalizer preset: bass boost */
+    SYS_KEYCODE_EQ_TREBLE,      /* Equalizer preset: treble boost */
     SYS_KEYCODE_NUM
 } SYS_KeyCode;
 
@@ -65,6 +79,15 @@ typedef enum {
  */
 void system_main(void);
 
+/** USB Attach Thread
+ *
+ *  Connects and mounts USB memory when a USB device is connected, so that
+ *  the main thread and the playback are not blocked during the attach.
+ *
+ *  @param argument Pointer to the thread function as start argument.
+ */
+void sys_attach_thread(void const *argument);
+
 /** Notifies the main thread of the key input information.
  *
  *  @param key_code key code
@@ -75,6 +98,13 @@ void system_main(void);
  *                    Show song information : SYS_KEYCODE_PLAYINFO
  *                    Switch repeat mode : SYS_KEYCODE_REPEAT
  *                    Show help message: SYS_KEYCODE_HELP
+ *                    Volume up : SYS_KEYCODE_VOLUP
+ *                    Volume down : SYS_KEYCODE_VOLDOWN
+ *                    Switch mute : SYS_KEYCODE_MUTE
+ *                    Switch crossfade : SYS_KEYCODE_XFADE
+ *                    Switch level meter : SYS_KEYCODE_METER
+ *                    Set equalizer preset : SYS_KEYCODE_EQ_FLAT, SYS_KEYCODE_EQ_BASS,
+ *                                           SYS_KEYCODE_EQ_TREBLE
  *
  *  @returns 
  *    Returns true if the API is successful. Returns false if the API fails.
@@ -84,7 +114,11 @@ void system_main(void);
  */
 bool sys_notify_key_input(const SYS_KeyCode key_code);
 
-/** Notifies the main thread of the play time, total play time, and play state.
+/** Notifies the main thread of the play time, total play time, play position, and play state.
+ *
+ *  The values are written to the status block which the main thread polls, not
+ *  sent by the mail. The main thread gets the latest values, so the notification
+ *  is never lost even if the mailbox is full.
  *
  *  @param play_stat Playback state
  *                     Stopped : SYS_PLAYSTAT_STOP
@@ -96,14 +130,13 @@ bool sys_notify_key_input(const SYS_KeyCode key_code);
  *  @param total_time Total play time (in seconds)
  *                      0 to 359999
  *                      * 0 hour, 0 minute, 0 second to 99 hours, 59 minutes, 59 seconds
+ *  @param play_sample Playback position (in samples)
+ *                       The position where the playback resumes after the pause
  *
  *  @returns 
- *    Returns true if the API is successful. Returns false if the API fails.
- *    This function fails when:
- *     Failed to secure memory for mailbox communication.
- *     Failed to perform transmit processing for mailbox communication.
+ *    Returns true always.
  */
 bool sys_notify_play_time(const SYS_PlayStat play_stat, 
-    const uint32_t play_time, const uint32_t total_time);
+    const uint32_t play_time, const uint32_t total_time, const uint32_t play_sample);
 
 #endif /* SYSTEM_H */
@@ -0,0 +1,147 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FileBlockDevice.h"
+
+
+FileBlockDevice::FileBlockDevice(FileSystem *fs, const char *path, bd_size_t size, bd_size_t block)
+    : _fs(fs), _path(path), _is_open(false)
+    , _block_size(block), _size(size)
+{
+    MBED_ASSERT((size / block) * block == size);
+}
+
+FileBlockDevice::~FileBlockDevice()
+{
+    deinit();
+}
+
+int FileBlockDevice::init()
+{
+    if (_is_open) {
+        return BD_ERROR_OK;
+    }
+
+    int err = _file.open(_fs, _path, O_RDWR);
+    if (err) {
+        // The file is created once with all blocks
+        err = create();
+    } else if (_file.size() < _size) {
+        _file.close();
+        err = BD_ERROR_DEVICE_ERROR;
+    }
+
+    if (!err) {
+        _is_open = true;
+    }
+    return err;
+}
+
+int FileBlockDevice::deinit()
+{
+    if (!_is_open) {
+        return BD_ERROR_OK;
+    }
+
+    _is_open = false;
+    return _file.close();
+}
+
+bd_size_t FileBlockDevice::get_read_size() const
+{
+    return _block_size;
+}
+
+bd_size_t FileBlockDevice::get_program_size() const
+{
+    return _block_size;
+}
+
+bd_size_t FileBlockDevice::get_erase_size() const
+{
+    return _block_size;
+}
+
+bd_size_t FileBlockDevice::size() const
+{
+    return _size;
+}
+
+int FileBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_read(addr, size));
+    if (!_is_open) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    if (_file.seek(addr) != (off_t)addr) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    if (_file.read(b, size) != (ssize_t)size) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return 0;
+}
+
+int FileBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_program(addr, size));
+    if (!_is_open) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    // The blocks are in the allocated clusters, so the file is not synced
+    if (_file.seek(addr) != (off_t)addr) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    if (_file.write(b, size) != (ssize_t)size) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+    return 0;
+}
+
+int FileBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    MBED_ASSERT(is_valid_erase(addr, size));
+
+    return 0;
+}
+
+int FileBlockDevice::create()
+{
+    int err = _file.open(_fs, _path, O_RDWR | O_CREAT | O_TRUNC);
+    if (err) {
+        return err;
+    }
+
+    uint8_t *buffer = new uint8_t[_block_size];
+    memset(buffer, 0xff, _block_size);
+    for (bd_size_t addr = 0; (addr < _size) && !err; addr += _block_size) {
+        if (_file.write(buffer, _block_size) != (ssize_t)_block_size) {
+            err = BD_ERROR_DEVICE_ERROR;
+        }
+    }
+    delete[] buffer;
+
+    // The size and the clusters are written to the directory and the FAT
+    if (!err) {
+        err = _file.sync();
+    }
+    if (err) {
+        _file.close();
+    }
+    return err;
+}
@@ -0,0 +1,146 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MBED_FILE_BLOCK_DEVICE_H
+#define MBED_FILE_BLOCK_DEVICE_H
+
+#include "BlockDevice.h"
+#include "File.h"
+#include "mbed.h"
+
+
+/** Block device stored in a file of a filesystem
+ *
+ *  The file is created with the size of the block device when it does not
+ *  exist, so the clusters of the file are allocated once. After that, a
+ *  program of whole blocks is written to the clusters of the file directly,
+ *  and the FAT and the directory are not written again. The file is kept open
+ *  between init() and deinit().
+ *
+ *  An erase does nothing, the same as HeapBlockDevice. The state of an erased
+ *  block is undefined until it has been programmed.
+ *
+ *  @code
+ *  #include "mbed.h"
+ *  #include "FATFileSystem.h"
+ *  #include "FileBlockDevice.h"
+ *
+ *  FATFileSystem fs("usb");
+ *  FileBlockDevice bd(&fs, "journal.bin", 8*512, 512);
+ *  @endcode
+ */
+class FileBlockDevice : public BlockDevice
+{
+public:
+
+    /** Lifetime of the file block device
+     *
+     *  @param fs       Filesystem of the file, mounted before init()
+     *  @param path     Path of the file in the filesystem, kept by the caller
+     *  @param size     Size of the block device in bytes
+     *  @param block    Size of a block in bytes
+     */
+    FileBlockDevice(FileSystem *fs, const char *path, bd_size_t size, bd_size_t block=512);
+    virtual ~FileBlockDevice();
+
+    /** Initialize a block device
+     *
+     *  Opens the file, and creates it if it does not exist
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int init();
+
+    /** Deinitialize a block device
+     *
+     *  Closes the file
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int deinit();
+
+    /** Read blocks from a block device
+     *
+     *  @param buffer   Buffer to read blocks into
+     *  @param addr     Address of block to begin reading from
+     *  @param size     Size to read in bytes, must be a multiple of read block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Program blocks to a block device
+     *
+     *  The blocks must have been erased prior to being programmed
+     *
+     *  @param buffer   Buffer of data to write to blocks
+     *  @param addr     Address of block to begin writing to
+     *  @param size     Size to write in bytes, must be a multiple of program block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Erase blocks on a block device
+     *
+     *  The state of an erased block is undefined until it has been programmed
+     *
+     *  @param addr     Address of block to begin erasing
+     *  @param size     Size to erase in bytes, must be a multiple of erase block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+
+    /** Get the size of a readable block
+     *
+     *  @return         Size of a readable block in bytes
+     */
+    virtual bd_size_t get_read_size() const;
+
+    /** Get the size of a programable block
+     *
+     *  @return         Size of a programable block in bytes
+     */
+    virtual bd_size_t get_program_size() const;
+
+    /** Get the size of a eraseable block
+     *
+     *  @return         Size of a eraseable block in bytes
+     */
+    virtual bd_size_t get_erase_size() const;
+
+    /** Get the total size of the underlying device
+     *
+     *  @return         Size of the underlying device in bytes
+     */
+    virtual bd_size_t size() const;
+
+private:
+    FileSystem *_fs;
+    const char *_path;
+    File _file;
+    bool _is_open;
+    bd_size_t _block_size;
+    bd_size_t _size;
+
+    int create();
+};
+
+
+#endif
@@ -44,6 +44,7 @@
 #endif
 
 #define	ABORT(fs, res)		{ fp->err = (BYTE)(res); LEAVE_FF(fs, res); }
+#define	ABORT_NL(res)		{ fp->err = (BYTE)(res); return res; }	/* ABORT() without releasing the grant */
 
 
 /* Definitions of sector size */
@@ -428,6 +429,29 @@ typedef struct {
 #define	DDEM				0xE5	/* Deleted directory entry mark at DIR_Name[0] */
 #define	RDDEM				0x05	/* Replacement of the character collides with DDEM */
 
+#define BS_FilSysTypeEx		3		/* exFAT: File system name "EXFAT   " (8) */
+#define BPB_FatOfsEx		80		/* exFAT: FAT offset from the volume top [sector] (4) */
+#define BPB_FatSzEx			84		/* exFAT: FAT size [sector] (4) */
+#define BPB_DataOfsEx		88		/* exFAT: Cluster heap offset from the volume top [sector] (4) */
+#define BPB_NumClusEx		92		/* exFAT: Number of clusters (4) */
+#define BPB_RootClusEx		96		/* exFAT: Root directory first cluster (4) */
+#define BPB_BytsPerSecEx	108		/* exFAT: Sector size shift (1) */
+#define BPB_SecPerClusEx	109		/* exFAT: Cluster size shift (1) */
+#define BPB_NumFATsEx		110		/* exFAT: Number of FAT copies (1) */
+#define	XDIR_Type			0		/* exFAT: Entry type (1) */
+#define	XDIR_NumSec			1		/* exFAT: Number of secondary entries in the set (1) */
+#define	XDIR_Attr			4		/* exFAT: File attribute (2) */
+#define	XDIR_ModTime		12		/* exFAT: Modified time and date (4) */
+#define	XDIR_GenFlags		1		/* exFAT: General secondary flags (1) */
+#define	XDIR_NumName		3		/* exFAT: Number of name characters (1) */
+#define	XDIR_FstClus		20		/* exFAT: First cluster (4) */
+#define	XDIR_FileSize		24		/* exFAT: Data length (8) */
+#define	XDIR_Name			2		/* exFAT: Name characters in a name entry (30) */
+#define	ET_FILEDIR			0x85	/* exFAT: File entry, the top of an entry set */
+#define	ET_STREAM			0xC0	/* exFAT: Stream extension entry */
+#define	ET_FILENAME			0xC1	/* exFAT: File name entry */
+#define	XSF_NOFATCHAIN		0x02	/* exFAT: NoFatChain flag in XDIR_GenFlags */
+
 
 
 
@@ -475,13 +499,17 @@ static WCHAR LfnBuf[_MAX_LFN + 1];
 #define	FREE_BUF()
 #elif _USE_LFN == 3 		/* LFN feature with dynamic working buffer on the heap */
 #define	DEFINE_NAMEBUF		BYTE sfn[12]; WCHAR *lfn
-#define INIT_BUF(dobj)		{ lfn = ff_memalloc((_MAX_LFN + 1) * 2); if (!lfn) LEAVE_FF((dobj).fs, FR_NOT_ENOUGH_CORE); (dobj).lfn = lfn; (dobj).fn = sfn; }
+#define INIT_BUF(dobj)		{ lfn = (WCHAR*)ff_memalloc((_MAX_LFN + 1) * 2); if (!lfn) LEAVE_FF((dobj).fs, FR_NOT_ENOUGH_CORE); (dobj).lfn = lfn; (dobj).fn = sfn; }
 #define	FREE_BUF()			ff_memfree(lfn)
 #else
 #error Wrong _USE_LFN setting
 #endif
 #endif
 
+#if _FS_EXFAT && (!_USE_LFN || _FS_RPATH)
+#error exFAT support needs LFN feature and cannot be used with relative path feature
+#endif
+
 #ifdef _EXCVT
 static const BYTE ExCvt[] = _EXCVT;	/* Upper conversion table for SBCS extended characters */
 #endif
@@ -853,6 +881,14 @@ DWORD get_fat (	/* 0xFFFFFFFF:Disk error, 1:Internal error, 2..0x0FFFFFFF:Cluste
 			val = LD_DWORD(p) & 0x0FFFFFFF;
 			break;
 
+#if _FS_EXFAT
+		case FS_EXFAT :
+			if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 4))) != FR_OK) break;
+			p = &fs->win[clst * 4 % SS(fs)];
+			val = LD_DWORD(p) & 0x7FFFFFFF;	/* (EOC and bad cluster fall on >= n_fatent) */
+			break;
+
+#endif
 		default:
 			val = 1;	/* Internal error */
 		}
@@ -1072,6 +1108,29 @@ DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* File handling - Get next cluster of the file in read                  */
+/*-----------------------------------------------------------------------*/
+
+static
+DWORD next_clust (	/* 0xFFFFFFFF:Disk error, 1:Internal error, >=2:Next cluster# or end of chain */
+	FIL* fp,		/* Pointer to the file object */
+	DWORD clst,		/* Current cluster# */
+	DWORD ofs		/* File offset of the next cluster */
+)
+{
+#if _FS_EXFAT
+	if (fp->xcont) return clst + 1;				/* Contiguous file has no chain on the FAT */
+#endif
+#if _USE_FASTSEEK
+	if (fp->cltbl) return clmt_clust(fp, ofs);	/* Get cluster# from the CLMT */
+#endif
+	return get_fat(fp->fs, clst);				/* Follow cluster chain on the FAT */
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Set directory index                              */
 /*-----------------------------------------------------------------------*/
@@ -1090,7 +1149,7 @@ FRESULT dir_sdi (	/* FR_OK(0):succeeded, !=0:error */
 	clst = dp->sclust;		/* Table start cluster (0:root) */
 	if (clst == 1 || clst >= dp->fs->n_fatent)	/* Check start cluster range */
 		return FR_INT_ERR;
-	if (!clst && dp->fs->fs_type == FS_FAT32)	/* Replace cluster# 0 with root cluster# if in FAT32 */
+	if (!clst && dp->fs->fs_type >= FS_FAT32)	/* Replace cluster# 0 with root cluster# if in FAT32/exFAT */
 		clst = dp->fs->dirbase;
 
 	if (clst == 0) {	/* Static table (root-directory in FAT12/16) */
@@ -1101,6 +1160,11 @@ FRESULT dir_sdi (	/* FR_OK(0):succeeded, !=0:error */
 	else {				/* Dynamic table (root-directory in FAT32 or sub-directory) */
 		ic = SS(dp->fs) / SZ_DIRE * dp->fs->csize;	/* Entries per cluster */
 		while (idx >= ic) {	/* Follow cluster chain */
+#if _FS_EXFAT
+			if (dp->xend)								/* Contiguous table has no chain on the FAT */
+				clst = (clst + 1 < dp->xend) ? clst + 1 : dp->fs->n_fatent;
+			else
+#endif
 			clst = get_fat(dp->fs, clst);				/* Get next cluster */
 			if (clst == 0xFFFFFFFF) return FR_DISK_ERR;	/* Disk error */
 			if (clst < 2 || clst >= dp->fs->n_fatent)	/* Reached to end of table or internal error */
@@ -1150,6 +1214,11 @@ FRESULT dir_next (	/* FR_OK(0):succeeded, FR_NO_FILE:End of table, FR_DENIED:Cou
 		}
 		else {					/* Dynamic table */
 			if (((i / (SS(dp->fs) / SZ_DIRE)) & (dp->fs->csize - 1)) == 0) {	/* Cluster changed? */
+#if _FS_EXFAT
+				if (dp->xend)									/* Contiguous table has no chain on the FAT */
+					clst = (dp->clust + 1 < dp->xend) ? dp->clust + 1 : dp->fs->n_fatent;
+				else
+#endif
 				clst = get_fat(dp->fs, dp->clust);				/* Get next cluster */
 				if (clst <= 1) return FR_INT_ERR;
 				if (clst == 0xFFFFFFFF) return FR_DISK_ERR;
@@ -1240,7 +1309,7 @@ DWORD ld_clust (	/* Returns the top cluster value of the SFN entry */
 	DWORD cl;
 
 	cl = LD_WORD(dir + DIR_FstClusLO);
-	if (fs->fs_type == FS_FAT32)
+	if (fs->fs_type >= FS_FAT32)
 		cl |= (DWORD)LD_WORD(dir + DIR_FstClusHI) << 16;
 
 	return cl;
@@ -1450,6 +1519,107 @@ BYTE sum_sfn (
 
 
 
+#if _FS_EXFAT
+/*-----------------------------------------------------------------------*/
+/* exFAT directory handling - Read an entry set                          */
+/*-----------------------------------------------------------------------*/
+/* The entry set is converted to an SFN entry in dp->xdir[], and dp->dir */
+/* points it, so the callers can handle it in the same way as FAT.       */
+
+static
+FRESULT dir_xread (	/* FR_OK(0):succeeded, FR_NO_FILE:End of table, !=0:error */
+	FATFS_DIR* dp,		/* Pointer to the directory object */
+	int cmp			/* 0:Get the name into lfn[], 1:Find the entry set named lfn[] */
+)
+{
+	FRESULT res;
+	BYTE c, ok, nsec, nlen, *dir, *xd;
+	UINT i, ni;
+	DWORD cl;
+	WCHAR w;
+
+
+	xd = dp->xdir;
+	ok = nsec = nlen = 0; ni = 0;
+	res = FR_NO_FILE;
+	while (dp->sect) {
+		res = move_window(dp->fs, dp->sect);
+		if (res != FR_OK) break;
+		dir = dp->dir;					/* Ptr to the directory entry of current index */
+		c = dir[XDIR_Type];
+		if (c == 0) { res = FR_NO_FILE; break; }	/* Reached to end of table */
+		if (c == ET_FILEDIR) {			/* Top of an entry set */
+			nsec = dir[XDIR_NumSec];	/* Number of secondary entries to follow */
+			ok = 0;
+			dp->lfn_idx = dp->index;
+			mem_set(xd, 0, SZ_DIRE);
+			xd[DIR_Attr] = dir[XDIR_Attr] & (AM_RDO | AM_HID | AM_SYS | AM_DIR | AM_ARC);
+			mem_cpy(xd + DIR_WrtTime, dir + XDIR_ModTime, 4);	/* (Same format as FAT) */
+		} else if (nsec && (c & 0xC0) == 0xC0) {	/* A secondary entry in the set */
+			nsec--;
+			if (c == ET_STREAM) {
+				nlen = dir[XDIR_NumName]; ni = 0;
+				ok = (LD_DWORD(dir + XDIR_FileSize + 4) == 0);	/* (Files of 4GB or larger are not supported) */
+				xd[DIR_NTres] = dir[XDIR_GenFlags];
+				cl = LD_DWORD(dir + XDIR_FstClus);
+				ST_WORD(xd + DIR_FstClusLO, cl);
+				ST_WORD(xd + DIR_FstClusHI, cl >> 16);
+				mem_cpy(xd + DIR_FileSize, dir + XDIR_FileSize, 4);
+			}
+			if (c == ET_FILENAME && ok) {	/* Get or compare up to 15 characters */
+				for (i = XDIR_Name; i < SZ_DIRE && ni < nlen; i += 2, ni++) {
+					w = LD_WORD(dir + i);
+					if (!cmp) {
+						dp->lfn[ni] = w;
+					} else if (ff_wtoupper(w) != ff_wtoupper(dp->lfn[ni])) {
+						ok = 0; break;
+					}
+				}
+			}
+			if (!nsec && ok && nlen && ni == nlen) {	/* End of a valid entry set */
+				if (!cmp) dp->lfn[ni] = 0;
+				if (!cmp || !dp->lfn[ni]) {
+					dp->dir = xd;
+					break;
+				}
+			}
+		} else {						/* An entry out of a set (bitmap, up-case table, label or unused) */
+			nsec = 0;
+		}
+		res = dir_next(dp, 0);			/* Next entry */
+		if (res != FR_OK) break;
+	}
+
+	return res;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* exFAT directory handling - Load a sub-directory table                 */
+/*-----------------------------------------------------------------------*/
+
+static
+void ld_xtable (
+	FATFS_DIR* dp,		/* Pointer to the directory object with sclust loaded */
+	const BYTE* dir	/* Pointer to the SFN entry of the sub-directory */
+)
+{
+	DWORD bcs;
+
+
+	dp->xend = 0;
+	if (dp->fs->fs_type == FS_EXFAT && (dir[DIR_NTres] & XSF_NOFATCHAIN)) {
+		bcs = (DWORD)dp->fs->csize * SS(dp->fs);
+		dp->xend = dp->sclust + (LD_DWORD(dir + DIR_FileSize) + bcs - 1) / bcs;
+	}
+}
+#endif	/* _FS_EXFAT */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Find an object in the directory                  */
 /*-----------------------------------------------------------------------*/
@@ -1467,6 +1637,10 @@ FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 
 	res = dir_sdi(dp, 0);			/* Rewind directory object */
 	if (res != FR_OK) return res;
+#if _FS_EXFAT
+	if (dp->fs->fs_type == FS_EXFAT)
+		return dir_xread(dp, 1);
+#endif
 
 #if _USE_LFN
 	ord = sum = 0xFF; dp->lfn_idx = 0xFFFF;	/* Reset LFN sequence */
@@ -1527,6 +1701,10 @@ FRESULT dir_read (
 	BYTE ord = 0xFF, sum = 0xFF;
 #endif
 
+#if _FS_EXFAT
+	if (dp->fs->fs_type == FS_EXFAT)	/* (Volume label of exFAT is not supported) */
+		return vol ? FR_NO_FILE : dir_xread(dp, 0);
+#endif
 	res = FR_NO_FILE;
 	while (dp->sect) {
 		res = move_window(dp->fs, dp->sect);
@@ -1713,6 +1891,23 @@ void get_fileinfo (		/* No return code */
 #endif
 
 	p = fno->fname;
+#if _FS_EXFAT
+	if (dp->sect && dp->fs->fs_type == FS_EXFAT) {	/* exFAT has no SFN, put the head of the name instead */
+		dir = dp->dir;
+		for (i = 0; i < 12 && dp->lfn[i]; i++) {
+			w = dp->lfn[i];
+#if !_LFN_UNICODE
+			w = ff_convert(w, 0);			/* Unicode -> OEM */
+			if (!w || w >= 0x100) w = '?';	/* (A DBC is not split) */
+#endif
+			*p++ = (TCHAR)w;
+		}
+		fno->fattrib = dir[DIR_Attr];				/* Attribute */
+		fno->fsize = (dir[DIR_Attr] & AM_DIR) ? 0 : LD_DWORD(dir + DIR_FileSize);	/* Size */
+		fno->fdate = LD_WORD(dir + DIR_WrtDate);	/* Date */
+		fno->ftime = LD_WORD(dir + DIR_WrtTime);	/* Time */
+	} else
+#endif
 	if (dp->sect) {		/* Get SFN */
 		dir = dp->dir;
 		i = 0;
@@ -2069,6 +2264,9 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 		path++;
 	dp->sclust = 0;							/* Always start from the root directory */
 #endif
+#if _FS_EXFAT
+	dp->xend = 0;							/* (Root directory of exFAT always has a FAT chain) */
+#endif
 
 	if ((UINT)*path < ' ') {				/* Null path name is the origin directory itself */
 		res = dir_sdi(dp, 0);
@@ -2097,6 +2295,9 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 				res = FR_NO_PATH; break;
 			}
 			dp->sclust = ld_clust(dp->fs, dir);
+#if _FS_EXFAT
+			ld_xtable(dp, dir);
+#endif
 		}
 	}
 
@@ -2188,6 +2389,10 @@ BYTE check_fs (	/* 0:Valid FAT-BS, 1:Valid BS but not FAT, 2:Not a BS, 3:Disk er
 		return 0;
 	if ((LD_DWORD(&fs->win[BS_FilSysType32]) & 0xFFFFFF) == 0x544146)	/* Check "FAT" string */
 		return 0;
+#if _FS_EXFAT
+	if (!mem_cmp(&fs->win[BS_FilSysTypeEx], "EXFAT   ", 8))			/* Check "EXFAT" string */
+		return 0;
+#endif
 
 	return 1;
 }
@@ -2195,6 +2400,63 @@ BYTE check_fs (	/* 0:Valid FAT-BS, 1:Valid BS but not FAT, 2:Not a BS, 3:Disk er
 
 
 
+#if _FS_EXFAT
+/*-----------------------------------------------------------------------*/
+/* Initialize the file system object with an exFAT boot sector in win[]  */
+/*-----------------------------------------------------------------------*/
+
+static
+FRESULT mount_xvolume (	/* FR_OK(0): successful, !=0: any error occurred */
+	FATFS* fs,		/* File system object */
+	DWORD bsect,	/* Volume start sector */
+	BYTE wmode		/* !=0: Check write protection for write access */
+)
+{
+	DWORD nclst;
+
+
+	if (fs->win[BPB_BytsPerSecEx] > 12 || (1U << fs->win[BPB_BytsPerSecEx]) != SS(fs))	/* (Must be equal to the physical sector size) */
+		return FR_NO_FILESYSTEM;
+	if (fs->win[BPB_SecPerClusEx] > 15)					/* (csize is a WORD) */
+		return FR_NO_FILESYSTEM;
+	fs->csize = (WORD)(1U << fs->win[BPB_SecPerClusEx]);	/* Number of sectors per cluster */
+
+	fs->n_fats = fs->win[BPB_NumFATsEx];				/* Number of FAT copies (the first one is used) */
+	if (fs->n_fats != 1 && fs->n_fats != 2)				/* (Must be 1 or 2) */
+		return FR_NO_FILESYSTEM;
+	fs->fsize = LD_DWORD(fs->win + BPB_FatSzEx);		/* Number of sectors per FAT */
+
+	nclst = LD_DWORD(fs->win + BPB_NumClusEx);			/* Number of clusters */
+	if (!nclst || nclst > 0x7FFFFFFD) return FR_NO_FILESYSTEM;	/* (Invalid volume size) */
+	if (fs->fsize < (nclst + 2 + (SS(fs) / 4) - 1) / (SS(fs) / 4))	/* (FAT size must not be less than the size needed) */
+		return FR_NO_FILESYSTEM;
+
+	/* Boundaries and Limits */
+	fs->n_fatent = nclst + 2;							/* Number of FAT entries */
+	fs->n_rootdir = 0;
+	fs->volbase = bsect;								/* Volume start sector */
+	fs->fatbase = bsect + LD_DWORD(fs->win + BPB_FatOfsEx);		/* FAT start sector */
+	fs->database = bsect + LD_DWORD(fs->win + BPB_DataOfsEx);	/* Data start sector */
+	fs->dirbase = LD_DWORD(fs->win + BPB_RootClusEx);	/* Root directory start cluster */
+	if (fs->dirbase < 2 || fs->dirbase >= fs->n_fatent)
+		return FR_NO_FILESYSTEM;
+#if !_FS_READONLY
+	fs->last_clust = fs->free_clust = 0xFFFFFFFF;		/* (Never used, the volume is read-only) */
+	fs->fsi_flag = 0x80;
+#endif
+	fs->fs_type = FS_EXFAT;
+	fs->id = ++Fsid;	/* File system mount ID */
+#if _FS_LOCK			/* Clear file lock semaphores */
+	clear_lock(fs);
+#endif
+
+	return wmode ? FR_WRITE_PROTECTED : FR_OK;	/* exFAT volume is mounted read-only */
+}
+#endif	/* _FS_EXFAT */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Find logical drive and check if the volume is mounted                 */
 /*-----------------------------------------------------------------------*/
@@ -2232,6 +2494,10 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 		if (!(stat & STA_NOINIT)) {		/* and the physical drive is kept initialized */
 			if (!_FS_READONLY && wmode && (stat & STA_PROTECT))	/* Check write protection if needed */
 				return FR_WRITE_PROTECTED;
+#if _FS_EXFAT
+			if (!_FS_READONLY && wmode && fs->fs_type == FS_EXFAT)	/* exFAT volume is read-only */
+				return FR_WRITE_PROTECTED;
+#endif
 			return FR_OK;				/* The file system object is valid */
 		}
 	}
@@ -2267,6 +2533,10 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 	}
 	if (fmt == 3) return FR_DISK_ERR;		/* An error occured in the disk I/O layer */
 	if (fmt) return FR_NO_FILESYSTEM;		/* No FAT volume is found */
+#if _FS_EXFAT
+	if (!mem_cmp(fs->win + BS_FilSysTypeEx, "EXFAT   ", 8))	/* An exFAT volume is found */
+		return mount_xvolume(fs, bsect, (BYTE)(!_FS_READONLY && wmode));
+#endif
 
 	/* An FAT volume is found. Following code initializes the file system object */
 
@@ -2369,7 +2639,7 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 /*-----------------------------------------------------------------------*/
 
 static
-FRESULT validate (	/* FR_OK(0): The object is valid, !=0: Invalid */
+FRESULT check_obj (	/* FR_OK(0): The object is valid, !=0: Invalid */
 	void* obj		/* Pointer to the object FIL/FATFS_DIR to check validity */
 )
 {
@@ -2379,7 +2649,22 @@ FRESULT validate (	/* FR_OK(0): The object is valid, !=0: Invalid */
 	if (!fil || !fil->fs || !fil->fs->fs_type || fil->fs->id != fil->id || (disk_status(fil->fs->drv) & STA_NOINIT))
 		return FR_INVALID_OBJECT;
 
-	ENTER_FF(fil->fs);		/* Lock file system */
+	return FR_OK;
+}
+
+
+static
+FRESULT validate (	/* FR_OK(0): The object is valid, !=0: Invalid */
+	void* obj		/* Pointer to the object FIL/FATFS_DIR to check validity */
+)
+{
+	FRESULT res;
+
+
+	res = check_obj(obj);
+	if (res != FR_OK) return res;
+
+	ENTER_FF(((FIL*)obj)->fs);	/* Lock file system */
 
 	return FR_OK;
 }
@@ -2387,6 +2672,33 @@ FRESULT validate (	/* FR_OK(0): The object is valid, !=0: Invalid */
 
 
 
+#if _FS_REENTRANT && !_FS_TINY
+/*-----------------------------------------------------------------------*/
+/* Check if the file can be read without the grant                       */
+/*-----------------------------------------------------------------------*/
+/* A read-only file whose clusters are known without the FAT (CLMT or
+/  contiguous exFAT file) is read through its own sector buffer, so the
+/  read touches no shared data of the volume. */
+
+static
+int is_mapped (	/* 1:Mapped read-only file, 0:Needs the grant */
+	FIL* fp		/* Pointer to the valid file object */
+)
+{
+	if (fp->flag & FA_WRITE) return 0;
+#if _FS_EXFAT
+	if (fp->xcont) return 1;
+#endif
+#if _USE_FASTSEEK
+	if (fp->cltbl) return 1;
+#endif
+	return 0;
+}
+#endif
+
+
+
+
 /*--------------------------------------------------------------------------
 
    Public Functions
@@ -2567,6 +2879,9 @@ FRESULT f_open (
 			fp->dsect = 0;
 #if _USE_FASTSEEK
 			fp->cltbl = 0;						/* Normal seek mode */
+#endif
+#if _FS_EXFAT
+			fp->xcont = (dj.fs->fs_type == FS_EXFAT && (dir[DIR_NTres] & XSF_NOFATCHAIN)) ? 1 : 0;
 #endif
 			fp->fs = dj.fs;	 					/* Validate file object */
 			fp->id = fp->fs->id;
@@ -2583,58 +2898,52 @@ FRESULT f_open (
 /* Read File                                                             */
 /*-----------------------------------------------------------------------*/
 
-FRESULT f_read (
+static
+FRESULT read_data (	/* Read the file data on the valid file object */
 	FIL* fp, 		/* Pointer to the file object */
 	void* buff,		/* Pointer to data buffer */
 	UINT btr,		/* Number of bytes to read */
 	UINT* br		/* Pointer to number of bytes read */
 )
 {
-	FRESULT res;
 	DWORD clst, sect, remain;
-	UINT rcnt, cc;
-	BYTE csect, *rbuff = (BYTE*)buff;
-
+	UINT rcnt, cc, csect, rc;
+	BYTE *rbuff = (BYTE*)buff;
 
-	*br = 0;	/* Clear read byte counter */
 
-	res = validate(fp);							/* Check validity */
-	if (res != FR_OK) LEAVE_FF(fp->fs, res);
-	if (fp->err)								/* Check error */
-		LEAVE_FF(fp->fs, (FRESULT)fp->err);
-	if (!(fp->flag & FA_READ)) 					/* Check access mode */
-		LEAVE_FF(fp->fs, FR_DENIED);
 	remain = fp->fsize - fp->fptr;
 	if (btr > remain) btr = (UINT)remain;		/* Truncate btr by remaining bytes */
 
 	for ( ;  btr;								/* Repeat until all data read */
 		rbuff += rcnt, fp->fptr += rcnt, *br += rcnt, btr -= rcnt) {
 		if ((fp->fptr % SS(fp->fs)) == 0) {		/* On the sector boundary? */
-			csect = (BYTE)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
+			csect = (UINT)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
 			if (!csect) {						/* On the cluster boundary? */
 				if (fp->fptr == 0) {			/* On the top of the file? */
 					clst = fp->sclust;			/* Follow from the origin */
 				} else {						/* Middle or end of the file */
-#if _USE_FASTSEEK
-					if (fp->cltbl)
-						clst = clmt_clust(fp, fp->fptr);	/* Get cluster# from the CLMT */
-					else
-#endif
-						clst = get_fat(fp->fs, fp->clust);	/* Follow cluster chain on the FAT */
+					clst = next_clust(fp, fp->clust, fp->fptr);
 				}
-				if (clst < 2) ABORT(fp->fs, FR_INT_ERR);
-				if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
+				if (clst < 2) ABORT_NL(FR_INT_ERR);
+				if (clst == 0xFFFFFFFF) ABORT_NL(FR_DISK_ERR);
 				fp->clust = clst;				/* Update current cluster */
 			}
 			sect = clust2sect(fp->fs, fp->clust);	/* Get current sector */
-			if (!sect) ABORT(fp->fs, FR_INT_ERR);
+			if (!sect) ABORT_NL(FR_INT_ERR);
 			sect += csect;
 			cc = btr / SS(fp->fs);				/* When remaining bytes >= sector size, */
 			if (cc) {							/* Read maximum contiguous sectors directly */
-				if (csect + cc > fp->fs->csize)	/* Clip at cluster boundary */
-					cc = fp->fs->csize - csect;
+				rc = fp->fs->csize - csect;		/* Sectors left in the current cluster */
+				while (rc < cc) {				/* Coalesce following clusters while they are physically contiguous */
+					clst = next_clust(fp, fp->clust, fp->fptr + rc * SS(fp->fs));
+					if (clst != fp->clust + 1) break;	/* (Fragment, end of chain or error is handled at the boundary) */
+					fp->clust = clst;
+					rc += fp->fs->csize;
+				}
+				if (cc > rc)					/* Clip at the end of the cluster run */
+					cc = rc;
 				if (disk_read(fp->fs->drv, rbuff, sect, cc) != RES_OK)
-					ABORT(fp->fs, FR_DISK_ERR);
+					ABORT_NL(FR_DISK_ERR);
 #if !_FS_READONLY && _FS_MINIMIZE <= 2			/* Replace one of the read sectors with cached data if it contains a dirty sector */
 #if _FS_TINY
 				if (fp->fs->wflag && fp->fs->winsect - sect < cc)
@@ -2652,12 +2961,12 @@ FRESULT f_read (
 #if !_FS_READONLY
 				if (fp->flag & FA__DIRTY) {		/* Write-back dirty sector cache */
 					if (disk_write(fp->fs->drv, fp->buf, fp->dsect, 1) != RES_OK)
-						ABORT(fp->fs, FR_DISK_ERR);
+						ABORT_NL(FR_DISK_ERR);
 					fp->flag &= ~FA__DIRTY;
 				}
 #endif
 				if (disk_read(fp->fs->drv, fp->buf, sect, 1) != RES_OK)	/* Fill sector cache */
-					ABORT(fp->fs, FR_DISK_ERR);
+					ABORT_NL(FR_DISK_ERR);
 			}
 #endif
 			fp->dsect = sect;
@@ -2666,20 +2975,98 @@ FRESULT f_read (
 		if (rcnt > btr) rcnt = btr;
 #if _FS_TINY
 		if (move_window(fp->fs, fp->dsect) != FR_OK)		/* Move sector window */
-			ABORT(fp->fs, FR_DISK_ERR);
+			ABORT_NL(FR_DISK_ERR);
 		mem_cpy(rbuff, &fp->fs->win[fp->fptr % SS(fp->fs)], rcnt);	/* Pick partial sector */
 #else
 		mem_cpy(rbuff, &fp->buf[fp->fptr % SS(fp->fs)], rcnt);	/* Pick partial sector */
 #endif
 	}
 
-	LEAVE_FF(fp->fs, FR_OK);
+	return FR_OK;
+}
+
+
+
+FRESULT f_read (
+	FIL* fp, 		/* Pointer to the file object */
+	void* buff,		/* Pointer to data buffer */
+	UINT btr,		/* Number of bytes to read */
+	UINT* br		/* Pointer to number of bytes read */
+)
+{
+	FRESULT res;
+
+
+	*br = 0;	/* Clear read byte counter */
+
+#if _FS_REENTRANT && !_FS_TINY
+	if (check_obj(fp) == FR_OK && is_mapped(fp)) {	/* Mapped read-only file is read without the grant */
+		if (fp->err)							/* Check error */
+			return (FRESULT)fp->err;
+		if (!(fp->flag & FA_READ)) 				/* Check access mode */
+			return FR_DENIED;
+		return read_data(fp, buff, btr, br);
+	}
+#endif
+	res = validate(fp);							/* Check validity */
+	if (res != FR_OK) LEAVE_FF(fp->fs, res);
+	if (fp->err)								/* Check error */
+		LEAVE_FF(fp->fs, (FRESULT)fp->err);
+	if (!(fp->flag & FA_READ)) 					/* Check access mode */
+		LEAVE_FF(fp->fs, FR_DENIED);
+
+	res = read_data(fp, buff, btr, br);
+	LEAVE_FF(fp->fs, res);
 }
 
 
 
 
 #if !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Synchronize the File with the grant held                              */
+/*-----------------------------------------------------------------------*/
+
+static
+FRESULT sync_file (	/* Flush the valid file object with the grant held */
+	FIL* fp		/* Pointer to the file object */
+)
+{
+	FRESULT res = FR_OK;
+	DWORD tm;
+	BYTE *dir;
+
+
+	if (fp->flag & FA__WRITTEN) {	/* Is there any change to the file? */
+#if !_FS_TINY
+		if (fp->flag & FA__DIRTY) {	/* Write-back cached data if needed */
+			if (disk_write(fp->fs->drv, fp->buf, fp->dsect, 1) != RES_OK)
+				return FR_DISK_ERR;
+			fp->flag &= ~FA__DIRTY;
+		}
+#endif
+		/* Update the directory entry */
+		res = move_window(fp->fs, fp->dir_sect);
+		if (res == FR_OK) {
+			dir = fp->dir_ptr;
+			dir[DIR_Attr] |= AM_ARC;					/* Set archive bit */
+			ST_DWORD(dir + DIR_FileSize, fp->fsize);	/* Update file size */
+			st_clust(dir, fp->sclust);					/* Update start cluster */
+			tm = GET_FATTIME();							/* Update modified time */
+			ST_DWORD(dir + DIR_WrtTime, tm);
+			ST_WORD(dir + DIR_LstAccDate, 0);
+			fp->flag &= ~FA__WRITTEN;
+			fp->fs->wflag = 1;
+			res = sync_fs(fp->fs);
+		}
+	}
+
+	return res;
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Write File                                                            */
 /*-----------------------------------------------------------------------*/
@@ -2772,7 +3159,11 @@ FRESULT f_write (
 #endif
 				wcnt = SS(fp->fs) * cc;		/* Number of bytes transferred */
 #if FLUSH_ON_NEW_SECTOR
-                need_sync = true;
+                // Overwriting the allocated sectors does not change the size
+                // and the chain, so the directory entry is synced at the close
+                if (fp->fptr + wcnt > fp->fsize) {
+                    need_sync = true;
+                }
 #endif
 				continue;
 			}
@@ -2807,7 +3198,7 @@ FRESULT f_write (
 	fp->flag |= FA__WRITTEN;						/* Set file change flag */
 
 	if (need_sync) {
-        f_sync (fp);
+        sync_file (fp);		/* (The grant is already held) */
     }
 
 	LEAVE_FF(fp->fs, FR_OK);
@@ -2825,36 +3216,11 @@ FRESULT f_sync (
 )
 {
 	FRESULT res;
-	DWORD tm;
-	BYTE *dir;
 
 
 	res = validate(fp);					/* Check validity of the object */
-	if (res == FR_OK) {
-		if (fp->flag & FA__WRITTEN) {	/* Is there any change to the file? */
-#if !_FS_TINY
-			if (fp->flag & FA__DIRTY) {	/* Write-back cached data if needed */
-				if (disk_write(fp->fs->drv, fp->buf, fp->dsect, 1) != RES_OK)
-					LEAVE_FF(fp->fs, FR_DISK_ERR);
-				fp->flag &= ~FA__DIRTY;
-			}
-#endif
-			/* Update the directory entry */
-			res = move_window(fp->fs, fp->dir_sect);
-			if (res == FR_OK) {
-				dir = fp->dir_ptr;
-				dir[DIR_Attr] |= AM_ARC;					/* Set archive bit */
-				ST_DWORD(dir + DIR_FileSize, fp->fsize);	/* Update file size */
-				st_clust(dir, fp->sclust);					/* Update start cluster */
-				tm = GET_FATTIME();							/* Update modified time */
-				ST_DWORD(dir + DIR_WrtTime, tm);
-				ST_WORD(dir + DIR_LstAccDate, 0);
-				fp->flag &= ~FA__WRITTEN;
-				fp->fs->wflag = 1;
-				res = sync_fs(fp->fs);
-			}
-		}
-	}
+	if (res == FR_OK)
+		res = sync_file(fp);
 
 	LEAVE_FF(fp->fs, res);
 }
@@ -3063,6 +3429,15 @@ FRESULT f_lseek (
 			tbl = fp->cltbl;
 			tlen = *tbl++; ulen = 2;	/* Given table size and required table size */
 			cl = fp->sclust;			/* Top of the chain */
+#if _FS_EXFAT
+			if (cl && fp->xcont) {		/* Contiguous file is a fragment */
+				ulen += 2;
+				if (ulen <= tlen) {
+					ncl = (DWORD)fp->fs->csize * SS(fp->fs);
+					*tbl++ = fp->fsize / ncl + 1; *tbl++ = cl;	/* (Never runs over the volume) */
+				}
+			} else
+#endif
 			if (cl) {
 				do {
 					/* Get a fragment */
@@ -3150,6 +3525,11 @@ FRESULT f_lseek (
 							ofs = bcs; break;
 						}
 					} else
+#endif
+#if _FS_EXFAT
+					if (fp->xcont)
+						clst++;							/* Contiguous file has no chain on the FAT */
+					else
 #endif
 						clst = get_fat(fp->fs, clst);	/* Follow cluster chain if not in write mode */
 					if (clst == 0xFFFFFFFF) ABORT(fp->fs, FR_DISK_ERR);
@@ -3219,9 +3599,12 @@ FRESULT f_opendir (
 		FREE_BUF();
 		if (res == FR_OK) {						/* Follow completed */
 			if (dp->dir) {						/* It is not the origin directory itself */
-				if (dp->dir[DIR_Attr] & AM_DIR)	/* The object is a sub directory */
+				if (dp->dir[DIR_Attr] & AM_DIR) {	/* The object is a sub directory */
 					dp->sclust = ld_clust(fs, dp->dir);
-				else							/* The object is a file */
+#if _FS_EXFAT
+					ld_xtable(dp, dp->dir);
+#endif
+				} else							/* The object is a file */
 					res = FR_NO_PATH;
 			}
 			if (res == FR_OK) {
@@ -4020,8 +4403,7 @@ FRESULT f_forward (
 {
 	FRESULT res;
 	DWORD remain, clst, sect;
-	UINT rcnt;
-	BYTE csect;
+	UINT rcnt, csect;
 
 
 	*bf = 0;	/* Clear transfer byte counter */
@@ -4038,9 +4420,14 @@ FRESULT f_forward (
 
 	for ( ;  btf && (*func)(0, 0);					/* Repeat until all data transferred or stream becomes busy */
 		fp->fptr += rcnt, *bf += rcnt, btf -= rcnt) {
-		csect = (BYTE)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
+		csect = (UINT)(fp->fptr / SS(fp->fs) & (fp->fs->csize - 1));	/* Sector offset in the cluster */
 		if ((fp->fptr % SS(fp->fs)) == 0) {			/* On the sector boundary? */
 			if (!csect) {							/* On the cluster boundary? */
+#if _FS_EXFAT
+				if (fp->xcont && fp->fptr != 0)
+					clst = fp->clust + 1;			/* Contiguous file has no chain on the FAT */
+				else
+#endif
 				clst = (fp->fptr == 0) ?			/* On the top of the file? */
 					fp->sclust : get_fat(fp->fs, fp->clust);
 				if (clst <= 1) ABORT(fp->fs, FR_INT_ERR);
@@ -78,7 +78,7 @@ typedef char TCHAR;
 typedef struct {
 	BYTE	fs_type;		/* FAT sub-type (0:Not mounted) */
 	BYTE	drv;			/* Physical drive number */
-	BYTE	csize;			/* Sectors per cluster (1,2,4...128) */
+	WORD	csize;			/* Sectors per cluster (1,2,4...128, up to 32768 on exFAT) */
 	BYTE	n_fats;			/* Number of FAT copies (1 or 2) */
 	BYTE	wflag;			/* win[] flag (b0:dirty) */
 	BYTE	fsi_flag;		/* FSINFO flags (b7:disabled, b0:dirty) */
@@ -131,6 +131,9 @@ typedef struct {
 #if _FS_LOCK
 	UINT	lockid;			/* File lock ID origin from 1 (index of file semaphore table Files[]) */
 #endif
+#if _FS_EXFAT
+	BYTE	xcont;			/* exFAT: File is on a contiguous cluster run (NoFatChain) */
+#endif
 #if !_FS_TINY
 	BYTE	buf[_MAX_SS];	/* File private data read/write window */
 #endif
@@ -159,6 +162,10 @@ typedef struct {
 #if _USE_FIND
 	const TCHAR*	pat;	/* Pointer to the name matching pattern */
 #endif
+#if _FS_EXFAT
+	DWORD	xend;			/* exFAT: End cluster of a contiguous table (0:Follow the FAT) */
+	BYTE	xdir[32];		/* exFAT: Found entry set converted to an SFN entry */
+#endif
 } FATFS_DIR;
 
 
@@ -309,6 +316,7 @@ int ff_del_syncobj (_SYNC_t sobj);				/* Delete a sync object */
 #define FS_FAT12	1
 #define FS_FAT16	2
 #define FS_FAT32	3
+#define FS_EXFAT	4
 
 
 /* File attribute bits for directory entry */
@@ -45,7 +45,7 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define	_USE_FASTSEEK	0
+#define	_USE_FASTSEEK	1
 /* This option switches fast seek feature. (0:Disable or 1:Enable) */
 
 
@@ -92,7 +92,7 @@
 */
 
 
-#define	_USE_LFN	1
+#define	_USE_LFN	2
 #define	_MAX_LFN	255
 /* The _USE_LFN option switches the LFN feature.
 /
@@ -105,7 +105,15 @@
 /  be added to the project. The LFN working buffer occupies (_MAX_LFN + 1) * 2 bytes.
 /  When use stack for the working buffer, take care on stack overflow. When use heap
 /  memory for the working buffer, memory management functions, ff_memalloc() and
-/  ff_memfree(), must be added to the project. */
+/  ff_memfree(), must be added to the project.
+/
+/  The mbed port uses the stack (2): the heap is not used by FatFs calls, and the
+/  static buffer (1) cannot be used with _FS_REENTRANT. The functions which take
+/  a path or read a directory entry put (_MAX_LFN + 1) * 2 = 512 bytes on the
+/  stack of the caller. In the application, only the main thread calls them
+/  (scan, track and resume file open), on its stack of OS_MAINSTKSIZE words.
+/  The attach thread only mounts and the decode thread only reads and seeks,
+/  which do not use the buffer, so their stacks are unchanged. */
 
 
 #define	_LFN_UNICODE	0
@@ -140,7 +148,7 @@
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
 
-#define _VOLUMES	1
+#define _VOLUMES	4
 /* Number of volumes (logical drives) to be used. */
 
 
@@ -189,6 +197,15 @@
 */
 
 
+#define	_FS_EXFAT	1
+/* This option switches exFAT support. (0:Disable or 1:Enable)
+/  exFAT volumes are mounted read-only. Any write access to them is rejected with
+/  FR_WRITE_PROTECTED. Files on a contiguous cluster run (NoFatChain flag) are
+/  read without any FAT lookup. Files of 4GB or larger are not listed.
+/  To enable exFAT support, also LFN feature needs to be enabled (_USE_LFN >= 1)
+/  and relative path feature needs to be disabled (_FS_RPATH == 0). */
+
+
 
 /*---------------------------------------------------------------------------/
 / System Configurations
@@ -228,9 +245,9 @@
 /      lock feature is independent of re-entrancy. */
 
 
-#define _FS_REENTRANT	0
+#define _FS_REENTRANT	1
 #define _FS_TIMEOUT		1000
-#define	_SYNC_t			HANDLE
+#define	_SYNC_t			BYTE
 /* The _FS_REENTRANT option switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
@@ -246,7 +263,13 @@
 /  The _FS_TIMEOUT defines timeout period in unit of time tick.
 /  The _SYNC_t defines O/S dependent sync object type. e.g. HANDLE, ID, OS_EVENT*,
 /  SemaphoreHandle_t and etc.. A header file for O/S definitions needs to be
-/  included somewhere in the scope of ff.c. */
+/  included somewhere in the scope of ff.c.
+/
+/  The mbed port (FATFileSystem.cpp) uses the logical drive number as the sync
+/  object and locks a mutex per volume with priority inheritance. The grant is
+/  waited for without timeout, so _FS_TIMEOUT has no effect. Reading a read-only
+/  file that has a cluster link map (or a contiguous exFAT file) does not take
+/  the grant, because it touches no shared data of the volume. */
 
 
 #define _WORD_ACCESS	0
@@ -128,8 +128,65 @@ void fat_filesystem_set_errno(FRESULT res)
 ////// Disk operations //////
 
 // Global access to block device from FAT driver
+// _ffs_mutex guards _ffs[], mount/format and the CLMT pool. File and directory
+// accesses are locked per volume by FatFs (_FS_REENTRANT) with _ffs_vol_mutex.
 static BlockDevice *_ffs[_VOLUMES] = {0};
 static SingletonPtr<PlatformMutex> _ffs_mutex;
+static SingletonPtr<PlatformMutex> _ffs_vol_mutex[_VOLUMES];
+
+#if _USE_FASTSEEK
+// Pool of cluster link map tables (CLMT) for read-only files, guarded by _ffs_mutex.
+// With a CLMT, f_lseek and f_read get the clusters from RAM instead of the FAT.
+static DWORD _ffs_clmt[MBED_CONF_FILESYSTEM_FAT_CLMT_NUM][MBED_CONF_FILESYSTEM_FAT_CLMT_SIZE];
+static FIL *_ffs_clmt_owner[MBED_CONF_FILESYSTEM_FAT_CLMT_NUM] = {0};
+
+// Builds a CLMT for the file if a table is free. Fails only on a disk error;
+// a file too fragmented for a table stays in the normal (FAT chain) mode.
+// The table is claimed under _ffs_mutex and filled under the volume lock.
+static FRESULT clmt_attach(FIL *fh)
+{
+    fh->cltbl = NULL;
+    int i;
+    _ffs_mutex->lock();
+    for (i = 0; i < MBED_CONF_FILESYSTEM_FAT_CLMT_NUM; i++) {
+        if (_ffs_clmt_owner[i] == NULL) {
+            _ffs_clmt_owner[i] = fh;
+            break;
+        }
+    }
+    _ffs_mutex->unlock();
+    if (i == MBED_CONF_FILESYSTEM_FAT_CLMT_NUM) {
+        return FR_OK;
+    }
+
+    _ffs_clmt[i][0] = MBED_CONF_FILESYSTEM_FAT_CLMT_SIZE;
+    fh->cltbl = _ffs_clmt[i];
+    FRESULT res = f_lseek(fh, CREATE_LINKMAP);
+    if (res != FR_OK) {
+        debug_if(FFS_DBG, "CLMT of %d items needed, fast seek not used\n", _ffs_clmt[i][0]);
+        fh->cltbl = NULL;
+        _ffs_mutex->lock();
+        _ffs_clmt_owner[i] = NULL;
+        _ffs_mutex->unlock();
+        if (res == FR_NOT_ENOUGH_CORE) {
+            res = FR_OK;
+        }
+    }
+    return res;
+}
+
+static void clmt_detach(FIL *fh)
+{
+    _ffs_mutex->lock();
+    for (int i = 0; i < MBED_CONF_FILESYSTEM_FAT_CLMT_NUM; i++) {
+        if (_ffs_clmt_owner[i] == fh) {
+            _ffs_clmt_owner[i] = NULL;
+        }
+    }
+    _ffs_mutex->unlock();
+    fh->cltbl = NULL;
+}
+#endif
 
 
 // FAT driver functions
@@ -146,6 +203,47 @@ DWORD get_fattime(void)
            | (DWORD)(ptm->tm_sec/2    );
 }
 
+#if _FS_REENTRANT
+// Implementation of sync functions (see ChaN/ff.h)
+// The sync object is the volume number. The mutex of RTX has priority
+// inheritance, so a low priority scan holding a volume is boosted while
+// the decode thread waits for it.
+int ff_cre_syncobj(BYTE vol, _SYNC_t *sobj)
+{
+    *sobj = vol;
+    return 1;
+}
+
+int ff_req_grant(_SYNC_t sobj)
+{
+    _ffs_vol_mutex[sobj]->lock();
+    return 1;
+}
+
+void ff_rel_grant(_SYNC_t sobj)
+{
+    _ffs_vol_mutex[sobj]->unlock();
+}
+
+int ff_del_syncobj(_SYNC_t sobj)
+{
+    return 1;
+}
+#endif
+
+#if _USE_LFN == 3
+// LFN working buffer of each API call
+void *ff_memalloc(UINT msize)
+{
+    return malloc(msize);
+}
+
+void ff_memfree(void *mblock)
+{
+    free(mblock);
+}
+#endif
+
 // Implementation of diskio functions (see ChaN/diskio.h)
 DSTATUS disk_status(BYTE pdrv)
 {
@@ -251,8 +349,10 @@ int FATFileSystem::mount(BlockDevice *bd, bool force) {
         if (!_ffs[i]) {
             _id = i;
             _ffs[_id] = bd;
+            // "N:", so that f_mount() and f_mkfs() select the drive N
             _fsid[0] = '0' + _id;
-            _fsid[1] = '\0';
+            _fsid[1] = ':';
+            _fsid[2] = '\0';
             debug_if(FFS_DBG, "Mounting [%s] on ffs drive [%s]\n", getName(), _fsid);
             FRESULT res = f_mount(&_fs, _fsid, force);
             unlock();
@@ -305,9 +405,11 @@ int FATFileSystem::format(BlockDevice *bd, int allocation_unit) {
 }
 
 int FATFileSystem::remove(const char *filename) {
-    lock();
-    FRESULT res = f_unlink(filename);
-    unlock();
+    char *buffer = new char[strlen(_fsid) + strlen(filename) + 3];
+    sprintf(buffer, "%s/%s", _fsid, filename);
+
+    FRESULT res = f_unlink(buffer);
+    delete[] buffer;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_unlink() failed: %d\n", res);
@@ -316,9 +418,14 @@ int FATFileSystem::remove(const char *filename) {
 }
 
 int FATFileSystem::rename(const char *oldname, const char *newname) {
-    lock();
-    FRESULT res = f_rename(oldname, newname);
-    unlock();
+    char *old_buffer = new char[strlen(_fsid) + strlen(oldname) + 3];
+    sprintf(old_buffer, "%s/%s", _fsid, oldname);
+    char *new_buffer = new char[strlen(_fsid) + strlen(newname) + 3];
+    sprintf(new_buffer, "%s/%s", _fsid, newname);
+
+    FRESULT res = f_rename(old_buffer, new_buffer);
+    delete[] old_buffer;
+    delete[] new_buffer;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_rename() failed: %d\n", res);
@@ -327,9 +434,11 @@ int FATFileSystem::rename(const char *oldname, const char *newname) {
 }
 
 int FATFileSystem::mkdir(const char *name, mode_t mode) {
-    lock();
-    FRESULT res = f_mkdir(name);
-    unlock();
+    char *buffer = new char[strlen(_fsid) + strlen(name) + 3];
+    sprintf(buffer, "%s/%s", _fsid, name);
+
+    FRESULT res = f_mkdir(buffer);
+    delete[] buffer;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_mkdir() failed: %d\n", res);
@@ -338,13 +447,14 @@ int FATFileSystem::mkdir(const char *name, mode_t mode) {
 }
 
 int FATFileSystem::stat(const char *name, struct stat *st) {
-    lock();
     FILINFO f;
     memset(&f, 0, sizeof(f));
+    char *buffer = new char[strlen(_fsid) + strlen(name) + 3];
+    sprintf(buffer, "%s/%s", _fsid, name);
 
-    FRESULT res = f_stat(name, &f);
+    FRESULT res = f_stat(buffer, &f);
+    delete[] buffer;
     if (res != FR_OK) {
-        unlock();
         return fat_error_remap(res);
     }
 
@@ -357,7 +467,6 @@ int FATFileSystem::stat(const char *name, struct stat *st) {
         (S_IRUSR | S_IXUSR | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) :
         (S_IRWXU | S_IRWXG | S_IRWXO);
 #endif /* TOOLCHAIN_GCC */
-    unlock();
 
     return 0;
 }
@@ -377,7 +486,7 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
 
     FIL *fh = new FIL;
     char *buffer = new char[strlen(_fsid) + strlen(path) + 3];
-    sprintf(buffer, "%s:/%s", _fsid, path);
+    sprintf(buffer, "%s/%s", _fsid, path);
 
     /* POSIX flags -> FatFS open mode */
     BYTE openmode;
@@ -396,11 +505,9 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
         }
     }
 
-    lock();
     FRESULT res = f_open(fh, buffer, openmode);
 
     if (res != FR_OK) {
-        unlock();
         debug_if(FFS_DBG, "f_open('w') failed: %d\n", res);
         delete[] buffer;
         delete fh;
@@ -410,7 +517,20 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
     if (flags & O_APPEND) {
         f_lseek(fh, fh->fsize);
     }
-    unlock();
+#if _USE_FASTSEEK
+    if (openmode == FA_READ) {
+        // The chain of a read-only file does not change, so it is mapped once here.
+        res = clmt_attach(fh);
+        if (res != FR_OK) {
+            clmt_detach(fh);
+            f_close(fh);
+            debug_if(FFS_DBG, "f_lseek(CREATE_LINKMAP) failed: %d\n", res);
+            delete[] buffer;
+            delete fh;
+            return fat_error_remap(res);
+        }
+    }
+#endif
 
     delete[] buffer;
     *file = fh;
@@ -420,9 +540,10 @@ int FATFileSystem::file_open(fs_file_t *file, const char *path, int flags) {
 int FATFileSystem::file_close(fs_file_t file) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     FRESULT res = f_close(fh);
-    unlock();
+#if _USE_FASTSEEK
+    clmt_detach(fh);
+#endif
 
     delete fh;
     return fat_error_remap(res);
@@ -431,10 +552,9 @@ int FATFileSystem::file_close(fs_file_t file) {
 ssize_t FATFileSystem::file_read(fs_file_t file, void *buffer, size_t len) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
+    // A read-only file with a CLMT is read without any lock (see is_mapped() in ff.cpp)
     UINT n;
     FRESULT res = f_read(fh, buffer, len, &n);
-    unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_read() failed: %d\n", res);
@@ -447,10 +567,8 @@ ssize_t FATFileSystem::file_read(fs_file_t file, void *buffer, size_t len) {
 ssize_t FATFileSystem::file_write(fs_file_t file, const void *buffer, size_t len) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     UINT n;
     FRESULT res = f_write(fh, buffer, len, &n);
-    unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_write() failed: %d", res);
@@ -463,9 +581,7 @@ ssize_t FATFileSystem::file_write(fs_file_t file, const void *buffer, size_t len
 int FATFileSystem::file_sync(fs_file_t file) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     FRESULT res = f_sync(fh);
-    unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_sync() failed: %d\n", res);
@@ -476,7 +592,6 @@ int FATFileSystem::file_sync(fs_file_t file) {
 off_t FATFileSystem::file_seek(fs_file_t file, off_t offset, int whence) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     if (whence == SEEK_END) {
         offset += fh->fsize;
     } else if(whence==SEEK_CUR) {
@@ -485,7 +600,6 @@ off_t FATFileSystem::file_seek(fs_file_t file, off_t offset, int whence) {
 
     FRESULT res = f_lseek(fh, offset);
     off_t noffset = fh->fptr;
-    unlock();
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "lseek failed: %d\n", res);
@@ -498,9 +612,7 @@ off_t FATFileSystem::file_seek(fs_file_t file, off_t offset, int whence) {
 off_t FATFileSystem::file_tell(fs_file_t file) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     off_t res = fh->fptr;
-    unlock();
 
     return res;
 }
@@ -508,9 +620,7 @@ off_t FATFileSystem::file_tell(fs_file_t file) {
 size_t FATFileSystem::file_size(fs_file_t file) {
     FIL *fh = static_cast<FIL*>(file);
 
-    lock();
     size_t res = fh->fsize;
-    unlock();
 
     return res;
 }
@@ -519,10 +629,11 @@ size_t FATFileSystem::file_size(fs_file_t file) {
 ////// Dir operations //////
 int FATFileSystem::dir_open(fs_dir_t *dir, const char *path) {
     FATFS_DIR *dh = new FATFS_DIR;
+    char *buffer = new char[strlen(_fsid) + strlen(path) + 3];
+    sprintf(buffer, "%s/%s", _fsid, path);
 
-    lock();
-    FRESULT res = f_opendir(dh, path);
-    unlock();
+    FRESULT res = f_opendir(dh, buffer);
+    delete[] buffer;
 
     if (res != FR_OK) {
         debug_if(FFS_DBG, "f_opendir() failed: %d\n", res);
@@ -537,9 +648,7 @@ int FATFileSystem::dir_open(fs_dir_t *dir, const char *path) {
 int FATFileSystem::dir_close(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     FRESULT res = f_closedir(dh);
-    unlock();
 
     delete dh;
     return fat_error_remap(res);
@@ -554,9 +663,7 @@ ssize_t FATFileSystem::dir_read(fs_dir_t dir, struct dirent *ent) {
     finfo.lfsize = NAME_MAX;
 #endif // _USE_LFN
 
-    lock();
     FRESULT res = f_readdir(dh, &finfo);
-    unlock();
 
     if (res != FR_OK) {
         return fat_error_remap(res);
@@ -581,17 +688,13 @@ ssize_t FATFileSystem::dir_read(fs_dir_t dir, struct dirent *ent) {
 void FATFileSystem::dir_seek(fs_dir_t dir, off_t offset) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     dh->index = offset;
-    unlock();
 }
 
 off_t FATFileSystem::dir_tell(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     off_t offset = dh->index;
-    unlock();
 
     return offset;
 }
@@ -599,8 +702,6 @@ off_t FATFileSystem::dir_tell(fs_dir_t dir) {
 void FATFileSystem::dir_rewind(fs_dir_t dir) {
     FATFS_DIR *dh = static_cast<FATFS_DIR*>(dir);
 
-    lock();
     dh->index = 0;
-    unlock();
 }
 
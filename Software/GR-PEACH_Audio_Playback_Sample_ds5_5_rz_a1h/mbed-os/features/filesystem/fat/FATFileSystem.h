@@ -227,10 +227,15 @@ protected:
     
 private:
     FATFS _fs; // Work area (file system object) for logical drive
-    char _fsid[2];
+    char _fsid[3];
     int _id;
 
 protected:
+    /** Locks the volume table for mount, unmount and format
+     *
+     *  File and directory operations are locked per volume inside FatFs
+     *  (_FS_REENTRANT), and not by this lock.
+     */
     virtual void lock();
     virtual void unlock();
 };
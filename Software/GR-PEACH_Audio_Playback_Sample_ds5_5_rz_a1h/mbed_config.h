@@ -16,6 +16,8 @@
 #define MBED_CONF_LWIP_UDP_SOCKET_MAX               4    // set by library:lwip
 #define MBED_CONF_NSAPI_PRESENT                     1    // set by library:nsapi
 #define MBED_CONF_FILESYSTEM_PRESENT                1    // set by library:filesystem
+#define MBED_CONF_FILESYSTEM_FAT_CLMT_NUM           2    // set by library:filesystem
+#define MBED_CONF_FILESYSTEM_FAT_CLMT_SIZE          128  // set by library:filesystem
 #define MBED_CONF_LWIP_IP_VER_PREF                  4    // set by library:lwip
 #define MBED_CONF_PLATFORM_STDIO_CONVERT_NEWLINES   0    // set by library:platform
 #define MBED_CONF_PLATFORM_STDIO_BAUD_RATE          9600 // set by library:platform
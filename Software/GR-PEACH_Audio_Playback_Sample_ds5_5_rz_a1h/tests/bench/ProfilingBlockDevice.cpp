@@ -0,0 +1,129 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProfilingBlockDevice.h"
+
+
+ProfilingBlockDevice::ProfilingBlockDevice(BlockDevice *bd)
+    : _bd(bd), _data_start(0), _next_addr(0)
+    , _cmd_us(0), _seek_us(0), _bytes_per_ms(0), _delay(false)
+{
+    reset_counters();
+}
+
+void ProfilingBlockDevice::set_model(uint32_t cmd_us, uint32_t seek_us, uint32_t bytes_per_ms, bool delay)
+{
+    _cmd_us = cmd_us;
+    _seek_us = seek_us;
+    _bytes_per_ms = bytes_per_ms;
+    _delay = delay;
+}
+
+void ProfilingBlockDevice::set_data_start(bd_addr_t addr)
+{
+    _data_start = addr;
+}
+
+const ProfilingBlockDevice::Counters &ProfilingBlockDevice::get_counters() const
+{
+    return _counters;
+}
+
+void ProfilingBlockDevice::reset_counters()
+{
+    memset(&_counters, 0, sizeof(_counters));
+}
+
+int ProfilingBlockDevice::init()
+{
+    return _bd->init();
+}
+
+int ProfilingBlockDevice::deinit()
+{
+    return _bd->deinit();
+}
+
+int ProfilingBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
+{
+    _counters.read_count += 1;
+    if (addr < _data_start) {
+        _counters.read_meta_count += 1;
+    }
+    if (model(addr, size)) {
+        _counters.read_seek_count += 1;
+    }
+    _counters.read_bytes += size;
+    return _bd->read(b, addr, size);
+}
+
+int ProfilingBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
+{
+    _counters.program_count += 1;
+    _counters.program_bytes += size;
+    model(addr, size);
+    return _bd->program(b, addr, size);
+}
+
+int ProfilingBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    // The erase is a command without the transfer
+    _counters.erase_count += 1;
+    model(addr, 0);
+    _next_addr = addr + size;
+    return _bd->erase(addr, size);
+}
+
+bd_size_t ProfilingBlockDevice::get_read_size() const
+{
+    return _bd->get_read_size();
+}
+
+bd_size_t ProfilingBlockDevice::get_program_size() const
+{
+    return _bd->get_program_size();
+}
+
+bd_size_t ProfilingBlockDevice::get_erase_size() const
+{
+    return _bd->get_erase_size();
+}
+
+bd_size_t ProfilingBlockDevice::size() const
+{
+    return _bd->size();
+}
+
+// Adds the time of a command to the model, returns true if it is not sequential
+bool ProfilingBlockDevice::model(bd_addr_t addr, bd_size_t size)
+{
+    bool seek = (addr != _next_addr);
+    uint64_t us = _cmd_us;
+
+    if (seek) {
+        us += _seek_us;
+    }
+    if (_bytes_per_ms) {
+        us += (size * 1000) / _bytes_per_ms;
+    }
+    _next_addr = addr + size;
+    _counters.model_us += us;
+
+    if (_delay && us) {
+        wait_us((int)us);
+    }
+    return seek;
+}
@@ -0,0 +1,187 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2017 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MBED_PROFILING_BLOCK_DEVICE_H
+#define MBED_PROFILING_BLOCK_DEVICE_H
+
+#include "BlockDevice.h"
+#include "mbed.h"
+
+
+/** Block device for counting the accesses to another block device
+ *
+ *  The reads, programs and erases are passed to the underlying block device
+ *  and counted. The reads below the data start address are also counted
+ *  separately, so the reads of the FAT and the root directory of a FAT
+ *  filesystem can be told from the reads of the file data.
+ *
+ *  A latency model gives the time the accesses would take on a slower device.
+ *  Each command takes cmd_us, a command which does not follow the previous
+ *  one takes seek_us more, and the transfer takes the size divided by the
+ *  bandwidth. The modeled time is summed up, and the accesses are delayed by
+ *  it if delay is enabled.
+ *
+ *  @code
+ *  #include "mbed.h"
+ *  #include "HeapBlockDevice.h"
+ *  #include "ProfilingBlockDevice.h"
+ *
+ *  HeapBlockDevice mem(1024*512, 512);
+ *
+ *  // 1 ms per command and 1 MB/s like a USB full speed memory
+ *  ProfilingBlockDevice profile(&mem);
+ *  profile.set_model(1000, 0, 1000);
+ *  @endcode
+ */
+class ProfilingBlockDevice : public BlockDevice
+{
+public:
+    /** Counters of the accesses
+     */
+    struct Counters {
+        uint32_t read_count;        ///< Number of reads
+        uint32_t read_meta_count;   ///< Number of reads below the data start address
+        uint32_t read_seek_count;   ///< Number of reads which do not follow the previous access
+        uint64_t read_bytes;        ///< Bytes read
+        uint32_t program_count;     ///< Number of programs
+        uint64_t program_bytes;     ///< Bytes programmed
+        uint32_t erase_count;       ///< Number of erases
+        uint64_t model_us;          ///< Time of the accesses in the latency model
+    };
+
+    /** Lifetime of the profiling block device
+     *
+     *  @param bd       Block device to back the ProfilingBlockDevice
+     */
+    ProfilingBlockDevice(BlockDevice *bd);
+
+    /** Lifetime of a block device
+     */
+    virtual ~ProfilingBlockDevice() {};
+
+    /** Set the latency model
+     *
+     *  @param cmd_us       Time of each command in microseconds
+     *  @param seek_us      Extra time of a command which does not follow the previous one
+     *  @param bytes_per_ms Bandwidth in bytes per millisecond, 0 is unlimited
+     *  @param delay        Delays the accesses by the modeled time
+     */
+    void set_model(uint32_t cmd_us, uint32_t seek_us, uint32_t bytes_per_ms, bool delay = false);
+
+    /** Set the address where the data area starts
+     *
+     *  @param addr     Reads below this address are counted as read_meta_count
+     */
+    void set_data_start(bd_addr_t addr);
+
+    /** Get the counters
+     *
+     *  @return         Counters since the last reset_counters()
+     */
+    const Counters &get_counters() const;
+
+    /** Reset the counters
+     */
+    void reset_counters();
+
+    /** Initialize a block device
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int init();
+
+    /** Deinitialize a block device
+     *
+     *  @return         0 on success or a negative error code on failure
+     */
+    virtual int deinit();
+
+    /** Read blocks from a block device
+     *
+     *  @param buffer   Buffer to read blocks into
+     *  @param addr     Address of block to begin reading from
+     *  @param size     Size to read in bytes, must be a multiple of read block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Program blocks to a block device
+     *
+     *  The blocks must have been erased prior to being programmed
+     *
+     *  @param buffer   Buffer of data to write to blocks
+     *  @param addr     Address of block to begin writing to
+     *  @param size     Size to write in bytes, must be a multiple of program block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Erase blocks on a block device
+     *
+     *  The state of an erased block is undefined until it has been programmed
+     *
+     *  @param addr     Address of block to begin erasing
+     *  @param size     Size to erase in bytes, must be a multiple of erase block size
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+
+    /** Get the size of a readable block
+     *
+     *  @return         Size of a readable block in bytes
+     */
+    virtual bd_size_t get_read_size() const;
+
+    /** Get the size of a programable block
+     *
+     *  @return         Size of a programable block in bytes
+     *  @note Must be a multiple of the read size
+     */
+    virtual bd_size_t get_program_size() const;
+
+    /** Get the size of a eraseable block
+     *
+     *  @return         Size of a eraseable block in bytes
+     *  @note Must be a multiple of the program size
+     */
+    virtual bd_size_t get_erase_size() const;
+
+    /** Get the total size of the underlying device
+     *
+     *  @return         Size of the underlying device in bytes
+     */
+    virtual bd_size_t size() const;
+
+protected:
+    BlockDevice *_bd;
+    Counters _counters;
+    bd_addr_t _data_start;
+    bd_addr_t _next_addr;
+    uint32_t _cmd_us;
+    uint32_t _seek_us;
+    uint32_t _bytes_per_ms;
+    bool _delay;
+
+    bool model(bd_addr_t addr, bd_size_t size);
+};
+
+
+#endif
@@ -0,0 +1,95 @@
+/* Linux runner of the storage benchmark (sys_bench.cpp).
+ *
+ *   sys_bench [-c cmd_us] [-s seek_us] [-b bytes_per_ms] [-k cluster]
+ *             [-m disk_mb] [-d] [trace]
+ *
+ * The default model is a USB memory of full speed: one command per frame
+ * of 1 ms and 1000 bytes per ms, on a 64 MB disk of 4 KB clusters. trace
+ * is the console log of a playback with DEC_FLAC_READ_TRACE of
+ * dec_flac.cpp; the lines which are not records are skipped. -d delays
+ * the accesses by the modeled time, so that wall_us follows the model.
+ * The CSV lines of sys_bench_run() go to stdout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "sys_bench.h"
+
+#define BENCH_DISK_SIZE         (64u * 1024u * 1024u)
+#define BENCH_CLUSTER_SIZE      (4096u)
+#define BENCH_CMD_US            (1000u)     /* One command per frame of 1ms */
+#define BENCH_SEEK_US           (0u)
+#define BENCH_BYTES_PER_MS      (1000u)
+#define BENCH_LINE_SIZE         (256u)
+
+static void usage(void)
+{
+    (void)fprintf(stderr, "usage: sys_bench [-c cmd_us] [-s seek_us] [-b bytes_per_ms] [-k cluster]"
+                          " [-m disk_mb] [-d] [trace]\n");
+}
+
+/* Reads the records of a trace file. */
+static bool read_trace(const char * const path, std::vector<sys_bench_trace_t> * const p_trace)
+{
+    FILE                *fp = fopen(path, "r");
+    char                line[BENCH_LINE_SIZE];
+    sys_bench_trace_t   rec;
+
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sys_bench_parse_trace(line, &rec)) {
+            p_trace->push_back(rec);
+        }
+    }
+    (void)fclose(fp);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    sys_bench_model_t               model = {
+        BENCH_DISK_SIZE, BENCH_CLUSTER_SIZE, BENCH_CMD_US, BENCH_SEEK_US, BENCH_BYTES_PER_MS, false
+    };
+    std::vector<sys_bench_trace_t>  trace;
+    int                             opt;
+
+    while ((opt = getopt(argc, argv, "c:s:b:k:m:dh")) != -1) {
+        switch (opt) {
+            case 'c':
+                model.cmd_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                model.seek_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                model.bytes_per_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                model.cluster_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                model.disk_size = (uint32_t)strtoul(optarg, NULL, 0) * 1024u * 1024u;
+                break;
+            case 'd':
+                model.delay = true;
+                break;
+            default:
+                usage();
+                return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if (optind < argc) {
+        if (read_trace(argv[optind], &trace) != true) {
+            return 1;
+        }
+        (void)fprintf(stderr, "%s: %u records\n", argv[optind], (unsigned)trace.size());
+    }
+    if (sys_bench_run(&model, trace.empty() ? NULL : &trace[0], (uint32_t)trace.size()) != true) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,513 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+#include "mbed.h"
+#include "FATFileSystem.h"
+#include "File.h"
+#include "Dir.h"
+#include "HeapBlockDevice.h"
+#include "ProfilingBlockDevice.h"
+#include "system.h"
+#include "sys_bench.h"
+
+/*--- Macro definition ---*/
+#define BENCH_FS_NAME           "bench"
+#define BENCH_BLOCK_SIZE        (512u)
+#define BENCH_BUF_SIZE          (16384u)            /* Maximum size of one read */
+#define BENCH_PATH_SIZE         (256u)
+
+#define BENCH_FILE_SIZE         (1024u * 1024u)     /* File of "seq" and "rand" */
+#define BENCH_RAND_NUM          (64u)               /* Number of reads of "rand" */
+#define BENCH_RAND_SIZE         (4096u)
+#define BENCH_RAND_SEED         (1u)
+#define BENCH_OPEN_DEPTH_MAX    (SYS_MAX_FOLDER_DEPTH - 1u)
+
+#define FILE_SEQ                "seq.flac"
+#define FILE_TRACE              "trace.flac"
+#define FILE_OPEN               "open.flac"
+#define FOLD_OPEN_FORMAT        "d%lu/"             /* Folders of "open" : "d1/d2/..." */
+#define FOLD_SCAN_FORMAT        "s%lu"              /* Folders of "scan" : "s16", "s64" ... */
+#define FILE_SCAN_FORMAT        "s%lu/%03lu Track name longer than 8.3 format.flac"
+
+#define LCG_MUL                 (1103515245u)       /* Random number of "rand" */
+#define LCG_ADD                 (12345u)
+
+/* Boot sector and partition table of FAT volume */
+#define MBR_PART_LBA            (0x1C6u)
+#define BPB_JUMP                (0x000u)
+#define BPB_SEC_PER_CLUS        (0x00Du)
+#define BPB_RSVD_SEC_CNT        (0x00Eu)
+#define BPB_NUM_FATS            (0x010u)
+#define BPB_ROOT_ENT_CNT        (0x011u)
+#define BPB_FAT_SZ16            (0x016u)
+#define BPB_FAT_SZ32            (0x024u)
+#define JUMP_SHORT              (0xEBu)
+#define JUMP_NEAR               (0xE9u)
+#define DIR_ENTRY_SIZE          (32u)
+
+#define PRINT_MSG_HEADER        "bench,item,param,reads,meta_reads,seeks,bytes,model_us,wall_us"
+#define PRINT_MSG_RESULT        "bench,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu"
+#define PRINT_MSG_ERROR         "bench,error,%s"
+
+/*--- User defined types ---*/
+typedef struct {
+    ProfilingBlockDevice    *p_bd;
+    FATFileSystem           *p_fs;
+    Timer                   timer;
+} bench_ctrl_t;
+
+static uint8_t bench_buf[BENCH_BUF_SIZE];
+static const uint32_t seq_size_tbl[] = {BENCH_BLOCK_SIZE, 4096u, BENCH_BUF_SIZE};
+static const uint32_t scan_num_tbl[] = {16u, 64u, 256u};
+
+static bool make_fixtures(FATFileSystem * const p_fs, const uint32_t trace_size);
+static bool make_file(FATFileSystem * const p_fs, const char_t * const p_path, const uint32_t size);
+static void get_open_path(char_t * const p_path, const uint32_t depth);
+static bd_addr_t get_data_start(BlockDevice * const p_bd);
+static uint32_t get_trace_size(const sys_bench_trace_t * const p_trace, const uint32_t trace_num);
+static void start_measure(bench_ctrl_t * const p_ctrl);
+static void end_measure(bench_ctrl_t * const p_ctrl, const char_t * const p_item, const uint32_t param);
+static void bench_seq(bench_ctrl_t * const p_ctrl, const uint32_t read_size);
+static void bench_rand(bench_ctrl_t * const p_ctrl);
+static void bench_open(bench_ctrl_t * const p_ctrl, const uint32_t depth);
+static void bench_scan(bench_ctrl_t * const p_ctrl, const uint32_t entry_num);
+static void bench_trace(bench_ctrl_t * const p_ctrl, 
+                const sys_bench_trace_t * const p_trace, const uint32_t trace_num);
+static ssize_t read_file(File * const p_file, const uint32_t size);
+
+bool sys_bench_run(const sys_bench_model_t * const p_model, 
+                        const sys_bench_trace_t * const p_trace, const uint32_t trace_num)
+{
+    bool                    ret = false;
+    uint32_t                i;
+    uint32_t                trace_size = 0u;
+    HeapBlockDevice         *p_heap;
+    static bench_ctrl_t     ctrl;
+
+    if (p_model != NULL) {
+        if (p_trace != NULL) {
+            trace_size = get_trace_size(p_trace, trace_num);
+        }
+        p_heap = new HeapBlockDevice(p_model->disk_size, BENCH_BLOCK_SIZE);
+        ctrl.p_bd = new ProfilingBlockDevice(p_heap);
+        ctrl.p_fs = new FATFileSystem(BENCH_FS_NAME);
+        if ((ctrl.p_bd->init() == 0) && 
+            (FATFileSystem::format(ctrl.p_bd, (int)p_model->cluster_size) == 0) && 
+            (ctrl.p_fs->mount(ctrl.p_bd, true) == 0) && 
+            (make_fixtures(ctrl.p_fs, trace_size) == true)) {
+            /* The fixtures are made without the delay of the model. */
+            ctrl.p_bd->set_model(p_model->cmd_us, p_model->seek_us, 
+                                    p_model->bytes_per_ms, p_model->delay);
+            ctrl.p_bd->set_data_start(get_data_start(p_heap));
+            (void) printf(PRINT_MSG_HEADER "\n");
+            for (i = 0u; i < (sizeof(seq_size_tbl) / sizeof(seq_size_tbl[0])); i++) {
+                bench_seq(&ctrl, seq_size_tbl[i]);
+            }
+            bench_rand(&ctrl);
+            for (i = 0u; i <= BENCH_OPEN_DEPTH_MAX; i++) {
+                bench_open(&ctrl, i);
+            }
+            for (i = 0u; i < (sizeof(scan_num_tbl) / sizeof(scan_num_tbl[0])); i++) {
+                bench_scan(&ctrl, scan_num_tbl[i]);
+            }
+            if (trace_size > 0u) {
+                bench_trace(&ctrl, p_trace, trace_num);
+            }
+            ret = true;
+        } else {
+            (void) printf(PRINT_MSG_ERROR "\n", "setup");
+        }
+        (void) ctrl.p_fs->unmount();
+        (void) ctrl.p_bd->deinit();
+        delete ctrl.p_fs;
+        delete ctrl.p_bd;
+        delete p_heap;
+    }
+    return ret;
+}
+
+bool sys_bench_parse_trace(const char * const p_line, sys_bench_trace_t * const p_trace)
+{
+    bool            ret = false;
+    char            *p_end;
+    unsigned long   pos;
+    unsigned long   bytes = 0u;
+
+    if ((p_line != NULL) && (p_trace != NULL) && (p_line[1] == ',')) {
+        if ((p_line[0] == SYS_BENCH_TRACE_READ) || (p_line[0] == SYS_BENCH_TRACE_SEEK)) {
+            pos = strtoul(&p_line[2], &p_end, 10);
+            if (p_end != &p_line[2]) {
+                ret = true;
+                if (p_line[0] == SYS_BENCH_TRACE_READ) {
+                    if (*p_end == ',') {
+                        bytes = strtoul(&p_end[1], &p_end, 10);
+                    } else {
+                        ret = false;
+                    }
+                }
+            }
+            if (ret == true) {
+                p_trace->type  = p_line[0];
+                p_trace->pos   = (uint32_t)pos;
+                p_trace->bytes = (uint32_t)bytes;
+            }
+        }
+    }
+    return ret;
+}
+
+/** Makes the files and folders used by the measurements
+ *
+ *  @param p_fs Pointer to the file system.
+ *  @param trace_size Size of the file of the I/O trace. 0 is not made.
+ *
+ *  @returns 
+ *    true if all of them were made. false if some of them failed.
+ */
+static bool make_fixtures(FATFileSystem * const p_fs, const uint32_t trace_size)
+{
+    bool            ret;
+    uint32_t        i;
+    uint32_t        j;
+    char_t          path[BENCH_PATH_SIZE];
+
+    ret = make_file(p_fs, FILE_SEQ, BENCH_FILE_SIZE);
+    if ((ret == true) && (trace_size > 0u)) {
+        ret = make_file(p_fs, FILE_TRACE, trace_size);
+    }
+    for (i = 0u; (i <= BENCH_OPEN_DEPTH_MAX) && (ret == true); i++) {
+        get_open_path(path, i);
+        if (i > 0u) {
+            /* The folders of the previous depths are already made. */
+            path[strlen(path) - sizeof("/" FILE_OPEN) + 1u] = '\0';
+            if (p_fs->mkdir(path, 0) != 0) {
+                ret = false;
+            }
+            get_open_path(path, i);
+        }
+        if (ret == true) {
+            ret = make_file(p_fs, path, BENCH_BLOCK_SIZE);
+        }
+    }
+    for (i = 0u; (i < (sizeof(scan_num_tbl) / sizeof(scan_num_tbl[0]))) && (ret == true); i++) {
+        (void) sprintf(path, FOLD_SCAN_FORMAT, (unsigned long)scan_num_tbl[i]);
+        if (p_fs->mkdir(path, 0) != 0) {
+            ret = false;
+        }
+        for (j = 0u; (j < scan_num_tbl[i]) && (ret == true); j++) {
+            (void) sprintf(path, FILE_SCAN_FORMAT, (unsigned long)scan_num_tbl[i], (unsigned long)j);
+            ret = make_file(p_fs, path, 0u);
+        }
+    }
+    return ret;
+}
+
+/** Makes a file
+ *
+ *  @param p_fs Pointer to the file system.
+ *  @param p_path Pointer to the path of the file.
+ *  @param size Size of the file.
+ *
+ *  @returns 
+ *    true if the file was made. false if it failed.
+ */
+static bool make_file(FATFileSystem * const p_fs, const char_t * const p_path, const uint32_t size)
+{
+    bool            ret = false;
+    uint32_t        i;
+    uint32_t        pos = 0u;
+    uint32_t        write_size;
+    File            file;
+
+    if (file.open(p_fs, p_path, O_WRONLY | O_CREAT | O_TRUNC) == 0) {
+        ret = true;
+        while ((pos < size) && (ret == true)) {
+            write_size = size - pos;
+            if (write_size > sizeof(bench_buf)) {
+                write_size = sizeof(bench_buf);
+            }
+            for (i = 0u; i < write_size; i++) {
+                bench_buf[i] = (uint8_t)(pos + i);
+            }
+            if (file.write(bench_buf, write_size) != (ssize_t)write_size) {
+                ret = false;
+            }
+            pos += write_size;
+        }
+        if (file.close() != 0) {
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+/** Gets the path of the file of "open"
+ *
+ *  @param p_path Pointer to store the path.
+ *  @param depth Folder depth of the file.
+ */
+static void get_open_path(char_t * const p_path, const uint32_t depth)
+{
+    uint32_t        i;
+
+    p_path[0] = '\0';
+    for (i = 1u; i <= depth; i++) {
+        (void) sprintf(&p_path[strlen(p_path)], FOLD_OPEN_FORMAT, (unsigned long)i);
+    }
+    (void) strcat(p_path, FILE_OPEN);
+}
+
+/** Gets the address of the data area of FAT volume
+ *
+ *  @param p_bd Pointer to the block device which has the FAT volume.
+ *
+ *  @returns 
+ *    Address of the first cluster. The reads before it are the FAT and the root folder.
+ */
+static bd_addr_t get_data_start(BlockDevice * const p_bd)
+{
+    bd_addr_t       addr = 0u;
+    uint32_t        fat_size;
+    uint32_t        root_size;
+
+    if (p_bd->read(bench_buf, 0u, BENCH_BLOCK_SIZE) == 0) {
+        if ((bench_buf[BPB_JUMP] != JUMP_SHORT) && (bench_buf[BPB_JUMP] != JUMP_NEAR)) {
+            /* Sector 0 is the partition table made by f_mkfs(). */
+            addr = (bd_addr_t)((uint32_t)bench_buf[MBR_PART_LBA] | 
+                            ((uint32_t)bench_buf[MBR_PART_LBA + 1u] << 8) | 
+                            ((uint32_t)bench_buf[MBR_PART_LBA + 2u] << 16) | 
+                            ((uint32_t)bench_buf[MBR_PART_LBA + 3u] << 24)) * BENCH_BLOCK_SIZE;
+        }
+        if (p_bd->read(bench_buf, addr, BENCH_BLOCK_SIZE) == 0) {
+            fat_size = (uint32_t)bench_buf[BPB_FAT_SZ16] | ((uint32_t)bench_buf[BPB_FAT_SZ16 + 1u] << 8);
+            if (fat_size == 0u) {
+                fat_size = (uint32_t)bench_buf[BPB_FAT_SZ32] | 
+                            ((uint32_t)bench_buf[BPB_FAT_SZ32 + 1u] << 8) | 
+                            ((uint32_t)bench_buf[BPB_FAT_SZ32 + 2u] << 16) | 
+                            ((uint32_t)bench_buf[BPB_FAT_SZ32 + 3u] << 24);
+            }
+            root_size = (((uint32_t)bench_buf[BPB_ROOT_ENT_CNT] | 
+                            ((uint32_t)bench_buf[BPB_ROOT_ENT_CNT + 1u] << 8)) * DIR_ENTRY_SIZE) / BENCH_BLOCK_SIZE;
+            addr += (bd_addr_t)(((uint32_t)bench_buf[BPB_RSVD_SEC_CNT] | 
+                            ((uint32_t)bench_buf[BPB_RSVD_SEC_CNT + 1u] << 8)) + 
+                            ((uint32_t)bench_buf[BPB_NUM_FATS] * fat_size) + root_size) * BENCH_BLOCK_SIZE;
+        }
+    }
+    return addr;
+}
+
+/** Gets the size of the file needed by the I/O trace
+ *
+ *  @param p_trace Pointer to the I/O trace.
+ *  @param trace_num Number of the records.
+ *
+ *  @returns 
+ *    End position of the last byte read or seeked by the I/O trace.
+ */
+static uint32_t get_trace_size(const sys_bench_trace_t * const p_trace, const uint32_t trace_num)
+{
+    uint32_t        i;
+    uint32_t        size = 0u;
+
+    for (i = 0u; i < trace_num; i++) {
+        if ((p_trace[i].pos + p_trace[i].bytes) > size) {
+            size = p_trace[i].pos + p_trace[i].bytes;
+        }
+    }
+    return size;
+}
+
+/** Starts a measurement
+ *
+ *  The volume is mounted again, so that the measurement starts without the cache.
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ */
+static void start_measure(bench_ctrl_t * const p_ctrl)
+{
+    (void) p_ctrl->p_fs->unmount();
+    (void) p_ctrl->p_fs->mount(p_ctrl->p_bd, true);
+    p_ctrl->p_bd->reset_counters();
+    p_ctrl->timer.reset();
+    p_ctrl->timer.start();
+}
+
+/** Ends a measurement and prints the result
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ *  @param p_item Pointer to the name of the measured item.
+ *  @param param Parameter of the measured item.
+ */
+static void end_measure(bench_ctrl_t * const p_ctrl, const char_t * const p_item, const uint32_t param)
+{
+    const ProfilingBlockDevice::Counters    &cnt = p_ctrl->p_bd->get_counters();
+
+    p_ctrl->timer.stop();
+    (void) printf(PRINT_MSG_RESULT "\n", p_item, (unsigned long)param, 
+                    (unsigned long)cnt.read_count, (unsigned long)cnt.read_meta_count, 
+                    (unsigned long)cnt.read_seek_count, (unsigned long)cnt.read_bytes, 
+                    (unsigned long)cnt.model_us, (unsigned long)p_ctrl->timer.read_us());
+}
+
+/** Measures the sequential read
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ *  @param read_size Size of each read.
+ */
+static void bench_seq(bench_ctrl_t * const p_ctrl, const uint32_t read_size)
+{
+    File            file;
+
+    start_measure(p_ctrl);
+    if (file.open(p_ctrl->p_fs, FILE_SEQ) == 0) {
+        while (read_file(&file, read_size) > 0) {
+            /* DO NOTHING */
+        }
+        (void) file.close();
+    }
+    end_measure(p_ctrl, "seq", read_size);
+}
+
+/** Measures the random read
+ *
+ *  The positions are the same in every run.
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ */
+static void bench_rand(bench_ctrl_t * const p_ctrl)
+{
+    uint32_t        i;
+    uint32_t        rand_val = BENCH_RAND_SEED;
+    File            file;
+
+    start_measure(p_ctrl);
+    if (file.open(p_ctrl->p_fs, FILE_SEQ) == 0) {
+        for (i = 0u; i < BENCH_RAND_NUM; i++) {
+            rand_val = (rand_val * LCG_MUL) + LCG_ADD;
+            (void) file.seek((off_t)((rand_val >> 8) % (BENCH_FILE_SIZE - BENCH_RAND_SIZE)));
+            (void) read_file(&file, BENCH_RAND_SIZE);
+        }
+        (void) file.close();
+    }
+    end_measure(p_ctrl, "rand", BENCH_RAND_SIZE);
+}
+
+/** Measures the file open
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ *  @param depth Folder depth of the file.
+ */
+static void bench_open(bench_ctrl_t * const p_ctrl, const uint32_t depth)
+{
+    char_t          path[BENCH_PATH_SIZE];
+    File            file;
+
+    get_open_path(path, depth);
+    start_measure(p_ctrl);
+    if (file.open(p_ctrl->p_fs, path) == 0) {
+        (void) file.close();
+    }
+    end_measure(p_ctrl, "open", depth);
+}
+
+/** Measures the folder scan
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ *  @param entry_num Number of the entries of the folder.
+ */
+static void bench_scan(bench_ctrl_t * const p_ctrl, const uint32_t entry_num)
+{
+    char_t          path[BENCH_PATH_SIZE];
+    struct dirent   ent;
+    Dir             dir;
+
+    (void) sprintf(path, FOLD_SCAN_FORMAT, (unsigned long)entry_num);
+    start_measure(p_ctrl);
+    if (dir.open(p_ctrl->p_fs, path) == 0) {
+        while (dir.read(&ent) > 0) {
+            /* DO NOTHING */
+        }
+        (void) dir.close();
+    }
+    end_measure(p_ctrl, "scan", entry_num);
+}
+
+/** Measures the replay of the I/O trace
+ *
+ *  The reads are done at the recorded position. A read which does not follow
+ *  the previous one is done after the seek, the same as fread() after fseek().
+ *
+ *  @param p_ctrl Pointer to the control data of benchmark.
+ *  @param p_trace Pointer to the I/O trace.
+ *  @param trace_num Number of the records.
+ */
+static void bench_trace(bench_ctrl_t * const p_ctrl, 
+                const sys_bench_trace_t * const p_trace, const uint32_t trace_num)
+{
+    uint32_t        i;
+    uint32_t        pos = 0u;
+    uint32_t        rest;
+    ssize_t         read_size;
+    File            file;
+
+    start_measure(p_ctrl);
+    if (file.open(p_ctrl->p_fs, FILE_TRACE) == 0) {
+        for (i = 0u; i < trace_num; i++) {
+            if (p_trace[i].pos != pos) {
+                pos = p_trace[i].pos;
+                (void) file.seek((off_t)pos);
+            }
+            if (p_trace[i].type == SYS_BENCH_TRACE_READ) {
+                rest = p_trace[i].bytes;
+                read_size = 1;
+                while ((rest > 0u) && (read_size > 0)) {
+                    read_size = read_file(&file, rest);
+                    if (read_size > 0) {
+                        pos  += (uint32_t)read_size;
+                        rest -= (uint32_t)read_size;
+                    }
+                }
+            }
+        }
+        (void) file.close();
+    }
+    end_measure(p_ctrl, "trace", trace_num);
+}
+
+/** Reads a file to the work buffer
+ *
+ *  @param p_file Pointer to the file.
+ *  @param size Size to read. It is limited to the size of the work buffer.
+ *
+ *  @returns 
+ *    Size read. 0 is the end of file. Negative value is failure.
+ */
+static ssize_t read_file(File * const p_file, const uint32_t size)
+{
+    uint32_t        read_size = size;
+
+    if (read_size > sizeof(bench_buf)) {
+        read_size = sizeof(bench_buf);
+    }
+    return p_file->read(bench_buf, read_size);
+}
@@ -0,0 +1,87 @@
+/*******************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only
+* intended for use with Renesas products. No other uses are authorized. This
+* software is owned by Renesas Electronics Corporation and is protected under
+* all applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT
+* LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+* AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED.
+* TO THE MAXIMUM EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS
+* ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES SHALL BE LIABLE
+* FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR
+* ANY REASON RELATED TO THIS SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE
+* BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software
+* and to discontinue the availability of this software. By using this software,
+* you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer*
+* Copyright (C) 2015 Renesas Electronics Corporation. All rights reserved.
+*******************************************************************************/
+
+
+#ifndef SYS_BENCH_H
+#define SYS_BENCH_H
+
+#include "r_typedefs.h"
+
+/*--- Macro definition ---*/
+#define SYS_BENCH_TRACE_READ    ('R')   /* Record of fread() : "R,<position>,<bytes>" */
+#define SYS_BENCH_TRACE_SEEK    ('S')   /* Record of fseek() : "S,<position>" */
+
+/*--- User defined types ---*/
+/* Storage model of the benchmark */
+typedef struct {
+    uint32_t    disk_size;      /* Size of the RAM disk in bytes */
+    uint32_t    cluster_size;   /* Allocation unit of the FAT volume in bytes. 0 is the default of f_mkfs. */
+    uint32_t    cmd_us;         /* Time of each command of the block device */
+    uint32_t    seek_us;        /* Extra time of a command which does not follow the previous one */
+    uint32_t    bytes_per_ms;   /* Bandwidth of the block device. 0 is unlimited. */
+    bool        delay;          /* Delays the accesses by the modeled time */
+} sys_bench_model_t;
+
+/* Record of the I/O trace captured by DEC_FLAC_READ_TRACE of dec_flac.cpp */
+typedef struct {
+    char        type;           /* SYS_BENCH_TRACE_READ or SYS_BENCH_TRACE_SEEK */
+    uint32_t    pos;            /* File position */
+    uint32_t    bytes;          /* Read size. 0 for SYS_BENCH_TRACE_SEEK. */
+} sys_bench_trace_t;
+
+/** Runs the storage benchmark
+ *
+ *  Makes a FAT volume on a RAM disk, which is accessed through the storage model,
+ *  and measures the following items. The volume is mounted again before each
+ *  measurement, so it starts without the cache of FatFs.
+ *    seq   : Sequential read of a file. Parameter is the read size.
+ *    rand  : Random read of a file. Parameter is the read size.
+ *    open  : Opening a file. Parameter is the folder depth of the file.
+ *    scan  : Reading all entries of a folder. Parameter is the number of entries.
+ *    trace : Replay of the I/O trace. Parameter is the number of records.
+ *  A CSV line is printed to stdout for each measurement.
+ *    bench,<item>,<parameter>,<reads>,<meta_reads>,<seeks>,<bytes>,<model_us>,<wall_us>
+ *  reads is the number of reads of the block device, and meta_reads is the
+ *  number of them before the data area (FAT and root folder).
+ *
+ *  @param p_model Pointer to the storage model.
+ *  @param p_trace Pointer to the I/O trace. NULL skips the replay.
+ *  @param trace_num Number of the records of the I/O trace.
+ *
+ *  @returns 
+ *    true if all items were measured. false if the RAM disk could not be made.
+ */
+bool sys_bench_run(const sys_bench_model_t * const p_model, 
+                        const sys_bench_trace_t * const p_trace, const uint32_t trace_num);
+
+/** Parses a line of the I/O trace
+ *
+ *  @param p_line Pointer to the line printed by DEC_FLAC_READ_TRACE.
+ *  @param p_trace Pointer to store the record.
+ *
+ *  @returns 
+ *    true if the line is a record. false if it is other output.
+ */
+bool sys_bench_parse_trace(const char * const p_line, sys_bench_trace_t * const p_trace);
+
+#endif /* SYS_BENCH_H */
@@ -0,0 +1,181 @@
+/* Writer of small synthetic FLAC streams for the GR-PEACH host tests.
+ * The tree has no FLAC encoder, so frames are written with VERBATIM
+ * subframes and independent channels; any rate, channel count (1-8) and
+ * bit depth (4-32) that the format allows can be produced bit-exactly.
+ */
+#ifndef FLAC_WRITER_H
+#define FLAC_WRITER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+extern "C" {
+#include "private/crc.h"
+}
+
+class FlacWriter {
+public:
+    enum {
+        TYPE_STREAMINFO     = 0,
+        TYPE_PADDING        = 1,
+        TYPE_APPLICATION    = 2,
+        TYPE_SEEKTABLE      = 3,
+        TYPE_VORBIS_COMMENT = 4,
+        TYPE_PICTURE        = 6
+    };
+
+    FlacWriter() : bit_cnt(0u) {
+        put_bytes("fLaC", 4u);
+    }
+
+    /* STREAMINFO with fixed block size and no MD5 (all zero skips the check) */
+    /* until md5() writes it. */
+    void streaminfo(uint32_t rate, uint32_t ch, uint32_t bps, uint64_t total,
+                    uint32_t block_size, bool last) {
+        block_header(TYPE_STREAMINFO, 34u, last);
+        put_bits(block_size, 16u);
+        put_bits(block_size, 16u);
+        put_bits(0u, 24u);
+        put_bits(0u, 24u);
+        put_bits(rate, 20u);
+        put_bits(ch - 1u, 3u);
+        put_bits(bps - 1u, 5u);
+        put_bits((uint32_t)(total >> 32), 4u);
+        put_bits((uint32_t)total, 32u);
+        for (uint32_t i = 0u; i < 16u; i++) {
+            put_bits(0u, 8u);
+        }
+    }
+
+    /* Any metadata block with the body given by the caller. */
+    void block(uint32_t type, const std::vector<uint8_t> &body, bool last) {
+        block_header(type, (uint32_t)body.size(), last);
+        buf.insert(buf.end(), body.begin(), body.end());
+    }
+
+    /* VORBIS_COMMENT body from "NAME=value" entries. */
+    static std::vector<uint8_t> vorbis_comment(const std::vector<std::string> &entries) {
+        std::vector<uint8_t>    body;
+        const std::string       vendor("host test");
+
+        put_le32(body, (uint32_t)vendor.size());
+        body.insert(body.end(), vendor.begin(), vendor.end());
+        put_le32(body, (uint32_t)entries.size());
+        for (size_t i = 0u; i < entries.size(); i++) {
+            put_le32(body, (uint32_t)entries[i].size());
+            body.insert(body.end(), entries[i].begin(), entries[i].end());
+        }
+        return body;
+    }
+
+    /* SEEKTABLE body from (sample, offset from the first frame, samples) points. */
+    static std::vector<uint8_t> seektable(const std::vector<uint64_t> &samples,
+                                          const std::vector<uint64_t> &offsets,
+                                          uint32_t frame_samples) {
+        std::vector<uint8_t>    body;
+
+        for (size_t i = 0u; i < samples.size(); i++) {
+            put_be(body, samples[i], 8u);
+            put_be(body, offsets[i], 8u);
+            put_be(body, frame_samples, 2u);
+        }
+        return body;
+    }
+
+    /* Writes the MD5 of the decoded samples into STREAMINFO. */
+    void md5(const uint8_t digest[16]) {
+        (void)memcpy(&buf[STREAMINFO_MD5_POS], digest, 16u);
+    }
+
+    /* One frame of p_pcm (interleaved, sample_num frames of ch channels).
+     * The sample rate and the bit depth are taken from STREAMINFO. */
+    void frame(uint32_t frame_no, const int32_t *p_pcm, uint32_t sample_num,
+               uint32_t ch, uint32_t bps) {
+        const size_t    top = buf.size();
+
+        put_bits(0xFFF8u, 16u);             /* sync, fixed block size */
+        put_bits(0x7u, 4u);                 /* block size - 1 in 16 bits */
+        put_bits(0x0u, 4u);                 /* rate from STREAMINFO */
+        put_bits(ch - 1u, 4u);              /* independent channels */
+        put_bits(0x0u, 3u);                 /* bit depth from STREAMINFO */
+        put_bits(0x0u, 1u);
+        put_utf8(frame_no);
+        put_bits(sample_num - 1u, 16u);
+        put_bits(FLAC__crc8(&buf[top], (uint32_t)(buf.size() - top)), 8u);
+        for (uint32_t c = 0u; c < ch; c++) {
+            put_bits(0x02u, 8u);            /* VERBATIM, no wasted bits */
+            for (uint32_t i = 0u; i < sample_num; i++) {
+                put_bits((uint32_t)p_pcm[(i * ch) + c], bps);
+            }
+        }
+        while (bit_cnt != 0u) {
+            put_bits(0u, 1u);
+        }
+        put_bits(FLAC__crc16(&buf[top], (uint32_t)(buf.size() - top)), 16u);
+    }
+
+    const std::vector<uint8_t> &data() const {
+        return buf;
+    }
+
+private:
+    enum {
+        STREAMINFO_MD5_POS  = 4 + 4 + 18   /* "fLaC", block header, fields before the MD5 */
+    };
+
+    std::vector<uint8_t>    buf;
+    uint32_t                bit_cnt;
+
+    void block_header(uint32_t type, uint32_t length, bool last) {
+        put_bits((last ? 0x80u : 0x00u) | type, 8u);
+        put_bits(length, 24u);
+    }
+
+    void put_bytes(const char *p, uint32_t len) {
+        buf.insert(buf.end(), (const uint8_t *)p, (const uint8_t *)p + len);
+    }
+
+    void put_bits(uint32_t val, uint32_t bits) {
+        for (uint32_t i = bits; i > 0u; i--) {
+            if (bit_cnt == 0u) {
+                buf.push_back(0u);
+            }
+            if (((val >> (i - 1u)) & 1u) != 0u) {
+                buf.back() |= (uint8_t)(0x80u >> bit_cnt);
+            }
+            bit_cnt = (bit_cnt + 1u) & 7u;
+        }
+    }
+
+    void put_utf8(uint32_t val) {
+        if (val < 0x80u) {
+            put_bits(val, 8u);
+        } else {
+            uint32_t    n = 2u;
+
+            while (val >= (1u << ((5u * n) + 1u))) {
+                n++;
+            }
+            put_bits(((0xFF00u >> n) & 0xFFu) | (val >> (6u * (n - 1u))), 8u);
+            for (uint32_t i = n - 1u; i > 0u; i--) {
+                put_bits(0x2u, 2u);
+                put_bits((val >> (6u * (i - 1u))) & 0x3Fu, 6u);
+            }
+        }
+    }
+
+    static void put_be(std::vector<uint8_t> &out, uint64_t val, uint32_t bytes) {
+        for (uint32_t i = bytes; i > 0u; i--) {
+            out.push_back((uint8_t)(val >> (8u * (i - 1u))));
+        }
+    }
+
+    static void put_le32(std::vector<uint8_t> &out, uint32_t val) {
+        for (uint32_t i = 0u; i < 4u; i++) {
+            out.push_back((uint8_t)(val >> (8u * i)));
+        }
+    }
+};
+
+#endif /* FLAC_WRITER_H */
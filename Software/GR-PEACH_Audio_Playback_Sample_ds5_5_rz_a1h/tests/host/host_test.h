@@ -0,0 +1,60 @@
+/* Minimal check macros shared by the GR-PEACH host tests.
+ * Each test program returns HOST_TEST_RESULT() from main(), so ctest sees
+ * a non-zero exit status when any check failed.
+ */
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static int host_test_fail_cnt;
+
+#define HOST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            (void)printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_fail_cnt++;                                               \
+        }                                                                       \
+    } while (0)
+
+#define HOST_CHECK_EQ(expect, actual)                                           \
+    do {                                                                        \
+        const long long host_e = (long long)(expect);                           \
+        const long long host_a = (long long)(actual);                           \
+        if (host_e != host_a) {                                                 \
+            (void)printf("%s:%d: check failed: %s == %s (%lld != %lld)\n",      \
+                         __FILE__, __LINE__, #expect, #actual, host_e, host_a); \
+            host_test_fail_cnt++;                                               \
+        }                                                                       \
+    } while (0)
+
+#define HOST_TEST_RESULT()                                                      \
+    ((host_test_fail_cnt == 0) ? (printf("PASS\n"), 0)                          \
+                               : (printf("FAIL (%d)\n", host_test_fail_cnt), 1))
+
+/* Monotonic time in ns for the benchmarks printed by the tests. */
+static inline uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000uLL) + (uint64_t)ts.tv_nsec;
+}
+
+/* Cycle counter for the cycles per sample figures. On x86 it is the TSC, */
+/* which counts at the nominal clock. Elsewhere it falls back to ns. */
+static inline uint64_t host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint64_t)__rdtsc();
+#else
+    return host_time_ns();
+#endif
+}
+
+#endif /* HOST_TEST_H */
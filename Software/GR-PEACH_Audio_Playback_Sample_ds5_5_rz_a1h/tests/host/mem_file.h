@@ -0,0 +1,82 @@
+/* Read-only FILE over a memory image for the GR-PEACH host tests.
+ * The decoders use stdio like on the target; the cookie counts what
+ * reaches the "media" below the stdio buffer, i.e. the reads and seeks
+ * FatFs would see.
+ */
+#ifndef MEM_FILE_H
+#define MEM_FILE_H
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <vector>
+
+typedef struct {
+    const uint8_t   *p_data;
+    size_t          size;
+    size_t          pos;
+    uint32_t        read_cnt;       /* read calls */
+    uint64_t        read_bytes;     /* bytes returned by the read calls */
+    uint32_t        seek_cnt;       /* seeks which moved the position */
+} mem_file_t;
+
+static ssize_t mem_file_read(void *cookie, char *buf, size_t size)
+{
+    mem_file_t  *p_mf = (mem_file_t *)cookie;
+    size_t      len = 0u;
+
+    if (p_mf->pos < p_mf->size) {
+        len = p_mf->size - p_mf->pos;
+        if (len > size) {
+            len = size;
+        }
+        (void)memcpy(buf, &p_mf->p_data[p_mf->pos], len);
+        p_mf->pos += len;
+    }
+    p_mf->read_cnt++;
+    p_mf->read_bytes += len;
+    return (ssize_t)len;
+}
+
+static int mem_file_seek(void *cookie, off64_t *offset, int whence)
+{
+    mem_file_t  *p_mf = (mem_file_t *)cookie;
+    off64_t     pos;
+
+    if (whence == SEEK_SET) {
+        pos = *offset;
+    } else if (whence == SEEK_CUR) {
+        pos = (off64_t)p_mf->pos + *offset;
+    } else {
+        pos = (off64_t)p_mf->size + *offset;
+    }
+    if (pos < 0) {
+        return -1;
+    }
+    if ((size_t)pos != p_mf->pos) {
+        p_mf->seek_cnt++;
+    }
+    p_mf->pos = (size_t)pos;
+    *offset = pos;
+    return 0;
+}
+
+/* Opens p_mf over the image. The image must outlive the FILE. */
+static inline FILE *mem_file_open(mem_file_t *p_mf, const std::vector<uint8_t> &image)
+{
+    cookie_io_functions_t   io;
+
+    (void)memset(p_mf, 0, sizeof(*p_mf));
+    p_mf->p_data = image.data();
+    p_mf->size = image.size();
+    (void)memset(&io, 0, sizeof(io));
+    io.read = &mem_file_read;
+    io.seek = &mem_file_seek;
+    return fopencookie(p_mf, "r", io);
+}
+
+#endif /* MEM_FILE_H */
@@ -0,0 +1,170 @@
+/* FatFs on a RAM disk for the GR-PEACH host tests.
+ * The real FATFileSystem and ChaN FatFs run on a HeapBlockDevice behind
+ * a ProfilingBlockDevice, whose data start is set to the end of the FAT:
+ * its read_meta_count is the number of reads of the boot sectors and the
+ * FAT, i.e. the reads a cluster link map table saves. The files are
+ * filled with a pattern of their seed and offset, so that any range read
+ * back can be checked.
+ */
+#ifndef RAM_FS_H
+#define RAM_FS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "FATFileSystem.h"
+#include "File.h"
+#include "Dir.h"
+#include "HeapBlockDevice.h"
+#include "ProfilingBlockDevice.h"
+
+#define RAM_FS_SECTOR       (512u)
+#define RAM_FS_SPACER_DIR   "spacer"
+
+class RamFs {
+public:
+    RamFs(const char *name, bd_size_t size)
+        : heap(size, RAM_FS_SECTOR), prof(&heap), fs(name), spacer_cnt(0u) {}
+
+    /* Formats the disk as FatFs does for the firmware, and mounts it. */
+    bool format(const int cluster) {
+        (void)fs.unmount();
+        return (FATFileSystem::format(&prof, cluster) == 0) && remount();
+    }
+
+    /* Mounts the disk again, so that the next access starts without any */
+    /* sector in the caches of FatFs, and clears the counters. */
+    bool remount(void) {
+        (void)fs.unmount();
+        if (fs.mount(&prof, true) != 0) {
+            return false;
+        }
+        prof.set_data_start(fat_end());
+        prof.reset_counters();
+        return true;
+    }
+
+    const ProfilingBlockDevice::Counters &cnt(void) const {
+        return prof.get_counters();
+    }
+
+    /* Byte of the pattern of a file. */
+    static uint8_t pattern(const uint32_t seed, const uint32_t ofs) {
+        uint32_t    x = (seed * 0x9E3779B9u) ^ (ofs >> 2);
+
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        return (uint8_t)(x >> ((ofs & 3u) * 8u));
+    }
+
+    static void fill(uint8_t * const p_buf, const uint32_t seed, const uint32_t ofs, const uint32_t len) {
+        for (uint32_t i = 0u; i < len; i++) {
+            p_buf[i] = pattern(seed, ofs + i);
+        }
+    }
+
+    /* Counts the bytes of p_buf which differ from the pattern. */
+    static uint32_t verify(const uint8_t * const p_buf, const uint32_t seed, const uint32_t ofs, const uint32_t len) {
+        uint32_t    err = 0u;
+
+        for (uint32_t i = 0u; i < len; i++) {
+            if (p_buf[i] != pattern(seed, ofs + i)) {
+                err++;
+            }
+        }
+        return err;
+    }
+
+    /* Writes a file of the pattern in frag_num fragments: a spacer file */
+    /* of one cluster is written after each fragment but the last one, so */
+    /* that the next fragment is allocated behind it. */
+    bool write_file(const char * const path, const uint32_t size, const uint32_t seed,
+                    const uint32_t frag_num = 1u) {
+        File                    file;
+        std::vector<uint8_t>    buf;
+        const uint32_t          frag_size = (size + frag_num - 1u) / frag_num;
+        uint32_t                ofs = 0u;
+        uint32_t                len;
+        bool                    result;
+
+        result = (file.open(&fs, path, O_WRONLY | O_CREAT | O_TRUNC) == 0);
+        if ((result == true) && (frag_num > 1u)) {
+            (void)fs.mkdir(RAM_FS_SPACER_DIR, 0777);
+        }
+        while ((result == true) && (ofs < size)) {
+            len = ((size - ofs) < frag_size) ? (size - ofs) : frag_size;
+            buf.resize(len);
+            fill(&buf[0], seed, ofs, len);
+            result = (file.write(&buf[0], len) == (ssize_t)len);
+            ofs += len;
+            if ((result == true) && (ofs < size)) {
+                result = write_spacer();
+            }
+        }
+        if (file.close() != 0) {
+            result = false;
+        }
+        return result;
+    }
+
+    HeapBlockDevice         heap;
+    ProfilingBlockDevice    prof;
+    FATFileSystem           fs;
+
+private:
+    uint32_t                spacer_cnt;
+
+    bool write_spacer(void) {
+        File        file;
+        char        path[32];
+        uint8_t     data[RAM_FS_SECTOR];
+        bool        result;
+
+        (void)snprintf(path, sizeof(path), RAM_FS_SPACER_DIR "/%05u.bin", (unsigned)spacer_cnt);
+        spacer_cnt++;
+        (void)memset(data, 0xA5, sizeof(data));
+        result = (file.open(&fs, path, O_WRONLY | O_CREAT | O_TRUNC) == 0);
+        if (result == true) {
+            result = (file.write(data, sizeof(data)) == (ssize_t)sizeof(data));
+            if (file.close() != 0) {
+                result = false;
+            }
+        }
+        return result;
+    }
+
+    /* End of the FAT on the disk: the root directory of FAT12/16, the */
+    /* data area of FAT32 or the cluster heap of exFAT. The boot sector is */
+    /* the first one or the one of the first partition. */
+    bd_addr_t fat_end(void) {
+        uint8_t     bs[RAM_FS_SECTOR];
+        uint32_t    base = 0u;
+        uint32_t    fat_size;
+
+        (void)heap.read(bs, 0u, RAM_FS_SECTOR);
+        if ((memcmp(&bs[3], "EXFAT   ", 8u) != 0) && (bs[0] != 0xEBu) && (bs[0] != 0xE9u)) {
+            base = ld_dword(&bs[0x1C6]);
+            (void)heap.read(bs, (bd_addr_t)base * RAM_FS_SECTOR, RAM_FS_SECTOR);
+        }
+        if (memcmp(&bs[3], "EXFAT   ", 8u) == 0) {
+            return (bd_addr_t)(base + ld_dword(&bs[0x58])) * RAM_FS_SECTOR;
+        }
+        fat_size = ld_word(&bs[0x16]);
+        if (fat_size == 0u) {
+            fat_size = ld_dword(&bs[0x24]);
+        }
+        return (bd_addr_t)(base + ld_word(&bs[0x0E]) + (bs[0x10] * fat_size)) * RAM_FS_SECTOR;
+    }
+
+    static uint32_t ld_word(const uint8_t * const p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+    }
+
+    static uint32_t ld_dword(const uint8_t * const p) {
+        return ld_word(p) | (ld_word(&p[2]) << 16);
+    }
+};
+
+#endif /* RAM_FS_H */
@@ -0,0 +1,238 @@
+/* Host test and benchmark of dec_dmx: downmix and bit count adjustment of
+ * the decoder output.
+ *
+ * Every kernel (1ch to 8ch) is checked bit-exact against a plain model of
+ * the Q15 matrix for the 8/12/16/20/24/32 bits inputs, so both shift paths
+ * are covered. The default matrices are checked for the documented layout
+ * (no crosstalk between left and right, LFE discarded, rows normalized so
+ * that a full scale input does not clip), and a custom matrix with a gain
+ * over 1.0 saturates. The benchmark prints the cycles per output frame of
+ * every kernel at 24 bits on blocks of the FLAC block size.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "host_test.h"
+#include "decode.h"
+#include "dec_dmx.h"
+
+#define TEST_SAMPLE_NUM     (4096u)
+#define BENCH_CALL_NUM      (2000u)
+#define PCM_MAX_VAL         ((int32_t)0x007FFFFF)
+#define PCM_MIN_VAL         ((int32_t)-0x00800000)
+#define LFE_CH              (3u)            /* LFE of the 6ch to 8ch layouts */
+
+static const uint32_t test_bits[] = { 8u, 12u, 16u, 20u, 24u, 32u };
+
+static std::vector<int32_t> in_data[DEC_MAX_CHANNEL_NUM];
+static const int32_t        *p_in[DEC_MAX_CHANNEL_NUM];
+
+/* Random full range samples of bits_per_sample bits for every channel. */
+static void make_input(const uint32_t bits_per_sample, const uint32_t sample_num)
+{
+    const int64_t   range = (int64_t)1 << (bits_per_sample - 1u);
+
+    for (uint32_t ch = 0u; ch < DEC_MAX_CHANNEL_NUM; ch++) {
+        in_data[ch].resize(sample_num);
+        for (uint32_t i = 0u; i < sample_num; i++) {
+            const int64_t rnd = ((int64_t)rand() << 31) ^ (int64_t)rand();
+
+            in_data[ch][i] = (int32_t)((rnd % (2 * range)) - range);
+        }
+        /* The extremes are always included. */
+        in_data[ch][0] = (int32_t)(range - 1);
+        in_data[ch][1] = (int32_t)-range;
+        p_in[ch] = &in_data[ch][0];
+    }
+}
+
+static int32_t to_24bits(const int32_t data, const uint32_t bits_per_sample)
+{
+    int32_t     ret;
+
+    if (bits_per_sample > 24u) {
+        ret = data >> (bits_per_sample - 24u);
+    } else {
+        ret = data * (1 << (24u - bits_per_sample));
+    }
+    return ret;
+}
+
+/* Model of the output element of channel out_ch at sample i. */
+static int32_t model(const dmx_ctrl_t &ctrl, const uint32_t bits_per_sample,
+                     const uint32_t out_ch, const uint32_t i)
+{
+    int64_t     acc = 0;
+    int32_t     ret;
+
+    if (ctrl.channel_num == 1u) {
+        ret = to_24bits(in_data[0][i], bits_per_sample);
+    } else if (ctrl.channel_num == 2u) {
+        ret = to_24bits(in_data[out_ch][i], bits_per_sample);
+    } else {
+        for (uint32_t ch = 0u; ch < ctrl.channel_num; ch++) {
+            acc += (int64_t)ctrl.matrix.coef[out_ch][ch] * to_24bits(in_data[ch][i], bits_per_sample);
+        }
+        /* Rounded to nearest, ties up. */
+        acc = (acc + (DMX_COEF_UNITY / 2)) >> DMX_COEF_FRAC_BITS;
+        ret = (acc > PCM_MAX_VAL) ? PCM_MAX_VAL : ((acc < PCM_MIN_VAL) ? PCM_MIN_VAL : (int32_t)acc);
+    }
+    return ret * (1 << DEC_OUTPUT_PADDING_BITS);
+}
+
+static void test_cfg(void)
+{
+    dmx_ctrl_t  ctrl;
+
+    HOST_CHECK(!dmx_set_cfg(NULL, 2u, 16u));
+    HOST_CHECK(!dmx_set_cfg(&ctrl, 0u, 16u));
+    HOST_CHECK(!dmx_set_cfg(&ctrl, DEC_MAX_CHANNEL_NUM + 1u, 16u));
+    HOST_CHECK(!dmx_set_cfg(&ctrl, 2u, DEC_MIN_BITS_PER_SAMPLE - 1u));
+    HOST_CHECK(!dmx_set_cfg(&ctrl, 2u, DEC_MAX_BITS_PER_SAMPLE + 1u));
+    HOST_CHECK(!dmx_set_matrix(2u, &ctrl.matrix));
+    HOST_CHECK(!dmx_set_matrix(DEC_MAX_CHANNEL_NUM + 1u, &ctrl.matrix));
+    HOST_CHECK(!dmx_set_matrix(3u, NULL));
+}
+
+/* Every kernel and every shift path against the model. */
+static void test_kernels(void)
+{
+    dmx_ctrl_t              ctrl;
+    std::vector<int32_t>    out(TEST_SAMPLE_NUM * DEC_OUTPUT_CHANNEL_NUM);
+    uint32_t                mismatch;
+
+    for (uint32_t b = 0u; b < (sizeof(test_bits) / sizeof(test_bits[0])); b++) {
+        make_input(test_bits[b], TEST_SAMPLE_NUM);
+        for (uint32_t ch_num = 1u; ch_num <= DEC_MAX_CHANNEL_NUM; ch_num++) {
+            HOST_CHECK(dmx_set_cfg(&ctrl, ch_num, test_bits[b]));
+            HOST_CHECK_EQ(TEST_SAMPLE_NUM * DEC_OUTPUT_CHANNEL_NUM,
+                          dmx_convert(&ctrl, p_in, &out[0], TEST_SAMPLE_NUM));
+            mismatch = 0u;
+            for (uint32_t i = 0u; i < TEST_SAMPLE_NUM; i++) {
+                for (uint32_t out_ch = 0u; out_ch < DEC_OUTPUT_CHANNEL_NUM; out_ch++) {
+                    if (out[(i * DEC_OUTPUT_CHANNEL_NUM) + out_ch] != model(ctrl, test_bits[b], out_ch, i)) {
+                        mismatch++;
+                    }
+                }
+            }
+            if (mismatch != 0u) {
+                (void)printf("%uch %u bits: %u mismatches\n",
+                             (unsigned)ch_num, (unsigned)test_bits[b], (unsigned)mismatch);
+            }
+            HOST_CHECK_EQ(0u, mismatch);
+        }
+    }
+}
+
+/* The layout rules of the default matrices. */
+static void test_matrix(void)
+{
+    dmx_ctrl_t      ctrl;
+    int32_t         sum;
+    int32_t         in_max[DEC_MAX_CHANNEL_NUM];
+    const int32_t   *p_max[DEC_MAX_CHANNEL_NUM];
+    int32_t         out[DEC_OUTPUT_CHANNEL_NUM];
+
+    for (uint32_t ch = 0u; ch < DEC_MAX_CHANNEL_NUM; ch++) {
+        in_max[ch] = PCM_MAX_VAL;
+        p_max[ch] = &in_max[ch];
+    }
+    for (uint32_t ch_num = 3u; ch_num <= DEC_MAX_CHANNEL_NUM; ch_num++) {
+        HOST_CHECK(dmx_set_cfg(&ctrl, ch_num, 24u));
+        for (uint32_t out_ch = 0u; out_ch < DEC_OUTPUT_CHANNEL_NUM; out_ch++) {
+            sum = 0;
+            for (uint32_t ch = 0u; ch < DEC_MAX_CHANNEL_NUM; ch++) {
+                HOST_CHECK(ctrl.matrix.coef[out_ch][ch] >= 0);
+                sum += ctrl.matrix.coef[out_ch][ch];
+            }
+            /* Normalized to 1.0 within the rounding of the coefficients. */
+            HOST_CHECK((sum <= DMX_COEF_UNITY) && (sum >= (DMX_COEF_UNITY - 2)));
+        }
+        /* FL goes only to the left, FR only to the right. */
+        HOST_CHECK_EQ(0, ctrl.matrix.coef[1][0]);
+        HOST_CHECK_EQ(0, ctrl.matrix.coef[0][1]);
+        if (ch_num >= 6u) {
+            HOST_CHECK_EQ(0, ctrl.matrix.coef[0][LFE_CH]);
+            HOST_CHECK_EQ(0, ctrl.matrix.coef[1][LFE_CH]);
+        }
+        /* All channels at full scale reach full scale without clipping. */
+        (void)dmx_convert(&ctrl, p_max, out, 1u);
+        for (uint32_t out_ch = 0u; out_ch < DEC_OUTPUT_CHANNEL_NUM; out_ch++) {
+            HOST_CHECK((out[out_ch] >> DEC_OUTPUT_PADDING_BITS) >= (PCM_MAX_VAL - 512));
+        }
+    }
+}
+
+/* A matrix with a gain over 1.0 saturates instead of wrapping. */
+static void test_saturation(void)
+{
+    dmx_ctrl_t      ctrl;
+    dmx_matrix_t    backup;
+    dmx_matrix_t    loud;
+    int32_t         in_val[DEC_MAX_CHANNEL_NUM];
+    const int32_t   *p_val[DEC_MAX_CHANNEL_NUM];
+    int32_t         out[DEC_OUTPUT_CHANNEL_NUM];
+
+    HOST_CHECK(dmx_set_cfg(&ctrl, 3u, 24u));
+    backup = ctrl.matrix;
+    (void)memset(&loud, 0, sizeof(loud));
+    loud.coef[0][0] = DMX_COEF_UNITY;
+    loud.coef[0][2] = DMX_COEF_UNITY;
+    loud.coef[1][1] = DMX_COEF_UNITY;
+    loud.coef[1][2] = DMX_COEF_UNITY;
+    HOST_CHECK(dmx_set_matrix(3u, &loud));
+    /* Not applied until the next dmx_set_cfg. */
+    HOST_CHECK(memcmp(&backup, &ctrl.matrix, sizeof(backup)) == 0);
+    HOST_CHECK(dmx_set_cfg(&ctrl, 3u, 24u));
+    for (uint32_t ch = 0u; ch < DEC_MAX_CHANNEL_NUM; ch++) {
+        p_val[ch] = &in_val[ch];
+    }
+    in_val[0] = PCM_MAX_VAL;
+    in_val[1] = PCM_MIN_VAL;
+    in_val[2] = PCM_MAX_VAL;
+    (void)dmx_convert(&ctrl, p_val, out, 1u);
+    HOST_CHECK_EQ(PCM_MAX_VAL, out[0] >> DEC_OUTPUT_PADDING_BITS);
+    HOST_CHECK_EQ(-1, out[1] >> DEC_OUTPUT_PADDING_BITS);
+    in_val[2] = PCM_MIN_VAL;
+    (void)dmx_convert(&ctrl, p_val, out, 1u);
+    HOST_CHECK_EQ(-1, out[0] >> DEC_OUTPUT_PADDING_BITS);
+    HOST_CHECK_EQ(PCM_MIN_VAL, out[1] >> DEC_OUTPUT_PADDING_BITS);
+    HOST_CHECK(dmx_set_matrix(3u, &backup));
+}
+
+static void bench(void)
+{
+    dmx_ctrl_t              ctrl;
+    std::vector<int32_t>    out(TEST_SAMPLE_NUM * DEC_OUTPUT_CHANNEL_NUM);
+    uint64_t                ns;
+    uint64_t                cycles;
+    const double            frame_num = (double)TEST_SAMPLE_NUM * BENCH_CALL_NUM;
+
+    make_input(24u, TEST_SAMPLE_NUM);
+    for (uint32_t ch_num = 1u; ch_num <= DEC_MAX_CHANNEL_NUM; ch_num++) {
+        HOST_CHECK(dmx_set_cfg(&ctrl, ch_num, 24u));
+        ns = host_time_ns();
+        cycles = host_cycles();
+        for (uint32_t n = 0u; n < BENCH_CALL_NUM; n++) {
+            (void)dmx_convert(&ctrl, p_in, &out[0], TEST_SAMPLE_NUM);
+            /* Keeps the calls from being merged. */
+            in_data[0][n % TEST_SAMPLE_NUM] ^= out[n % out.size()] & 0x100;
+        }
+        cycles = host_cycles() - cycles;
+        ns = host_time_ns() - ns;
+        (void)printf("dmx_convert %uch: %5.2f cycles / %5.2f ns per output frame, %6.1f Mframes/s\n",
+                     (unsigned)ch_num, (double)cycles / frame_num, (double)ns / frame_num,
+                     (frame_num * 1000.0) / (double)ns);
+    }
+}
+
+int main(void)
+{
+    srand(1u);
+    test_cfg();
+    test_kernels();
+    test_matrix();
+    test_saturation();
+    bench();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,425 @@
+/* Host test and benchmark of dec_eq: the biquad equalizer before SCUX.
+ *
+ *  - Coefficients: the steady state gain of sine waves through each filter
+ *    type matches |H(e^jw)| of the Audio EQ Cookbook evaluated in double.
+ *  - Step response: the low pass settles to the DC gain of 1.0, the high
+ *    pass to 0.
+ *  - Crossfade: eq_set_param() during the playback changes the gain of a
+ *    sine wave over EQ_FADE_FRAME_NUM frames without a step, and a second
+ *    call during the fade is faded in after it, again without a step.
+ *  - Copy: the parameter is copied by eq_set_param(), so a change of the
+ *    caller's parameter after the call does not change the equalizer.
+ *  - Bypass: no band and a NULL parameter leave the data unchanged.
+ * The benchmark prints the cycles per frame of eq_process() for 0 to 10
+ * stages on blocks of the decode buffer size.
+ */
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "host_test.h"
+#include "decode.h"
+#include "dec_eq.h"
+
+#define TEST_RATE           (48000u)
+#define TEST_CHUNK          (4096u)         /* Elements per call, as a decode buffer */
+#define TEST_AMP            (0.125)         /* -18 dBFS leaves room for +15 dB */
+#define PCM_SCALE           (8388608.0)     /* 24 bits full scale */
+#define FADE_FRAME_NUM      (1024u)         /* EQ_FADE_FRAME_NUM of dec_eq.cpp */
+#define SETTLE_FRAME_NUM    (9600u)
+#define FIT_FRAME_NUM       (9600u)         /* Whole cycles of all test frequencies */
+#define BENCH_SEC           (10u)
+
+static eq_ctrl_t    eq_ctrl;
+
+static int32_t to_pcm(const double val)
+{
+    return (int32_t)((uint32_t)(int32_t)lrint(val * PCM_SCALE) << DEC_OUTPUT_PADDING_BITS);
+}
+
+static double from_pcm(const int32_t val)
+{
+    return (double)(val >> DEC_OUTPUT_PADDING_BITS) / PCM_SCALE;
+}
+
+static std::vector<int32_t> make_sine(const double freq, const double amp, const uint32_t frame_num)
+{
+    std::vector<int32_t>    buf(frame_num * EQ_CHANNEL_NUM);
+
+    for (uint32_t i = 0u; i < frame_num; i++) {
+        buf[(i * EQ_CHANNEL_NUM) + 0u] = to_pcm(amp * sin((2.0 * M_PI * freq * i) / TEST_RATE));
+        buf[(i * EQ_CHANNEL_NUM) + 1u] = to_pcm(amp * cos((2.0 * M_PI * freq * i) / TEST_RATE));
+    }
+    return buf;
+}
+
+static void process(std::vector<int32_t> * const p_buf)
+{
+    uint32_t    num;
+
+    for (size_t i = 0u; i < p_buf->size(); i += TEST_CHUNK) {
+        num = (uint32_t)(((p_buf->size() - i) < TEST_CHUNK) ? (p_buf->size() - i) : TEST_CHUNK);
+        eq_process(&eq_ctrl, &(*p_buf)[i], num);
+    }
+}
+
+/* Gain in dB of channel ch over the last FIT_FRAME_NUM frames. */
+static double measure_gain(const std::vector<int32_t> &buf, const uint32_t ch,
+                           const double freq, const double amp)
+{
+    const uint32_t  top = (uint32_t)(buf.size() / EQ_CHANNEL_NUM) - FIT_FRAME_NUM;
+    double          s = 0.0;
+    double          c = 0.0;
+    double          w;
+
+    for (uint32_t i = top; i < (top + FIT_FRAME_NUM); i++) {
+        w = (2.0 * M_PI * freq * i) / TEST_RATE;
+        s += from_pcm(buf[(i * EQ_CHANNEL_NUM) + ch]) * sin(w);
+        c += from_pcm(buf[(i * EQ_CHANNEL_NUM) + ch]) * cos(w);
+    }
+    return 20.0 * log10((2.0 * sqrt((s * s) + (c * c))) / (FIT_FRAME_NUM * amp));
+}
+
+/* |H(e^jw)| in dB of the cookbook biquad, calculated in double. */
+static double model_gain(const eq_band_t &band, const double freq)
+{
+    const double    amp = pow(10.0, (band.gain / 10.0) / 40.0);
+    const double    w0 = (2.0 * M_PI * band.freq) / TEST_RATE;
+    const double    alpha = sin(w0) / (2.0 * (band.q / 100.0));
+    const double    cw = cos(w0);
+    const double    sa = 2.0 * sqrt(amp) * alpha;
+    double          b[3];
+    double          a[3];
+    double          w = (2.0 * M_PI * freq) / TEST_RATE;
+    double          nr;
+    double          ni;
+    double          dr;
+    double          di;
+
+    switch (band.type) {
+        case EQ_TYPE_LOW_SHELF:
+            b[0] = amp * (((amp + 1.0) - ((amp - 1.0) * cw)) + sa);
+            b[1] = 2.0 * amp * ((amp - 1.0) - ((amp + 1.0) * cw));
+            b[2] = amp * (((amp + 1.0) - ((amp - 1.0) * cw)) - sa);
+            a[0] = ((amp + 1.0) + ((amp - 1.0) * cw)) + sa;
+            a[1] = -2.0 * ((amp - 1.0) + ((amp + 1.0) * cw));
+            a[2] = ((amp + 1.0) + ((amp - 1.0) * cw)) - sa;
+            break;
+        case EQ_TYPE_HIGH_SHELF:
+            b[0] = amp * (((amp + 1.0) + ((amp - 1.0) * cw)) + sa);
+            b[1] = -2.0 * amp * ((amp - 1.0) + ((amp + 1.0) * cw));
+            b[2] = amp * (((amp + 1.0) + ((amp - 1.0) * cw)) - sa);
+            a[0] = ((amp + 1.0) - ((amp - 1.0) * cw)) + sa;
+            a[1] = 2.0 * ((amp - 1.0) - ((amp + 1.0) * cw));
+            a[2] = ((amp + 1.0) - ((amp - 1.0) * cw)) - sa;
+            break;
+        case EQ_TYPE_LOW_PASS:
+            b[0] = (1.0 - cw) / 2.0;
+            b[1] = 1.0 - cw;
+            b[2] = (1.0 - cw) / 2.0;
+            a[0] = 1.0 + alpha;
+            a[1] = -2.0 * cw;
+            a[2] = 1.0 - alpha;
+            break;
+        case EQ_TYPE_HIGH_PASS:
+            b[0] = (1.0 + cw) / 2.0;
+            b[1] = -(1.0 + cw);
+            b[2] = (1.0 + cw) / 2.0;
+            a[0] = 1.0 + alpha;
+            a[1] = -2.0 * cw;
+            a[2] = 1.0 - alpha;
+            break;
+        case EQ_TYPE_PEAK:
+        default:
+            b[0] = 1.0 + (alpha * amp);
+            b[1] = -2.0 * cw;
+            b[2] = 1.0 - (alpha * amp);
+            a[0] = 1.0 + (alpha / amp);
+            a[1] = -2.0 * cw;
+            a[2] = 1.0 - (alpha / amp);
+            break;
+    }
+    nr = b[0] + (b[1] * cos(w)) + (b[2] * cos(2.0 * w));
+    ni = -(b[1] * sin(w)) - (b[2] * sin(2.0 * w));
+    dr = a[0] + (a[1] * cos(w)) + (a[2] * cos(2.0 * w));
+    di = -(a[1] * sin(w)) - (a[2] * sin(2.0 * w));
+    return 10.0 * log10(((nr * nr) + (ni * ni)) / ((dr * dr) + (di * di)));
+}
+
+static bool setup(const eq_param_t * const p_param)
+{
+    eq_init(&eq_ctrl);
+    (void)eq_set_param(&eq_ctrl, p_param);
+    return eq_set_rate(&eq_ctrl, TEST_RATE);
+}
+
+static void test_cfg(void)
+{
+    static eq_param_t   param;
+    std::vector<int32_t> in = make_sine(1000.0, TEST_AMP, 4800u);
+    std::vector<int32_t> out;
+
+    /* Before the rate is known, the parameter is only kept, as a copy. */
+    eq_init(&eq_ctrl);
+    param.band_num = 1u;
+    param.band[0].type = EQ_TYPE_PEAK;
+    param.band[0].freq = 1000u;
+    param.band[0].gain = 60;
+    param.band[0].q = 100u;
+    HOST_CHECK(eq_set_param(&eq_ctrl, &param));
+    HOST_CHECK_EQ(1u, eq_ctrl.param.band_num);
+    HOST_CHECK_EQ(0u, eq_ctrl.cur.stage_num);
+    param.band_num = EQ_MAX_STAGE_NUM + 1u;
+    param.band[0].freq = TEST_RATE;
+    HOST_CHECK(eq_set_rate(&eq_ctrl, TEST_RATE));
+    HOST_CHECK_EQ(1u, eq_ctrl.cur.stage_num);
+    HOST_CHECK_EQ(0u, eq_ctrl.fade_cnt);
+    param.band_num = 1u;
+
+    /* A band at or above the Nyquist rate bypasses the equalizer. */
+    param.band[0].freq = TEST_RATE / 2u;
+    eq_init(&eq_ctrl);
+    HOST_CHECK(eq_set_param(&eq_ctrl, &param));
+    HOST_CHECK(!eq_set_rate(&eq_ctrl, TEST_RATE));
+    HOST_CHECK_EQ(0u, eq_ctrl.cur.stage_num);
+    HOST_CHECK(!eq_set_param(&eq_ctrl, &param));
+    param.band[0].freq = 1000u;
+    param.band[0].gain = EQ_MAX_GAIN + 1;
+    HOST_CHECK(!eq_set_param(&eq_ctrl, &param));
+    param.band[0].gain = 60;
+    param.band[0].q = EQ_MIN_Q - 1u;
+    HOST_CHECK(!eq_set_param(&eq_ctrl, &param));
+    param.band[0].q = 100u;
+    param.band_num = EQ_MAX_STAGE_NUM + 1u;
+    HOST_CHECK(!eq_set_param(&eq_ctrl, &param));
+
+    /* Bypass : no band, and NULL. */
+    param.band_num = 0u;
+    HOST_CHECK(setup(&param));
+    out = in;
+    process(&out);
+    HOST_CHECK(out == in);
+    HOST_CHECK(setup(NULL));
+    out = in;
+    process(&out);
+    HOST_CHECK(out == in);
+}
+
+/* Gain of each filter type against the double model. */
+static void test_response(void)
+{
+    static const eq_band_t  bands[] = {
+        { EQ_TYPE_PEAK,        1000u,   60, 100u },
+        { EQ_TYPE_PEAK,        3000u, -120, 400u },
+        { EQ_TYPE_LOW_SHELF,    100u,  150,  71u },
+        { EQ_TYPE_HIGH_SHELF,  8000u,  -60,  71u },
+        { EQ_TYPE_LOW_PASS,    2000u,    0,  71u },
+        { EQ_TYPE_HIGH_PASS,    200u,    0,  71u },
+        { EQ_TYPE_PEAK,          40u,  150, 200u },
+    };
+    static const double     freqs[] = { 20.0, 100.0, 200.0, 1000.0, 2000.0, 3000.0, 8000.0, 15000.0 };
+    static eq_param_t       param;
+    std::vector<int32_t>    buf;
+    double                  gain;
+    double                  expect;
+    double                  err;
+    double                  worst = 0.0;
+
+    for (size_t b = 0u; b < (sizeof(bands) / sizeof(bands[0])); b++) {
+        param.band_num = 1u;
+        param.band[0] = bands[b];
+        HOST_CHECK(setup(&param));
+        for (size_t f = 0u; f < (sizeof(freqs) / sizeof(freqs[0])); f++) {
+            buf = make_sine(freqs[f], TEST_AMP, SETTLE_FRAME_NUM + FIT_FRAME_NUM);
+            process(&buf);
+            expect = model_gain(bands[b], freqs[f]);
+            for (uint32_t ch = 0u; ch < EQ_CHANNEL_NUM; ch++) {
+                gain = measure_gain(buf, ch, freqs[f], TEST_AMP);
+                /* Down to -60 dB, where the 24 bits output still resolves it. */
+                if (expect > -60.0) {
+                    err = fabs(gain - expect);
+                    worst = (err > worst) ? err : worst;
+                    if (err >= 0.05) {
+                        (void)printf("type %d %u Hz: %.0f Hz %.3f dB, expected %.3f dB\n",
+                                     (int)bands[b].type, (unsigned)bands[b].freq,
+                                     freqs[f], gain, expect);
+                    }
+                    HOST_CHECK(err < 0.05);
+                } else {
+                    HOST_CHECK(gain < -50.0);
+                }
+            }
+        }
+    }
+    (void)printf("gain error against the double model: %.4f dB max\n", worst);
+}
+
+/* Step of 0.5 into the low pass and the high pass. */
+static void test_step(void)
+{
+    static eq_param_t       param;
+    std::vector<int32_t>    buf(SETTLE_FRAME_NUM * EQ_CHANNEL_NUM, to_pcm(0.5));
+    std::vector<int32_t>    hp;
+    double                  peak = 0.0;
+
+    param.band_num = 1u;
+    param.band[0].type = EQ_TYPE_LOW_PASS;
+    param.band[0].freq = 1000u;
+    param.band[0].gain = 0;
+    param.band[0].q = 71u;
+    HOST_CHECK(setup(&param));
+    hp = buf;
+    process(&buf);
+    for (size_t i = 0u; i < buf.size(); i++) {
+        peak = (from_pcm(buf[i]) > peak) ? from_pcm(buf[i]) : peak;
+    }
+    /* Butterworth (Q 0.71) overshoots by about 4 %. */
+    HOST_CHECK(peak < (0.5 * 1.05));
+    HOST_CHECK(fabs(from_pcm(buf[buf.size() - 1u]) - 0.5) < 1.0e-5);
+
+    param.band[0].type = EQ_TYPE_HIGH_PASS;
+    HOST_CHECK(setup(&param));
+    process(&hp);
+    /* The step passes the high pass at once, then decays. */
+    HOST_CHECK(from_pcm(hp[0]) > 0.45);
+    HOST_CHECK(fabs(from_pcm(hp[hp.size() - 1u])) < 1.0e-5);
+    (void)printf("step 0.5: low pass peak %.5f, settles to %.7f; high pass settles to %.7f\n",
+                 peak, from_pcm(buf[buf.size() - 1u]), from_pcm(hp[hp.size() - 1u]));
+}
+
+/* Largest second difference of channel 0 in frames [top, end). */
+/* A step in the output shows as a spike far above the one of the sine. */
+static double max_accel(const std::vector<int32_t> &buf, const uint32_t top, const uint32_t end)
+{
+    double  ret = 0.0;
+    double  acc;
+
+    for (uint32_t i = top + 2u; i < end; i++) {
+        acc = fabs((from_pcm(buf[i * EQ_CHANNEL_NUM]) - (2.0 * from_pcm(buf[(i - 1u) * EQ_CHANNEL_NUM])))
+                   + from_pcm(buf[(i - 2u) * EQ_CHANNEL_NUM]));
+        ret = (acc > ret) ? acc : ret;
+    }
+    return ret;
+}
+
+/* Peak of channel 0 in frames [top, end). */
+static double peak(const std::vector<int32_t> &buf, const uint32_t top, const uint32_t end)
+{
+    double  ret = 0.0;
+
+    for (uint32_t i = top; i < end; i++) {
+        ret = (fabs(from_pcm(buf[i * EQ_CHANNEL_NUM])) > ret) ? fabs(from_pcm(buf[i * EQ_CHANNEL_NUM])) : ret;
+    }
+    return ret;
+}
+
+/* +12 dB at 1 kHz switched on, and changed to -12 dB during the fade. */
+/* The -12 dB parameter is on the stack and changed after the call. */
+static void test_fade(void)
+{
+    static eq_param_t       boost;
+    eq_param_t              cut;
+    const double            freq = 1000.0;
+    const uint32_t          period = TEST_RATE / 1000u;
+    const uint32_t          switch_at = 4800u;
+    const uint32_t          second_at = switch_at + (FADE_FRAME_NUM / 2u);
+    std::vector<int32_t>    buf = make_sine(freq, TEST_AMP, switch_at + (FADE_FRAME_NUM * 8u));
+    std::vector<int32_t>    one = buf;
+    const double            sine_accel = TEST_AMP * pow((2.0 * M_PI * freq) / TEST_RATE, 2.0);
+    double                  accel;
+    double                  before;
+    double                  mid;
+    double                  after;
+
+    boost.band_num = 1u;
+    boost.band[0].type = EQ_TYPE_PEAK;
+    boost.band[0].freq = 1000u;
+    boost.band[0].gain = 120;
+    boost.band[0].q = 100u;
+    cut = boost;
+    cut.band[0].gain = -120;
+
+    /* Flat, then +12 dB : the level moves from 1x to 4x over the fade. */
+    HOST_CHECK(setup(NULL));
+    eq_process(&eq_ctrl, &one[0], switch_at * EQ_CHANNEL_NUM);
+    HOST_CHECK(eq_set_param(&eq_ctrl, &boost));
+    HOST_CHECK_EQ(FADE_FRAME_NUM, eq_ctrl.fade_cnt);
+    eq_process(&eq_ctrl, &one[switch_at * EQ_CHANNEL_NUM], (FADE_FRAME_NUM - 1u) * EQ_CHANNEL_NUM);
+    HOST_CHECK_EQ(1u, eq_ctrl.fade_cnt);
+    eq_process(&eq_ctrl, &one[(switch_at + FADE_FRAME_NUM - 1u) * EQ_CHANNEL_NUM],
+               (uint32_t)(one.size() - ((switch_at + FADE_FRAME_NUM - 1u) * EQ_CHANNEL_NUM)));
+    HOST_CHECK_EQ(0u, eq_ctrl.fade_cnt);
+    HOST_CHECK_EQ(1u, eq_ctrl.cur.stage_num);
+    before = peak(one, switch_at - period, switch_at);
+    mid = peak(one, (switch_at + (FADE_FRAME_NUM / 2u)) - (period / 2u),
+               switch_at + (FADE_FRAME_NUM / 2u) + (period / 2u));
+    after = peak(one, (uint32_t)(one.size() / EQ_CHANNEL_NUM) - period, (uint32_t)(one.size() / EQ_CHANNEL_NUM));
+    accel = max_accel(one, switch_at - period, (uint32_t)(one.size() / EQ_CHANNEL_NUM));
+    (void)printf("fade +12 dB: peak %.4f -> %.4f -> %.4f, max 2nd difference %.2f x of the 4x sine\n",
+                 before, mid, after, accel / (4.0 * sine_accel));
+    HOST_CHECK(fabs(before - TEST_AMP) < 0.001);
+    HOST_CHECK((mid > (before * 1.5)) && (mid < (after * 0.9)));
+    HOST_CHECK(fabs(after - (TEST_AMP * 4.0)) < 0.01);
+    /* No click : the sample to sample change stays at the one of the louder sine. */
+    HOST_CHECK(accel < (4.0 * sine_accel * 1.1));
+
+    /* A second change during the fade waits for its end. */
+    HOST_CHECK(setup(NULL));
+    eq_process(&eq_ctrl, &buf[0], switch_at * EQ_CHANNEL_NUM);
+    HOST_CHECK(eq_set_param(&eq_ctrl, &boost));
+    eq_process(&eq_ctrl, &buf[switch_at * EQ_CHANNEL_NUM], (second_at - switch_at) * EQ_CHANNEL_NUM);
+    HOST_CHECK(eq_set_param(&eq_ctrl, &cut));
+    (void)memset(&cut, 0xFF, sizeof(cut));
+    HOST_CHECK_EQ(FADE_FRAME_NUM - (second_at - switch_at), eq_ctrl.fade_cnt);
+    HOST_CHECK_EQ(-120, eq_ctrl.param.band[0].gain);
+    HOST_CHECK(eq_ctrl.is_pending);
+    eq_process(&eq_ctrl, &buf[second_at * EQ_CHANNEL_NUM],
+               (uint32_t)(buf.size() - (second_at * EQ_CHANNEL_NUM)));
+    after = peak(buf, (uint32_t)(buf.size() / EQ_CHANNEL_NUM) - period, (uint32_t)(buf.size() / EQ_CHANNEL_NUM));
+    accel = max_accel(buf, switch_at - period, (uint32_t)(buf.size() / EQ_CHANNEL_NUM));
+    (void)printf("-12 dB during the fade: peak %.4f, max 2nd difference %.2f x of the 4x sine\n",
+                 after, accel / (4.0 * sine_accel));
+    HOST_CHECK(!eq_ctrl.is_pending);
+    HOST_CHECK(fabs(after - (TEST_AMP / 4.0)) < 0.01);
+    HOST_CHECK(accel < (4.0 * sine_accel * 1.1));
+}
+
+static void bench(void)
+{
+    static const uint32_t   stages[] = { 0u, 1u, 2u, 5u, 10u };
+    static eq_param_t       param;
+    std::vector<int32_t>    buf = make_sine(1000.0, TEST_AMP, TEST_CHUNK / EQ_CHANNEL_NUM);
+    const uint32_t          call_num = (TEST_RATE * BENCH_SEC * EQ_CHANNEL_NUM) / TEST_CHUNK;
+    const double            frame_num = ((double)call_num * TEST_CHUNK) / EQ_CHANNEL_NUM;
+    uint64_t                ns;
+    uint64_t                cycles;
+
+    for (uint32_t i = 0u; i < EQ_MAX_STAGE_NUM; i++) {
+        param.band[i].type = EQ_TYPE_PEAK;
+        param.band[i].freq = 100u * (i + 1u);
+        param.band[i].gain = -30;
+        param.band[i].q = 100u;
+    }
+    for (size_t n = 0u; n < (sizeof(stages) / sizeof(stages[0])); n++) {
+        param.band_num = stages[n];
+        HOST_CHECK(setup(&param));
+        ns = host_time_ns();
+        cycles = host_cycles();
+        for (uint32_t i = 0u; i < call_num; i++) {
+            eq_process(&eq_ctrl, &buf[0], TEST_CHUNK);
+        }
+        cycles = host_cycles() - cycles;
+        ns = host_time_ns() - ns;
+        (void)printf("eq_process %2u stages: %6.1f cycles / %5.1f ns per stereo frame\n",
+                     (unsigned)stages[n], (double)cycles / frame_num, (double)ns / frame_num);
+    }
+}
+
+int main(void)
+{
+    test_cfg();
+    test_response();
+    test_step();
+    test_fade();
+    bench();
+    return HOST_TEST_RESULT();
+}
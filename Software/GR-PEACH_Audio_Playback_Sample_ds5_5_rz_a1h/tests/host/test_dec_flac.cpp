@@ -0,0 +1,187 @@
+/* Host test of dec_flac: metadata skipping during flac_open.
+ *
+ * Synthetic FLAC files carry large PICTURE and PADDING blocks and
+ * VORBIS_COMMENT blocks around FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH
+ * (4096 bytes). The memory FILE counts the bytes read from the "media", so
+ * the test sees whether skip_metadata_block_() seeks past a block or reads
+ * it through the bitreader, and the decoded samples show that the
+ * bitreader was cleared correctly after the seek.
+ */
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "dec_flac.h"
+
+#define TEST_RATE           (44100u)
+#define TEST_CH             (2u)
+#define TEST_BPS            (16u)
+#define TEST_BLOCK          (1152u)
+#define TEST_FRAME_NUM      (20u)
+#define TEST_SAMPLE_NUM     (TEST_BLOCK * TEST_FRAME_NUM)
+#define PCM_BUF_NUM         (DEC_MAX_BLOCK_SIZE * DEC_OUTPUT_CHANNEL_NUM)
+#define BITREADER_BYTES     (8192u)     /* FLAC__BITREADER_DEFAULT_CAPACITY */
+
+typedef struct {
+    uint32_t    picture_size;       /* 0 : no PICTURE block */
+    uint32_t    padding_size;       /* 0 : no PADDING block */
+    uint32_t    comment_size;       /* 0 : no VORBIS_COMMENT block */
+    bool        comment_first;      /* VORBIS_COMMENT right after STREAMINFO */
+} layout_t;
+
+static std::vector<int32_t> make_pcm(void)
+{
+    std::vector<int32_t>    pcm(TEST_SAMPLE_NUM * TEST_CH);
+
+    srand(1);
+    for (size_t i = 0u; i < pcm.size(); i++) {
+        pcm[i] = (int32_t)(rand() % 65536) - 32768;
+    }
+    return pcm;
+}
+
+/* VORBIS_COMMENT of exactly body_size bytes with a ReplayGain of -6.50 dB. */
+static std::vector<uint8_t> make_comment(uint32_t body_size)
+{
+    std::vector<std::string>    entries;
+    std::vector<uint8_t>        body;
+
+    entries.push_back("REPLAYGAIN_TRACK_GAIN=-6.50 dB");
+    entries.push_back("TITLE=x");
+    body = FlacWriter::vorbis_comment(entries);
+    entries[1].append(body_size - body.size(), 'x');
+    body = FlacWriter::vorbis_comment(entries);
+    return body;
+}
+
+static std::vector<uint8_t> make_file(const layout_t &layout, const std::vector<int32_t> &pcm,
+                                      size_t *p_meta_size)
+{
+    FlacWriter      fw;
+    const bool      has_pic = (layout.picture_size != 0u);
+    const bool      has_pad = (layout.padding_size != 0u);
+    const bool      has_cmt = (layout.comment_size != 0u);
+
+    fw.streaminfo(TEST_RATE, TEST_CH, TEST_BPS, TEST_SAMPLE_NUM, TEST_BLOCK,
+                  !has_pic && !has_pad && !has_cmt);
+    if (has_cmt && layout.comment_first) {
+        fw.block(FlacWriter::TYPE_VORBIS_COMMENT, make_comment(layout.comment_size),
+                 !has_pic && !has_pad);
+    }
+    if (has_pic) {
+        fw.block(FlacWriter::TYPE_PICTURE, std::vector<uint8_t>(layout.picture_size, 0xA5u),
+                 !has_pad && !(has_cmt && !layout.comment_first));
+    }
+    if (has_cmt && !layout.comment_first) {
+        fw.block(FlacWriter::TYPE_VORBIS_COMMENT, make_comment(layout.comment_size), !has_pad);
+    }
+    if (has_pad) {
+        fw.block(FlacWriter::TYPE_PADDING, std::vector<uint8_t>(layout.padding_size, 0u), true);
+    }
+    *p_meta_size = fw.data().size();
+    for (uint32_t i = 0u; i < TEST_FRAME_NUM; i++) {
+        fw.frame(i, &pcm[i * TEST_BLOCK * TEST_CH], TEST_BLOCK, TEST_CH, TEST_BPS);
+    }
+    return fw.data();
+}
+
+/* Opens the file, checks the seeks and bytes of the open and decodes it to the end. */
+static void run_case(const char *p_name, flac_ctrl_t *p_ctrl, const layout_t &layout,
+                     int32_t expect_gain, uint32_t expect_seeks)
+{
+    static int32_t              pcm_buf[PCM_BUF_NUM];
+    const std::vector<int32_t>  pcm = make_pcm();
+    size_t                      meta_size;
+    const std::vector<uint8_t>  image = make_file(layout, pcm, &meta_size);
+    mem_file_t                  mf;
+    FILE                        *fp;
+    uint64_t                    open_bytes;
+    uint32_t                    open_seeks;
+    uint32_t                    pos = 0u;
+    uint32_t                    mismatch = 0u;
+    uint32_t                    cnt;
+
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(fp != NULL);
+    HOST_CHECK(flac_open(fp, p_ctrl));
+    open_bytes = mf.read_bytes;
+    open_seeks = mf.seek_cnt;
+    HOST_CHECK_EQ(TEST_RATE, p_ctrl->sample_rate);
+    HOST_CHECK_EQ(TEST_CH, p_ctrl->channel_num);
+    HOST_CHECK_EQ(TEST_SAMPLE_NUM, p_ctrl->total_sample);
+    HOST_CHECK_EQ(expect_gain, flac_get_replay_gain(p_ctrl));
+    /* The bitreader is refilled at most twice per seek; the bodies of the */
+    /* skipped blocks are never read. */
+    HOST_CHECK_EQ(expect_seeks, open_seeks);
+    HOST_CHECK(open_bytes <= ((open_seeks + 1u) * 2u * BITREADER_BYTES));
+
+    /* The first frame must be decoded from the right place after the seek. */
+    while (pos < (TEST_SAMPLE_NUM * TEST_CH)) {
+        HOST_CHECK(flac_set_pcm_buf(p_ctrl, pcm_buf, PCM_BUF_NUM));
+        if (!flac_decode(p_ctrl)) {
+            break;
+        }
+        cnt = flac_get_pcm_cnt(p_ctrl);
+        for (uint32_t i = 0u; (i < cnt) && (pos < pcm.size()); i++, pos++) {
+            /* 16bit input is output as 24bit data padded by 8bits. */
+            if (pcm_buf[i] != (pcm[pos] << 16)) {
+                mismatch++;
+            }
+        }
+    }
+    HOST_CHECK_EQ(TEST_SAMPLE_NUM * TEST_CH, pos);
+    HOST_CHECK_EQ(0, mismatch);
+    flac_close(p_ctrl);
+    (void)fclose(fp);
+    (void)printf("%-34s meta %8u B, open read %6u B / %u seeks, gain %d\n", p_name,
+                 (unsigned)meta_size, (unsigned)open_bytes, (unsigned)open_seeks,
+                 (int)expect_gain);
+}
+
+int main(void)
+{
+    flac_ctrl_t     ctrl;
+    layout_t        layout;
+
+    HOST_CHECK(flac_init(&ctrl));
+
+    /* Cover art and padding far larger than the bitreader are seeked over. */
+    layout.picture_size = 1024u * 1024u;
+    layout.padding_size = 256u * 1024u;
+    layout.comment_size = 200u;
+    layout.comment_first = false;
+    run_case("picture 1MB + padding 256kB", &ctrl, layout, -650, 2u);
+
+    /* A comment at the cap is still parsed for ReplayGain. */
+    layout.picture_size = 0u;
+    layout.padding_size = 0u;
+    layout.comment_size = 4096u;
+    layout.comment_first = true;
+    run_case("comment 4096B", &ctrl, layout, -650, 0u);
+
+    /* Just over the cap: skipped inside the bitreader, no gain. */
+    layout.comment_size = 4097u;
+    run_case("comment 4097B", &ctrl, layout, 0, 0u);
+
+    /* A huge comment is skipped by seeking even though it was requested. */
+    layout.comment_size = 512u * 1024u;
+    layout.padding_size = 100u;
+    run_case("comment 512kB + padding", &ctrl, layout, 0, 1u);
+
+    /* The same huge comment behind a large picture. */
+    layout.picture_size = 300u * 1024u;
+    layout.comment_first = false;
+    run_case("picture 300kB + comment 512kB", &ctrl, layout, 0, 2u);
+
+    /* Padding smaller than the bitreader contents is skipped without a seek. */
+    layout.picture_size = 0u;
+    layout.padding_size = 1000u;
+    layout.comment_size = 100u;
+    layout.comment_first = true;
+    run_case("small comment + small padding", &ctrl, layout, -650, 0u);
+
+    return HOST_TEST_RESULT();
+}
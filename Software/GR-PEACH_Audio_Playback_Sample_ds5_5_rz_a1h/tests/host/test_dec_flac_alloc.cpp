@@ -0,0 +1,255 @@
+/* Host test of dec_flac: no heap allocation on a track change.
+ *
+ * malloc, calloc, realloc and free of the program are counted around each
+ * track: flac_open, a seek, the decode to the end and flac_close, on the
+ * decoder of flac_init as the decode thread recycles it. The tracks cover
+ * mono to DEC_MAX_CHANNEL_NUM channels, 16 and 24 bits, block sizes up to
+ * DEC_MAX_BLOCK_SIZE, MD5 signatures, a VORBIS_COMMENT at the cap and a
+ * SEEKTABLE over FLAC__STREAM_DECODER_MAX_SEEK_POINTS points. Only the
+ * first open may allocate (the bitreader buffer); every later track must
+ * not allocate or free at all, whichever track it follows. The stereo
+ * tracks are also checked bit-exactly after the seek.
+ */
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "dec_flac.h"
+extern "C" {
+#include "private/md5.h"
+}
+
+#define TEST_RATE           (48000u)
+#define TEST_SEEK_POINTS    (2000u)     /* Over FLAC__STREAM_DECODER_MAX_SEEK_POINTS */
+#define TEST_COMMENT_SIZE   (4096u)     /* FLAC__STREAM_DECODER_MAX_VORBIS_COMMENT_LENGTH */
+#define TEST_STDIO_BUF      (4096u)
+#define TEST_ROUND_NUM      (2u)
+#define PCM_BUF_NUM         (DEC_MAX_BLOCK_SIZE * DEC_OUTPUT_CHANNEL_NUM)
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+static bool     is_counting;
+static uint32_t alloc_cnt;
+static uint32_t free_cnt;
+
+extern "C" void *malloc(size_t size)
+{
+    if (is_counting) {
+        alloc_cnt++;
+    }
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t num, size_t size)
+{
+    if (is_counting) {
+        alloc_cnt++;
+    }
+    return __libc_calloc(num, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    if (is_counting) {
+        alloc_cnt++;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void *ptr)
+{
+    if (is_counting && (ptr != NULL)) {
+        free_cnt++;
+    }
+    __libc_free(ptr);
+}
+
+typedef struct {
+    const char  *p_name;
+    uint32_t    ch;
+    uint32_t    bps;
+    uint32_t    block;
+    uint32_t    frame_num;
+    bool        has_md5;
+    bool        has_comment;
+    bool        has_seektable;      /* One point per frame */
+} track_spec_t;
+
+typedef struct {
+    track_spec_t            spec;
+    std::vector<int32_t>    pcm;
+    std::vector<uint8_t>    image;
+} track_t;
+
+static void calc_md5(const track_spec_t &spec, const std::vector<int32_t> &pcm, uint8_t digest[16])
+{
+    FLAC__MD5Context            ctx;
+    std::vector<FLAC__int32>    ch_buf(spec.ch * spec.block);
+    const FLAC__int32           *signal[FLAC__MAX_CHANNELS];
+
+    FLAC__MD5Init(&ctx);
+    for (uint32_t f = 0u; f < spec.frame_num; f++) {
+        for (uint32_t c = 0u; c < spec.ch; c++) {
+            for (uint32_t i = 0u; i < spec.block; i++) {
+                ch_buf[(c * spec.block) + i] = pcm[(((f * spec.block) + i) * spec.ch) + c];
+            }
+            signal[c] = &ch_buf[c * spec.block];
+        }
+        HOST_CHECK(FLAC__MD5Accumulate(&ctx, signal, spec.ch, spec.block, (spec.bps + 7u) / 8u));
+    }
+    FLAC__MD5Final(digest, &ctx);
+}
+
+/* Writes the track twice: the first pass gives the frame offsets of the */
+/* seek table, which does not change them. */
+static void make_track(track_t * const p_track)
+{
+    const track_spec_t          &spec = p_track->spec;
+    const uint32_t              sample_num = spec.block * spec.frame_num;
+    std::vector<uint64_t>       seek_sample;
+    std::vector<uint64_t>       seek_offset;
+    std::vector<std::string>    entries;
+    std::vector<uint8_t>        comment;
+    uint8_t                     digest[16];
+
+    p_track->pcm.resize(sample_num * spec.ch);
+    for (size_t i = 0u; i < p_track->pcm.size(); i++) {
+        p_track->pcm[i] = (int32_t)(rand() % (1 << spec.bps)) - (1 << (spec.bps - 1u));
+    }
+    entries.push_back("REPLAYGAIN_TRACK_GAIN=-3.00 dB");
+    entries.push_back("TITLE=x");
+    comment = FlacWriter::vorbis_comment(entries);
+    entries[1].append(TEST_COMMENT_SIZE - comment.size(), 'x');
+    comment = FlacWriter::vorbis_comment(entries);
+    for (uint32_t f = 0u; f < spec.frame_num; f++) {
+        seek_sample.push_back((uint64_t)f * spec.block);
+        seek_offset.push_back(0u);
+    }
+    for (uint32_t pass = 0u; pass < 2u; pass++) {
+        FlacWriter  fw;
+        size_t      first_frame;
+
+        fw.streaminfo(TEST_RATE, spec.ch, spec.bps, sample_num, spec.block, false);
+        if (spec.has_seektable) {
+            fw.block(FlacWriter::TYPE_SEEKTABLE,
+                     FlacWriter::seektable(seek_sample, seek_offset, spec.block), false);
+        }
+        fw.block(FlacWriter::TYPE_VORBIS_COMMENT, spec.has_comment ? comment : FlacWriter::vorbis_comment(std::vector<std::string>()), true);
+        first_frame = fw.data().size();
+        for (uint32_t f = 0u; f < spec.frame_num; f++) {
+            seek_offset[f] = fw.data().size() - first_frame;
+            fw.frame(f, &p_track->pcm[f * spec.block * spec.ch], spec.block, spec.ch, spec.bps);
+        }
+        if (spec.has_md5) {
+            calc_md5(spec, p_track->pcm, digest);
+            fw.md5(digest);
+        }
+        p_track->image = fw.data();
+    }
+}
+
+/* Plays the track from the open to the close as the decode thread does, */
+/* with a seek to 3/4 of it after the first buffer. Returns the heap calls. */
+static uint32_t play_track(flac_ctrl_t * const p_ctrl, const track_t &track)
+{
+    static int32_t      pcm_buf[PCM_BUF_NUM];
+    static char         stdio_buf[TEST_STDIO_BUF];
+    const track_spec_t  &spec = track.spec;
+    const uint32_t      sample_num = spec.block * spec.frame_num;
+    const uint64_t      seek_sample = ((uint64_t)sample_num * 3u) / 4u;
+    const uint32_t      shift = DEC_OUTPUT_BITS_PER_SAMPLE + DEC_OUTPUT_PADDING_BITS - spec.bps;
+    mem_file_t          mf;
+    FILE                *fp;
+    uint32_t            out_num = 0u;
+    uint32_t            mismatch = 0u;
+    uint32_t            pos;
+    uint32_t            cnt;
+    bool                is_open;
+
+    /* The FILE and its buffer stand for the file of FatFs, opened before. */
+    fp = mem_file_open(&mf, track.image);
+    HOST_CHECK(fp != NULL);
+    (void)setvbuf(fp, stdio_buf, _IOFBF, sizeof(stdio_buf));
+
+    alloc_cnt = 0u;
+    free_cnt = 0u;
+    is_counting = true;
+    is_open = flac_open(fp, p_ctrl);
+    if (is_open) {
+        HOST_CHECK(flac_set_pcm_buf(p_ctrl, pcm_buf, PCM_BUF_NUM));
+        (void)flac_decode(p_ctrl);
+        HOST_CHECK(flac_set_position(p_ctrl, seek_sample));
+        pos = (uint32_t)seek_sample * spec.ch;
+        for (;;) {
+            HOST_CHECK(flac_set_pcm_buf(p_ctrl, pcm_buf, PCM_BUF_NUM));
+            if (!flac_decode(p_ctrl)) {
+                break;
+            }
+            cnt = flac_get_pcm_cnt(p_ctrl);
+            if (spec.ch == DEC_OUTPUT_CHANNEL_NUM) {
+                for (uint32_t i = 0u; (i < cnt) && (pos < track.pcm.size()); i++, pos++) {
+                    if (pcm_buf[i] != (int32_t)((uint32_t)track.pcm[pos] << shift)) {
+                        mismatch++;
+                    }
+                }
+            }
+            out_num += cnt;
+        }
+        flac_close(p_ctrl);
+    }
+    is_counting = false;
+    (void)fclose(fp);
+
+    HOST_CHECK(is_open);
+    HOST_CHECK_EQ((sample_num - (uint32_t)seek_sample) * DEC_OUTPUT_CHANNEL_NUM, out_num);
+    HOST_CHECK_EQ(0u, mismatch);
+    return alloc_cnt + free_cnt;
+}
+
+int main(void)
+{
+    static const track_spec_t   spec[] = {
+        /* name                     ch  bps  block  frames md5    comment seektable */
+        { "stereo 16bit 4608",      2u, 16u, 4608u,  8u,   true,  true,   false },
+        { "mono 24bit 1152",        1u, 24u, 1152u,  16u,  true,  false,  false },
+        { "5.1ch 24bit 16384",      6u, 24u, DEC_MAX_BLOCK_SIZE, 3u, true, true, true },
+        { "8ch 24bit 16384",        DEC_MAX_CHANNEL_NUM, 24u, DEC_MAX_BLOCK_SIZE, 3u, true, false, true },
+        { "stereo 24bit 2000 seek points", 2u, 24u, DEC_MIN_BLOCK_SIZE, TEST_SEEK_POINTS, true, true, true },
+    };
+    const uint32_t              track_num = sizeof(spec) / sizeof(spec[0]);
+    std::vector<track_t>        track(track_num);
+    flac_ctrl_t                 ctrl;
+    uint32_t                    calls;
+
+    srand(1);
+    for (uint32_t i = 0u; i < track_num; i++) {
+        track[i].spec = spec[i];
+        make_track(&track[i]);
+    }
+    HOST_CHECK(flac_init(&ctrl));
+
+    /* The first open allocates the bitreader buffer once. */
+    calls = play_track(&ctrl, track[0]);
+    (void)printf("%-32s first open: %u heap calls\n", spec[0].p_name, (unsigned)calls);
+
+    /* Each track after each other one, in both orders. */
+    for (uint32_t round = 0u; round < TEST_ROUND_NUM; round++) {
+        for (uint32_t n = 0u; n < track_num; n++) {
+            const uint32_t  i = (round == 0u) ? n : (track_num - 1u - n);
+
+            calls = play_track(&ctrl, track[i]);
+            (void)printf("%-32s %7u B: %u heap calls\n", spec[i].p_name,
+                         (unsigned)track[i].image.size(), (unsigned)calls);
+            HOST_CHECK_EQ(0u, calls);
+        }
+    }
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,472 @@
+/* Host test of the WAV/AIFF backend (dec_pcm) behind dec_codec.
+ *
+ * Synthetic WAV, WAV with WAVEFORMATEXTENSIBLE, AIFF and AIFF-C ("NONE"
+ * and "sowt") files of random samples are opened by codec_open() from a
+ * memory FILE, as the decode thread opens a track:
+ *  - the backend is chosen by the header: WAV and AIFF go to dec_pcm, a
+ *    FLAC file to dec_flac;
+ *  - every layout of 1ch and 2ch from 8 to 32 bits is output bit-exactly
+ *    as left-justified 32 bits data, also with valid bits less than the
+ *    container, an odd chunk before the data and the SSND chunk before
+ *    COMM with an offset;
+ *  - over 2ch, the output is the one of dmx_convert() for the same data;
+ *  - after codec_set_position() the output starts at that sample;
+ *  - a file shorter than its header ends at its last whole sample, and
+ *    the data chunk of a stream (size 0xFFFFFFFF) is played to the end;
+ *  - float, compressed and out of range files are refused.
+ * The test prints the throughput of the read and conversion of the main
+ * layouts, in MB of file data per second.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "dec_codec.h"
+
+#define TEST_RATE           (44100u)
+#define TEST_SAMPLE_NUM     (40000u)
+#define TEST_BENCH_SIZE     (16u * 1024u * 1024u)
+#define TEST_BENCH_ROUND    (4u)
+#define PCM_BUF_NUM         (DEC_MAX_BLOCK_SIZE * DEC_OUTPUT_CHANNEL_NUM)
+#define WAV_FORMAT_FLOAT    (0x0003u)
+
+typedef enum {
+    FMT_WAV = 0,
+    FMT_WAV_EXT,            /* WAVE_FORMAT_EXTENSIBLE */
+    FMT_AIFF,
+    FMT_AIFC_NONE,
+    FMT_AIFC_SOWT,
+    FMT_NUM
+} test_fmt_t;
+
+typedef struct {
+    test_fmt_t  fmt;
+    uint32_t    ch;
+    uint32_t    bits;           /* Container */
+    uint32_t    valid_bits;
+} layout_t;
+
+static const char * const fmt_name[FMT_NUM] = { "WAV", "WAV ext", "AIFF", "AIFC NONE", "AIFC sowt" };
+
+static void put_le(std::vector<uint8_t> * const p_buf, const uint32_t data, const uint32_t bytes)
+{
+    for (uint32_t i = 0u; i < bytes; i++) {
+        p_buf->push_back((uint8_t)(data >> (i * 8u)));
+    }
+}
+
+static void put_be(std::vector<uint8_t> * const p_buf, const uint32_t data, const uint32_t bytes)
+{
+    for (uint32_t i = bytes; i > 0u; i--) {
+        p_buf->push_back((uint8_t)(data >> ((i - 1u) * 8u)));
+    }
+}
+
+static void put_id(std::vector<uint8_t> * const p_buf, const char * const id)
+{
+    p_buf->insert(p_buf->end(), id, id + 4);
+}
+
+/* Random samples of valid_bits, in the upper bits of the container. */
+static std::vector<uint32_t> make_samples(const layout_t &layout, const uint32_t num)
+{
+    std::vector<uint32_t>   data(num * layout.ch);
+
+    for (size_t i = 0u; i < data.size(); i++) {
+        data[i] = ((uint32_t)rand() ^ ((uint32_t)rand() << 16)) << (32u - layout.valid_bits)
+                  >> (32u - layout.bits);
+    }
+    return data;
+}
+
+/* The sample data of the data chunk or the SSND chunk. */
+static std::vector<uint8_t> make_data(const layout_t &layout, const std::vector<uint32_t> &data)
+{
+    std::vector<uint8_t>    buf;
+    const uint32_t          bytes = layout.bits / 8u;
+    const bool              is_big = (layout.fmt == FMT_AIFF) || (layout.fmt == FMT_AIFC_NONE);
+    uint32_t                value;
+
+    for (size_t i = 0u; i < data.size(); i++) {
+        value = data[i];
+        if ((bytes == 1u) && ((layout.fmt == FMT_WAV) || (layout.fmt == FMT_WAV_EXT))) {
+            value ^= 0x80u;     /* 8 bits data of WAV is unsigned. */
+        }
+        if (is_big == true) {
+            put_be(&buf, value, bytes);
+        } else {
+            put_le(&buf, value, bytes);
+        }
+    }
+    return buf;
+}
+
+static std::vector<uint8_t> make_wav(const layout_t &layout, const std::vector<uint8_t> &data,
+                                     const uint32_t data_size, const uint32_t format)
+{
+    std::vector<uint8_t>    buf;
+    const uint32_t          block_align = (layout.bits / 8u) * layout.ch;
+    const bool              is_ext = (layout.fmt == FMT_WAV_EXT);
+
+    put_id(&buf, "RIFF");
+    put_le(&buf, 0u, 4u);
+    put_id(&buf, "WAVE");
+    put_id(&buf, "fmt ");
+    put_le(&buf, is_ext ? 40u : 16u, 4u);
+    put_le(&buf, is_ext ? 0xFFFEu : format, 2u);
+    put_le(&buf, layout.ch, 2u);
+    put_le(&buf, TEST_RATE, 4u);
+    put_le(&buf, TEST_RATE * block_align, 4u);
+    put_le(&buf, block_align, 2u);
+    put_le(&buf, is_ext ? layout.bits : layout.valid_bits, 2u);
+    if (is_ext == true) {
+        put_le(&buf, 22u, 2u);
+        put_le(&buf, layout.valid_bits, 2u);
+        put_le(&buf, 0u, 4u);                   /* dwChannelMask */
+        put_le(&buf, format, 4u);               /* SubFormat: KSDATAFORMAT_SUBTYPE_PCM */
+        put_le(&buf, 0x0000u, 2u);
+        put_le(&buf, 0x0010u, 2u);
+        put_be(&buf, 0x800000AAu, 4u);
+        put_be(&buf, 0x00389B71u, 4u);
+    }
+    /* A chunk of an odd size, padded. */
+    put_id(&buf, "LIST");
+    put_le(&buf, 5u, 4u);
+    put_id(&buf, "INFO");
+    buf.push_back(0u);
+    buf.push_back(0u);
+    put_id(&buf, "data");
+    put_le(&buf, data_size, 4u);
+    buf.insert(buf.end(), data.begin(), data.end());
+    return buf;
+}
+
+/* 80 bits extended of an integer rate. */
+static void put_ext_rate(std::vector<uint8_t> * const p_buf, const uint32_t rate)
+{
+    const uint32_t  shift = (uint32_t)__builtin_clzll((unsigned long long)rate);
+    const uint64_t  mantissa = (uint64_t)rate << shift;
+
+    put_be(p_buf, 16383u + (63u - shift), 2u);
+    put_be(p_buf, (uint32_t)(mantissa >> 32), 4u);
+    put_be(p_buf, (uint32_t)mantissa, 4u);
+}
+
+static std::vector<uint8_t> make_aiff(const layout_t &layout, const std::vector<uint8_t> &data,
+                                      const uint32_t frame_num, const char * const compression,
+                                      const bool is_ssnd_first)
+{
+    std::vector<uint8_t>    buf;
+    std::vector<uint8_t>    comm;
+    std::vector<uint8_t>    ssnd;
+    const bool              is_aifc = (layout.fmt != FMT_AIFF);
+    const uint32_t          offset = is_ssnd_first ? 8u : 0u;
+
+    put_id(&comm, "COMM");
+    put_be(&comm, is_aifc ? 28u : 18u, 4u);
+    put_be(&comm, layout.ch, 2u);
+    put_be(&comm, frame_num, 4u);
+    put_be(&comm, layout.valid_bits, 2u);
+    put_ext_rate(&comm, TEST_RATE);
+    if (is_aifc == true) {
+        put_id(&comm, compression);
+        comm.push_back(4u);
+        put_id(&comm, "test");
+        comm.push_back(0u);
+    }
+    put_id(&ssnd, "SSND");
+    put_be(&ssnd, 8u + offset + (uint32_t)data.size(), 4u);
+    put_be(&ssnd, offset, 4u);
+    put_be(&ssnd, 0u, 4u);
+    ssnd.insert(ssnd.end(), offset, 0xEEu);
+    ssnd.insert(ssnd.end(), data.begin(), data.end());
+    if ((ssnd.size() & 1u) != 0u) {
+        ssnd.push_back(0u);
+    }
+
+    put_id(&buf, "FORM");
+    put_be(&buf, 0u, 4u);
+    put_id(&buf, is_aifc ? "AIFC" : "AIFF");
+    if (is_aifc == true) {
+        put_id(&buf, "FVER");
+        put_be(&buf, 4u, 4u);
+        put_be(&buf, 0xA2805140u, 4u);
+    }
+    buf.insert(buf.end(), is_ssnd_first ? ssnd.begin() : comm.begin(), is_ssnd_first ? ssnd.end() : comm.end());
+    buf.insert(buf.end(), is_ssnd_first ? comm.begin() : ssnd.begin(), is_ssnd_first ? comm.end() : ssnd.end());
+    return buf;
+}
+
+static std::vector<uint8_t> make_file(const layout_t &layout, const std::vector<uint32_t> &samples,
+                                      const bool is_ssnd_first = false)
+{
+    const std::vector<uint8_t>  data = make_data(layout, samples);
+    const uint32_t              frame_num = (uint32_t)(samples.size() / layout.ch);
+
+    if ((layout.fmt == FMT_WAV) || (layout.fmt == FMT_WAV_EXT)) {
+        return make_wav(layout, data, (uint32_t)data.size(), 0x0001u);
+    }
+    return make_aiff(layout, data, frame_num, (layout.fmt == FMT_AIFC_SOWT) ? "sowt" : "NONE", is_ssnd_first);
+}
+
+/* The output of the samples: left-justified for 1ch and 2ch, or the */
+/* output of the downmix of the FLAC decoder for the same data. */
+static std::vector<int32_t> expect_output(const layout_t &layout, const std::vector<uint32_t> &samples)
+{
+    const uint32_t          num = (uint32_t)(samples.size() / layout.ch);
+    std::vector<int32_t>    out(num * DEC_OUTPUT_CHANNEL_NUM);
+    std::vector<int32_t>    ch_buf[DEC_MAX_CHANNEL_NUM];
+    const int32_t           *p_in[DEC_MAX_CHANNEL_NUM];
+    dmx_ctrl_t              dmx;
+
+    if (layout.ch <= DEC_OUTPUT_CHANNEL_NUM) {
+        for (uint32_t i = 0u; i < num; i++) {
+            for (uint32_t ch = 0u; ch < DEC_OUTPUT_CHANNEL_NUM; ch++) {
+                out[(i * DEC_OUTPUT_CHANNEL_NUM) + ch] =
+                    (int32_t)(samples[(i * layout.ch) + (ch % layout.ch)] << (32u - layout.bits));
+            }
+        }
+    } else {
+        for (uint32_t ch = 0u; ch < layout.ch; ch++) {
+            ch_buf[ch].resize(num);
+            for (uint32_t i = 0u; i < num; i++) {
+                /* Sign-extended in the bits of the container */
+                ch_buf[ch][i] = (int32_t)(samples[(i * layout.ch) + ch] << (32u - layout.bits)) >> (32u - layout.bits);
+            }
+            p_in[ch] = &ch_buf[ch][0];
+        }
+        HOST_CHECK(dmx_set_cfg(&dmx, layout.ch, layout.bits));
+        (void)dmx_convert(&dmx, p_in, &out[0], num);
+    }
+    return out;
+}
+
+/* Decodes the rest of the track. */
+static std::vector<int32_t> decode_all(codec_ctrl_t * const p_codec, std::vector<int32_t> * const p_buf)
+{
+    std::vector<int32_t>    out;
+    uint32_t                cnt;
+
+    while (codec_set_pcm_buf(p_codec, &(*p_buf)[0], (uint32_t)p_buf->size()) &&
+           codec_decode(p_codec)) {
+        cnt = codec_get_pcm_cnt(p_codec);
+        out.insert(out.end(), p_buf->begin(), p_buf->begin() + cnt);
+    }
+    return out;
+}
+
+static uint32_t count_mismatch(const std::vector<int32_t> &out, const std::vector<int32_t> &expect,
+                               const size_t top)
+{
+    uint32_t    mismatch = 0u;
+
+    for (size_t i = 0u; i < out.size(); i++) {
+        if (((top + i) >= expect.size()) || (out[i] != expect[top + i])) {
+            mismatch++;
+        }
+    }
+    return mismatch;
+}
+
+static void run_layout(const layout_t &layout, const bool is_ssnd_first = false)
+{
+    const std::vector<uint32_t> samples = make_samples(layout, TEST_SAMPLE_NUM);
+    const std::vector<uint8_t>  image = make_file(layout, samples, is_ssnd_first);
+    const std::vector<int32_t>  expect = expect_output(layout, samples);
+    const uint32_t              seek = (TEST_SAMPLE_NUM / 3u) + 1u;
+    std::vector<int32_t>        buf(PCM_BUF_NUM);
+    std::vector<int32_t>        out;
+    static codec_ctrl_t         codec;
+    mem_file_t                  mf;
+    FILE                        *fp;
+    uint32_t                    mismatch;
+
+    HOST_CHECK(codec_init(&codec));
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(codec_open(fp, &codec));
+    HOST_CHECK_EQ(CODEC_TYPE_PCM, codec.type);
+    HOST_CHECK_EQ(TEST_RATE, codec_get_sample_rate(&codec));
+    HOST_CHECK_EQ(layout.ch, codec_get_channel_num(&codec));
+    HOST_CHECK_EQ(TEST_SAMPLE_NUM, codec_get_total_sample(&codec));
+
+    out = decode_all(&codec, &buf);
+    HOST_CHECK_EQ(expect.size(), out.size());
+    mismatch = count_mismatch(out, expect, 0u);
+    HOST_CHECK_EQ(TEST_SAMPLE_NUM, codec_get_decoded_sample(&codec));
+
+    /* From the middle of the track */
+    HOST_CHECK(codec_set_position(&codec, seek));
+    out = decode_all(&codec, &buf);
+    HOST_CHECK_EQ((TEST_SAMPLE_NUM - seek) * DEC_OUTPUT_CHANNEL_NUM, out.size());
+    mismatch += count_mismatch(out, expect, seek * DEC_OUTPUT_CHANNEL_NUM);
+    HOST_CHECK(codec_set_position(&codec, TEST_SAMPLE_NUM) != true);
+    codec_close(&codec);
+    (void)fclose(fp);
+
+    if (mismatch != 0u) {
+        (void)printf("%s %uch %u bits in %u: %u mismatches\n", fmt_name[layout.fmt], (unsigned)layout.ch,
+                     (unsigned)layout.valid_bits, (unsigned)layout.bits, (unsigned)mismatch);
+    }
+    HOST_CHECK_EQ(0u, mismatch);
+}
+
+static void test_layouts(void)
+{
+    static const uint32_t   bits_tbl[] = { 8u, 16u, 24u, 32u };
+    static const test_fmt_t fmt_tbl[] = { FMT_WAV, FMT_AIFF, FMT_AIFC_SOWT };
+    layout_t                layout;
+    uint32_t                num = 0u;
+
+    for (size_t f = 0u; f < (sizeof(fmt_tbl) / sizeof(fmt_tbl[0])); f++) {
+        for (size_t b = 0u; b < (sizeof(bits_tbl) / sizeof(bits_tbl[0])); b++) {
+            for (uint32_t ch = 1u; ch <= 2u; ch++) {
+                layout.fmt = fmt_tbl[f];
+                layout.ch = ch;
+                layout.bits = bits_tbl[b];
+                layout.valid_bits = bits_tbl[b];
+                run_layout(layout);
+                num++;
+            }
+        }
+    }
+    /* Valid bits less than the container */
+    layout = { FMT_WAV_EXT, 2u, 32u, 24u };
+    run_layout(layout);
+    layout = { FMT_WAV_EXT, 1u, 24u, 20u };
+    run_layout(layout);
+    layout = { FMT_AIFF, 2u, 16u, 12u };
+    run_layout(layout);
+    layout = { FMT_AIFC_NONE, 2u, 24u, 24u };
+    run_layout(layout);
+    /* SSND before COMM, with an offset */
+    layout = { FMT_AIFF, 2u, 24u, 24u };
+    run_layout(layout, true);
+    /* Over 2ch: downmixed */
+    layout = { FMT_WAV, 6u, 16u, 16u };
+    run_layout(layout);
+    layout = { FMT_AIFF, 6u, 24u, 24u };
+    run_layout(layout);
+    layout = { FMT_WAV_EXT, 8u, 32u, 32u };
+    run_layout(layout);
+    (void)printf("%u layouts of 1ch and 2ch from 8 to 32 bits and 8 other files: bit-exact, also after a seek\n",
+                 (unsigned)num);
+}
+
+/* Opens the image. Returns the result of codec_open(). */
+static bool open_image(codec_ctrl_t * const p_codec, const std::vector<uint8_t> &image,
+                       std::vector<int32_t> * const p_out)
+{
+    std::vector<int32_t>    buf(PCM_BUF_NUM);
+    mem_file_t              mf;
+    FILE                    *fp = mem_file_open(&mf, image);
+    bool                    result;
+
+    HOST_CHECK(codec_init(p_codec));
+    result = codec_open(fp, p_codec);
+    if ((result == true) && (p_out != NULL)) {
+        *p_out = decode_all(p_codec, &buf);
+    }
+    codec_close(p_codec);
+    (void)fclose(fp);
+    return result;
+}
+
+static void test_files(void)
+{
+    static codec_ctrl_t         codec;
+    const layout_t              layout = { FMT_WAV, 2u, 16u, 16u };
+    const std::vector<uint32_t> samples = make_samples(layout, TEST_SAMPLE_NUM);
+    const std::vector<uint8_t>  data = make_data(layout, samples);
+    const std::vector<int32_t>  expect = expect_output(layout, samples);
+    const uint32_t              cut = 1000u;
+    std::vector<int32_t>        out;
+    std::vector<uint8_t>        image;
+    std::vector<int32_t>        pcm(4096u * 2u, 0);
+    FlacWriter                  fw;
+    layout_t                    other;
+
+    /* A FLAC file goes to dec_flac. */
+    fw.streaminfo(TEST_RATE, 2u, 16u, 4096u, 4096u, true);
+    fw.frame(0u, &pcm[0], 4096u, 2u, 16u);
+    HOST_CHECK(open_image(&codec, fw.data(), &out));
+    HOST_CHECK_EQ(CODEC_TYPE_FLAC, codec.type);
+    HOST_CHECK_EQ(4096u * DEC_OUTPUT_CHANNEL_NUM, out.size());
+
+    /* Shorter than the header: the last sample is not whole. */
+    image = make_wav(layout, data, (uint32_t)data.size(), 0x0001u);
+    image.resize(image.size() - (cut * 4u) - 1u);
+    HOST_CHECK(open_image(&codec, image, &out));
+    HOST_CHECK_EQ((TEST_SAMPLE_NUM - cut - 1u) * DEC_OUTPUT_CHANNEL_NUM, out.size());
+    HOST_CHECK_EQ(0u, count_mismatch(out, expect, 0u));
+
+    /* A stream: played to the end of the file. */
+    image = make_wav(layout, data, 0xFFFFFFFFu, 0x0001u);
+    HOST_CHECK(open_image(&codec, image, &out));
+    HOST_CHECK_EQ(expect.size(), out.size());
+    HOST_CHECK_EQ(0u, count_mismatch(out, expect, 0u));
+
+    /* Refused: float, compressed, out of the range of the decoder. */
+    HOST_CHECK(open_image(&codec, make_wav(layout, data, (uint32_t)data.size(), WAV_FORMAT_FLOAT), NULL) != true);
+    other = { FMT_AIFC_NONE, 2u, 16u, 16u };
+    HOST_CHECK(open_image(&codec, make_aiff(other, data, TEST_SAMPLE_NUM, "ima4", false), NULL) != true);
+    other = { FMT_WAV, DEC_MAX_CHANNEL_NUM + 1u, 16u, 16u };
+    HOST_CHECK(open_image(&codec, make_wav(other, data, (uint32_t)data.size(), 0x0001u), NULL) != true);
+    image = make_wav(layout, data, (uint32_t)data.size(), 0x0001u);
+    image[24] = 0x40u;      /* nSamplesPerSec 8000 */
+    image[25] = 0x1Fu;
+    HOST_CHECK(open_image(&codec, image, NULL) != true);
+    (void)printf("FLAC sniffed, short file and stream played to the end, 4 files refused\n");
+}
+
+static void bench_layout(const layout_t &layout)
+{
+    const uint32_t              num = TEST_BENCH_SIZE / ((layout.bits / 8u) * layout.ch);
+    const std::vector<uint32_t> samples = make_samples(layout, num);
+    const std::vector<uint8_t>  image = make_file(layout, samples);
+    std::vector<int32_t>        buf(PCM_BUF_NUM);
+    static codec_ctrl_t         codec;
+    mem_file_t                  mf;
+    FILE                        *fp;
+    uint64_t                    start;
+    uint64_t                    best_ns = UINT64_MAX;
+    uint64_t                    cnt;
+
+    for (uint32_t round = 0u; round < TEST_BENCH_ROUND; round++) {
+        HOST_CHECK(codec_init(&codec));
+        fp = mem_file_open(&mf, image);
+        HOST_CHECK(codec_open(fp, &codec));
+        cnt = 0u;
+        start = host_time_ns();
+        while (codec_set_pcm_buf(&codec, &buf[0], (uint32_t)buf.size()) && codec_decode(&codec)) {
+            cnt += codec_get_pcm_cnt(&codec);
+        }
+        best_ns = ((host_time_ns() - start) < best_ns) ? (host_time_ns() - start) : best_ns;
+        HOST_CHECK_EQ((uint64_t)num * DEC_OUTPUT_CHANNEL_NUM, cnt);
+        codec_close(&codec);
+        (void)fclose(fp);
+    }
+    (void)printf("  %-9s %uch %2u bits: %7.0f MB/s\n", fmt_name[layout.fmt], (unsigned)layout.ch,
+                 (unsigned)layout.bits, ((double)TEST_BENCH_SIZE / 1e6) / ((double)best_ns / 1e9));
+}
+
+static void test_bench(void)
+{
+    (void)printf("Read and conversion of %u MB of data:\n", TEST_BENCH_SIZE >> 20);
+    bench_layout({ FMT_WAV, 2u, 32u, 32u });
+    bench_layout({ FMT_WAV, 2u, 24u, 24u });
+    bench_layout({ FMT_WAV, 2u, 16u, 16u });
+    bench_layout({ FMT_AIFF, 2u, 16u, 16u });
+    bench_layout({ FMT_WAV, 1u, 16u, 16u });
+    bench_layout({ FMT_WAV, 2u, 8u, 8u });
+}
+
+int main(void)
+{
+    srand(TEST_RATE);
+    test_layouts();
+    test_files();
+    test_bench();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,86 @@
+/* Host test of dec_rate: the sampling rate policy of the decode thread.
+ *
+ * For every input rate the player accepts, the chain is checked as
+ * open_proc runs it: file rate -> SCUX input rate (software 2x decimation
+ * above DEC_SCUX_MAX_SAMPLE_RATE) -> audio output rate -> SCUX SRC config.
+ */
+#include "host_test.h"
+#include "decode.h"
+#include "dec_rate.h"
+
+typedef struct {
+    uint32_t    file_rate;
+    uint32_t    scux_input_rate;
+    uint32_t    output_rate;
+} rate_case_t;
+
+static const rate_case_t rate_cases[] = {
+#if (DEC_NATIVE_RATE_OUTPUT == 1)
+    /* Native rates bypass the SRC of SCUX. */
+    {  44100u,  44100u,  44100u },
+    {  48000u,  48000u,  48000u },
+    {  88200u,  88200u,  88200u },
+    {  96000u,  96000u,  96000u },
+    /* Rates which TLV320 cannot take from the 12 MHz MCLK are converted. */
+    {  22050u,  22050u,  96000u },
+    {  24000u,  24000u,  96000u },
+    {  32000u,  32000u,  96000u },
+    {  64000u,  64000u,  96000u },
+    /* Over 96 kHz, the software SRC halves the rate first. */
+    { 176400u,  88200u,  88200u },
+    { 192000u,  96000u,  96000u },
+    { 128000u,  64000u,  96000u },
+#else
+    {  44100u,  44100u,  96000u },
+    {  48000u,  48000u,  96000u },
+    {  88200u,  88200u,  96000u },
+    {  96000u,  96000u,  96000u },
+    {  22050u,  22050u,  96000u },
+    {  32000u,  32000u,  96000u },
+    { 176400u,  88200u,  96000u },
+    { 192000u,  96000u,  96000u },
+#endif /* DEC_NATIVE_RATE_OUTPUT */
+};
+
+static bool is_codec_rate(const uint32_t rate)
+{
+    return (rate == 44100u) || (rate == 48000u) || (rate == 88200u) || (rate == 96000u);
+}
+
+int main(void)
+{
+    scux_src_usr_cfg_t  conf;
+    uint32_t            input_rate;
+    uint32_t            output_rate;
+
+    for (size_t i = 0u; i < (sizeof(rate_cases) / sizeof(rate_cases[0])); i++) {
+        const rate_case_t   *p_case = &rate_cases[i];
+
+        input_rate = rate_get_scux_input_rate(p_case->file_rate);
+        HOST_CHECK_EQ(p_case->scux_input_rate, input_rate);
+        HOST_CHECK(input_rate <= DEC_SCUX_MAX_SAMPLE_RATE);
+
+        output_rate = rate_select_output_rate(input_rate);
+        HOST_CHECK_EQ(p_case->output_rate, output_rate);
+        HOST_CHECK(is_codec_rate(output_rate));
+
+        HOST_CHECK(rate_set_scux_src_cfg(&conf, input_rate, output_rate));
+        HOST_CHECK_EQ(input_rate, conf.input_rate);
+        HOST_CHECK_EQ(output_rate, conf.output_rate);
+        HOST_CHECK_EQ(SCUX_DATA_LEN_24, conf.word_len);
+        if (input_rate == output_rate) {
+            /* The driver allows the bypass in asynchronous mode only. */
+            HOST_CHECK(!conf.src_enable);
+            HOST_CHECK(!conf.mode_sync);
+        } else {
+            HOST_CHECK(conf.src_enable);
+            HOST_CHECK(conf.mode_sync);
+        }
+        (void)printf("%6u Hz -> SCUX %6u Hz -> out %6u Hz (%s)\n",
+                     (unsigned)p_case->file_rate, (unsigned)input_rate,
+                     (unsigned)output_rate, conf.src_enable ? "SRC" : "bypass");
+    }
+    HOST_CHECK(!rate_set_scux_src_cfg(NULL, 44100u, 44100u));
+
+    return HOST_TEST_RESULT();
+}
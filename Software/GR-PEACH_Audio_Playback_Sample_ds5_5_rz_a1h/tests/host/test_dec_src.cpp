@@ -0,0 +1,289 @@
+/* Host test and benchmark of dec_src: the 2x half-band decimator in front
+ * of SCUX.
+ *
+ * The quality figures are measured at 192 kHz -> 96 kHz with 24 bits sine
+ * waves on both channels:
+ *  - passband ripple from 20 Hz to 0.21 fs (fs : input rate),
+ *  - rejection from 0.29 fs to 0.49 fs, i.e. the level of the aliases,
+ *  - THD+N of a 1 kHz tone.
+ * The tones are placed on the bins of the analysed output block, so the
+ * fitted sine and the residual need no window. The benchmark prints the
+ * cycles per output frame (host_cycles) of src_convert() on the decode
+ * buffer size, and the state kept between calls is checked bit-exact.
+ */
+#include <math.h>
+#include <vector>
+#include "host_test.h"
+#include "decode.h"
+#include "dec_src.h"
+
+#define TEST_CH             (DEC_OUTPUT_CHANNEL_NUM)
+#define TEST_IN_RATE        (192000u)
+#define TEST_OUT_RATE       (TEST_IN_RATE / SRC_DECIMATION_RATIO)
+#define TEST_CHUNK          (4096u)         /* Elements per call, as a decode buffer */
+#define TEST_SKIP_FRAME     (256u)          /* Output frames until the filter settles */
+#define TEST_FIT_FRAME      (16384u)        /* Output frames analysed */
+#define TEST_AMP            (0.5)           /* -6 dBFS */
+#define PCM_SCALE           (8388608.0)     /* 24 bits full scale */
+#define PASSBAND_EDGE       (0.21)
+#define STOPBAND_EDGE       (0.29)
+#define BENCH_SEC           (10u)
+
+static src_ctrl_t   src_ctrl;
+
+static bool setup(const bool enable)
+{
+    src_cfg_t   cfg;
+
+    cfg.src_enable = enable;
+    cfg.input_rate = TEST_IN_RATE;
+    cfg.output_rate = TEST_OUT_RATE;
+    return src_set_cfg(&src_ctrl, &cfg);
+}
+
+/* Runs the decimator over in, TEST_CHUNK elements per call. */
+static std::vector<int32_t> run(const std::vector<int32_t> &in, const uint32_t chunk)
+{
+    std::vector<int32_t>    buf = in;
+    std::vector<int32_t>    out;
+    uint32_t                num;
+
+    for (size_t i = 0u; i < buf.size(); i += chunk) {
+        num = (uint32_t)(((buf.size() - i) < chunk) ? (buf.size() - i) : chunk);
+        num = src_convert(&src_ctrl, &buf[i], num);
+        out.insert(out.end(), &buf[i], &buf[i] + num);
+    }
+    return out;
+}
+
+/* Sine of freq on both channels, 24 bits data with 8 bits padding. */
+static std::vector<int32_t> make_tone(const double freq)
+{
+    const uint32_t          frame_num = (TEST_SKIP_FRAME + TEST_FIT_FRAME) * SRC_DECIMATION_RATIO;
+    std::vector<int32_t>    in(frame_num * TEST_CH);
+    double                  val;
+
+    for (uint32_t i = 0u; i < frame_num; i++) {
+        val = TEST_AMP * PCM_SCALE * sin((2.0 * M_PI * freq * i) / TEST_IN_RATE);
+        for (uint32_t ch = 0u; ch < TEST_CH; ch++) {
+            in[(i * TEST_CH) + ch] = (int32_t)((uint32_t)(int32_t)lrint(val) << DEC_OUTPUT_PADDING_BITS);
+        }
+    }
+    return in;
+}
+
+static double bin_freq(const uint32_t bin)
+{
+    return ((double)bin * TEST_OUT_RATE) / TEST_FIT_FRAME;
+}
+
+/* Analyses channel ch of the output at bin. */
+/* Returns the amplitude of the bin relative to TEST_AMP, and the RMS of */
+/* everything else relative to the RMS of the bin in *p_residual. */
+static double analyse(const std::vector<int32_t> &out, const uint32_t ch, const uint32_t bin,
+                      double * const p_residual, double * const p_rms)
+{
+    double  s = 0.0;
+    double  c = 0.0;
+    double  y;
+    double  w;
+    double  amp;
+    double  phase;
+    double  err = 0.0;
+    double  total = 0.0;
+
+    for (uint32_t i = 0u; i < TEST_FIT_FRAME; i++) {
+        y = (double)(out[((TEST_SKIP_FRAME + i) * TEST_CH) + ch] >> DEC_OUTPUT_PADDING_BITS);
+        w = (2.0 * M_PI * bin * i) / TEST_FIT_FRAME;
+        s += y * sin(w);
+        c += y * cos(w);
+        total += y * y;
+    }
+    s *= 2.0 / TEST_FIT_FRAME;
+    c *= 2.0 / TEST_FIT_FRAME;
+    amp = sqrt((s * s) + (c * c));
+    phase = atan2(c, s);
+    for (uint32_t i = 0u; i < TEST_FIT_FRAME; i++) {
+        y = (double)(out[((TEST_SKIP_FRAME + i) * TEST_CH) + ch] >> DEC_OUTPUT_PADDING_BITS);
+        w = (2.0 * M_PI * bin * i) / TEST_FIT_FRAME;
+        y -= amp * sin(w + phase);
+        err += y * y;
+    }
+    if (p_residual != NULL) {
+        *p_residual = sqrt(err / TEST_FIT_FRAME) / (amp / sqrt(2.0));
+    }
+    if (p_rms != NULL) {
+        *p_rms = sqrt(total / TEST_FIT_FRAME) / ((TEST_AMP * PCM_SCALE) / sqrt(2.0));
+    }
+    return amp / (TEST_AMP * PCM_SCALE);
+}
+
+static double to_db(const double val)
+{
+    return 20.0 * log10(val);
+}
+
+static void test_cfg(void)
+{
+    src_cfg_t               cfg;
+    std::vector<int32_t>    in(TEST_CHUNK);
+    std::vector<int32_t>    out;
+
+    /* Only the 2x decimation is supported. */
+    cfg.src_enable = true;
+    cfg.input_rate = 176400u;
+    cfg.output_rate = 96000u;
+    HOST_CHECK(!src_set_cfg(&src_ctrl, &cfg));
+    HOST_CHECK(!src_ctrl.src_enable);
+    cfg.output_rate = 88200u;
+    HOST_CHECK(src_set_cfg(&src_ctrl, &cfg));
+    HOST_CHECK_EQ(88200u, src_get_output_rate(&src_ctrl));
+
+    /* Disabled, the data passes unchanged at the input rate. */
+    HOST_CHECK(setup(false));
+    HOST_CHECK_EQ(TEST_IN_RATE, src_get_output_rate(&src_ctrl));
+    for (size_t i = 0u; i < in.size(); i++) {
+        in[i] = (int32_t)((i * 2654435761u) & 0xFFFFFF00u);
+    }
+    out = run(in, TEST_CHUNK);
+    HOST_CHECK(out == in);
+}
+
+/* The filter state carries over the calls: any split gives the same data. */
+static void test_chunk(void)
+{
+    std::vector<int32_t>    in = make_tone(bin_freq(171u));
+    std::vector<int32_t>    ref;
+    std::vector<int32_t>    out;
+    static const uint32_t   chunks[] = { 2u, 6u, 130u, 4094u };
+
+    HOST_CHECK(setup(true));
+    ref = run(in, (uint32_t)in.size());
+    HOST_CHECK_EQ(in.size() / SRC_DECIMATION_RATIO, ref.size());
+    for (size_t i = 0u; i < (sizeof(chunks) / sizeof(chunks[0])); i++) {
+        HOST_CHECK(setup(true));
+        out = run(in, chunks[i]);
+        HOST_CHECK(out == ref);
+    }
+}
+
+static void test_quality(void)
+{
+    const uint32_t  pass_bin = (uint32_t)((PASSBAND_EDGE * TEST_IN_RATE * TEST_FIT_FRAME) / TEST_OUT_RATE);
+    const uint32_t  stop_bin = (uint32_t)ceil((STOPBAND_EDGE * TEST_IN_RATE * TEST_FIT_FRAME) / TEST_OUT_RATE);
+    const uint32_t  end_bin = (uint32_t)((0.49 * TEST_IN_RATE * TEST_FIT_FRAME) / TEST_OUT_RATE);
+    double          gain_min = 1.0e9;
+    double          gain_max = 0.0;
+    double          worst_stop = 0.0;
+    double          gain;
+    double          rms;
+    double          thdn;
+    std::vector<int32_t> out;
+
+    /* Passband : 20 Hz to 0.21 fs in 48 steps. */
+    for (uint32_t step = 0u; step <= 48u; step++) {
+        const uint32_t bin = 4u + (((pass_bin - 4u) * step) / 48u);
+
+        HOST_CHECK(setup(true));
+        out = run(make_tone(bin_freq(bin)), TEST_CHUNK);
+        for (uint32_t ch = 0u; ch < TEST_CH; ch++) {
+            gain = analyse(out, ch, bin, NULL, NULL);
+            gain_min = (gain < gain_min) ? gain : gain_min;
+            gain_max = (gain > gain_max) ? gain : gain_max;
+        }
+    }
+    /* Stopband : the tone of the input is above the output Nyquist rate. */
+    /* Everything left in the output is its alias. */
+    for (uint32_t step = 0u; step <= 48u; step++) {
+        const uint32_t bin = stop_bin + (((end_bin - stop_bin) * step) / 48u);
+
+        HOST_CHECK(setup(true));
+        out = run(make_tone(bin_freq(bin)), TEST_CHUNK);
+        (void)analyse(out, 0u, 1u, NULL, &rms);
+        worst_stop = (rms > worst_stop) ? rms : worst_stop;
+    }
+    /* THD+N of 1 kHz (bin 171 is 1001.95 Hz). */
+    HOST_CHECK(setup(true));
+    out = run(make_tone(bin_freq(171u)), TEST_CHUNK);
+    (void)analyse(out, 0u, 171u, &thdn, NULL);
+
+    (void)printf("passband ripple (20 Hz - %.1f kHz): %.5f dB (gain %.5f .. %.5f dB)\n",
+                 (PASSBAND_EDGE * TEST_IN_RATE) / 1000.0, to_db(gain_max) - to_db(gain_min),
+                 to_db(gain_min), to_db(gain_max));
+    (void)printf("rejection (%.1f kHz - %.1f kHz): %.1f dB\n",
+                 (STOPBAND_EDGE * TEST_IN_RATE) / 1000.0, (0.49 * TEST_IN_RATE) / 1000.0,
+                 -to_db(worst_stop));
+    (void)printf("THD+N at 1 kHz, -6 dBFS: %.1f dB\n", to_db(thdn));
+    HOST_CHECK((to_db(gain_max) - to_db(gain_min)) < 0.01);
+    HOST_CHECK(fabs(to_db(gain_max)) < 0.01);
+    HOST_CHECK(-to_db(worst_stop) >= 70.0);
+    /* 24 bits quantization of the -6 dBFS tone alone is about -140 dB. */
+    HOST_CHECK(to_db(thdn) < -120.0);
+}
+
+/* Full scale square wave: the overshoot of the filter saturates instead of wrapping. */
+static void test_saturation(void)
+{
+    const uint32_t          period = 256u;      /* Input frames */
+    std::vector<int32_t>    in(period * 16u * TEST_CH);
+    std::vector<int32_t>    out;
+    uint32_t                pos;
+    bool                    is_plus;
+
+    for (size_t i = 0u; i < (in.size() / TEST_CH); i++) {
+        is_plus = ((i % period) < (period / 2u));
+        for (uint32_t ch = 0u; ch < TEST_CH; ch++) {
+            in[(i * TEST_CH) + ch] = is_plus ? (int32_t)0x7FFFFF00 : (int32_t)0x80000000;
+        }
+    }
+    HOST_CHECK(setup(true));
+    out = run(in, TEST_CHUNK);
+    /* Checks the middle of every half period after the first one. */
+    for (size_t i = period; i < (out.size() / TEST_CH); i++) {
+        pos = (uint32_t)(((i * SRC_DECIMATION_RATIO) - (SRC_HB_TAP_NUM / 2u)) % period);
+        if ((pos > (period / 8u)) && (pos < ((period * 3u) / 8u))) {
+            HOST_CHECK(out[i * TEST_CH] > 0x7F000000);
+        } else if ((pos > ((period * 5u) / 8u)) && (pos < ((period * 7u) / 8u))) {
+            HOST_CHECK(out[i * TEST_CH] < (int32_t)0x81000000);
+        } else {
+            /* Edge */
+        }
+    }
+}
+
+static void bench(void)
+{
+    std::vector<int32_t>    buf(TEST_CHUNK);
+    const uint32_t          call_num = (TEST_IN_RATE * BENCH_SEC * TEST_CH) / TEST_CHUNK;
+    uint64_t                out_num = 0u;
+    uint64_t                ns;
+    uint64_t                cycles;
+    uint32_t                seed = 1u;
+
+    HOST_CHECK(setup(true));
+    ns = host_time_ns();
+    cycles = host_cycles();
+    for (uint32_t n = 0u; n < call_num; n++) {
+        for (size_t i = 0u; i < buf.size(); i++) {
+            seed = (seed * 1103515245u) + 12345u;
+            buf[i] = (int32_t)(seed & 0xFFFFFF00u);
+        }
+        out_num += src_convert(&src_ctrl, &buf[0], (uint32_t)buf.size());
+    }
+    cycles = host_cycles() - cycles;
+    ns = host_time_ns() - ns;
+    out_num /= TEST_CH;
+    (void)printf("src_convert: %u s of 192 kHz stereo in %.1f ms, %.1f cycles / %.1f ns per output frame\n",
+                 (unsigned)BENCH_SEC, (double)ns / 1.0e6,
+                 (double)cycles / (double)out_num, (double)ns / (double)out_num);
+}
+
+int main(void)
+{
+    test_cfg();
+    test_chunk();
+    test_quality();
+    test_saturation();
+    bench();
+    return HOST_TEST_RESULT();
+}
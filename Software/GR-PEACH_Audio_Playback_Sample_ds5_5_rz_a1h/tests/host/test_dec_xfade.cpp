@@ -0,0 +1,346 @@
+/* Host test and benchmark of dec_xfade: the crossfade mixer between tracks.
+ *
+ *  - Curves: every output sample of xfade_mix() matches the mix of a double
+ *    model of the linear and the equal-power curves, with the gains held
+ *    for XFADE_STEP_FRAME_NUM frames like the mixer, in any call size.
+ *  - Endpoints: the first frame is the track which fades out bit-exact,
+ *    and after the end the track which fades in bit-exact.
+ *  - The linear gains sum to 1, the equal-power powers sum to 1.
+ *  - Saturation: full scale tracks in phase clamp to 24 bits.
+ *  - Short tail: the frames after in_num are mixed with silence and the
+ *    fade still advances over the whole output buffer.
+ * The benchmark prints the cycles per frame of xfade_mix(), its share of
+ * the host CPU at 192 kHz, and the cycle budget per frame of the 400 MHz
+ * RZ/A1H at 192 kHz to compare them with.
+ */
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "host_test.h"
+#include "decode.h"
+#include "dec_xfade.h"
+
+#define TEST_RATE           (48000u)
+#define TEST_CHUNK          (4096u)         /* Elements per call, as a decode buffer */
+#define TEST_FADE_MS        (100u)
+#define STEP_FRAME_NUM      (32u)           /* XFADE_STEP_FRAME_NUM of dec_xfade.cpp */
+#define PCM_SCALE           (8388608.0)     /* 24 bits full scale */
+#define PCM_MAX_VAL         (0x007FFFFF)
+#define PCM_MIN_VAL         (-0x00800000)
+#define TARGET_CPU_HZ       (400000000.0)   /* RZ/A1H */
+#define MAX_RATE            (192000.0)
+#define BENCH_SEC           (10u)
+
+static xfade_ctrl_t xfade_ctrl;
+
+static int32_t to_pcm(const double val)
+{
+    return (int32_t)((uint32_t)(int32_t)lrint(val * PCM_SCALE) << DEC_OUTPUT_PADDING_BITS);
+}
+
+static int32_t raw(const int32_t val)
+{
+    return val >> DEC_OUTPUT_PADDING_BITS;
+}
+
+static std::vector<int32_t> make_sine(const double freq, const double amp, const uint32_t frame_num)
+{
+    std::vector<int32_t>    buf(frame_num * XFADE_CHANNEL_NUM);
+
+    for (uint32_t i = 0u; i < frame_num; i++) {
+        buf[(i * XFADE_CHANNEL_NUM) + 0u] = to_pcm(amp * sin((2.0 * M_PI * freq * i) / TEST_RATE));
+        buf[(i * XFADE_CHANNEL_NUM) + 1u] = to_pcm(amp * cos((2.0 * M_PI * freq * i) / TEST_RATE));
+    }
+    return buf;
+}
+
+static std::vector<int32_t> make_dc(const int32_t val, const uint32_t frame_num)
+{
+    return std::vector<int32_t>(frame_num * XFADE_CHANNEL_NUM,
+                                (int32_t)((uint32_t)val << DEC_OUTPUT_PADDING_BITS));
+}
+
+/* Gain of the track which fades in at a position of the fade. */
+static double model_gain_in(const XFADE_Curve curve, const uint32_t pos, const uint32_t len)
+{
+    const double    x = (pos >= len) ? 1.0 : ((double)pos / len);
+
+    return (curve == XFADE_CURVE_EQUAL_POWER) ? sin((M_PI / 2.0) * x) : x;
+}
+
+static double model_gain_out(const XFADE_Curve curve, const uint32_t pos, const uint32_t len)
+{
+    const double    x = (pos >= len) ? 1.0 : ((double)pos / len);
+
+    return (curve == XFADE_CURVE_EQUAL_POWER) ? cos((M_PI / 2.0) * x) : (1.0 - x);
+}
+
+/* Starts a crossfade of len frames. */
+static void setup(const XFADE_Curve curve, const uint32_t len)
+{
+    xfade_init(&xfade_ctrl);
+    HOST_CHECK(xfade_set_param(&xfade_ctrl, TEST_FADE_MS, curve));
+    xfade_start(&xfade_ctrl, len);
+    HOST_CHECK(xfade_is_started(&xfade_ctrl));
+}
+
+/* Mixes in of the same length into out in calls of chunk elements, and */
+/* checks every sample against the model. Returns the largest error in LSB. */
+static double check_mix(const XFADE_Curve curve, const uint32_t len, const uint32_t chunk,
+                        const std::vector<int32_t> &out_src, const std::vector<int32_t> &in_src)
+{
+    std::vector<int32_t>    out = out_src;
+    uint32_t                gain_pos = 0u;
+    uint32_t                pos = 0u;
+    uint32_t                num;
+    double                  expect;
+    double                  tol;
+    double                  err;
+    double                  max_err = 0.0;
+    uint32_t                error_cnt = 0u;
+
+    setup(curve, len);
+    for (size_t top = 0u; top < out.size(); top += chunk) {
+        num = (uint32_t)(((out.size() - top) < chunk) ? (out.size() - top) : chunk);
+        HOST_CHECK_EQ(num, xfade_mix(&xfade_ctrl, &out[top], num, &in_src[top], num));
+        for (size_t i = top; i < (top + num); i += XFADE_CHANNEL_NUM) {
+            /* The gains are held for STEP_FRAME_NUM frames, from the top of each call, */
+            /* and move to the end gains at the end of the fade. */
+            if ((i == top) || ((pos % STEP_FRAME_NUM) == 0u) || (pos >= len)) {
+                gain_pos = pos;
+            }
+            for (uint32_t ch = 0u; ch < XFADE_CHANNEL_NUM; ch++) {
+                expect = (raw(out_src[i + ch]) * model_gain_out(curve, gain_pos, len)) +
+                         (raw(in_src[i + ch]) * model_gain_in(curve, gain_pos, len));
+                expect = fmin(fmax(expect, (double)PCM_MIN_VAL), (double)PCM_MAX_VAL);
+                /* Q15 gains, and the interpolated sine table of the equal power curve. */
+                tol = ((fabs((double)raw(out_src[i + ch])) + fabs((double)raw(in_src[i + ch]))) *
+                       ((curve == XFADE_CURVE_EQUAL_POWER) ? 1.0e-4 : 6.2e-5)) + 1.0;
+                err = fabs(raw(out[i + ch]) - expect);
+                max_err = fmax(max_err, err);
+                if (err > tol) {
+                    error_cnt++;
+                }
+            }
+            if (pos < len) {
+                pos++;
+            }
+        }
+    }
+    HOST_CHECK_EQ(0u, error_cnt);
+    return max_err;
+}
+
+static void test_curve(void)
+{
+    static const uint32_t   chunks[] = { TEST_CHUNK, 2u, 998u, 4098u };
+    const uint32_t          len = (TEST_RATE * TEST_FADE_MS) / 1000u;
+    const uint32_t          frame_num = len + 1000u;
+    const std::vector<int32_t> out_src = make_sine(440.0, 0.5, frame_num);
+    const std::vector<int32_t> in_src = make_sine(1000.0, 0.5, frame_num);
+    double                  max_err;
+
+    for (uint32_t c = 0u; c < XFADE_CURVE_NUM; c++) {
+        for (size_t n = 0u; n < (sizeof(chunks) / sizeof(chunks[0])); n++) {
+            max_err = check_mix((XFADE_Curve)c, len, chunks[n], out_src, in_src);
+            if (n == 0u) {
+                (void)printf("%-11s curve: max error %.2f LSB from the model\n",
+                             (c == XFADE_CURVE_LINEAR) ? "linear" : "equal power", max_err);
+            }
+        }
+    }
+}
+
+static void test_endpoint(void)
+{
+    const uint32_t          len = 4800u;
+    const uint32_t          frame_num = len + 100u;
+    const std::vector<int32_t> out_src = make_sine(440.0, 0.9, frame_num);
+    const std::vector<int32_t> in_src = make_sine(1000.0, 0.9, frame_num);
+    std::vector<int32_t>    out;
+
+    for (uint32_t c = 0u; c < XFADE_CURVE_NUM; c++) {
+        out = out_src;
+        setup((XFADE_Curve)c, len);
+        (void)xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &in_src[0], (uint32_t)in_src.size());
+        for (uint32_t ch = 0u; ch < XFADE_CHANNEL_NUM; ch++) {
+            HOST_CHECK_EQ(out_src[ch], out[ch]);
+        }
+        for (size_t i = len * XFADE_CHANNEL_NUM; i < out.size(); i++) {
+            HOST_CHECK_EQ(in_src[i], out[i]);
+        }
+        /* After the end the track which fades out stays muted. */
+        out = out_src;
+        (void)xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &in_src[0], (uint32_t)in_src.size());
+        HOST_CHECK(memcmp(&out[0], &in_src[0], out.size() * sizeof(int32_t)) == 0);
+    }
+}
+
+/* Measures the gains of both tracks with DC, one track at a time. */
+static void measure_gain(const XFADE_Curve curve, const uint32_t len,
+                         std::vector<double> * const p_out_gain, std::vector<double> * const p_in_gain)
+{
+    const int32_t           level = 0x400000;
+    const std::vector<int32_t> dc = make_dc(level, len);
+    const std::vector<int32_t> zero = make_dc(0, len);
+    std::vector<int32_t>    out;
+
+    p_out_gain->resize(len);
+    p_in_gain->resize(len);
+    out = dc;
+    setup(curve, len);
+    (void)xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &zero[0], (uint32_t)zero.size());
+    for (uint32_t i = 0u; i < len; i++) {
+        (*p_out_gain)[i] = (double)raw(out[i * XFADE_CHANNEL_NUM]) / level;
+    }
+    out = zero;
+    setup(curve, len);
+    (void)xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &dc[0], (uint32_t)dc.size());
+    for (uint32_t i = 0u; i < len; i++) {
+        (*p_in_gain)[i] = (double)raw(out[i * XFADE_CHANNEL_NUM]) / level;
+    }
+}
+
+static void test_sum(void)
+{
+    const uint32_t          len = (TEST_RATE * TEST_FADE_MS) / 1000u;
+    std::vector<double>     g_out;
+    std::vector<double>     g_in;
+    double                  max_dev = 0.0;
+
+    measure_gain(XFADE_CURVE_LINEAR, len, &g_out, &g_in);
+    for (uint32_t i = 0u; i < len; i++) {
+        max_dev = fmax(max_dev, fabs((g_out[i] + g_in[i]) - 1.0));
+        if (i > 0u) {
+            HOST_CHECK(g_out[i] <= g_out[i - 1u]);
+            HOST_CHECK(g_in[i] >= g_in[i - 1u]);
+        }
+    }
+    HOST_CHECK(max_dev < 1.0e-4);
+    (void)printf("linear      curve: sum of the gains 1 %+.1e\n", max_dev);
+
+    max_dev = 0.0;
+    measure_gain(XFADE_CURVE_EQUAL_POWER, len, &g_out, &g_in);
+    for (uint32_t i = 0u; i < len; i++) {
+        max_dev = fmax(max_dev, fabs(((g_out[i] * g_out[i]) + (g_in[i] * g_in[i])) - 1.0));
+        if (i > 0u) {
+            HOST_CHECK(g_out[i] <= g_out[i - 1u]);
+            HOST_CHECK(g_in[i] >= g_in[i - 1u]);
+        }
+    }
+    HOST_CHECK(max_dev < 2.0e-4);
+    (void)printf("equal power curve: sum of the powers 1 %+.1e\n", max_dev);
+}
+
+static void test_saturation(void)
+{
+    const uint32_t          len = 960u;
+    std::vector<int32_t>    out;
+    std::vector<int32_t>    in;
+    uint32_t                clip_cnt = 0u;
+
+    /* The equal power gains sum to 1.41 at the middle. */
+    out = make_dc(PCM_MAX_VAL, len);
+    in = out;
+    for (uint32_t i = 0u; i < len; i++) {
+        out[(i * XFADE_CHANNEL_NUM) + 1u] = (int32_t)((uint32_t)PCM_MIN_VAL << DEC_OUTPUT_PADDING_BITS);
+        in[(i * XFADE_CHANNEL_NUM) + 1u] = out[(i * XFADE_CHANNEL_NUM) + 1u];
+    }
+    setup(XFADE_CURVE_EQUAL_POWER, len);
+    (void)xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &in[0], (uint32_t)in.size());
+    for (uint32_t i = 0u; i < len; i++) {
+        HOST_CHECK(raw(out[i * XFADE_CHANNEL_NUM]) <= PCM_MAX_VAL);
+        HOST_CHECK(raw(out[i * XFADE_CHANNEL_NUM]) > 0);
+        HOST_CHECK(raw(out[(i * XFADE_CHANNEL_NUM) + 1u]) < 0);
+        if (raw(out[i * XFADE_CHANNEL_NUM]) == PCM_MAX_VAL) {
+            HOST_CHECK_EQ(PCM_MIN_VAL, raw(out[(i * XFADE_CHANNEL_NUM) + 1u]));
+            clip_cnt++;
+        }
+    }
+    HOST_CHECK_EQ(PCM_MAX_VAL, raw(out[(len / 2u) * XFADE_CHANNEL_NUM]));
+    HOST_CHECK(clip_cnt > (len / 2u));
+}
+
+static void test_short_tail(void)
+{
+    const uint32_t          len = 2000u;
+    const uint32_t          frame_num = 1024u;
+    const uint32_t          in_frame_num = 700u;
+    const std::vector<int32_t> out_src = make_sine(440.0, 0.5, frame_num);
+    const std::vector<int32_t> in_src = make_sine(1000.0, 0.5, frame_num);
+    std::vector<int32_t>    in = in_src;
+    std::vector<int32_t>    full;
+    std::vector<int32_t>    out;
+    std::vector<double>     g_out;
+    std::vector<double>     g_in;
+    uint32_t                error_cnt = 0u;
+
+    /* The data after in_num must not be read. */
+    for (size_t i = in_frame_num * XFADE_CHANNEL_NUM; i < in.size(); i++) {
+        in[i] = (int32_t)0x7FFFFF00;
+    }
+    out = out_src;
+    setup(XFADE_CURVE_LINEAR, len);
+    HOST_CHECK_EQ(in_frame_num * XFADE_CHANNEL_NUM,
+                  xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &in[0], in_frame_num * XFADE_CHANNEL_NUM));
+    HOST_CHECK_EQ(frame_num, xfade_ctrl.fade_pos);
+
+    /* Up to in_num, the same as the full buffer. After it, the fading out track only. */
+    full = out_src;
+    setup(XFADE_CURVE_LINEAR, len);
+    HOST_CHECK_EQ(full.size(),
+                  xfade_mix(&xfade_ctrl, &full[0], (uint32_t)full.size(), &in_src[0], (uint32_t)in_src.size()));
+    HOST_CHECK(memcmp(&out[0], &full[0], in_frame_num * XFADE_CHANNEL_NUM * sizeof(int32_t)) == 0);
+    measure_gain(XFADE_CURVE_LINEAR, len, &g_out, &g_in);
+    for (size_t i = in_frame_num * XFADE_CHANNEL_NUM; i < out.size(); i++) {
+        if (fabs(raw(out[i]) - (raw(out_src[i]) * g_out[i / XFADE_CHANNEL_NUM])) > 1.0) {
+            error_cnt++;
+        }
+    }
+    HOST_CHECK_EQ(0u, error_cnt);
+
+    /* The next call continues the fade from there to its end. */
+    out = out_src;
+    HOST_CHECK_EQ(0u, xfade_mix(&xfade_ctrl, &out[0], (uint32_t)out.size(), &in_src[0], 0u));
+    HOST_CHECK_EQ(len, xfade_ctrl.fade_pos);
+}
+
+static void bench(void)
+{
+    const std::vector<int32_t> out_src = make_sine(440.0, 0.5, TEST_CHUNK / XFADE_CHANNEL_NUM);
+    const std::vector<int32_t> in_src = make_sine(1000.0, 0.5, TEST_CHUNK / XFADE_CHANNEL_NUM);
+    std::vector<int32_t>    out = out_src;
+    const uint32_t          call_num = (TEST_RATE * BENCH_SEC * XFADE_CHANNEL_NUM) / TEST_CHUNK;
+    const double            frame_num = ((double)call_num * TEST_CHUNK) / XFADE_CHANNEL_NUM;
+    uint64_t                ns;
+    uint64_t                cycles;
+
+    for (uint32_t c = 0u; c < XFADE_CURVE_NUM; c++) {
+        /* A fade longer than the benchmark keeps the gains moving. */
+        setup((XFADE_Curve)c, (uint32_t)frame_num + 1u);
+        ns = host_time_ns();
+        cycles = host_cycles();
+        for (uint32_t i = 0u; i < call_num; i++) {
+            (void)xfade_mix(&xfade_ctrl, &out[0], TEST_CHUNK, &in_src[0], TEST_CHUNK);
+        }
+        cycles = host_cycles() - cycles;
+        ns = host_time_ns() - ns;
+        (void)printf("xfade_mix %-11s: %5.1f cycles / %4.1f ns per stereo frame, "
+                     "%.2f %% of the host CPU at 192 kHz\n",
+                     (c == XFADE_CURVE_LINEAR) ? "linear" : "equal power",
+                     (double)cycles / frame_num, (double)ns / frame_num,
+                     ((double)ns / frame_num) * MAX_RATE * 1.0e-7);
+    }
+    (void)printf("RZ/A1H budget at 192 kHz: %.0f cycles per stereo frame\n", TARGET_CPU_HZ / MAX_RATE);
+}
+
+int main(void)
+{
+    test_curve();
+    test_endpoint();
+    test_sum();
+    test_saturation();
+    test_short_tail();
+    bench();
+    return HOST_TEST_RESULT();
+}
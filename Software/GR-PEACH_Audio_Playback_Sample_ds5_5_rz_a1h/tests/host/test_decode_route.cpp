@@ -0,0 +1,204 @@
+/* Host test of the SCUX-to-SSIF direct output of the decode thread.
+ *
+ * The real dec_thread() runs on a pthread against the simulated SCUX
+ * driver (scux_sim.h) and the simulated audio out thread (player_sim.h).
+ * Each case plays a synthetic FLAC file to the end and checks that
+ *  - SSIF0 is configured as TLV320_RBSP configured it (slave, 32 bits
+ *    system word, I2S) and SCUX is routed to it before the first start,
+ *  - no configuration is requested while SCUX runs and nothing is read
+ *    from SCUX, i.e. only the SCUX driver owns SSIF0,
+ *  - the volume goes to DVU and never to the audio codec,
+ *  - the SSIF output is the decoded data, bit-exact at the native rates,
+ *    also across a pause which discards the data queued in SCUX,
+ *  - the display tap gets the data from the decode thread.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "scux_sim.h"
+#include "player_sim.h"
+
+#define TEST_CH             (2u)
+#define TEST_BLOCK          (4096u)
+
+typedef struct {
+    const char  *p_name;
+    uint32_t    rate;
+    uint32_t    bps;
+    uint32_t    frame_num;          /* FLAC frames of TEST_BLOCK samples */
+    uint32_t    pause_at;           /* Completed SCUX writes before the pause. 0 : no pause */
+    uint32_t    output_rate;        /* Expected rate of the audio codec */
+    bool        src_enable;         /* Expected SRC of SCUX */
+    bool        is_bit_exact;       /* SSIF output is the file data */
+} route_case_t;
+
+static volatile bool    open_result;
+static volatile bool    is_opened;
+static volatile bool    is_closed;
+
+static void open_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    (void)sample_freq;
+    (void)channel_num;
+    open_result = result;
+    is_opened = true;
+}
+
+static void close_callback(void)
+{
+    is_closed = true;
+}
+
+static std::vector<uint8_t> make_file(const route_case_t &tc, std::vector<int32_t> *p_pcm)
+{
+    FlacWriter      fw;
+    const uint32_t  total = TEST_BLOCK * tc.frame_num;
+    const int32_t   range = (int32_t)(1u << (tc.bps - 1u));
+
+    p_pcm->resize(total * TEST_CH);
+    srand(tc.rate);
+    for (size_t i = 0u; i < p_pcm->size(); i++) {
+        (*p_pcm)[i] = (int32_t)(rand() % (2 * range)) - range;
+    }
+    fw.streaminfo(tc.rate, TEST_CH, tc.bps, total, TEST_BLOCK, true);
+    for (uint32_t i = 0u; i < tc.frame_num; i++) {
+        fw.frame(i, &(*p_pcm)[i * TEST_BLOCK * TEST_CH], TEST_BLOCK, TEST_CH, tc.bps);
+    }
+    return fw.data();
+}
+
+/* Completes the SCUX writes one by one until the track ends. */
+/* At the end the decode thread flushes SCUX and requests the zero output. */
+static void run_output(const route_case_t &tc)
+{
+    const uint32_t      zero_out_cnt = player_sim_get_stat().zero_out_cnt;
+    scux_sim_stat_t     stat;
+    uint32_t            done_cnt = 0u;
+    uint32_t            start_cnt;
+    bool                is_stopped = false;
+
+    while (is_stopped != true) {
+        if (scux_sim_pump(1u) > 0u) {
+            done_cnt++;
+            if (done_cnt == tc.pause_at) {
+                stat = scux_sim_get_stat();
+                HOST_CHECK(dec_pause_on());
+                HOST_CHECK(player_sim_wait([&]() {
+                    return (scux_sim_get_stat().clear_stop_cnt > stat.clear_stop_cnt) &&
+                           (player_sim_get_stat().play_stat == SYS_PLAYSTAT_PAUSE);
+                }));
+                HOST_CHECK_EQ(0u, scux_sim_queued_num());
+                start_cnt = stat.trans_start_cnt;
+                HOST_CHECK(dec_pause_off());
+                HOST_CHECK(player_sim_wait([&]() {
+                    return scux_sim_get_stat().trans_start_cnt > start_cnt;
+                }));
+            }
+        } else {
+            is_stopped = (player_sim_get_stat().zero_out_cnt != zero_out_cnt);
+            (void)usleep(100u);
+        }
+    }
+}
+
+static void run_case(const route_case_t &tc)
+{
+    std::vector<int32_t>        pcm;
+    const std::vector<uint8_t>  image = make_file(tc, &pcm);
+    mem_file_t                  mf;
+    FILE                        *fp;
+    const size_t                out_top = scux_sim_ssif_out().size();
+    const player_sim_stat_t     aud_top = player_sim_get_stat();
+    scux_sim_stat_t             stat;
+    player_sim_stat_t           aud;
+    std::vector<int32_t>        out;
+    uint32_t                    mismatch = 0u;
+
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(fp != NULL);
+    is_opened = false;
+    HOST_CHECK(dec_open(fp, 0u, &open_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_opened; }));
+    HOST_CHECK(open_result);
+
+    /* SCUX is started by the open with its route and DVU already set. */
+    stat = scux_sim_get_stat();
+    HOST_CHECK(stat.is_started);
+    HOST_CHECK_EQ(SCUX_ROUTE_SRC0_SSIF0, stat.route);
+    HOST_CHECK_EQ(tc.src_enable, stat.src_cfg.src_enable);
+    HOST_CHECK_EQ(tc.output_rate, stat.src_cfg.output_rate);
+    HOST_CHECK(stat.is_dvu_set);
+    HOST_CHECK(stat.dvu_cfg.ramp_vol_enable);
+
+    HOST_CHECK(dec_play());
+    run_output(tc);
+    is_closed = false;
+    HOST_CHECK(dec_close(&close_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_closed; }));
+    (void)fclose(fp);
+
+    stat = scux_sim_get_stat();
+    aud = player_sim_get_stat();
+    HOST_CHECK_EQ(0u, stat.cfg_reject_cnt);
+    HOST_CHECK_EQ(0u, stat.read_cnt);
+    HOST_CHECK_EQ(0u, aud.set_volume_cnt);
+    HOST_CHECK_EQ(tc.output_rate, aud.data_out_freq);
+    HOST_CHECK_EQ(aud_top.zero_out_cnt + 1u, aud.zero_out_cnt);
+
+    out = scux_sim_ssif_out();
+    out.erase(out.begin(), out.begin() + out_top);
+    if (tc.is_bit_exact == true) {
+        HOST_CHECK_EQ(pcm.size(), out.size());
+        for (size_t i = 0u; (i < pcm.size()) && (i < out.size()); i++) {
+            /* Left aligned to 32 bits: 24 bits data with 8 bits padding. */
+            if (out[i] != (int32_t)((uint32_t)pcm[i] << (32u - tc.bps))) {
+                mismatch++;
+            }
+        }
+        HOST_CHECK_EQ(0u, mismatch);
+    } else {
+        /* Decimated by 2 in software before SCUX. */
+        HOST_CHECK_EQ(pcm.size() / 2u, out.size());
+    }
+    /* Every buffer written to SCUX went to the display tap too. */
+    HOST_CHECK((aud.tap_sample_cnt - aud_top.tap_sample_cnt) >= out.size());
+    (void)printf("%-24s %6u Hz %2u bit: %7u frames out, %3u writes, %2u cancelled\n",
+                 tc.p_name, (unsigned)tc.rate, (unsigned)tc.bps, (unsigned)(out.size() / TEST_CH),
+                 (unsigned)stat.write_cnt, (unsigned)stat.cancel_cnt);
+}
+
+int main(void)
+{
+    static const route_case_t cases[] = {
+        { "44.1k native",           44100u, 16u, 40u,  0u, 44100u, false, true  },
+        { "48k native, pause",      48000u, 24u, 40u, 10u, 48000u, false, true  },
+        { "32k by SCUX SRC",        32000u, 16u, 20u,  0u, 96000u, true,  true  },
+        { "192k decimated",        192000u, 24u, 40u,  0u, 96000u, false, false },
+    };
+    scux_sim_stat_t stat;
+
+    scux_sim_reset();
+    player_sim_start();
+
+    /* The decode thread routes SCUX to SSIF0 at its start, before any track. */
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_get_stat().is_route_set; }));
+    stat = scux_sim_get_stat();
+    HOST_CHECK(stat.is_ssif_set);
+    HOST_CHECK_EQ(SCUX_SSIF_CH_0, stat.ssif_cfg.ssif_ch_num);
+    HOST_CHECK(!stat.ssif_cfg.mode_master);
+    HOST_CHECK(!stat.ssif_cfg.select_audio_clk);
+    HOST_CHECK_EQ(SCUX_SSIF_SYSTEM_LEN_32, stat.ssif_cfg.system_word);
+    HOST_CHECK(stat.ssif_cfg.serial_data_align);
+    HOST_CHECK(stat.ssif_cfg.ws_delay);
+    HOST_CHECK(!stat.ssif_cfg.use_tdm);
+    HOST_CHECK_EQ(SCUX_ROUTE_SRC0_SSIF0, stat.route);
+    HOST_CHECK(!stat.is_started);
+
+    for (size_t i = 0u; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        run_case(cases[i]);
+    }
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,337 @@
+/* Host model of the transport latency of the decode thread: pause, resume and stop.
+ *
+ * The real dec_thread() plays a synthetic FLAC file (44.1 kHz, 4096 samples
+ * per block) against the simulated SCUX driver (scux_sim.h). The test
+ * completes the SCUX writes one by one as the DMA would, and presses the
+ * keys after the completed writes of pause_at[].
+ *  - Pause: the audio output is muted and the SCUX queue is cancelled at
+ *    once, and no data is output after the key. The buffer being output
+ *    at the key has output TEST_CANCEL_PART_FRAME frames of it, and the
+ *    results of the cancelled writes come after the pause, like from the
+ *    DMA interrupt. The position notified again with them is the output
+ *    position, including that part.
+ *  - Resume: the first buffer output after the resume is the data at the
+ *    output position, so the SSIF output of the whole run is the file data
+ *    without a skip or a repeat.
+ *  - Stop: muted and cancelled at once like the pause.
+ *  - Open at a position, as the main thread resumes the track of the
+ *    journal: the first data output is the data at that sample, also in
+ *    the middle of a FLAC frame, and the position notified with the
+ *    pause counts from the top of the track.
+ * For each key the test prints the data queued in SCUX at the key, which
+ * the pause played out before the silence when it waited for the queue,
+ * the time from the key to the mute request, and the times from the
+ * resume key to the first SCUX write and to the full queue. The times are
+ * the ones of the decode thread on the host; the 50 ms debounce of SW0
+ * and the SSIF FIFO of the target are not included. The key to silence
+ * (mute request) must be within TEST_SILENCE_TARGET_MS, and the key to
+ * sound (first SCUX write after the resume) within TEST_SOUND_TARGET_MS,
+ * a unit of PCM data processing of decode.cpp.
+ */
+#include <stdlib.h>
+#include <sched.h>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "scux_sim.h"
+#include "player_sim.h"
+
+#define TEST_RATE           (44100u)
+#define TEST_BPS            (16u)
+#define TEST_CH             (2u)
+#define TEST_BLOCK          (4096u)
+#define TEST_FRAME_NUM      (160u)
+#define TEST_QUEUE_NUM      (3u)        /* SCUX writes in flight: PCM_BUF_NUM of decode.cpp */
+#define TEST_FRAME_BYTE     (TEST_CH * sizeof(int32_t))
+#define TEST_TIMEOUT_NS     (5000000000uLL)
+#define TEST_CANCEL_PART_FRAME  (1000u) /* Output part of the buffer cancelled by ClearStop() */
+#define TEST_SILENCE_TARGET_MS  (20u)   /* Key to the mute request */
+#define TEST_SOUND_TARGET_MS    (50u)   /* Key to the first write after the resume */
+#define TEST_MS_TO_NS           (1000000)
+
+static const uint32_t   pause_at[] = { 1u, 2u, 3u, 5u, 8u, 13u };
+static const uint32_t   start_at[] = { (TEST_BLOCK * 5u) + 1234u, (TEST_BLOCK * TEST_FRAME_NUM) / 2u };
+
+static volatile bool    open_result;
+static volatile bool    is_opened;
+static volatile bool    is_closed;
+
+static void open_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    (void)sample_freq;
+    (void)channel_num;
+    open_result = result;
+    is_opened = true;
+}
+
+static void close_callback(void)
+{
+    is_closed = true;
+}
+
+static std::vector<uint8_t> make_file(std::vector<int32_t> * const p_pcm)
+{
+    FlacWriter      fw;
+    const uint32_t  total = TEST_BLOCK * TEST_FRAME_NUM;
+    const int32_t   range = (int32_t)(1u << (TEST_BPS - 1u));
+
+    p_pcm->resize(total * TEST_CH);
+    srand(TEST_RATE);
+    for (size_t i = 0u; i < p_pcm->size(); i++) {
+        (*p_pcm)[i] = (int32_t)(rand() % (2 * range)) - range;
+    }
+    fw.streaminfo(TEST_RATE, TEST_CH, TEST_BPS, total, TEST_BLOCK, true);
+    for (uint32_t i = 0u; i < TEST_FRAME_NUM; i++) {
+        fw.frame(i, &(*p_pcm)[i * TEST_BLOCK * TEST_CH], TEST_BLOCK, TEST_CH, TEST_BPS);
+    }
+    return fw.data();
+}
+
+/* Spins until cond is true, so that the time is not rounded by a poll */
+/* period. Returns the time in ns from top, or TEST_TIMEOUT_NS or more on */
+/* the timeout. */
+template<typename F>
+static uint64_t wait_ns(const uint64_t top, F cond)
+{
+    uint64_t        ns = host_time_ns() - top;
+
+    while ((cond() != true) && (ns < TEST_TIMEOUT_NS)) {
+        (void)sched_yield();
+        ns = host_time_ns() - top;
+    }
+    return ns;
+}
+
+/* Completes num SCUX writes, waiting for the decode thread to queue them. */
+static void pump(const uint32_t num)
+{
+    for (uint32_t i = 0u; i < num; i++) {
+        HOST_CHECK(player_sim_wait([]() { return scux_sim_get_stat().write_cnt > 0u; }));
+        HOST_CHECK(player_sim_wait([]() { return scux_sim_pump(1u) > 0u; }));
+    }
+}
+
+static uint32_t out_frame_num(const size_t out_top)
+{
+    return (uint32_t)((scux_sim_ssif_out().size() - out_top) / TEST_CH);
+}
+
+/* Waits for the results of the writes cancelled by ClearStop(). */
+static void wait_cancel_fin(void)
+{
+    HOST_CHECK(player_sim_wait([]() {
+        const scux_sim_stat_t   stat = scux_sim_get_stat();
+
+        return stat.cancel_fin_cnt == stat.cancel_cnt;
+    }));
+}
+
+/* Presses the pause key in the steady state and checks the silence. */
+/* Returns the output position. */
+static uint32_t pause_key(const size_t out_top)
+{
+    const uint32_t      out_num = out_frame_num(out_top);
+    scux_sim_stat_t     stat;
+    player_sim_stat_t   aud;
+    uint32_t            queued_byte;
+    uint64_t            top;
+    uint64_t            mute_ns;
+
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_queued_num() == TEST_QUEUE_NUM; }));
+    queued_byte = scux_sim_queued_byte();
+    stat = scux_sim_get_stat();
+    aud = player_sim_get_stat();
+
+    top = host_time_ns();
+    HOST_CHECK(dec_pause_on());
+    mute_ns = wait_ns(top, [&]() { return player_sim_get_stat().mute_out_cnt > aud.mute_out_cnt; });
+    HOST_CHECK(mute_ns <= ((uint64_t)TEST_SILENCE_TARGET_MS * TEST_MS_TO_NS));
+    HOST_CHECK(player_sim_wait([&]() {
+        return (scux_sim_get_stat().clear_stop_cnt > stat.clear_stop_cnt) &&
+               (player_sim_get_stat().play_stat == SYS_PLAYSTAT_PAUSE);
+    }));
+
+    /* Nothing is left to output but the part of the first buffer, and the */
+    /* position notified with the results of the cancel is the output one. */
+    wait_cancel_fin();
+    HOST_CHECK_EQ(0u, scux_sim_queued_num());
+    HOST_CHECK_EQ(0u, scux_sim_pump(1u));
+    HOST_CHECK_EQ(out_num + TEST_CANCEL_PART_FRAME, out_frame_num(out_top));
+    HOST_CHECK_EQ(stat.cancel_cnt + TEST_QUEUE_NUM, scux_sim_get_stat().cancel_cnt);
+    HOST_CHECK(player_sim_wait([=]() {
+        return player_sim_get_stat().play_sample == (out_num + TEST_CANCEL_PART_FRAME);
+    }));
+
+    (void)printf("pause at %6u frames: %3u ms queued (old pause played it), mute %7.1f us after the key\n",
+                 (unsigned)out_num, (unsigned)(((queued_byte / TEST_FRAME_BYTE) * 1000u) / TEST_RATE),
+                 (double)mute_ns / 1000.0);
+    return out_num + TEST_CANCEL_PART_FRAME;
+}
+
+/* Presses the pause key again and checks the restart of the output. */
+static void resume_key(void)
+{
+    const uint32_t          start_cnt = scux_sim_get_stat().trans_start_cnt;
+    const uint64_t          top = host_time_ns();
+    scux_sim_stat_t         stat;
+    int64_t                 first_ns;
+    int64_t                 full_ns;
+
+    HOST_CHECK(dec_pause_off());
+    /* start_write_cnt still counts the writes before the pause until TransStart(). */
+    HOST_CHECK(wait_ns(top, [=]() {
+        const scux_sim_stat_t   cur = scux_sim_get_stat();
+
+        return (cur.trans_start_cnt > start_cnt) && (cur.start_write_cnt >= TEST_QUEUE_NUM);
+    }) < TEST_TIMEOUT_NS);
+    /* The times of the writes are taken by the simulated driver, as the */
+    /* decode thread may write them all before this thread runs again. */
+    stat = scux_sim_get_stat();
+    first_ns = (int64_t)(stat.first_write_ns - top);
+    full_ns = (int64_t)(stat.last_write_ns - top);
+    HOST_CHECK(player_sim_wait([]() { return player_sim_get_stat().play_stat == SYS_PLAYSTAT_PLAY; }));
+    HOST_CHECK_EQ(start_cnt + 1u, stat.trans_start_cnt);
+    HOST_CHECK((first_ns >= 0) && (first_ns <= ((int64_t)TEST_SOUND_TARGET_MS * TEST_MS_TO_NS)));
+
+    (void)printf("          resume: first write %7.1f us, %u writes %7.1f us after the key\n",
+                 (double)first_ns / 1000.0, TEST_QUEUE_NUM, (double)full_ns / 1000.0);
+}
+
+static void stop_key(const size_t out_top)
+{
+    const uint32_t          out_num = out_frame_num(out_top);
+    scux_sim_stat_t         stat;
+    player_sim_stat_t       aud;
+    uint64_t                top;
+    uint64_t                mute_ns;
+
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_queued_num() == TEST_QUEUE_NUM; }));
+    stat = scux_sim_get_stat();
+    aud = player_sim_get_stat();
+    top = host_time_ns();
+    HOST_CHECK(dec_stop());
+    mute_ns = wait_ns(top, [&]() { return player_sim_get_stat().mute_out_cnt > aud.mute_out_cnt; });
+    HOST_CHECK(mute_ns <= ((uint64_t)TEST_SILENCE_TARGET_MS * TEST_MS_TO_NS));
+    HOST_CHECK(player_sim_wait([&]() {
+        return (scux_sim_get_stat().clear_stop_cnt > stat.clear_stop_cnt) &&
+               (player_sim_get_stat().play_stat == SYS_PLAYSTAT_STOP);
+    }));
+    wait_cancel_fin();
+    HOST_CHECK_EQ(0u, scux_sim_queued_num());
+    HOST_CHECK_EQ(0u, scux_sim_pump(1u));
+    HOST_CHECK_EQ(out_num + TEST_CANCEL_PART_FRAME, out_frame_num(out_top));
+    (void)printf("stop  at %6u frames: mute %7.1f us after the key\n",
+                 (unsigned)out_num, (double)mute_ns / 1000.0);
+}
+
+/* Opens the file at the start position, plays, pauses and stops it. */
+static void open_at(const std::vector<uint8_t> &image, const std::vector<int32_t> &pcm, const uint32_t start)
+{
+    mem_file_t              mf;
+    FILE                    *fp;
+    std::vector<int32_t>    out;
+    const size_t            out_top = scux_sim_ssif_out().size();
+    uint32_t                mismatch = 0u;
+    size_t                  num;
+
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(fp != NULL);
+    is_opened = false;
+    HOST_CHECK(dec_open(fp, start, &open_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_opened; }));
+    HOST_CHECK(open_result);
+    HOST_CHECK(dec_play());
+    HOST_CHECK(player_sim_wait([]() { return player_sim_get_stat().play_stat == SYS_PLAYSTAT_PLAY; }));
+    pump(2u);
+    /* The pause notifies the output position from the top of the track. */
+    HOST_CHECK(dec_pause_on());
+    HOST_CHECK(player_sim_wait([]() { return player_sim_get_stat().play_stat == SYS_PLAYSTAT_PAUSE; }));
+    wait_cancel_fin();
+
+    out = scux_sim_ssif_out();
+    out.erase(out.begin(), out.begin() + out_top);
+    num = out.size() / TEST_CH;
+    HOST_CHECK((num > 0u) && ((start + num) <= (pcm.size() / TEST_CH)));
+    for (size_t i = 0u; (i < out.size()) && (((start * TEST_CH) + i) < pcm.size()); i++) {
+        if (out[i] != (int32_t)((uint32_t)pcm[(start * TEST_CH) + i] << (32u - TEST_BPS))) {
+            mismatch++;
+        }
+    }
+    HOST_CHECK_EQ(0u, mismatch);
+    HOST_CHECK(player_sim_wait([=]() { return player_sim_get_stat().play_sample == (start + num); }));
+    (void)printf("open  at %6u samples: %u frames output from that sample, %u mismatches\n",
+                 (unsigned)start, (unsigned)num, (unsigned)mismatch);
+    HOST_CHECK(dec_stop());
+    HOST_CHECK(player_sim_wait([]() { return player_sim_get_stat().play_stat == SYS_PLAYSTAT_STOP; }));
+
+    is_closed = false;
+    HOST_CHECK(dec_close(&close_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_closed; }));
+    (void)fclose(fp);
+}
+
+int main(void)
+{
+    std::vector<int32_t>        pcm;
+    const std::vector<uint8_t>  image = make_file(&pcm);
+    mem_file_t                  mf;
+    FILE                        *fp;
+    std::vector<int32_t>        out;
+    uint32_t                    mismatch = 0u;
+    uint32_t                    pos;
+    size_t                      out_top;
+
+    scux_sim_reset();
+    scux_sim_set_cancel_part(TEST_CANCEL_PART_FRAME * TEST_FRAME_BYTE);
+    player_sim_start();
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_get_stat().is_route_set; }));
+
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(fp != NULL);
+    out_top = scux_sim_ssif_out().size();
+    is_opened = false;
+    HOST_CHECK(dec_open(fp, 0u, &open_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_opened; }));
+    HOST_CHECK(open_result);
+    HOST_CHECK(dec_play());
+
+    for (size_t i = 0u; i < (sizeof(pause_at) / sizeof(pause_at[0])); i++) {
+        pump(pause_at[i]);
+        pos = pause_key(out_top);
+        resume_key();
+        /* The first buffer after the resume starts at the output position. */
+        pump(1u);
+        out = scux_sim_ssif_out();
+        HOST_CHECK(out.size() > (out_top + (pos * TEST_CH)));
+        if (out.size() > (out_top + (pos * TEST_CH))) {
+            HOST_CHECK_EQ((int32_t)((uint32_t)pcm[pos * TEST_CH] << (32u - TEST_BPS)), out[out_top + (pos * TEST_CH)]);
+        }
+    }
+    pump(2u);
+    stop_key(out_top);
+
+    is_closed = false;
+    HOST_CHECK(dec_close(&close_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_closed; }));
+    (void)fclose(fp);
+
+    /* The output of the whole run is the file data from its start. */
+    out = scux_sim_ssif_out();
+    out.erase(out.begin(), out.begin() + out_top);
+    HOST_CHECK(out.size() <= pcm.size());
+    for (size_t i = 0u; (i < out.size()) && (i < pcm.size()); i++) {
+        if (out[i] != (int32_t)((uint32_t)pcm[i] << (32u - TEST_BPS))) {
+            mismatch++;
+        }
+    }
+    HOST_CHECK_EQ(0u, mismatch);
+    (void)printf("%u frames output across %u pauses, %u mismatches\n", (unsigned)(out.size() / TEST_CH),
+                 (unsigned)(sizeof(pause_at) / sizeof(pause_at[0])), (unsigned)mismatch);
+
+    for (size_t i = 0u; i < (sizeof(start_at) / sizeof(start_at[0])); i++) {
+        open_at(image, pcm, start_at[i]);
+    }
+    return HOST_TEST_RESULT();
+}
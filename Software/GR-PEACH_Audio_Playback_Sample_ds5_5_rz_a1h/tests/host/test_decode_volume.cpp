@@ -0,0 +1,247 @@
+/* Host test of the volume of the decode thread on the SCUX DVU.
+ *
+ * The real dec_thread() plays a constant level through the simulated SCUX
+ * driver, whose DVU model (scux_sim.h) applies the digital volume and the
+ * ramp volume to the SSIF output. The level of every output frame is the
+ * gain of DVU at that frame, so the ramp timing is read from the output:
+ *  - ReplayGain of the file is applied by the digital volume from the
+ *    first frame,
+ *  - dec_set_volume() ramps 0.125 dB per 8 frames (1 dB per 64 frames)
+ *    from the frame after the request, monotonically, and settles exactly,
+ *  - the mute ramps down to silence and the unmute ramps up to 0 dB at
+ *    the same rate, without any step larger than 0.125 dB.
+ */
+#include <math.h>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "scux_sim.h"
+#include "player_sim.h"
+
+#define TEST_RATE           (48000u)
+#define TEST_CH             (2u)
+#define TEST_BPS            (24u)
+#define TEST_BLOCK          (4096u)
+#define TEST_FRAME_NUM      (60u)           /* FLAC frames of TEST_BLOCK samples */
+#define TEST_LEVEL          (0x200000)      /* -12 dBFS */
+#define RAMP_FRAME_PER_UNIT (8u)            /* SCUX_DVU_TIME_0_125DB_8STEP */
+#define UNIT_PER_DB         (8.0)           /* DVU_RAMP_VOL_PER_DB */
+#define FLAC_TYPE_VORBIS_COMMENT (4u)
+
+typedef struct {
+    size_t      pos;            /* Output frame from which the change applies */
+    int32_t     volume;
+    bool        mute;
+} vol_step_t;
+
+static volatile bool    is_opened;
+static volatile bool    open_result;
+static volatile bool    is_closed;
+
+static void open_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    (void)sample_freq;
+    (void)channel_num;
+    open_result = result;
+    is_opened = true;
+}
+
+static void close_callback(void)
+{
+    is_closed = true;
+}
+
+static std::vector<uint8_t> make_file(const char * const p_gain)
+{
+    FlacWriter              fw;
+    std::vector<int32_t>    pcm(TEST_BLOCK * TEST_CH);
+    std::vector<std::string> tags;
+
+    for (size_t i = 0u; i < pcm.size(); i += TEST_CH) {
+        pcm[i] = TEST_LEVEL;
+        pcm[i + 1u] = -TEST_LEVEL;
+    }
+    fw.streaminfo(TEST_RATE, TEST_CH, TEST_BPS, TEST_BLOCK * TEST_FRAME_NUM, TEST_BLOCK, false);
+    tags.push_back(std::string("REPLAYGAIN_TRACK_GAIN=") + p_gain);
+    fw.block(FLAC_TYPE_VORBIS_COMMENT, FlacWriter::vorbis_comment(tags), true);
+    for (uint32_t i = 0u; i < TEST_FRAME_NUM; i++) {
+        fw.frame(i, &pcm[0], TEST_BLOCK, TEST_CH, TEST_BPS);
+    }
+    return fw.data();
+}
+
+/* Level of a ramp volume in ramp units (0.125 dB). DVU_RAMP_VOL_MUTE is silence. */
+static double unit_to_level(const double unit, const double ref)
+{
+    return (unit >= DVU_RAMP_VOL_MUTE) ? 0.0 : (ref * pow(10.0, -(unit / UNIT_PER_DB) / 20.0));
+}
+
+/* Completes num SCUX writes, waiting for the decode thread to queue them. */
+static void pump(const uint32_t num)
+{
+    uint32_t    done_cnt = 0u;
+
+    HOST_CHECK(player_sim_wait([&]() {
+        done_cnt += scux_sim_pump(num - done_cnt);
+        return done_cnt >= num;
+    }));
+}
+
+/* Sets the volume at the current end of the output, and waits for DVU to get it. */
+static size_t set_volume(const int32_t volume, const bool mute)
+{
+    const uint32_t  set_cnt = scux_sim_get_stat().ramp_set_cnt;
+
+    HOST_CHECK(dec_set_volume(volume, mute));
+    HOST_CHECK(player_sim_wait([&]() { return scux_sim_get_stat().ramp_set_cnt > set_cnt; }));
+    return scux_sim_ssif_out().size() / TEST_CH;
+}
+
+/* Checks the ramp of channel ch from step.pos to target_unit in the output. */
+/* Returns the number of frames until the target level is reached. */
+static size_t check_ramp(const std::vector<int32_t> &out, const uint32_t ch, const double ref,
+                         const vol_step_t &step, const double from_unit, const double target_unit,
+                         const size_t end)
+{
+    const double    dir = (target_unit > from_unit) ? 1.0 : -1.0;
+    const double    target_val = nearbyint(unit_to_level(target_unit, ref));
+    double          val;
+    double          prev = fabs((double)(out[((step.pos - 1u) * TEST_CH) + ch] >> 8));
+    double          expect;
+    size_t          reach = 0u;
+    uint32_t        error_cnt = 0u;
+
+    for (size_t i = step.pos; i < end; i++) {
+        /* The DVU steps after each frame, so the first frame is still at from_unit. */
+        expect = from_unit + (dir * (double)((i - step.pos) / RAMP_FRAME_PER_UNIT));
+        if (((dir > 0.0) && (expect > target_unit)) || ((dir < 0.0) && (expect < target_unit))) {
+            expect = target_unit;
+        }
+        val = fabs((double)(out[(i * TEST_CH) + ch] >> 8));
+        /* Within the rounding of the 24 bits data. */
+        if (fabs(val - unit_to_level(expect, ref)) > 0.51) {
+            error_cnt++;
+        }
+        /* Monotonic, and at most 0.125 dB per frame with the rounding. */
+        if ((((val - prev) * dir) > 0.0) ||
+            (fabs(val - prev) > ((fmax(val, prev) * (1.0 - unit_to_level(1.0, 1.0))) + 1.0))) {
+            error_cnt++;
+        }
+        if ((reach == 0u) && (val == target_val)) {
+            reach = i - step.pos;
+        }
+        prev = val;
+    }
+    HOST_CHECK_EQ(0u, error_cnt);
+    return reach;
+}
+
+int main(void)
+{
+    const std::vector<uint8_t>  image = make_file("-6.02 dB");
+    mem_file_t                  mf;
+    FILE                        *fp;
+    scux_sim_stat_t             stat;
+    std::vector<int32_t>        out;
+    vol_step_t                  steps[4];
+    double                      ref;
+    double                      from_unit;
+    double                      target_unit;
+    size_t                      end;
+    size_t                      reach;
+    uint32_t                    zero_out_cnt;
+    uint32_t                    dvu_stat;
+
+    scux_sim_reset();
+    player_sim_start();
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_get_stat().is_route_set; }));
+
+    fp = mem_file_open(&mf, image);
+    HOST_CHECK(fp != NULL);
+    HOST_CHECK(dec_open(fp, 0u, &open_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_opened; }));
+    HOST_CHECK(open_result);
+
+    /* ReplayGain goes to the digital volume, the volume to the ramp. */
+    stat = scux_sim_get_stat();
+    HOST_CHECK(stat.dvu_cfg.dvu_enable);
+    HOST_CHECK(stat.dvu_cfg.digi_vol_enable);
+    HOST_CHECK(fabs(((double)stat.dvu_cfg.digi_vol[0] / DVU_DIGI_VOL_0DB) - 0.5) < 0.001);
+    ref = ((double)TEST_LEVEL * stat.dvu_cfg.digi_vol[0]) / DVU_DIGI_VOL_0DB;
+    HOST_CHECK_EQ(stat.dvu_cfg.digi_vol[0], stat.dvu_cfg.digi_vol[1]);
+    HOST_CHECK(stat.dvu_cfg.ramp_vol_enable);
+    HOST_CHECK_EQ(DVU_RAMP_VOL_0DB, stat.dvu_cfg.ramp_vol);
+    HOST_CHECK_EQ(SCUX_DVU_TIME_0_125DB_8STEP, stat.dvu_cfg.up_period);
+    HOST_CHECK_EQ(SCUX_DVU_TIME_0_125DB_8STEP, stat.dvu_cfg.down_period);
+
+    zero_out_cnt = player_sim_get_stat().zero_out_cnt;
+    HOST_CHECK(dec_play());
+    pump(2u);
+
+    steps[0].volume = -20;
+    steps[0].mute = false;
+    steps[0].pos = set_volume(steps[0].volume, steps[0].mute);
+    HOST_CHECK_EQ(20u * DVU_RAMP_VOL_PER_DB, scux_sim_get_stat().dvu_cfg.ramp_vol);
+    pump(4u);
+    HOST_CHECK(R_BSP_Scux(SCUX_CH_0, 0u, 0, 0).GetDvuStat(&dvu_stat));
+    HOST_CHECK_EQ(SCUX_DVU_STAT_RAMP_FIXED, dvu_stat);
+
+    steps[1].volume = -20;
+    steps[1].mute = true;
+    steps[1].pos = set_volume(steps[1].volume, steps[1].mute);
+    HOST_CHECK_EQ(DVU_RAMP_VOL_MUTE, scux_sim_get_stat().dvu_cfg.ramp_vol);
+    pump(6u);
+    HOST_CHECK(R_BSP_Scux(SCUX_CH_0, 0u, 0, 0).GetDvuStat(&dvu_stat));
+    HOST_CHECK_EQ(SCUX_DVU_STAT_MUTE, dvu_stat);
+
+    steps[2].volume = 0;
+    steps[2].mute = false;
+    steps[2].pos = set_volume(steps[2].volume, steps[2].mute);
+    HOST_CHECK_EQ(DVU_RAMP_VOL_0DB, scux_sim_get_stat().dvu_cfg.ramp_vol);
+    pump(6u);
+    HOST_CHECK(R_BSP_Scux(SCUX_CH_0, 0u, 0, 0).GetDvuStat(&dvu_stat));
+    HOST_CHECK_EQ(SCUX_DVU_STAT_ORIGINAL_SIZE, dvu_stat);
+    steps[3].pos = scux_sim_ssif_out().size() / TEST_CH;
+
+    /* Plays to the end. */
+    HOST_CHECK(player_sim_wait([&]() {
+        (void)scux_sim_pump(1u);
+        return player_sim_get_stat().zero_out_cnt != zero_out_cnt;
+    }));
+    HOST_CHECK(dec_close(&close_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_closed; }));
+    (void)fclose(fp);
+
+    out = scux_sim_ssif_out();
+    HOST_CHECK_EQ((size_t)TEST_BLOCK * TEST_FRAME_NUM * TEST_CH, out.size());
+    /* Before the first change : ReplayGain only. */
+    HOST_CHECK(steps[0].pos > 0u);
+    for (size_t i = 0u; i < steps[0].pos; i++) {
+        HOST_CHECK_EQ((int32_t)nearbyint(ref), out[i * TEST_CH] >> 8);
+        HOST_CHECK_EQ((int32_t)nearbyint(-ref), out[(i * TEST_CH) + 1u] >> 8);
+    }
+    from_unit = 0.0;
+    for (uint32_t s = 0u; s < 3u; s++) {
+        target_unit = steps[s].mute ? (double)DVU_RAMP_VOL_MUTE : (-steps[s].volume * UNIT_PER_DB);
+        end = steps[s + 1u].pos;
+        for (uint32_t ch = 0u; ch < TEST_CH; ch++) {
+            reach = check_ramp(out, ch, ref, steps[s], from_unit, target_unit, end);
+            HOST_CHECK(reach > 0u);
+            /* The ramp takes 8 frames per 0.125 dB. */
+            HOST_CHECK(reach <= (size_t)(fabs(target_unit - from_unit) * RAMP_FRAME_PER_UNIT));
+        }
+        (void)printf("%-26s at frame %6u: %5u frames (%5.1f ms) to %s\n",
+                     (s == 0u) ? "volume 0 dB -> -20 dB" : ((s == 1u) ? "mute at -20 dB" : "unmute to 0 dB"),
+                     (unsigned)steps[s].pos, (unsigned)reach, (reach * 1000.0) / TEST_RATE,
+                     steps[s].mute ? "silence" : "the target");
+        from_unit = target_unit;
+    }
+    /* After the ramps : the ReplayGain level again. */
+    for (size_t i = steps[3].pos; i < (out.size() / TEST_CH); i++) {
+        HOST_CHECK_EQ((int32_t)nearbyint(ref), out[i * TEST_CH] >> 8);
+    }
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,238 @@
+/* Host model of the load of the decode thread through a crossfade.
+ *
+ * The real dec_thread() plays two synthetic FLAC files (192 kHz, 24 bits,
+ * stereo, 4096 samples per block) with a crossfade of TEST_XFADE_MS
+ * between them, against the simulated SCUX driver (scux_sim.h). 192 kHz
+ * is the heaviest path of decode.cpp: the data is decimated by 2 in
+ * software before SCUX, and in the crossfade both tracks are decoded and
+ * decimated for each buffer. The test completes the SCUX writes in real
+ * time, as the DMA outputs them at DEC_SCUX_MAX_SAMPLE_RATE: each buffer
+ * is completed when the one before it has been output. For each completed
+ * buffer, the decode thread decodes and writes the next one; the CPU time
+ * of the decode thread from the completion to that write is its time per
+ * output buffer. The test prints the buffers out of the crossfade and in
+ * it, with their mean and maximum time against the length of a buffer,
+ * and the underruns: completions which leave the SCUX queue empty before
+ * the end of the second track. The checks are:
+ *  - no underrun through the whole run;
+ *  - the crossfade is reached, and the second track starts and plays to
+ *    its end (SYS_PLAYSTAT_STOP after the flush);
+ *  - the maximum time per buffer, in and out of the crossfade, is less
+ *    than the length of a buffer.
+ * The FLAC frames are VERBATIM, which decode faster than the LPC frames
+ * of a real file, so the times are a lower bound of the decode load; the
+ * margin of the crossfade against the other buffers is the point.
+ */
+#include <stdlib.h>
+#include <sched.h>
+#include <vector>
+#include "host_test.h"
+#include "flac_writer.h"
+#include "mem_file.h"
+#include "decode.h"
+#include "scux_sim.h"
+#include "player_sim.h"
+
+#define TEST_RATE           (192000u)
+#define TEST_BPS            (24u)
+#define TEST_CH             (2u)
+#define TEST_BLOCK          (4096u)
+#define TEST_FRAME_NUM      (141u)      /* About 3 s */
+#define TEST_XFADE_MS       (2000u)
+#define TEST_QUEUE_NUM      (3u)        /* SCUX writes in flight: PCM_BUF_NUM of decode.cpp */
+#define TEST_SCUX_RATE      (DEC_SCUX_MAX_SAMPLE_RATE)
+#define TEST_FRAME_BYTE     (TEST_CH * sizeof(int32_t))
+#define TEST_TIMEOUT_NS     (20000000000uLL)
+#define TEST_NS_PER_MS      (1000000u)
+
+typedef struct {
+    uint32_t    buf_num;
+    uint64_t    sum_ns;
+    uint64_t    max_ns;
+    uint64_t    budget_ns;              /* Length of the shortest buffer */
+} load_t;
+
+static volatile bool    is_opened;
+static volatile bool    is_next_opened;
+static volatile bool    is_next_started;
+static volatile bool    is_closed;
+
+static void open_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    (void)sample_freq;
+    (void)channel_num;
+    HOST_CHECK(result);
+    is_opened = true;
+}
+
+static void next_open_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    (void)sample_freq;
+    (void)channel_num;
+    HOST_CHECK(result);
+    is_next_opened = true;
+}
+
+static void next_start_callback(const bool result, const uint32_t sample_freq, const uint32_t channel_num)
+{
+    HOST_CHECK(result);
+    HOST_CHECK_EQ(TEST_RATE, sample_freq);
+    HOST_CHECK_EQ(TEST_CH, channel_num);
+    is_next_started = true;
+}
+
+static void close_callback(void)
+{
+    is_closed = true;
+}
+
+static std::vector<uint8_t> make_file(const uint32_t seed)
+{
+    FlacWriter              fw;
+    const uint32_t          total = TEST_BLOCK * TEST_FRAME_NUM;
+    const int32_t           range = (int32_t)(1u << (TEST_BPS - 1u));
+    std::vector<int32_t>    pcm(total * TEST_CH);
+
+    srand(seed);
+    for (size_t i = 0u; i < pcm.size(); i++) {
+        pcm[i] = (int32_t)(rand() % (2 * range)) - range;
+    }
+    fw.streaminfo(TEST_RATE, TEST_CH, TEST_BPS, total, TEST_BLOCK, true);
+    for (uint32_t i = 0u; i < TEST_FRAME_NUM; i++) {
+        fw.frame(i, &pcm[i * TEST_BLOCK * TEST_CH], TEST_BLOCK, TEST_CH, TEST_BPS);
+    }
+    return fw.data();
+}
+
+/* Output time of a buffer of byte bytes at the rate of SCUX input. */
+static uint64_t buf_ns(const uint32_t byte)
+{
+    return ((uint64_t)(byte / TEST_FRAME_BYTE) * 1000000000uLL) / TEST_SCUX_RATE;
+}
+
+/* Spins until cond is true or the time reaches end_ns. Returns cond. */
+template<typename F>
+static bool spin_until(const uint64_t end_ns, F cond)
+{
+    bool    result = cond();
+
+    while ((result != true) && (host_time_ns() < end_ns)) {
+        (void)sched_yield();
+        result = cond();
+    }
+    return result;
+}
+
+static void add_load(load_t * const p_load, const uint64_t ns, const uint64_t budget_ns)
+{
+    p_load->buf_num++;
+    p_load->sum_ns += ns;
+    if (ns > p_load->max_ns) {
+        p_load->max_ns = ns;
+    }
+    if ((p_load->budget_ns == 0u) || (budget_ns < p_load->budget_ns)) {
+        p_load->budget_ns = budget_ns;
+    }
+}
+
+static void print_load(const char * const p_name, const load_t &load)
+{
+    const uint64_t  mean_ns = (load.buf_num > 0u) ? (load.sum_ns / load.buf_num) : 0u;
+
+    (void)printf("%-14s %3u buffers: mean %6.2f ms, max %6.2f ms per %6.2f ms buffer (%5.1f %% of real time)\n",
+                 p_name, (unsigned)load.buf_num, (double)mean_ns / TEST_NS_PER_MS,
+                 (double)load.max_ns / TEST_NS_PER_MS, (double)load.budget_ns / TEST_NS_PER_MS,
+                 (load.budget_ns > 0u) ? (((double)load.max_ns * 100.0) / (double)load.budget_ns) : 0.0);
+}
+
+int main(void)
+{
+    const std::vector<uint8_t>  image_a = make_file(1u);
+    const std::vector<uint8_t>  image_b = make_file(2u);
+    /* The crossfade is the end of the first track, at the rate of SCUX input. */
+    const uint64_t              a_out_frame = ((uint64_t)TEST_BLOCK * TEST_FRAME_NUM * TEST_SCUX_RATE) / TEST_RATE;
+    const uint64_t              xfade_top = a_out_frame - (((uint64_t)TEST_XFADE_MS * TEST_SCUX_RATE) / 1000u);
+    mem_file_t                  mf_a;
+    mem_file_t                  mf_b;
+    FILE                        *fp_a;
+    FILE                        *fp_b;
+    load_t                      plain = {};
+    load_t                      xfade = {};
+    scux_sim_stat_t             stat;
+    uint64_t                    out_frame;          /* Frames written before the buffer being decoded */
+    uint64_t                    end_ns;
+    uint64_t                    due_ns;
+    uint64_t                    cpu_ns;
+    uint32_t                    write_cnt;
+    uint64_t                    write_byte;
+    uint32_t                    underrun = 0u;
+    bool                        is_stopped = false;
+
+    scux_sim_reset();
+    player_sim_start();
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_get_stat().is_route_set; }));
+
+    fp_a = mem_file_open(&mf_a, image_a);
+    fp_b = mem_file_open(&mf_b, image_b);
+    HOST_CHECK((fp_a != NULL) && (fp_b != NULL));
+    HOST_CHECK(dec_set_xfade(TEST_XFADE_MS, XFADE_CURVE_EQUAL_POWER));
+    HOST_CHECK(dec_open(fp_a, 0u, &open_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_opened; }));
+    HOST_CHECK(dec_play());
+    HOST_CHECK(dec_open_next(fp_b, &next_open_callback, &next_start_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_next_opened; }));
+    HOST_CHECK(player_sim_wait([]() { return scux_sim_queued_num() == TEST_QUEUE_NUM; }));
+
+    stat = scux_sim_get_stat();
+    write_cnt = stat.write_cnt;
+    write_byte = stat.write_byte;
+    out_frame = write_byte / TEST_FRAME_BYTE;
+    end_ns = host_time_ns() + TEST_TIMEOUT_NS;
+    due_ns = host_time_ns() + buf_ns(scux_sim_head_byte());
+    while ((is_stopped != true) && (host_time_ns() < end_ns)) {
+        /* The DMA completes the buffer being output. */
+        while (host_time_ns() < due_ns) {
+            (void)sched_yield();
+        }
+        cpu_ns = player_sim_cpu_ns();
+        (void)scux_sim_pump(1u);
+        if (scux_sim_queued_num() > 0u) {
+            due_ns += buf_ns(scux_sim_head_byte());
+        } else if (scux_sim_get_stat().flush_stop_cnt > 0u) {
+            /* The end of the second track: the flush completes. */
+            is_stopped = player_sim_wait([]() { return player_sim_get_stat().play_stat == SYS_PLAYSTAT_STOP; });
+            break;
+        } else {
+            /* SCUX outputs silence until the next write. */
+            underrun++;
+            (void)spin_until(end_ns, []() { return scux_sim_queued_num() > 0u; });
+            due_ns = host_time_ns() + buf_ns(scux_sim_head_byte());
+        }
+        /* The decode thread decodes and writes the next buffer before the DMA needs it. */
+        if (spin_until(due_ns, [=]() { return scux_sim_get_stat().write_cnt != write_cnt; })) {
+            cpu_ns = player_sim_cpu_ns() - cpu_ns;
+            stat = scux_sim_get_stat();
+            add_load((((out_frame >= xfade_top) && (out_frame < a_out_frame)) ? &xfade : &plain),
+                     cpu_ns, buf_ns((uint32_t)(stat.write_byte - write_byte)));
+            out_frame += (stat.write_byte - write_byte) / TEST_FRAME_BYTE;
+            write_cnt = stat.write_cnt;
+            write_byte = stat.write_byte;
+        }
+    }
+
+    print_load("out of xfade", plain);
+    print_load("in the xfade", xfade);
+    (void)printf("%u underruns, %llu frames written\n", (unsigned)underrun, (unsigned long long)out_frame);
+    HOST_CHECK(is_stopped);
+    HOST_CHECK(is_next_started);
+    HOST_CHECK_EQ(0u, underrun);
+    HOST_CHECK(xfade.buf_num > 0u);
+    HOST_CHECK(plain.max_ns < plain.budget_ns);
+    HOST_CHECK(xfade.max_ns < xfade.budget_ns);
+
+    HOST_CHECK(dec_close(&close_callback));
+    HOST_CHECK(player_sim_wait([]() { return is_closed; }));
+    (void)fclose(fp_a);
+    (void)fclose(fp_b);
+    return HOST_TEST_RESULT();
+}
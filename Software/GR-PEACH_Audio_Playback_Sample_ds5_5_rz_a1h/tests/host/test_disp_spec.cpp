@@ -0,0 +1,214 @@
+/* Host test and benchmark of disp_spec: the spectrum and the level meter.
+ *
+ * The FFT is static in disp_spec.cpp, so the module is built into this
+ * translation unit, and aud_get_audio_data() hands it the test data.
+ *  - FFT: the power of every bin of the real FFT (radix-4 complex FFT of
+ *    256 points and the split) matches a double DFT of the same Hann
+ *    windowed data: (L + R) / 2 of 512 points, or the average power of L
+ *    and R of 256 points. The magnitude SNR is printed. The test is built
+ *    for both values of DSP_SPEC_FFT_POINT.
+ *  - Bands: a full scale sine is 0 dB in its band and below -40 dB in the
+ *    bands away from it; the peak meter is 0 dB and the RMS meter -3 dB.
+ *  - Without data the levels fall by METER_FALL_DB per cycle to the minimum.
+ * The benchmark prints the time of one spectrum (window, FFT and bands).
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "host_test.h"
+#include "disp_spec.cpp"
+
+#define TEST_RATE           (48000u / AUD_TAP_DECIMATION)
+#define TEST_TRIAL_NUM      (100u)
+#define BENCH_NUM           (100000u)
+
+static std::vector<int16_t> tap_data;
+static bool                 tap_result;
+
+bool aud_get_audio_data(const AUD_CbAudioData p_cb, int16_t * const p_buf, const uint32_t buf_num)
+{
+    const bool  result = tap_result && (buf_num <= tap_data.size());
+
+    if (result == true) {
+        (void)memcpy(p_buf, &tap_data[0], buf_num * sizeof(int16_t));
+    }
+    p_cb(result, p_buf, buf_num, NULL, 0u);
+    return true;
+}
+
+static void make_sine(const double freq, const double amp)
+{
+    tap_data.resize(SPEC_FRAME_NUM * TAP_CH_NUM);
+    for (uint32_t i = 0u; i < SPEC_FRAME_NUM; i++) {
+        tap_data[(i * TAP_CH_NUM) + TAP_CH_L] = (int16_t)lrint(amp * INT16_MAX * sin((2.0 * M_PI * freq * i) / TEST_RATE));
+        tap_data[(i * TAP_CH_NUM) + TAP_CH_R] = tap_data[(i * TAP_CH_NUM) + TAP_CH_L];
+    }
+}
+
+static void make_noise(const uint32_t seed)
+{
+    srand(seed);
+    tap_data.resize(SPEC_FRAME_NUM * TAP_CH_NUM);
+    for (size_t i = 0u; i < tap_data.size(); i++) {
+        tap_data[i] = (int16_t)((rand() % 65536) - 32768);
+    }
+}
+
+/* Power of each bin of x by the DFT in double. */
+static void add_dft_power(const std::vector<double> &x, std::vector<double> * const p_power, const double scale)
+{
+    double      re;
+    double      im;
+
+    for (uint32_t k = 1u; k < SPEC_BIN_NUM; k++) {
+        re = 0.0;
+        im = 0.0;
+        for (uint32_t n = 0u; n < DSP_SPEC_FFT_POINT; n++) {
+            re += x[n] * cos((2.0 * M_PI * k * n) / DSP_SPEC_FFT_POINT);
+            im -= x[n] * sin((2.0 * M_PI * k * n) / DSP_SPEC_FFT_POINT);
+        }
+        (*p_power)[k] += ((re * re) + (im * im)) * scale;
+    }
+}
+
+/* Power of each bin like get_bin_power(). The FFT scales the input to Q23 */
+/* and its result by 1 / FFT_SIZE. */
+static std::vector<double> model_power(const std::vector<int16_t> &data)
+{
+    std::vector<double>     power(SPEC_BIN_NUM, 0.0);
+    std::vector<double>     x(DSP_SPEC_FFT_POINT);
+    std::vector<double>     y(DSP_SPEC_FFT_POINT);
+    double                  w;
+
+    for (uint32_t n = 0u; n < DSP_SPEC_FFT_POINT; n++) {
+        w = (0.5 - (0.5 * cos((2.0 * M_PI * n) / DSP_SPEC_FFT_POINT))) * (double)(1u << FFT_INPUT_SHIFT);
+        x[n] = (double)data[(n * TAP_CH_NUM) + TAP_CH_L] * w;
+        y[n] = (double)data[(n * TAP_CH_NUM) + TAP_CH_R] * w;
+    }
+#if (DSP_SPEC_FFT_POINT == 512u)
+    for (uint32_t n = 0u; n < DSP_SPEC_FFT_POINT; n++) {
+        x[n] = (x[n] + y[n]) / 2.0;
+    }
+    add_dft_power(x, &power, 1.0 / ((double)FFT_SIZE * FFT_SIZE));
+#else
+    add_dft_power(x, &power, 0.5 / ((double)FFT_SIZE * FFT_SIZE));
+    add_dft_power(y, &power, 0.5 / ((double)FFT_SIZE * FFT_SIZE));
+#endif
+    return power;
+}
+
+/* Adds the signal and the error powers of the magnitudes of data. */
+static void add_snr(const std::vector<int16_t> &data, double * const p_sig, double * const p_err)
+{
+    const std::vector<double> model = model_power(data);
+    double                  mag;
+
+    fill_fft_buf(&data[0], &fft_buf[0]);
+    fft_radix4(&fft_buf[0]);
+    for (uint32_t k = 1u; k < SPEC_BIN_NUM; k++) {
+        mag = sqrt((double)get_bin_power(&fft_buf[0], k)) - sqrt(model[k]);
+        *p_sig += model[k];
+        *p_err += mag * mag;
+    }
+}
+
+static void test_fft(void)
+{
+    double      sig = 0.0;
+    double      err = 0.0;
+    double      snr;
+
+    for (uint32_t t = 0u; t < TEST_TRIAL_NUM; t++) {
+        make_noise(t + 1u);
+        add_snr(tap_data, &sig, &err);
+    }
+    snr = 10.0 * log10(sig / err);
+    (void)printf("FFT %u points, full scale noise: magnitude SNR %.1f dB\n", DSP_SPEC_FFT_POINT, snr);
+    HOST_CHECK(snr > 80.0);
+
+    sig = 0.0;
+    err = 0.0;
+    for (uint32_t k = 1u; k < SPEC_BIN_NUM; k += 7u) {
+        make_sine(((double)k + 0.3) * TEST_RATE / DSP_SPEC_FFT_POINT, 0.5);
+        add_snr(tap_data, &sig, &err);
+    }
+    snr = 10.0 * log10(sig / err);
+    (void)printf("FFT %u points, -6 dBFS sines   : magnitude SNR %.1f dB\n", DSP_SPEC_FFT_POINT, snr);
+    HOST_CHECK(snr > 80.0);
+}
+
+/* Runs a cycle from the minimum levels, so that the levels are the new ones. */
+static void run_cycle(dsp_com_ctrl_t * const p_com)
+{
+    for (uint32_t i = 0u; i < DSP_METER_CH_NUM; i++) {
+        p_com->peak_level[i] = DSP_METER_LEVEL_MIN;
+        p_com->rms_level[i] = DSP_METER_LEVEL_MIN;
+    }
+    for (uint32_t i = 0u; i < DSP_METER_BAND_NUM; i++) {
+        p_com->band_level[i] = DSP_METER_LEVEL_MIN;
+    }
+    (void)dsp_exe_spec(p_com);
+}
+
+static void test_band(void)
+{
+    static dsp_com_ctrl_t   com;
+    uint32_t                bin;
+    uint32_t                band;
+
+    tap_result = true;
+    for (band = 0u; band < DSP_METER_BAND_NUM; band++) {
+        /* A bin in the middle of the band, so that the lobe of the window is in it. */
+        /* The narrow bands at the bottom hold only a part of the lobe. */
+        if ((band_edge[band + 1u] - band_edge[band]) >= 3u) {
+            bin = (band_edge[band] + band_edge[band + 1u]) / 2u;
+            make_sine((double)bin * TEST_RATE / DSP_SPEC_FFT_POINT, 1.0);
+            run_cycle(&com);
+            HOST_CHECK(abs(com.band_level[band]) <= 1);
+            for (uint32_t b = 0u; b < DSP_METER_BAND_NUM; b++) {
+                if (((b + 1u) < band) || (b > (band + 1u))) {
+                    HOST_CHECK(com.band_level[b] < -40);
+                }
+            }
+            HOST_CHECK_EQ(0, com.peak_level[0]);
+            HOST_CHECK_EQ(0, com.peak_level[1]);
+            HOST_CHECK_EQ(-3, com.rms_level[0]);
+            HOST_CHECK_EQ(-3, com.rms_level[1]);
+        }
+    }
+
+    /* The levels fall without data. */
+    tap_result = false;
+    for (int32_t level = -METER_FALL_DB; level > DSP_METER_LEVEL_MIN; level -= METER_FALL_DB) {
+        HOST_CHECK(dsp_exe_spec(&com));
+        HOST_CHECK_EQ(level, com.peak_level[0]);
+    }
+    HOST_CHECK(dsp_exe_spec(&com));
+    HOST_CHECK_EQ(DSP_METER_LEVEL_MIN, com.peak_level[0]);
+    HOST_CHECK_EQ(DSP_METER_LEVEL_MIN, com.band_level[0]);
+    HOST_CHECK(dsp_exe_spec(&com) == false);
+}
+
+static void bench(void)
+{
+    int32_t     band[DSP_METER_BAND_NUM];
+    uint64_t    ns;
+
+    make_noise(1u);
+    ns = host_time_ns();
+    for (uint32_t i = 0u; i < BENCH_NUM; i++) {
+        calc_spectrum(&tap_data[0], &band[0]);
+    }
+    ns = host_time_ns() - ns;
+    (void)printf("calc_spectrum: %.2f us per spectrum\n", (double)ns / (BENCH_NUM * 1000.0));
+}
+
+int main(void)
+{
+    dsp_init_spec();
+    test_fft();
+    test_band();
+    bench();
+    return HOST_TEST_RESULT();
+}
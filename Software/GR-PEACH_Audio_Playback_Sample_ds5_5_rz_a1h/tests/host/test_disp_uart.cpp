@@ -0,0 +1,177 @@
+/* Host test of disp_uart: the console transmit and receive rings.
+ *
+ * disp_uart.cpp runs on the simulated UART (uart_sim.h) at
+ * DSP_PC_COM_BAUDRATE with a 16 bytes FIFO.
+ *  - Stream: strings of random length written at random times arrive on
+ *    the line exactly in order, and the ring drains at the line rate.
+ *  - Overflow: a string larger than the free space is dropped whole, the
+ *    overflow is reported once, and the following strings are sent.
+ *  - Receive: the received bytes come out of dsp_uart_getc() in order,
+ *    the callback is called per interrupt, and the bytes after a full
+ *    ring are discarded.
+ * The test prints the drain rate and the time of dsp_uart_write() on the
+ * host (99.9 percentile and worst, which includes the preemptions).
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "display.h"
+#include "disp_uart.h"
+#include "uart_sim.h"
+
+#define TEST_STRING_NUM     (20000u)
+#define TEST_MAX_LEN        (200u)
+
+static uint32_t rx_cb_cnt;
+
+static void rx_callback(void)
+{
+    rx_cb_cnt++;
+}
+
+static std::string make_string(const uint32_t len)
+{
+    std::string     str;
+
+    /* Escape sequences like the terminal output. */
+    str = "\x1b[2K";
+    while (str.size() < len) {
+        str += (char)(' ' + (rand() % 95));
+    }
+    str.resize(len);
+    return str;
+}
+
+static void test_stream(void)
+{
+    std::string     sent;
+    std::string     str;
+    uint64_t        ns;
+    std::vector<uint64_t> write_ns;
+    uint32_t        drop_cnt = 0u;
+    uint64_t        us;
+
+    uart_sim_reset();
+    srand(1u);
+    for (uint32_t i = 0u; i < TEST_STRING_NUM; i++) {
+        str = make_string(1u + (uint32_t)(rand() % TEST_MAX_LEN));
+        ns = host_time_ns();
+        if (dsp_uart_write(str.c_str()) == true) {
+            sent += str;
+        } else {
+            drop_cnt++;
+        }
+        write_ns.push_back(host_time_ns() - ns);
+        /* Below the line rate on average, with bursts above it. */
+        uart_sim_run((uint32_t)(rand() % 20000));
+    }
+    (void)dsp_uart_check_overflow();
+    (void)uart_sim_run_until_idle();
+    HOST_CHECK_EQ(sent.size(), uart_sim_tx_out().size());
+    HOST_CHECK(memcmp(sent.data(), &uart_sim_tx_out()[0], sent.size()) == 0);
+    std::sort(write_ns.begin(), write_ns.end());
+    (void)printf("stream: %u strings, %u dropped, dsp_uart_write() %.2f us (99.9 %%), %.1f us (worst)\n",
+                 TEST_STRING_NUM, (unsigned)drop_cnt, (double)write_ns[(write_ns.size() * 999u) / 1000u] / 1000.0,
+                 (double)write_ns.back() / 1000.0);
+
+    /* Drain rate of a full ring. */
+    uart_sim_reset();
+    str = make_string(DSP_UART_TX_BUF_SIZE / 2u);
+    HOST_CHECK(dsp_uart_write(str.c_str()));
+    HOST_CHECK(dsp_uart_write(str.c_str()));
+    us = uart_sim_run_until_idle();
+    HOST_CHECK_EQ(DSP_UART_TX_BUF_SIZE, uart_sim_tx_out().size());
+    (void)printf("drain: %u bytes in %.1f ms, %.2f kB/s at %u baud, %u TX interrupts\n",
+                 DSP_UART_TX_BUF_SIZE, (double)us / 1000.0,
+                 ((double)DSP_UART_TX_BUF_SIZE * 1000.0) / (double)us,
+                 (unsigned)uart_sim_get_stat().baud, (unsigned)uart_sim_get_stat().tx_irq_cnt);
+    HOST_CHECK_EQ(DSP_PC_COM_BAUDRATE, uart_sim_get_stat().baud);
+    HOST_CHECK(us <= (((uint64_t)DSP_UART_TX_BUF_SIZE * 10u * 1000000u) / DSP_PC_COM_BAUDRATE) + 100u);
+}
+
+static void test_overflow(void)
+{
+    std::string     sent;
+    std::string     str;
+    std::string     big;
+
+    uart_sim_reset();
+    HOST_CHECK(dsp_uart_check_overflow() == false);
+    big = make_string(DSP_UART_TX_BUF_SIZE + 1u);
+    HOST_CHECK(dsp_uart_write(big.c_str()) == false);
+    HOST_CHECK(dsp_uart_check_overflow());
+    HOST_CHECK(dsp_uart_check_overflow() == false);
+    HOST_CHECK_EQ(0u, uart_sim_run_until_idle());
+
+    /* Fills the ring without time. The FIFO takes the first 16 bytes. */
+    str = make_string(100u);
+    while (dsp_uart_write(str.c_str()) == true) {
+        sent += str;
+    }
+    HOST_CHECK_EQ(((DSP_UART_TX_BUF_SIZE + UART_SIM_FIFO_SIZE) / 100u) * 100u, sent.size());
+    HOST_CHECK(dsp_uart_check_overflow());
+    /* A short string which fits is still accepted. */
+    str = make_string(4u);
+    HOST_CHECK(dsp_uart_write(str.c_str()));
+    sent += str;
+    HOST_CHECK(dsp_uart_check_overflow() == false);
+    (void)uart_sim_run_until_idle();
+    str = make_string(50u);
+    HOST_CHECK(dsp_uart_write(str.c_str()));
+    sent += str;
+    (void)uart_sim_run_until_idle();
+    HOST_CHECK_EQ(sent.size(), uart_sim_tx_out().size());
+    HOST_CHECK(memcmp(sent.data(), &uart_sim_tx_out()[0], sent.size()) == 0);
+}
+
+static void test_receive(void)
+{
+    std::string     str;
+    std::string     got;
+    int32_t         c;
+
+    uart_sim_reset();
+    rx_cb_cnt = 0u;
+    dsp_uart_set_rx_callback(&rx_callback);
+    HOST_CHECK(dsp_uart_readable() == false);
+    HOST_CHECK_EQ(-1, dsp_uart_getc());
+
+    uart_sim_receive("play\r", 5u);
+    uart_sim_receive("\n", 1u);
+    HOST_CHECK_EQ(2u, rx_cb_cnt);
+    while (dsp_uart_readable() == true) {
+        got += (char)dsp_uart_getc();
+    }
+    HOST_CHECK(got == "play\r\n");
+
+    /* The ring keeps DSP_UART_RX_BUF_SIZE bytes, and the rest is discarded. */
+    got.clear();
+    str = make_string(DSP_UART_RX_BUF_SIZE + 20u);
+    for (size_t i = 0u; i < str.size(); i += UART_SIM_FIFO_SIZE) {
+        uart_sim_receive(&str[i], (uint32_t)(((str.size() - i) < UART_SIM_FIFO_SIZE) ?
+                                              (str.size() - i) : UART_SIM_FIFO_SIZE));
+    }
+    c = dsp_uart_getc();
+    while (c >= 0) {
+        got += (char)c;
+        c = dsp_uart_getc();
+    }
+    HOST_CHECK(got == str.substr(0u, DSP_UART_RX_BUF_SIZE));
+    HOST_CHECK_EQ(0u, uart_sim_get_stat().rx_lost_cnt);
+
+    dsp_uart_set_rx_callback(NULL);
+    uart_sim_receive("x", 1u);
+    HOST_CHECK_EQ('x', dsp_uart_getc());
+}
+
+int main(void)
+{
+    dsp_uart_init();
+    test_stream();
+    test_overflow();
+    test_receive();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,139 @@
+/* Host test of the cluster run coalescing of f_read.
+ *
+ * 8 MB files are written on a 64 MB FAT16 RAM disk with 4 KB clusters
+ * (ram_fs.h) and read sequentially after the open. A direct read joins
+ * the physically contiguous clusters that follow into one disk_read, so
+ * the data reads (the reads which are not of the FAT) are:
+ *  - a contiguous file: one per read, mapped or on the FAT chain;
+ *  - 32 fragments: at most one more per fragment boundary;
+ *  - a read which starts in a sector: the head from the cached tail
+ *    sector of the read before, the sectors, and the new tail sector;
+ *  - every cluster a fragment: one per cluster, as before.
+ * The data of every read is checked, and reads of random lengths check
+ * the edges of the runs. The test prints the counts of each case.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+
+#define TEST_DISK_SIZE      (64u * 1024u * 1024u)
+#define TEST_CLUSTER        (4096u)
+#define TEST_FILE_SIZE      (8u * 1024u * 1024u)
+#define TEST_HEAD_SIZE      (1000u)
+#define TEST_RANDOM_MAX     (70000u)
+#define TEST_HOLD_NUM       (MBED_CONF_FILESYSTEM_FAT_CLMT_NUM)
+
+typedef struct {
+    uint32_t    call_cnt;           /* File::read() calls */
+    uint32_t    data_cnt;           /* disk_read calls which are not of the FAT */
+    uint32_t    fat_cnt;
+    uint32_t    err_cnt;            /* Bytes which differ from the pattern */
+} read_result_t;
+
+static RamFs    ram("ram", TEST_DISK_SIZE);
+
+/* Reads the file sequentially after a head of head bytes, with reads of */
+/* read_size, or of random sizes up to TEST_RANDOM_MAX if it is 0. */
+static read_result_t read_file(const char * const path, const uint32_t seed, const bool is_map,
+                               const uint32_t head, const uint32_t read_size)
+{
+    File                    hold[TEST_HOLD_NUM];
+    File                    file;
+    std::vector<uint8_t>    buf(TEST_RANDOM_MAX);
+    read_result_t           res = {};
+    uint32_t                ofs = 0u;
+    uint32_t                len;
+
+    HOST_CHECK(ram.remount());
+    if (is_map != true) {
+        for (uint32_t i = 0u; i < TEST_HOLD_NUM; i++) {
+            HOST_CHECK_EQ(0, hold[i].open(&ram.fs, "hold.bin", O_RDONLY));
+        }
+    }
+    HOST_CHECK_EQ(0, file.open(&ram.fs, path, O_RDONLY));
+    ram.prof.reset_counters();
+    srand(seed);
+    while (ofs < TEST_FILE_SIZE) {
+        if ((ofs == 0u) && (head != 0u)) {
+            len = head;
+        } else if (read_size == 0u) {
+            len = 1u + ((uint32_t)rand() % TEST_RANDOM_MAX);
+        } else {
+            len = read_size;
+        }
+        if (len > (TEST_FILE_SIZE - ofs)) {
+            len = TEST_FILE_SIZE - ofs;
+        }
+        HOST_CHECK_EQ((ssize_t)len, file.read(&buf[0], len));
+        res.err_cnt += RamFs::verify(&buf[0], seed, ofs, len);
+        res.call_cnt++;
+        ofs += len;
+    }
+    HOST_CHECK_EQ(0, file.read(&buf[0], 1u));
+    res.fat_cnt = ram.cnt().read_meta_count;
+    res.data_cnt = ram.cnt().read_count - res.fat_cnt;
+    HOST_CHECK_EQ(0, file.close());
+    HOST_CHECK_EQ(0u, res.err_cnt);
+    return res;
+}
+
+static void print_result(const char * const name, const read_result_t &res)
+{
+    (void)printf("  %-40s %5u reads: %5u disk_read (%3u FAT)\n", name, (unsigned)res.call_cnt,
+                 (unsigned)(res.data_cnt + res.fat_cnt), (unsigned)res.fat_cnt);
+}
+
+static void test_coalesce(void)
+{
+    read_result_t   res;
+
+    (void)printf("%u MB files, %u KB clusters:\n", TEST_FILE_SIZE >> 20, TEST_CLUSTER >> 10);
+    res = read_file("contig.bin", 1u, true, 0u, 64u * 1024u);
+    print_result("contiguous, CLMT, 64 KB reads", res);
+    HOST_CHECK_EQ(res.call_cnt, res.data_cnt);
+    HOST_CHECK_EQ(0u, res.fat_cnt);
+
+    res = read_file("contig.bin", 1u, false, 0u, 64u * 1024u);
+    print_result("contiguous, chain, 64 KB reads", res);
+    HOST_CHECK_EQ(res.call_cnt, res.data_cnt);
+
+    res = read_file("contig.bin", 1u, false, 0u, 16u * 1024u);
+    print_result("contiguous, chain, 16 KB reads", res);
+    HOST_CHECK_EQ(res.call_cnt, res.data_cnt);
+
+    res = read_file("frag32.bin", 32u, false, 0u, 64u * 1024u);
+    print_result("32 fragments, chain, 64 KB reads", res);
+    HOST_CHECK(res.data_cnt <= (res.call_cnt + 31u));
+
+    res = read_file("frag32.bin", 32u, true, 0u, 64u * 1024u);
+    print_result("32 fragments, CLMT, 64 KB reads", res);
+    HOST_CHECK(res.data_cnt <= (res.call_cnt + 31u));
+    HOST_CHECK_EQ(0u, res.fat_cnt);
+
+    res = read_file("contig.bin", 1u, false, TEST_HEAD_SIZE, 64u * 1024u);
+    print_result("contiguous, 1000 byte head, 64 KB reads", res);
+    HOST_CHECK(res.data_cnt <= ((2u * res.call_cnt) + 1u));
+
+    res = read_file("every.bin", 3u, false, 0u, 64u * 1024u);
+    print_result("every cluster a fragment, 64 KB reads", res);
+    HOST_CHECK_EQ(TEST_FILE_SIZE / TEST_CLUSTER, res.data_cnt);
+
+    res = read_file("frag32.bin", 32u, false, 0u, 0u);
+    print_result("32 fragments, chain, random lengths", res);
+    res = read_file("frag32.bin", 32u, true, TEST_HEAD_SIZE, 0u);
+    print_result("32 fragments, CLMT, random lengths", res);
+    res = read_file("every.bin", 3u, true, 0u, 0u);
+    print_result("every cluster a fragment, random lengths", res);
+}
+
+int main(void)
+{
+    HOST_CHECK(ram.format((int)TEST_CLUSTER));
+    HOST_CHECK(ram.write_file("hold.bin", TEST_CLUSTER, 0u));
+    HOST_CHECK(ram.write_file("contig.bin", TEST_FILE_SIZE, 1u));
+    HOST_CHECK(ram.write_file("frag32.bin", TEST_FILE_SIZE, 32u, 32u));
+    HOST_CHECK(ram.write_file("every.bin", TEST_FILE_SIZE, 3u, TEST_FILE_SIZE / TEST_CLUSTER));
+    test_coalesce();
+    return HOST_TEST_RESULT();
+}
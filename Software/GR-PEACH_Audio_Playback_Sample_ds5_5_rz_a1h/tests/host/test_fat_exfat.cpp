@@ -0,0 +1,440 @@
+/* Host test of the read-only exFAT support of FatFs.
+ *
+ * FatFs cannot format exFAT, so the test writes a 128 MB exFAT image with
+ * 32 KB clusters straight into the RAM disk (ram_fs.h):
+ *  - the root directory on a FAT chain with the bitmap, the up-case
+ *    table, a sub-directory and two 8 MB files: one contiguous
+ *    (NoFatChain) and one on a FAT chain in 32 fragments;
+ *  - a contiguous (NoFatChain) sub-directory of TEST_TRACK_NUM files with
+ *    long names, which takes two clusters.
+ * Checks:
+ *  - The mount reads the boot sector only.
+ *  - The root and the sub-directory list every entry set with its name,
+ *    attribute and size. The contiguous sub-directory is listed without
+ *    reading the FAT.
+ *  - Names are found without case.
+ *  - The contiguous file is read with 64 KB reads in one disk_read each,
+ *    and read and seeked TEST_SEEK_NUM times without a FAT read. The
+ *    fragmented file reads the FAT.
+ *  - Any write access is rejected with EACCES.
+ *  - All data read back is the data of the image.
+ * The test prints the disk_read calls and the FAT reads of each step.
+ */
+#include <ctype.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+
+#define TEST_DISK_SIZE      (128u * 1024u * 1024u)
+#define TEST_FILE_SIZE      (8u * 1024u * 1024u)
+#define TEST_FRAG_NUM       (32u)
+#define TEST_TRACK_NUM      (300u)
+#define TEST_READ_SIZE      (64u * 1024u)
+#define TEST_SEEK_NUM       (200u)
+#define TEST_SEEK_READ      (4096u)
+
+#define XF_CLUSTER_SHIFT    (6u)        /* 64 sectors: 32 KB clusters */
+#define XF_CLUSTER_SIZE     (RAM_FS_SECTOR << XF_CLUSTER_SHIFT)
+#define XF_FAT_OFS          (128u)      /* Sectors */
+#define XF_FAT_LEN          (64u)
+#define XF_HEAP_OFS         (1024u)
+#define XF_CLUSTER_NUM      (((TEST_DISK_SIZE / RAM_FS_SECTOR) - XF_HEAP_OFS) >> XF_CLUSTER_SHIFT)
+#define XF_FAT_EOC          (0xFFFFFFFFu)
+#define XF_ENTRY_SIZE       (32u)
+#define XF_NAME_PER_ENTRY   (15u)
+
+#define XF_ET_BITMAP        (0x81u)
+#define XF_ET_UPCASE        (0x82u)
+#define XF_ET_FILEDIR       (0x85u)
+#define XF_ET_STREAM        (0xC0u)
+#define XF_ET_FILENAME      (0xC1u)
+#define XF_SF_ALLOC         (0x01u)
+#define XF_SF_NOFATCHAIN    (0x02u)
+#define XF_ATTR_DIR         (0x10u)
+#define XF_ATTR_ARC         (0x20u)
+
+typedef struct {
+    std::string     name;
+    uint32_t        attr;
+    uint32_t        size;
+    uint32_t        seed;
+} entry_t;
+
+/* Writer of an exFAT image on the RAM disk. Clusters are allocated in */
+/* order from the first one of the heap. */
+class ExfatImage {
+public:
+    ExfatImage(RamFs * const p_ram) : ram(p_ram), fat(XF_CLUSTER_NUM + 2u, 0u), next_clust(2u) {
+        /* The block table of the heap is made by init(), which FatFs */
+        /* only calls at the mount. */
+        HOST_CHECK_EQ(0, ram->heap.init());
+    }
+
+    /* Allocates num clusters in frag_num fragments, a free cluster */
+    /* between them, and links them on the FAT unless is_contig. */
+    uint32_t alloc(const uint32_t num, const uint32_t frag_num, const bool is_contig) {
+        const uint32_t  frag_len = (num + frag_num - 1u) / frag_num;
+        const uint32_t  top = next_clust;
+        uint32_t        prev = 0u;
+
+        for (uint32_t i = 0u; i < num; i++) {
+            if ((i > 0u) && ((i % frag_len) == 0u)) {
+                next_clust++;
+            }
+            if (is_contig != true) {
+                if (prev != 0u) {
+                    fat[prev] = next_clust;
+                }
+                fat[next_clust] = XF_FAT_EOC;
+            }
+            used.push_back(next_clust);
+            prev = next_clust;
+            next_clust++;
+        }
+        return top;
+    }
+
+    /* Writes data to the chain of clusters from top, as alloc() made it. */
+    void write(const uint32_t top, const uint32_t frag_num, const uint32_t num, const std::vector<uint8_t> &data) {
+        const uint32_t  frag_len = (num + frag_num - 1u) / frag_num;
+        uint32_t        clust = top;
+
+        for (uint32_t i = 0u; i < num; i++) {
+            if ((i > 0u) && ((i % frag_len) == 0u)) {
+                clust++;
+            }
+            write_cluster(clust, &data[i * XF_CLUSTER_SIZE]);
+            clust++;
+        }
+    }
+
+    /* Adds a file of the pattern of seed and returns its entry set. */
+    std::vector<uint8_t> add_file(const std::string &name, const uint32_t size, const uint32_t seed,
+                                  const uint32_t frag_num, const bool is_contig) {
+        const uint32_t          num = (size + XF_CLUSTER_SIZE - 1u) / XF_CLUSTER_SIZE;
+        std::vector<uint8_t>    data(num * XF_CLUSTER_SIZE, 0u);
+        const uint32_t          top = alloc(num, frag_num, is_contig);
+
+        RamFs::fill(&data[0], seed, 0u, size);
+        write(top, frag_num, num, data);
+        return entry_set(name, XF_ATTR_ARC, top, size, is_contig);
+    }
+
+    /* Adds a contiguous directory of the entry sets and returns its set. */
+    std::vector<uint8_t> add_dir(const std::string &name, std::vector<uint8_t> table) {
+        const uint32_t  num = (uint32_t)((table.size() + XF_CLUSTER_SIZE) / XF_CLUSTER_SIZE);
+        const uint32_t  top = alloc(num, 1u, true);
+
+        table.resize(num * XF_CLUSTER_SIZE, 0u);
+        write(top, 1u, num, table);
+        return entry_set(name, XF_ATTR_DIR, top, num * XF_CLUSTER_SIZE, true);
+    }
+
+    /* Writes the boot sector, the FAT, the bitmap, the up-case table and */
+    /* the root directory on a FAT chain. */
+    void finish(const std::vector<uint8_t> &root_sets) {
+        std::vector<uint8_t>    root;
+        std::vector<uint8_t>    bitmap((XF_CLUSTER_NUM + 7u) / 8u, 0u);
+        std::vector<uint8_t>    upcase(128u * 2u);
+        std::vector<uint8_t>    boot(RAM_FS_SECTOR, 0u);
+        std::vector<uint8_t>    sect(RAM_FS_SECTOR * XF_FAT_LEN, 0u);
+        const uint32_t          bitmap_clust = alloc(1u, 1u, false);
+        const uint32_t          upcase_clust = alloc(1u, 1u, false);
+        const uint32_t          root_clust = alloc(1u, 1u, false);
+
+        /* The up-case table of ASCII, which FatFs does not read. */
+        for (uint32_t i = 0u; i < 128u; i++) {
+            st_word(&upcase[i * 2u], ((i >= 'a') && (i <= 'z')) ? (i - 0x20u) : i);
+        }
+        root.resize(XF_ENTRY_SIZE * 2u, 0u);
+        root[0] = XF_ET_BITMAP;
+        st_dword(&root[20], bitmap_clust);
+        st_dword(&root[24], (uint32_t)bitmap.size());
+        root[XF_ENTRY_SIZE] = XF_ET_UPCASE;
+        st_dword(&root[XF_ENTRY_SIZE + 20u], upcase_clust);
+        st_dword(&root[XF_ENTRY_SIZE + 24u], (uint32_t)upcase.size());
+        root.insert(root.end(), root_sets.begin(), root_sets.end());
+        root.resize(XF_CLUSTER_SIZE, 0u);
+        write_cluster(root_clust, &root[0]);
+
+        for (size_t i = 0u; i < used.size(); i++) {
+            bitmap[(used[i] - 2u) / 8u] |= (uint8_t)(1u << ((used[i] - 2u) % 8u));
+        }
+        bitmap.resize(XF_CLUSTER_SIZE, 0u);
+        write_cluster(bitmap_clust, &bitmap[0]);
+        upcase.resize(XF_CLUSTER_SIZE, 0u);
+        write_cluster(upcase_clust, &upcase[0]);
+
+        st_dword(&sect[0], 0xFFFFFFF8u);
+        st_dword(&sect[4], XF_FAT_EOC);
+        for (uint32_t i = 2u; i < fat.size(); i++) {
+            st_dword(&sect[i * 4u], fat[i]);
+        }
+        program((bd_addr_t)XF_FAT_OFS * RAM_FS_SECTOR, &sect[0], (uint32_t)sect.size());
+
+        boot[0] = 0xEBu;
+        boot[1] = 0x76u;
+        boot[2] = 0x90u;
+        (void)memcpy(&boot[3], "EXFAT   ", 8u);
+        st_dword(&boot[72], TEST_DISK_SIZE / RAM_FS_SECTOR);
+        st_dword(&boot[80], XF_FAT_OFS);
+        st_dword(&boot[84], XF_FAT_LEN);
+        st_dword(&boot[88], XF_HEAP_OFS);
+        st_dword(&boot[92], XF_CLUSTER_NUM);
+        st_dword(&boot[96], root_clust);
+        st_dword(&boot[100], 0x12345678u);
+        st_word(&boot[104], 0x0100u);
+        boot[108] = 9u;
+        boot[109] = XF_CLUSTER_SHIFT;
+        boot[110] = 1u;
+        boot[111] = 0x80u;
+        st_word(&boot[510], 0xAA55u);
+        program(0u, &boot[0], RAM_FS_SECTOR);
+    }
+
+private:
+    RamFs                   *ram;
+    std::vector<uint32_t>   fat;
+    std::vector<uint32_t>   used;
+    uint32_t                next_clust;
+
+    /* File, stream and name entries of an object. */
+    std::vector<uint8_t> entry_set(const std::string &name, const uint32_t attr, const uint32_t clust,
+                                   const uint32_t size, const bool is_contig) {
+        const uint32_t          name_num = (uint32_t)((name.size() + XF_NAME_PER_ENTRY - 1u) / XF_NAME_PER_ENTRY);
+        std::vector<uint8_t>    set((2u + name_num) * XF_ENTRY_SIZE, 0u);
+        uint16_t                sum = 0u;
+
+        set[0] = XF_ET_FILEDIR;
+        set[1] = (uint8_t)(1u + name_num);
+        st_word(&set[4], attr);
+        st_dword(&set[12], 0x4A210000u);    /* 2017-01-01 00:00:00 */
+        set[XF_ENTRY_SIZE] = XF_ET_STREAM;
+        set[XF_ENTRY_SIZE + 1u] = (uint8_t)(XF_SF_ALLOC | (is_contig ? XF_SF_NOFATCHAIN : 0u));
+        set[XF_ENTRY_SIZE + 3u] = (uint8_t)name.size();
+        st_dword(&set[XF_ENTRY_SIZE + 8u], size);
+        st_dword(&set[XF_ENTRY_SIZE + 20u], clust);
+        st_dword(&set[XF_ENTRY_SIZE + 24u], size);
+        for (uint32_t i = 0u; i < name.size(); i++) {
+            const uint32_t  pos = ((2u + (i / XF_NAME_PER_ENTRY)) * XF_ENTRY_SIZE) + 2u + ((i % XF_NAME_PER_ENTRY) * 2u);
+
+            set[((2u + (i / XF_NAME_PER_ENTRY)) * XF_ENTRY_SIZE)] = XF_ET_FILENAME;
+            st_word(&set[pos], (uint8_t)name[i]);
+        }
+        for (uint32_t i = 0u; i < set.size(); i++) {
+            if ((i != 2u) && (i != 3u)) {
+                sum = (uint16_t)(((sum & 1u) ? 0x8000u : 0u) + (sum >> 1) + set[i]);
+            }
+        }
+        st_word(&set[2], sum);
+        return set;
+    }
+
+    void write_cluster(const uint32_t clust, const uint8_t * const p_data) {
+        program((bd_addr_t)(XF_HEAP_OFS + ((clust - 2u) << XF_CLUSTER_SHIFT)) * RAM_FS_SECTOR, p_data, XF_CLUSTER_SIZE);
+    }
+
+    void program(const bd_addr_t addr, const uint8_t * const p_data, const uint32_t size) {
+        HOST_CHECK_EQ(0, ram->heap.erase(addr, size));
+        HOST_CHECK_EQ(0, ram->heap.program(p_data, addr, size));
+    }
+
+    static void st_word(uint8_t * const p, const uint32_t val) {
+        p[0] = (uint8_t)val;
+        p[1] = (uint8_t)(val >> 8);
+    }
+
+    static void st_dword(uint8_t * const p, const uint32_t val) {
+        st_word(p, val);
+        st_word(&p[2], val >> 16);
+    }
+};
+
+static RamFs                    ram("ram", TEST_DISK_SIZE);
+static std::vector<entry_t>     root_entry;
+static std::vector<entry_t>     track_entry;
+
+static std::string track_name(const uint32_t i)
+{
+    char    name[64];
+
+    (void)snprintf(name, sizeof(name), "Track %03u - A Long exFAT Name.flac", (unsigned)i);
+    return name;
+}
+
+static void make_image(void)
+{
+    ExfatImage              img(&ram);
+    std::vector<uint8_t>    root;
+    std::vector<uint8_t>    tracks;
+    std::vector<uint8_t>    set;
+    entry_t                 ent;
+
+    for (uint32_t i = 0u; i < TEST_TRACK_NUM; i++) {
+        ent = (entry_t){ track_name(i), XF_ATTR_ARC, 1000u + (i * 97u), 100u + i };
+        set = img.add_file(ent.name, ent.size, ent.seed, 1u, true);
+        tracks.insert(tracks.end(), set.begin(), set.end());
+        track_entry.push_back(ent);
+    }
+    set = img.add_dir("Music Folder", tracks);
+    root.insert(root.end(), set.begin(), set.end());
+    root_entry.push_back((entry_t){ "Music Folder", XF_ATTR_DIR, 0u, 0u });
+
+    ent = (entry_t){ "Contiguous Stream.bin", XF_ATTR_ARC, TEST_FILE_SIZE, 1u };
+    set = img.add_file(ent.name, ent.size, ent.seed, 1u, true);
+    root.insert(root.end(), set.begin(), set.end());
+    root_entry.push_back(ent);
+
+    ent = (entry_t){ "chain.bin", XF_ATTR_ARC, TEST_FILE_SIZE, 2u };
+    set = img.add_file(ent.name, ent.size, ent.seed, TEST_FRAG_NUM, false);
+    root.insert(root.end(), set.begin(), set.end());
+    root_entry.push_back(ent);
+    img.finish(root);
+}
+
+static void print_cnt(const char * const label)
+{
+    (void)printf("%-40s: %4u reads (%u FAT)\n", label,
+                 (unsigned)ram.cnt().read_count, (unsigned)ram.cnt().read_meta_count);
+}
+
+/* Lists the directory and checks it against the entries. */
+static void list_dir(const char * const path, const std::vector<entry_t> &expect)
+{
+    Dir             dir;
+    struct dirent   ent;
+    struct stat     st;
+    std::string     name;
+    uint32_t        num = 0u;
+
+    HOST_CHECK_EQ(0, dir.open(&ram.fs, path));
+    while (dir.read(&ent) > 0) {
+        HOST_CHECK(num < expect.size());
+        if (num < expect.size()) {
+            HOST_CHECK(expect[num].name == ent.d_name);
+            HOST_CHECK_EQ((expect[num].attr == XF_ATTR_DIR) ? DT_DIR : DT_REG, ent.d_type);
+            if (expect[num].attr != XF_ATTR_DIR) {
+                name = std::string(path) + ((path[0] != '\0') ? "/" : "") + ent.d_name;
+                HOST_CHECK_EQ(0, ram.fs.stat(name.c_str(), &st));
+                HOST_CHECK_EQ(expect[num].size, st.st_size);
+            }
+        }
+        num++;
+    }
+    HOST_CHECK_EQ(0, dir.close());
+    HOST_CHECK_EQ(expect.size(), num);
+}
+
+/* Reads the whole file with TEST_READ_SIZE reads. */
+static uint32_t read_file(const char * const path, const uint32_t seed)
+{
+    File                    file;
+    std::vector<uint8_t>    buf(TEST_READ_SIZE);
+    uint32_t                err = 0u;
+    ssize_t                 len;
+
+    HOST_CHECK_EQ(0, file.open(&ram.fs, path, O_RDONLY));
+    for (uint32_t ofs = 0u; ofs < TEST_FILE_SIZE; ofs += TEST_READ_SIZE) {
+        len = file.read(&buf[0], TEST_READ_SIZE);
+        HOST_CHECK_EQ((ssize_t)TEST_READ_SIZE, len);
+        err += RamFs::verify(&buf[0], seed, ofs, TEST_READ_SIZE);
+    }
+    HOST_CHECK_EQ(0, file.read(&buf[0], TEST_READ_SIZE));
+    HOST_CHECK_EQ(0, file.close());
+    return err;
+}
+
+static void test_exfat(void)
+{
+    File            file;
+    uint8_t         buf[TEST_SEEK_READ];
+    char            path[80];
+    uint32_t        err = 0u;
+    uint32_t        ofs;
+    uint32_t        i;
+
+    /* Mount */
+    HOST_CHECK(ram.remount());
+    (void)ram.fs.unmount();
+    ram.prof.reset_counters();
+    HOST_CHECK_EQ(0, ram.fs.mount(&ram.prof, true));
+    print_cnt("mount");
+    HOST_CHECK_EQ(1u, ram.cnt().read_count);
+
+    /* Directories */
+    ram.prof.reset_counters();
+    list_dir("", root_entry);
+    print_cnt("root listing");
+    HOST_CHECK(ram.remount());
+    {
+        Dir             dir;
+        struct dirent   ent;
+
+        HOST_CHECK_EQ(0, dir.open(&ram.fs, "Music Folder"));
+        for (i = 0u; dir.read(&ent) > 0; i++) {
+            HOST_CHECK((i < TEST_TRACK_NUM) && (track_entry[i].name == ent.d_name));
+        }
+        HOST_CHECK_EQ(TEST_TRACK_NUM, i);
+        HOST_CHECK_EQ(0, dir.close());
+    }
+    print_cnt("contiguous directory of 300 files");
+    HOST_CHECK_EQ(0u, ram.cnt().read_meta_count);
+    list_dir("Music Folder", track_entry);
+
+    /* Files of the sub-directory, found without case. */
+    for (i = 0u; i < TEST_TRACK_NUM; i += 37u) {
+        std::vector<uint8_t>    data(track_entry[i].size + 1u);
+
+        (void)snprintf(path, sizeof(path), "MUSIC FOLDER/%s", track_name(i).c_str());
+        for (char *p = path; *p != '\0'; p++) {
+            *p = (char)(((i % 2u) == 0u) ? toupper(*p) : tolower(*p));
+        }
+        HOST_CHECK_EQ(0, file.open(&ram.fs, path, O_RDONLY));
+        HOST_CHECK_EQ((ssize_t)track_entry[i].size, file.read(&data[0], data.size()));
+        err += RamFs::verify(&data[0], track_entry[i].seed, 0u, track_entry[i].size);
+        HOST_CHECK_EQ(0, file.close());
+    }
+
+    /* Contiguous file: one disk_read per read, no FAT. */
+    HOST_CHECK(ram.remount());
+    err += read_file("contiguous stream.BIN", 1u);
+    print_cnt("contiguous 8 MB file, 64 KB reads");
+    HOST_CHECK_EQ(0u, ram.cnt().read_meta_count);
+    HOST_CHECK(ram.cnt().read_count <= ((TEST_FILE_SIZE / TEST_READ_SIZE) + 2u));
+    HOST_CHECK(ram.remount());
+    err += read_file("chain.bin", 2u);
+    print_cnt("8 MB file in 32 fragments, 64 KB reads");
+    HOST_CHECK(ram.cnt().read_meta_count > 0u);
+
+    /* Seeks on the contiguous file. */
+    HOST_CHECK(ram.remount());
+    HOST_CHECK_EQ(0, file.open(&ram.fs, "Contiguous Stream.bin", O_RDONLY));
+    srand(1u);
+    for (i = 0u; i < TEST_SEEK_NUM; i++) {
+        ofs = (uint32_t)rand() % (TEST_FILE_SIZE - TEST_SEEK_READ);
+        HOST_CHECK_EQ((off_t)ofs, file.seek((off_t)ofs, SEEK_SET));
+        HOST_CHECK_EQ((ssize_t)TEST_SEEK_READ, file.read(buf, TEST_SEEK_READ));
+        err += RamFs::verify(buf, 1u, ofs, TEST_SEEK_READ);
+    }
+    HOST_CHECK_EQ(0, file.close());
+    print_cnt("200 seeks and 4 KB reads");
+    HOST_CHECK_EQ(0u, ram.cnt().read_meta_count);
+    HOST_CHECK_EQ(0u, err);
+
+    /* Read-only volume */
+    HOST_CHECK_EQ(-EACCES, file.open(&ram.fs, "new.bin", O_WRONLY | O_CREAT));
+    HOST_CHECK_EQ(-EACCES, file.open(&ram.fs, "chain.bin", O_RDWR));
+    HOST_CHECK_EQ(-EACCES, ram.fs.mkdir("new", 0777));
+    HOST_CHECK_EQ(-EACCES, ram.fs.remove("chain.bin"));
+    HOST_CHECK_EQ(0, ram.cnt().program_count);
+    HOST_CHECK_EQ(0u, read_file("chain.bin", 2u));
+}
+
+int main(void)
+{
+    make_image();
+    test_exfat();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,144 @@
+/* Host test of the cluster link map tables (CLMT) of FATFileSystem.
+ *
+ * An 8 MB file in 32 fragments and one in 512 fragments are written on a
+ * 64 MB FAT16 RAM disk with 4 KB clusters (ram_fs.h). Each file is read
+ * once mapped, i.e. opened O_RDONLY with a free table, and once on the
+ * FAT chain, with both tables of the pool held by two other files.
+ *  - Mapped: the open reads the FAT to build the table, and the
+ *    sequential reads and the random seeks read no FAT at all. Each 4 KB
+ *    read is one disk_read.
+ *  - The pool: with both tables held, the file is read on the chain.
+ *  - A file with too many fragments for a table falls back to the chain:
+ *    after the failed mapping in the open, its reads have the same counts
+ *    as on the chain.
+ *  - All data read back is the data written.
+ * The test prints the disk_read calls and the FAT reads of the open, of
+ * the sequential 4 KB reads and of TEST_SEEK_NUM random seeks and reads.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+
+#define TEST_DISK_SIZE      (64u * 1024u * 1024u)
+#define TEST_CLUSTER        (4096)
+#define TEST_FILE_SIZE      (8u * 1024u * 1024u)
+#define TEST_READ_SIZE      (4096u)
+#define TEST_SEEK_NUM       (200u)
+#define TEST_HOLD_NUM       (MBED_CONF_FILESYSTEM_FAT_CLMT_NUM)
+
+typedef struct {
+    uint32_t    read_cnt;
+    uint32_t    fat_cnt;
+} io_cnt_t;
+
+typedef struct {
+    io_cnt_t    open;
+    io_cnt_t    seq;
+    io_cnt_t    seek;
+    uint32_t    err_cnt;            /* Bytes which differ from the pattern */
+} read_result_t;
+
+static RamFs    ram("ram", TEST_DISK_SIZE);
+
+static io_cnt_t take_cnt(void)
+{
+    io_cnt_t    cnt;
+
+    cnt.read_cnt = ram.cnt().read_count;
+    cnt.fat_cnt = ram.cnt().read_meta_count;
+    ram.prof.reset_counters();
+    return cnt;
+}
+
+/* Opens the file from a cold cache and reads it sequentially, then at */
+/* random positions. With is_hold, the tables are held by other files. */
+static read_result_t read_file(const char * const path, const uint32_t seed, const bool is_hold)
+{
+    File            hold[TEST_HOLD_NUM];
+    File            file;
+    read_result_t   res;
+    uint8_t         buf[TEST_READ_SIZE];
+    uint32_t        ofs;
+
+    res.err_cnt = 0u;
+    HOST_CHECK(ram.remount());
+    if (is_hold == true) {
+        for (uint32_t i = 0u; i < TEST_HOLD_NUM; i++) {
+            HOST_CHECK_EQ(0, hold[i].open(&ram.fs, "hold.bin", O_RDONLY));
+        }
+        (void)take_cnt();
+    }
+
+    HOST_CHECK_EQ(0, file.open(&ram.fs, path, O_RDONLY));
+    res.open = take_cnt();
+    for (ofs = 0u; ofs < TEST_FILE_SIZE; ofs += TEST_READ_SIZE) {
+        HOST_CHECK_EQ((ssize_t)TEST_READ_SIZE, file.read(buf, TEST_READ_SIZE));
+        res.err_cnt += RamFs::verify(buf, seed, ofs, TEST_READ_SIZE);
+    }
+    res.seq = take_cnt();
+
+    srand(seed);
+    for (uint32_t i = 0u; i < TEST_SEEK_NUM; i++) {
+        ofs = (uint32_t)rand() % (TEST_FILE_SIZE - TEST_READ_SIZE);
+        HOST_CHECK_EQ((off_t)ofs, file.seek((off_t)ofs, SEEK_SET));
+        HOST_CHECK_EQ((ssize_t)TEST_READ_SIZE, file.read(buf, TEST_READ_SIZE));
+        res.err_cnt += RamFs::verify(buf, seed, ofs, TEST_READ_SIZE);
+    }
+    res.seek = take_cnt();
+    HOST_CHECK_EQ(0, file.close());
+    return res;
+}
+
+static void print_result(const char * const name, const read_result_t &res)
+{
+    (void)printf("  %-24s open %4u reads (%4u FAT), sequential %5u reads (%4u FAT), %u seeks %5u reads (%4u FAT)\n",
+                 name, (unsigned)res.open.read_cnt, (unsigned)res.open.fat_cnt,
+                 (unsigned)res.seq.read_cnt, (unsigned)res.seq.fat_cnt, TEST_SEEK_NUM,
+                 (unsigned)res.seek.read_cnt, (unsigned)res.seek.fat_cnt);
+}
+
+static void test_fastseek(void)
+{
+    read_result_t   map;
+    read_result_t   chain;
+
+    (void)printf("%u MB file in 32 fragments:\n", TEST_FILE_SIZE >> 20);
+    map = read_file("frag32.bin", 32u, false);
+    chain = read_file("frag32.bin", 32u, true);
+    print_result("CLMT", map);
+    print_result("chain (tables held)", chain);
+    HOST_CHECK_EQ(0u, map.err_cnt);
+    HOST_CHECK_EQ(0u, chain.err_cnt);
+    /* Only the open of a mapped file reads the FAT. */
+    HOST_CHECK(map.open.fat_cnt > 0u);
+    HOST_CHECK_EQ(0u, map.seq.fat_cnt);
+    HOST_CHECK_EQ(0u, map.seek.fat_cnt);
+    HOST_CHECK_EQ(TEST_FILE_SIZE / TEST_READ_SIZE, map.seq.read_cnt);
+    HOST_CHECK_EQ(0u, chain.open.fat_cnt);
+    HOST_CHECK(chain.seq.fat_cnt > 0u);
+    HOST_CHECK(chain.seek.fat_cnt > TEST_SEEK_NUM);
+
+    /* 512 fragments do not fit a table of MBED_CONF_FILESYSTEM_FAT_CLMT_SIZE. */
+    (void)printf("%u MB file in 512 fragments:\n", TEST_FILE_SIZE >> 20);
+    map = read_file("frag512.bin", 512u, false);
+    chain = read_file("frag512.bin", 512u, true);
+    print_result("CLMT (too small)", map);
+    print_result("chain (tables held)", chain);
+    HOST_CHECK_EQ(0u, map.err_cnt);
+    HOST_CHECK_EQ(0u, chain.err_cnt);
+    HOST_CHECK_EQ(chain.seq.read_cnt, map.seq.read_cnt);
+    HOST_CHECK_EQ(chain.seq.fat_cnt, map.seq.fat_cnt);
+    HOST_CHECK_EQ(chain.seek.read_cnt, map.seek.read_cnt);
+    HOST_CHECK_EQ(chain.seek.fat_cnt, map.seek.fat_cnt);
+}
+
+int main(void)
+{
+    HOST_CHECK(ram.format(TEST_CLUSTER));
+    HOST_CHECK(ram.write_file("hold.bin", TEST_CLUSTER, 1u));
+    HOST_CHECK(ram.write_file("frag32.bin", TEST_FILE_SIZE, 32u, 32u));
+    HOST_CHECK(ram.write_file("frag512.bin", TEST_FILE_SIZE, 512u, 512u));
+    test_fastseek();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,262 @@
+/* Host stress test of the per-volume locking of FATFileSystem.
+ *
+ * A 64 MB FAT16 volume with 4 KB clusters is on a HeapBlockDevice, without
+ * the ProfilingBlockDevice of ram_fs.h, whose counters are not meant for
+ * several threads. The pthreads are:
+ *  - TEST_READER_NUM readers: each reads its 2 MB track TEST_PASS_NUM
+ *    times in 4 KB reads and checks the data;
+ *  - a scanner: lists a directory of TEST_DIR_NUM long file names;
+ *  - a writer: rewrites index files sector by sector, so that
+ *    FLUSH_ON_NEW_SECTOR syncs the file on every write, and reads them
+ *    back.
+ * The scanner and the writer run until the readers end. The tracks are
+ * read once mapped (a free CLMT for each reader) and once on the FAT
+ * chain, with the tables held by the main thread.
+ *  - Mapped: the reads take no lock at all (PlatformMutex stub counts the
+ *    locks of each thread). Only the opens and the closes lock.
+ *  - Chain: each read takes the grant of the volume once.
+ *  - No data read differs from the data written, no call fails, and the
+ *    test does not hang (the sync of f_write runs with the grant held).
+ * The test prints the reads, the locks, the scans and the index writes of
+ * each run. test_fat_lock_tsan is the same test under ThreadSanitizer.
+ */
+#include <pthread.h>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+
+#define TEST_DISK_SIZE      (64u * 1024u * 1024u)
+#define TEST_CLUSTER        (4096)
+#define TEST_TRACK_SIZE     (2u * 1024u * 1024u)
+#define TEST_READ_SIZE      (4096u)
+#define TEST_PASS_NUM       (4u)
+#define TEST_READER_NUM     (MBED_CONF_FILESYSTEM_FAT_CLMT_NUM)
+#define TEST_DIR_NAME       "Music Folder"
+#define TEST_DIR_NUM        (300u)
+#define TEST_INDEX_NUM      (4u)
+#define TEST_INDEX_SIZE     (16u * 1024u)
+#define TEST_INDEX_SEED     (1000u)
+
+typedef struct {
+    uint32_t    id;
+    uint32_t    read_cnt;
+    uint32_t    read_lock_cnt;      /* Locks taken by the read calls */
+    uint32_t    lock_cnt;           /* Locks taken by the opens and the closes */
+    uint32_t    err_cnt;            /* Failed calls and bytes which differ */
+} reader_stat_t;
+
+typedef struct {
+    uint32_t    scan_cnt;
+    uint32_t    write_cnt;
+    uint32_t    err_cnt;
+} worker_stat_t;
+
+static HeapBlockDevice  heap(TEST_DISK_SIZE, RAM_FS_SECTOR);
+static FATFileSystem    fs("lock");
+static volatile bool    is_read;
+
+static void track_path(char * const path, const size_t size, const uint32_t id)
+{
+    (void)snprintf(path, size, "track%02u.bin", (unsigned)id);
+}
+
+static void *reader_thread(void *p_arg)
+{
+    reader_stat_t * const   p_stat = (reader_stat_t *)p_arg;
+    File                    file;
+    char                    path[32];
+    uint8_t                 buf[TEST_READ_SIZE];
+    unsigned long           lock;
+
+    track_path(path, sizeof(path), p_stat->id);
+    for (uint32_t pass = 0u; pass < TEST_PASS_NUM; pass++) {
+        lock = PlatformMutex::thread_lock_count();
+        if (file.open(&fs, path, O_RDONLY) != 0) {
+            p_stat->err_cnt++;
+            break;
+        }
+        p_stat->lock_cnt += PlatformMutex::thread_lock_count() - lock;
+        for (uint32_t ofs = 0u; ofs < TEST_TRACK_SIZE; ofs += TEST_READ_SIZE) {
+            lock = PlatformMutex::thread_lock_count();
+            if (file.read(buf, TEST_READ_SIZE) != (ssize_t)TEST_READ_SIZE) {
+                p_stat->err_cnt++;
+            }
+            p_stat->read_lock_cnt += PlatformMutex::thread_lock_count() - lock;
+            p_stat->read_cnt++;
+            p_stat->err_cnt += RamFs::verify(buf, p_stat->id, ofs, TEST_READ_SIZE);
+        }
+        lock = PlatformMutex::thread_lock_count();
+        if (file.close() != 0) {
+            p_stat->err_cnt++;
+        }
+        p_stat->lock_cnt += PlatformMutex::thread_lock_count() - lock;
+    }
+    return NULL;
+}
+
+static void *scanner_thread(void *p_arg)
+{
+    worker_stat_t * const   p_stat = (worker_stat_t *)p_arg;
+    Dir                     dir;
+    struct dirent           ent;
+    uint32_t                cnt;
+
+    do {
+        if (dir.open(&fs, TEST_DIR_NAME) != 0) {
+            p_stat->err_cnt++;
+            break;
+        }
+        cnt = 0u;
+        while (dir.read(&ent) > 0) {
+            if (ent.d_name[0] != '.') {
+                cnt++;
+            }
+        }
+        if (cnt != TEST_DIR_NUM) {
+            p_stat->err_cnt++;
+        }
+        if (dir.close() != 0) {
+            p_stat->err_cnt++;
+        }
+        p_stat->scan_cnt++;
+    } while (__atomic_load_n(&is_read, __ATOMIC_ACQUIRE) != true);
+    return NULL;
+}
+
+static void *writer_thread(void *p_arg)
+{
+    worker_stat_t * const   p_stat = (worker_stat_t *)p_arg;
+    File                    file;
+    char                    path[32];
+    uint8_t                 buf[RAM_FS_SECTOR];
+    uint32_t                seed;
+
+    do {
+        (void)snprintf(path, sizeof(path), "index%u.idx", (unsigned)(p_stat->write_cnt % TEST_INDEX_NUM));
+        seed = TEST_INDEX_SEED + p_stat->write_cnt;
+        if (file.open(&fs, path, O_WRONLY | O_CREAT | O_TRUNC) != 0) {
+            p_stat->err_cnt++;
+            break;
+        }
+        for (uint32_t ofs = 0u; ofs < TEST_INDEX_SIZE; ofs += sizeof(buf)) {
+            RamFs::fill(buf, seed, ofs, sizeof(buf));
+            if (file.write(buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+                p_stat->err_cnt++;
+            }
+        }
+        if (file.close() != 0) {
+            p_stat->err_cnt++;
+        }
+        /* O_RDWR, so that the check takes no table of the readers. */
+        if (file.open(&fs, path, O_RDWR) != 0) {
+            p_stat->err_cnt++;
+            break;
+        }
+        for (uint32_t ofs = 0u; ofs < TEST_INDEX_SIZE; ofs += sizeof(buf)) {
+            if (file.read(buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+                p_stat->err_cnt++;
+            }
+            p_stat->err_cnt += RamFs::verify(buf, seed, ofs, sizeof(buf));
+        }
+        if (file.close() != 0) {
+            p_stat->err_cnt++;
+        }
+        p_stat->write_cnt++;
+    } while (__atomic_load_n(&is_read, __ATOMIC_ACQUIRE) != true);
+    return NULL;
+}
+
+/* Runs the readers, the scanner and the writer together. With is_hold, */
+/* the tables are held, so the tracks are read on the FAT chain. */
+static void run(const char * const name, const bool is_hold)
+{
+    File            hold[TEST_READER_NUM];
+    reader_stat_t   reader[TEST_READER_NUM] = {};
+    worker_stat_t   worker = {};
+    pthread_t       reader_id[TEST_READER_NUM];
+    pthread_t       scanner_id;
+    pthread_t       writer_id;
+    uint64_t        start;
+    reader_stat_t   sum = {};
+
+    if (is_hold == true) {
+        for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+            HOST_CHECK_EQ(0, hold[i].open(&fs, "hold.bin", O_RDONLY));
+        }
+    }
+    is_read = false;
+    start = host_time_ns();
+    HOST_CHECK_EQ(0, pthread_create(&scanner_id, NULL, scanner_thread, &worker));
+    HOST_CHECK_EQ(0, pthread_create(&writer_id, NULL, writer_thread, &worker));
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        reader[i].id = i;
+        HOST_CHECK_EQ(0, pthread_create(&reader_id[i], NULL, reader_thread, &reader[i]));
+    }
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        HOST_CHECK_EQ(0, pthread_join(reader_id[i], NULL));
+        sum.read_cnt += reader[i].read_cnt;
+        sum.read_lock_cnt += reader[i].read_lock_cnt;
+        sum.lock_cnt += reader[i].lock_cnt;
+        sum.err_cnt += reader[i].err_cnt;
+    }
+    __atomic_store_n(&is_read, true, __ATOMIC_RELEASE);
+    HOST_CHECK_EQ(0, pthread_join(scanner_id, NULL));
+    HOST_CHECK_EQ(0, pthread_join(writer_id, NULL));
+
+    (void)printf("  %-8s %5u reads (%5u locks), %3u locks of open/close, %4u scans, %4u index writes, %5.0f ms\n",
+                 name, (unsigned)sum.read_cnt, (unsigned)sum.read_lock_cnt, (unsigned)sum.lock_cnt,
+                 (unsigned)worker.scan_cnt, (unsigned)worker.write_cnt,
+                 (double)(host_time_ns() - start) / 1e6);
+    HOST_CHECK_EQ(TEST_READER_NUM * TEST_PASS_NUM * (TEST_TRACK_SIZE / TEST_READ_SIZE), sum.read_cnt);
+    HOST_CHECK_EQ(0u, sum.err_cnt);
+    HOST_CHECK_EQ(0u, worker.err_cnt);
+    HOST_CHECK(worker.scan_cnt > 0u);
+    HOST_CHECK(worker.write_cnt > 0u);
+    if (is_hold == true) {
+        HOST_CHECK_EQ(sum.read_cnt, sum.read_lock_cnt);
+    } else {
+        HOST_CHECK_EQ(0u, sum.read_lock_cnt);
+    }
+}
+
+static bool write_pattern(const char * const path, const uint32_t size, const uint32_t seed)
+{
+    File                    file;
+    std::vector<uint8_t>    buf(size);
+    bool                    result;
+
+    RamFs::fill(&buf[0], seed, 0u, size);
+    result = (file.open(&fs, path, O_WRONLY | O_CREAT | O_TRUNC) == 0);
+    if (result == true) {
+        result = (file.write(&buf[0], size) == (ssize_t)size);
+        if (file.close() != 0) {
+            result = false;
+        }
+    }
+    return result;
+}
+
+int main(void)
+{
+    char    path[64];
+
+    HOST_CHECK_EQ(0, FATFileSystem::format(&heap, TEST_CLUSTER));
+    HOST_CHECK_EQ(0, fs.mount(&heap));
+    HOST_CHECK(write_pattern("hold.bin", TEST_CLUSTER, 0u));
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        track_path(path, sizeof(path), i);
+        HOST_CHECK(write_pattern(path, TEST_TRACK_SIZE, i));
+    }
+    HOST_CHECK_EQ(0, fs.mkdir(TEST_DIR_NAME, 0777));
+    for (uint32_t i = 0u; i < TEST_DIR_NUM; i++) {
+        (void)snprintf(path, sizeof(path), TEST_DIR_NAME "/%03u - A track with a long file name.flac", (unsigned)i);
+        HOST_CHECK(write_pattern(path, RAM_FS_SECTOR, i));
+    }
+
+    (void)printf("%u readers of %u MB tracks, a scanner of %u names and an index writer:\n",
+                 (unsigned)TEST_READER_NUM, TEST_TRACK_SIZE >> 20, TEST_DIR_NUM);
+    run("mapped", false);
+    run("chain", true);
+    HOST_CHECK_EQ(0, fs.unmount());
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,271 @@
+/* Host test of the key inputs: key_sw (SW0 debounce) and key_cmd (command-line).
+ *
+ * SW0: the loop of key_thread() is simulated by events. The thread wakes
+ * at each edge of the pin (SIG_SW) and at the timeout of sw_get_wait_time(),
+ * and waits forever otherwise.
+ *  - A press is reported once, SW_DECISION_TIME after the last edge.
+ *  - Bouncing edges restart the decision time; glitches and presses shorter
+ *    than SW_DECISION_TIME are not reported.
+ *  - The time may wrap around during the decision.
+ *  - Without edges the thread does not wake up.
+ * Command-line: the characters are received by disp_uart on the simulated
+ * UART (uart_sim.h), and cmd_main_proc() is called like on SIG_CMD.
+ *  - Backspace editing, overlong lines, CR/LF pairs, and several commands
+ *    in one burst, read one line per call.
+ *  - The display is notified once per call, and unknown commands print
+ *    a message.
+ *  - "eq" takes the preset as its argument. A missing, unknown or extra
+ *    argument is an unknown command.
+ */
+#include <string.h>
+#include <string>
+#include <vector>
+#include "host_test.h"
+#include "key_sw.h"
+#include "key_cmd.h"
+#include "display.h"
+#include "disp_uart.h"
+#include "uart_sim.h"
+
+#define SW_RELEASED         (1)
+
+typedef struct {
+    uint32_t    time_ms;
+    int32_t     level;
+} edge_t;
+
+typedef struct {
+    std::vector<uint32_t>   key_time;   /* Times of SYS_KEYCODE_PLAYPAUSE */
+    uint32_t                wake_cnt;
+} sw_result_t;
+
+static std::vector<std::string> input_notice;   /* dsp_notify_input_string() */
+static std::vector<bool>        input_fin;
+static std::vector<std::string> print_notice;   /* dsp_notify_print_string() */
+
+bool dsp_notify_input_string(const char_t * const p_str, const bool flag_fin)
+{
+    input_notice.push_back(p_str);
+    input_fin.push_back(flag_fin);
+    return true;
+}
+
+bool dsp_notify_print_string(const char_t * const p_str)
+{
+    print_notice.push_back(p_str);
+    return true;
+}
+
+/* Runs the SW0 part of key_thread() from start_ms to end_ms with the edges. */
+static sw_result_t run_sw(const uint32_t start_ms, const std::vector<edge_t> &edges, const uint32_t end_ms)
+{
+    sw_ctrl_t       sw;
+    sw_result_t     res;
+    int32_t         level = SW_RELEASED;
+    uint32_t        now = start_ms;
+    uint32_t        wait_ms;
+    uint32_t        wake;
+    size_t          next = 0u;
+    bool            is_edge = false;
+
+    res.wake_cnt = 0u;
+    sw_init_proc(&sw, now);
+    while ((now - start_ms) < (end_ms - start_ms)) {
+        if (is_edge == true) {
+            sw_edge_proc(&sw, now);
+        }
+        if (sw_main_proc(&sw, level, now) == SYS_KEYCODE_PLAYPAUSE) {
+            res.key_time.push_back(now - start_ms);
+        }
+        /* Waits for the next edge or the timeout. */
+        wake = end_ms;
+        is_edge = false;
+        if (sw_get_wait_time(&sw, now, &wait_ms) == true) {
+            wake = now + wait_ms;
+        }
+        if ((next < edges.size()) && ((edges[next].time_ms - now) <= (wake - now))) {
+            wake = edges[next].time_ms;
+            level = edges[next].level;
+            is_edge = true;
+            next++;
+        }
+        if ((wake - start_ms) < (end_ms - start_ms)) {
+            res.wake_cnt++;
+        }
+        now = wake;
+    }
+    return res;
+}
+
+static std::vector<edge_t> press(const uint32_t at, const uint32_t len)
+{
+    std::vector<edge_t>     edges;
+
+    edges.push_back((edge_t){ at, SW_ACTIVE_LEVEL });
+    edges.push_back((edge_t){ at + len, SW_RELEASED });
+    return edges;
+}
+
+static void test_sw(void)
+{
+    std::vector<edge_t>     edges;
+    sw_result_t             res;
+    const uint32_t          wrap = 0xFFFFFFF0u;
+
+    /* Idle: only the decision of the initial status. */
+    res = run_sw(0u, edges, 10000u);
+    HOST_CHECK_EQ(0u, res.key_time.size());
+    HOST_CHECK_EQ(1u, res.wake_cnt);
+
+    /* A clean press of 200 ms is reported once, 50 ms after the edge. */
+    edges = press(1000u, 200u);
+    res = run_sw(0u, edges, 10000u);
+    HOST_CHECK_EQ(1u, res.key_time.size());
+    HOST_CHECK_EQ(1000u + SW_DECISION_TIME, res.key_time[0]);
+
+    /* Bouncing edges at the press and the release. */
+    edges.clear();
+    for (uint32_t i = 0u; i < 6u; i++) {
+        edges.push_back((edge_t){ 1000u + (i * 3u), ((i % 2u) == 0u) ? SW_ACTIVE_LEVEL : SW_RELEASED });
+    }
+    edges.push_back((edge_t){ 1020u, SW_ACTIVE_LEVEL });
+    for (uint32_t i = 0u; i < 5u; i++) {
+        edges.push_back((edge_t){ 1500u + (i * 4u), ((i % 2u) == 0u) ? SW_RELEASED : SW_ACTIVE_LEVEL });
+    }
+    res = run_sw(0u, edges, 10000u);
+    HOST_CHECK_EQ(1u, res.key_time.size());
+    HOST_CHECK_EQ(1020u + SW_DECISION_TIME, res.key_time[0]);
+
+    /* A glitch of 5 ms and a press of 49 ms are not reported. 51 ms is. */
+    res = run_sw(0u, press(1000u, 5u), 10000u);
+    HOST_CHECK_EQ(0u, res.key_time.size());
+    res = run_sw(0u, press(1000u, SW_DECISION_TIME - 1u), 10000u);
+    HOST_CHECK_EQ(0u, res.key_time.size());
+    res = run_sw(0u, press(1000u, SW_DECISION_TIME + 1u), 10000u);
+    HOST_CHECK_EQ(1u, res.key_time.size());
+
+    /* Two presses are two keys, and a long hold is one key. The thread */
+    /* wakes once per edge and once per decision, after the initial one. */
+    edges = press(1000u, 100u);
+    edges.push_back((edge_t){ 1300u, SW_ACTIVE_LEVEL });
+    res = run_sw(0u, edges, 100000u);
+    HOST_CHECK_EQ(2u, res.key_time.size());
+    HOST_CHECK_EQ(1u + (3u * 2u), res.wake_cnt);
+
+    /* The ms counter wraps around during the decision. */
+    edges.clear();
+    edges.push_back((edge_t){ wrap + 10u, SW_ACTIVE_LEVEL });
+    res = run_sw(wrap - 100u, edges, wrap + 1000u);
+    HOST_CHECK_EQ(1u, res.key_time.size());
+    HOST_CHECK_EQ(110u + SW_DECISION_TIME, res.key_time[0]);
+}
+
+/* Receives the string on the UART in FIFO sized pieces. */
+static void receive(const std::string &str)
+{
+    for (size_t i = 0u; i < str.size(); i += UART_SIM_FIFO_SIZE) {
+        uart_sim_receive(&str[i], (uint32_t)(((str.size() - i) < UART_SIM_FIFO_SIZE) ?
+                                              (str.size() - i) : UART_SIM_FIFO_SIZE));
+    }
+}
+
+static void clear_notice(void)
+{
+    input_notice.clear();
+    input_fin.clear();
+    print_notice.clear();
+}
+
+static void test_cmd(void)
+{
+    cmd_ctrl_t      cmd;
+    std::string     str;
+
+    cmd_init_proc(&cmd);
+    clear_notice();
+
+    /* Nothing received. */
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(0u, input_notice.size());
+
+    /* Typing, one notice per call with the string so far. */
+    receive("st");
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    receive("pp\b\bop");
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(2u, input_notice.size());
+    HOST_CHECK(input_notice[0] == "st");
+    HOST_CHECK(input_notice[1] == "stop");
+    HOST_CHECK(input_fin[1] == false);
+    receive("\r");
+    HOST_CHECK_EQ(SYS_KEYCODE_STOP, cmd_main_proc(&cmd));
+    HOST_CHECK(input_fin[2] == true);
+    HOST_CHECK_EQ(0u, print_notice.size());
+
+    /* Backspace on the empty line, and the case of the letters. */
+    clear_notice();
+    receive("\b\bNeXt\r");
+    HOST_CHECK_EQ(SYS_KEYCODE_NEXT, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(1u, input_notice.size());
+
+    /* An overlong line is cut at CMD_INPUT_MAX_LEN - 1 characters. */
+    clear_notice();
+    str = "playpause";
+    str.append(40u, 'x');
+    receive(str + "\r");
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(CMD_INPUT_MAX_LEN - 1u, input_notice[0].size());
+    HOST_CHECK_EQ(1u, print_notice.size());
+    clear_notice();
+    str = "playpause";
+    str.append(40u, '\b');
+    str.append(1u, '\r');
+    receive(str);
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(0u, print_notice.size());
+
+    /* CR/LF: the LF ends an empty line, which is not a command. */
+    clear_notice();
+    receive("prev\r\n");
+    HOST_CHECK_EQ(SYS_KEYCODE_PREV, cmd_main_proc(&cmd));
+    HOST_CHECK(dsp_uart_readable());
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK(dsp_uart_readable() == false);
+    HOST_CHECK_EQ(0u, print_notice.size());
+
+    /* Several commands in one burst, one line per call. */
+    clear_notice();
+    receive("help\rmute\rbad\rmeter\r");
+    HOST_CHECK_EQ(SYS_KEYCODE_HELP, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_MUTE, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_METER, cmd_main_proc(&cmd));
+    HOST_CHECK(dsp_uart_readable() == false);
+    HOST_CHECK_EQ(4u, input_notice.size());
+    HOST_CHECK_EQ(1u, print_notice.size());
+
+    /* The equalizer presets take an argument, in any case of the letters. */
+    clear_notice();
+    receive("eq bass\r  EQ   Treble \req flat\req\req loud\rmute on\req bass x\r");
+    HOST_CHECK_EQ(SYS_KEYCODE_EQ_BASS, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_EQ_TREBLE, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_EQ_FLAT, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(0u, print_notice.size());
+    /* The argument missing, unknown or extra. */
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(3u, print_notice.size());
+    /* More words than MAX_CNT_OF_ARG are ignored without the notice. */
+    HOST_CHECK_EQ(SYS_KEYCODE_NON, cmd_main_proc(&cmd));
+    HOST_CHECK_EQ(3u, print_notice.size());
+    HOST_CHECK(dsp_uart_readable() == false);
+}
+
+int main(void)
+{
+    dsp_uart_init();
+    test_sw();
+    test_cmd();
+    return HOST_TEST_RESULT();
+}
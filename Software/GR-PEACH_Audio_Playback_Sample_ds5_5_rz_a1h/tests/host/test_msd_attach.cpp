@@ -0,0 +1,270 @@
+/* Host test of the attach of a USB memory: device event, TEST UNIT READY
+ * polling and the cached init() of USBHostMSD.
+ *
+ * USBHostMSD runs unchanged on the simulated BOT device of sim/msd_sim.cpp.
+ * The device holds a FAT image of ram_fs.h with TEST_FOLDER_NUM folders of
+ * TEST_TRACK_NUM tracks. As on the target, the device event of the host
+ * wakes the main thread, which connects the driver, initializes it, mounts
+ * FatFs and reads the first track of the first folder. The times of each
+ * step from the event are printed for a device ready at once, after 30 ms
+ * and after 200 ms. The first READ CAPACITY of each attach reports a unit
+ * attention. The checks are:
+ *  - TEST UNIT READY fails while the device is not ready (a CHECK
+ *    CONDITION fails the command, after REQUEST SENSE), and the first try
+ *    after the ready time succeeds;
+ *  - the tries follow the backoff schedule, from their times as logged by
+ *    the device: the waits double from USBHOST_MSD_TUR_FIRST_WAIT_MS up to
+ *    USBHOST_MSD_TUR_MAX_WAIT_MS. A gap is at least its wait and at most
+ *    TEST_SLACK_MS more, for the scheduling of a loaded host, and there are
+ *    no more tries than the schedule fits in the ready time;
+ *  - the unit attention is retried, so init() succeeds;
+ *  - a second init() returns at once without any command;
+ *  - the detach clears the device: connect() fails until the next attach,
+ *    whose init() sends the commands again;
+ *  - a device which is never ready fails init() after
+ *    USBHOST_MSD_TUR_TIMEOUT_MS.
+ */
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+#include "USBHostMSD/USBHostMSD.h"
+#include "msd_sim.h"
+
+#define TEST_DISK_SIZE      (32u * 1024u * 1024u)
+#define TEST_CLUSTER        (4096)
+#define TEST_FOLDER_NUM     (4u)
+#define TEST_TRACK_NUM      (10u)
+#define TEST_TRACK_SIZE     (64u * 1024u)
+#define TEST_READ_SIZE      (8u * 1024u)
+#define TEST_BYTE_NS        (40u)       /* 25 MB/s */
+#define TEST_CMD_US         (60u)
+#define TEST_SLACK_MS       (50u)       /* Scheduling of the host, per wait */
+#define TEST_NEVER_MS       (60000u)
+
+typedef struct {
+    uint32_t    init_ms;                /* connect() and init() */
+    uint32_t    mount_ms;
+    uint32_t    track_ms;               /* First track opened and read */
+} attach_time_t;
+
+static RamFs            ram("img", TEST_DISK_SIZE);
+static FATFileSystem    usb_fs("usb");
+static USBHostMSD       *msd;
+static Semaphore        event_sem;
+static uint64_t         event_ns;
+
+/* Called from the thread which attaches or detaches, as from the USB */
+/* thread on the target. */
+static void device_event(void)
+{
+    event_ns = host_time_ns();
+    (void)event_sem.release();
+}
+
+static void track_path(char * const path, const size_t size, const uint32_t folder, const uint32_t track)
+{
+    (void)snprintf(path, size, "Music/Folder %02u/%02u - Track.wav", (unsigned)folder, (unsigned)track);
+}
+
+static void make_image(void)
+{
+    char    path[64];
+
+    HOST_CHECK(ram.format(TEST_CLUSTER));
+    HOST_CHECK_EQ(0, ram.fs.mkdir("Music", 0777));
+    for (uint32_t folder = 0u; folder < TEST_FOLDER_NUM; folder++) {
+        (void)snprintf(path, sizeof(path), "Music/Folder %02u", (unsigned)folder);
+        HOST_CHECK_EQ(0, ram.fs.mkdir(path, 0777));
+        for (uint32_t track = 0u; track < TEST_TRACK_NUM; track++) {
+            track_path(path, sizeof(path), folder, track);
+            HOST_CHECK(ram.write_file(path, TEST_TRACK_SIZE, (folder * TEST_TRACK_NUM) + track));
+        }
+    }
+    HOST_CHECK_EQ(0, ram.fs.unmount());
+}
+
+static uint32_t ms_since_event(void)
+{
+    return (uint32_t)((host_time_ns() - event_ns) / 1000000u);
+}
+
+static msd_sim_config_t device_config(const uint32_t ready_ms)
+{
+    msd_sim_config_t    config = {};
+
+    config.bd = &ram.heap;
+    config.ready_ms = ready_ms;
+    config.unit_attention = true;
+    config.cmd_us = TEST_CMD_US;
+    config.byte_ns = TEST_BYTE_NS;
+    return config;
+}
+
+/* Reads the first track of the first folder, as the scan finds it. */
+static bool read_first_track(void)
+{
+    Dir                     dir;
+    File                    file;
+    struct dirent           ent;
+    std::vector<uint8_t>    buf(TEST_READ_SIZE);
+    char                    path[64];
+    bool                    result = false;
+
+    if (dir.open(&usb_fs, "Music/Folder 00") == 0) {
+        while ((result != true) && (dir.read(&ent) > 0)) {
+            result = (ent.d_name[0] != '.');
+        }
+        (void)dir.close();
+    }
+    track_path(path, sizeof(path), 0u, 0u);
+    result = result && (strcmp(ent.d_name, strrchr(path, '/') + 1) == 0);
+    result = result && (file.open(&usb_fs, path, O_RDONLY) == 0);
+    if (result == true) {
+        result = (file.read(&buf[0], TEST_READ_SIZE) == (ssize_t)TEST_READ_SIZE) &&
+                 (RamFs::verify(&buf[0], 0u, 0u, TEST_READ_SIZE) == 0u);
+        (void)file.close();
+    }
+    return result;
+}
+
+static uint32_t tur_wait_ms(const uint32_t wait_ms)
+{
+    return ((wait_ms * 2u) < USBHOST_MSD_TUR_MAX_WAIT_MS) ? (wait_ms * 2u) : USBHOST_MSD_TUR_MAX_WAIT_MS;
+}
+
+/* Checks the gaps between the logged TEST UNIT READY against the waits of */
+/* the schedule. Only the lower bound is exact: the host may sleep longer. */
+static void check_tur_schedule(const msd_sim_stat_t &stat)
+{
+    const uint32_t  num = (stat.tur_cnt < MSD_SIM_TUR_LOG_NUM) ? stat.tur_cnt : MSD_SIM_TUR_LOG_NUM;
+    uint32_t        wait_ms = USBHOST_MSD_TUR_FIRST_WAIT_MS;
+    uint32_t        gap_us;
+
+    for (uint32_t i = 1u; i < num; i++) {
+        gap_us = stat.tur_us[i] - stat.tur_us[i - 1u];
+        HOST_CHECK(gap_us >= (wait_ms * 1000u));
+        HOST_CHECK(gap_us <= ((wait_ms + TEST_SLACK_MS) * 1000u));
+        wait_ms = tur_wait_ms(wait_ms);
+    }
+}
+
+/* Tries that the schedule fits until ready_ms: the first one, and one */
+/* after each wait which ends before ready_ms, the ready try included. */
+static uint32_t tur_max_num(const uint32_t ready_ms)
+{
+    uint32_t    num = 1u;
+    uint32_t    time_ms = 0u;
+    uint32_t    wait_ms = USBHOST_MSD_TUR_FIRST_WAIT_MS;
+
+    while (time_ms < ready_ms) {
+        time_ms += wait_ms;
+        wait_ms = tur_wait_ms(wait_ms);
+        num++;
+    }
+    return num;
+}
+
+/* Attaches a device ready after ready_ms and plays it as the main thread */
+/* of the firmware does after the device event. */
+static void attach(const uint32_t ready_ms)
+{
+    attach_time_t   time = {};
+    msd_sim_stat_t  stat;
+
+    msd_sim_attach(0u, device_config(ready_ms));
+    HOST_CHECK(event_sem.wait(1000) > 0);
+    HOST_CHECK(msd->connect());
+    HOST_CHECK_EQ(0, msd->init());
+    time.init_ms = ms_since_event();
+    stat = msd_sim_get_stat(0u);
+    HOST_CHECK_EQ(0, usb_fs.mount(msd, true));
+    time.mount_ms = ms_since_event();
+    HOST_CHECK(read_first_track());
+    time.track_ms = ms_since_event();
+    (void)printf("  ready %3u ms: %2u TEST UNIT READY (%2u not ready), init %3u ms, mount %3u ms, first track %3u ms\n",
+                 (unsigned)ready_ms, (unsigned)stat.tur_cnt, (unsigned)stat.not_ready_cnt,
+                 (unsigned)time.init_ms, (unsigned)time.mount_ms, (unsigned)time.track_ms);
+
+    HOST_CHECK(time.init_ms >= ready_ms);
+    HOST_CHECK_EQ(stat.tur_cnt - 1u, stat.not_ready_cnt);
+    HOST_CHECK(stat.tur_cnt <= tur_max_num(ready_ms));
+    HOST_CHECK(stat.tur_us[stat.tur_cnt - 1u] >= (ready_ms * 1000u));
+    if (stat.tur_cnt >= 2u) {
+        HOST_CHECK(stat.tur_us[stat.tur_cnt - 2u] < (ready_ms * 1000u));
+    }
+    check_tur_schedule(stat);
+    /* REQUEST SENSE after each failed TEST UNIT READY and the unit attention. */
+    HOST_CHECK_EQ(stat.not_ready_cnt + 1u, stat.sense_cnt);
+    HOST_CHECK_EQ(0u, stat.bot_err_cnt);
+    if (ready_ms == 0u) {
+        HOST_CHECK_EQ(1u, stat.tur_cnt);
+    }
+}
+
+static void detach(void)
+{
+    HOST_CHECK_EQ(0, usb_fs.unmount());
+    msd_sim_detach(0u);
+    HOST_CHECK(event_sem.wait(1000) > 0);
+    HOST_CHECK(msd->connected() != true);
+    HOST_CHECK(msd->connect() != true);
+}
+
+static void test_attach(void)
+{
+    msd_sim_stat_t  stat;
+
+    (void)printf("%u folders of %u tracks, times from the device event:\n",
+                 TEST_FOLDER_NUM, TEST_TRACK_NUM);
+    attach(0u);
+
+    /* Initialized until the detach: no command at all. */
+    msd_sim_reset_stat(0u);
+    HOST_CHECK_EQ(0, msd->init());
+    stat = msd_sim_get_stat(0u);
+    HOST_CHECK_EQ(0u, stat.cmd_cnt);
+    detach();
+
+    attach(30u);
+    detach();
+    attach(200u);
+    detach();
+}
+
+static void test_never_ready(void)
+{
+    msd_sim_stat_t  stat;
+    uint64_t        start;
+    uint32_t        time_ms;
+
+    msd_sim_attach(0u, device_config(TEST_NEVER_MS));
+    HOST_CHECK(event_sem.wait(1000) > 0);
+    HOST_CHECK(msd->connect());
+    start = host_time_ns();
+    HOST_CHECK_EQ(BD_ERROR_DEVICE_ERROR, msd->init());
+    time_ms = (uint32_t)((host_time_ns() - start) / 1000000u);
+    stat = msd_sim_get_stat(0u);
+    (void)printf("  never ready: init fails in %u ms after %u TEST UNIT READY\n",
+                 (unsigned)time_ms, (unsigned)stat.tur_cnt);
+    HOST_CHECK(time_ms >= USBHOST_MSD_TUR_TIMEOUT_MS);
+    HOST_CHECK_EQ(stat.tur_cnt, stat.not_ready_cnt);
+    /* The doubling waits, then one try per USBHOST_MSD_TUR_MAX_WAIT_MS, */
+    /* and the last try at most one wait before USBHOST_MSD_TUR_TIMEOUT_MS. */
+    HOST_CHECK(stat.tur_cnt <= tur_max_num(USBHOST_MSD_TUR_TIMEOUT_MS));
+    HOST_CHECK(stat.tur_cnt <= MSD_SIM_TUR_LOG_NUM);
+    HOST_CHECK(stat.tur_us[stat.tur_cnt - 1u] >= ((USBHOST_MSD_TUR_TIMEOUT_MS - USBHOST_MSD_TUR_MAX_WAIT_MS) * 1000u));
+    check_tur_schedule(stat);
+    HOST_CHECK_EQ(0u, stat.bot_err_cnt);
+    msd_sim_detach(0u);
+    HOST_CHECK(event_sem.wait(1000) > 0);
+}
+
+int main(void)
+{
+    make_image();
+    USBHost::getHostInst()->attachDeviceEvent(device_event);
+    msd = new USBHostMSD();
+    test_attach();
+    test_never_ready();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,216 @@
+/* Host test of the queued reads and the read-ahead of USBHostMSD.
+ *
+ * USBHostMSD runs unchanged on the simulated BOT device of sim/msd_sim.cpp,
+ * a 16 MB HeapBlockDevice filled with the pattern of ram_fs.h, with a bus
+ * of TEST_BYTE_NS per byte and TEST_CMD_US per CBW and CSW. The test is
+ * built with USBHOST_MSD_READ_AHEAD_BLOCKS of the firmware (64) and with 0:
+ *  - readAsync(): USBHOST_MSD_ASYNC_QUEUE reads are queued while the
+ *    first one is on the bus, one more is refused, and the callbacks come
+ *    in order with the data;
+ *  - a stream of 8 KB reads with TEST_DECODE_US of decoding after each
+ *    one: with the read-ahead, the device gets one command per buffer and
+ *    the bus time is hidden behind the decoding;
+ *  - random 8 KB reads: one command each, the buffers are bypassed;
+ *  - program() in a stream: the next reads return the new data.
+ * No transfer breaks the BOT protocol (one command at a time, all of its
+ * stages on one thread) and all data read is checked. The decoding is a
+ * sleep, so that the overlap is seen on a single core host as well. The
+ * times compared are the times slept, which exceed the nominal ones.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+#include "USBHostMSD/USBHostMSD.h"
+#include "msd_sim.h"
+
+#define TEST_DISK_SIZE      (16u * 1024u * 1024u)
+#define TEST_SEED           (45u)
+#define TEST_BYTE_NS        (40u)       /* 25 MB/s */
+#define TEST_CMD_US         (60u)
+#define TEST_READ_SIZE      (8u * 1024u)
+#define TEST_STREAM_SIZE    (8u * 1024u * 1024u)
+#define TEST_DECODE_US      (250u)
+#define TEST_RANDOM_NUM     (200u)
+#define TEST_ASYNC_SIZE     (32u * 1024u)
+#define TEST_WRITE_SEED     (46u)
+
+#define ERROR_WOULD_BLOCK   (-5001)     /* USB_BLOCK_DEVICE_ERROR_WOULD_BLOCK */
+
+typedef struct {
+    Semaphore   done;
+    uint32_t    order[USBHOST_MSD_ASYNC_QUEUE];
+    int         result[USBHOST_MSD_ASYNC_QUEUE];
+    uint32_t    cnt;
+} async_log_t;
+
+typedef struct {
+    async_log_t *p_log;
+    uint32_t    id;
+} async_req_t;
+
+static HeapBlockDevice  heap(TEST_DISK_SIZE, RAM_FS_SECTOR);
+static USBHostMSD       *msd;
+
+static void fill_disk(void)
+{
+    std::vector<uint8_t>    buf(1024u * 1024u);
+
+    HOST_CHECK_EQ(0, heap.init());
+    for (uint32_t ofs = 0u; ofs < TEST_DISK_SIZE; ofs += (uint32_t)buf.size()) {
+        RamFs::fill(&buf[0], TEST_SEED, ofs, (uint32_t)buf.size());
+        HOST_CHECK_EQ(0, heap.program(&buf[0], ofs, buf.size()));
+    }
+}
+
+/* Called from the MSD thread. */
+static void async_done(async_req_t *p_req, int result)
+{
+    async_log_t * const p_log = p_req->p_log;
+
+    p_log->order[p_log->cnt] = p_req->id;
+    p_log->result[p_log->cnt] = result;
+    p_log->cnt++;
+    (void)p_log->done.release();
+}
+
+static void test_async(void)
+{
+    async_log_t             log;
+    async_req_t             req[USBHOST_MSD_ASYNC_QUEUE];
+    std::vector<uint8_t>    buf[USBHOST_MSD_ASYNC_QUEUE + 1u];
+    std::vector<uint8_t>    extra(TEST_ASYNC_SIZE);
+
+    log.cnt = 0u;
+    msd_sim_reset_stat(0u);
+    for (uint32_t i = 0u; i < USBHOST_MSD_ASYNC_QUEUE; i++) {
+        buf[i].resize(TEST_ASYNC_SIZE);
+        req[i].p_log = &log;
+        req[i].id = i;
+        HOST_CHECK_EQ(0, msd->readAsync(&buf[i][0], (bd_addr_t)i * TEST_ASYNC_SIZE, TEST_ASYNC_SIZE,
+                                        callback(async_done, &req[i])));
+    }
+    /* The first read is still on the bus, so the queue is full. */
+    HOST_CHECK_EQ(ERROR_WOULD_BLOCK, msd->readAsync(&extra[0], 0u, TEST_ASYNC_SIZE, Callback<void(int)>()));
+    for (uint32_t i = 0u; i < USBHOST_MSD_ASYNC_QUEUE; i++) {
+        (void)log.done.wait();
+    }
+    HOST_CHECK_EQ(USBHOST_MSD_ASYNC_QUEUE, log.cnt);
+    for (uint32_t i = 0u; i < USBHOST_MSD_ASYNC_QUEUE; i++) {
+        HOST_CHECK_EQ(i, log.order[i]);
+        HOST_CHECK_EQ(0, log.result[i]);
+        HOST_CHECK_EQ(0u, RamFs::verify(&buf[i][0], TEST_SEED, i * TEST_ASYNC_SIZE, TEST_ASYNC_SIZE));
+    }
+    HOST_CHECK_EQ(USBHOST_MSD_ASYNC_QUEUE, msd_sim_get_stat(0u).read_cmd_cnt);
+    HOST_CHECK_EQ(0u, msd_sim_get_stat(0u).bot_err_cnt);
+    (void)printf("  readAsync: %u reads of %u KB queued, the next one refused\n",
+                 (unsigned)USBHOST_MSD_ASYNC_QUEUE, TEST_ASYNC_SIZE >> 10);
+}
+
+static void test_stream(void)
+{
+    std::vector<uint8_t>    buf(TEST_READ_SIZE);
+    msd_sim_stat_t          stat;
+    uint32_t                err_cnt = 0u;
+    uint64_t                start;
+    uint64_t                time_ns;
+    uint64_t                decode_ns = 0u;
+
+    msd_sim_reset_stat(0u);
+    start = host_time_ns();
+    for (uint32_t ofs = 0u; ofs < TEST_STREAM_SIZE; ofs += TEST_READ_SIZE) {
+        HOST_CHECK_EQ(0, msd->read(&buf[0], ofs, TEST_READ_SIZE));
+        err_cnt += RamFs::verify(&buf[0], TEST_SEED, ofs, TEST_READ_SIZE);
+        time_ns = host_time_ns();
+        wait_us(TEST_DECODE_US);
+        decode_ns += host_time_ns() - time_ns;
+    }
+    time_ns = host_time_ns() - start;
+    stat = msd_sim_get_stat(0u);
+    (void)printf("  stream: %u MB in %u KB reads, %u us decoding each: %4u commands, %3.0f ms"
+                 " (bus %3.0f ms, decoding %3.0f ms)\n",
+                 TEST_STREAM_SIZE >> 20, TEST_READ_SIZE >> 10, TEST_DECODE_US, (unsigned)stat.read_cmd_cnt,
+                 (double)time_ns / 1e6, (double)stat.bus_ns / 1e6, (double)decode_ns / 1e6);
+    HOST_CHECK_EQ(0u, err_cnt);
+    HOST_CHECK_EQ(0u, stat.bot_err_cnt);
+#if USBHOST_MSD_READ_AHEAD_BLOCKS
+    /* One command per buffer, plus the first read and the last buffers. */
+    HOST_CHECK(stat.read_cmd_cnt <= ((TEST_STREAM_SIZE / (USBHOST_MSD_READ_AHEAD_BLOCKS * 512u)) + 3u));
+    HOST_CHECK(time_ns < ((stat.bus_ns + decode_ns) * 9u / 10u));
+#else
+    HOST_CHECK_EQ(TEST_STREAM_SIZE / TEST_READ_SIZE, stat.read_cmd_cnt);
+    HOST_CHECK(time_ns >= (stat.bus_ns + decode_ns));
+#endif
+}
+
+static void test_random(void)
+{
+    std::vector<uint8_t>    buf(TEST_READ_SIZE);
+    msd_sim_stat_t          stat;
+    uint32_t                err_cnt = 0u;
+    uint32_t                ofs;
+
+    msd_sim_reset_stat(0u);
+    srand(TEST_SEED);
+    for (uint32_t i = 0u; i < TEST_RANDOM_NUM; i++) {
+        ofs = ((uint32_t)rand() % (TEST_DISK_SIZE / TEST_READ_SIZE - 1u)) * TEST_READ_SIZE;
+        HOST_CHECK_EQ(0, msd->read(&buf[0], ofs, TEST_READ_SIZE));
+        err_cnt += RamFs::verify(&buf[0], TEST_SEED, ofs, TEST_READ_SIZE);
+    }
+    stat = msd_sim_get_stat(0u);
+    (void)printf("  random: %u reads of %u KB: %u commands, %u blocks\n", TEST_RANDOM_NUM,
+                 TEST_READ_SIZE >> 10, (unsigned)stat.read_cmd_cnt, (unsigned)stat.read_block_cnt);
+    HOST_CHECK_EQ(0u, err_cnt);
+    HOST_CHECK_EQ(0u, stat.bot_err_cnt);
+    HOST_CHECK(stat.read_cmd_cnt <= TEST_RANDOM_NUM);
+    HOST_CHECK(stat.read_block_cnt <= (TEST_RANDOM_NUM * (TEST_READ_SIZE / 512u)));
+}
+
+/* A block behind the reads of a stream is programmed: the stream reads */
+/* on with the new data. */
+static void test_program(void)
+{
+    const uint32_t          base = TEST_DISK_SIZE / 2u;
+    msd_sim_stat_t          stat;
+    const uint32_t          block = base + (3u * TEST_READ_SIZE);
+    std::vector<uint8_t>    buf(TEST_READ_SIZE);
+    uint8_t                 data[512];
+
+    msd_sim_reset_stat(0u);
+    HOST_CHECK_EQ(0, msd->read(&buf[0], base, TEST_READ_SIZE));
+    HOST_CHECK_EQ(0, msd->read(&buf[0], base + TEST_READ_SIZE, TEST_READ_SIZE));
+    RamFs::fill(data, TEST_WRITE_SEED, block, sizeof(data));
+    HOST_CHECK_EQ(0, msd->program(data, block, sizeof(data)));
+    HOST_CHECK_EQ(0, msd->read(&buf[0], base + (2u * TEST_READ_SIZE), TEST_READ_SIZE));
+    HOST_CHECK_EQ(0u, RamFs::verify(&buf[0], TEST_SEED, base + (2u * TEST_READ_SIZE), TEST_READ_SIZE));
+    HOST_CHECK_EQ(0, msd->read(&buf[0], block, TEST_READ_SIZE));
+    HOST_CHECK_EQ(0u, RamFs::verify(&buf[0], TEST_WRITE_SEED, block, sizeof(data)));
+    HOST_CHECK_EQ(0u, RamFs::verify(&buf[sizeof(data)], TEST_SEED, block + sizeof(data),
+                                    TEST_READ_SIZE - sizeof(data)));
+    stat = msd_sim_get_stat(0u);
+    HOST_CHECK_EQ(1u, stat.write_cmd_cnt);
+    HOST_CHECK_EQ(0u, stat.bot_err_cnt);
+    (void)printf("  program: a block ahead of a stream is read back new\n");
+}
+
+int main(void)
+{
+    msd_sim_config_t    config = {};
+
+    fill_disk();
+    config.bd = &heap;
+    config.cmd_us = TEST_CMD_US;
+    config.byte_ns = TEST_BYTE_NS;
+    msd_sim_attach(0u, config);
+    msd = new USBHostMSD();
+    HOST_CHECK(msd->connect());
+    HOST_CHECK_EQ(0, msd->init());
+
+    (void)printf("USBHOST_MSD_READ_AHEAD_BLOCKS %u, bus %u ns per byte, %u us per CBW and CSW:\n",
+                 (unsigned)USBHOST_MSD_READ_AHEAD_BLOCKS, TEST_BYTE_NS, TEST_CMD_US);
+    test_async();
+    test_stream();
+    test_random();
+    test_program();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,280 @@
+/* Host test of the folder scan of several USB memories (sys_scan_folder).
+ *
+ * sys_scan_folder.cpp is compiled unchanged, with the opendir(), readdir()
+ * and fopen() of sim/retarget_sim.cpp: "/usb0" ... "/usb2" are three
+ * FatFs RAM images of ram_fs.h. Each drive holds TEST_DRIVE_TRACK_NUM
+ * tracks in its root, two folders and a sub folder, and a file which is
+ * not a track. The track names carry the seed of their data. The cases:
+ *  - drives 0 and 1 scanned together, drive 2 added in the middle of the
+ *    scan;
+ *  - drive 1 removed with track IDs held, then attached again;
+ *  - drive 0 removed in the middle of the scan;
+ *  - stat(), rename() and remove() on drive 1 act on drive 1 only, while
+ *    drive 0 has a file of the same name.
+ * After each case, every track opens its own file of its own drive and
+ * fid_find_track() maps its path back to its ID, the tracks of a folder
+ * are contiguous, and no directory or file is left
+ * open. The track IDs found by the scan do not change while it goes on,
+ * and the IDs held across a removal follow their tracks.
+ */
+#include <vector>
+#include <string>
+#include "host_test.h"
+#include "ram_fs.h"
+#include "retarget_sim.h"
+#include "sys_scan_folder.h"
+
+#define TEST_DISK_SIZE          (32u * 1024u * 1024u)
+#define TEST_CLUSTER            (4096)
+#define TEST_DRIVE_NUM          (3u)
+#define TEST_TRACK_SIZE         (4096u)
+#define TEST_DRIVE_TRACK_NUM    (15u)       /* 2 + 5 + 5 + 3 */
+#define TEST_STEP_NUM           (3u)        /* Folders scanned before a drive is added or removed */
+#define FOLD_ID_NOT_EXIST       (0xFFFFFFFFu)
+
+static RamFs                ram0("usb0", TEST_DISK_SIZE);
+static RamFs                ram1("usb1", TEST_DISK_SIZE);
+static RamFs                ram2("usb2", TEST_DISK_SIZE);
+static RamFs                * const ram[TEST_DRIVE_NUM] = { &ram0, &ram1, &ram2 };
+static fid_scan_folder_t    info;
+
+/* Writes the tracks of a folder. Their seeds are unique over the drives. */
+static void write_tracks(RamFs * const p_ram, const char * const dir, const uint32_t drive,
+                         const uint32_t first, const uint32_t num)
+{
+    char    path[128];
+
+    for (uint32_t i = 0u; i < num; i++) {
+        (void)snprintf(path, sizeof(path), "%s%s%02u - s%04u.flac", dir, (dir[0] != '\0') ? "/" : "",
+                       (unsigned)(i + 1u), (unsigned)((drive * 100u) + first + i));
+        HOST_CHECK(p_ram->write_file(path, TEST_TRACK_SIZE, (drive * 100u) + first + i));
+    }
+}
+
+static void make_image(const uint32_t drive)
+{
+    RamFs * const   p_ram = ram[drive];
+
+    HOST_CHECK(p_ram->format(TEST_CLUSTER));
+    write_tracks(p_ram, "", drive, 0u, 2u);
+    HOST_CHECK_EQ(0, p_ram->fs.mkdir("Album A", 0777));
+    write_tracks(p_ram, "Album A", drive, 10u, 5u);
+    HOST_CHECK_EQ(0, p_ram->fs.mkdir("Album A/Disc 2", 0777));
+    write_tracks(p_ram, "Album A/Disc 2", drive, 20u, 3u);
+    HOST_CHECK_EQ(0, p_ram->fs.mkdir("Album B", 0777));
+    write_tracks(p_ram, "Album B", drive, 30u, 5u);
+    HOST_CHECK(p_ram->write_file("notes.txt", TEST_TRACK_SIZE, 0u));
+}
+
+static void attach(const uint32_t drive)
+{
+    retarget_sim_mount(&ram[drive]->fs);
+    HOST_CHECK(fid_add_drive(&info, drive));
+}
+
+/* The stick is pulled: its paths fail from now on. */
+static void detach(const uint32_t drive, uint32_t * const p_trk_ids, const uint32_t trk_num)
+{
+    retarget_sim_unmount(&ram[drive]->fs);
+    fid_remove_drive(&info, drive, p_trk_ids, trk_num);
+    HOST_CHECK(fid_is_drive_added(&info, drive) != true);
+}
+
+static std::vector<std::string> track_paths(void)
+{
+    std::vector<std::string>    paths;
+
+    for (uint32_t i = 0u; i < fid_get_total_track(&info); i++) {
+        paths.push_back(fid_get_track_path(&info, i));
+    }
+    return paths;
+}
+
+/* Scans num folders (all if 0). The tracks found before keep their IDs. */
+static void scan(const uint32_t num)
+{
+    std::vector<std::string>    before;
+    std::vector<std::string>    after;
+    uint32_t                    cnt = 0u;
+
+    while (fid_is_scanning(&info) && ((num == 0u) || (cnt < num))) {
+        before = track_paths();
+        (void)fid_scan_next_folder(&info);
+        after = track_paths();
+        HOST_CHECK(after.size() >= before.size());
+        for (size_t i = 0u; (i < before.size()) && (i < after.size()); i++) {
+            HOST_CHECK(before[i] == after[i]);
+        }
+        cnt++;
+    }
+}
+
+/* Checks the whole list: every track of the drives in drive_mask. */
+static void check_list(const uint32_t drive_mask)
+{
+    const retarget_sim_stat_t   stat = retarget_sim_get_stat();
+    uint32_t                    expect = 0u;
+    uint32_t                    parent = FOLD_ID_NOT_EXIST;
+    std::vector<bool>           is_done(SYS_MAX_FOLDER_NUM, false);
+    std::vector<uint8_t>        buf(TEST_TRACK_SIZE + 1u);
+    uint32_t                    drive_num;
+    uint32_t                    found_id = 0u;
+    std::string                 path;
+    unsigned                    seed = 0u;
+    char                        prefix[16];
+    FILE                        *fp;
+
+    for (uint32_t drive = 0u; drive < TEST_DRIVE_NUM; drive++) {
+        if ((drive_mask & (1u << drive)) != 0u) {
+            expect += TEST_DRIVE_TRACK_NUM;
+        }
+    }
+    HOST_CHECK(fid_is_scanning(&info) != true);
+    HOST_CHECK_EQ(expect, fid_get_total_track(&info));
+    for (uint32_t i = 0u; i < fid_get_total_track(&info); i++) {
+        /* The tracks of a folder are contiguous. */
+        if (info.track_list[i].parent_number != parent) {
+            parent = info.track_list[i].parent_number;
+            HOST_CHECK(is_done[parent] != true);
+            is_done[parent] = true;
+        }
+        drive_num = 0u;
+        for (uint32_t drive = 0u; drive < TEST_DRIVE_NUM; drive++) {
+            if (fid_is_drive_track(&info, drive, i)) {
+                HOST_CHECK((drive_mask & (1u << drive)) != 0u);
+                (void)snprintf(prefix, sizeof(prefix), "/usb%u/", (unsigned)drive);
+                HOST_CHECK(strncmp(fid_get_track_path(&info, i), prefix, strlen(prefix)) == 0);
+                HOST_CHECK((sscanf(fid_get_track_name(&info, i), "%*u - s%u", &seed) == 1) &&
+                           ((seed / 100u) == drive));
+                drive_num++;
+            }
+        }
+        HOST_CHECK_EQ(1u, drive_num);
+        /* The path of the resume state finds the track again. */
+        path = fid_get_track_path(&info, i);
+        HOST_CHECK(fid_find_track(&info, path.c_str(), 0u, &found_id) && (found_id == i));
+        HOST_CHECK(fid_find_track(&info, path.c_str(), i + 1u, &found_id) != true);
+        fp = fid_open_track(&info, i);
+        HOST_CHECK(fp != NULL);
+        if (fp != NULL) {
+            HOST_CHECK_EQ(TEST_TRACK_SIZE, fread(&buf[0], 1u, buf.size(), fp));
+            HOST_CHECK_EQ(0u, RamFs::verify(&buf[0], seed, 0u, TEST_TRACK_SIZE));
+            fid_close_track(fp);
+        }
+    }
+    HOST_CHECK_EQ(0u, stat.dir_open_cnt);
+    HOST_CHECK_EQ(0u, retarget_sim_get_stat().file_open_cnt);
+    HOST_CHECK_EQ(0u, stat.open_err_cnt);
+}
+
+static void test_add_during_scan(void)
+{
+    fid_init(&info);
+    attach(0u);
+    attach(1u);
+    /* The roots of both drives first: tracks of both can be played. */
+    scan(2u);
+    HOST_CHECK(fid_is_drive_track(&info, 0u, 0u));
+    HOST_CHECK(fid_is_drive_track(&info, 1u, fid_get_total_track(&info) - 1u));
+    scan(TEST_STEP_NUM);
+    attach(2u);
+    scan(0u);
+    check_list(0x7u);
+    (void)printf("  drives 0 and 1, drive 2 added during the scan: %u tracks in %u folders\n",
+                 (unsigned)fid_get_total_track(&info), (unsigned)info.total_folder);
+}
+
+static void test_remove_reattach(void)
+{
+    const std::vector<std::string>  before = track_paths();
+    const uint32_t                  total = fid_get_total_track(&info);
+    uint32_t                        ids[3];
+    uint32_t                        next;
+
+    /* A track of drive 1, the one after its last track, and the last one. */
+    ids[0] = 0u;
+    while ((ids[0] < total) && (fid_is_drive_track(&info, 1u, ids[0]) != true)) {
+        ids[0]++;
+    }
+    next = ids[0];
+    while ((next < total) && fid_is_drive_track(&info, 1u, next)) {
+        next++;
+    }
+    ids[1] = next;
+    ids[2] = total - 1u;
+    HOST_CHECK((next < total) && (fid_is_drive_track(&info, 1u, ids[2]) != true));
+    detach(1u, ids, 3u);
+    check_list(0x5u);
+    /* A removed track becomes the first track after it of another drive. */
+    HOST_CHECK(before[next] == fid_get_track_path(&info, ids[0]));
+    HOST_CHECK(before[next] == fid_get_track_path(&info, ids[1]));
+    HOST_CHECK(before.back() == fid_get_track_path(&info, ids[2]));
+    (void)printf("  drive 1 removed: %u tracks, held IDs %u %u %u follow their tracks\n",
+                 (unsigned)fid_get_total_track(&info), (unsigned)ids[0], (unsigned)ids[1], (unsigned)ids[2]);
+
+    attach(1u);
+    scan(0u);
+    check_list(0x7u);
+    (void)printf("  drive 1 attached again: %u tracks\n", (unsigned)fid_get_total_track(&info));
+}
+
+static void test_remove_during_scan(void)
+{
+    for (uint32_t drive = 0u; drive < TEST_DRIVE_NUM; drive++) {
+        retarget_sim_unmount(&ram[drive]->fs);
+    }
+    fid_init(&info);
+    for (uint32_t drive = 0u; drive < TEST_DRIVE_NUM; drive++) {
+        attach(drive);
+    }
+    scan(TEST_DRIVE_NUM + TEST_STEP_NUM);
+    HOST_CHECK(fid_is_scanning(&info));
+    detach(0u, NULL, 0u);
+    scan(0u);
+    check_list(0x6u);
+    (void)printf("  drive 0 removed during the scan: %u tracks in %u folders\n",
+                 (unsigned)fid_get_total_track(&info), (unsigned)info.total_folder);
+}
+
+/* The FatFs drive number of the volume must prefix every path: without */
+/* it FatFs takes the default drive 0. */
+static void test_file_ops_drive1(void)
+{
+    struct stat st;
+
+    HOST_CHECK(ram0.write_file("same.txt", TEST_TRACK_SIZE, 1u));
+    HOST_CHECK(ram1.write_file("same.txt", TEST_TRACK_SIZE * 2u, 2u));
+    HOST_CHECK_EQ(0, ram1.fs.stat("same.txt", &st));
+    HOST_CHECK_EQ((off_t)(TEST_TRACK_SIZE * 2u), st.st_size);
+    HOST_CHECK_EQ(0, ram1.fs.stat("Album A", &st));
+    HOST_CHECK(S_ISDIR(st.st_mode));
+
+    HOST_CHECK_EQ(0, ram1.fs.rename("same.txt", "Album B/moved.txt"));
+    HOST_CHECK(ram1.fs.stat("same.txt", &st) != 0);
+    HOST_CHECK_EQ(0, ram1.fs.stat("Album B/moved.txt", &st));
+    HOST_CHECK_EQ((off_t)(TEST_TRACK_SIZE * 2u), st.st_size);
+    HOST_CHECK(ram0.fs.stat("Album B/moved.txt", &st) != 0);
+
+    HOST_CHECK_EQ(0, ram1.fs.remove("Album B/moved.txt"));
+    HOST_CHECK(ram1.fs.stat("Album B/moved.txt", &st) != 0);
+    HOST_CHECK(ram1.fs.remove("same.txt") != 0);
+
+    /* Drive 0 still has its own file. */
+    HOST_CHECK_EQ(0, ram0.fs.stat("same.txt", &st));
+    HOST_CHECK_EQ((off_t)TEST_TRACK_SIZE, st.st_size);
+    HOST_CHECK_EQ(0, ram0.fs.remove("same.txt"));
+    (void)printf("  stat, rename and remove on drive 1 leave drive 0 alone\n");
+}
+
+int main(void)
+{
+    for (uint32_t drive = 0u; drive < TEST_DRIVE_NUM; drive++) {
+        make_image(drive);
+    }
+    (void)printf("%u drives of %u tracks:\n", TEST_DRIVE_NUM, TEST_DRIVE_TRACK_NUM);
+    test_add_during_scan();
+    test_remove_reattach();
+    test_remove_during_scan();
+    test_file_ops_drive1();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,367 @@
+/* Host test of the journal of the resume state (sys_resume).
+ *
+ * sys_resume.cpp runs unchanged on FlashModel, a RAM model of a NOR flash
+ * of TEST_FLASH_BLOCK_NUM erase blocks: an erase sets its block to 0xFF,
+ * a program may only clear bits of erased bytes, and the power can be cut
+ * after any number of bytes of the next erase or program. The cases:
+ *  - a flash of garbage has no record, and the first state is written;
+ *  - batching: TEST_PLAY_MIN minutes of playback with a position update
+ *    every TEST_UPDATE_MS write once per SYS_RESUME_WRITE_INTERVAL_MS,
+ *    also across the wrap of the us counter. The same state is not
+ *    written, the pause and the track change are written at once;
+ *  - wear: the records go round all slots, one program each, and every
+ *    erase block is erased as often as the others;
+ *  - recovery: the journal opened again after each write returns that
+ *    write, and a power cut during any erase or program returns the
+ *    record before it. No byte is ever programmed without an erase;
+ *  - the journal file of the firmware: a FileBlockDevice of 16 sectors
+ *    on a FatFs RAM disk of ram_fs.h. Each write is one sector program
+ *    and no FAT or directory write, and the disk image taken without
+ *    closing the file (the USB memory pulled) has the latest record.
+ */
+#include <stdlib.h>
+#include <vector>
+#include "host_test.h"
+#include "ram_fs.h"
+#include "FileBlockDevice.h"
+#include "sys_resume.h"
+
+#define TEST_FLASH_BLOCK        (4096u)
+#define TEST_FLASH_PAGE         (256u)
+#define TEST_FLASH_BLOCK_NUM    (4u)
+#define TEST_PLAY_MIN           (10u)
+#define TEST_UPDATE_MS          (100u)
+#define TEST_SAMPLE_RATE        (44100u)
+#define TEST_WEAR_ROUND         (10u)
+#define TEST_DISK_SIZE          (32u * 1024u * 1024u)
+#define TEST_CLUSTER            (4096)
+#define TEST_JOURNAL_PATH       "resume.jnl"
+#define TEST_JOURNAL_SECTOR     (512u)
+#define TEST_JOURNAL_SLOT_NUM   (16u)
+#define TEST_MS_TO_US           (1000u)
+#define TEST_CUT_NON            (-1)
+
+/* RAM model of a NOR flash. */
+class FlashModel : public BlockDevice {
+public:
+    FlashModel() : mem(TEST_FLASH_BLOCK * TEST_FLASH_BLOCK_NUM), erase_cnt(TEST_FLASH_BLOCK_NUM, 0u),
+                   program_cnt(0u), dirty_cnt(0u), cut(TEST_CUT_NON), is_dead(false) {
+        srand(TEST_FLASH_BLOCK);
+        for (size_t i = 0u; i < mem.size(); i++) {
+            mem[i] = (uint8_t)rand();
+        }
+    }
+
+    virtual int init() { return is_dead ? BD_ERROR_DEVICE_ERROR : 0; }
+    virtual int deinit() { return 0; }
+
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size) {
+        MBED_ASSERT(is_valid_read(addr, size));
+        if (is_dead) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        (void)memcpy(buffer, &mem[addr], size);
+        return 0;
+    }
+
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size) {
+        const uint8_t * const   p_data = static_cast<const uint8_t *>(buffer);
+        const bd_size_t         len = cut_size(size);
+
+        MBED_ASSERT(is_valid_program(addr, size));
+        if (is_dead) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        for (bd_size_t i = 0u; i < len; i++) {
+            if (mem[addr + i] != 0xFFu) {
+                dirty_cnt++;
+            }
+            mem[addr + i] &= p_data[i];
+        }
+        program_cnt++;
+        return is_dead ? BD_ERROR_DEVICE_ERROR : 0;
+    }
+
+    virtual int erase(bd_addr_t addr, bd_size_t size) {
+        const bd_size_t len = cut_size(size);
+
+        MBED_ASSERT(is_valid_erase(addr, size));
+        if (is_dead) {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+        (void)memset(&mem[addr], 0xFF, len);
+        for (bd_addr_t block = addr; block < (addr + size); block += TEST_FLASH_BLOCK) {
+            erase_cnt[block / TEST_FLASH_BLOCK]++;
+        }
+        return is_dead ? BD_ERROR_DEVICE_ERROR : 0;
+    }
+
+    virtual bd_size_t get_read_size() const { return 1u; }
+    virtual bd_size_t get_program_size() const { return TEST_FLASH_PAGE; }
+    virtual bd_size_t get_erase_size() const { return TEST_FLASH_BLOCK; }
+    virtual bd_size_t size() const { return mem.size(); }
+
+    /* The power is cut after bytes of the next erase or program. */
+    void cut_power(const int bytes) {
+        cut = bytes;
+    }
+
+    void power_on(void) {
+        cut = TEST_CUT_NON;
+        is_dead = false;
+    }
+
+    std::vector<uint8_t>    mem;
+    std::vector<uint32_t>   erase_cnt;
+    uint32_t                program_cnt;
+    uint32_t                dirty_cnt;      /* Bytes programmed without an erase */
+
+private:
+    int                     cut;
+    bool                    is_dead;
+
+    bd_size_t cut_size(const bd_size_t size) {
+        if ((cut == TEST_CUT_NON) || ((bd_size_t)cut >= size)) {
+            return size;
+        }
+        is_dead = true;
+        return (bd_size_t)cut;
+    }
+};
+
+static void make_state(sys_resume_state_t * const p_state, const uint32_t track, const uint32_t sample)
+{
+    (void)memset(p_state, 0, sizeof(*p_state));
+    (void)snprintf(p_state->path, sizeof(p_state->path), "Music/Folder %02u/%02u - Track.flac",
+                   (unsigned)(track / 10u), (unsigned)(track % 10u));
+    p_state->sample = sample;
+    p_state->volume = -(int32_t)(track % 40u);
+    p_state->repeat_mode = (uint8_t)(track & 1u);
+    p_state->xfade_mode = 1u;
+}
+
+static bool is_same(const sys_resume_state_t * const p_a, const sys_resume_state_t * const p_b)
+{
+    return (strcmp(p_a->path, p_b->path) == 0) && (p_a->sample == p_b->sample) &&
+           (p_a->volume == p_b->volume) && (p_a->mute == p_b->mute) &&
+           (p_a->repeat_mode == p_b->repeat_mode) && (p_a->xfade_mode == p_b->xfade_mode) &&
+           (p_a->meter_mode == p_b->meter_mode);
+}
+
+/* Opens the journal again, as after a reset, and checks its latest record. */
+static void check_reopen(BlockDevice * const p_bd, const sys_resume_state_t * const p_expect)
+{
+    sys_resume_t        journal;
+    sys_resume_state_t  state;
+
+    HOST_CHECK(sys_resume_open(&journal, p_bd));
+    HOST_CHECK(sys_resume_read(&journal, &state));
+    HOST_CHECK(is_same(p_expect, &state));
+    sys_resume_close(&journal);
+}
+
+static void test_empty(void)
+{
+    FlashModel          flash;
+    sys_resume_t        journal;
+    sys_resume_state_t  state;
+
+    HOST_CHECK(sys_resume_open(&journal, &flash));
+    HOST_CHECK(sys_resume_read(&journal, &state) != true);
+    /* The first state is written without waiting for the interval. */
+    make_state(&state, 0u, 0u);
+    HOST_CHECK(sys_resume_write(&journal, &state, false, 0u));
+    sys_resume_close(&journal);
+    check_reopen(&flash, &state);
+    HOST_CHECK_EQ(0u, flash.dirty_cnt);
+}
+
+/* Plays one track from now_us, and returns the writes of the journal. */
+static uint32_t play(sys_resume_t * const p_journal, FlashModel * const p_flash,
+                     sys_resume_state_t * const p_state, uint32_t * const p_now_us)
+{
+    const uint32_t  top = p_flash->program_cnt;
+    uint32_t        last_us = *p_now_us;
+    uint32_t        cnt;
+
+    for (uint32_t ms = 0u; ms < (TEST_PLAY_MIN * 60u * 1000u); ms += TEST_UPDATE_MS) {
+        cnt = p_flash->program_cnt;
+        p_state->sample += (TEST_SAMPLE_RATE * TEST_UPDATE_MS) / 1000u;
+        *p_now_us += TEST_UPDATE_MS * TEST_MS_TO_US;
+        (void)sys_resume_write(p_journal, p_state, false, *p_now_us);
+        if (p_flash->program_cnt != cnt) {
+            /* A write of the position waits for the interval. */
+            HOST_CHECK((*p_now_us - last_us) >= (SYS_RESUME_WRITE_INTERVAL_MS * TEST_MS_TO_US));
+            last_us = *p_now_us;
+        }
+    }
+    return p_flash->program_cnt - top;
+}
+
+static void test_batching(void)
+{
+    const uint32_t      expect = (TEST_PLAY_MIN * 60u * 1000u) / SYS_RESUME_WRITE_INTERVAL_MS;
+    FlashModel          flash;
+    sys_resume_t        journal;
+    sys_resume_state_t  state;
+    uint32_t            now_us = 0u;
+    uint32_t            cnt;
+
+    HOST_CHECK(sys_resume_open(&journal, &flash));
+    make_state(&state, 1u, 0u);
+    HOST_CHECK(sys_resume_write(&journal, &state, true, now_us));
+    cnt = play(&journal, &flash, &state, &now_us);
+    (void)printf("  %u minutes, position every %u ms: %u writes\n",
+                 TEST_PLAY_MIN, TEST_UPDATE_MS, (unsigned)cnt);
+    HOST_CHECK_EQ(expect, cnt);
+
+    /* Pause: written at once, then nothing while the state does not change. */
+    state.sample += 100u;
+    HOST_CHECK(sys_resume_write(&journal, &state, true, now_us + 1u));
+    HOST_CHECK(sys_resume_write(&journal, &state, true, now_us + 2u) != true);
+    HOST_CHECK(sys_resume_write(&journal, &state, false, now_us + (SYS_RESUME_WRITE_INTERVAL_MS * 2u * TEST_MS_TO_US)) != true);
+    /* A setting waits for the interval, the track change does not. */
+    state.volume--;
+    HOST_CHECK(sys_resume_write(&journal, &state, false, now_us + 3u) != true);
+    make_state(&state, 2u, 0u);
+    HOST_CHECK(sys_resume_write(&journal, &state, false, now_us + 4u));
+    check_reopen(&flash, &state);
+
+    /* The us counter wraps in the middle of the track. */
+    now_us = 0u - ((TEST_PLAY_MIN * 60u * 1000u * TEST_MS_TO_US) / 2u);
+    HOST_CHECK(sys_resume_write(&journal, &state, true, now_us) != true);
+    make_state(&state, 3u, 0u);
+    HOST_CHECK(sys_resume_write(&journal, &state, false, now_us));
+    cnt = play(&journal, &flash, &state, &now_us);
+    (void)printf("  the same across the wrap of the us counter: %u writes\n", (unsigned)cnt);
+    HOST_CHECK_EQ(expect, cnt);
+    sys_resume_close(&journal);
+    check_reopen(&flash, &state);
+    HOST_CHECK_EQ(0u, flash.dirty_cnt);
+}
+
+static void test_wear(void)
+{
+    FlashModel          flash;
+    sys_resume_t        journal;
+    sys_resume_state_t  state;
+    uint32_t            slot_num;
+    uint32_t            min_cnt = 0xFFFFFFFFu;
+    uint32_t            max_cnt = 0u;
+
+    HOST_CHECK(sys_resume_open(&journal, &flash));
+    slot_num = journal.slot_num;
+    HOST_CHECK_EQ((TEST_FLASH_BLOCK / TEST_FLASH_PAGE) * TEST_FLASH_BLOCK_NUM, slot_num);
+    for (uint32_t i = 0u; i < (slot_num * TEST_WEAR_ROUND); i++) {
+        make_state(&state, i, i * 7u);
+        HOST_CHECK(sys_resume_write(&journal, &state, true, i));
+    }
+    sys_resume_close(&journal);
+    for (uint32_t block = 0u; block < TEST_FLASH_BLOCK_NUM; block++) {
+        min_cnt = (flash.erase_cnt[block] < min_cnt) ? flash.erase_cnt[block] : min_cnt;
+        max_cnt = (flash.erase_cnt[block] > max_cnt) ? flash.erase_cnt[block] : max_cnt;
+    }
+    (void)printf("  %u writes on %u slots of %u erase blocks: %u programs, %u to %u erases per block\n",
+                 (unsigned)(slot_num * TEST_WEAR_ROUND), (unsigned)slot_num, TEST_FLASH_BLOCK_NUM,
+                 (unsigned)flash.program_cnt, (unsigned)min_cnt, (unsigned)max_cnt);
+    HOST_CHECK_EQ(slot_num * TEST_WEAR_ROUND, flash.program_cnt);
+    HOST_CHECK_EQ(TEST_WEAR_ROUND, min_cnt);
+    HOST_CHECK_EQ(TEST_WEAR_ROUND, max_cnt);
+    HOST_CHECK_EQ(0u, flash.dirty_cnt);
+    check_reopen(&flash, &state);
+}
+
+static void test_recovery(void)
+{
+    static const int    cut_tbl[] = { 0, 1, 8, 100, (int)TEST_FLASH_PAGE - 1 };
+    FlashModel          flash;
+    sys_resume_t        journal;
+    sys_resume_state_t  state;
+    sys_resume_state_t  last;
+    uint32_t            slot_num;
+    uint32_t            cut_num = 0u;
+
+    HOST_CHECK(sys_resume_open(&journal, &flash));
+    slot_num = journal.slot_num;
+    make_state(&last, 0u, 0u);
+    HOST_CHECK(sys_resume_write(&journal, &last, true, 0u));
+    sys_resume_close(&journal);
+
+    /* Each write is either the new record or the one before it, whether the */
+    /* power is cut during the erase of a block or a program of a slot. */
+    for (uint32_t i = 1u; i < (slot_num * 3u); i++) {
+        HOST_CHECK(sys_resume_open(&journal, &flash));
+        make_state(&state, i, i * 4410u);
+        if ((i % 3u) == 0u) {
+            flash.cut_power(cut_tbl[cut_num % (sizeof(cut_tbl) / sizeof(cut_tbl[0]))]);
+            cut_num++;
+            HOST_CHECK(sys_resume_write(&journal, &state, true, i) != true);
+            flash.power_on();
+        } else {
+            HOST_CHECK(sys_resume_write(&journal, &state, true, i));
+            last = state;
+        }
+        sys_resume_close(&journal);
+        check_reopen(&flash, &last);
+    }
+    (void)printf("  %u reopens, %u power cuts: the latest complete record each time\n",
+                 (unsigned)((slot_num * 3u) - 1u), (unsigned)cut_num);
+    HOST_CHECK_EQ(0u, flash.dirty_cnt);
+}
+
+static void test_file_journal(void)
+{
+    RamFs                   ram("usb", TEST_DISK_SIZE);
+    RamFs                   image("img", TEST_DISK_SIZE);
+    FileBlockDevice         bd(&ram.fs, TEST_JOURNAL_PATH, TEST_JOURNAL_SECTOR * TEST_JOURNAL_SLOT_NUM,
+                               TEST_JOURNAL_SECTOR);
+    std::vector<uint8_t>    buf(1024u * 1024u);
+    sys_resume_t            journal;
+    sys_resume_state_t      state;
+    struct stat             st;
+
+    HOST_CHECK(ram.format(TEST_CLUSTER));
+    HOST_CHECK(sys_resume_open(&journal, &bd));
+    HOST_CHECK_EQ(TEST_JOURNAL_SLOT_NUM, journal.slot_num);
+    ram.prof.reset_counters();
+    for (uint32_t i = 0u; i < (TEST_JOURNAL_SLOT_NUM * 2u); i++) {
+        make_state(&state, i, i * 4410u);
+        HOST_CHECK(sys_resume_write(&journal, &state, true, i));
+    }
+    (void)printf("  journal file: %u writes, %u sector programs\n",
+                 TEST_JOURNAL_SLOT_NUM * 2u, (unsigned)ram.cnt().program_count);
+    HOST_CHECK_EQ(TEST_JOURNAL_SLOT_NUM * 2u, ram.cnt().program_count);
+    HOST_CHECK_EQ(TEST_JOURNAL_SLOT_NUM * 2u * TEST_JOURNAL_SECTOR, ram.cnt().program_bytes);
+
+    /* The stick is pulled with the file open: the image has the record. */
+    HOST_CHECK_EQ(0, image.heap.init());
+    for (uint32_t ofs = 0u; ofs < TEST_DISK_SIZE; ofs += (uint32_t)buf.size()) {
+        HOST_CHECK_EQ(0, ram.heap.read(&buf[0], ofs, buf.size()));
+        HOST_CHECK_EQ(0, image.heap.program(&buf[0], ofs, buf.size()));
+    }
+    HOST_CHECK(image.remount());
+    {
+        FileBlockDevice     image_bd(&image.fs, TEST_JOURNAL_PATH, TEST_JOURNAL_SECTOR * TEST_JOURNAL_SLOT_NUM,
+                                     TEST_JOURNAL_SECTOR);
+
+        check_reopen(&image_bd, &state);
+    }
+    HOST_CHECK_EQ(0, image.fs.stat(TEST_JOURNAL_PATH, &st));
+    HOST_CHECK_EQ(TEST_JOURNAL_SECTOR * TEST_JOURNAL_SLOT_NUM, st.st_size);
+
+    sys_resume_close(&journal);
+    HOST_CHECK(ram.remount());
+    check_reopen(&bd, &state);
+}
+
+int main(void)
+{
+    (void)printf("Flash of %u erase blocks of %u bytes, %u bytes per program:\n",
+                 TEST_FLASH_BLOCK_NUM, TEST_FLASH_BLOCK, TEST_FLASH_PAGE);
+    test_empty();
+    test_batching();
+    test_wear();
+    test_recovery();
+    test_file_journal();
+    return HOST_TEST_RESULT();
+}
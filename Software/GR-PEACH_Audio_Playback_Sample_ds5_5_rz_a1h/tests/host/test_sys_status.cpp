@@ -0,0 +1,124 @@
+/* Host stress test of sys_status: the seqlock status block.
+ *
+ * One writer pthread writes TEST_UPDATE_NUM values, whose fields are all
+ * derived from one counter, while TEST_READER_NUM reader pthreads read
+ * the block in a loop like the main and display threads.
+ *  - No read returns a torn value: the fields of every value agree.
+ *  - The values seen by each reader only go forward.
+ *  - A read without an update since the last one returns false.
+ *  - Every reader sees the final value after the writer ends.
+ * The test prints the reads and the updates seen by each reader. On a
+ * single core the threads only interleave at the preemptions, so the
+ * test is stronger on a multi-core host.
+ */
+#include <pthread.h>
+#include <vector>
+#include "host_test.h"
+#include "sys_status.h"
+
+#define TEST_UPDATE_NUM     (20000000u)
+#define TEST_READER_NUM     (3u)
+
+typedef struct {
+    uint32_t    read_cnt;           /* Calls of sys_status_read() */
+    uint32_t    update_cnt;         /* Calls which returned true */
+    uint32_t    torn_cnt;
+    uint32_t    back_cnt;           /* Values older than the previous one */
+    uint32_t    last;               /* Counter of the last value */
+} reader_stat_t;
+
+static sys_status_block_t   status_block;
+static volatile bool        is_written;
+
+static void make_status(const uint32_t cnt, sys_status_t * const p_status)
+{
+    p_status->play_stat = ((cnt & 1u) == 0u) ? SYS_PLAYSTAT_PLAY : SYS_PLAYSTAT_PAUSE;
+    p_status->track_id = cnt;
+    p_status->play_time = cnt / 3u;
+    p_status->total_time = ~cnt;
+    p_status->play_sample = cnt * 2654435761u;
+}
+
+static bool is_consistent(const sys_status_t &status)
+{
+    sys_status_t    expect;
+
+    make_status(status.track_id, &expect);
+    return (status.play_stat == expect.play_stat) && (status.play_time == expect.play_time) &&
+           (status.total_time == expect.total_time) && (status.play_sample == expect.play_sample);
+}
+
+static void *writer_thread(void *p_arg)
+{
+    sys_status_t    status;
+
+    (void)p_arg;
+    for (uint32_t cnt = 1u; cnt <= TEST_UPDATE_NUM; cnt++) {
+        make_status(cnt, &status);
+        sys_status_write(&status_block, &status);
+    }
+    __atomic_store_n(&is_written, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *reader_thread(void *p_arg)
+{
+    reader_stat_t * const p_stat = (reader_stat_t *)p_arg;
+    uint32_t        seq = 0u;
+    sys_status_t    status;
+    bool            is_end = false;
+
+    while (is_end != true) {
+        /* The block is read once more after the writer ends. */
+        is_end = __atomic_load_n(&is_written, __ATOMIC_ACQUIRE);
+        p_stat->read_cnt++;
+        if (sys_status_read(&status_block, &status, &seq) == true) {
+            p_stat->update_cnt++;
+            if (is_consistent(status) != true) {
+                p_stat->torn_cnt++;
+            }
+            if (status.track_id < p_stat->last) {
+                p_stat->back_cnt++;
+            }
+            p_stat->last = status.track_id;
+        }
+    }
+    /* Nothing is updated any more. */
+    if (sys_status_read(&status_block, &status, &seq) == true) {
+        p_stat->back_cnt++;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t       writer;
+    pthread_t       reader[TEST_READER_NUM];
+    reader_stat_t   stat[TEST_READER_NUM] = {};
+    uint64_t        ns;
+
+    sys_status_init(&status_block);
+    ns = host_time_ns();
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        HOST_CHECK_EQ(0, pthread_create(&reader[i], NULL, &reader_thread, &stat[i]));
+    }
+    HOST_CHECK_EQ(0, pthread_create(&writer, NULL, &writer_thread, NULL));
+    (void)pthread_join(writer, NULL);
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        (void)pthread_join(reader[i], NULL);
+    }
+    ns = host_time_ns() - ns;
+
+    for (uint32_t i = 0u; i < TEST_READER_NUM; i++) {
+        (void)printf("reader %u: %u reads, %u updates seen, %u torn, %u backward, last %u\n",
+                     (unsigned)i, (unsigned)stat[i].read_cnt, (unsigned)stat[i].update_cnt,
+                     (unsigned)stat[i].torn_cnt, (unsigned)stat[i].back_cnt, (unsigned)stat[i].last);
+        HOST_CHECK_EQ(0u, stat[i].torn_cnt);
+        HOST_CHECK_EQ(0u, stat[i].back_cnt);
+        HOST_CHECK_EQ(TEST_UPDATE_NUM, stat[i].last);
+        HOST_CHECK(stat[i].update_cnt > 0u);
+    }
+    (void)printf("%u updates in %.2f s, %.1f ns per update\n", TEST_UPDATE_NUM,
+                 (double)ns * 1.0e-9, (double)ns / TEST_UPDATE_NUM);
+    return HOST_TEST_RESULT();
+}
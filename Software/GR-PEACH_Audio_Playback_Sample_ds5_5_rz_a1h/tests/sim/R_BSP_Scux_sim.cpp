@@ -0,0 +1,593 @@
+/* Simulated SCUX driver for the GR-PEACH host tests. See scux_sim.h.
+ *
+ * Only one R_BSP_Scux object is supported, and R_BSP_Aio::write()/read()
+ * are the ones of that object. The requests which the RenesasBSP driver
+ * accepts only while SCUX is stopped (SetSrcCfg, SetSsifCfg, SetRoute,
+ * SetDvuCfg) fail while it is started, like on the target.
+ */
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <deque>
+#include "r_errno.h"
+#include "scux_sim.h"
+
+typedef struct {
+    int32_t             *p_data;
+    uint32_t            data_size;
+    rbsp_data_conf_t    conf;
+} sim_req_t;
+
+typedef struct {
+    sim_req_t           req;
+    int32_t             result;
+} sim_done_t;
+
+static pthread_mutex_t      sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static scux_sim_stat_t      sim_stat;
+static std::deque<sim_req_t> sim_queue;
+static std::vector<int32_t> sim_ssif_out;
+static void                 (*sim_flush_cb)(int32_t) = NULL;
+static uint32_t             sim_cancel_part_byte;
+static std::deque<sim_done_t> sim_cancel_queue;    /* Results which the interrupt thread delivers */
+static pthread_cond_t       sim_cancel_cond = PTHREAD_COND_INITIALIZER;
+static bool                 is_irq_started;
+static uint32_t             dvu_step_cnt;       /* Frames since the last step of the ramp */
+static uint32_t             dvu_wait_cnt;       /* Frames until the ramp starts */
+static bool                 dvu_zc_muted[SCUX_USE_CH_2];
+static int32_t              dvu_last[SCUX_USE_CH_2];
+
+#define PCM_PADDING_BITS    (8)
+#define PCM_MAX_VAL         (0x007FFFFF)
+#define PCM_MIN_VAL         (-0x00800000)
+#define DVU_FINE_PERIOD_TOP (SCUX_DVU_TIME_0_125DB_1STEP)
+
+static void complete(const sim_req_t &req, const int32_t result)
+{
+    if (req.conf.p_notify_func != NULL) {
+        req.conf.p_notify_func(req.p_data, result, req.conf.p_app_data);
+    }
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000uLL) + (uint64_t)ts.tv_nsec;
+}
+
+static bool is_ssif_route(const scux_route_t route)
+{
+    return (route > SCUX_ROUTE_SRC_SSIF_MIN) && (route < SCUX_ROUTE_SRC_MIX_SSIF_MAX);
+}
+
+/* Moves the ramp volume one frame toward its target. */
+static void dvu_step(void)
+{
+    scux_dvu_usr_cfg_t  * const p_cfg = &sim_stat.dvu_cfg;
+    const bool          is_up = (p_cfg->ramp_vol < sim_stat.ramp_vol_cur);
+    const int32_t       period = (int32_t)(is_up ? p_cfg->up_period : p_cfg->down_period);
+    uint32_t            step = 1u;
+    uint32_t            frame_num = 1u;
+
+    if (dvu_wait_cnt > 0u) {
+        dvu_wait_cnt--;
+    } else if (p_cfg->ramp_vol != sim_stat.ramp_vol_cur) {
+        if (period <= DVU_FINE_PERIOD_TOP) {
+            /* 128 dB (1024 units) per frame, halved by each period number. */
+            step = 1024u >> period;
+        } else {
+            frame_num = 1u << (period - DVU_FINE_PERIOD_TOP);
+        }
+        dvu_step_cnt++;
+        if (dvu_step_cnt >= frame_num) {
+            dvu_step_cnt = 0u;
+            if (is_up) {
+                sim_stat.ramp_vol_cur -= ((sim_stat.ramp_vol_cur - p_cfg->ramp_vol) < step) ?
+                                         (sim_stat.ramp_vol_cur - p_cfg->ramp_vol) : step;
+            } else {
+                sim_stat.ramp_vol_cur += ((p_cfg->ramp_vol - sim_stat.ramp_vol_cur) < step) ?
+                                         (p_cfg->ramp_vol - sim_stat.ramp_vol_cur) : step;
+            }
+        }
+    } else {
+        dvu_step_cnt = 0u;
+    }
+}
+
+/* Applies DVU to one frame of the SSIF route. */
+static void dvu_process(int32_t * const p_frame)
+{
+    const scux_dvu_usr_cfg_t    * const p_cfg = &sim_stat.dvu_cfg;
+    double                      gain;
+    double                      val;
+    int32_t                     data;
+
+    for (uint32_t ch = 0u; ch < SCUX_USE_CH_2; ch++) {
+        gain = 1.0;
+        if (p_cfg->digi_vol_enable == true) {
+            gain = (double)p_cfg->digi_vol[ch] / (double)DVU_DIGI_VOL_0DB;
+        }
+        if (p_cfg->ramp_vol_enable == true) {
+            if (sim_stat.ramp_vol_cur >= DVU_RAMP_VOL_MUTE) {
+                gain = 0.0;
+            } else {
+                gain *= pow(10.0, -((double)sim_stat.ramp_vol_cur / DVU_RAMP_VOL_PER_DB) / 20.0);
+            }
+        }
+        data = p_frame[ch] >> PCM_PADDING_BITS;
+        if (p_cfg->zc_mute_enable == true) {
+            if ((data == 0) || ((data < 0) != (dvu_last[ch] < 0))) {
+                dvu_zc_muted[ch] = true;
+            }
+        } else {
+            dvu_zc_muted[ch] = false;
+        }
+        dvu_last[ch] = data;
+        if (dvu_zc_muted[ch] == true) {
+            data = 0;
+        } else if (gain != 1.0) {
+            val = nearbyint((double)data * gain);
+            data = (val > PCM_MAX_VAL) ? PCM_MAX_VAL : ((val < PCM_MIN_VAL) ? PCM_MIN_VAL : (int32_t)val);
+        } else {
+            /* Unity gain : bit-exact */
+        }
+        p_frame[ch] = (int32_t)((uint32_t)data << PCM_PADDING_BITS);
+    }
+    dvu_step();
+}
+
+/* Appends byte of the request to the SSIF output, through DVU. */
+static void output_ssif(const sim_req_t &req, const uint32_t byte)
+{
+    const size_t    top = sim_ssif_out.size();
+
+    if (is_ssif_route(sim_stat.route) == true) {
+        sim_ssif_out.insert(sim_ssif_out.end(), req.p_data, req.p_data + (byte / sizeof(int32_t)));
+        if ((sim_stat.is_dvu_set == true) && (sim_stat.dvu_cfg.dvu_enable == true)) {
+            for (size_t i = top; (i + SCUX_USE_CH_2) <= sim_ssif_out.size(); i += SCUX_USE_CH_2) {
+                dvu_process(&sim_ssif_out[i]);
+            }
+        }
+    }
+}
+
+/* Delivers the results of the writes cancelled by ClearStop(), like the */
+/* interrupt of the DMA does on the target after ClearStop() returned. */
+static void *irq_thread(void *arg)
+{
+    std::deque<sim_done_t>  done;
+
+    (void)arg;
+    while (true) {
+        (void)pthread_mutex_lock(&sim_mutex);
+        while (sim_cancel_queue.empty() == true) {
+            (void)pthread_cond_wait(&sim_cancel_cond, &sim_mutex);
+        }
+        done.swap(sim_cancel_queue);
+        (void)pthread_mutex_unlock(&sim_mutex);
+        for (size_t i = 0u; i < done.size(); i++) {
+            complete(done[i].req, done[i].result);
+        }
+        (void)pthread_mutex_lock(&sim_mutex);
+        sim_stat.cancel_fin_cnt += (uint32_t)done.size();
+        (void)pthread_mutex_unlock(&sim_mutex);
+        done.clear();
+    }
+    return NULL;
+}
+
+/* Accepts a configuration request only while SCUX is stopped. */
+static bool accept_cfg(void)
+{
+    bool    ret = !sim_stat.is_started;
+
+    if (ret != true) {
+        sim_stat.cfg_reject_cnt++;
+    }
+    return ret;
+}
+
+void scux_sim_reset(void)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    (void)memset(&sim_stat, 0, sizeof(sim_stat));
+    sim_queue.clear();
+    sim_ssif_out.clear();
+    sim_flush_cb = NULL;
+    sim_cancel_part_byte = 0u;
+    sim_cancel_queue.clear();
+    dvu_step_cnt = 0u;
+    dvu_wait_cnt = 0u;
+    (void)memset(dvu_zc_muted, 0, sizeof(dvu_zc_muted));
+    (void)memset(dvu_last, 0, sizeof(dvu_last));
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+scux_sim_stat_t scux_sim_get_stat(void)
+{
+    scux_sim_stat_t stat;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    stat = sim_stat;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return stat;
+}
+
+uint32_t scux_sim_queued_num(void)
+{
+    uint32_t    num;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    num = (uint32_t)sim_queue.size();
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return num;
+}
+
+uint32_t scux_sim_queued_byte(void)
+{
+    uint32_t    byte = 0u;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    for (size_t i = 0u; i < sim_queue.size(); i++) {
+        byte += sim_queue[i].data_size;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return byte;
+}
+
+uint32_t scux_sim_head_byte(void)
+{
+    uint32_t    byte = 0u;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if (sim_queue.empty() != true) {
+        byte = sim_queue.front().data_size;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return byte;
+}
+
+void scux_sim_set_cancel_part(const uint32_t byte)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_cancel_part_byte = byte - (byte % (SCUX_USE_CH_2 * sizeof(int32_t)));
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+uint32_t scux_sim_pump(const uint32_t max_num)
+{
+    std::vector<sim_req_t>  done;
+    void                    (*flush_cb)(int32_t) = NULL;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    while ((done.size() < max_num) && (sim_queue.empty() != true)) {
+        const sim_req_t &req = sim_queue.front();
+
+        output_ssif(req, req.data_size);
+        done.push_back(req);
+        sim_queue.pop_front();
+    }
+    if ((sim_flush_cb != NULL) && (sim_queue.empty() == true)) {
+        flush_cb = sim_flush_cb;
+        sim_flush_cb = NULL;
+        sim_stat.is_started = false;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    /* The callbacks are called outside the lock, like from the DMA interrupt. */
+    for (size_t i = 0u; i < done.size(); i++) {
+        complete(done[i], (int32_t)done[i].data_size);
+    }
+    if (flush_cb != NULL) {
+        flush_cb(ESUCCESS);
+    }
+    return (uint32_t)done.size();
+}
+
+std::vector<int32_t> scux_sim_ssif_out(void)
+{
+    std::vector<int32_t>    out;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    out = sim_ssif_out;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return out;
+}
+
+/*--- R_BSP_Aio / R_BSP_SerialFamily ---*/
+
+R_BSP_Aio::R_BSP_Aio()
+{
+    (void)memset(&write_ctl, 0, sizeof(write_ctl));
+    (void)memset(&read_ctl, 0, sizeof(read_ctl));
+}
+
+R_BSP_Aio::~R_BSP_Aio()
+{
+}
+
+R_BSP_SerialFamily::~R_BSP_SerialFamily()
+{
+}
+
+int32_t R_BSP_Aio::write(void * const p_data, uint32_t data_size, const rbsp_data_conf_t * const p_data_conf)
+{
+    int32_t     ret = EERROR;
+    sim_req_t   req;
+
+    if ((p_data != NULL) && (data_size > 0u) && (p_data_conf != NULL)) {
+        req.p_data = (int32_t *)p_data;
+        req.data_size = data_size;
+        req.conf = *p_data_conf;
+        (void)pthread_mutex_lock(&sim_mutex);
+        if ((sim_stat.is_started == true) && (sim_flush_cb == NULL)) {
+            sim_queue.push_back(req);
+            sim_stat.write_cnt++;
+            sim_stat.write_byte += data_size;
+            sim_stat.last_write_ns = time_ns();
+            if (sim_stat.start_write_cnt == 0u) {
+                sim_stat.first_write_ns = sim_stat.last_write_ns;
+            }
+            sim_stat.start_write_cnt++;
+            ret = ESUCCESS;
+        }
+        (void)pthread_mutex_unlock(&sim_mutex);
+    }
+    return ret;
+}
+
+int32_t R_BSP_Aio::read(void * const p_data, uint32_t data_size, const rbsp_data_conf_t * const p_data_conf)
+{
+    (void)p_data;
+    (void)data_size;
+    (void)p_data_conf;
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.read_cnt++;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    /* The memory route is not simulated. */
+    return EERROR;
+}
+
+/*--- R_BSP_Scux ---*/
+
+R_BSP_Scux::R_BSP_Scux(scux_ch_num_t channel, uint8_t int_level, int32_t max_write_num,
+                       int32_t max_read_num)
+{
+    (void)int_level;
+    (void)max_write_num;
+    (void)max_read_num;
+    scux_ch = (int32_t)channel;
+}
+
+R_BSP_Scux::~R_BSP_Scux(void)
+{
+}
+
+bool R_BSP_Scux::TransStart(void)
+{
+    bool    ret;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    ret = (sim_stat.is_started != true) && (sim_stat.is_src_set == true);
+    if (ret == true) {
+        sim_stat.is_started = true;
+        sim_stat.trans_start_cnt++;
+        sim_stat.start_write_cnt = 0u;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::FlushStop(void (* const callback)(int32_t))
+{
+    bool    ret;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    ret = (callback != NULL) && (sim_stat.is_started == true) && (sim_flush_cb == NULL);
+    if (ret == true) {
+        sim_flush_cb = callback;
+        sim_stat.flush_stop_cnt++;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::ClearStop(void)
+{
+    sim_done_t  done;
+    uint32_t    part;
+    pthread_t   thread;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    for (size_t i = 0u; i < sim_queue.size(); i++) {
+        /* The first buffer is being output by the DMA. It returns the bytes output. */
+        done.req = sim_queue[i];
+        done.result = ECANCELED;
+        if ((i == 0u) && (sim_cancel_part_byte > 0u)) {
+            part = (sim_cancel_part_byte < done.req.data_size) ? sim_cancel_part_byte : done.req.data_size;
+            output_ssif(done.req, part);
+            done.result = (int32_t)part;
+        }
+        sim_cancel_queue.push_back(done);
+    }
+    sim_stat.cancel_cnt += (uint32_t)sim_queue.size();
+    sim_stat.clear_stop_cnt++;
+    sim_stat.is_started = false;
+    sim_queue.clear();
+    sim_flush_cb = NULL;
+    if (is_irq_started != true) {
+        is_irq_started = true;
+        (void)pthread_create(&thread, NULL, &irq_thread, NULL);
+        (void)pthread_detach(thread);
+    }
+    (void)pthread_cond_signal(&sim_cancel_cond);
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return true;
+}
+
+bool R_BSP_Scux::SetSrcCfg(const scux_src_usr_cfg_t * const p_src_param)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((p_src_param != NULL) && (accept_cfg() == true)) {
+        sim_stat.src_cfg = *p_src_param;
+        sim_stat.is_src_set = true;
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetRoute(const scux_route_t route)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if (accept_cfg() == true) {
+        /* The SSIF routes need the SSIF settings first. */
+        if ((is_ssif_route(route) != true) || (sim_stat.is_ssif_set == true)) {
+            sim_stat.route = route;
+            sim_stat.is_route_set = true;
+            ret = true;
+        }
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetSsifCfg(const scux_ssif_usr_cfg_t * const p_ssif_param)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((p_ssif_param != NULL) && (accept_cfg() == true)) {
+        sim_stat.ssif_cfg = *p_ssif_param;
+        sim_stat.is_ssif_set = true;
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetDvuCfg(const scux_dvu_usr_cfg_t * const p_dvu_param)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((p_dvu_param != NULL) && (accept_cfg() == true)) {
+        sim_stat.dvu_cfg = *p_dvu_param;
+        sim_stat.is_dvu_set = true;
+        sim_stat.ramp_vol_cur = p_dvu_param->ramp_vol;
+        dvu_step_cnt = 0u;
+        dvu_wait_cnt = p_dvu_param->ramp_wait_time;
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetDigiVol(const uint32_t * const p_digi_vol)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((p_digi_vol != NULL) && (sim_stat.is_dvu_set == true) &&
+        (p_digi_vol[0] <= DVU_DIGI_VOL_MAX) && (p_digi_vol[1] <= DVU_DIGI_VOL_MAX)) {
+        sim_stat.dvu_cfg.digi_vol_enable = true;
+        sim_stat.dvu_cfg.digi_vol[0] = p_digi_vol[0];
+        sim_stat.dvu_cfg.digi_vol[1] = p_digi_vol[1];
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetRampVol(const uint32_t ramp_vol,
+                            const scux_dvu_ramp_time_t up_period, const scux_dvu_ramp_time_t down_period)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((sim_stat.is_dvu_set == true) && (ramp_vol <= DVU_RAMP_VOL_MUTE) &&
+        (up_period > SCUX_DVU_TIME_MIN) && (up_period < SCUX_DVU_TIME_MAX) &&
+        (down_period > SCUX_DVU_TIME_MIN) && (down_period < SCUX_DVU_TIME_MAX)) {
+        if (sim_stat.dvu_cfg.ramp_vol_enable != true) {
+            sim_stat.ramp_vol_cur = DVU_RAMP_VOL_0DB;
+        }
+        sim_stat.dvu_cfg.ramp_vol_enable = true;
+        sim_stat.dvu_cfg.ramp_wait_time = 0u;
+        sim_stat.ramp_set_cnt++;
+        dvu_wait_cnt = 0u;
+        sim_stat.dvu_cfg.ramp_vol = ramp_vol;
+        sim_stat.dvu_cfg.up_period = up_period;
+        sim_stat.dvu_cfg.down_period = down_period;
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::SetZerocrossMute(const bool mute)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if (sim_stat.is_dvu_set == true) {
+        sim_stat.dvu_cfg.zc_mute_enable = mute;
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::GetDvuStat(uint32_t * const p_dvu_stat)
+{
+    bool    ret = false;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((p_dvu_stat != NULL) && (sim_stat.is_dvu_set == true)) {
+        if (sim_stat.ramp_vol_cur >= DVU_RAMP_VOL_MUTE) {
+            *p_dvu_stat = SCUX_DVU_STAT_MUTE;
+        } else if (sim_stat.ramp_vol_cur < sim_stat.dvu_cfg.ramp_vol) {
+            *p_dvu_stat = SCUX_DVU_STAT_RAMP_DOWN;
+        } else if (sim_stat.ramp_vol_cur > sim_stat.dvu_cfg.ramp_vol) {
+            *p_dvu_stat = SCUX_DVU_STAT_RAMP_UP;
+        } else if (sim_stat.ramp_vol_cur == DVU_RAMP_VOL_0DB) {
+            *p_dvu_stat = SCUX_DVU_STAT_ORIGINAL_SIZE;
+        } else {
+            *p_dvu_stat = SCUX_DVU_STAT_RAMP_FIXED;
+        }
+        ret = true;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return ret;
+}
+
+bool R_BSP_Scux::GetWriteStat(uint32_t * const p_write_stat)
+{
+    bool    ret = false;
+
+    if (p_write_stat != NULL) {
+        (void)pthread_mutex_lock(&sim_mutex);
+        if (sim_stat.is_started != true) {
+            *p_write_stat = SCUX_STAT_STOP;
+        } else if (sim_queue.empty() == true) {
+            *p_write_stat = SCUX_STAT_IDLE;
+        } else {
+            *p_write_stat = SCUX_STAT_TRANS;
+        }
+        (void)pthread_mutex_unlock(&sim_mutex);
+        ret = true;
+    }
+    return ret;
+}
+
+bool R_BSP_Scux::GetReadStat(uint32_t * const p_read_stat)
+{
+    (void)p_read_stat;
+    return false;
+}
@@ -0,0 +1,443 @@
+/* Simulated USB mass storage devices for the GR-PEACH host tests. See msd_sim.h. */
+#include <pthread.h>
+#include <vector>
+#include "USBHost.h"
+#include "msd_sim.h"
+
+#define CBW_SIGNATURE       (0x43425355u)
+#define CSW_SIGNATURE       (0x53425355u)
+#define CBW_SIZE            (31u)
+#define CSW_SIZE            (13u)
+#define BLOCK_SIZE          (512u)
+
+#define CSW_STATUS_GOOD     (0u)
+#define CSW_STATUS_FAILED   (1u)
+
+#define SENSE_NONE          (0x00u)
+#define SENSE_NOT_READY     (0x02u)
+#define SENSE_ILLEGAL       (0x05u)
+#define SENSE_ATTENTION     (0x06u)
+
+typedef enum {
+    PHASE_CBW,
+    PHASE_DATA_IN,
+    PHASE_DATA_OUT,
+    PHASE_CSW
+} bot_phase_t;
+
+typedef struct {
+    USBDeviceConnected      dev;            /* First, so that the device is found by its pointer */
+    bool                    attached;
+    msd_sim_config_t        config;
+    msd_sim_stat_t          stat;
+    uint64_t                attach_ns;
+    bool                    attention;
+    uint8_t                 sense_key;
+    bot_phase_t             phase;
+    pthread_t               owner;          /* Thread of the command in flight */
+    uint8_t                 cmd;
+    uint32_t                tag;
+    uint32_t                lba;
+    uint32_t                residue;
+    uint8_t                 status;
+    std::vector<uint8_t>    data;           /* Data of the data stage */
+    uint32_t                data_ofs;
+} sim_device_t;
+
+static sim_device_t     sim_dev[MAX_DEVICE_CONNECTED];
+static pthread_mutex_t  sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t  bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000uLL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t load_be32(const uint8_t * const p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint32_t load_le32(const uint8_t * const p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_be32(uint8_t * const p, const uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void store_le32(uint8_t * const p, const uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static sim_device_t *find_device(USBDeviceConnected * const dev)
+{
+    for (uint32_t i = 0u; i < MAX_DEVICE_CONNECTED; i++) {
+        if ((&sim_dev[i].dev == dev) && (sim_dev[i].attached == true)) {
+            return &sim_dev[i];
+        }
+    }
+    return NULL;
+}
+
+/* Occupies the bus for the time of len bytes, or of a CBW or a CSW. */
+/* The time counted is the time slept, which is longer on the host. */
+static void bus_transfer(sim_device_t * const p_dev, const uint32_t len, const bool is_cmd)
+{
+    const uint64_t  ns = (is_cmd == true) ? ((uint64_t)p_dev->config.cmd_us * 1000u)
+                                          : ((uint64_t)len * p_dev->config.byte_ns);
+    uint64_t        start;
+
+    if (ns != 0u) {
+        (void)pthread_mutex_lock(&bus_mutex);
+        start = now_ns();
+        wait_us((int)(ns / 1000u));
+        start = now_ns() - start;
+        (void)pthread_mutex_unlock(&bus_mutex);
+        (void)pthread_mutex_lock(&sim_mutex);
+        p_dev->stat.bus_ns += start;
+        (void)pthread_mutex_unlock(&sim_mutex);
+    }
+}
+
+/* Counts a transfer which is not the one the BOT state expects. */
+static bool check_phase(sim_device_t * const p_dev, const bot_phase_t phase)
+{
+    bool    result = true;
+
+    if (p_dev->phase != phase) {
+        result = false;
+    } else if ((phase != PHASE_CBW) && (pthread_equal(p_dev->owner, pthread_self()) == 0)) {
+        result = false;
+    } else {
+        /* In turn */
+    }
+    if (result != true) {
+        p_dev->stat.bot_err_cnt++;
+    }
+    return result;
+}
+
+static void fail(sim_device_t * const p_dev, const uint8_t sense_key)
+{
+    p_dev->status = CSW_STATUS_FAILED;
+    p_dev->sense_key = sense_key;
+}
+
+/* Runs the command of a CBW and prepares its data stage. */
+static void run_command(sim_device_t * const p_dev, const uint8_t * const p_cbw)
+{
+    const uint32_t  data_len = load_le32(&p_cbw[8]);
+    const uint8_t   flags = p_cbw[12];
+    const uint8_t   * const p_cb = &p_cbw[15];
+    BlockDevice     * const bd = p_dev->config.bd;
+    const uint32_t  block_num = (uint32_t)(bd->size() / BLOCK_SIZE);
+    const bool      is_ready = ((now_ns() - p_dev->attach_ns) >= ((uint64_t)p_dev->config.ready_ms * 1000000u));
+    uint32_t        len;
+
+    p_dev->cmd = p_cb[0];
+    p_dev->tag = load_le32(&p_cbw[4]);
+    p_dev->status = CSW_STATUS_GOOD;
+    p_dev->data.assign(data_len, 0u);
+    p_dev->data_ofs = 0u;
+    p_dev->residue = 0u;
+    p_dev->owner = pthread_self();
+    p_dev->stat.cmd_cnt++;
+    if ((p_dev->cmd == 0x00u) && (p_dev->stat.tur_cnt < MSD_SIM_TUR_LOG_NUM)) {
+        p_dev->stat.tur_us[p_dev->stat.tur_cnt] = (uint32_t)((now_ns() - p_dev->attach_ns) / 1000u);
+    }
+    if ((p_dev->cmd != 0x03u) && (p_dev->cmd != 0x12u) && (is_ready != true)) {
+        fail(p_dev, SENSE_NOT_READY);
+        if (p_dev->cmd == 0x00u) {
+            p_dev->stat.tur_cnt++;
+            p_dev->stat.not_ready_cnt++;
+        }
+    } else {
+        switch (p_dev->cmd) {
+            case 0x00u:                 /* TEST UNIT READY */
+                p_dev->stat.tur_cnt++;
+                break;
+            case 0x03u:                 /* REQUEST SENSE */
+                p_dev->stat.sense_cnt++;
+                if (data_len >= 13u) {
+                    p_dev->data[0] = 0x70u;
+                    p_dev->data[2] = p_dev->sense_key;
+                    p_dev->data[7] = 10u;
+                    p_dev->data[12] = (p_dev->sense_key == SENSE_NOT_READY) ? 0x04u : 0x00u;
+                }
+                p_dev->sense_key = SENSE_NONE;
+                break;
+            case 0x12u:                 /* INQUIRY */
+                if (data_len >= 36u) {
+                    (void)memcpy(&p_dev->data[8], "HOSTSIM MSD BOT DEVICE  1.00", 28u);
+                }
+                break;
+            case 0x25u:                 /* READ CAPACITY(10): last block and block size */
+                if (p_dev->attention == true) {
+                    p_dev->attention = false;
+                    fail(p_dev, SENSE_ATTENTION);
+                } else if (data_len >= 8u) {
+                    store_be32(&p_dev->data[0], block_num - 1u);
+                    store_be32(&p_dev->data[4], BLOCK_SIZE);
+                } else {
+                    fail(p_dev, SENSE_ILLEGAL);
+                }
+                break;
+            case 0x28u:                 /* READ(10) */
+            case 0x2Au:                 /* WRITE(10) */
+                p_dev->lba = load_be32(&p_cb[2]);
+                len = (((uint32_t)p_cb[7] << 8) | (uint32_t)p_cb[8]) * BLOCK_SIZE;
+                if ((len != data_len) || (((uint64_t)p_dev->lba * BLOCK_SIZE) + len > bd->size())) {
+                    fail(p_dev, SENSE_ILLEGAL);
+                } else if (p_dev->cmd == 0x28u) {
+                    p_dev->stat.read_cmd_cnt++;
+                    p_dev->stat.read_block_cnt += len / BLOCK_SIZE;
+                    if (bd->read(&p_dev->data[0], (bd_addr_t)p_dev->lba * BLOCK_SIZE, len) != 0) {
+                        fail(p_dev, SENSE_ILLEGAL);
+                    }
+                } else {
+                    p_dev->stat.write_cmd_cnt++;
+                    p_dev->stat.write_block_cnt += len / BLOCK_SIZE;
+                }
+                break;
+            default:
+                fail(p_dev, SENSE_ILLEGAL);
+                break;
+        }
+    }
+    if (data_len == 0u) {
+        p_dev->phase = PHASE_CSW;
+    } else {
+        p_dev->phase = ((flags & 0x80u) != 0u) ? PHASE_DATA_IN : PHASE_DATA_OUT;
+    }
+}
+
+USBHost *USBHost::getHostInst()
+{
+    static USBHost  host;
+
+    return &host;
+}
+
+USB_TYPE USBHost::controlRead(USBDeviceConnected * dev, uint8_t requestType, uint8_t request, uint32_t value,
+                              uint32_t index, uint8_t * buf, uint32_t len)
+{
+    (void)requestType;
+    (void)value;
+    (void)index;
+    if (find_device(dev) == NULL) {
+        return USB_TYPE_DEVICE_NOT_RESPONDING_ERROR;
+    }
+    if ((request == 0xFEu) && (len >= 1u)) {    /* GET MAX LUN */
+        buf[0] = 0u;
+    }
+    return USB_TYPE_OK;
+}
+
+USB_TYPE USBHost::controlWrite(USBDeviceConnected * dev, uint8_t requestType, uint8_t request, uint32_t value,
+                               uint32_t index, uint8_t * buf, uint32_t len)
+{
+    sim_device_t    *p_dev;
+
+    (void)requestType;
+    (void)value;
+    (void)index;
+    (void)buf;
+    (void)len;
+    (void)pthread_mutex_lock(&sim_mutex);
+    p_dev = find_device(dev);
+    if ((p_dev != NULL) && (request == 0xFFu)) {    /* Bulk-Only Mass Storage Reset */
+        p_dev->phase = PHASE_CBW;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return (p_dev != NULL) ? USB_TYPE_OK : USB_TYPE_DEVICE_NOT_RESPONDING_ERROR;
+}
+
+USB_TYPE USBHost::bulkWrite(USBDeviceConnected * dev, USBEndpoint * ep, uint8_t * buf, uint32_t len, bool blocking)
+{
+    sim_device_t    *p_dev;
+    USB_TYPE        res = USB_TYPE_OK;
+    bool            is_cbw = false;
+    bool            is_program = false;
+
+    (void)ep;
+    (void)blocking;
+    (void)pthread_mutex_lock(&sim_mutex);
+    p_dev = find_device(dev);
+    if (p_dev == NULL) {
+        res = USB_TYPE_DEVICE_NOT_RESPONDING_ERROR;
+    } else if (p_dev->phase == PHASE_DATA_OUT) {
+        if ((check_phase(p_dev, PHASE_DATA_OUT) == true) && (len == p_dev->data.size())) {
+            (void)memcpy(&p_dev->data[0], buf, len);
+            p_dev->phase = PHASE_CSW;
+            is_program = (p_dev->status == CSW_STATUS_GOOD) && (p_dev->cmd == 0x2Au);
+        } else {
+            res = USB_TYPE_STALL_ERROR;
+        }
+    } else if ((check_phase(p_dev, PHASE_CBW) == true) && (len == CBW_SIZE) &&
+               (load_le32(&buf[0]) == CBW_SIGNATURE)) {
+        run_command(p_dev, buf);
+        is_cbw = true;
+    } else {
+        res = USB_TYPE_STALL_ERROR;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    if (res == USB_TYPE_OK) {
+        if (is_program == true) {
+            /* Like disk_write of FATFileSystem */
+            BlockDevice * const bd = p_dev->config.bd;
+            const bd_addr_t     addr = (bd_addr_t)p_dev->lba * BLOCK_SIZE;
+
+            if ((bd->erase(addr, len) != 0) || (bd->program(&p_dev->data[0], addr, len) != 0)) {
+                (void)pthread_mutex_lock(&sim_mutex);
+                fail(p_dev, SENSE_ILLEGAL);
+                (void)pthread_mutex_unlock(&sim_mutex);
+            }
+        }
+        bus_transfer(p_dev, len, is_cbw);
+    }
+    return res;
+}
+
+USB_TYPE USBHost::bulkRead(USBDeviceConnected * dev, USBEndpoint * ep, uint8_t * buf, uint32_t len, bool blocking)
+{
+    sim_device_t    *p_dev;
+    USB_TYPE        res = USB_TYPE_OK;
+    bool            is_csw = false;
+    uint32_t        n = 0u;
+
+    (void)ep;
+    (void)blocking;
+    (void)pthread_mutex_lock(&sim_mutex);
+    p_dev = find_device(dev);
+    if (p_dev == NULL) {
+        res = USB_TYPE_DEVICE_NOT_RESPONDING_ERROR;
+    } else if (p_dev->phase == PHASE_DATA_IN) {
+        if (check_phase(p_dev, PHASE_DATA_IN) == true) {
+            n = (uint32_t)p_dev->data.size() - p_dev->data_ofs;
+            if (n > len) {
+                n = len;
+            }
+            (void)memcpy(buf, &p_dev->data[p_dev->data_ofs], n);
+            p_dev->data_ofs += n;
+            if (p_dev->data_ofs == p_dev->data.size()) {
+                p_dev->phase = PHASE_CSW;
+            }
+        } else {
+            res = USB_TYPE_STALL_ERROR;
+        }
+    } else if ((check_phase(p_dev, PHASE_CSW) == true) && (len >= CSW_SIZE)) {
+        store_le32(&buf[0], CSW_SIGNATURE);
+        store_le32(&buf[4], p_dev->tag);
+        store_le32(&buf[8], p_dev->residue);
+        buf[12] = p_dev->status;
+        p_dev->phase = PHASE_CBW;
+        is_csw = true;
+    } else {
+        res = USB_TYPE_STALL_ERROR;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+
+    if (res == USB_TYPE_OK) {
+        bus_transfer(p_dev, n, is_csw);
+    }
+    return res;
+}
+
+USB_TYPE USBHost::enumerate(USBDeviceConnected * dev, IUSBEnumerator* pEnumerator)
+{
+    if (find_device(dev) == NULL) {
+        return USB_TYPE_DEVICE_NOT_RESPONDING_ERROR;
+    }
+    pEnumerator->setVidPid(dev->vid, dev->pid);
+    if (pEnumerator->parseInterface(0u, MSD_CLASS, 0x06u, 0x50u) == true) {
+        (void)pEnumerator->useEndpoint(0u, BULK_ENDPOINT, IN);
+        (void)pEnumerator->useEndpoint(0u, BULK_ENDPOINT, OUT);
+    }
+    return USB_TYPE_OK;
+}
+
+USBDeviceConnected *USBHost::getDevice(uint8_t index)
+{
+    USBDeviceConnected  *dev = NULL;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    if ((index < MAX_DEVICE_CONNECTED) && (sim_dev[index].attached == true)) {
+        dev = &sim_dev[index].dev;
+    }
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return dev;
+}
+
+void msd_sim_attach(const uint8_t index, const msd_sim_config_t &config)
+{
+    sim_device_t * const    p_dev = &sim_dev[index];
+    USBHost * const         host = USBHost::getHostInst();
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    p_dev->dev.bulk_in.init(0x81u);
+    p_dev->dev.bulk_out.init(0x02u);
+    p_dev->dev.vid = 0x0781u;
+    p_dev->dev.pid = (uint16_t)(0x5500u + index);
+    p_dev->dev.on_disconnect = mbed::Callback<void()>();
+    p_dev->config = config;
+    p_dev->stat = msd_sim_stat_t();
+    p_dev->attach_ns = now_ns();
+    p_dev->attention = config.unit_attention;
+    p_dev->sense_key = SENSE_NONE;
+    p_dev->phase = PHASE_CBW;
+    p_dev->attached = true;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    if (host->deviceEvent != NULL) {
+        host->deviceEvent();
+    }
+}
+
+void msd_sim_detach(const uint8_t index)
+{
+    sim_device_t * const    p_dev = &sim_dev[index];
+    USBHost * const         host = USBHost::getHostInst();
+    mbed::Callback<void()>  on_disconnect;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    p_dev->attached = false;
+    on_disconnect = p_dev->dev.on_disconnect;
+    p_dev->dev.on_disconnect = mbed::Callback<void()>();
+    (void)pthread_mutex_unlock(&sim_mutex);
+    if (on_disconnect) {
+        on_disconnect();
+    }
+    if (host->deviceEvent != NULL) {
+        host->deviceEvent();
+    }
+}
+
+msd_sim_stat_t msd_sim_get_stat(const uint8_t index)
+{
+    msd_sim_stat_t  stat;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    stat = sim_dev[index].stat;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return stat;
+}
+
+void msd_sim_reset_stat(const uint8_t index)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_dev[index].stat = msd_sim_stat_t();
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
@@ -0,0 +1,57 @@
+/* Simulated USB mass storage devices for the GR-PEACH host tests.
+ *
+ * msd_sim.cpp implements the USBHost of stub/usbhost/USBHost.h for up to
+ * MAX_DEVICE_CONNECTED Bulk-Only Transport (BOT) devices. Each device
+ * answers the SCSI commands of USBHostMSD from a BlockDevice of 512 bytes
+ * blocks:
+ *  - TEST UNIT READY fails with NOT READY until ready_ms after the attach,
+ *    and the time of each one from the attach is logged in tur_us;
+ *  - with unit_attention, the first READ CAPACITY fails once;
+ *  - READ(10) and WRITE(10) read and program the BlockDevice.
+ * A command is a CBW, the data stage if any, and a CSW. They are checked
+ * against the BOT state of the device: a transfer out of turn, or from
+ * another thread than the one of the command in flight, is counted in
+ * bot_err_cnt. The transfers take the bus time of the device, on the
+ * calling thread, one at a time on the bus.
+ */
+#ifndef MSD_SIM_H
+#define MSD_SIM_H
+
+#include <stdint.h>
+#include "BlockDevice.h"
+
+#define MSD_SIM_TUR_LOG_NUM (64u)   /* TEST UNIT READY logged in the stat */
+
+typedef struct {
+    BlockDevice *bd;
+    uint32_t    ready_ms;           /* Not ready until this time after the attach */
+    bool        unit_attention;     /* The first READ CAPACITY fails */
+    uint32_t    cmd_us;             /* Bus time of the CBW and of the CSW each */
+    uint32_t    byte_ns;            /* Bus time of each data byte */
+} msd_sim_config_t;
+
+typedef struct {
+    uint32_t    cmd_cnt;            /* All the SCSI commands */
+    uint32_t    tur_cnt;
+    uint32_t    not_ready_cnt;      /* TEST UNIT READY which failed */
+    uint32_t    sense_cnt;
+    uint32_t    read_cmd_cnt;
+    uint32_t    read_block_cnt;
+    uint32_t    write_cmd_cnt;
+    uint32_t    write_block_cnt;
+    uint32_t    bot_err_cnt;        /* Transfers against the BOT protocol */
+    uint64_t    bus_ns;             /* Bus time of the transfers, as slept */
+    uint32_t    tur_us[MSD_SIM_TUR_LOG_NUM];    /* Time of each TEST UNIT READY from the attach */
+} msd_sim_stat_t;
+
+/* Attaches a device at index and raises the device event of the host. */
+void msd_sim_attach(const uint8_t index, const msd_sim_config_t &config);
+
+/* Calls the disconnect callback of the driver, then the device event. */
+void msd_sim_detach(const uint8_t index);
+
+msd_sim_stat_t msd_sim_get_stat(const uint8_t index);
+
+void msd_sim_reset_stat(const uint8_t index);
+
+#endif /* MSD_SIM_H */
@@ -0,0 +1,115 @@
+/* Simulated neighbours of the decode thread for the GR-PEACH host tests.
+ * See player_sim.h.
+ */
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "decode.h"
+#include "audio_out.h"
+#include "player_sim.h"
+
+static pthread_mutex_t      sim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static player_sim_stat_t    sim_stat;
+static pthread_t            dec_thread_id;
+
+static void *dec_thread_entry(void *arg)
+{
+    (void)arg;
+    dec_thread(NULL);
+    return NULL;
+}
+
+void player_sim_start(void)
+{
+    (void)pthread_create(&dec_thread_id, NULL, &dec_thread_entry, NULL);
+    (void)pthread_detach(dec_thread_id);
+}
+
+uint64_t player_sim_cpu_ns(void)
+{
+    clockid_t       clock;
+    struct timespec ts;
+
+    if ((pthread_getcpuclockid(dec_thread_id, &clock) != 0) || (clock_gettime(clock, &ts) != 0)) {
+        return 0u;
+    }
+    return ((uint64_t)ts.tv_sec * 1000000000uLL) + (uint64_t)ts.tv_nsec;
+}
+
+player_sim_stat_t player_sim_get_stat(void)
+{
+    player_sim_stat_t   stat;
+
+    (void)pthread_mutex_lock(&sim_mutex);
+    stat = sim_stat;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return stat;
+}
+
+/*--- Audio out thread ---*/
+
+bool aud_req_data_out(const AUD_CbDataOut p_cb, const uint32_t sample_freq)
+{
+    if (p_cb == NULL) {
+        return false;
+    }
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.data_out_cnt++;
+    sim_stat.data_out_freq = sample_freq;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    p_cb(true);
+    return true;
+}
+
+bool aud_req_zero_out(void)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.zero_out_cnt++;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return true;
+}
+
+bool aud_req_mute_out(const AUD_CbMuteOut p_cb)
+{
+    if (p_cb == NULL) {
+        return false;
+    }
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.mute_out_cnt++;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    p_cb(0u);
+    return true;
+}
+
+bool aud_set_volume(const int32_t gain, const bool mute)
+{
+    (void)gain;
+    (void)mute;
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.set_volume_cnt++;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return true;
+}
+
+void aud_store_audio_data(const int32_t * const p_buf, const uint32_t sample_num)
+{
+    (void)p_buf;
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.tap_sample_cnt += sample_num;
+    (void)pthread_mutex_unlock(&sim_mutex);
+}
+
+/*--- Main thread ---*/
+
+bool sys_notify_play_time(const SYS_PlayStat play_stat,
+    const uint32_t play_time, const uint32_t total_time, const uint32_t play_sample)
+{
+    (void)pthread_mutex_lock(&sim_mutex);
+    sim_stat.notify_cnt++;
+    sim_stat.play_stat = play_stat;
+    sim_stat.play_time = play_time;
+    sim_stat.total_time = total_time;
+    sim_stat.play_sample = play_sample;
+    (void)pthread_mutex_unlock(&sim_mutex);
+    return true;
+}
@@ -0,0 +1,53 @@
+/* Simulated neighbours of the decode thread for the GR-PEACH host tests.
+ *
+ * player_sim.cpp implements the audio out API (aud_*) and the play time
+ * notification of the main thread (sys_notify_play_time) which decode.cpp
+ * calls, and runs dec_thread() on a pthread. The audio out requests are
+ * completed at once in the caller, as if the audio out thread answered
+ * immediately. Together with the simulated SCUX driver (scux_sim.h), the
+ * real decode thread runs unchanged on the host.
+ */
+#ifndef PLAYER_SIM_H
+#define PLAYER_SIM_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include "system.h"
+
+typedef struct {
+    uint32_t        data_out_cnt;       /* aud_req_data_out() */
+    uint32_t        data_out_freq;      /* Sampling frequency of the last one */
+    uint32_t        zero_out_cnt;       /* aud_req_zero_out() */
+    uint32_t        mute_out_cnt;       /* aud_req_mute_out() */
+    uint32_t        set_volume_cnt;     /* aud_set_volume() */
+    uint64_t        tap_sample_cnt;     /* Elements stored by aud_store_audio_data() */
+    uint32_t        notify_cnt;         /* sys_notify_play_time() */
+    SYS_PlayStat    play_stat;          /* Arguments of the last notification */
+    uint32_t        play_time;
+    uint32_t        total_time;
+    uint32_t        play_sample;
+} player_sim_stat_t;
+
+/* Starts dec_thread() on a pthread. It runs until the program exits. */
+void player_sim_start(void);
+
+/* Copy of the recorded requests, taken under the lock of the simulation. */
+player_sim_stat_t player_sim_get_stat(void);
+
+/* CPU time in ns used by the thread of dec_thread() so far. */
+uint64_t player_sim_cpu_ns(void);
+
+/* Polls cond every 100 us for up to 5 s. Returns false on the timeout. */
+template<typename F>
+static inline bool player_sim_wait(F cond)
+{
+    for (uint32_t i = 0u; i < 50000u; i++) {
+        if (cond()) {
+            return true;
+        }
+        (void)usleep(100u);
+    }
+    return cond();
+}
+
+#endif /* PLAYER_SIM_H */
@@ -0,0 +1,176 @@
+/* Simulated file retarget of mbed for the GR-PEACH host tests. See retarget_sim.h. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <string.h>
+#include <fcntl.h>
+#include "mbed.h"
+#include "FileSystem.h"
+#include "File.h"
+#include "Dir.h"
+#include "retarget_sim.h"
+
+#define MOUNT_MAX       (8u)
+
+typedef struct {
+    Dir             dir;
+    struct dirent   ent;
+} sim_dir_t;
+
+static FileSystem           *mount_list[MOUNT_MAX];
+static retarget_sim_stat_t  sim_stat;
+
+void retarget_sim_mount(FileSystem * const fs)
+{
+    for (uint32_t i = 0u; i < MOUNT_MAX; i++) {
+        if (mount_list[i] == NULL) {
+            mount_list[i] = fs;
+            break;
+        }
+    }
+}
+
+void retarget_sim_unmount(FileSystem * const fs)
+{
+    for (uint32_t i = 0u; i < MOUNT_MAX; i++) {
+        if (mount_list[i] == fs) {
+            mount_list[i] = NULL;
+        }
+    }
+}
+
+retarget_sim_stat_t retarget_sim_get_stat(void)
+{
+    return sim_stat;
+}
+
+/* Finds the file system of "/<name>/<path>" and returns <path>. */
+static FileSystem *lookup(const char * const path, const char ** const p_rest)
+{
+    const char  *p_name;
+    const char  *p_end;
+    size_t      len;
+
+    if ((path == NULL) || (path[0] != '/')) {
+        return NULL;
+    }
+    p_name = &path[1];
+    p_end = strchr(p_name, '/');
+    len = (p_end != NULL) ? (size_t)(p_end - p_name) : strlen(p_name);
+    *p_rest = (p_end != NULL) ? (p_end + 1) : "";
+    for (uint32_t i = 0u; i < MOUNT_MAX; i++) {
+        if ((mount_list[i] != NULL) && (strlen(mount_list[i]->getName()) == len) &&
+            (strncmp(mount_list[i]->getName(), p_name, len) == 0)) {
+            return mount_list[i];
+        }
+    }
+    return NULL;
+}
+
+DIR *retarget_sim_opendir(const char *path)
+{
+    const char  *p_rest;
+    FileSystem  *fs = lookup(path, &p_rest);
+    sim_dir_t   *p_dir = NULL;
+
+    if (fs != NULL) {
+        p_dir = new sim_dir_t;
+        if (p_dir->dir.open(fs, p_rest) != 0) {
+            delete p_dir;
+            p_dir = NULL;
+        }
+    }
+    if (p_dir != NULL) {
+        sim_stat.dir_open_cnt++;
+    } else {
+        sim_stat.open_err_cnt++;
+    }
+    /* The DIR of the C library is never dereferenced here. */
+    return reinterpret_cast<DIR *>(p_dir);
+}
+
+struct dirent *retarget_sim_readdir(DIR *p_dir)
+{
+    sim_dir_t * const   p_sim = reinterpret_cast<sim_dir_t *>(p_dir);
+
+    (void)memset(&p_sim->ent, 0, sizeof(p_sim->ent));
+    return (p_sim->dir.read(&p_sim->ent) > 0) ? &p_sim->ent : NULL;
+}
+
+int retarget_sim_closedir(DIR *p_dir)
+{
+    sim_dir_t * const   p_sim = reinterpret_cast<sim_dir_t *>(p_dir);
+    const int           result = p_sim->dir.close();
+
+    delete p_sim;
+    sim_stat.dir_open_cnt--;
+    return result;
+}
+
+static ssize_t file_read(void *cookie, char *buf, size_t size)
+{
+    return static_cast<File *>(cookie)->read(buf, size);
+}
+
+static ssize_t file_write(void *cookie, const char *buf, size_t size)
+{
+    return static_cast<File *>(cookie)->write(buf, size);
+}
+
+static int file_seek(void *cookie, off64_t *p_ofs, int whence)
+{
+    const off_t pos = static_cast<File *>(cookie)->seek((off_t)*p_ofs, whence);
+
+    if (pos < 0) {
+        return -1;
+    }
+    *p_ofs = pos;
+    return 0;
+}
+
+static int file_close(void *cookie)
+{
+    File * const    p_file = static_cast<File *>(cookie);
+    const int       result = p_file->close();
+
+    delete p_file;
+    sim_stat.file_open_cnt--;
+    return result;
+}
+
+FILE *retarget_sim_fopen(const char *path, const char *mode)
+{
+    static const cookie_io_functions_t  io = { file_read, file_write, file_seek, file_close };
+    const char                          *p_rest;
+    FileSystem                          *fs = lookup(path, &p_rest);
+    File                                *p_file = NULL;
+    FILE                                *fp = NULL;
+    int                                 flags = O_RDONLY;
+
+    if (strchr(mode, 'w') != NULL) {
+        flags = O_WRONLY | O_CREAT | O_TRUNC;
+    } else if (strchr(mode, 'a') != NULL) {
+        flags = O_WRONLY | O_CREAT | O_APPEND;
+    }
+    if (strchr(mode, '+') != NULL) {
+        flags = (flags & ~O_WRONLY) | O_RDWR;
+    }
+    if (fs != NULL) {
+        p_file = new File;
+        if (p_file->open(fs, p_rest, flags) == 0) {
+            fp = fopencookie(p_file, mode, io);
+            if (fp == NULL) {
+                (void)p_file->close();
+            }
+        }
+        if (fp == NULL) {
+            delete p_file;
+        }
+    }
+    if (fp != NULL) {
+        sim_stat.file_open_cnt++;
+    } else {
+        sim_stat.open_err_cnt++;
+    }
+    return fp;
+}
@@ -0,0 +1,55 @@
+/* Simulated file retarget of mbed for the GR-PEACH host tests.
+ *
+ * On the target, opendir() and fopen() of "/usb0/folder/track.flac" find
+ * the file system mounted as "usb0" and open "folder/track.flac" on it.
+ * retarget_sim.cpp does the same for the file systems registered by
+ * retarget_sim_mount(): a module compiled with -include retarget_sim.h
+ * calls the functions below in place of the ones of the C library. The
+ * FILE of fopen() reads through an mbed File (fopencookie), so fclose()
+ * and the rest of stdio are the ones of the host. The shim is for one
+ * thread.
+ */
+#ifndef RETARGET_SIM_H
+#define RETARGET_SIM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <dirent.h>
+
+#ifdef __cplusplus
+namespace mbed {
+class FileSystem;
+}
+
+/* Makes the paths "/<name of fs>/..." reach fs. */
+void retarget_sim_mount(mbed::FileSystem * const fs);
+
+/* The paths of fs fail from now on. Open handles stay valid. */
+void retarget_sim_unmount(mbed::FileSystem * const fs);
+#endif
+
+typedef struct {
+    uint32_t    dir_open_cnt;       /* Directories open */
+    uint32_t    file_open_cnt;      /* Files open */
+    uint32_t    open_err_cnt;       /* opendir() and fopen() which failed */
+} retarget_sim_stat_t;
+
+retarget_sim_stat_t retarget_sim_get_stat(void);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+DIR *retarget_sim_opendir(const char *path);
+struct dirent *retarget_sim_readdir(DIR *p_dir);
+int retarget_sim_closedir(DIR *p_dir);
+FILE *retarget_sim_fopen(const char *path, const char *mode);
+#ifdef __cplusplus
+}
+#endif
+
+#define opendir     retarget_sim_opendir
+#define readdir     retarget_sim_readdir
+#define closedir    retarget_sim_closedir
+#define fopen       retarget_sim_fopen
+
+#endif /* RETARGET_SIM_H */
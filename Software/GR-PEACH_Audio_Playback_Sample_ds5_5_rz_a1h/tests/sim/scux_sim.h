@@ -0,0 +1,86 @@
+/* Simulated SCUX driver for the GR-PEACH host tests.
+ *
+ * R_BSP_Scux_sim.cpp implements the R_BSP_Scux API of one channel in
+ * place of the RenesasBSP driver. It records the configuration requests,
+ * rejects the ones the driver only accepts while SCUX is stopped, and
+ * queues the written buffers. The test completes the queued buffers with
+ * scux_sim_pump() as the DMA would, and the data of the SSIF route is
+ * appended to the simulated SSIF output.
+ *
+ * The data of the SSIF route passes a software model of DVU:
+ *  - the digital volume multiplies by digi_vol / DVU_DIGI_VOL_0DB,
+ *  - the ramp volume is an attenuation in 0.125 dB units (DVU_RAMP_VOL_PER_DB
+ *    per dB, DVU_RAMP_VOL_MUTE is mute). It moves to the target by the ramp
+ *    period: "N dB among 1 step" moves N dB per frame, "0.125 dB among N
+ *    step" moves 0.125 dB per N frames. The step is taken after each frame.
+ *  - the zero cross mute mutes each channel at its next change of sign.
+ * SetDvuCfg() starts the ramp volume at its target, as it is only accepted
+ * while SCUX is stopped.
+ *
+ * ClearStop() cancels the queued buffers. Their results are delivered by a
+ * thread of the simulation after ClearStop() returned, like from the DMA
+ * interrupt of the target. The first of them is the one being output: after
+ * scux_sim_set_cancel_part(), it has output that many bytes to SSIF and its
+ * result is their count, as R_DMA_Cancel() leaves a partial transfer.
+ */
+#ifndef SCUX_SIM_H
+#define SCUX_SIM_H
+
+#include <stdint.h>
+#include <vector>
+#include "R_BSP_Scux.h"
+
+typedef struct {
+    bool                    is_started;         /* Between TransStart() and the stop */
+    bool                    is_ssif_set;
+    bool                    is_route_set;
+    bool                    is_src_set;
+    bool                    is_dvu_set;
+    scux_ssif_usr_cfg_t     ssif_cfg;
+    scux_route_t            route;
+    scux_src_usr_cfg_t      src_cfg;
+    scux_dvu_usr_cfg_t      dvu_cfg;
+    uint32_t                trans_start_cnt;
+    uint32_t                clear_stop_cnt;
+    uint32_t                flush_stop_cnt;
+    uint32_t                cfg_reject_cnt;     /* Configuration requested while started */
+    uint32_t                write_cnt;          /* Accepted write requests */
+    uint64_t                write_byte;         /* Bytes of them */
+    uint32_t                start_write_cnt;    /* Accepted write requests since TransStart() */
+    uint64_t                first_write_ns;     /* CLOCK_MONOTONIC of the first one of them */
+    uint64_t                last_write_ns;      /* CLOCK_MONOTONIC of the last one of them */
+    uint32_t                cancel_cnt;         /* Writes cancelled by ClearStop() */
+    uint32_t                cancel_fin_cnt;     /* Results of them delivered */
+    uint32_t                read_cnt;           /* Read requests (memory route only) */
+    uint32_t                ramp_vol_cur;       /* Ramp volume of DVU at the SSIF output */
+    uint32_t                ramp_set_cnt;       /* Accepted SetRampVol() */
+} scux_sim_stat_t;
+
+/* Resets the simulation. The configuration is cleared as after power on. */
+void scux_sim_reset(void);
+
+/* Copy of the state, taken under the lock of the simulation. */
+scux_sim_stat_t scux_sim_get_stat(void);
+
+/* Number of the written buffers which are not completed yet. */
+uint32_t scux_sim_queued_num(void);
+
+/* Bytes of the written buffers which are not completed yet. */
+uint32_t scux_sim_queued_byte(void);
+
+/* Bytes of the first of them, which the DMA outputs now. 0 if none. */
+uint32_t scux_sim_head_byte(void);
+
+/* Completes up to max_num queued buffers and calls their callbacks.
+ * When FlushStop() is pending and the queue becomes empty, SCUX stops
+ * and the flush callback is called. Returns the number completed. */
+uint32_t scux_sim_pump(const uint32_t max_num);
+
+/* Bytes of the first cancelled buffer output before ClearStop(), rounded */
+/* down to a frame. 0 (default after the reset) cancels it whole. */
+void scux_sim_set_cancel_part(const uint32_t byte);
+
+/* Data output to SSIF so far (2ch interleaved, 24 bits data with 8 bits padding). */
+std::vector<int32_t> scux_sim_ssif_out(void);
+
+#endif /* SCUX_SIM_H */
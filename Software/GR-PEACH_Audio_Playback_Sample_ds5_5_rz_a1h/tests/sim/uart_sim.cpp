@@ -0,0 +1,173 @@
+/* Simulated console UART for the GR-PEACH host tests. See uart_sim.h. */
+#include <deque>
+#include "mbed.h"
+#include "uart_sim.h"
+
+#define BITS_PER_BYTE       (10u)       /* Start, 8 data and stop bits */
+#define US_PER_SEC          (1000000.0)
+
+static uart_sim_stat_t      sim_stat;
+static std::deque<uint8_t>  tx_fifo;
+static std::deque<uint8_t>  rx_fifo;
+static std::vector<uint8_t> tx_out;
+static void                 (*tx_handler)(void) = NULL;
+static void                 (*rx_handler)(void) = NULL;
+static bool                 tx_irq_enable;
+static bool                 rx_irq_pending;
+static bool                 in_irq;
+static uint32_t             critical_depth;
+static double               byte_time_us;       /* Time left of the byte on the line */
+
+/* Raises the interrupts whose condition is met, unless masked. */
+static void dispatch(void)
+{
+    if ((critical_depth == 0u) && (in_irq != true)) {
+        in_irq = true;
+        while (((tx_irq_enable == true) && (tx_fifo.size() <= UART_SIM_TX_TRIGGER) && (tx_handler != NULL)) ||
+               ((rx_irq_pending == true) && (rx_handler != NULL))) {
+            if ((rx_irq_pending == true) && (rx_handler != NULL)) {
+                rx_irq_pending = false;
+                sim_stat.rx_irq_cnt++;
+                rx_handler();
+            } else {
+                tx_irq_enable = false;
+                sim_stat.tx_irq_cnt++;
+                tx_handler();
+            }
+        }
+        in_irq = false;
+    }
+}
+
+void uart_sim_reset(void)
+{
+    const uint32_t  baud = sim_stat.baud;
+
+    sim_stat = uart_sim_stat_t();
+    sim_stat.baud = baud;
+    tx_fifo.clear();
+    rx_fifo.clear();
+    tx_out.clear();
+    tx_irq_enable = false;
+    rx_irq_pending = false;
+    byte_time_us = 0.0;
+}
+
+uart_sim_stat_t uart_sim_get_stat(void)
+{
+    return sim_stat;
+}
+
+void uart_sim_run(const uint32_t us)
+{
+    double      rest = (double)us;
+
+    dispatch();
+    while ((rest > 0.0) && (tx_fifo.empty() != true)) {
+        if (byte_time_us <= 0.0) {
+            byte_time_us = (BITS_PER_BYTE * US_PER_SEC) / sim_stat.baud;
+        }
+        if (byte_time_us <= rest) {
+            rest -= byte_time_us;
+            byte_time_us = 0.0;
+            tx_out.push_back(tx_fifo.front());
+            tx_fifo.pop_front();
+            dispatch();
+        } else {
+            byte_time_us -= rest;
+            rest = 0.0;
+        }
+    }
+    sim_stat.time_us += us;
+}
+
+uint64_t uart_sim_run_until_idle(void)
+{
+    const uint64_t  start = sim_stat.time_us;
+
+    dispatch();
+    while ((tx_fifo.empty() != true) || (tx_irq_enable == true)) {
+        uart_sim_run(1u);
+    }
+    return sim_stat.time_us - start;
+}
+
+void uart_sim_receive(const char * const p_data, const uint32_t len)
+{
+    for (uint32_t i = 0u; i < len; i++) {
+        if (rx_fifo.size() < UART_SIM_FIFO_SIZE) {
+            rx_fifo.push_back((uint8_t)p_data[i]);
+        } else {
+            sim_stat.rx_lost_cnt++;
+        }
+    }
+    rx_irq_pending = true;
+    dispatch();
+}
+
+const std::vector<uint8_t> &uart_sim_tx_out(void)
+{
+    return tx_out;
+}
+
+RawSerial::RawSerial(PinName tx, PinName rx)
+{
+    (void)tx;
+    (void)rx;
+}
+
+void RawSerial::baud(int baudrate)
+{
+    sim_stat.baud = (uint32_t)baudrate;
+}
+
+void RawSerial::attach(void (*func)(void), IrqType type)
+{
+    if (type == TxIrq) {
+        tx_handler = func;
+    } else {
+        rx_handler = func;
+    }
+}
+
+int RawSerial::readable(void)
+{
+    return (rx_fifo.empty() != true) ? 1 : 0;
+}
+
+int RawSerial::writeable(void)
+{
+    return (tx_fifo.size() < UART_SIM_FIFO_SIZE) ? 1 : 0;
+}
+
+int RawSerial::getc(void)
+{
+    int     c = -1;
+
+    if (rx_fifo.empty() != true) {
+        c = (int)rx_fifo.front();
+        rx_fifo.pop_front();
+    }
+    return c;
+}
+
+int RawSerial::putc(int c)
+{
+    if (tx_fifo.size() < UART_SIM_FIFO_SIZE) {
+        tx_fifo.push_back((uint8_t)c);
+    }
+    tx_irq_enable = true;
+    dispatch();
+    return c;
+}
+
+void core_util_critical_section_enter(void)
+{
+    critical_depth++;
+}
+
+void core_util_critical_section_exit(void)
+{
+    critical_depth--;
+    dispatch();
+}
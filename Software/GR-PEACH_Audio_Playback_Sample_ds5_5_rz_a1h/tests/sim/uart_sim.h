@@ -0,0 +1,48 @@
+/* Simulated console UART for the GR-PEACH host tests.
+ *
+ * uart_sim.cpp implements the RawSerial of the stub mbed.h like the SCIF
+ * of RZ/A1H: a 16 bytes transmit FIFO sent at the baud rate (10 bits per
+ * byte) and a 16 bytes receive FIFO. The test advances the time with
+ * uart_sim_run(), and the interrupts are raised from there:
+ *  - TxIrq while it is enabled and the transmit FIFO holds at most
+ *    UART_SIM_TX_TRIGGER bytes. Its enable is cleared before the handler,
+ *    and putc() sets it again, like the mbed serial driver.
+ *  - RxIrq by uart_sim_receive().
+ * Interrupts raised in the critical section are taken at its exit.
+ */
+#ifndef UART_SIM_H
+#define UART_SIM_H
+
+#include <stdint.h>
+#include <vector>
+
+#define UART_SIM_FIFO_SIZE      (16u)
+#define UART_SIM_TX_TRIGGER     (8u)
+
+typedef struct {
+    uint32_t    baud;
+    uint32_t    tx_irq_cnt;
+    uint32_t    rx_irq_cnt;
+    uint32_t    rx_lost_cnt;        /* Bytes lost by the receive FIFO overrun */
+    uint64_t    time_us;
+} uart_sim_stat_t;
+
+/* Clears the FIFOs, the output and the statistics. The handlers stay attached. */
+void uart_sim_reset(void);
+
+uart_sim_stat_t uart_sim_get_stat(void);
+
+/* Advances the time by us microseconds. */
+void uart_sim_run(const uint32_t us);
+
+/* Runs until the transmit FIFO is empty and TxIrq is not expected. */
+/* Returns the time it took in microseconds. */
+uint64_t uart_sim_run_until_idle(void);
+
+/* Receives len bytes at once and raises RxIrq. */
+void uart_sim_receive(const char * const p_data, const uint32_t len);
+
+/* Bytes sent on the line since the reset. */
+const std::vector<uint8_t> &uart_sim_tx_out(void);
+
+#endif /* UART_SIM_H */
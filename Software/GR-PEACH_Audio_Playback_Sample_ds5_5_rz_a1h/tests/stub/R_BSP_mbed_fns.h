@@ -0,0 +1,13 @@
+/* Host stub of R_BSP_mbed_fns.h for the GR-PEACH host tests.
+ * The real header pulls in the POSIX AIO types of the Renesas BSP, which
+ * clash with the host C library. The driver function table is only
+ * referenced by pointer in the R_BSP class headers.
+ */
+#ifndef R_BSP_MBED_FNS_H
+#define R_BSP_MBED_FNS_H
+
+#include "r_typedefs.h"
+
+typedef struct host_rbsp_mbed_fns_st RBSP_MBED_FNS;
+
+#endif /* R_BSP_MBED_FNS_H */
@@ -0,0 +1,11 @@
+/* Host stub of USBHostMSD.h for the GR-PEACH host tests.
+ * The decode and display headers include it only for the C library headers
+ * it pulls in; the MSD class itself is replaced by the tests that need it.
+ */
+#ifndef HOST_STUB_USBHOSTMSD_H
+#define HOST_STUB_USBHOSTMSD_H
+
+#include <stdio.h>
+#include <limits.h>
+
+#endif /* HOST_STUB_USBHOSTMSD_H */
@@ -0,0 +1,62 @@
+/* Host stub of the CMSIS-RTOS header for the GR-PEACH host tests.
+ * Only the types used by the application and R_BSP headers are defined.
+ */
+#ifndef HOST_STUB_CMSIS_OS_H
+#define HOST_STUB_CMSIS_OS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    osPriorityIdle          = -3,
+    osPriorityLow           = -2,
+    osPriorityBelowNormal   = -1,
+    osPriorityNormal        =  0,
+    osPriorityAboveNormal   = +1,
+    osPriorityHigh          = +2,
+    osPriorityRealtime      = +3,
+    osPriorityError         = 0x84
+} osPriority;
+
+typedef enum {
+    osOK                    =    0,
+    osEventSignal           = 0x08,
+    osEventMessage          = 0x10,
+    osEventMail             = 0x20,
+    osEventTimeout          = 0x40,
+    osErrorParameter        = 0x80,
+    osErrorResource         = 0x81,
+    osErrorTimeoutResource  = 0xC1,
+    osErrorISR              = 0x82,
+    osErrorValue            = 0x86,
+    osErrorNoMemory         = 0x85,
+    osErrorOS               = 0xFF
+} osStatus;
+
+#define osWaitForever       (0xFFFFFFFFu)
+
+typedef struct host_thread_st *osThreadId;
+
+typedef struct {
+    osStatus                status;
+    union {
+        uint32_t            v;
+        void                *p;
+        int32_t             signals;
+    } value;
+    union {
+        void                *mail_id;
+        void                *message_id;
+    } def;
+} osEvent;
+
+int32_t osSignalSet(osThreadId thread_id, int32_t signals);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_STUB_CMSIS_OS_H */
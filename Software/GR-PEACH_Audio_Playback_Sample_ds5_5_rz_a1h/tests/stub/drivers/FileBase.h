@@ -0,0 +1,42 @@
+/* Host stub of FileBase for the GR-PEACH host tests.
+ * Only the name is kept: the host tests reach the file systems through
+ * their objects, not through the retarget lookup of fopen().
+ */
+#ifndef HOST_STUB_FILE_BASE_H
+#define HOST_STUB_FILE_BASE_H
+
+#include "platform/platform.h"
+#include "platform/SingletonPtr.h"
+#include "platform/PlatformMutex.h"
+
+namespace mbed {
+
+typedef enum {
+    FilePathType,
+    FileSystemPathType
+} PathType;
+
+class FileBase {
+public:
+    FileBase(const char *name, PathType t) : _name(name), _path_type(t) {}
+    virtual ~FileBase() {}
+
+    const char *getName(void) {
+        return _name;
+    }
+
+    PathType getPathType(void) {
+        return _path_type;
+    }
+
+private:
+    const char * const  _name;
+    const PathType      _path_type;
+
+    FileBase(const FileBase &);
+    FileBase &operator=(const FileBase &);
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_FILE_BASE_H */
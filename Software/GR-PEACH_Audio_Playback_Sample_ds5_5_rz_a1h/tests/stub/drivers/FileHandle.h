@@ -0,0 +1,9 @@
+/* Host stub of FileHandle for the GR-PEACH host tests.
+ * FATFileSystem.h includes it, but the file system does not use it.
+ */
+#ifndef HOST_STUB_FILE_HANDLE_H
+#define HOST_STUB_FILE_HANDLE_H
+
+#include "drivers/FileLike.h"
+
+#endif /* HOST_STUB_FILE_HANDLE_H */
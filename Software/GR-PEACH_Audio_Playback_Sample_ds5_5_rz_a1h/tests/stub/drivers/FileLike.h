@@ -0,0 +1,17 @@
+/* Host stub of FileLike for the GR-PEACH host tests. */
+#ifndef HOST_STUB_FILE_LIKE_H
+#define HOST_STUB_FILE_LIKE_H
+
+#include "drivers/FileBase.h"
+
+namespace mbed {
+
+class FileLike : public FileBase {
+public:
+    FileLike(const char *name = NULL) : FileBase(name, FilePathType) {}
+    virtual ~FileLike() {}
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_FILE_LIKE_H */
@@ -0,0 +1,62 @@
+/* Host stub of Timer for the GR-PEACH host tests, on the monotonic clock. */
+#ifndef HOST_STUB_TIMER_H
+#define HOST_STUB_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+namespace mbed {
+
+class Timer {
+public:
+    Timer() : _start_us(0), _time_us(0), _running(false) {}
+
+    void start() {
+        if (!_running) {
+            _start_us = now_us();
+            _running = true;
+        }
+    }
+
+    void stop() {
+        _time_us = read_high_resolution_us();
+        _running = false;
+    }
+
+    void reset() {
+        _start_us = now_us();
+        _time_us = 0;
+    }
+
+    int read_us() {
+        return (int)read_high_resolution_us();
+    }
+
+    int read_ms() {
+        return (int)(read_high_resolution_us() / 1000);
+    }
+
+    float read() {
+        return (float)read_high_resolution_us() / 1000000.0f;
+    }
+
+    uint64_t read_high_resolution_us() {
+        return _running ? (_time_us + now_us() - _start_us) : _time_us;
+    }
+
+private:
+    uint64_t    _start_us;
+    uint64_t    _time_us;
+    bool        _running;
+
+    static uint64_t now_us() {
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+    }
+};
+
+} // namespace mbed
+
+#endif /* HOST_STUB_TIMER_H */
@@ -0,0 +1,21 @@
+/* Host integer types of FatFs for the GR-PEACH host tests.
+ * ChaN/integer.h makes DWORD an unsigned long, which is 64 bits on a
+ * Linux host, while FatFs and the on-disk structures need 32 bits. This
+ * header is included first into every unit of the host FatFs build
+ * (-include), and its guard keeps integer.h out.
+ */
+#ifndef _FF_INTEGER
+#define _FF_INTEGER
+
+#include <stdint.h>
+
+typedef uint8_t         BYTE;
+typedef int16_t         SHORT;
+typedef uint16_t        WORD;
+typedef uint16_t        WCHAR;
+typedef int             INT;
+typedef unsigned int    UINT;
+typedef int32_t         LONG;
+typedef uint32_t        DWORD;
+
+#endif /* _FF_INTEGER */
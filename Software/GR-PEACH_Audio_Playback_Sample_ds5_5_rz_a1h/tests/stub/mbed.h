@@ -0,0 +1,81 @@
+/* Host stub of the mbed header for the GR-PEACH host tests.
+ * Only the C library, Callback, Timer and the few target definitions
+ * used by the application modules are provided. The serial port of the console and
+ * the critical section are implemented by sim/uart_sim.cpp.
+ */
+#ifndef HOST_STUB_MBED_H
+#define HOST_STUB_MBED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifndef __DMB
+#define __DMB()     __sync_synchronize()
+#endif
+
+/* Checked in every build type. <assert.h> is shadowed by FLAC/assert.h. */
+#define MBED_ASSERT(expr)                                                       \
+    do {                                                                        \
+        if (!(expr)) {                                                          \
+            (void)fprintf(stderr, "%s:%d: MBED_ASSERT: %s\n", __FILE__, __LINE__, #expr); \
+            abort();                                                            \
+        }                                                                       \
+    } while (0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* Microsecond ticker. It is defined by the host test which needs it. */
+uint32_t us_ticker_read(void);
+
+static inline void wait_us(int us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000L;
+    (void)nanosleep(&ts, NULL);
+}
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+typedef enum {
+    USBTX,
+    USBRX
+} PinName;
+
+class SerialBase {
+public:
+    enum IrqType {
+        RxIrq = 0,
+        TxIrq
+    };
+};
+
+class RawSerial : public SerialBase {
+public:
+    RawSerial(PinName tx, PinName rx);
+    void baud(int baudrate);
+    void attach(void (*func)(void), IrqType type = RxIrq);
+    int readable(void);
+    int writeable(void);
+    int getc(void);
+    int putc(int c);
+};
+
+void core_util_critical_section_enter(void);
+void core_util_critical_section_exit(void);
+
+/* Like the mbed.h of the target, for the drivers of mbed. */
+#include "platform/Callback.h"
+#include "drivers/Timer.h"
+using namespace mbed;
+#endif /* __cplusplus */
+
+#endif /* HOST_STUB_MBED_H */
@@ -0,0 +1,69 @@
+/* Host stub of Callback for the GR-PEACH host tests.
+ * A Callback holds a function, a member function bound to its object or a
+ * function bound to its first argument, like the Callback of mbed.
+ */
+#ifndef HOST_STUB_CALLBACK_H
+#define HOST_STUB_CALLBACK_H
+
+#include <functional>
+
+namespace mbed {
+
+template <typename F>
+class Callback;
+
+template <typename R, typename... A>
+class Callback<R(A...)> {
+public:
+    Callback() {}
+
+    Callback(R (*func)(A...)) {
+        if (func != NULL) {
+            _func = func;
+        }
+    }
+
+    template <typename T>
+    Callback(T *obj, R (T::*method)(A...)) {
+        _func = [obj, method](A... args) -> R { return (obj->*method)(args...); };
+    }
+
+    template <typename T, typename U>
+    Callback(R (*func)(T *, A...), U *arg) {
+        _func = [func, arg](A... args) -> R { return func(arg, args...); };
+    }
+
+    R call(A... args) const {
+        return _func(args...);
+    }
+
+    R operator()(A... args) const {
+        return _func(args...);
+    }
+
+    operator bool() const {
+        return (bool)_func;
+    }
+
+private:
+    std::function<R(A...)> _func;
+};
+
+template <typename R, typename... A>
+Callback<R(A...)> callback(R (*func)(A...)) {
+    return Callback<R(A...)>(func);
+}
+
+template <typename T, typename R, typename... A>
+Callback<R(A...)> callback(T *obj, R (T::*method)(A...)) {
+    return Callback<R(A...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(R (*func)(T *, A...), U *arg) {
+    return Callback<R(A...)>(func, arg);
+}
+
+} // namespace mbed
+
+#endif /* HOST_STUB_CALLBACK_H */
@@ -0,0 +1,50 @@
+/* Host stub of PlatformMutex for the GR-PEACH host tests.
+ * Like rtos::Mutex on the target, the mutex is recursive and has
+ * priority inheritance. Each thread counts the locks it takes, so that a
+ * test can tell which calls lock at all.
+ */
+#ifndef HOST_STUB_PLATFORM_MUTEX_H
+#define HOST_STUB_PLATFORM_MUTEX_H
+
+#include <pthread.h>
+
+class PlatformMutex {
+public:
+    PlatformMutex() {
+        pthread_mutexattr_t attr;
+
+        (void)pthread_mutexattr_init(&attr);
+        (void)pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        (void)pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+        (void)pthread_mutex_init(&_mutex, &attr);
+        (void)pthread_mutexattr_destroy(&attr);
+    }
+
+    ~PlatformMutex() {
+        (void)pthread_mutex_destroy(&_mutex);
+    }
+
+    void lock() {
+        thread_lock_count()++;
+        (void)pthread_mutex_lock(&_mutex);
+    }
+
+    void unlock() {
+        (void)pthread_mutex_unlock(&_mutex);
+    }
+
+    /* Locks taken by the calling thread on any PlatformMutex. */
+    static unsigned long &thread_lock_count() {
+        static thread_local unsigned long cnt = 0u;
+
+        return cnt;
+    }
+
+private:
+    pthread_mutex_t _mutex;
+
+    PlatformMutex(const PlatformMutex &);
+    PlatformMutex &operator=(const PlatformMutex &);
+};
+
+#endif /* HOST_STUB_PLATFORM_MUTEX_H */
@@ -0,0 +1,45 @@
+/* Host stub of SingletonPtr for the GR-PEACH host tests.
+ * Like on the target, a static SingletonPtr is zero initialized and its
+ * object is constructed in place on the first use, here under a pthread
+ * mutex instead of the singleton lock of the RTOS.
+ */
+#ifndef HOST_STUB_SINGLETON_PTR_H
+#define HOST_STUB_SINGLETON_PTR_H
+
+#include <stdint.h>
+#include <new>
+#include <pthread.h>
+
+static inline pthread_mutex_t *singleton_mutex(void)
+{
+    static pthread_mutex_t  mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    return &mutex;
+}
+
+template <class T>
+struct SingletonPtr {
+    T *get() {
+        T   *p_obj = __atomic_load_n(&_ptr, __ATOMIC_ACQUIRE);
+
+        if (p_obj == NULL) {
+            (void)pthread_mutex_lock(singleton_mutex());
+            p_obj = _ptr;
+            if (p_obj == NULL) {
+                p_obj = new (_data) T();
+                __atomic_store_n(&_ptr, p_obj, __ATOMIC_RELEASE);
+            }
+            (void)pthread_mutex_unlock(singleton_mutex());
+        }
+        return p_obj;
+    }
+
+    T *operator->() {
+        return get();
+    }
+
+    T       *_ptr;
+    uint64_t _data[(sizeof(T) + sizeof(uint64_t) - 1u) / sizeof(uint64_t)];
+};
+
+#endif /* HOST_STUB_SINGLETON_PTR_H */
@@ -0,0 +1,9 @@
+/* Host stub of the mbed critical section header for the GR-PEACH host
+ * tests. The functions are declared by the stub mbed.h.
+ */
+#ifndef HOST_STUB_MBED_CRITICAL_H
+#define HOST_STUB_MBED_CRITICAL_H
+
+#include "mbed.h"
+
+#endif /* HOST_STUB_MBED_CRITICAL_H */
@@ -0,0 +1,28 @@
+/* Host stub of the mbed debug header for the GR-PEACH host tests. */
+#ifndef HOST_STUB_MBED_DEBUG_H
+#define HOST_STUB_MBED_DEBUG_H
+
+#include <stdio.h>
+#include <stdarg.h>
+
+static inline void debug(const char *format, ...)
+{
+    va_list     args;
+
+    va_start(args, format);
+    (void)vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+static inline void debug_if(int condition, const char *format, ...)
+{
+    va_list     args;
+
+    if (condition) {
+        va_start(args, format);
+        (void)vfprintf(stderr, format, args);
+        va_end(args);
+    }
+}
+
+#endif /* HOST_STUB_MBED_DEBUG_H */
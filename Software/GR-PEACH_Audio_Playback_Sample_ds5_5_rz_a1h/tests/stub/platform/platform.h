@@ -0,0 +1,20 @@
+/* Host stub of the mbed platform header for the GR-PEACH host tests.
+ * The C library and the POSIX types of mbed_retarget.h are the ones of
+ * the host.
+ */
+#ifndef HOST_STUB_PLATFORM_H
+#define HOST_STUB_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#endif /* HOST_STUB_PLATFORM_H */
@@ -0,0 +1,251 @@
+/* Host stub of the mbed RTOS header for the GR-PEACH host tests.
+ * Mail, Mutex, Semaphore and Thread are implemented on pthread, so the
+ * thread functions of the application and the USB drivers can run on the
+ * host. Like on the target, a Mail is never destroyed while its thread
+ * may wait on it, and a Thread is not joined by its destructor: the
+ * tests keep the objects which own threads until the end.
+ */
+#ifndef HOST_STUB_RTOS_H
+#define HOST_STUB_RTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <pthread.h>
+#include "cmsis_os.h"
+#include "mbed.h"
+
+/* Recursive, like the mutex of RTX. */
+class Mutex {
+public:
+    Mutex() {
+        pthread_mutexattr_t attr;
+
+        (void)pthread_mutexattr_init(&attr);
+        (void)pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        (void)pthread_mutex_init(&mutex, &attr);
+        (void)pthread_mutexattr_destroy(&attr);
+    }
+
+    osStatus lock(uint32_t millisec = osWaitForever) {
+        (void)millisec;
+        (void)pthread_mutex_lock(&mutex);
+        return osOK;
+    }
+
+    bool trylock() {
+        return (pthread_mutex_trylock(&mutex) == 0);
+    }
+
+    osStatus unlock() {
+        (void)pthread_mutex_unlock(&mutex);
+        return osOK;
+    }
+
+private:
+    pthread_mutex_t mutex;
+};
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0) : tokens(count) {
+        (void)pthread_mutex_init(&mutex, NULL);
+        (void)pthread_cond_init(&cond, NULL);
+    }
+
+    /* Returns the tokens available before this one was taken, or 0 at */
+    /* the timeout. */
+    int32_t wait(uint32_t millisec = osWaitForever) {
+        struct timespec ts;
+        int32_t         cnt = 0;
+        int             err = 0;
+
+        host_deadline(millisec, &ts);
+        (void)pthread_mutex_lock(&mutex);
+        while ((tokens == 0) && (err == 0) && (millisec != 0u)) {
+            if (millisec == osWaitForever) {
+                err = pthread_cond_wait(&cond, &mutex);
+            } else {
+                err = pthread_cond_timedwait(&cond, &mutex, &ts);
+            }
+        }
+        if (tokens > 0) {
+            cnt = tokens;
+            tokens--;
+        }
+        (void)pthread_mutex_unlock(&mutex);
+        return cnt;
+    }
+
+    osStatus release(void) {
+        (void)pthread_mutex_lock(&mutex);
+        tokens++;
+        (void)pthread_cond_signal(&cond);
+        (void)pthread_mutex_unlock(&mutex);
+        return osOK;
+    }
+
+private:
+    int32_t         tokens;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+
+    static void host_deadline(const uint32_t millisec, struct timespec * const p_ts) {
+        (void)clock_gettime(CLOCK_REALTIME, p_ts);
+        p_ts->tv_sec += (time_t)(millisec / 1000u);
+        p_ts->tv_nsec += (long)(millisec % 1000u) * 1000000L;
+        if (p_ts->tv_nsec >= 1000000000L) {
+            p_ts->tv_sec++;
+            p_ts->tv_nsec -= 1000000000L;
+        }
+    }
+};
+
+/* The priority and the stack size are ignored. */
+class Thread {
+public:
+    Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = 0u)
+        : started(false) {
+        (void)priority;
+        (void)stack_size;
+    }
+
+    ~Thread() {
+        if (started == true) {
+            (void)pthread_detach(id);
+        }
+    }
+
+    osStatus start(mbed::Callback<void()> task) {
+        if (started == true) {
+            return osErrorResource;
+        }
+        func = task;
+        if (pthread_create(&id, NULL, &Thread::entry, this) != 0) {
+            return osErrorResource;
+        }
+        started = true;
+        return osOK;
+    }
+
+    static osStatus wait(uint32_t millisec) {
+        wait_us((int)(millisec * 1000u));
+        return osEventTimeout;
+    }
+
+private:
+    mbed::Callback<void()>  func;
+    pthread_t               id;
+    bool                    started;
+
+    static void *entry(void *p_arg) {
+        ((Thread *)p_arg)->func();
+        return NULL;
+    }
+};
+
+template<typename T, uint32_t queue_sz>
+class Mail {
+public:
+    Mail() : head(0u), cnt(0u) {
+        (void)pthread_mutex_init(&mutex, NULL);
+        (void)pthread_cond_init(&cond, NULL);
+        for (uint32_t i = 0u; i < queue_sz; i++) {
+            used[i] = false;
+        }
+    }
+
+    /* Like the target, alloc() does not wait for a free block. */
+    T *alloc(uint32_t millisec = 0u) {
+        T   *p_mail = NULL;
+
+        (void)millisec;
+        (void)pthread_mutex_lock(&mutex);
+        for (uint32_t i = 0u; (i < queue_sz) && (p_mail == NULL); i++) {
+            if (used[i] == false) {
+                used[i] = true;
+                p_mail = &pool[i];
+            }
+        }
+        (void)pthread_mutex_unlock(&mutex);
+        return p_mail;
+    }
+
+    osStatus put(T *mptr) {
+        osStatus    stat = osErrorParameter;
+
+        (void)pthread_mutex_lock(&mutex);
+        if ((mptr != NULL) && (cnt < queue_sz)) {
+            queue[(head + cnt) % queue_sz] = mptr;
+            cnt++;
+            (void)pthread_cond_signal(&cond);
+            stat = osOK;
+        }
+        (void)pthread_mutex_unlock(&mutex);
+        return stat;
+    }
+
+    osEvent get(uint32_t millisec = osWaitForever) {
+        osEvent         evt;
+        struct timespec ts;
+        int             err = 0;
+
+        evt.status = osEventTimeout;
+        evt.value.p = NULL;
+        evt.def.mail_id = this;
+        if (millisec != osWaitForever) {
+            (void)clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += (time_t)(millisec / 1000u);
+            ts.tv_nsec += (long)(millisec % 1000u) * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+        }
+        (void)pthread_mutex_lock(&mutex);
+        /* err is ETIMEDOUT at the timeout. <errno.h> is not included, because */
+        /* the application uses the error numbers of r_errno.h. */
+        while ((cnt == 0u) && (err == 0)) {
+            if (millisec == osWaitForever) {
+                err = pthread_cond_wait(&cond, &mutex);
+            } else {
+                err = pthread_cond_timedwait(&cond, &mutex, &ts);
+            }
+        }
+        if (cnt > 0u) {
+            evt.status = osEventMail;
+            evt.value.p = queue[head];
+            head = (head + 1u) % queue_sz;
+            cnt--;
+        } else if (millisec == 0u) {
+            evt.status = osOK;
+        } else {
+            /* osEventTimeout */
+        }
+        (void)pthread_mutex_unlock(&mutex);
+        return evt;
+    }
+
+    osStatus free(T *mptr) {
+        osStatus    stat = osErrorParameter;
+
+        (void)pthread_mutex_lock(&mutex);
+        if ((mptr >= &pool[0]) && (mptr < &pool[queue_sz])) {
+            used[mptr - &pool[0]] = false;
+            stat = osOK;
+        }
+        (void)pthread_mutex_unlock(&mutex);
+        return stat;
+    }
+
+private:
+    T               pool[queue_sz];
+    bool            used[queue_sz];
+    T               *queue[queue_sz];
+    uint32_t        head;
+    uint32_t        cnt;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+};
+
+#endif /* HOST_STUB_RTOS_H */
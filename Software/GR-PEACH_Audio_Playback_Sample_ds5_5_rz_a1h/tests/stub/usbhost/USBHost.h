@@ -0,0 +1,106 @@
+/* Host stub of USBHost.h for the USB host tests of the GR-PEACH.
+ *
+ * USBHostMSD is compiled unchanged against this USBHost. Its transfers go
+ * to the simulated devices of sim/msd_sim.cpp instead of the RZ_A1 host
+ * controller: the devices are attached and detached by the test, and
+ * the transfers are carried out on the calling thread like the blocking
+ * transfers of the target. USBHostTypes.h and USBHostConf.h are the ones
+ * of the firmware.
+ */
+#ifndef HOST_STUB_USBHOST_H
+#define HOST_STUB_USBHOST_H
+
+#include <cstdio>              /* std::printf of dbg.h */
+#include <string.h>
+#include "USBHostTypes.h"
+#include "USBHostConf.h"
+#include "rtos.h"
+#include "dbg.h"
+
+class USBEndpoint {
+public:
+    USBEndpoint() : address(0u), state(USB_TYPE_IDLE) {}
+
+    void init(const uint8_t addr) {
+        address = addr;
+        state = USB_TYPE_IDLE;
+    }
+
+    inline void setState(USB_TYPE st) { state = st; }
+    inline USB_TYPE getState() { return state; }
+    inline uint8_t getAddress() { return address; }
+
+private:
+    uint8_t     address;
+    USB_TYPE    state;
+};
+
+class IUSBEnumerator {
+public:
+    virtual void setVidPid(uint16_t vid, uint16_t pid) = 0;
+    virtual bool parseInterface(uint8_t intf_nb, uint8_t intf_class, uint8_t intf_subclass, uint8_t intf_protocol) = 0;
+    virtual bool useEndpoint(uint8_t intf_nb, ENDPOINT_TYPE type, ENDPOINT_DIRECTION dir) = 0;
+};
+
+class USBDeviceConnected {
+public:
+    USBDeviceConnected() : vid(0u), pid(0u) {
+        name[0] = '\0';
+    }
+
+    USBEndpoint * getEndpoint(uint8_t intf_nb, ENDPOINT_TYPE type, ENDPOINT_DIRECTION dir, uint8_t index = 0) {
+        (void)intf_nb;
+        (void)index;
+        if (type != BULK_ENDPOINT) {
+            return NULL;
+        }
+        return (dir == IN) ? &bulk_in : &bulk_out;
+    }
+
+    inline void setName(const char * name_, uint8_t intf_nb) {
+        (void)intf_nb;
+        strncpy(name, name_, sizeof(name) - 1u);
+        name[sizeof(name) - 1u] = '\0';
+    }
+
+    inline uint16_t getVid() { return vid; }
+    inline uint16_t getPid() { return pid; }
+
+    USBEndpoint             bulk_in;
+    USBEndpoint             bulk_out;
+    uint16_t                vid;
+    uint16_t                pid;
+    char                    name[8];
+    mbed::Callback<void()>  on_disconnect;
+};
+
+class USBHost {
+public:
+    static USBHost * getHostInst();
+
+    USB_TYPE controlRead(USBDeviceConnected * dev, uint8_t requestType, uint8_t request, uint32_t value, uint32_t index, uint8_t * buf, uint32_t len);
+    USB_TYPE controlWrite(USBDeviceConnected * dev, uint8_t requestType, uint8_t request, uint32_t value, uint32_t index, uint8_t * buf, uint32_t len);
+    USB_TYPE bulkRead(USBDeviceConnected * dev, USBEndpoint * ep, uint8_t * buf, uint32_t len, bool blocking = true);
+    USB_TYPE bulkWrite(USBDeviceConnected * dev, USBEndpoint * ep, uint8_t * buf, uint32_t len, bool blocking = true);
+    USB_TYPE enumerate(USBDeviceConnected * dev, IUSBEnumerator* pEnumerator);
+    USBDeviceConnected * getDevice(uint8_t index);
+
+    /* The disconnect callback of the driver is called by msd_sim_detach(). */
+    template<typename T>
+    inline void registerDriver(USBDeviceConnected * dev, uint8_t intf, T* tptr, void (T::*mptr)(void)) {
+        (void)intf;
+        dev->on_disconnect = mbed::callback(tptr, mptr);
+    }
+
+    /* Called by msd_sim_attach() and msd_sim_detach(). */
+    inline void attachDeviceEvent(void (*fn)(void)) {
+        deviceEvent = fn;
+    }
+
+    void (*deviceEvent)(void);
+
+private:
+    USBHost() : deviceEvent(NULL) {}
+};
+
+#endif /* HOST_STUB_USBHOST_H */
@@ -0,0 +1,16 @@
+/* Host stub of the mbed toolchain header for the USB host tests.
+ * USBHostTypes.h includes it after mbed.h, so it also defines the __IO
+ * of CMSIS for the descriptors of the host controller.
+ */
+#ifndef HOST_STUB_TOOLCHAIN_H
+#define HOST_STUB_TOOLCHAIN_H
+
+#ifndef PACKED
+#define PACKED      __attribute__((packed))
+#endif
+
+#ifndef __IO
+#define __IO        volatile
+#endif
+
+#endif /* HOST_STUB_TOOLCHAIN_H */
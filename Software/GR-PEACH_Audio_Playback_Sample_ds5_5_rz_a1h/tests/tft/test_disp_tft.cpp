@@ -0,0 +1,377 @@
+/* Host render test and benchmark of disp_tft: the now-playing screen.
+ *
+ * display/disp_tft.cpp is built into this translation unit with
+ * DSP_TFT_ENABLE 1 to see its dirty tiles, and us_ticker_read() is the
+ * host clock or a fake one for the slices.
+ *  - Snapshots: the stop, play and pause screens match the PNG files in
+ *    snapshot/. Each render is also written to the working directory as
+ *    tft_<name>.png. With TFT_SNAPSHOT_UPDATE=1 in the environment the
+ *    renders replace the snapshots instead.
+ *  - Incremental: after a track change, time ticks, spectrum updates and
+ *    a pause, the frame buffer equals a full redraw of the final state.
+ *    A 1 s tick marks only a few tiles.
+ *  - Slice: dsp_exe_tft() stops when DSP_TFT_SLICE_US is used, draws
+ *    nothing more in the same DSP_TFT_SLICE_CYCLE_MS, and goes on in the
+ *    next cycle.
+ * The benchmark prints the times of a full screen, a track change, a 1 s
+ * tick and a spectrum update.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <png.h>
+#include "host_test.h"
+#include "disp_tft.cpp"
+
+#define TEST_TICK_STEP_US   (250u)      /* Fake ticker: time per us_ticker_read() */
+#define TEST_TICK_MAX_TILE  (12u)      /* A minute carry: 3 characters on 2 tile rows and the bar */
+#define BENCH_TICK_NUM      (300u)
+#define BENCH_SPEC_NUM      (1000u)
+
+static bool             ticker_fake;
+static uint32_t         ticker_now_us;
+static dsp_com_ctrl_t   com;
+static dsp_tft_ctrl_t   tft;
+
+uint32_t us_ticker_read(void)
+{
+    if (ticker_fake == true) {
+        ticker_now_us += TEST_TICK_STEP_US;
+        return ticker_now_us;
+    }
+    return (uint32_t)(host_time_ns() / 1000u);
+}
+
+/* Draws until the frame buffer is up to date. Returns the time in ns. */
+static uint64_t draw_all(void)
+{
+    const uint64_t  top = host_time_ns();
+
+    while (dsp_exe_tft() == true) {
+        /* The slice is used up: the next cycle goes on. */
+    }
+    return host_time_ns() - top;
+}
+
+/* Draws an update in a new slice, as the display thread does at the mail, */
+/* so that the time does not include the wait for the next slice. */
+static uint64_t bench_draw(void)
+{
+    slice_start_us = us_ticker_read();
+    slice_used_us = 0u;
+    return draw_all();
+}
+
+static uint32_t dirty_tile_num(void)
+{
+    uint32_t    num = 0u;
+
+    for (uint32_t row = 0u; row < TILE_ROW_NUM; row++) {
+        num += (uint32_t)__builtin_popcount(dirty_tile[row]);
+    }
+    return num;
+}
+
+static void set_list(const uint32_t track_id, const uint32_t track_num)
+{
+    for (uint32_t row = 0u; row < DSP_LIST_ROW_NUM; row++) {
+        const uint32_t  no = (track_id + row) - LIST_SELECT_ROW;
+
+        if ((no >= 1u) && (no <= track_num)) {
+            tft.list_no[row] = no;
+            (void)snprintf(&tft.list_name[row][0], DSP_DISP_STR_MAX_LEN, "/Music/Album %u/%02u - Track.flac",
+                           (unsigned)(no / 10u), (unsigned)no);
+        } else {
+            tft.list_no[row] = 0u;
+            tft.list_name[row][0] = '\0';
+        }
+    }
+}
+
+/* Levels of a linear congruential generator, the same on every host. */
+static void set_spectrum(const uint32_t seed)
+{
+    uint32_t    x = seed;
+
+    for (uint32_t i = 0u; i < DSP_METER_BAND_NUM; i++) {
+        x = (x * 1103515245u) + 12345u;
+        com.band_level[i] = DSP_METER_LEVEL_MIN +
+                            (int32_t)((x >> 16) % (uint32_t)((DSP_METER_LEVEL_MAX - DSP_METER_LEVEL_MIN) + 1));
+    }
+}
+
+/* The state of the display thread while the track plays. */
+static void set_playing(const uint32_t track_id)
+{
+    com.play_stat = SYS_PLAYSTAT_PLAY;
+    com.track_id = track_id;
+    com.play_time = 83u;
+    com.total_time = 296u;
+    com.samp_freq = 44100u;
+    com.channel = 2u;
+    com.repeat_mode = true;
+    (void)snprintf(&com.file_name[0], DSP_DISP_STR_MAX_LEN, "%02u - Track.flac", (unsigned)track_id);
+    set_list(track_id, 12u);
+    set_spectrum(track_id);
+}
+
+/* Notifies the module of the whole state, like the mails of a track change. */
+static void output_all(void)
+{
+    dsp_output_tft(DSP_MAILID_PLAY_INFO, &com, &tft);
+    dsp_output_tft(DSP_MAILID_PLAY_MODE, &com, &tft);
+    dsp_output_tft(DSP_MAILID_FILE_NAME, &com, &tft);
+    dsp_output_tft(DSP_MAILID_PLAY_TIME, &com, &tft);
+    dsp_output_tft(DSP_MAILID_CYCLE_IND, &com, &tft);
+    dsp_output_tft(DSP_MAILID_LIST_NAME, &com, &tft);
+}
+
+/* Initialises the module for a full redraw. dsp_init_tft() empties the */
+/* track list of the control data too, so it is restored for output_all(). */
+static void init_keep_list(void)
+{
+    const dsp_tft_ctrl_t    keep = tft;
+
+    dsp_init_tft(&tft);
+    tft = keep;
+}
+
+static std::vector<uint8_t> frame_rgb(void)
+{
+    const uint16_t          *p_frame = dsp_get_tft_frame();
+    std::vector<uint8_t>    rgb(DSP_TFT_WIDTH * DSP_TFT_HEIGHT * 3u);
+
+    for (uint32_t i = 0u; i < (DSP_TFT_WIDTH * DSP_TFT_HEIGHT); i++) {
+        const uint32_t  r = (p_frame[i] >> 11) & 0x1Fu;
+        const uint32_t  g = (p_frame[i] >> 5) & 0x3Fu;
+        const uint32_t  b = p_frame[i] & 0x1Fu;
+
+        rgb[(i * 3u) + 0u] = (uint8_t)((r << 3) | (r >> 2));
+        rgb[(i * 3u) + 1u] = (uint8_t)((g << 2) | (g >> 4));
+        rgb[(i * 3u) + 2u] = (uint8_t)((b << 3) | (b >> 2));
+    }
+    return rgb;
+}
+
+static bool write_png(const std::string &path, const std::vector<uint8_t> &rgb)
+{
+    png_image   image;
+
+    (void)memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    image.width = DSP_TFT_WIDTH;
+    image.height = DSP_TFT_HEIGHT;
+    image.format = PNG_FORMAT_RGB;
+    return png_image_write_to_file(&image, path.c_str(), 0, &rgb[0], 0, NULL) != 0;
+}
+
+static bool read_png(const std::string &path, std::vector<uint8_t> * const p_rgb)
+{
+    png_image   image;
+    bool        ret = false;
+
+    (void)memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (png_image_begin_read_from_file(&image, path.c_str()) != 0) {
+        image.format = PNG_FORMAT_RGB;
+        if ((image.width == DSP_TFT_WIDTH) && (image.height == DSP_TFT_HEIGHT)) {
+            p_rgb->resize(PNG_IMAGE_SIZE(image));
+            ret = (png_image_finish_read(&image, NULL, &(*p_rgb)[0], 0, NULL) != 0);
+        } else {
+            png_image_free(&image);
+        }
+    }
+    return ret;
+}
+
+/* Compares the frame buffer with the snapshot of the name. */
+static void check_snapshot(const char * const p_name)
+{
+    const std::vector<uint8_t>  rgb = frame_rgb();
+    const std::string           golden = std::string(TFT_SNAPSHOT_DIR "/") + p_name + ".png";
+    const char                  *p_update = getenv("TFT_SNAPSHOT_UPDATE");
+    std::vector<uint8_t>        expect;
+    uint32_t                    diff = 0u;
+
+    HOST_CHECK(write_png(std::string("tft_") + p_name + ".png", rgb));
+    if ((p_update != NULL) && (strcmp(p_update, "1") == 0)) {
+        HOST_CHECK(write_png(golden, rgb));
+        (void)printf("snapshot %-6s: updated\n", p_name);
+    } else {
+        HOST_CHECK(read_png(golden, &expect));
+        if (expect.size() == rgb.size()) {
+            for (size_t i = 0u; i < rgb.size(); i += 3u) {
+                if (memcmp(&rgb[i], &expect[i], 3u) != 0) {
+                    diff++;
+                }
+            }
+        } else {
+            diff = DSP_TFT_WIDTH * DSP_TFT_HEIGHT;
+        }
+        HOST_CHECK_EQ(0u, diff);
+        (void)printf("snapshot %-6s: %u pixels differ\n", p_name, (unsigned)diff);
+    }
+}
+
+static void test_snapshot(void)
+{
+    (void)memset(&com, 0, sizeof(com));
+    (void)memset(&tft, 0, sizeof(tft));
+    dsp_init_tft(&tft);
+    (void)draw_all();
+    check_snapshot("stop");
+
+    set_playing(3u);
+    output_all();
+    (void)draw_all();
+    check_snapshot("play");
+
+    com.play_stat = SYS_PLAYSTAT_PAUSE;
+    com.play_time = 84u;
+    com.repeat_mode = false;
+    set_spectrum(100u);
+    dsp_output_tft(DSP_MAILID_PLAY_TIME, &com, &tft);
+    dsp_output_tft(DSP_MAILID_PLAY_MODE, &com, &tft);
+    dsp_output_tft(DSP_MAILID_CYCLE_IND, &com, &tft);
+    (void)draw_all();
+    check_snapshot("pause");
+}
+
+static void test_incremental(void)
+{
+    std::vector<uint16_t>   frame;
+    uint32_t                tile_max = 0u;
+
+    (void)memset(&com, 0, sizeof(com));
+    (void)memset(&tft, 0, sizeof(tft));
+    dsp_init_tft(&tft);
+    set_playing(1u);
+    output_all();
+    (void)draw_all();
+
+    /* Track change to the last track with a short list, then ticks. */
+    set_playing(12u);
+    com.samp_freq = 96000u;
+    com.channel = 1u;
+    output_all();
+    (void)draw_all();
+    for (uint32_t t = 0u; t < 70u; t++) {
+        com.play_time = t;
+        dsp_output_tft(DSP_MAILID_PLAY_TIME, &com, &tft);
+        /* The first one goes back from 83 s to 0 s. */
+        if ((t > 0u) && (dirty_tile_num() > tile_max)) {
+            tile_max = dirty_tile_num();
+        }
+        (void)draw_all();
+        set_spectrum(t + 1000u);
+        dsp_output_tft(DSP_MAILID_CYCLE_IND, &com, &tft);
+        (void)draw_all();
+    }
+    com.play_stat = SYS_PLAYSTAT_PAUSE;
+    dsp_output_tft(DSP_MAILID_PLAY_TIME, &com, &tft);
+    (void)draw_all();
+    frame.assign(dsp_get_tft_frame(), dsp_get_tft_frame() + (DSP_TFT_WIDTH * DSP_TFT_HEIGHT));
+
+    /* Full redraw of the same state. */
+    init_keep_list();
+    output_all();
+    (void)draw_all();
+    HOST_CHECK(memcmp(&frame[0], dsp_get_tft_frame(), frame.size() * sizeof(frame[0])) == 0);
+    (void)printf("1 s tick: %u tiles at most of %u\n", (unsigned)tile_max,
+                 (unsigned)(TILE_ROW_NUM * TILE_COL_NUM));
+    HOST_CHECK(tile_max <= TEST_TICK_MAX_TILE);
+}
+
+static void test_slice(void)
+{
+    std::vector<uint16_t>   frame;
+    uint32_t                dirty[TILE_ROW_NUM];
+    uint32_t                call_num = 0u;
+    bool                    is_busy = true;
+
+    /* Reference: the full screen of the state drawn at once. */
+    (void)memset(&com, 0, sizeof(com));
+    (void)memset(&tft, 0, sizeof(tft));
+    dsp_init_tft(&tft);
+    set_playing(5u);
+    output_all();
+    (void)draw_all();
+    frame.assign(dsp_get_tft_frame(), dsp_get_tft_frame() + (DSP_TFT_WIDTH * DSP_TFT_HEIGHT));
+
+    /* Each run of tiles takes TEST_TICK_STEP_US on the fake ticker. */
+    ticker_fake = true;
+    ticker_now_us = 0u;
+    init_keep_list();
+    output_all();
+    while ((is_busy == true) && (call_num < 100u)) {
+        is_busy = dsp_exe_tft();
+        call_num++;
+        if (is_busy == true) {
+            /* Nothing more is drawn in the same cycle. */
+            (void)memcpy(dirty, dirty_tile, sizeof(dirty));
+            HOST_CHECK(dsp_exe_tft());
+            HOST_CHECK(memcmp(dirty, dirty_tile, sizeof(dirty)) == 0);
+            ticker_now_us += SLICE_CYCLE_US;
+        }
+    }
+    ticker_fake = false;
+    HOST_CHECK(is_busy == false);
+    HOST_CHECK(call_num > 1u);
+    HOST_CHECK(memcmp(&frame[0], dsp_get_tft_frame(), frame.size() * sizeof(frame[0])) == 0);
+    (void)printf("full screen in %u slices of %u us at %u us per run\n", (unsigned)call_num,
+                 (unsigned)DSP_TFT_SLICE_US, (unsigned)TEST_TICK_STEP_US);
+}
+
+static void bench(void)
+{
+    uint64_t    full_ns;
+    uint64_t    track_ns;
+    uint64_t    tick_ns = 0u;
+    uint64_t    spec_ns = 0u;
+    uint64_t    ns;
+
+    (void)memset(&com, 0, sizeof(com));
+    (void)memset(&tft, 0, sizeof(tft));
+    dsp_init_tft(&tft);
+    full_ns = bench_draw();
+    set_playing(1u);
+    output_all();
+    (void)draw_all();
+
+    set_playing(2u);
+    ns = host_time_ns();
+    output_all();
+    track_ns = (host_time_ns() - ns) + bench_draw();
+
+    for (uint32_t t = 0u; t < BENCH_TICK_NUM; t++) {
+        com.play_time = t;
+        ns = host_time_ns();
+        dsp_output_tft(DSP_MAILID_PLAY_TIME, &com, &tft);
+        ns = (host_time_ns() - ns) + bench_draw();
+        if (ns > tick_ns) {
+            tick_ns = ns;
+        }
+    }
+    for (uint32_t i = 0u; i < BENCH_SPEC_NUM; i++) {
+        set_spectrum(i + 2000u);
+        ns = host_time_ns();
+        dsp_output_tft(DSP_MAILID_CYCLE_IND, &com, &tft);
+        ns = (host_time_ns() - ns) + bench_draw();
+        if (ns > spec_ns) {
+            spec_ns = ns;
+        }
+    }
+    (void)printf("full screen %.3f ms, track change %.3f ms, 1 s tick max %.3f ms, spectrum max %.3f ms\n",
+                 (double)full_ns * 1.0e-6, (double)track_ns * 1.0e-6,
+                 (double)tick_ns * 1.0e-6, (double)spec_ns * 1.0e-6);
+}
+
+int main(void)
+{
+    test_snapshot();
+    test_incremental();
+    test_slice();
+    bench();
+    return HOST_TEST_RESULT();
+}